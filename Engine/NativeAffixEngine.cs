@@ -1,4 +1,5 @@
 using Nioh3AffixEditor.Models;
+using Nioh3AffixEditor.Services;
 
 namespace Nioh3AffixEditor.Engine;
 
@@ -13,8 +14,15 @@ public sealed class NativeAffixEngine : IAffixEngine, IDisposable
     private ulong? _lastAffixSnapshotBase;
     private IReadOnlyList<AffixSlotData>? _lastAffixSnapshot;
 
+    private SharedStatePage? _statePage;
+
     public string Name => "NativeEngine";
 
+    /// <summary>
+    /// 核心发布的共享状态页（附加后可用，打开失败时为 null）
+    /// </summary>
+    public SharedStatePage? StatePage => _statePage;
+
     public bool IsAttached => NativeBridge.IsAttached();
 
     public ProcessInfo? AttachedProcess => _attachedProcess;
@@ -103,6 +111,37 @@ public sealed class NativeAffixEngine : IAffixEngine, IDisposable
         return NativeBridge.DisableSkillBypass();
     }
 
+    /// <summary>
+    /// 从游戏内存中的数据表读取词条和地狱技能名称（按游戏版本缓存到 AppData），
+    /// 某个表没有读到时对应的输出为 null，调用者继续使用 CSV
+    /// </summary>
+    public bool TryLoadGameCatalog(out AffixIdTable? affixes, out UnderworldSkillTable? underworldSkills)
+    {
+        ThrowIfDisposed();
+
+        affixes = null;
+        underworldSkills = null;
+        if (!IsAttached)
+        {
+            return false;
+        }
+
+        unsafe
+        {
+            System.IO.Directory.CreateDirectory(AppPaths.GetAppDataDir());
+            if (!NativeBridge.SessionLoadGameCatalog(0, AppPaths.GetGameCatalogCachePath(), null, out _))
+            {
+                return false;
+            }
+        }
+
+        var affixNames = NativeBridge.GetGameCatalog(0, 0);
+        var skillNames = NativeBridge.GetGameCatalog(0, 1);
+        affixes = affixNames.Count > 0 ? AffixIdTable.FromNames(affixNames) : null;
+        underworldSkills = skillNames.Count > 0 ? UnderworldSkillTable.FromNames(skillNames) : null;
+        return true;
+    }
+
     public Task AttachAsync(ProcessInfo process, CancellationToken cancellationToken)
     {
         ThrowIfDisposed();
@@ -118,18 +157,59 @@ public sealed class NativeAffixEngine : IAffixEngine, IDisposable
             throw new InvalidOperationException($"Failed to attach to process: {error}");
         }
 
+        LoadRecordLayout();
         _attachedProcess = process;
         _lastAffixSnapshotBase = null;
         _lastAffixSnapshot = null;
+        OpenStatePage();
         return Task.CompletedTask;
     }
 
+    /// <summary>
+    /// 游戏更新后字段偏移变化时，AppData 中的 record_layout.txt 覆盖内置布局；
+    /// 文件不合法时不附加 (按错误的偏移写入会破坏装备数据)
+    /// </summary>
+    private static void LoadRecordLayout()
+    {
+        var path = AppPaths.GetRecordLayoutPath();
+        if (NativeBridge.SessionLoadRecordLayout(0, System.IO.File.Exists(path) ? path : null))
+        {
+            return;
+        }
+
+        var error = NativeBridge.GetLastErrorString();
+        NativeBridge.DetachProcess();
+        throw new InvalidOperationException($"Failed to load {path}: {error}");
+    }
+
+    private void OpenStatePage()
+    {
+        if (_statePage is not null)
+        {
+            return;
+        }
+
+        var name = SharedStatePage.GetDefaultName(Environment.ProcessId);
+        if (NativeBridge.SessionEnableStatePage(0, name))
+        {
+            _statePage = SharedStatePage.TryOpen(name);
+        }
+    }
+
+    private void CloseStatePage()
+    {
+        _statePage?.Dispose();
+        _statePage = null;
+        NativeBridge.SessionDisableStatePage(0);
+    }
+
     public Task DetachAsync(CancellationToken cancellationToken)
     {
         if (IsAttached)
         {
             NativeBridge.DetachProcess();
         }
+        CloseStatePage();
         _attachedProcess = null;
         _lastAffixSnapshotBase = null;
         _lastAffixSnapshot = null;
@@ -325,6 +405,53 @@ public sealed class NativeAffixEngine : IAffixEngine, IDisposable
         return true;
     }
 
+    /// <summary>
+    /// 把一套词条写入多件装备（如背包读取或结构扫描得到的基址），不需要在游戏中逐件选中；
+    /// 返回每件装备的结果（与 preset_apply.h 中的 PresetItemResult 相同：0 未变化 / 1 已写入 / 其余为失败）
+    /// </summary>
+    public int[] ApplyAffixesToItems(IReadOnlyList<AffixSlotData> slots, IReadOnlyList<ulong> equipmentBases)
+    {
+        ThrowIfDisposed();
+
+        if (!IsAttached)
+        {
+            throw new InvalidOperationException("Not attached to any process.");
+        }
+
+        var preset = new AffixPreset();
+        foreach (var slot in slots)
+        {
+            int index = slot.SlotIndex - 1;
+            if (index < 0 || index >= 7)
+            {
+                throw new ArgumentOutOfRangeException(nameof(slots), $"Invalid slot index: {slot.SlotIndex}");
+            }
+
+            preset.Slots[index] = new AffixPresetSlot
+            {
+                Id = slot.AffixId,
+                Level = slot.Level,
+                Prefix1 = slot.Prefix1,
+                Prefix2 = slot.Prefix2,
+                Prefix3 = slot.Prefix3,
+                Prefix4 = slot.Prefix4,
+                FieldMask = 0x3F,
+            };
+        }
+
+        var results = NativeBridge.ApplyAffixPreset(0, preset, equipmentBases.ToArray(), out _);
+        if (results is null)
+        {
+            var error = NativeBridge.GetLastErrorString();
+            throw new InvalidOperationException($"Failed to apply affixes: {error}");
+        }
+
+        // 当前捕获的装备可能也在其中
+        _lastAffixSnapshotBase = null;
+        _lastAffixSnapshot = null;
+        return results;
+    }
+
     public Task<EquipmentData> ReadEquipmentAsync(CancellationToken cancellationToken)
     {
         ThrowIfDisposed();
@@ -422,6 +549,7 @@ public sealed class NativeAffixEngine : IAffixEngine, IDisposable
             {
                 NativeBridge.DetachProcess();
             }
+            CloseStatePage();
         }
         catch
         {
@@ -1,7 +1,372 @@
 using System.Runtime.InteropServices;
+using System.Text;
 
 namespace Nioh3AffixEditor.Engine;
 
+/// <summary>
+/// 捕获过的一件装备 (与 session.h 中的 CapturedItem 布局一致)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct CapturedItem
+{
+    public ulong Base;
+    public ulong LastSequence;
+    public uint HitCount;
+    public int EquipmentType;
+    public ulong Owner;
+}
+
+/// <summary>
+/// 推导出的背包数组布局 (与 inventory_layout.h 中的 InventoryLayout 布局一致)
+/// ArrayKind: 1 内联数组 / 2 指针数组；CountKind: 1 结束指针 / 2 32 位元素数
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct InventoryLayout
+{
+    public ulong Owner;
+    public ulong ArrayAddress;
+    public uint ArrayFieldOffset;
+    public uint CountFieldOffset;
+    public uint Stride;
+    public uint Count;
+    public int ArrayKind;
+    public int CountKind;
+}
+
+/// <summary>
+/// 背包中的一件装备 (与 session.h 中的 InventoryItem 布局一致)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal unsafe struct InventoryItem
+{
+    public ulong Base;
+    public short ItemId;
+    public short TransmogId;
+    public short Level;
+    public byte EquipPlusValue;
+    public byte Reserved;
+    public int Quality;
+    public fixed int AffixIds[7];
+    public fixed int AffixLevels[7];
+}
+
+/// <summary>
+/// 结构扫描参数 (与 equipment_scan.h 中的 EquipmentScanConfig 布局一致)，为 0 的字段取默认值
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct EquipmentScanConfig
+{
+    public ulong StartAddress;
+    public ulong EndAddress;
+    public int MinItemId;
+    public int MaxItemId;
+    public int MinLevel;
+    public int MaxLevel;
+    public int MinAffixId;
+    public int MaxAffixId;
+    public int MaxAffixLevel;
+    public uint MinAffixes;
+    public uint MaxResults;
+    public uint Threads;
+}
+
+/// <summary>
+/// 结构扫描的统计 (与 equipment_scan.h 中的 EquipmentScanStats 布局一致)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct EquipmentScanStats
+{
+    public ulong ScannedBytes;
+    public ulong Positions;
+    public ulong Candidates;
+    public ulong Records;
+    public ulong Microseconds;
+    public uint Regions;
+    public uint Reads;
+    public uint Threads;
+    public uint Truncated;
+}
+
+/// <summary>
+/// 字段发现提出的一个候选字段 (与 field_samples.h 中的 FieldCandidate 布局一致)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct FieldCandidate
+{
+    public uint Offset;
+    public uint Width;
+    public int Kind;        // 1 字节 / 2 位标志 / 3 整数 / 4 浮点 / 5 指针
+    public int BestLabel;   // 关联最强的标签序号，没有标签时为 -1
+    public double MinValue;
+    public double MaxValue;
+    public double Mean;
+    public double StdDev;
+    public double Correlation;
+    public double Association;
+    public uint Distinct;
+    public uint Reserved;
+}
+
+/// <summary>
+/// 字段发现的统计 (与 field_samples.h 中的 FieldAnalysisStats 布局一致)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct FieldAnalysisStats
+{
+    public uint Records;
+    public uint RecordSize;
+    public uint ConstantBytes;
+    public uint Candidates;
+    public ulong Microseconds;
+}
+
+/// <summary>
+/// 一个游戏数据表的定位方式和条目布局 (与 game_catalog.h 中的 CatalogTableSpec 布局一致)
+/// Signature 为以 0 结尾的 AOB 特征码 (?? 为通配符)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal unsafe struct CatalogTableSpec
+{
+    public fixed byte Signature[128];
+    public int DisplacementOffset;
+    public int InstructionLength;
+    public uint Dereference;
+    public uint EntriesOffset;
+    public uint CountOffset;
+    public uint EntryIndirect;
+    public uint EntryStride;
+    public uint IdOffset;
+    public uint NameOffset;
+    public uint NameEncoding;   // 0 UTF-8 / 1 UTF-16
+}
+
+/// <summary>
+/// 游戏数据表目录中的一项 (与 game_catalog.h 中的 CatalogEntry 布局一致)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct CatalogEntry
+{
+    public int Id;
+    public int Kind;            // 0 词条 / 1 地狱技能
+    public uint NameOffset;     // 名称在字符串池中的偏移
+    public uint NameLength;
+}
+
+/// <summary>
+/// 载入游戏数据表目录的统计 (与 game_catalog.h 中的 CatalogStats 布局一致)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct CatalogStats
+{
+    public ulong BuildKey;
+    public ulong BytesRead;
+    public ulong Microseconds;
+    public uint AffixEntries;
+    public uint UnderworldSkillEntries;
+    public uint Reads;
+    public uint FromCache;
+}
+
+/// <summary>
+/// 装备记录中一个字段的位置 (与 record_layout.h 中的 RecordFieldDesc 布局一致)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct RecordFieldDesc
+{
+    public uint Offset;         // 相对于记录基址
+    public byte Size;           // 1 / 2 / 4
+    public byte Bit;            // 位字段的位号，0xFF 表示整字段
+    public byte IsSigned;
+    public byte Reserved;
+}
+
+/// <summary>
+/// 预设中的一个词条槽位 (与 preset_apply.h 中的 AffixPresetSlot 布局一致)
+/// FieldMask: bit0 id、bit1 level、bit2..bit5 prefix1..prefix4
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct AffixPresetSlot
+{
+    public int Id;
+    public int Level;
+    public byte Prefix1;
+    public byte Prefix2;
+    public byte Prefix3;
+    public byte Prefix4;
+    public uint FieldMask;
+}
+
+[System.Runtime.CompilerServices.InlineArray(7)]
+internal struct AffixPresetSlots
+{
+    private AffixPresetSlot _element0;
+}
+
+/// <summary>
+/// 批量应用的预设 (与 preset_apply.h 中的 AffixPreset 布局一致)
+/// Basics 按 record_layout.h 中 RecordFieldId 的顺序，BasicsMask 的 bit i 表示写入 Basics[i]
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal unsafe struct AffixPreset
+{
+    public AffixPresetSlots Slots;
+    public fixed int Basics[8];
+    public uint BasicsMask;
+}
+
+/// <summary>
+/// 预设批量应用的统计 (与 preset_apply.h 中的 PresetApplyStats 布局一致)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct PresetApplyStats
+{
+    public ulong Microseconds;
+    public ulong BytesRead;
+    public ulong BytesWritten;
+    public uint Items;
+    public uint Applied;
+    public uint Unchanged;
+    public uint Failed;
+    public uint Reads;
+    public uint Writes;
+}
+
+/// <summary>
+/// 捕获 hook 的开销统计 (与 session.h 中的 CaptureStats 布局一致)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct CaptureStats
+{
+    public ulong WeaponHits;
+    public ulong ArmorHits;
+    public ulong LostHits;
+    public ulong WeaponHookedMs;
+    public ulong ArmorHookedMs;
+    public uint RearmCount;
+    public uint Flags;
+}
+
+/// <summary>
+/// 插桩 hook 的命中统计 (与 hook_stats.h 中的 HookStats 布局一致)
+/// Histogram[i] 为耗时在 [2^i, 2^(i+1)) 个 rdtsc 周期内的采样次数
+/// </summary>
+[StructLayout(LayoutKind.Sequential, Pack = 1)]
+internal unsafe struct HookStats
+{
+    public ulong Hits;
+    public ulong Samples;
+    public ulong TotalCycles;
+    public fixed ulong Histogram[64];
+}
+
+/// <summary>
+/// 补丁完整性检查的结果和开销 (与 integrity_monitor.h 中的 IntegrityStats 布局一致)
+/// States 依次为武器注入点、武器 hook 代码、装备注入点、装备 hook 代码、技能绕过位置 1、2:
+/// 0 未监视 / 1 完好 / 2 已被恢复为原始代码 / 3 被其它程序改写 / 4 读取失败 (无法判断)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal unsafe struct IntegrityStats
+{
+    public ulong Checks;
+    public ulong LastCheckMicroseconds;
+    public uint LastReads;
+    public uint LastBytes;
+    public fixed byte States[6];
+    public fixed byte Reserved[2];
+}
+
+/// <summary>
+/// 指针路径扫描参数 (与 pointer_scan.h 中的 PointerScanConfig 布局一致)，为 0 的字段取默认值
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct PointerScanConfig
+{
+    public ulong MaxMapBytes;
+    public ulong MaxNodes;
+    public uint MaxDepth;
+    public uint MaxOffset;
+    public uint MaxResults;
+    public uint Threads;
+}
+
+/// <summary>
+/// 一条指针路径 (与 pointer_scan.h 中的 PointerPath 布局一致)
+/// p = [模块 + ModuleOffset]，之后 p = [p + Offsets[i]]，目标地址 = p + Offsets[Depth - 1]
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal unsafe struct PointerPath
+{
+    public uint ModuleOffset;
+    public ushort Depth;
+    public ushort Reserved;
+    public fixed uint Offsets[6];
+}
+
+/// <summary>
+/// 指针路径扫描的统计 (与 pointer_scan.h 中的 PointerScanStats 布局一致)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct PointerScanStats
+{
+    public ulong ScannedBytes;
+    public ulong Pointers;
+    public ulong MapBytes;
+    public ulong Nodes;
+    public ulong BuildMicroseconds;
+    public ulong SearchMicroseconds;
+    public uint Regions;
+    public uint Threads;
+    public uint Results;
+    public uint Truncated;
+}
+
+/// <summary>
+/// 数值扫描条件 (与 value_scan.h 中的 ValueScanQuery 布局一致)
+/// ValueType: 1 int8, 2 int16, 3 int32, 4 int64, 5 float, 6 double
+/// Compare: 1 等于, 2 范围, 3 变化, 4 不变, 5 增大, 6 减小 (首次扫描只能用等于 / 范围)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct ValueScanQuery
+{
+    public int ValueType;
+    public int Compare;
+    public long IntValue;
+    public long IntValue2;
+    public double FloatValue;
+    public double FloatValue2;
+    public ulong StartAddress;
+    public ulong EndAddress;
+    public ulong MaxMemoryBytes;
+    public uint Threads;
+    public uint Reserved;
+}
+
+/// <summary>
+/// 数值扫描的统计 (与 value_scan.h 中的 ValueScanStats 布局一致)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct ValueScanStats
+{
+    public ulong Candidates;
+    public ulong MemoryBytes;
+    public ulong ScannedBytes;
+    public ulong Microseconds;
+    public uint Reads;
+    public uint DenseBlocks;
+    public uint SparseBlocks;
+    public uint Threads;
+}
+
+/// <summary>
+/// 数值扫描的一个候选，Value 为最近一次读到的原始字节 (高位补 0)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct ValueScanResult
+{
+    public ulong Address;
+    public ulong Value;
+}
+
 /// <summary>
 /// P/Invoke 桥接类，用于调用 Nioh3AffixCore.dll
 /// </summary>
@@ -191,6 +556,467 @@ internal static partial class NativeBridge
     [return: MarshalAs(UnmanagedType.Bool)]
     public static partial bool IsSkillBypassEnabled();
 
+    // 共享状态页 (session 传 0 表示默认会话)
+    [LibraryImport(DllName, StringMarshalling = StringMarshalling.Utf8)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionEnableStatePage(nint session, string name);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial void SessionDisableStatePage(nint session);
+
+    // 远程操作跟踪 (下一次附加时生效，path 为 null 表示关闭)
+    [LibraryImport(DllName, StringMarshalling = StringMarshalling.Utf8)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial void SessionSetTraceFile(nint session, string? path);
+
+    // 编辑日志 (作用于当前装备)
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionUndoEdits(nint session, int steps, out int applied);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionRedoEdits(nint session, int steps, out int applied);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionRestoreOriginal(nint session);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionGetEditDepth(nint session, out int undoDepth, out int redoDepth);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial void SessionSetJournalLimit(nint session, ulong bytes);
+
+    [LibraryImport(DllName, StringMarshalling = StringMarshalling.Utf8)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionEnableJournalFile(nint session, string path);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial void SessionDisableJournalFile(nint session);
+
+    // 捕获传输方式 (共享内存或 ReadProcessMemory，附加后首次启用捕获时生效)
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial void SessionSetSharedCapture(nint session, [MarshalAs(UnmanagedType.U1)] bool allow);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionIsCaptureShared(nint session);
+
+    // 编辑信箱 (写入由 hook 在游戏线程上应用，默认关闭)
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial void SessionSetEditMailbox(nint session, [MarshalAs(UnmanagedType.U1)] bool enable);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial int SessionGetPendingEdits(nint session);
+
+    // 常驻 hook (附加之前设置；分离后 hook 留在游戏中，下次附加直接接管，cachePath 为 null 表示关闭)
+    // SessionGetResidentState: 0 没有常驻代码洞, 1 已接管, 2 已不完好并被清除
+    [LibraryImport(DllName, StringMarshalling = StringMarshalling.Utf8)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial void SessionSetResidentHooks(nint session, string? cachePath);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial int SessionGetResidentState(nint session);
+
+    // 捕获代数 (每次 hook 命中加一，未变化时可跳过刷新)
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial ulong SessionGetCaptureGeneration(nint session);
+
+    // 捕获过的装备列表 (按最近捕获排序，返回总数)
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static unsafe partial int SessionGetCapturedItems(nint session, CapturedItem* items, int capacity);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial void SessionClearCapturedItems(nint session);
+
+    // 单次捕获 (捕获到基址后自动撤下 hook，选择新装备时重新挂上)
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial void SessionSetOneShotCapture(nint session, [MarshalAs(UnmanagedType.U1)] bool enable);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionRearmCapture(nint session);
+
+    // hook 命中次数和处于 hook 状态的时间
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionGetCaptureStats(nint session, out CaptureStats stats);
+
+    // hook 插桩 (下一次挂上 hook 时生效)，equipmentType: 1 武器 / 2 装备
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial void SessionSetHookInstrumentation(nint session, [MarshalAs(UnmanagedType.U1)] bool enable);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionGetHookStats(nint session, int equipmentType, out HookStats stats);
+
+    // 容器捕获 (下一次挂上 hook 时生效) 和背包批量读取
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial void SessionSetOwnerCapture(nint session, [MarshalAs(UnmanagedType.U1)] bool enable);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionDeriveInventoryLayout(nint session, out InventoryLayout layout);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static unsafe partial int SessionReadInventory(nint session, InventoryItem* items, int capacity);
+
+    // 结构扫描 (config 为 null 时全部取默认值)
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static unsafe partial bool SessionScanEquipment(nint session, EquipmentScanConfig* config, out EquipmentScanStats stats);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static unsafe partial int SessionGetScannedEquipment(nint session, InventoryItem* items, int capacity);
+
+    // 字段发现 (base 为 0 表示当前装备；labels 的长度即标签个数)
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static unsafe partial bool SessionAddFieldSample(nint session, ulong baseAddress, uint size, int* labels, uint labelCount);
+
+    [LibraryImport(DllName, StringMarshalling = StringMarshalling.Utf8)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionSaveFieldSamples(nint session, string path);
+
+    [LibraryImport(DllName, StringMarshalling = StringMarshalling.Utf8)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionLoadFieldSamples(nint session, string path);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial void SessionClearFieldSamples(nint session);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial int SessionGetFieldSampleCount(nint session);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static unsafe partial int SessionAnalyzeFieldSamples(nint session, FieldCandidate* candidates, int capacity, out FieldAnalysisStats stats);
+
+    // 游戏数据表目录 (cachePath 可为空；specs 为 2 项，为 null 时使用内置的特征码和布局)
+    [LibraryImport(DllName, StringMarshalling = StringMarshalling.Utf8)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static unsafe partial bool SessionLoadGameCatalog(nint session, string? cachePath, CatalogTableSpec* specs, out CatalogStats stats);
+
+    [LibraryImport(DllName, StringMarshalling = StringMarshalling.Utf8)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static unsafe partial bool SessionDumpGameTables(nint session, string path, CatalogTableSpec* specs);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static unsafe partial int SessionGetCatalogEntries(nint session, int kind, CatalogEntry* entries, int capacity);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static unsafe partial int SessionGetCatalogStrings(nint session, byte* buffer, int capacity);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial nint SessionGetCatalogName(nint session, int kind, int id);
+
+    // 装备记录布局 (path 为 null 时恢复内置布局)
+    [LibraryImport(DllName, StringMarshalling = StringMarshalling.Utf8)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionLoadRecordLayout(nint session, string? path);
+
+    [LibraryImport(DllName, StringMarshalling = StringMarshalling.Utf8)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionSaveRecordLayout(nint session, string path);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static unsafe partial int SessionGetRecordLayout(nint session, RecordFieldDesc* fields, int capacity);
+
+    // 预设批量应用 (results 为 count 项 PresetItemResult，可为 null)
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static unsafe partial bool SessionApplyAffixPreset(nint session, in AffixPreset preset, ulong* bases, int count, int* results, out PresetApplyStats stats);
+
+    // 补丁完整性检查 (intervalMs 为 0 时只在 SessionCheckIntegrity 时检查)
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial void SessionSetIntegrityInterval(nint session, uint intervalMs);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionCheckIntegrity(nint session, out IntegrityStats stats);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionGetIntegrityStats(nint session, out IntegrityStats stats);
+
+    // 指针路径扫描 (target 为 0 表示当前装备，config 为 null 时全部取默认值)
+    [LibraryImport(DllName, StringMarshalling = StringMarshalling.Utf8)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static unsafe partial bool SessionScanPointerPaths(nint session, ulong target, PointerScanConfig* config,
+        string outputPath, out PointerScanStats stats);
+
+    [LibraryImport(DllName, StringMarshalling = StringMarshalling.Utf8)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionIntersectPointerPaths(nint session, string first, string second, string outputPath,
+        out ulong count);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionResolvePointerPath(nint session, in PointerPath path, out ulong address);
+
+    // 数值扫描 (失败时之前的结果不变)
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionFirstScan(nint session, in ValueScanQuery query, out ValueScanStats stats);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static partial bool SessionNextScan(nint session, in ValueScanQuery query, out ValueScanStats stats);
+
+    // 按地址顺序填充前 capacity 个候选，返回总数
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static unsafe partial int SessionGetScanResults(nint session, ValueScanResult* results, int capacity);
+
+    [LibraryImport(DllName)]
+    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+    public static partial void SessionResetScan(nint session);
+
+    /// <summary>
+    /// 读取捕获过的装备列表 (最近捕获的在前)
+    /// </summary>
+    public static CapturedItem[] GetCapturedItems(nint session)
+    {
+        unsafe
+        {
+            // 两次调用之间可能有新捕获，按返回的总数重试
+            int capacity = SessionGetCapturedItems(session, null, 0);
+            while (true)
+            {
+                var items = new CapturedItem[capacity];
+                int total;
+                fixed (CapturedItem* ptr = items)
+                {
+                    total = SessionGetCapturedItems(session, ptr, capacity);
+                }
+
+                if (total <= capacity)
+                {
+                    return total == capacity ? items : items[..total];
+                }
+                capacity = total;
+            }
+        }
+    }
+
+    /// <summary>
+    /// 批量读取背包中的全部装备，失败时返回 null (错误信息见 GetLastErrorString)
+    /// </summary>
+    public static InventoryItem[]? ReadInventory(nint session)
+    {
+        unsafe
+        {
+            // 两次读取之间背包可能变化，按返回的总数重试
+            int capacity = 256;
+            while (true)
+            {
+                var items = new InventoryItem[capacity];
+                int total;
+                fixed (InventoryItem* ptr = items)
+                {
+                    total = SessionReadInventory(session, ptr, capacity);
+                }
+
+                if (total < 0)
+                {
+                    return null;
+                }
+                if (total <= capacity)
+                {
+                    return total == capacity ? items : items[..total];
+                }
+                capacity = total;
+            }
+        }
+    }
+
+    /// <summary>
+    /// 读取最近一次结构扫描找到的全部装备 (按地址升序)
+    /// </summary>
+    public static InventoryItem[] GetScannedEquipment(nint session)
+    {
+        unsafe
+        {
+            var items = new InventoryItem[SessionGetScannedEquipment(session, null, 0)];
+            int total;
+            fixed (InventoryItem* ptr = items)
+            {
+                total = SessionGetScannedEquipment(session, ptr, items.Length);
+            }
+            return total < items.Length ? items[..total] : items;
+        }
+    }
+
+    /// <summary>
+    /// 添加一条字段发现样本 (base 为 0 表示当前装备)
+    /// </summary>
+    public static bool AddFieldSample(nint session, ulong baseAddress, uint size, int[] labels)
+    {
+        unsafe
+        {
+            fixed (int* ptr = labels)
+            {
+                return SessionAddFieldSample(session, baseAddress, size, ptr, (uint)labels.Length);
+            }
+        }
+    }
+
+    /// <summary>
+    /// 分析已收集的样本，返回全部候选字段 (按偏移排序)；没有样本时返回空数组
+    /// </summary>
+    public static FieldCandidate[] AnalyzeFieldSamples(nint session, out FieldAnalysisStats stats)
+    {
+        unsafe
+        {
+            int count = SessionAnalyzeFieldSamples(session, null, 0, out stats);
+            var candidates = new FieldCandidate[Math.Max(count, 0)];
+            int total;
+            fixed (FieldCandidate* ptr = candidates)
+            {
+                total = SessionAnalyzeFieldSamples(session, ptr, candidates.Length, out stats);
+            }
+            return total >= 0 && total < candidates.Length ? candidates[..total] : candidates;
+        }
+    }
+
+    /// <summary>
+    /// 读取已载入的游戏数据表目录中 kind 表的全部名称 (ID -> 名称)；目录未载入时返回空字典
+    /// </summary>
+    public static Dictionary<int, string> GetGameCatalog(nint session, int kind)
+    {
+        unsafe
+        {
+            var entries = new CatalogEntry[Math.Max(SessionGetCatalogEntries(session, kind, null, 0), 0)];
+            var pool = new byte[Math.Max(SessionGetCatalogStrings(session, null, 0), 0)];
+            int entryCount;
+            int poolSize;
+            fixed (CatalogEntry* entryPtr = entries)
+            fixed (byte* poolPtr = pool)
+            {
+                entryCount = SessionGetCatalogEntries(session, kind, entryPtr, entries.Length);
+                poolSize = SessionGetCatalogStrings(session, poolPtr, pool.Length);
+            }
+
+            var names = new Dictionary<int, string>(entries.Length);
+            if (entryCount != entries.Length || poolSize != pool.Length)
+            {
+                return names;   // 两次调用之间目录被重新载入
+            }
+            foreach (var entry in entries)
+            {
+                if ((ulong)entry.NameOffset + entry.NameLength <= (ulong)pool.Length)
+                {
+                    names[entry.Id] = Encoding.UTF8.GetString(pool, (int)entry.NameOffset, (int)entry.NameLength);
+                }
+            }
+            return names;
+        }
+    }
+
+    /// <summary>
+    /// 读取当前的装备记录布局 (按 record_layout.h 中 RecordFieldId 的顺序)
+    /// </summary>
+    public static RecordFieldDesc[] GetRecordLayout(nint session)
+    {
+        unsafe
+        {
+            var fields = new RecordFieldDesc[SessionGetRecordLayout(session, null, 0)];
+            fixed (RecordFieldDesc* ptr = fields)
+            {
+                SessionGetRecordLayout(session, ptr, fields.Length);
+            }
+            return fields;
+        }
+    }
+
+    /// <summary>
+    /// 把预设写入 bases 中的每件装备，返回每件装备的结果 (preset_apply.h 中的 PresetItemResult)；
+    /// 部分装备失败时仍返回结果 (GetLastErrorString 给出第一件失败装备的原因)，
+    /// 整体失败 (未附加、参数无效、记录重叠) 时返回 null
+    /// </summary>
+    public static int[]? ApplyAffixPreset(nint session, in AffixPreset preset, ulong[] bases, out PresetApplyStats stats)
+    {
+        unsafe
+        {
+            var results = new int[bases.Length];
+            stats = default;
+            fixed (ulong* basePtr = bases)
+            fixed (int* resultPtr = results)
+            {
+                bool applied = SessionApplyAffixPreset(session, preset, basePtr, bases.Length, resultPtr, out stats);
+                return applied || stats.Failed != 0 ? results : null;
+            }
+        }
+    }
+
+    /// <summary>
+    /// 读取数值扫描的前 maxCount 个候选 (候选可能有上百万个，界面只显示前面一部分)
+    /// </summary>
+    public static ValueScanResult[] GetScanResults(nint session, int maxCount)
+    {
+        unsafe
+        {
+            var results = new ValueScanResult[Math.Min(SessionGetScanResults(session, null, 0), maxCount)];
+            int total;
+            fixed (ValueScanResult* ptr = results)
+            {
+                total = SessionGetScanResults(session, ptr, results.Length);
+            }
+            return total < results.Length ? results[..total] : results;
+        }
+    }
+
     /// <summary>
     /// 获取最后一次错误信息的托管字符串
     /// </summary>
@@ -0,0 +1,188 @@
+using System.IO.MemoryMappedFiles;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+
+namespace Nioh3AffixEditor.Engine;
+
+/// <summary>
+/// 共享状态页读取结果
+/// </summary>
+public enum StatePageReadResult
+{
+    Ok,
+    Unchanged,
+    Torn,
+    Invalid
+}
+
+[InlineArray(7)]
+public struct StateAffixSlots
+{
+    private StateAffixSlot _element0;
+}
+
+[StructLayout(LayoutKind.Sequential, Pack = 8)]
+public struct StateAffixSlot
+{
+    public int Id;
+    public int Level;
+    public byte Prefix1;
+    public byte Prefix2;
+    public byte Prefix3;
+    public byte Prefix4;
+    public uint Reserved;
+}
+
+[StructLayout(LayoutKind.Sequential, Pack = 8)]
+public struct StateRecord
+{
+    public ulong Base;
+    public uint ValidMask;
+    public short ItemId;
+    public short TransmogId;
+    public short Level;
+    public byte EquipPlusValue;
+    public byte IsUnderworld;
+    public int Quality;
+    public int UnderworldSkillId;
+    public int Familiarity;
+    public uint Reserved;
+    public StateAffixSlots Affixes;
+}
+
+[StructLayout(LayoutKind.Sequential, Pack = 8)]
+public struct StateCounters
+{
+    public ulong RemoteReads;
+    public ulong RemoteWrites;
+    public ulong RemoteQueries;
+    public ulong RemoteProtects;
+    public ulong RemoteAllocations;
+    public ulong BytesRead;
+    public ulong BytesWritten;
+    public ulong RemoteFailures;
+    public ulong PublishCount;
+}
+
+/// <summary>
+/// 共享状态页正文，布局与 Nioh3AffixCore/state_page.h 中的 StatePageBody 一致
+/// </summary>
+[StructLayout(LayoutKind.Sequential, Pack = 8)]
+public struct StatePageBody
+{
+    public const uint FlagAttached = 1u << 0;
+    public const uint FlagWeaponHook = 1u << 1;
+    public const uint FlagArmorHook = 1u << 2;
+    public const uint FlagSkillBypass = 1u << 3;
+    public const uint FlagEditsWithdrawn = 1u << 4;
+
+    public const uint RecordBasicsValid = 1u << 0;
+    public const uint RecordExtendedValid = 1u << 1;
+    public const uint RecordWeaponFieldsValid = 1u << 2;
+    public const uint RecordAffixSlot0Valid = 1u << 8;
+
+    public uint Flags;
+    public int EquipmentType;
+    public ulong EquipmentBase;
+    public ulong WeaponBase;
+    public ulong ArmorBase;
+    public StateRecord Record;
+    public StateCounters Counters;
+}
+
+/// <summary>
+/// 核心发布的共享状态页 (seqlock 协议，见 state_page.h)。
+/// 读取只做内存拷贝，不经过 P/Invoke，也不分配托管对象。
+/// </summary>
+public sealed unsafe class SharedStatePage : IDisposable
+{
+    private const uint Magic = 0x5053334E; // "N3SP"
+    private const uint Version = 1;
+    private const int SequenceOffset = 16;
+    private const int BodyOffset = 24;
+    private const int PageSize = 280;
+
+    private readonly MemoryMappedFile _file;
+    private readonly MemoryMappedViewAccessor _view;
+    private byte* _ptr;
+    private ulong _lastSequence;
+
+    private SharedStatePage(MemoryMappedFile file, MemoryMappedViewAccessor view)
+    {
+        _file = file;
+        _view = view;
+        _view.SafeMemoryMappedViewHandle.AcquirePointer(ref _ptr);
+        _ptr += _view.PointerOffset;
+    }
+
+    /// <summary>
+    /// 默认映射名称，按编辑器进程区分
+    /// </summary>
+    public static string GetDefaultName(int editorProcessId)
+        => $"Local\\Nioh3AffixEditor.State.{editorProcessId}";
+
+    public static SharedStatePage? TryOpen(string name)
+    {
+        try
+        {
+            var file = MemoryMappedFile.OpenExisting(name, MemoryMappedFileRights.Read);
+            var view = file.CreateViewAccessor(0, PageSize, MemoryMappedFileAccess.Read);
+            return new SharedStatePage(file, view);
+        }
+        catch
+        {
+            return null;
+        }
+    }
+
+    /// <summary>
+    /// 读取一致快照。返回 Unchanged 时 body 保持不变；Torn 时应稍后重试。
+    /// </summary>
+    public StatePageReadResult TryRead(ref StatePageBody body)
+    {
+        if (_ptr == null)
+        {
+            return StatePageReadResult.Invalid;
+        }
+
+        ulong before = Volatile.Read(ref *(ulong*)(_ptr + SequenceOffset));
+        if ((before & 1) != 0)
+        {
+            return StatePageReadResult.Torn;
+        }
+
+        if (*(uint*)_ptr != Magic || *(uint*)(_ptr + 4) != Version)
+        {
+            return StatePageReadResult.Invalid;
+        }
+
+        if (before == _lastSequence)
+        {
+            return StatePageReadResult.Unchanged;
+        }
+
+        StatePageBody copy = *(StatePageBody*)(_ptr + BodyOffset);
+        Interlocked.MemoryBarrier();
+
+        ulong after = Volatile.Read(ref *(ulong*)(_ptr + SequenceOffset));
+        if (after != before)
+        {
+            return StatePageReadResult.Torn;
+        }
+
+        body = copy;
+        _lastSequence = before;
+        return StatePageReadResult.Ok;
+    }
+
+    public void Dispose()
+    {
+        if (_ptr != null)
+        {
+            _view.SafeMemoryMappedViewHandle.ReleasePointer();
+            _ptr = null;
+        }
+        _view.Dispose();
+        _file.Dispose();
+    }
+}
@@ -1,38 +1,25 @@
 #include "aob_scanner.h"
-#include <Psapi.h>
 #include <vector>
+#include <cstdlib>
 #include <cstring>
 
-#pragma comment(lib, "psapi.lib")
-
 struct PatternByte {
-    BYTE value;
+    uint8_t value;
     bool isWild;
 };
 
-bool GetMainModuleInfo(HANDLE process, QWORD& baseAddr, QWORD& moduleSize) {
-    HMODULE hMods[1024];
-    DWORD cbNeeded;
-
-    if (EnumProcessModules(process, hMods, sizeof(hMods), &cbNeeded)) {
-        MODULEINFO modInfo;
-        if (GetModuleInformation(process, hMods[0], &modInfo, sizeof(modInfo))) {
-            baseAddr = (QWORD)modInfo.lpBaseOfDll;
-            moduleSize = (QWORD)modInfo.SizeOfImage;
-            return true;
-        }
-    }
-    return false;
+bool GetMainModuleInfo(ProcessMemory* memory, QWORD& baseAddr, QWORD& moduleSize) {
+    return memory != nullptr && memory->GetMainModule(baseAddr, moduleSize);
 }
 
-QWORD AobScan(HANDLE process, const char* pattern, QWORD startAddr, QWORD endAddr) {
+QWORD AobScan(ProcessMemory* memory, const char* pattern, QWORD startAddr, QWORD endAddr) {
     // 如果起始和结束地址都为0，自动获取主模块范围
     QWORD actualStartAddr = startAddr;
     QWORD actualEndAddr = endAddr;
 
     if (startAddr == 0 && endAddr == 0) {
         QWORD baseAddr, moduleSize;
-        if (GetMainModuleInfo(process, baseAddr, moduleSize)) {
+        if (GetMainModuleInfo(memory, baseAddr, moduleSize)) {
             actualStartAddr = baseAddr;
             actualEndAddr = baseAddr + moduleSize;
         }
@@ -69,7 +56,7 @@ QWORD AobScan(HANDLE process, const char* pattern, QWORD startAddr, QWORD endAdd
         }
         else {
             char* end;
-            bytes[i].value = (BYTE)strtoul(c, &end, 16);
+            bytes[i].value = (uint8_t)strtoul(c, &end, 16);
             bytes[i].isWild = (end != c + 2);
             if (bytes[i].isWild) {
                 return 0; // 无效的十六进制字符
@@ -78,16 +65,16 @@ QWORD AobScan(HANDLE process, const char* pattern, QWORD startAddr, QWORD endAdd
     }
 
     // 扫描内存
-    const DWORD pageSize = 4096;
-    std::vector<BYTE> page(pageSize);
+    const size_t pageSize = 4096;
+    std::vector<uint8_t> page(pageSize);
 
     for (QWORD addr = actualStartAddr; addr < actualEndAddr; addr += pageSize - byteCount) {
-        SIZE_T bytesRead;
-        if (!ReadProcessMemory(process, (LPCVOID)addr, page.data(), pageSize, &bytesRead)) {
+        size_t bytesRead;
+        if (!memory->Read(addr, page.data(), pageSize, &bytesRead)) {
             continue;
         }
 
-        for (SIZE_T i = 0; i < bytesRead - byteCount; i++) {
+        for (size_t i = 0; i < bytesRead - byteCount; i++) {
             bool matched = true;
             for (int j = 0; j < byteCount; j++) {
                 if (!bytes[j].isWild && page[i + j] != bytes[j].value) {
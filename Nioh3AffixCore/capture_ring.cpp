@@ -0,0 +1,199 @@
+#include "capture_ring.h"
+#include <cstddef>
+#include <cstring>
+
+CaptureRing::CaptureRing()
+    : m_nextSequence(0)
+    , m_generation(0)
+    , m_lastTag(0)
+    , m_lost(0)
+{
+}
+
+CaptureRing::~CaptureRing() {
+    Release();
+}
+
+bool CaptureRing::Initialize(ProcessMemory* memory, RemoteArena* arena, bool allowShared) {
+    Release();
+
+    // 头部和所有条目清零 (tag 为 0 表示从未写入)
+    if (!m_block.Initialize(memory, arena, TOTAL_SIZE, allowShared)) {
+        return false;
+    }
+
+    m_entries.assign(sizeof(CaptureRingEntry) * CaptureRingLayout::CAPACITY, 0);
+    return true;
+}
+
+bool CaptureRing::Adopt(ProcessMemory* memory, RemoteArena* arena, QWORD address) {
+    Release();
+
+    CaptureRingHeader header;
+    if (!m_block.Adopt(memory, arena, address, TOTAL_SIZE) || !m_block.Read(0, &header, sizeof(header))) {
+        m_block.Release();
+        return false;
+    }
+
+    // 上一次会话之后的记录都还没有消费，但环中只保留最近 CAPACITY 条
+    m_entries.assign(sizeof(CaptureRingEntry) * CaptureRingLayout::CAPACITY, 0);
+    m_nextSequence = header.writeIndex > CaptureRingLayout::CAPACITY ? header.writeIndex - CaptureRingLayout::CAPACITY : 0;
+    return true;
+}
+
+void CaptureRing::Release() {
+    m_block.Release();
+    Abandon();
+}
+
+void CaptureRing::Abandon() {
+    m_block.Abandon();
+    m_nextSequence = 0;
+    m_generation = 0;
+    m_lastTag = 0;
+    m_lost = 0;
+}
+
+bool CaptureRing::EmitAppend(X64Emitter& emitter, QWORD ringAddress, X64Reg capturedRegister, uint8_t source,
+    X64Reg ownerRegister) {
+    /*
+        (调用者已保存 rax/rcx/rdx 和标志位)
+        B8 01000000             ; mov eax, 1
+        F0 48 0F C1 05 [disp32] ; lock xadd [rip+writeIndex], rax   -> rax = 序号
+        48 89 C1                ; mov rcx, rax
+        48 81 E1 [imm32]        ; and rcx, CAPACITY-1
+        48 C1 E1 05             ; shl rcx, ENTRY_SHIFT
+        48 8D 15 [disp32]       ; lea rdx, [rip+entries]
+        48 01 CA                ; add rdx, rcx
+        48 FF C0                ; inc rax
+        48 C1 E0 08             ; shl rax, 8
+        48 83 C8 [source]       ; or rax, source
+        48 89 42 18             ; mov [rdx+18], rax     (先写 seal)
+        48 89 xx 08             ; mov [rdx+8], 捕获的寄存器
+        48 31 C9                ; xor rcx, rcx          (不记录容器时)
+        48 89 xx 10             ; mov [rdx+10], 容器寄存器 / rcx
+        48 89 42 00             ; mov [rdx+0], rax      (写完 base 再写 tag)
+        48 89 05 [disp32]       ; mov [rip+lastTag], rax
+    */
+    auto isScratch = [](X64Reg reg) {
+        return reg == X64Reg::Rax || reg == X64Reg::Rcx || reg == X64Reg::Rdx || reg == X64Reg::Rsp;
+    };
+    if (isScratch(capturedRegister) || (ownerRegister != NO_OWNER && isScratch(ownerRegister))) {
+        return false;
+    }
+
+    QWORD entriesAddress = ringAddress + sizeof(CaptureRingHeader);
+
+    emitter.MovImm32(X64Reg::Rax, 1);
+    emitter.LockXaddRip(ringAddress + offsetof(CaptureRingHeader, writeIndex), X64Reg::Rax);
+    emitter.MovReg(X64Reg::Rcx, X64Reg::Rax);
+    emitter.AndImm32(X64Reg::Rcx, (int32_t)(CaptureRingLayout::CAPACITY - 1));
+    emitter.ShlImm8(X64Reg::Rcx, CaptureRingLayout::ENTRY_SHIFT);
+    emitter.LeaRip(X64Reg::Rdx, entriesAddress);
+    emitter.AddReg(X64Reg::Rdx, X64Reg::Rcx);
+    emitter.Inc(X64Reg::Rax);
+    emitter.ShlImm8(X64Reg::Rax, CaptureRingLayout::TAG_SEQUENCE_SHIFT);
+    emitter.OrImm8(X64Reg::Rax, (int8_t)source);
+    emitter.MovStore(X64Reg::Rdx, (int32_t)offsetof(CaptureRingEntry, seal), X64Reg::Rax);
+    emitter.MovStore(X64Reg::Rdx, (int32_t)offsetof(CaptureRingEntry, base), capturedRegister);
+    if (ownerRegister == NO_OWNER) {
+        // 槽位会被重复使用，不记录时也要清掉上一圈的值
+        emitter.XorReg(X64Reg::Rcx, X64Reg::Rcx);
+        ownerRegister = X64Reg::Rcx;
+    }
+    emitter.MovStore(X64Reg::Rdx, (int32_t)offsetof(CaptureRingEntry, owner), ownerRegister);
+    emitter.MovStore(X64Reg::Rdx, (int32_t)offsetof(CaptureRingEntry, tag), X64Reg::Rax);
+    emitter.MovRipStore(ringAddress + offsetof(CaptureRingHeader, lastTag), X64Reg::Rax);
+
+    return emitter.Ok();
+}
+
+bool CaptureRing::ReadEntries(uint64_t firstSequence, uint64_t count) {
+    // 读出 [firstSequence, firstSequence + count) 所在的槽位，环绕时分两段
+    size_t entriesOffset = sizeof(CaptureRingHeader);
+    uint32_t firstSlot = (uint32_t)(firstSequence & (CaptureRingLayout::CAPACITY - 1));
+    uint64_t firstCount = CaptureRingLayout::CAPACITY - firstSlot;
+    if (firstCount > count) {
+        firstCount = count;
+    }
+
+    size_t offset = (size_t)firstSlot * sizeof(CaptureRingEntry);
+    if (!m_block.Read(entriesOffset + offset, m_entries.data() + offset, (size_t)firstCount * sizeof(CaptureRingEntry))) {
+        return false;
+    }
+    if (count > firstCount) {
+        if (!m_block.Read(entriesOffset, m_entries.data(), (size_t)(count - firstCount) * sizeof(CaptureRingEntry))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CaptureRing::Drain(std::vector<CaptureEvent>& outEvents, bool* outChanged) {
+    if (outChanged != nullptr) {
+        *outChanged = false;
+    }
+    if (!m_block.IsInitialized()) {
+        return false;
+    }
+
+    CaptureRingHeader header;
+    if (!m_block.Read(0, &header, sizeof(header))) {
+        return false;
+    }
+
+    uint64_t writeIndex = header.writeIndex;
+    bool changed = writeIndex != m_generation;
+    m_generation = writeIndex;
+    m_lastTag = header.lastTag;
+    if (outChanged != nullptr) {
+        *outChanged = changed;
+    }
+
+    if (writeIndex < m_nextSequence) {
+        // 计数回退只可能是缓冲区被外部重置，从当前位置重新开始
+        m_nextSequence = writeIndex;
+        return true;
+    }
+
+    // 代数未变且没有上次留下的未写完条目，不再读取
+    if (writeIndex == m_nextSequence) {
+        return true;
+    }
+
+    // 落后超过一圈的记录已被覆盖
+    if (writeIndex - m_nextSequence > CaptureRingLayout::CAPACITY) {
+        uint64_t skipped = writeIndex - m_nextSequence - CaptureRingLayout::CAPACITY;
+        m_lost += skipped;
+        m_nextSequence += skipped;
+    }
+
+    if (!ReadEntries(m_nextSequence, writeIndex - m_nextSequence)) {
+        return false;
+    }
+
+    for (; m_nextSequence < writeIndex; m_nextSequence++) {
+        CaptureRingEntry entry;
+        memcpy(&entry, m_entries.data() + (m_nextSequence & (CaptureRingLayout::CAPACITY - 1)) * sizeof(CaptureRingEntry), sizeof(entry));
+
+        uint64_t tagSequence = entry.tag >> CaptureRingLayout::TAG_SEQUENCE_SHIFT;
+        if (tagSequence < m_nextSequence + 1) {
+            // 槽位已认领但还没写完，下次轮询再消费 (保持顺序)
+            break;
+        }
+        if (tagSequence > m_nextSequence + 1 || entry.seal != entry.tag) {
+            // 读取之前或拷贝期间被新一圈覆盖 (seal 先于 base/owner 改写)
+            m_lost++;
+            continue;
+        }
+
+        CaptureEvent event;
+        event.base = entry.base;
+        event.owner = entry.owner;
+        event.sequence = m_nextSequence;
+        event.source = (uint8_t)(entry.tag & CaptureRingLayout::TAG_SOURCE_MASK);
+        outEvents.push_back(event);
+    }
+
+    return true;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "process_memory.h"
+#include "remote_arena.h"
+#include "remote_block.h"
+#include "x64_emitter.h"
+#include <cstdint>
+#include <vector>
+
+// 捕获环形缓冲区 (位于代码洞数据区，由所有捕获 hook 共用)
+//
+// 布局: [CaptureRingHeader][CaptureRingEntry * CAPACITY]
+//
+// 生产者 (hook 代码，在游戏线程上执行):
+//   seq = lock xadd [writeIndex], 1
+//   entry = entries[seq & (CAPACITY - 1)]
+//   entry.seal  = ((seq + 1) << 8) | source      ; 先写尾部标记
+//   entry.base  = 捕获的寄存器
+//   entry.owner = 拥有该装备的容器寄存器 (开启容器捕获的 hook)，否则为 0
+//   entry.tag   = entry.seal                      ; 写完 base/owner 再写 tag，x86 的写入顺序保证它们先于 tag 可见
+//   header.lastTag = entry.tag                    ; 最近一次命中的 hook
+//
+// writeIndex 同时是捕获代数: 每次命中加一，同一基址被重复捕获也会改变。
+// 消费者 (本工具): 每次轮询只读 16 字节头部，代数与上次相同且没有未消费的条目时到此为止；
+// 否则只读出新增的条目 (环绕时分两段)，按序号从上次位置消费到 writeIndex。
+// 条目按地址递增拷贝 (tag、base/owner、seal)，tag 与 seal 都等于期望值时才接受:
+// tag 相符说明这一圈的 base/owner 已经写完；新一圈的生产者先写 seal 再写 base/owner，
+// 拷贝期间槽位被改写时读到的 seal 必然已经变化。tag 还是上一圈的条目尚未写完，留到下次轮询；
+// 其余不符的条目已被覆盖，计为丢失。
+// lock xadd 认领槽位，多个游戏线程同时命中 hook 也不会写坏同一条目。
+//
+// 传输方式见 RemoteBlock: 支持共享视图时消费者直接用普通内存读取，没有跨进程调用；
+// 否则放在代码洞数据区，通过 ProcessMemory::Read 读取。两种方式的布局和协议完全相同。
+namespace CaptureRingLayout {
+    constexpr uint32_t CAPACITY = 256;          // 必须是 2 的幂
+    constexpr uint32_t ENTRY_SHIFT = 5;         // 条目大小 = 1 << ENTRY_SHIFT
+    constexpr uint32_t TAG_SEQUENCE_SHIFT = 8;
+    constexpr uint64_t TAG_SOURCE_MASK = 0xFF;
+
+    // 条目来源 (tag 的低 8 位)
+    constexpr uint8_t SOURCE_WEAPON = 1;
+    constexpr uint8_t SOURCE_ARMOR = 2;
+}
+
+#pragma pack(push, 1)
+
+struct CaptureRingHeader {
+    uint64_t writeIndex;    // 已认领的条目数 (下一个序号)，即捕获代数
+    uint64_t lastTag;       // 最近写完的条目的 tag，0 表示尚未捕获
+};
+
+// tag 放在 base 前面、seal 放在最后: 读取按地址递增拷贝，先读到 tag，最后读到 seal
+// 两者都是期望值说明拷贝到的 base/owner 属于同一次写入 (与 seqlock 同理)
+struct CaptureRingEntry {
+    uint64_t tag;           // ((序号 + 1) << 8) | 来源，0 表示从未写入；最后写入
+    uint64_t base;
+    uint64_t owner;         // 容器指针 (见 inventory_layout.h)，0 表示未记录
+    uint64_t seal;          // 与 tag 相同，最先写入
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(CaptureRingHeader) == 16, "capture ring layout changed");
+static_assert(sizeof(CaptureRingEntry) == (1u << CaptureRingLayout::ENTRY_SHIFT), "capture ring layout changed");
+static_assert((CaptureRingLayout::CAPACITY & (CaptureRingLayout::CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+// 消费到的一条捕获记录
+struct CaptureEvent {
+    QWORD base;
+    QWORD owner;
+    uint64_t sequence;
+    uint8_t source;
+};
+
+class CaptureRing {
+public:
+    static constexpr size_t TOTAL_SIZE = sizeof(CaptureRingHeader) + sizeof(CaptureRingEntry) * CaptureRingLayout::CAPACITY;
+
+    CaptureRing();
+    ~CaptureRing();
+
+    CaptureRing(const CaptureRing&) = delete;
+    CaptureRing& operator=(const CaptureRing&) = delete;
+
+    // 分配并清零；allowShared 为 true 时优先放在共享视图中，不支持时退回到代码洞数据区
+    bool Initialize(ProcessMemory* memory, RemoteArena* arena, bool allowShared = true);
+
+    // 接管常驻代码洞中的缓冲区，从仍保留在环中的最早一条记录开始消费
+    bool Adopt(ProcessMemory* memory, RemoteArena* arena, QWORD address);
+
+    // 解除共享视图或把槽位还给代码洞分配器
+    void Release();
+
+    // 不访问目标进程，直接丢弃状态 (代码洞被放弃时使用；目标进程中的共享视图保留)
+    void Abandon();
+
+    bool IsInitialized() const { return m_block.IsInitialized(); }
+    QWORD GetAddress() const { return m_block.GetAddress(); }
+
+    // 是否通过共享视图读取 (不产生跨进程调用)
+    bool IsShared() const { return m_block.IsShared(); }
+
+    // 生成追加一条记录的生产者代码
+    // 会改写 rax/rcx/rdx 和标志位，由调用者保存和恢复；capturedRegister / ownerRegister 不能是这三个寄存器
+    // ownerRegister 为 NO_OWNER 时条目的 owner 写 0
+    static constexpr X64Reg NO_OWNER = X64Reg::Rsp;
+    static bool EmitAppend(X64Emitter& emitter, QWORD ringAddress, X64Reg capturedRegister, uint8_t source,
+        X64Reg ownerRegister = NO_OWNER);
+
+    // 读取头部，代数有变化时再读出新记录并按序号追加到 outEvents
+    // outChanged 返回代数是否变化 (可为空)；读取失败返回 false
+    bool Drain(std::vector<CaptureEvent>& outEvents, bool* outChanged = nullptr);
+
+    // 最近一次读到的捕获代数和最后命中的 hook 来源 (0 表示尚未捕获)
+    uint64_t GetGeneration() const { return m_generation; }
+    uint8_t GetLastSource() const { return (uint8_t)(m_lastTag & CaptureRingLayout::TAG_SOURCE_MASK); }
+
+    // 被覆盖或未写完而跳过的记录数
+    uint64_t GetLostCount() const { return m_lost; }
+
+    // 下一个待消费的序号
+    uint64_t GetNextSequence() const { return m_nextSequence; }
+
+private:
+    RemoteBlock m_block;
+    uint64_t m_nextSequence;
+    uint64_t m_generation;
+    uint64_t m_lastTag;
+    uint64_t m_lost;
+    std::vector<uint8_t> m_entries;     // 条目的本地副本 (按槽位存放)
+
+    bool ReadEntries(uint64_t firstSequence, uint64_t count);
+};
@@ -1,235 +1,268 @@
 #include "code_injector.h"
+#include "x64_decoder.h"
+#include "x64_emitter.h"
+#include "patch_transaction.h"
 #include <cstring>
 
 CodeInjector::CodeInjector()
-    : m_process(nullptr)
+    : m_memory(nullptr)
+    , m_arena(nullptr)
     , m_injectionPoint(0)
     , m_allocatedMemory(0)
-    , m_equipmentVarAddr(0)
+    , m_ringAddress(0)
+    , m_mailboxAddress(0)
+    , m_statsAddress(0)
+    , m_instrumented(false)
+    , m_captureOwner(false)
     , m_enabled(false)
+    , m_foreign(false)
     , m_hookType(HookType::Weapon)
+    , m_hookedTime(0)
     , m_originalBytesCount(0)
+    , m_codeSize(0)
+    , m_codeHash(0)
 {
     memset(m_originalBytes, 0, sizeof(m_originalBytes));
+    memset(m_jumpBytes, 0, sizeof(m_jumpBytes));
 }
 
 CodeInjector::~CodeInjector() {
     Cleanup();
 }
 
-bool CodeInjector::Initialize(HANDLE process, QWORD injectionPoint, HookType hookType) {
+bool CodeInjector::Initialize(ProcessMemory* memory, RemoteArena* arena, const CaptureRing* ring, const EditMailbox* mailbox,
+    QWORD injectionPoint, HookType hookType) {
     if (m_enabled) {
         return false; // 已经启用，需要先禁用
     }
 
-    m_process = process;
+    // 重复初始化时先归还上一次分配的槽位
+    Cleanup();
+
+    if (arena == nullptr || !arena->IsInitialized() || ring == nullptr || !ring->IsInitialized()) {
+        return false;
+    }
+
+    m_memory = memory;
+    m_arena = arena;
     m_injectionPoint = injectionPoint;
     m_hookType = hookType;
+    m_ringAddress = ring->GetAddress();
+    m_mailboxAddress = mailbox != nullptr && mailbox->IsInitialized() ? mailbox->GetAddress() : 0;
 
-    // 根据Hook类型确定原始指令字节数
-    if (hookType == HookType::Weapon) {
-        m_originalBytesCount = 6;  // mov rdx,rbp + mov rcx,r10
-    } else {
-        m_originalBytesCount = 8;  // lea rcx,[r12+00000148]
+    // 备份原始代码: 读出最长可能的一段，解码出覆盖 5 字节跳转的完整指令
+    // 武器: mov rdx,rbp + mov rcx,r10 (6 字节)  装备: lea rcx,[r12+00000148] (8 字节)
+    uint8_t code[sizeof(m_originalBytes)];
+    if (!memory->Read(injectionPoint, code, sizeof(code))) {
+        return false;
     }
+    size_t coveredLength = MeasureX64Instructions(code, sizeof(code), X64Emitter::JMP_REL32_SIZE);
+    if (coveredLength == 0 || coveredLength > sizeof(m_originalBytes)) {
+        return false;
+    }
+    memcpy(m_originalBytes, code, coveredLength);
+    m_originalBytesCount = (int)coveredLength;
 
-    // 备份原始代码
-    SIZE_T bytesRead;
-    if (!ReadProcessMemory(process, (LPCVOID)injectionPoint, m_originalBytes, m_originalBytesCount, &bytesRead)
-        || bytesRead != (SIZE_T)m_originalBytesCount) {
+    // 从会话的代码洞中分配 hook 代码
+    // 代码洞在主模块附近，注入点可以用相对跳转 (±2GB 范围内) 到达
+    m_allocatedMemory = arena->AllocateCode(HOOK_CODE_SLOT_SIZE);
+    if (m_allocatedMemory == 0) {
+        Cleanup();
         return false;
     }
 
-    // 在目标进程中分配内存 (用于 hook 代码和装备基址变量)
-    // 必须在注入点附近分配，以便使用相对跳转 (±2GB 范围内)
-    m_allocatedMemory = 0;
+    return true;
+}
 
-    // 尝试在注入点前后 1GB 范围内分配内存
-    // 从注入点向下搜索可用地址
-    QWORD searchStart = injectionPoint > 0x70000000 ? injectionPoint - 0x70000000 : 0x10000;
-    QWORD searchEnd = injectionPoint + 0x70000000;
-
-    // 按 64KB 边界对齐 (Windows 分配粒度)
-    searchStart = (searchStart + 0xFFFF) & ~0xFFFF;
-
-    MEMORY_BASIC_INFORMATION mbi;
-    for (QWORD addr = searchStart; addr < searchEnd; addr += 0x10000) {
-        if (VirtualQueryEx(process, (LPCVOID)addr, &mbi, sizeof(mbi)) == sizeof(mbi)) {
-            if (mbi.State == MEM_FREE && mbi.RegionSize >= 0x1000) {
-                // 尝试在这个地址分配
-                LPVOID allocated = VirtualAllocEx(
-                    process,
-                    (LPVOID)addr,
-                    0x1000,
-                    MEM_COMMIT | MEM_RESERVE,
-                    PAGE_EXECUTE_READWRITE
-                );
-                if (allocated != nullptr) {
-                    m_allocatedMemory = (QWORD)allocated;
-                    break;
-                }
-            }
-        }
+bool CodeInjector::Adopt(ProcessMemory* memory, RemoteArena* arena, const CaptureRing* ring, const EditMailbox* mailbox,
+    const ResidentHookRecord& record) {
+    if (m_enabled) {
+        return false;
     }
 
-    if (m_allocatedMemory == 0) {
-        // 如果附近分配失败，尝试让系统自动分配
-        m_allocatedMemory = (QWORD)VirtualAllocEx(
-            process,
-            nullptr,
-            0x1000,
-            MEM_COMMIT | MEM_RESERVE,
-            PAGE_EXECUTE_READWRITE
-        );
+    Cleanup();
+
+    if (arena == nullptr || !arena->IsInitialized() || ring == nullptr || !ring->IsInitialized()) {
+        return false;
     }
 
-    if (m_allocatedMemory == 0) {
+    HookType hookType;
+    if (record.source == CaptureRingLayout::SOURCE_WEAPON) {
+        hookType = HookType::Weapon;
+    } else if (record.source == CaptureRingLayout::SOURCE_ARMOR) {
+        hookType = HookType::Armor;
+    } else {
         return false;
     }
 
-    // 装备基址变量地址 (在分配内存的末尾)
-    m_equipmentVarAddr = m_allocatedMemory + 0x100;
+    // 记录的字节数必须正好是覆盖跳转的完整指令
+    int originalBytesCount = record.patchSize;
+    if (MeasureX64Instructions(record.originalBytes, record.patchSize, X64Emitter::JMP_REL32_SIZE) != record.patchSize ||
+        record.codeSize > HOOK_CODE_SLOT_SIZE ||
+        !arena->Claim(record.codeAddress, HOOK_CODE_SLOT_SIZE)) {
+        return false;
+    }
 
-    // 初始化装备基址变量为 0
-    QWORD zero = 0;
-    SIZE_T bytesWritten;
-    WriteProcessMemory(process, (LPVOID)m_equipmentVarAddr, &zero, sizeof(zero), &bytesWritten);
+    m_memory = memory;
+    m_arena = arena;
+    m_injectionPoint = record.injectionPoint;
+    m_hookType = hookType;
+    m_allocatedMemory = record.codeAddress;
+    m_ringAddress = ring->GetAddress();
+    m_mailboxAddress = mailbox != nullptr && mailbox->IsInitialized() ? mailbox->GetAddress() : 0;
+    m_statsAddress = record.statsAddress;
+    m_instrumented = record.statsAddress != 0;
+    m_originalBytesCount = originalBytesCount;
+    memcpy(m_originalBytes, record.originalBytes, originalBytesCount);
+    memcpy(m_jumpBytes, record.jumpBytes, originalBytesCount);
+    m_codeSize = record.codeSize;
+    m_codeHash = record.codeHash;
+
+    SetEnabled(true);
+    return true;
+}
 
+bool CodeInjector::Describe(ResidentHookRecord& outRecord) const {
+    if (!m_enabled) {
+        return false;
+    }
+
+    memset(&outRecord, 0, sizeof(outRecord));
+    outRecord.injectionPoint = m_injectionPoint;
+    outRecord.codeAddress = m_allocatedMemory;
+    outRecord.statsAddress = m_instrumented ? m_statsAddress : 0;
+    outRecord.codeHash = m_codeHash;
+    outRecord.codeSize = m_codeSize;
+    outRecord.source = GetCaptureSource();
+    outRecord.patchSize = (uint8_t)m_originalBytesCount;
+    memcpy(outRecord.originalBytes, m_originalBytes, m_originalBytesCount);
+    memcpy(outRecord.jumpBytes, m_jumpBytes, m_originalBytesCount);
     return true;
 }
 
-int CodeInjector::GenerateWeaponHookCode(BYTE* buffer, QWORD returnAddr) {
+uint8_t CodeInjector::GetCaptureSource() const {
+    return m_hookType == HookType::Weapon ? CaptureRingLayout::SOURCE_WEAPON : CaptureRingLayout::SOURCE_ARMOR;
+}
+
+int CodeInjector::GenerateHookCode(uint8_t* buffer, size_t capacity) {
     /*
-    武器Hook代码结构:
+    Hook代码结构 (不修改任何寄存器和标志位):
 
     newmem:
-        ; 保存 rbp 到装备基址变量
-        ; mov [m_equipmentVarAddr], rbp
-        ; 使用绝对地址方式: mov rax, addr; mov [rax], rbp
-        48 B8 [8字节地址]       ; mov rax, m_equipmentVarAddr
-        48 89 28                ; mov [rax], rbp
-
-        ; 执行原始指令
-        48 8B D5                ; mov rdx, rbp
-        49 8B CA                ; mov rcx, r10
-
-        ; 跳回原位置 + 6
-        ; jmp [return_addr]
-        48 B8 [8字节地址]       ; mov rax, return_addr
-        FF E0                   ; jmp rax
+        50                      ; push rax
+        9F                      ; lahf                  ah = SF/ZF/AF/PF/CF
+        0F 90 C0                ; seto al               al = OF
+        50                      ; push rax              (保存的标志位)
+        51 52                   ; push rcx/rdx
+        [41 50] [41 51] [41 52] ; push r8 (信箱或插桩) / r9 (信箱) / r10 (插桩): 只保存会被改写的寄存器
+        [插桩: 计数/开始采样]   ; 见 HookStatsBlock::EmitBegin (不插桩时省略)
+        [追加捕获记录]          ; rbp (武器) / rbx (装备)，容器捕获时加上 r12 -> 捕获环形缓冲区，见 CaptureRing::EmitAppend
+        [应用编辑信箱]          ; 基址匹配时应用待处理的写入，见 EditMailbox::EmitApply (没有信箱时省略)
+        [插桩: 结束采样]        ; 见 HookStatsBlock::EmitEnd (不插桩时省略)
+        [41 5A] [41 59] [41 58] 5A 59
+        58                      ; pop rax               (保存的标志位)
+        04 7F                   ; add al, 7F            al 为 1 时有符号溢出: 恢复 OF
+        9E                      ; sahf                  恢复 SF/ZF/AF/PF/CF
+        58                      ; pop rax
+        [原始指令]              ; 搬移后的被覆盖指令 (RIP 相对操作数和相对跳转按新位置修正，见 x64_decoder.h)
+                                ; 武器: mov rdx,rbp; mov rcx,r10  装备: lea rcx,[r12+00000148]
+        E9 [rel32]              ; jmp 注入点 + 原始指令长度
+                                ; (分配在 ±2GB 之外时改用 FF 25 00000000 [8字节地址])
+
+    不用 pushfq/popfq: popfq 是微码指令，约占 hook 开销的一半。lahf/sahf + seto 覆盖全部
+    状态标志；主体不执行串操作，DF 不会改变。
     */
 
-    int offset = 0;
-
-    // mov rax, m_equipmentVarAddr
-    buffer[offset++] = 0x48;
-    buffer[offset++] = 0xB8;
-    memcpy(&buffer[offset], &m_equipmentVarAddr, 8);
-    offset += 8;
-
-    // mov [rax], rbp
-    buffer[offset++] = 0x48;
-    buffer[offset++] = 0x89;
-    buffer[offset++] = 0x28;
-
-    // mov rdx, rbp (原始指令)
-    buffer[offset++] = 0x48;
-    buffer[offset++] = 0x8B;
-    buffer[offset++] = 0xD5;
-
-    // mov rcx, r10 (原始指令)
-    buffer[offset++] = 0x49;
-    buffer[offset++] = 0x8B;
-    buffer[offset++] = 0xCA;
-
-    // mov rax, return_addr
-    buffer[offset++] = 0x48;
-    buffer[offset++] = 0xB8;
-    memcpy(&buffer[offset], &returnAddr, 8);
-    offset += 8;
+    X64Reg capturedRegister = m_hookType == HookType::Weapon ? X64Reg::Rbp : X64Reg::Rbx;
+
+    // rax 与标志位一起保存；r8 被信箱和插桩改写，r9 只被信箱改写，r10 只在插桩时使用 (保存起始时间戳)
+    const bool instrumented = m_statsAddress != 0;
+    const bool mailbox = m_mailboxAddress != 0;
+    X64Reg savedRegisters[5];
+    int savedCount = 0;
+    savedRegisters[savedCount++] = X64Reg::Rcx;
+    savedRegisters[savedCount++] = X64Reg::Rdx;
+    if (mailbox || instrumented) {
+        savedRegisters[savedCount++] = X64Reg::R8;
+    }
+    if (mailbox) {
+        savedRegisters[savedCount++] = X64Reg::R9;
+    }
+    if (instrumented) {
+        savedRegisters[savedCount++] = X64Reg::R10;
+    }
 
-    // jmp rax
-    buffer[offset++] = 0xFF;
-    buffer[offset++] = 0xE0;
+    X64Emitter emitter(buffer, capacity, m_allocatedMemory);
+    emitter.Push(X64Reg::Rax);
+    emitter.Lahf();
+    emitter.SetoAl();
+    emitter.Push(X64Reg::Rax);
+    for (int i = 0; i < savedCount; i++) {
+        emitter.Push(savedRegisters[i]);
+    }
+    if (instrumented && !HookStatsBlock::EmitBegin(emitter, m_statsAddress, X64Reg::R10)) {
+        return 0;
+    }
+    X64Reg ownerRegister = m_captureOwner && HasOwnerRegister() ? X64Reg::R12 : CaptureRing::NO_OWNER;
+    if (!CaptureRing::EmitAppend(emitter, m_ringAddress, capturedRegister, GetCaptureSource(), ownerRegister)) {
+        return 0;
+    }
+    if (mailbox && !EditMailbox::EmitApply(emitter, m_mailboxAddress, capturedRegister)) {
+        return 0;
+    }
+    if (instrumented && !HookStatsBlock::EmitEnd(emitter, m_statsAddress, X64Reg::R10)) {
+        return 0;
+    }
+    for (int i = savedCount - 1; i >= 0; i--) {
+        emitter.Pop(savedRegisters[i]);
+    }
+    emitter.Pop(X64Reg::Rax);
+    emitter.AddAlImm8(0x7F);
+    emitter.Sahf();
+    emitter.Pop(X64Reg::Rax);
+    if (!RelocateX64Instructions(m_originalBytes, m_originalBytesCount, m_injectionPoint, emitter)) {
+        return 0;
+    }
+    emitter.Jmp(m_injectionPoint + m_originalBytesCount);
 
-    return offset;
+    return emitter.Ok() ? (int)emitter.Size() : 0;
 }
 
-int CodeInjector::GenerateArmorHookCode(BYTE* buffer, QWORD returnAddr) {
-    /*
-    装备Hook代码结构:
-
-    newmem:
-        ; 保存 rbx 到装备基址变量
-        ; 使用绝对地址方式: mov rax, addr; mov [rax], rbx
-        48 B8 [8字节地址]       ; mov rax, m_equipmentVarAddr
-        48 89 18                ; mov [rax], rbx
+void CodeInjector::DescribeIntegrity(IntegrityRange& outPatch, IntegrityRange& outCode) const {
+    memset(&outPatch, 0, sizeof(outPatch));
+    memset(&outCode, 0, sizeof(outCode));
+    if (!m_enabled) {
+        return;
+    }
 
-        ; 执行原始指令
-        49 8D 8C 24 48 01 00 00 ; lea rcx,[r12+00000148]
+    outPatch.address = m_injectionPoint;
+    outPatch.size = (uint32_t)m_originalBytesCount;
+    outPatch.expectedHash = HashResidentBytes(m_jumpBytes, m_originalBytesCount);
+    outPatch.originalHash = HashResidentBytes(m_originalBytes, m_originalBytesCount);
 
-        ; 跳回原位置 + 8
-        48 B8 [8字节地址]       ; mov rax, return_addr
-        FF E0                   ; jmp rax
-    */
-
-    int offset = 0;
-
-    // mov rax, m_equipmentVarAddr
-    buffer[offset++] = 0x48;
-    buffer[offset++] = 0xB8;
-    memcpy(&buffer[offset], &m_equipmentVarAddr, 8);
-    offset += 8;
-
-    // mov [rax], rbx
-    buffer[offset++] = 0x48;
-    buffer[offset++] = 0x89;
-    buffer[offset++] = 0x18;
-
-    // lea rcx,[r12+00000148] (原始指令)
-    buffer[offset++] = 0x49;
-    buffer[offset++] = 0x8D;
-    buffer[offset++] = 0x8C;
-    buffer[offset++] = 0x24;
-    buffer[offset++] = 0x48;
-    buffer[offset++] = 0x01;
-    buffer[offset++] = 0x00;
-    buffer[offset++] = 0x00;
-
-    // mov rax, return_addr
-    buffer[offset++] = 0x48;
-    buffer[offset++] = 0xB8;
-    memcpy(&buffer[offset], &returnAddr, 8);
-    offset += 8;
-
-    // jmp rax
-    buffer[offset++] = 0xFF;
-    buffer[offset++] = 0xE0;
-
-    return offset;
+    outCode.address = m_allocatedMemory;
+    outCode.size = m_codeSize;
+    outCode.expectedHash = m_codeHash;
 }
 
-bool CodeInjector::Enable() {
+bool CodeInjector::PrepareEnable(PatchTransaction& transaction) {
     if (m_enabled || m_allocatedMemory == 0) {
         return false;
     }
 
-    BYTE hookCode[64];
-    int codeSize;
-    QWORD returnAddr = m_injectionPoint + m_originalBytesCount;
-
-    // 根据Hook类型生成不同的Hook代码
-    if (m_hookType == HookType::Weapon) {
-        codeSize = GenerateWeaponHookCode(hookCode, returnAddr);
-    } else {
-        codeSize = GenerateArmorHookCode(hookCode, returnAddr);
+    uint8_t hookCode[HOOK_CODE_SLOT_SIZE];
+    int codeSize = GenerateHookCode(hookCode, sizeof(hookCode));
+    if (codeSize == 0) {
+        return false;
     }
 
-    // 写入 hook 代码到分配的内存
-    SIZE_T bytesWritten;
-    if (!WriteProcessMemory(m_process, (LPVOID)m_allocatedMemory, hookCode, codeSize, &bytesWritten)) {
+    // 写入 hook 代码到分配的内存 (注入点改写之前游戏不会执行到这里，不需要事务)
+    if (!m_memory->Write(m_allocatedMemory, hookCode, codeSize)) {
         return false;
     }
+    m_instrumented = m_statsAddress != 0;
+    m_codeSize = (uint32_t)codeSize;
+    m_codeHash = HashResidentBytes(hookCode, codeSize);
 
     /*
     注入点修改:
@@ -240,91 +273,113 @@ bool CodeInjector::Enable() {
     注意: 如果距离超过 2GB，相对跳转会失败
     */
 
-    // 计算相对偏移
-    int64_t relOffset = (int64_t)m_allocatedMemory - (int64_t)(m_injectionPoint + 5);
+    // 构建跳转代码，用NOP填充剩余字节
+    X64Emitter jump(m_jumpBytes, sizeof(m_jumpBytes), m_injectionPoint);
+    jump.JmpRel32(m_allocatedMemory);
+    jump.Nop(m_originalBytesCount - X64Emitter::JMP_REL32_SIZE);
 
-    // 检查是否在 32 位有符号整数范围内
-    if (relOffset < INT32_MIN || relOffset > INT32_MAX) {
+    // 距离超过 2GB 时相对跳转无法到达
+    if (!jump.Ok()) {
         return false;
     }
 
-    // 构建跳转代码
-    BYTE jumpCode[16];
-    jumpCode[0] = 0xE9; // jmp rel32
-    int32_t rel32 = (int32_t)relOffset;
-    memcpy(&jumpCode[1], &rel32, 4);
-
-    // 用NOP填充剩余字节
-    for (int i = 5; i < m_originalBytesCount; i++) {
-        jumpCode[i] = 0x90; // nop
-    }
-
-    // 修改内存保护
-    DWORD oldProtect;
-    if (!VirtualProtectEx(m_process, (LPVOID)m_injectionPoint, m_originalBytesCount, PAGE_EXECUTE_READWRITE, &oldProtect)) {
-        return false;
-    }
+    // 注入点必须仍是备份时的原始指令
+    transaction.Add(m_injectionPoint, m_jumpBytes, m_originalBytes, m_originalBytesCount);
+    return true;
+}
 
-    // 写入跳转代码
-    if (!WriteProcessMemory(m_process, (LPVOID)m_injectionPoint, jumpCode, m_originalBytesCount, &bytesWritten)) {
-        VirtualProtectEx(m_process, (LPVOID)m_injectionPoint, m_originalBytesCount, oldProtect, &oldProtect);
+bool CodeInjector::PrepareDisable(PatchTransaction& transaction) {
+    if (!m_enabled || m_foreign) {
         return false;
     }
 
-    // 恢复内存保护
-    VirtualProtectEx(m_process, (LPVOID)m_injectionPoint, m_originalBytesCount, oldProtect, &oldProtect);
-
-    m_enabled = true;
+    // 恢复原始代码
+    transaction.Add(m_injectionPoint, m_originalBytes, m_jumpBytes, m_originalBytesCount);
     return true;
 }
 
-bool CodeInjector::Disable() {
-    if (!m_enabled) {
-        return true; // 已经禁用
+void CodeInjector::SetEnabled(bool enabled) {
+    if (enabled == m_enabled) {
+        return;
     }
 
-    // 恢复原始代码
-    DWORD oldProtect;
-    if (!VirtualProtectEx(m_process, (LPVOID)m_injectionPoint, m_originalBytesCount, PAGE_EXECUTE_READWRITE, &oldProtect)) {
-        return false;
+    auto now = std::chrono::steady_clock::now();
+    if (enabled) {
+        m_enabledSince = now;
+    } else {
+        m_hookedTime += now - m_enabledSince;
     }
+    m_enabled = enabled;
+}
 
-    SIZE_T bytesWritten;
-    bool success = WriteProcessMemory(m_process, (LPVOID)m_injectionPoint, m_originalBytes, m_originalBytesCount, &bytesWritten);
+uint64_t CodeInjector::GetHookedMilliseconds() const {
+    auto total = m_hookedTime;
+    if (m_enabled) {
+        total += std::chrono::steady_clock::now() - m_enabledSince;
+    }
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(total).count();
+}
 
-    VirtualProtectEx(m_process, (LPVOID)m_injectionPoint, m_originalBytesCount, oldProtect, &oldProtect);
+void CodeInjector::ResetHookedTime() {
+    m_hookedTime = std::chrono::steady_clock::duration(0);
+    m_enabledSince = std::chrono::steady_clock::now();
+}
 
-    if (success) {
-        m_enabled = false;
+bool CodeInjector::Enable() {
+    PatchTransaction transaction(m_memory);
+    if (!PrepareEnable(transaction) || !transaction.Commit()) {
+        return false;
     }
 
-    return success;
+    SetEnabled(true);
+    return true;
 }
 
-QWORD CodeInjector::GetEquipmentBase() const {
-    if (!m_enabled || m_equipmentVarAddr == 0) {
-        return 0;
+bool CodeInjector::Disable() {
+    if (!m_enabled) {
+        return true; // 已经禁用
+    }
+    if (m_foreign) {
+        return false;
     }
 
-    QWORD value = 0;
-    SIZE_T bytesRead;
-    if (ReadProcessMemory(m_process, (LPCVOID)m_equipmentVarAddr, &value, sizeof(value), &bytesRead)) {
-        return value;
+    PatchTransaction transaction(m_memory);
+    if (!PrepareDisable(transaction) || !transaction.Commit()) {
+        return false;
     }
-    return 0;
+
+    SetEnabled(false);
+    return true;
 }
 
 void CodeInjector::Cleanup() {
-    if (m_enabled) {
-        Disable();
+    // 被改写或没能恢复的注入点可能仍跳向 hook 代码，槽位不能归还
+    if (m_foreign || (m_enabled && !Disable())) {
+        Abandon();
+        return;
     }
 
-    if (m_allocatedMemory != 0 && m_process != nullptr) {
-        VirtualFreeEx(m_process, (LPVOID)m_allocatedMemory, 0, MEM_RELEASE);
-        m_allocatedMemory = 0;
+    if (m_arena != nullptr && m_allocatedMemory != 0) {
+        m_arena->Free(m_allocatedMemory);
     }
 
-    m_equipmentVarAddr = 0;
-    m_process = nullptr;
+    m_allocatedMemory = 0;
+    m_ringAddress = 0;
+    m_mailboxAddress = 0;
+    m_statsAddress = 0;
+    m_memory = nullptr;
+    m_arena = nullptr;
+    m_injectionPoint = 0;
+}
+
+void CodeInjector::Abandon() {
+    SetEnabled(false);
+    m_foreign = false;
+    m_allocatedMemory = 0;
+    m_ringAddress = 0;
+    m_mailboxAddress = 0;
+    m_statsAddress = 0;
+    m_memory = nullptr;
+    m_arena = nullptr;
     m_injectionPoint = 0;
 }
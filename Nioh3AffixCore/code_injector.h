@@ -1,14 +1,21 @@
 #pragma once
 
-#include <windows.h>
-#include <cstdint>
+#include "capture_ring.h"
+#include "edit_mailbox.h"
+#include "hook_stats.h"
+#include "integrity_monitor.h"
+#include "process_memory.h"
+#include "remote_arena.h"
+#include "resident_cave.h"
+#include <chrono>
 
-typedef uint64_t QWORD;
+class PatchTransaction;
 
 // Hook类型枚举
+// 被覆盖的原始指令由 x64_decoder 解码和搬移，注入点可以是任意指令边界
 enum class HookType {
-    Weapon,  // 武器Hook: 捕获rbp, 6字节原始指令
-    Armor    // 装备Hook: 捕获rbx, 8字节原始指令
+    Weapon,  // 武器Hook: 捕获rbp
+    Armor    // 装备Hook: 捕获rbx，容器捕获时同时记录r12 (原始指令 lea rcx,[r12+148] 中的容器)
 };
 
 // 代码注入器类
@@ -18,10 +25,22 @@ public:
     ~CodeInjector();
 
     // 初始化注入器
-    // process: 目标进程句柄
+    // memory: 目标进程内存接口
+    // arena: 会话的代码洞分配器 (hook 代码从中分配)
+    // ring: 会话的捕获环形缓冲区 (hook 把捕获的装备基址追加到其中)
+    // mailbox: 会话的编辑信箱 (可为空；hook 在捕获到匹配的基址时应用其中的写入)
     // injectionPoint: 注入点地址 (AOB 扫描结果)
     // hookType: Hook类型 (武器或装备)
-    bool Initialize(HANDLE process, QWORD injectionPoint, HookType hookType = HookType::Weapon);
+    bool Initialize(ProcessMemory* memory, RemoteArena* arena, const CaptureRing* ring, const EditMailbox* mailbox,
+        QWORD injectionPoint, HookType hookType = HookType::Weapon);
+
+    // 接管常驻代码洞中仍然完好的 hook (见 resident_cave.h)，成功后处于启用状态
+    // record 必须已经通过 CheckResidentHook 校验；ring / mailbox 必须是 hook 代码引用的数据块
+    bool Adopt(ProcessMemory* memory, RemoteArena* arena, const CaptureRing* ring, const EditMailbox* mailbox,
+        const ResidentHookRecord& record);
+
+    // 填写常驻头部中该 hook 的记录，未启用时返回 false
+    bool Describe(ResidentHookRecord& outRecord) const;
 
     // 启用 hook
     bool Enable();
@@ -29,33 +48,86 @@ public:
     // 禁用 hook (恢复原始代码)
     bool Disable();
 
-    // 获取捕获的装备基址
-    QWORD GetEquipmentBase() const;
+    // 把启用/禁用的注入点改写加入事务，由调用者统一提交，提交成功后调用 SetEnabled
+    // PrepareEnable 会先写入 hook 代码
+    bool PrepareEnable(PatchTransaction& transaction);
+    bool PrepareDisable(PatchTransaction& transaction);
+    void SetEnabled(bool enabled);
 
     // 是否已启用
     bool IsEnabled() const { return m_enabled; }
 
+    // 完整性检查 (见 integrity_monitor.h): 启用时填写注入点和 hook 代码两个范围，否则 size 为 0
+    void DescribeIntegrity(IntegrityRange& outPatch, IntegrityRange& outCode) const;
+
+    // 检查结果: 注入点已是原始字节时视为已撤下；被其它程序改写时标记为 foreign，
+    // 之后拒绝撤下 (PrepareDisable/Disable 返回 false)，Cleanup 不再访问注入点和代码洞
+    void MarkReverted() { SetEnabled(false); }
+    void MarkForeign() { m_foreign = true; }
+    bool IsForeign() const { return m_foreign; }
+
+    // 插桩: slotAddress 为该 hook 的统计槽位 (见 hook_stats.h)，0 表示生成不带插桩的代码
+    // 在下一次写入 hook 代码 (Enable/PrepareEnable) 时生效；已启用的 hook 代码不会被改写
+    void SetStatsAddress(QWORD slotAddress) { m_statsAddress = slotAddress; }
+    bool IsInstrumented() const { return m_instrumented; }
+
+    // 容器捕获: 在捕获记录中同时写入拥有该装备的容器指针 (只有装备 hook 有)
+    // 与插桩相同，在下一次写入 hook 代码时生效
+    void SetOwnerCapture(bool enable) { m_captureOwner = enable; }
+    bool HasOwnerRegister() const { return m_hookType == HookType::Armor; }
+
+    // 注入点处于 hook 状态的累计时间 (毫秒，包括当前这一段)
+    uint64_t GetHookedMilliseconds() const;
+    void ResetHookedTime();
+
     // 获取Hook类型
     HookType GetHookType() const { return m_hookType; }
 
+    // hook 代码检查的编辑信箱 (0 表示不检查)
+    QWORD GetMailboxAddress() const { return m_mailboxAddress; }
+
+    // 该 hook 写入捕获环形缓冲区的来源标记 (CaptureRingLayout::SOURCE_*)
+    uint8_t GetCaptureSource() const;
+
+    // 清理资源 (恢复原始代码并把槽位还给代码洞分配器)；注入点没能恢复时同 Abandon，槽位保留
+    void Cleanup();
+
+    // 不访问目标进程，直接丢弃状态 (注入点无法恢复、代码洞必须保留时使用)
+    void Abandon();
+
 private:
-    HANDLE m_process;
+    ProcessMemory* m_memory;
+    RemoteArena* m_arena;
     QWORD m_injectionPoint;
-    QWORD m_allocatedMemory;
-    QWORD m_equipmentVarAddr;
+    QWORD m_allocatedMemory;    // hook 代码槽位 (代码区)
+    QWORD m_ringAddress;        // 捕获环形缓冲区 (数据区，会话所有)
+    QWORD m_mailboxAddress;     // 编辑信箱 (会话所有)，0 表示不检查
+    QWORD m_statsAddress;       // 命中统计槽位 (会话所有)，0 表示不插桩
+    bool m_instrumented;        // 当前写入的 hook 代码是否带插桩
+    bool m_captureOwner;        // 下一次写入的 hook 代码是否记录容器指针
     bool m_enabled;
+    bool m_foreign;             // 注入点或 hook 代码被其它程序改写
     HookType m_hookType;
 
-    // 原始代码备份 (最多16字节，支持8字节指令)
-    BYTE m_originalBytes[16];
+    // 启用时间统计
+    std::chrono::steady_clock::time_point m_enabledSince;
+    std::chrono::steady_clock::duration m_hookedTime;
+
+    // 原始代码备份 (覆盖 5 字节跳转的完整指令，最多16字节)
+    uint8_t m_originalBytes[16];
     int m_originalBytesCount;
 
-    // 清理资源
-    void Cleanup();
+    // 注入点的跳转代码 (禁用时用于校验)
+    uint8_t m_jumpBytes[16];
+
+    // 当前写入的 hook 代码的长度和哈希 (常驻头部使用)
+    uint32_t m_codeSize;
+    uint64_t m_codeHash;
 
-    // 生成武器Hook代码
-    int GenerateWeaponHookCode(BYTE* buffer, QWORD returnAddr);
+    // hook 代码槽位大小 (足够容纳寄存器保存/恢复 + 插桩 + 环形缓冲区追加代码 + 信箱应用代码 + 搬移后的原始指令 + 绝对跳转)
+    // 全部开启时约 390 字节；搬移的跳转超出 rel32 范围时每条还要多出十几字节
+    static constexpr size_t HOOK_CODE_SLOT_SIZE = 512;
 
-    // 生成装备Hook代码
-    int GenerateArmorHookCode(BYTE* buffer, QWORD returnAddr);
+    // 生成Hook代码 (武器捕获rbp，装备捕获rbx)，返回字节数，失败返回 0
+    int GenerateHookCode(uint8_t* buffer, size_t capacity);
 };
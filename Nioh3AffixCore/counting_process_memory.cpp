@@ -0,0 +1,77 @@
+#include "counting_process_memory.h"
+
+CountingProcessMemory::CountingProcessMemory(std::unique_ptr<ProcessMemory> inner)
+    : m_inner(std::move(inner))
+    , m_reads(0)
+    , m_writes(0)
+    , m_queries(0)
+    , m_protects(0)
+    , m_allocations(0)
+    , m_bytesRead(0)
+    , m_bytesWritten(0)
+    , m_failures(0)
+{
+}
+
+RemoteOpStats CountingProcessMemory::GetStats() const {
+    RemoteOpStats stats;
+    stats.reads = m_reads.load(std::memory_order_relaxed);
+    stats.writes = m_writes.load(std::memory_order_relaxed);
+    stats.queries = m_queries.load(std::memory_order_relaxed);
+    stats.protects = m_protects.load(std::memory_order_relaxed);
+    stats.allocations = m_allocations.load(std::memory_order_relaxed);
+    stats.bytesRead = m_bytesRead.load(std::memory_order_relaxed);
+    stats.bytesWritten = m_bytesWritten.load(std::memory_order_relaxed);
+    stats.failures = m_failures.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool CountingProcessMemory::Read(QWORD address, void* buffer, size_t size, size_t* bytesRead) {
+    size_t read = 0;
+    bool ok = m_inner->Read(address, buffer, size, &read);
+    m_reads.fetch_add(1, std::memory_order_relaxed);
+    m_bytesRead.fetch_add(read, std::memory_order_relaxed);
+    if (bytesRead) *bytesRead = read;
+    return Count(ok);
+}
+
+bool CountingProcessMemory::Write(QWORD address, const void* buffer, size_t size) {
+    bool ok = m_inner->Write(address, buffer, size);
+    m_writes.fetch_add(1, std::memory_order_relaxed);
+    if (ok) m_bytesWritten.fetch_add(size, std::memory_order_relaxed);
+    return Count(ok);
+}
+
+bool CountingProcessMemory::Query(QWORD address, MemoryRegion& outRegion) {
+    m_queries.fetch_add(1, std::memory_order_relaxed);
+    return Count(m_inner->Query(address, outRegion));
+}
+
+bool CountingProcessMemory::Protect(QWORD address, size_t size, uint32_t newProtect, uint32_t* oldProtect) {
+    m_protects.fetch_add(1, std::memory_order_relaxed);
+    return Count(m_inner->Protect(address, size, newProtect, oldProtect));
+}
+
+QWORD CountingProcessMemory::Allocate(QWORD preferredAddress, size_t size, uint32_t protect) {
+    m_allocations.fetch_add(1, std::memory_order_relaxed);
+    QWORD address = m_inner->Allocate(preferredAddress, size, protect);
+    Count(address != 0);
+    return address;
+}
+
+bool CountingProcessMemory::Free(QWORD address) {
+    return Count(m_inner->Free(address));
+}
+
+bool CountingProcessMemory::GetMainModule(QWORD& baseAddress, QWORD& moduleSize) {
+    return Count(m_inner->GetMainModule(baseAddress, moduleSize));
+}
+
+bool CountingProcessMemory::MapShared(QWORD preferredAddress, size_t size, SharedView& outView) {
+    // 近址搜索会逐个尝试候选地址，映射失败不计入失败数
+    bool ok = m_inner->MapShared(preferredAddress, size, outView);
+    if (ok) {
+        m_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return ok;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "process_memory.h"
+#include <atomic>
+#include <memory>
+
+// 远程操作统计
+struct RemoteOpStats {
+    uint64_t reads = 0;
+    uint64_t writes = 0;
+    uint64_t queries = 0;
+    uint64_t protects = 0;
+    uint64_t allocations = 0;
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t failures = 0;
+};
+
+// 统计远程操作次数的后端装饰器，会话用它向状态页发布计数
+class CountingProcessMemory : public ProcessMemory {
+public:
+    explicit CountingProcessMemory(std::unique_ptr<ProcessMemory> inner);
+
+    ProcessMemory* GetInner() const { return m_inner.get(); }
+    RemoteOpStats GetStats() const;
+
+    bool Read(QWORD address, void* buffer, size_t size, size_t* bytesRead = nullptr) override;
+    bool Write(QWORD address, const void* buffer, size_t size) override;
+    bool Query(QWORD address, MemoryRegion& outRegion) override;
+    bool Protect(QWORD address, size_t size, uint32_t newProtect, uint32_t* oldProtect) override;
+    QWORD Allocate(QWORD preferredAddress, size_t size, uint32_t protect) override;
+    bool Free(QWORD address) override;
+    bool GetMainModule(QWORD& baseAddress, QWORD& moduleSize) override;
+    bool CanMapShared() const override { return m_inner->CanMapShared(); }
+    bool MapShared(QWORD preferredAddress, size_t size, SharedView& outView) override;
+    void UnmapShared(SharedView& view) override { m_inner->UnmapShared(view); }
+    bool SuspendThreads(std::vector<QWORD>* outInstructionPointers) override { return m_inner->SuspendThreads(outInstructionPointers); }
+    void ResumeThreads() override { m_inner->ResumeThreads(); }
+    void MarkPhase(const char* phase) override { m_inner->MarkPhase(phase); }
+
+private:
+    std::unique_ptr<ProcessMemory> m_inner;
+
+    std::atomic<uint64_t> m_reads;
+    std::atomic<uint64_t> m_writes;
+    std::atomic<uint64_t> m_queries;
+    std::atomic<uint64_t> m_protects;
+    std::atomic<uint64_t> m_allocations;
+    std::atomic<uint64_t> m_bytesRead;
+    std::atomic<uint64_t> m_bytesWritten;
+    std::atomic<uint64_t> m_failures;
+
+    bool Count(bool ok) {
+        if (!ok) m_failures.fetch_add(1, std::memory_order_relaxed);
+        return ok;
+    }
+};
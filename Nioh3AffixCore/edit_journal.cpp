@@ -0,0 +1,360 @@
+#include "edit_journal.h"
+#include <cstring>
+
+namespace {
+    // 日志文件头
+    constexpr uint32_t JOURNAL_FILE_MAGIC = 0x4A45334E;   // "N3EJ"
+    constexpr uint32_t JOURNAL_FILE_VERSION = 1;
+
+    uint16_t ReadU16(const uint8_t* p) {
+        uint16_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    void AppendU16(std::vector<uint8_t>& data, uint16_t value) {
+        uint8_t bytes[2];
+        memcpy(bytes, &value, sizeof(value));
+        data.insert(data.end(), bytes, bytes + 2);
+    }
+
+    // 遍历一步中的所有段: fn(offset, length, before, after)
+    template <typename Fn>
+    void ForEachRun(const std::vector<uint8_t>& data, Fn fn) {
+        size_t pos = 0;
+        while (pos + 4 <= data.size()) {
+            uint16_t offset = ReadU16(&data[pos]);
+            uint16_t length = ReadU16(&data[pos + 2]);
+            const uint8_t* before = &data[pos + 4];
+            const uint8_t* after = before + length;
+            fn(offset, length, before, after);
+            pos += 4 + (size_t)length * 2;
+        }
+    }
+
+    // 把一组段覆盖的范围合成到补丁中 (先计算范围，再按顺序套用)
+    void BeginPatch(JournalPatch& patch, uint32_t lo, uint32_t hi) {
+        patch.offset = lo;
+        patch.bytes.assign(hi - lo, 0);
+        patch.mask.assign(hi - lo, 0);
+    }
+
+    size_t StepCost(const std::vector<uint8_t>& data) {
+        return data.size() + sizeof(uint64_t) + sizeof(std::vector<uint8_t>);
+    }
+}
+
+EditJournal::EditJournal()
+    : m_nextSequence(1)
+    , m_memoryLimit(DEFAULT_MEMORY_LIMIT)
+    , m_memoryUsage(0)
+    , m_file(nullptr)
+{
+}
+
+EditJournal::~EditJournal() {
+    CloseFile();
+}
+
+size_t EditJournal::HistoryOverhead(const History& history) {
+    return sizeof(History) + history.original.size() + history.originalKnown.size();
+}
+
+void EditJournal::Record(QWORD base, uint32_t offset, const uint8_t* before, const uint8_t* after, size_t size) {
+    if (size == 0 || offset + size > 0xFFFF) {
+        return;
+    }
+
+    // 差分: 只保存变化的字节段。未变化的字节即使夹在两段之间也不并入，
+    // 否则撤销/重做会把记录时的旧值写回游戏之后改写过的字节
+    std::vector<uint8_t> data;
+    size_t i = 0;
+    while (i < size) {
+        if (before[i] == after[i]) {
+            i++;
+            continue;
+        }
+
+        size_t start = i;
+        size_t end = i + 1;
+        while (end < size && before[end] != after[end]) {
+            end++;
+        }
+
+        size_t length = end - start;
+        AppendU16(data, (uint16_t)(offset + start));
+        AppendU16(data, (uint16_t)length);
+        data.insert(data.end(), before + start, before + end);
+        data.insert(data.end(), after + start, after + end);
+        i = end;
+    }
+
+    if (data.empty()) {
+        return;
+    }
+
+    auto inserted = m_histories.emplace(base, History());
+    History& history = inserted.first->second;
+    if (inserted.second) {
+        m_memoryUsage += HistoryOverhead(history);
+    }
+
+    // 丢弃重做分支
+    while (history.steps.size() > history.cursor) {
+        m_memoryUsage -= StepCost(history.steps.back().data);
+        history.steps.pop_back();
+    }
+
+    // 记录首次所见的字节
+    size_t overheadBefore = HistoryOverhead(history);
+    ForEachRun(data, [&](uint16_t runOffset, uint16_t length, const uint8_t* runBefore, const uint8_t*) {
+        size_t runEnd = (size_t)runOffset + length;
+        if (history.original.size() < runEnd) {
+            history.original.resize(runEnd, 0);
+            history.originalKnown.resize(runEnd, 0);
+        }
+        for (size_t k = 0; k < length; k++) {
+            if (!history.originalKnown[runOffset + k]) {
+                history.original[runOffset + k] = runBefore[k];
+                history.originalKnown[runOffset + k] = 1;
+            }
+        }
+    });
+    m_memoryUsage += HistoryOverhead(history) - overheadBefore;
+
+    AppendToFile(FILE_RECORD_STEP, base, data.data(), (uint32_t)data.size());
+
+    m_memoryUsage += StepCost(data);
+    history.steps.push_back(Step{ m_nextSequence++, std::move(data) });
+    history.cursor = history.steps.size();
+
+    EnforceLimit();
+}
+
+int EditJournal::GetUndoDepth(QWORD base) const {
+    auto it = m_histories.find(base);
+    return it == m_histories.end() ? 0 : (int)it->second.cursor;
+}
+
+int EditJournal::GetRedoDepth(QWORD base) const {
+    auto it = m_histories.find(base);
+    return it == m_histories.end() ? 0 : (int)(it->second.steps.size() - it->second.cursor);
+}
+
+int EditJournal::PrepareUndo(QWORD base, int steps, JournalPatch& outPatch) const {
+    outPatch = JournalPatch();
+
+    auto it = m_histories.find(base);
+    if (it == m_histories.end() || steps <= 0) {
+        return 0;
+    }
+
+    const History& history = it->second;
+    size_t count = (size_t)steps < history.cursor ? (size_t)steps : history.cursor;
+    if (count == 0) {
+        return 0;
+    }
+
+    uint32_t lo = 0xFFFF;
+    uint32_t hi = 0;
+    for (size_t s = history.cursor - count; s < history.cursor; s++) {
+        ForEachRun(history.steps[s].data, [&](uint16_t offset, uint16_t length, const uint8_t*, const uint8_t*) {
+            if (offset < lo) lo = offset;
+            if ((uint32_t)offset + length > hi) hi = (uint32_t)offset + length;
+        });
+    }
+
+    // 从新到旧套用 before，较旧步骤的前像覆盖较新步骤的
+    BeginPatch(outPatch, lo, hi);
+    for (size_t s = history.cursor; s > history.cursor - count; s--) {
+        ForEachRun(history.steps[s - 1].data, [&](uint16_t offset, uint16_t length, const uint8_t* before, const uint8_t*) {
+            memcpy(&outPatch.bytes[offset - lo], before, length);
+            memset(&outPatch.mask[offset - lo], 1, length);
+        });
+    }
+
+    return (int)count;
+}
+
+int EditJournal::PrepareRedo(QWORD base, int steps, JournalPatch& outPatch) const {
+    outPatch = JournalPatch();
+
+    auto it = m_histories.find(base);
+    if (it == m_histories.end() || steps <= 0) {
+        return 0;
+    }
+
+    const History& history = it->second;
+    size_t available = history.steps.size() - history.cursor;
+    size_t count = (size_t)steps < available ? (size_t)steps : available;
+    if (count == 0) {
+        return 0;
+    }
+
+    uint32_t lo = 0xFFFF;
+    uint32_t hi = 0;
+    for (size_t s = history.cursor; s < history.cursor + count; s++) {
+        ForEachRun(history.steps[s].data, [&](uint16_t offset, uint16_t length, const uint8_t*, const uint8_t*) {
+            if (offset < lo) lo = offset;
+            if ((uint32_t)offset + length > hi) hi = (uint32_t)offset + length;
+        });
+    }
+
+    // 从旧到新套用 after
+    BeginPatch(outPatch, lo, hi);
+    for (size_t s = history.cursor; s < history.cursor + count; s++) {
+        ForEachRun(history.steps[s].data, [&](uint16_t offset, uint16_t length, const uint8_t*, const uint8_t* after) {
+            memcpy(&outPatch.bytes[offset - lo], after, length);
+            memset(&outPatch.mask[offset - lo], 1, length);
+        });
+    }
+
+    return (int)count;
+}
+
+void EditJournal::CommitUndo(QWORD base, int steps) {
+    auto it = m_histories.find(base);
+    if (it == m_histories.end() || steps <= 0) {
+        return;
+    }
+
+    History& history = it->second;
+    size_t count = (size_t)steps < history.cursor ? (size_t)steps : history.cursor;
+    history.cursor -= count;
+
+    uint32_t value = (uint32_t)count;
+    AppendToFile(FILE_RECORD_UNDO, base, reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+}
+
+void EditJournal::CommitRedo(QWORD base, int steps) {
+    auto it = m_histories.find(base);
+    if (it == m_histories.end() || steps <= 0) {
+        return;
+    }
+
+    History& history = it->second;
+    size_t available = history.steps.size() - history.cursor;
+    size_t count = (size_t)steps < available ? (size_t)steps : available;
+    history.cursor += count;
+
+    uint32_t value = (uint32_t)count;
+    AppendToFile(FILE_RECORD_REDO, base, reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+}
+
+bool EditJournal::PrepareRestore(QWORD base, JournalPatch& outPatch) const {
+    outPatch = JournalPatch();
+
+    auto it = m_histories.find(base);
+    if (it == m_histories.end()) {
+        return false;
+    }
+
+    const History& history = it->second;
+    uint32_t lo = 0xFFFF;
+    uint32_t hi = 0;
+    for (uint32_t k = 0; k < (uint32_t)history.originalKnown.size(); k++) {
+        if (history.originalKnown[k]) {
+            if (k < lo) lo = k;
+            hi = k + 1;
+        }
+    }
+    if (hi == 0) {
+        return false;
+    }
+
+    BeginPatch(outPatch, lo, hi);
+    memcpy(outPatch.bytes.data(), &history.original[lo], hi - lo);
+    memcpy(outPatch.mask.data(), &history.originalKnown[lo], hi - lo);
+    return true;
+}
+
+void EditJournal::Clear() {
+    m_histories.clear();
+    m_memoryUsage = 0;
+}
+
+void EditJournal::SetMemoryLimit(size_t bytes) {
+    m_memoryLimit = bytes;
+    EnforceLimit();
+}
+
+void EditJournal::EnforceLimit() {
+    while (m_memoryUsage > m_memoryLimit && !m_histories.empty()) {
+        // 找全局最旧的一步
+        auto oldest = m_histories.end();
+        for (auto it = m_histories.begin(); it != m_histories.end(); ++it) {
+            if (it->second.steps.empty()) {
+                continue;
+            }
+            if (oldest == m_histories.end() || it->second.steps.front().sequence < oldest->second.steps.front().sequence) {
+                oldest = it;
+            }
+        }
+
+        if (oldest == m_histories.end()) {
+            // 只剩原始值，整条记录淘汰
+            m_memoryUsage -= HistoryOverhead(m_histories.begin()->second);
+            m_histories.erase(m_histories.begin());
+            continue;
+        }
+
+        // 有可撤销的步骤时淘汰最旧的撤销步骤；全部已撤销时 steps[0] 是下一个重做步骤，
+        // 淘汰它会让之后的重做套用在错误的状态上，改为淘汰最远的重做步骤
+        History& history = oldest->second;
+        if (history.cursor > 0) {
+            m_memoryUsage -= StepCost(history.steps.front().data);
+            history.steps.pop_front();
+            history.cursor--;
+        } else {
+            m_memoryUsage -= StepCost(history.steps.back().data);
+            history.steps.pop_back();
+        }
+    }
+}
+
+bool EditJournal::OpenFile(const char* path) {
+    CloseFile();
+
+    if (path == nullptr || path[0] == '\0') {
+        return false;
+    }
+
+    m_file = fopen(path, "ab");
+    if (m_file == nullptr) {
+        return false;
+    }
+
+    // 新文件写入文件头
+    if (fseek(m_file, 0, SEEK_END) == 0 && ftell(m_file) == 0) {
+        uint32_t header[2] = { JOURNAL_FILE_MAGIC, JOURNAL_FILE_VERSION };
+        fwrite(header, sizeof(header), 1, m_file);
+        fflush(m_file);
+    }
+    return true;
+}
+
+void EditJournal::CloseFile() {
+    if (m_file != nullptr) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+// 文件记录: [u8 kind][u8 reserved * 3][u32 size][u64 base][payload * size]
+void EditJournal::AppendToFile(FileRecordKind kind, QWORD base, const uint8_t* data, uint32_t size) {
+    if (m_file == nullptr) {
+        return;
+    }
+
+    uint8_t header[16] = {};
+    header[0] = (uint8_t)kind;
+    memcpy(&header[4], &size, sizeof(size));
+    memcpy(&header[8], &base, sizeof(base));
+
+    if (fwrite(header, sizeof(header), 1, m_file) != 1 || (size != 0 && fwrite(data, size, 1, m_file) != 1)) {
+        // 写失败 (磁盘满等) 时停止记录，不影响内存中的历史
+        CloseFile();
+        return;
+    }
+    fflush(m_file);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <vector>
+
+typedef uint64_t QWORD;
+
+// 待写回目标进程的字节补丁
+// bytes/mask 覆盖 [offset, offset + bytes.size())，mask 为 0 的字节保持目标进程中的原值
+struct JournalPatch {
+    uint32_t offset = 0;
+    std::vector<uint8_t> bytes;
+    std::vector<uint8_t> mask;
+
+    bool IsEmpty() const { return bytes.empty(); }
+};
+
+// 编辑日志
+// 会话在每次写入装备记录前把前像/后像交给日志，日志按装备基址保存差分历史:
+//   - 每一步只保存发生变化的字节段 (before/after)，段之间未变化的字节不保存，撤销/重做不会写它们
+//   - 撤销/重做 N 步时把 N 步合成为一个补丁，会话一次读 + 一次写完成
+//   - 每个字节第一次被修改前的值记为 "原始值"，恢复原始状态同样是一次写入
+//   - 历史占用超过上限时淘汰全局最旧的步骤 (全部已撤销的记录淘汰最远的重做步骤；原始值不淘汰，除非整条记录被淘汰)
+//   - 可选地把每一步追加到日志文件 (只追加，不回读)
+// 日志本身不访问目标进程，线程安全由会话锁保证。
+class EditJournal {
+public:
+    static constexpr size_t DEFAULT_MEMORY_LIMIT = 1024 * 1024;
+
+    EditJournal();
+    ~EditJournal();
+
+    EditJournal(const EditJournal&) = delete;
+    EditJournal& operator=(const EditJournal&) = delete;
+
+    // 记录一次写入；offset 为 before/after 相对装备基址的偏移，两者相同时不记录
+    void Record(QWORD base, uint32_t offset, const uint8_t* before, const uint8_t* after, size_t size);
+
+    int GetUndoDepth(QWORD base) const;
+    int GetRedoDepth(QWORD base) const;
+
+    // 合成撤销/重做 steps 步的补丁，返回实际步数 (不移动游标，写入成功后再调用 Commit*)
+    int PrepareUndo(QWORD base, int steps, JournalPatch& outPatch) const;
+    int PrepareRedo(QWORD base, int steps, JournalPatch& outPatch) const;
+    void CommitUndo(QWORD base, int steps);
+    void CommitRedo(QWORD base, int steps);
+
+    // 合成恢复到首次所见状态的补丁；没有修改过时返回 false
+    bool PrepareRestore(QWORD base, JournalPatch& outPatch) const;
+
+    // 丢弃全部历史 (例如目标进程分离后基址失效)
+    void Clear();
+
+    // 历史占用上限 (字节)，0 表示不保留历史
+    void SetMemoryLimit(size_t bytes);
+    size_t GetMemoryLimit() const { return m_memoryLimit; }
+    size_t GetMemoryUsage() const { return m_memoryUsage; }
+
+    // 日志文件 (追加写入)
+    bool OpenFile(const char* path);
+    void CloseFile();
+    bool IsFileOpen() const { return m_file != nullptr; }
+
+private:
+    // 一步编辑: data 中依次为若干段 [u16 offset][u16 length][before * length][after * length]
+    struct Step {
+        uint64_t sequence;
+        std::vector<uint8_t> data;
+    };
+
+    struct History {
+        std::deque<Step> steps;
+        size_t cursor = 0;                  // steps[0, cursor) 可撤销，[cursor, size) 可重做
+        std::vector<uint8_t> original;      // 首次所见的字节
+        std::vector<uint8_t> originalKnown; // original 中哪些字节有效
+    };
+
+    std::map<QWORD, History> m_histories;
+    uint64_t m_nextSequence;
+    size_t m_memoryLimit;
+    size_t m_memoryUsage;
+    FILE* m_file;
+
+    enum FileRecordKind : uint8_t {
+        FILE_RECORD_STEP = 1,
+        FILE_RECORD_UNDO = 2,
+        FILE_RECORD_REDO = 3
+    };
+
+    static size_t HistoryOverhead(const History& history);
+    void EnforceLimit();
+    void AppendToFile(FileRecordKind kind, QWORD base, const uint8_t* data, uint32_t size);
+};
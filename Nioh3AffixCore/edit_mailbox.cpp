@@ -0,0 +1,277 @@
+#include "edit_mailbox.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <thread>
+
+namespace {
+    // 信箱头部中由 hook 写入或认领的字 (一次读取)
+    struct MailboxHeader {
+        uint64_t ack;
+        uint64_t claim;
+        uint64_t withdrawn;
+        uint64_t cancel;
+    };
+
+    static_assert(sizeof(MailboxHeader) == offsetof(EditMailboxBlock, base), "edit mailbox layout changed");
+
+    // 批次 posted 的状态；cancelled 为工具已写入的 cancel
+    MailboxBatchState ResolveBatch(const MailboxHeader& header, uint64_t posted, uint64_t cancelled) {
+        if (header.ack == posted) {
+            return MAILBOX_BATCH_APPLIED;
+        }
+        if (header.withdrawn == posted || (posted <= cancelled && header.claim != posted)) {
+            return MAILBOX_BATCH_WITHDRAWN;
+        }
+        return MAILBOX_BATCH_PENDING;
+    }
+}
+
+EditMailbox::EditMailbox()
+    : m_posted(0)
+    , m_cancelled(0)
+    , m_state(MAILBOX_BATCH_APPLIED)
+    , m_postedCount(0)
+{
+}
+
+EditMailbox::~EditMailbox() {
+    Release();
+}
+
+bool EditMailbox::Initialize(ProcessMemory* memory, RemoteArena* arena, bool allowShared) {
+    Release();
+    return m_block.Initialize(memory, arena, sizeof(EditMailboxBlock), allowShared);
+}
+
+void EditMailbox::Release() {
+    m_block.Release();
+    Abandon();
+}
+
+void EditMailbox::Abandon() {
+    m_block.Abandon();
+    m_posted = 0;
+    m_cancelled = 0;
+    m_state = MAILBOX_BATCH_APPLIED;
+    m_postedCount = 0;
+}
+
+bool EditMailbox::Adopt(ProcessMemory* memory, RemoteArena* arena, QWORD address) {
+    Release();
+
+    EditMailboxBlock block;
+    if (!m_block.Adopt(memory, arena, address, sizeof(EditMailboxBlock)) || !m_block.Read(0, &block, sizeof(block))) {
+        m_block.Release();
+        return false;
+    }
+
+    // 上一次会话撤回时已经认领的批次在这里得到结果
+    MailboxHeader header = { block.ack, block.claim, block.withdrawn, block.cancel };
+    m_posted = block.post;
+    m_cancelled = block.cancel;
+    m_state = ResolveBatch(header, m_posted, m_cancelled);
+    m_postedCount = m_state == MAILBOX_BATCH_PENDING ? (int)block.count : 0;
+    return true;
+}
+
+bool EditMailbox::EmitApply(X64Emitter& emitter, QWORD mailboxAddress, X64Reg capturedRegister) {
+    /*
+        4C 8B 0D [post]         ; mov r9, [rip+post]            P，之后不再读 post
+        48 8B 05 [claim]        ; mov rax, [rip+claim]
+        49 39 C1                ; cmp r9, rax
+        0F 84 [done]            ; je done                       没有待认领的批次
+        48 3B xx [base]         ; cmp 捕获的寄存器, [rip+base]
+        0F 85 [done]            ; jne done
+        F0 4C 0F B1 0D [claim]  ; lock cmpxchg [rip+claim], r9  认领 (claim 仍是读到的值时置为 P)
+        0F 85 [done]            ; jne done                      其它线程已认领
+        4C 3B 0D [cancel]       ; cmp r9, [rip+cancel]
+        0F 86 [withdrawn]       ; jbe withdrawn                 P <= cancel: 已撤回
+        48 8B 0D [count]        ; mov rcx, [rip+count]
+        48 8D 15 [edits]        ; lea rdx, [rip+edits]
+    next:
+        48 85 C9                ; test rcx, rcx
+        0F 84 [finish]          ; je finish
+        4C 8B 02                ; mov r8, [rdx+offset]
+        4C 01 xx                ; add r8, 捕获的寄存器
+    retry:
+        49 8B 00                ; mov rax, [r8]
+        4C 8B C8                ; mov r9, rax
+        4C 33 4A 10             ; xor r9, [rdx+value]
+        4C 23 4A 08             ; and r9, [rdx+mask]
+        4C 31 C1                ; xor r9, rax          -> old ^ ((old ^ value) & mask)
+        F0 4D 0F B1 08          ; lock cmpxchg [r8], r9
+        0F 85 [retry]           ; jne retry            (期间被其它线程改写)
+        48 83 C2 18             ; add rdx, 24
+        48 FF C9                ; dec rcx
+        E9 [next]               ; jmp next
+    finish:
+        48 8B 05 [claim]        ; mov rax, [rip+claim]          仍是 P: 本线程认领后 claim 只能在 ack 之后改变
+        48 89 05 [ack]          ; mov [rip+ack], rax
+        E9 [done]               ; jmp done
+    withdrawn:
+        4C 89 0D [withdrawn]    ; mov [rip+withdrawn], r9
+    done:
+    */
+    switch (capturedRegister) {
+    case X64Reg::Rax:
+    case X64Reg::Rcx:
+    case X64Reg::Rdx:
+    case X64Reg::R8:
+    case X64Reg::R9:
+    case X64Reg::Rsp:
+        return false;
+    default:
+        break;
+    }
+
+    QWORD post = mailboxAddress + offsetof(EditMailboxBlock, post);
+    QWORD ack = mailboxAddress + offsetof(EditMailboxBlock, ack);
+    QWORD claim = mailboxAddress + offsetof(EditMailboxBlock, claim);
+
+    X64Label next, retry, finish, withdrawn, done;
+
+    emitter.MovRipLoad(X64Reg::R9, post);
+    emitter.MovRipLoad(X64Reg::Rax, claim);
+    emitter.CmpReg(X64Reg::R9, X64Reg::Rax);
+    emitter.Jcc(X64Cond::Equal, done);
+    emitter.CmpRip(capturedRegister, mailboxAddress + offsetof(EditMailboxBlock, base));
+    emitter.Jcc(X64Cond::NotEqual, done);
+    emitter.LockCmpxchgRip(claim, X64Reg::R9);
+    emitter.Jcc(X64Cond::NotEqual, done);
+    emitter.CmpRip(X64Reg::R9, mailboxAddress + offsetof(EditMailboxBlock, cancel));
+    emitter.Jcc(X64Cond::BelowOrEqual, withdrawn);
+    emitter.MovRipLoad(X64Reg::Rcx, mailboxAddress + offsetof(EditMailboxBlock, count));
+    emitter.LeaRip(X64Reg::Rdx, mailboxAddress + offsetof(EditMailboxBlock, edits));
+
+    emitter.Bind(next);
+    emitter.TestReg(X64Reg::Rcx, X64Reg::Rcx);
+    emitter.Jcc(X64Cond::Equal, finish);
+    emitter.MovLoad(X64Reg::R8, X64Reg::Rdx, (int32_t)offsetof(MailboxEdit, offset));
+    emitter.AddReg(X64Reg::R8, capturedRegister);
+
+    emitter.Bind(retry);
+    emitter.MovLoad(X64Reg::Rax, X64Reg::R8, 0);
+    emitter.MovReg(X64Reg::R9, X64Reg::Rax);
+    emitter.XorLoad(X64Reg::R9, X64Reg::Rdx, (int32_t)offsetof(MailboxEdit, value));
+    emitter.AndLoad(X64Reg::R9, X64Reg::Rdx, (int32_t)offsetof(MailboxEdit, mask));
+    emitter.XorReg(X64Reg::R9, X64Reg::Rax);
+    emitter.LockCmpxchg(X64Reg::R8, 0, X64Reg::R9);
+    emitter.Jcc(X64Cond::NotEqual, retry);
+    emitter.AddImm8(X64Reg::Rdx, (int8_t)sizeof(MailboxEdit));
+    emitter.Dec(X64Reg::Rcx);
+    emitter.Jmp(next);
+
+    emitter.Bind(finish);
+    emitter.MovRipLoad(X64Reg::Rax, claim);
+    emitter.MovRipStore(ack, X64Reg::Rax);
+    emitter.Jmp(done);
+
+    emitter.Bind(withdrawn);
+    emitter.MovRipStore(mailboxAddress + offsetof(EditMailboxBlock, withdrawn), X64Reg::R9);
+
+    emitter.Bind(done);
+    return emitter.Ok();
+}
+
+bool EditMailbox::BuildEdits(QWORD base, uint32_t offset, const uint8_t* bytes, const uint8_t* bitMasks, size_t size,
+    std::vector<MailboxEdit>& outEdits) {
+    // 对齐地址 -> (mask, value)
+    std::map<QWORD, std::pair<uint64_t, uint64_t>> words;
+    for (size_t i = 0; i < size; i++) {
+        if (bitMasks[i] == 0) {
+            continue;
+        }
+
+        QWORD address = base + offset + i;
+        QWORD aligned = address & ~(QWORD)7;
+        int shift = (int)(address - aligned) * 8;
+
+        auto& word = words[aligned];
+        word.first |= (uint64_t)bitMasks[i] << shift;
+        word.second |= (uint64_t)(bytes[i] & bitMasks[i]) << shift;
+    }
+
+    if (words.size() > (size_t)EditMailboxLayout::MAX_EDITS) {
+        return false;
+    }
+
+    outEdits.clear();
+    for (const auto& word : words) {
+        MailboxEdit edit;
+        edit.offset = word.first - base;
+        edit.mask = word.second.first;
+        edit.value = word.second.second;
+        outEdits.push_back(edit);
+    }
+    return true;
+}
+
+MailboxBatchState EditMailbox::Poll() {
+    if (m_state != MAILBOX_BATCH_PENDING) {
+        return m_state;
+    }
+
+    MailboxHeader header;
+    if (m_block.Read(0, &header, sizeof(header))) {
+        m_state = ResolveBatch(header, m_posted, m_cancelled);
+    }
+    return m_state;
+}
+
+int EditMailbox::GetPendingCount() {
+    return IsPending() ? m_postedCount : 0;
+}
+
+bool EditMailbox::Post(QWORD base, const std::vector<MailboxEdit>& edits) {
+    if (!m_block.IsInitialized() || edits.empty() || edits.size() > (size_t)EditMailboxLayout::MAX_EDITS || IsPending()) {
+        return false;
+    }
+
+    // 先写 base/count/edits，post 单独在之后写入: 一次远程写入内部的落地顺序没有保证
+    EditMailboxBlock block;
+    memset(&block, 0, sizeof(block));
+    block.base = base;
+    block.count = edits.size();
+    memcpy(block.edits, edits.data(), edits.size() * sizeof(MailboxEdit));
+    block.post = m_posted + 1;
+
+    const size_t begin = offsetof(EditMailboxBlock, base);
+    const size_t end = offsetof(EditMailboxBlock, post);
+    if (!m_block.Write(begin, (const uint8_t*)&block + begin, end - begin) ||
+        !m_block.Write(end, &block.post, sizeof(block.post))) {
+        return false;
+    }
+
+    m_posted = block.post;
+    m_state = MAILBOX_BATCH_PENDING;
+    m_postedCount = (int)edits.size();
+    return true;
+}
+
+MailboxBatchState EditMailbox::Cancel() {
+    if (!IsPending()) {
+        return m_state;
+    }
+
+    if (!m_block.Write(offsetof(EditMailboxBlock, cancel), &m_posted, sizeof(m_posted))) {
+        return m_state;
+    }
+    m_cancelled = m_posted;
+
+    // cancel 落地之后才能读 claim: 共享视图中由这里的 fence 保证；远程访问时读取会切换到目标进程的
+    // 地址空间 (写 CR3 是串行化指令)，写入不会被重排到之后的读取之后
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // 已认领的批次在几条指令内给出结果，除非游戏线程恰好在 hook 代码中被挂起
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(EditMailboxLayout::CANCEL_WAIT_MS);
+    m_state = MAILBOX_BATCH_PENDING;
+    while (Poll() == MAILBOX_BATCH_PENDING && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    if (m_state != MAILBOX_BATCH_PENDING) {
+        m_postedCount = 0;
+    }
+    return m_state;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "process_memory.h"
+#include "remote_arena.h"
+#include "remote_block.h"
+#include "x64_emitter.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 编辑信箱 (由所有捕获 hook 共用，传输方式同 RemoteBlock)
+//
+// 工具把一批按 8 字节对齐的掩码写入 (offset, mask, value) 连同目标基址投递到信箱，
+// 下次 hook 捕获到同一基址时由 hook 代码在游戏线程上认领并应用:
+//
+//   P = post                                       (只读一次)
+//   if (P != claim && 捕获的寄存器 == base && lock cmpxchg(claim: 读到的值 -> P)) {
+//       if (P <= cancel) { withdrawn = P; }         (认领后发现已撤回，什么都不写)
+//       else {
+//           for each edit:
+//               do { old = [base+offset]; new = old ^ ((old ^ value) & mask); } while (!lock cmpxchg)
+//           ack = P
+//       }
+//   }
+//
+// 多个游戏线程同时执行同一个 hook 时只有 cmpxchg 成功的一个线程处理这一批；批次序号只增不减，
+// 工具在一批有结果 (ack 或 withdrawn 等于它) 之前不会改写 base/edits，因此认领成功时读到的内容
+// 一定属于 P (读取之后被换成下一批的线程认领时 claim 已经变化，cmpxchg 失败)。
+// 掩码之外的位保持游戏当时的值 (cmpxchg 循环保证不会覆盖其它线程同时写入的位)。
+//
+// 投递: 先写入 base/count/edits，再单独写入 post (远程写入不保证块内按地址递增落地)。
+// 撤回: 工具先写 cancel = P，再读 claim。claim 不等于 P 时之后认领的线程一定看到 cancel，这一批已撤回；
+// 等于 P 时已有线程认领，等待它写入 ack (已应用) 或 withdrawn (已放弃)。两边都是先写后读，
+// hook 一侧由 lock cmpxchg 保证顺序，工具一侧见 Cancel。
+// 同一时刻只允许一个没有结果的批次。
+namespace EditMailboxLayout {
+    constexpr int MAX_EDITS = 32;
+    constexpr uint32_t CANCEL_WAIT_MS = 50;     // 撤回时等待已认领的批次给出结果的上限
+}
+
+#pragma pack(push, 1)
+
+struct MailboxEdit {
+    uint64_t offset;    // 相对基址，base + offset 按 8 字节对齐 (按有符号数相加)
+    uint64_t mask;
+    uint64_t value;
+};
+
+struct EditMailboxBlock {
+    uint64_t ack;                   // hook 写: 已应用的批次序号
+    uint64_t claim;                 // hook lock cmpxchg: 已认领的批次序号
+    uint64_t withdrawn;             // hook 写: 认领后因撤回而放弃的批次序号
+    uint64_t cancel;                // 工具写: 序号不大于它的批次已撤回
+    uint64_t base;                  // 以下由工具写
+    uint64_t count;
+    MailboxEdit edits[EditMailboxLayout::MAX_EDITS];
+    uint64_t post;                  // 最新投递的批次序号，与 claim 不等表示有待认领的批次
+};
+
+#pragma pack(pop)
+
+// 最近一次投递的批次的状态
+enum MailboxBatchState {
+    MAILBOX_BATCH_APPLIED = 0,      // 已由 hook 应用 (或没有投递过)
+    MAILBOX_BATCH_PENDING = 1,      // 尚无结果
+    MAILBOX_BATCH_WITHDRAWN = 2     // 已撤回，没有任何写入落地
+};
+
+static_assert(sizeof(MailboxEdit) == 24, "edit mailbox layout changed");
+static_assert(offsetof(EditMailboxBlock, base) == 32, "edit mailbox layout changed");
+static_assert(sizeof(EditMailboxBlock) % 8 == 0, "edit mailbox layout changed");
+
+class EditMailbox {
+public:
+    EditMailbox();
+    ~EditMailbox();
+
+    EditMailbox(const EditMailbox&) = delete;
+    EditMailbox& operator=(const EditMailbox&) = delete;
+
+    bool Initialize(ProcessMemory* memory, RemoteArena* arena, bool allowShared = true);
+    void Release();
+    void Abandon();
+
+    // 接管常驻代码洞中的信箱，未确认的批次保持待应用
+    bool Adopt(ProcessMemory* memory, RemoteArena* arena, QWORD address);
+
+    bool IsInitialized() const { return m_block.IsInitialized(); }
+    bool IsShared() const { return m_block.IsShared(); }
+    QWORD GetAddress() const { return m_block.GetAddress(); }
+
+    // 生成检查并应用信箱的 hook 代码
+    // 会改写 rax/rcx/rdx/r8/r9 和标志位，由调用者保存和恢复；capturedRegister 不能是这些寄存器
+    static bool EmitApply(X64Emitter& emitter, QWORD mailboxAddress, X64Reg capturedRegister);
+
+    // 把字节级的掩码写入 (bytes/bitMasks 覆盖 [base + offset, base + offset + size)) 转换为对齐的 8 字节写入
+    // 超过 MAX_EDITS 时返回 false
+    static bool BuildEdits(QWORD base, uint32_t offset, const uint8_t* bytes, const uint8_t* bitMasks, size_t size,
+        std::vector<MailboxEdit>& outEdits);
+
+    // 投递一批写入 (两次远程写入)；上一批尚无结果时返回 false
+    bool Post(QWORD base, const std::vector<MailboxEdit>& edits);
+
+    // 最近一批的状态 (尚无结果时读取信箱头部)
+    MailboxBatchState Poll();
+
+    // 是否有尚无结果的批次
+    bool IsPending() { return Poll() == MAILBOX_BATCH_PENDING; }
+
+    // 尚无结果的批次中的写入数
+    int GetPendingCount();
+
+    // 撤回尚无结果的批次 (hook 已全部禁用时调用)，返回这一批的最终状态
+    // 已被认领的批次等待 hook 给出结果，超过 CANCEL_WAIT_MS 仍没有结果时返回 PENDING (之后 Poll 会给出结果)
+    MailboxBatchState Cancel();
+
+private:
+    RemoteBlock m_block;
+    uint64_t m_posted;      // 最近投递的批次序号
+    uint64_t m_cancelled;   // 最近写入的 cancel
+    MailboxBatchState m_state;
+    int m_postedCount;
+};
@@ -0,0 +1,303 @@
+#include "equipment_scan.h"
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <mutex>
+
+// x86-64 上 SSE2 总是可用
+#if defined(__SSE2__) || defined(_M_X64)
+#define EQUIPMENT_SCAN_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // 预筛用到的第一个词条 ID 所在的 qword (相对记录开头)
+    constexpr uint32_t AFFIX_QWORD = (MemoryLayout::FIRST_AFFIX_OFFSET + MemoryLayout::AFFIX_ID_OFFSET) / 8;
+
+    static_assert(EquipmentLayout::ITEM_ID_OFFSET == 0 && EquipmentLayout::LEVEL_OFFSET == 6,
+        "the prefilter expects the item id and level in the first qword");
+    static_assert((MemoryLayout::FIRST_AFFIX_OFFSET + MemoryLayout::AFFIX_ID_OFFSET) % 8 == 0,
+        "the prefilter expects the first affix id at the start of a qword");
+    static_assert(MemoryLayout::AFFIX_LEVEL_OFFSET == MemoryLayout::AFFIX_ID_OFFSET + 4,
+        "an affix slot is read as one qword (level:id)");
+
+    template <typename T>
+    T Load(const uint8_t* data) {
+        T value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    int16_t ClampToInt16(int32_t value) {
+        return (int16_t)std::min<int32_t>(std::max<int32_t>(value, SHRT_MIN), SHRT_MAX);
+    }
+
+    bool InRange(int32_t value, int32_t low, int32_t high) {
+        return value >= low && value <= high;
+    }
+
+    bool IsAffixIdAllowed(int32_t id, const EquipmentScanConfig& config) {
+        return id == EquipmentScanLayout::EMPTY_AFFIX_ID || InRange(id, config.minAffixId, config.maxAffixId);
+    }
+
+    bool PassesPrefilter(const uint8_t* record, const EquipmentScanConfig& config) {
+        return InRange(Load<int16_t>(record + EquipmentLayout::ITEM_ID_OFFSET), config.minItemId, config.maxItemId) &&
+            InRange(Load<int16_t>(record + EquipmentLayout::LEVEL_OFFSET), config.minLevel, config.maxLevel) &&
+            IsAffixIdAllowed(Load<int32_t>(record + AFFIX_QWORD * 8), config);
+    }
+
+#ifdef EQUIPMENT_SCAN_SSE2
+    // 处理 [0, 返回值) 的位置，每次两个
+    // 16 字节 A = 第 i、i+1 个位置的第一个 qword (int16 通道 0/3、4/7 为物品 ID 和等级)，
+    // 16 字节 B = 两个位置的第 AFFIX_QWORD 个 qword (int32 通道 0、2 为第一个词条 ID)；
+    // 其余通道的范围取整个类型，总是通过，因此每个位置对应的 8 个字节掩码全为 0 即通过
+    size_t PrefilterSimd(const uint8_t* data, size_t positions, const EquipmentScanConfig& config, uint64_t* outBits) {
+        const int16_t itemLow = ClampToInt16(config.minItemId);
+        const int16_t itemHigh = ClampToInt16(config.maxItemId);
+        const int16_t levelLow = ClampToInt16(config.minLevel);
+        const int16_t levelHigh = ClampToInt16(config.maxLevel);
+        const __m128i headerLow = _mm_setr_epi16(itemLow, SHRT_MIN, SHRT_MIN, levelLow, itemLow, SHRT_MIN, SHRT_MIN, levelLow);
+        const __m128i headerHigh = _mm_setr_epi16(itemHigh, SHRT_MAX, SHRT_MAX, levelHigh, itemHigh, SHRT_MAX, SHRT_MAX, levelHigh);
+        const __m128i affixLow = _mm_setr_epi32(config.minAffixId, INT_MIN, config.minAffixId, INT_MIN);
+        const __m128i affixHigh = _mm_setr_epi32(config.maxAffixId, INT_MAX, config.maxAffixId, INT_MAX);
+        const __m128i empty = _mm_setr_epi32(EquipmentScanLayout::EMPTY_AFFIX_ID, 0, EquipmentScanLayout::EMPTY_AFFIX_ID, 0);
+        const __m128i emptyLanes = _mm_setr_epi32(-1, 0, -1, 0);
+
+        size_t i = 0;
+        for (; i + 2 <= positions; i += 2) {
+            const uint8_t* p = data + i * EquipmentScanLayout::RECORD_ALIGN;
+            __m128i header = _mm_loadu_si128((const __m128i*)p);
+            __m128i affix = _mm_loadu_si128((const __m128i*)(p + AFFIX_QWORD * 8));
+
+            __m128i headerOut = _mm_or_si128(_mm_cmpgt_epi16(headerLow, header), _mm_cmpgt_epi16(header, headerHigh));
+            __m128i affixOut = _mm_or_si128(_mm_cmpgt_epi32(affixLow, affix), _mm_cmpgt_epi32(affix, affixHigh));
+            // 空槽位 (-1) 在范围之外也通过
+            affixOut = _mm_andnot_si128(_mm_and_si128(_mm_cmpeq_epi32(affix, empty), emptyLanes), affixOut);
+
+            uint32_t fail = (uint32_t)_mm_movemask_epi8(_mm_or_si128(headerOut, affixOut));
+            uint64_t bits = ((fail & 0xFF) == 0 ? 1u : 0u) | ((fail >> 8) == 0 ? 2u : 0u);
+            outBits[i >> 6] |= bits << (i & 63);
+        }
+        return i;
+    }
+#endif
+
+    // regions 按地址排序
+    bool PointsIntoRegions(QWORD value, const std::vector<MemoryRegion>& regions) {
+        auto it = std::upper_bound(regions.begin(), regions.end(), value,
+            [](QWORD address, const MemoryRegion& region) { return address < region.baseAddress; });
+        return it != regions.begin() && value - std::prev(it)->baseAddress < std::prev(it)->regionSize;
+    }
+
+    bool HasPointerAffixes(const uint8_t* record, const std::vector<MemoryRegion>& regions) {
+        for (int slot = 0; slot < MemoryLayout::AFFIX_SLOT_COUNT; slot++) {
+            const uint8_t* field = record + MemoryLayout::GetAffixIdOffset(slot);
+            if (Load<int32_t>(field) != EquipmentScanLayout::EMPTY_AFFIX_ID && PointsIntoRegions(Load<QWORD>(field), regions)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t LowestBit(uint64_t word) {
+        return (uint32_t)std::bitset<64>((word & (0 - word)) - 1).count();
+    }
+
+    uint64_t ElapsedMicroseconds(std::chrono::steady_clock::time_point start) {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+EquipmentScanConfig NormalizeEquipmentScanConfig(const EquipmentScanConfig& config) {
+    EquipmentScanConfig normalized = config;
+    if (normalized.minItemId == 0) normalized.minItemId = 1;
+    if (normalized.maxItemId == 0) normalized.maxItemId = EquipmentScanLayout::DEFAULT_MAX_ITEM_ID;
+    if (normalized.minLevel == 0) normalized.minLevel = 1;
+    if (normalized.maxLevel == 0) normalized.maxLevel = EquipmentScanLayout::DEFAULT_MAX_LEVEL;
+    if (normalized.minAffixId == 0) normalized.minAffixId = 1;
+    if (normalized.maxAffixId == 0) normalized.maxAffixId = EquipmentScanLayout::DEFAULT_MAX_AFFIX_ID;
+    if (normalized.maxAffixLevel == 0) normalized.maxAffixLevel = EquipmentScanLayout::DEFAULT_MAX_AFFIX_LEVEL;
+    if (normalized.minAffixes == 0) normalized.minAffixes = EquipmentScanLayout::DEFAULT_MIN_AFFIXES;
+    if (normalized.maxResults == 0) normalized.maxResults = EquipmentScanLayout::DEFAULT_MAX_RESULTS;
+    normalized.minAffixes = std::min<uint32_t>(normalized.minAffixes, MemoryLayout::AFFIX_SLOT_COUNT);
+    normalized.threads = ResolveScanThreads(normalized.threads);
+    return normalized;
+}
+
+void PrefilterEquipmentRecords(const uint8_t* data, size_t positions, const EquipmentScanConfig& config,
+    uint64_t* outBits, bool useSimd) {
+    memset(outBits, 0, (positions + 63) / 64 * sizeof(uint64_t));
+
+    size_t i = 0;
+#ifdef EQUIPMENT_SCAN_SSE2
+    if (useSimd) {
+        i = PrefilterSimd(data, positions, config, outBits);
+    }
+#else
+    (void)useSimd;
+#endif
+    for (; i < positions; i++) {
+        if (PassesPrefilter(data + i * EquipmentScanLayout::RECORD_ALIGN, config)) {
+            outBits[i >> 6] |= 1ull << (i & 63);
+        }
+    }
+}
+
+bool IsPlausibleEquipmentRecord(const uint8_t* record, const EquipmentScanConfig& config) {
+    if (!PassesPrefilter(record, config)) {
+        return false;
+    }
+
+    uint32_t affixes = 0;
+    for (int slot = 0; slot < MemoryLayout::AFFIX_SLOT_COUNT; slot++) {
+        int32_t id = Load<int32_t>(record + MemoryLayout::GetAffixIdOffset(slot));
+        if (id == EquipmentScanLayout::EMPTY_AFFIX_ID) {
+            continue;
+        }
+        int32_t level = Load<int32_t>(record + MemoryLayout::GetAffixLevelOffset(slot));
+        if (!InRange(id, config.minAffixId, config.maxAffixId) || !InRange(level, 0, config.maxAffixLevel)) {
+            return false;
+        }
+        affixes++;
+    }
+    if (affixes < config.minAffixes) {
+        return false;
+    }
+
+    // 地狱武器必须带地狱技能
+    bool underworld = (record[EquipmentLayout::UNDERWORLD_FLAG_OFFSET] >> EquipmentLayout::UNDERWORLD_FLAG_BIT) & 1;
+    return !underworld || Load<int32_t>(record + EquipmentLayout::UNDERWORLD_SKILL_ID_OFFSET) > 0;
+}
+
+bool ScanEquipmentRecords(ProcessMemory* memory, const EquipmentScanConfig& requested, std::vector<QWORD>& outBases,
+    std::vector<uint8_t>& outRecords, EquipmentScanStats& outStats) {
+    auto start = std::chrono::steady_clock::now();
+    memset(&outStats, 0, sizeof(outStats));
+    outBases.clear();
+    outRecords.clear();
+
+    const EquipmentScanConfig config = NormalizeEquipmentScanConfig(requested);
+    std::vector<MemoryRegion> regions;
+    if (!CollectDataRegions(memory, config.startAddress, config.endAddress, regions)) {
+        return false;
+    }
+
+    // 每块多读一条记录的长度，块末尾的记录不会被截断
+    struct Chunk {
+        QWORD address;
+        uint32_t size;
+        uint32_t readSize;
+    };
+    std::vector<Chunk> chunks;
+    for (const MemoryRegion& region : regions) {
+        for (QWORD offset = 0; offset < region.regionSize; offset += EquipmentScanLayout::BLOCK_SIZE) {
+            QWORD remaining = region.regionSize - offset;
+            chunks.push_back({ region.baseAddress + offset,
+                (uint32_t)std::min<QWORD>(EquipmentScanLayout::BLOCK_SIZE, remaining),
+                (uint32_t)std::min<QWORD>(EquipmentScanLayout::BLOCK_SIZE + EquipmentScanLayout::RECORD_SIZE, remaining) });
+        }
+    }
+
+    struct ChunkResult {
+        std::vector<QWORD> bases;
+        std::vector<uint8_t> records;
+    };
+    std::vector<ChunkResult> results(chunks.size());
+    std::mutex readLock;
+    std::atomic<size_t> nextChunk(0);
+    std::atomic<uint64_t> scannedBytes(0);
+    std::atomic<uint64_t> positionCount(0);
+    std::atomic<uint64_t> candidateCount(0);
+    std::atomic<uint32_t> reads(0);
+
+    RunScanWorkers(config.threads, [&](uint32_t) {
+        std::vector<uint8_t> buffer(EquipmentScanLayout::BLOCK_SIZE + EquipmentScanLayout::RECORD_SIZE);
+        std::vector<uint64_t> bits;
+
+        for (size_t c = nextChunk++; c < chunks.size(); c = nextChunk++) {
+            const Chunk& chunk = chunks[c];
+            if (chunk.readSize < EquipmentScanLayout::RECORD_SIZE) {
+                continue;
+            }
+            const size_t positions = std::min<size_t>(chunk.size / EquipmentScanLayout::RECORD_ALIGN,
+                (chunk.readSize - EquipmentScanLayout::RECORD_SIZE) / EquipmentScanLayout::RECORD_ALIGN + 1);
+
+            // 整块读取；失败时逐页读取，与读不到的页重叠的位置不接受
+            std::vector<uint32_t> failedPages;
+            {
+                std::lock_guard<std::mutex> lock(readLock);
+                bool ok = memory->Read(chunk.address, buffer.data(), chunk.readSize);
+                reads++;
+                for (uint32_t offset = 0; !ok && offset < chunk.readSize; offset += RegionScanLayout::PAGE_SIZE) {
+                    uint32_t size = std::min<uint32_t>(RegionScanLayout::PAGE_SIZE, chunk.readSize - offset);
+                    reads++;
+                    if (!memory->Read(chunk.address + offset, buffer.data() + offset, size)) {
+                        memset(buffer.data() + offset, 0, size);
+                        failedPages.push_back(offset);
+                    }
+                }
+            }
+            scannedBytes += chunk.readSize;
+            positionCount += positions;
+
+            bits.resize((positions + 63) / 64);
+            PrefilterEquipmentRecords(buffer.data(), positions, config, bits.data(), true);
+
+            ChunkResult& result = results[c];
+            uint64_t candidates = 0;
+            QWORD nextFree = 0;         // 已接受的记录结束的位置 (块内偏移)
+            for (size_t w = 0; w < bits.size(); w++) {
+                for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                    candidates++;
+                    QWORD offset = (w * 64 + LowestBit(word)) * EquipmentScanLayout::RECORD_ALIGN;
+                    if (offset < nextFree) {
+                        continue;
+                    }
+                    bool overlapsFailed = std::any_of(failedPages.begin(), failedPages.end(), [&](uint32_t page) {
+                        return offset < page + RegionScanLayout::PAGE_SIZE && page < offset + EquipmentScanLayout::RECORD_SIZE;
+                    });
+                    const uint8_t* record = buffer.data() + offset;
+                    if (overlapsFailed || !IsPlausibleEquipmentRecord(record, config) || HasPointerAffixes(record, regions)) {
+                        continue;
+                    }
+                    result.bases.push_back(chunk.address + offset);
+                    result.records.insert(result.records.end(), record, record + EquipmentScanLayout::RECORD_SIZE);
+                    nextFree = offset + EquipmentScanLayout::RECORD_SIZE;
+                }
+            }
+            candidateCount += candidates;
+        }
+    });
+
+    // 按地址顺序合并；块边界两侧的记录同样不能重叠
+    QWORD nextFree = 0;
+    for (ChunkResult& result : results) {
+        for (size_t i = 0; i < result.bases.size(); i++) {
+            if (result.bases[i] < nextFree) {
+                continue;
+            }
+            if (outBases.size() >= config.maxResults) {
+                outStats.truncated = 1;
+                break;
+            }
+            outBases.push_back(result.bases[i]);
+            const uint8_t* record = result.records.data() + i * EquipmentScanLayout::RECORD_SIZE;
+            outRecords.insert(outRecords.end(), record, record + EquipmentScanLayout::RECORD_SIZE);
+            nextFree = result.bases[i] + EquipmentScanLayout::RECORD_SIZE;
+        }
+        result = ChunkResult();
+    }
+
+    outStats.scannedBytes = scannedBytes;
+    outStats.positions = positionCount;
+    outStats.candidates = candidateCount;
+    outStats.records = outBases.size();
+    outStats.regions = (uint32_t)regions.size();
+    outStats.reads = reads;
+    outStats.threads = config.threads;
+    outStats.microseconds = ElapsedMicroseconds(start);
+    return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "inventory_layout.h"
+#include "memory_layout.h"
+#include "process_memory.h"
+#include "region_scan.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 结构扫描: 在可写数据区域中按 memory_layout.h 的布局找出全部装备记录 (不需要 hook)
+//
+// 每个 8 字节对齐的位置都当作候选记录的开头，分两步判断:
+//   1. 预筛 (SSE2，每次 16 字节判断两个位置): 物品 ID、等级和第一个词条 ID 在合理范围内。
+//      这三个字段分别在记录的第 0 个和第 7 个 qword 中，两个相邻位置的同一字段正好在同一个 16 字节里
+//   2. 完整校验 (只对通过预筛的位置): 7 个词条槽位的 ID 和等级、非空词条数、地狱武器标志位与地狱技能 ID 一致；
+//      扫描时另外要求非空词条槽位的 qword (等级:ID) 不指向任何可写数据区域 ——
+//      堆指针的低 32 位常常像词条 ID、高 32 位像词条等级，指针数组否则很容易被当成词条
+// 合法记录互不重叠: 按地址顺序接受，与前一条重叠的丢弃。
+// 区域按 BLOCK_SIZE 分块 (块的末尾多读一条记录的长度)，读取串行，判断在多个线程上并行。
+namespace EquipmentScanLayout {
+    constexpr uint32_t RECORD_SIZE = InventoryScanLayout::RECORD_SIZE;
+    constexpr uint32_t RECORD_ALIGN = 8;
+    constexpr uint32_t BLOCK_SIZE = 0x100000;
+    constexpr int32_t EMPTY_AFFIX_ID = -1;          // 空词条槽位
+
+    // 合理范围的默认值 (EquipmentScanConfig 中为 0 的字段)
+    constexpr int32_t DEFAULT_MAX_ITEM_ID = 0x7FFF;
+    constexpr int32_t DEFAULT_MAX_LEVEL = 2000;
+    constexpr int32_t DEFAULT_MAX_AFFIX_ID = 0xFFFFFF;
+    constexpr int32_t DEFAULT_MAX_AFFIX_LEVEL = 1000;
+    constexpr uint32_t DEFAULT_MIN_AFFIXES = 1;
+    constexpr uint32_t DEFAULT_MAX_RESULTS = 100000;
+}
+
+// 与导出函数 SessionScanEquipment 共用；为 0 的字段取默认值
+// 物品 ID / 等级 / 词条 ID 的下限默认为 1，词条等级的下限固定为 0
+struct EquipmentScanConfig {
+    QWORD startAddress;         // endAddress 为 0 表示到用户空间末尾
+    QWORD endAddress;
+    int32_t minItemId;
+    int32_t maxItemId;
+    int32_t minLevel;
+    int32_t maxLevel;
+    int32_t minAffixId;
+    int32_t maxAffixId;
+    int32_t maxAffixLevel;
+    uint32_t minAffixes;        // 非空词条的最少个数
+    uint32_t maxResults;
+    uint32_t threads;           // 0 表示按 CPU 核数
+};
+
+struct EquipmentScanStats {
+    uint64_t scannedBytes;
+    uint64_t positions;         // 检查的对齐位置数
+    uint64_t candidates;        // 通过预筛的位置数
+    uint64_t records;           // 通过完整校验 (且不重叠) 的记录数
+    uint64_t microseconds;
+    uint32_t regions;
+    uint32_t reads;
+    uint32_t threads;
+    uint32_t truncated;         // 超过 maxResults，只保留地址最低的 maxResults 条
+};
+
+EquipmentScanConfig NormalizeEquipmentScanConfig(const EquipmentScanConfig& config);
+
+// 以下两个函数的 config 必须已经规范化
+// 预筛 data 开头的 positions 个位置 (第 i 个位置在 data + i * RECORD_ALIGN，
+// 最后一个位置之后必须还有 RECORD_SIZE 字节可读)，通过时置 outBits 的第 i 位
+// useSimd 为 false 时使用逐个判断的实现 (用于基准对比和校验)
+void PrefilterEquipmentRecords(const uint8_t* data, size_t positions, const EquipmentScanConfig& config,
+    uint64_t* outBits, bool useSimd);
+
+// 完整校验一条记录 (RECORD_SIZE 字节)
+bool IsPlausibleEquipmentRecord(const uint8_t* record, const EquipmentScanConfig& config);
+
+// 扫描全部可写数据区域。outBases 按地址升序，outRecords 依次为每条记录开头 RECORD_SIZE 字节
+// 没有可扫描的区域时返回 false
+bool ScanEquipmentRecords(ProcessMemory* memory, const EquipmentScanConfig& config, std::vector<QWORD>& outBases,
+    std::vector<uint8_t>& outRecords, EquipmentScanStats& outStats);
@@ -1,411 +1,485 @@
 #define NIOH3AFFIXCORE_EXPORTS
 #include "exports.h"
-#include "aob_scanner.h"
-#include "code_injector.h"
-#include "memory_layout.h"
-#include "skill_bypass_injector.h"
-#include <mutex>
-#include <string>
-
-// 全局状态
-static HANDLE g_processHandle = nullptr;
-static CodeInjector g_weaponInjector;   // 武器Hook
-static CodeInjector g_armorInjector;    // 装备Hook
-static SkillBypassInjector g_skillBypassInjector; // 技能学习条件绕过
-static std::recursive_mutex g_mutex;
-static std::string g_lastError;
-
-// 时间戳和基址缓存，用于自动切换
-static QWORD g_weaponTimestamp = 0;
-static QWORD g_armorTimestamp = 0;
-static QWORD g_lastWeaponBase = 0;
-static QWORD g_lastArmorBase = 0;
-
-static void SetLastError(const char* msg) {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-    g_lastError = msg;
-}
-
-// 更新时间戳并返回当前活动的基址
-static QWORD GetActiveEquipmentBase() {
-    QWORD weaponBase = g_weaponInjector.GetEquipmentBase();
-    QWORD armorBase = g_armorInjector.GetEquipmentBase();
-
-    // 检查哪个基址最近被更新
-    if (weaponBase != g_lastWeaponBase && weaponBase != 0) {
-        g_lastWeaponBase = weaponBase;
-        g_weaponTimestamp = GetTickCount64();
-    }
-    if (armorBase != g_lastArmorBase && armorBase != 0) {
-        g_lastArmorBase = armorBase;
-        g_armorTimestamp = GetTickCount64();
-    }
+#include "win32_process_memory.h"
+#include <memory>
 
-    // 返回最近更新的基址
-    if (g_armorTimestamp > g_weaponTimestamp && armorBase != 0) {
-        return armorBase;
-    } else if (weaponBase != 0) {
-        return weaponBase;
-    } else if (armorBase != 0) {
-        return armorBase;
-    }
-    return 0;
+// 默认会话 (无前缀的旧导出都作用于它)
+static Session& DefaultSession() {
+    static Session session;
+    return session;
 }
 
-// 获取当前装备类型
-static EquipmentType GetCurrentType() {
-    QWORD weaponBase = g_weaponInjector.GetEquipmentBase();
-    QWORD armorBase = g_armorInjector.GetEquipmentBase();
+// nullptr 表示默认会话
+static Session& ResolveSession(SessionHandle session) {
+    return session != nullptr ? *session : DefaultSession();
+}
 
-    // 更新时间戳
-    if (weaponBase != g_lastWeaponBase && weaponBase != 0) {
-        g_lastWeaponBase = weaponBase;
-        g_weaponTimestamp = GetTickCount64();
-    }
-    if (armorBase != g_lastArmorBase && armorBase != 0) {
-        g_lastArmorBase = armorBase;
-        g_armorTimestamp = GetTickCount64();
+extern "C" {
+
+// ---------------------------------------------------------------------------
+// 会话 API
+// ---------------------------------------------------------------------------
+
+NIOH3AFFIXCORE_API SessionHandle __cdecl CreateSession() {
+    return new Session();
+}
+
+NIOH3AFFIXCORE_API void __cdecl DestroySession(SessionHandle session) {
+    // 默认会话不可销毁
+    if (session != nullptr && session != &DefaultSession()) {
+        delete session;
     }
+}
+
+NIOH3AFFIXCORE_API bool __cdecl SessionAttachProcess(SessionHandle session, DWORD processId) {
+    Session& target = ResolveSession(session);
 
-    // 判断当前类型
-    if (g_armorTimestamp > g_weaponTimestamp && armorBase != 0) {
-        return EQUIP_TYPE_ARMOR;
-    } else if (weaponBase != 0) {
-        return EQUIP_TYPE_WEAPON;
-    } else if (armorBase != 0) {
-        return EQUIP_TYPE_ARMOR;
+    // 已附加时不再打开句柄，由 Session::Attach 报告 "Already attached"；打开失败时传入空后端
+    std::unique_ptr<Win32ProcessMemory> memory(new Win32ProcessMemory());
+    if (target.IsAttached() || !memory->Open(processId)) {
+        memory.reset();
     }
-    return EQUIP_TYPE_UNKNOWN;
+    return target.Attach(std::move(memory));
 }
 
-extern "C" {
+NIOH3AFFIXCORE_API void __cdecl SessionDetachProcess(SessionHandle session) {
+    ResolveSession(session).Detach();
+}
 
-NIOH3AFFIXCORE_API bool __cdecl AttachProcess(DWORD processId) {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
+NIOH3AFFIXCORE_API bool __cdecl SessionIsAttached(SessionHandle session) {
+    return ResolveSession(session).IsAttached();
+}
 
-    if (g_processHandle != nullptr) {
-        SetLastError("Already attached to a process");
-        return false;
-    }
+NIOH3AFFIXCORE_API bool __cdecl SessionEnableCapture(SessionHandle session) {
+    return ResolveSession(session).EnableCapture();
+}
 
-    g_processHandle = OpenProcess(
-        PROCESS_VM_READ | PROCESS_VM_WRITE | PROCESS_VM_OPERATION | PROCESS_QUERY_INFORMATION,
-        FALSE,
-        processId
-    );
+NIOH3AFFIXCORE_API void __cdecl SessionDisableCapture(SessionHandle session) {
+    ResolveSession(session).DisableCapture();
+}
 
-    if (g_processHandle == nullptr) {
-        SetLastError("Failed to open process");
-        return false;
-    }
+NIOH3AFFIXCORE_API bool __cdecl SessionIsCaptureEnabled(SessionHandle session) {
+    return ResolveSession(session).IsCaptureEnabled();
+}
 
-    // 重置时间戳和缓存
-    g_weaponTimestamp = 0;
-    g_armorTimestamp = 0;
-    g_lastWeaponBase = 0;
-    g_lastArmorBase = 0;
+NIOH3AFFIXCORE_API int __cdecl SessionGetCurrentEquipmentType(SessionHandle session) {
+    return (int)ResolveSession(session).GetCurrentEquipmentType();
+}
 
-    g_lastError.clear();
-    return true;
+NIOH3AFFIXCORE_API bool __cdecl SessionIsWeaponMode(SessionHandle session) {
+    return ResolveSession(session).IsWeaponMode();
 }
 
-NIOH3AFFIXCORE_API void __cdecl DetachProcess() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
+NIOH3AFFIXCORE_API QWORD __cdecl SessionGetEquipmentBase(SessionHandle session) {
+    return ResolveSession(session).GetEquipmentBase();
+}
 
-    if (g_weaponInjector.IsEnabled()) {
-        g_weaponInjector.Disable();
-    }
-    if (g_armorInjector.IsEnabled()) {
-        g_armorInjector.Disable();
-    }
-    if (g_skillBypassInjector.IsEnabled()) {
-        g_skillBypassInjector.Disable();
-    }
-    g_skillBypassInjector.Cleanup();
+NIOH3AFFIXCORE_API bool __cdecl SessionIsWeaponHookEnabled(SessionHandle session) {
+    return ResolveSession(session).IsWeaponHookEnabled();
+}
 
-    if (g_processHandle != nullptr) {
-        CloseHandle(g_processHandle);
-        g_processHandle = nullptr;
-    }
+NIOH3AFFIXCORE_API bool __cdecl SessionIsArmorHookEnabled(SessionHandle session) {
+    return ResolveSession(session).IsArmorHookEnabled();
+}
 
-    // 重置时间戳和缓存
-    g_weaponTimestamp = 0;
-    g_armorTimestamp = 0;
-    g_lastWeaponBase = 0;
-    g_lastArmorBase = 0;
+NIOH3AFFIXCORE_API QWORD __cdecl SessionGetWeaponBase(SessionHandle session) {
+    return ResolveSession(session).GetWeaponBase();
+}
 
-    g_lastError.clear();
+NIOH3AFFIXCORE_API QWORD __cdecl SessionGetArmorBase(SessionHandle session) {
+    return ResolveSession(session).GetArmorBase();
 }
 
-NIOH3AFFIXCORE_API bool __cdecl IsAttached() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-    return g_processHandle != nullptr;
+NIOH3AFFIXCORE_API bool __cdecl SessionReadAffix(SessionHandle session, int slotIndex, int* outId, int* outLevel) {
+    return ResolveSession(session).ReadAffix(slotIndex, outId, outLevel);
 }
 
-NIOH3AFFIXCORE_API bool __cdecl EnableCapture() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
+NIOH3AFFIXCORE_API bool __cdecl SessionWriteAffix(SessionHandle session, int slotIndex, int id, int level) {
+    return ResolveSession(session).WriteAffix(slotIndex, id, level);
+}
 
-    if (g_processHandle == nullptr) {
-        SetLastError("Not attached to any process");
+NIOH3AFFIXCORE_API bool __cdecl SessionReadAffixEx(
+    SessionHandle session,
+    int slotIndex,
+    int* outId,
+    int* outLevel,
+    uint8_t* outPrefix1,
+    uint8_t* outPrefix2,
+    uint8_t* outPrefix3,
+    uint8_t* outPrefix4
+) {
+    uint8_t prefixes[4] = { 0, 0, 0, 0 };
+    if (!ResolveSession(session).ReadAffixEx(slotIndex, outId, outLevel, prefixes)) {
         return false;
     }
 
-    bool weaponEnabled = g_weaponInjector.IsEnabled();
-    bool armorEnabled = g_armorInjector.IsEnabled();
+    if (outPrefix1) *outPrefix1 = prefixes[0];
+    if (outPrefix2) *outPrefix2 = prefixes[1];
+    if (outPrefix3) *outPrefix3 = prefixes[2];
+    if (outPrefix4) *outPrefix4 = prefixes[3];
+    return true;
+}
 
-    // 如果两个都已启用，直接返回成功
-    if (weaponEnabled && armorEnabled) {
-        return true;
-    }
+NIOH3AFFIXCORE_API bool __cdecl SessionWriteAffixExMasked(
+    SessionHandle session,
+    int slotIndex,
+    int id,
+    int level,
+    uint8_t prefix1,
+    uint8_t prefix2,
+    uint8_t prefix3,
+    uint8_t prefix4,
+    uint32_t fieldMask
+) {
+    const uint8_t prefixes[4] = { prefix1, prefix2, prefix3, prefix4 };
+    return ResolveSession(session).WriteAffixExMasked(slotIndex, id, level, prefixes, fieldMask);
+}
 
-    // 启用武器Hook
-    if (!weaponEnabled) {
-        QWORD weaponInjectionPoint = AobScan(g_processHandle, AobPatterns::WEAPON_CAPTURE_AOB);
-        if (weaponInjectionPoint == 0) {
-            SetLastError("Weapon AOB pattern not found. Game version may be incompatible.");
-            return false;
-        }
-
-        if (!g_weaponInjector.Initialize(g_processHandle, weaponInjectionPoint, HookType::Weapon)) {
-            SetLastError("Failed to initialize weapon code injector");
-            return false;
-        }
-
-        if (!g_weaponInjector.Enable()) {
-            SetLastError("Failed to enable weapon hook");
-            return false;
-        }
-    }
+NIOH3AFFIXCORE_API bool __cdecl SessionReadEquipmentBasicsEx(
+    SessionHandle session,
+    short* outItemId,
+    short* outTransmogId,
+    short* outLevel,
+    uint8_t* outEquipPlusValue,
+    int* outQuality,
+    int* outUnderworldSkillId,
+    int* outFamiliarity,
+    bool* outIsUnderworld
+) {
+    return ResolveSession(session).ReadEquipmentBasics(
+        outItemId, outTransmogId, outLevel, outEquipPlusValue, outQuality,
+        outUnderworldSkillId, outFamiliarity, outIsUnderworld);
+}
 
-    // 启用装备Hook
-    if (!armorEnabled) {
-        QWORD armorInjectionPoint = AobScan(g_processHandle, AobPatterns::ARMOR_CAPTURE_AOB);
-        if (armorInjectionPoint == 0) {
-            // 装备Hook找不到不算致命错误，只记录警告
-            // 武器Hook已经成功，可以继续
-            g_lastError = "Armor AOB pattern not found. Armor editing may not work.";
-            return true; // 仍然返回成功，因为武器Hook已启用
-        }
-
-        if (!g_armorInjector.Initialize(g_processHandle, armorInjectionPoint, HookType::Armor)) {
-            // 同样，装备Hook初始化失败不算致命错误
-            g_lastError = "Failed to initialize armor code injector. Armor editing may not work.";
-            return true;
-        }
-
-        if (!g_armorInjector.Enable()) {
-            g_lastError = "Failed to enable armor hook. Armor editing may not work.";
-            return true;
-        }
-    }
+NIOH3AFFIXCORE_API bool __cdecl SessionWriteEquipmentBasicsEx(
+    SessionHandle session,
+    short itemId,
+    short transmogId,
+    short level,
+    uint8_t equipPlusValue,
+    int quality,
+    int underworldSkillId,
+    int familiarity,
+    bool isUnderworld
+) {
+    return ResolveSession(session).WriteEquipmentBasics(
+        itemId, transmogId, level, true, equipPlusValue, quality,
+        underworldSkillId, familiarity, isUnderworld);
+}
 
-    g_lastError.clear();
-    return true;
+NIOH3AFFIXCORE_API bool __cdecl SessionEnableSkillBypass(SessionHandle session) {
+    return ResolveSession(session).EnableSkillBypass();
 }
 
-NIOH3AFFIXCORE_API void __cdecl DisableCapture() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
+NIOH3AFFIXCORE_API bool __cdecl SessionDisableSkillBypass(SessionHandle session) {
+    return ResolveSession(session).DisableSkillBypass();
+}
 
-    if (g_weaponInjector.IsEnabled()) {
-        g_weaponInjector.Disable();
-    }
-    if (g_armorInjector.IsEnabled()) {
-        g_armorInjector.Disable();
-    }
+NIOH3AFFIXCORE_API bool __cdecl SessionIsSkillBypassEnabled(SessionHandle session) {
+    return ResolveSession(session).IsSkillBypassEnabled();
 }
 
-NIOH3AFFIXCORE_API bool __cdecl IsCaptureEnabled() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-    // 只要武器Hook启用就算启用
-    return g_weaponInjector.IsEnabled();
+NIOH3AFFIXCORE_API const char* __cdecl SessionGetLastErrorMessage(SessionHandle session) {
+    return ResolveSession(session).GetLastErrorMessage();
 }
 
-NIOH3AFFIXCORE_API int __cdecl GetCurrentEquipmentType() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-    return (int)GetCurrentType();
+NIOH3AFFIXCORE_API bool __cdecl SessionEnableStatePage(SessionHandle session, const char* name) {
+    return ResolveSession(session).EnableStatePage(name);
 }
 
-NIOH3AFFIXCORE_API bool __cdecl IsWeaponMode() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-    EquipmentType type = GetCurrentType();
-    return type == EQUIP_TYPE_WEAPON || type == EQUIP_TYPE_UNKNOWN;
+NIOH3AFFIXCORE_API void __cdecl SessionDisableStatePage(SessionHandle session) {
+    ResolveSession(session).DisableStatePage();
 }
 
-NIOH3AFFIXCORE_API QWORD __cdecl GetEquipmentBase() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-    return GetActiveEquipmentBase();
+NIOH3AFFIXCORE_API void __cdecl SessionSetTraceFile(SessionHandle session, const char* path) {
+    ResolveSession(session).SetTraceFile(path);
 }
 
-NIOH3AFFIXCORE_API bool __cdecl IsWeaponHookEnabled() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-    return g_weaponInjector.IsEnabled();
+NIOH3AFFIXCORE_API bool __cdecl SessionUndoEdits(SessionHandle session, int steps, int* outApplied) {
+    return ResolveSession(session).UndoEdits(steps, outApplied);
 }
 
-NIOH3AFFIXCORE_API bool __cdecl IsArmorHookEnabled() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-    return g_armorInjector.IsEnabled();
+NIOH3AFFIXCORE_API bool __cdecl SessionRedoEdits(SessionHandle session, int steps, int* outApplied) {
+    return ResolveSession(session).RedoEdits(steps, outApplied);
 }
 
-NIOH3AFFIXCORE_API QWORD __cdecl GetWeaponBase() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-    return g_weaponInjector.GetEquipmentBase();
+NIOH3AFFIXCORE_API bool __cdecl SessionRestoreOriginal(SessionHandle session) {
+    return ResolveSession(session).RestoreOriginal();
 }
 
-NIOH3AFFIXCORE_API QWORD __cdecl GetArmorBase() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-    return g_armorInjector.GetEquipmentBase();
+NIOH3AFFIXCORE_API bool __cdecl SessionGetEditDepth(SessionHandle session, int* outUndoDepth, int* outRedoDepth) {
+    return ResolveSession(session).GetEditDepth(outUndoDepth, outRedoDepth);
 }
 
-NIOH3AFFIXCORE_API bool __cdecl ReadAffix(int slotIndex, int* outId, int* outLevel) {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
+NIOH3AFFIXCORE_API void __cdecl SessionSetJournalLimit(SessionHandle session, QWORD bytes) {
+    ResolveSession(session).SetJournalLimit((size_t)bytes);
+}
 
-    if (g_processHandle == nullptr) {
-        SetLastError("Not attached to any process");
-        return false;
-    }
+NIOH3AFFIXCORE_API bool __cdecl SessionEnableJournalFile(SessionHandle session, const char* path) {
+    return ResolveSession(session).EnableJournalFile(path);
+}
 
-    if (slotIndex < 0 || slotIndex >= MemoryLayout::AFFIX_SLOT_COUNT) {
-        SetLastError("Invalid slot index");
-        return false;
-    }
+NIOH3AFFIXCORE_API void __cdecl SessionDisableJournalFile(SessionHandle session) {
+    ResolveSession(session).DisableJournalFile();
+}
 
-    QWORD equipBase = GetActiveEquipmentBase();
-    if (equipBase == 0) {
-        SetLastError("Equipment base address not captured yet");
-        return false;
-    }
+NIOH3AFFIXCORE_API void __cdecl SessionSetSharedCapture(SessionHandle session, bool allow) {
+    ResolveSession(session).SetSharedCapture(allow);
+}
 
-    // 读取词条 ID
-    int idOffset = MemoryLayout::GetAffixIdOffset(slotIndex);
-    QWORD idAddr = equipBase + idOffset;
-    SIZE_T bytesRead;
-    int id = 0;
-    if (!ReadProcessMemory(g_processHandle, (LPCVOID)idAddr, &id, sizeof(id), &bytesRead)) {
-        SetLastError("Failed to read affix ID");
-        return false;
-    }
+NIOH3AFFIXCORE_API bool __cdecl SessionIsCaptureShared(SessionHandle session) {
+    return ResolveSession(session).IsCaptureShared();
+}
 
-    // 读取词条等级
-    int levelOffset = MemoryLayout::GetAffixLevelOffset(slotIndex);
-    QWORD levelAddr = equipBase + levelOffset;
-    int level = 0;
-    if (!ReadProcessMemory(g_processHandle, (LPCVOID)levelAddr, &level, sizeof(level), &bytesRead)) {
-        SetLastError("Failed to read affix level");
-        return false;
-    }
+NIOH3AFFIXCORE_API void __cdecl SessionSetEditMailbox(SessionHandle session, bool enable) {
+    ResolveSession(session).SetEditMailbox(enable);
+}
 
-    if (outId) *outId = id;
-    if (outLevel) *outLevel = level;
+NIOH3AFFIXCORE_API int __cdecl SessionGetPendingEdits(SessionHandle session) {
+    return ResolveSession(session).GetPendingEdits();
+}
 
-    g_lastError.clear();
-    return true;
+NIOH3AFFIXCORE_API void __cdecl SessionSetResidentHooks(SessionHandle session, const char* cachePath) {
+    ResolveSession(session).SetResidentHooks(cachePath);
 }
 
-NIOH3AFFIXCORE_API bool __cdecl WriteAffix(int slotIndex, int id, int level) {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
+NIOH3AFFIXCORE_API int __cdecl SessionGetResidentState(SessionHandle session) {
+    return ResolveSession(session).GetResidentState();
+}
 
-    if (g_processHandle == nullptr) {
-        SetLastError("Not attached to any process");
-        return false;
-    }
+NIOH3AFFIXCORE_API QWORD __cdecl SessionGetCaptureGeneration(SessionHandle session) {
+    return ResolveSession(session).GetCaptureGeneration();
+}
 
-    if (slotIndex < 0 || slotIndex >= MemoryLayout::AFFIX_SLOT_COUNT) {
-        SetLastError("Invalid slot index");
-        return false;
-    }
+NIOH3AFFIXCORE_API int __cdecl SessionGetCapturedItems(SessionHandle session, CapturedItem* outItems, int capacity) {
+    return ResolveSession(session).GetCapturedItems(outItems, capacity);
+}
 
-    QWORD equipBase = GetActiveEquipmentBase();
-    if (equipBase == 0) {
-        SetLastError("Equipment base address not captured yet");
-        return false;
-    }
+NIOH3AFFIXCORE_API void __cdecl SessionClearCapturedItems(SessionHandle session) {
+    ResolveSession(session).ClearCapturedItems();
+}
 
-    // 写入词条 ID
-    int idOffset = MemoryLayout::GetAffixIdOffset(slotIndex);
-    QWORD idAddr = equipBase + idOffset;
-    SIZE_T bytesWritten;
-    if (!WriteProcessMemory(g_processHandle, (LPVOID)idAddr, &id, sizeof(id), &bytesWritten)) {
-        SetLastError("Failed to write affix ID");
-        return false;
-    }
+NIOH3AFFIXCORE_API void __cdecl SessionSetOneShotCapture(SessionHandle session, bool enable) {
+    ResolveSession(session).SetOneShotCapture(enable);
+}
 
-    // 写入词条等级
-    int levelOffset = MemoryLayout::GetAffixLevelOffset(slotIndex);
-    QWORD levelAddr = equipBase + levelOffset;
-    if (!WriteProcessMemory(g_processHandle, (LPVOID)levelAddr, &level, sizeof(level), &bytesWritten)) {
-        SetLastError("Failed to write affix level");
-        return false;
-    }
+NIOH3AFFIXCORE_API bool __cdecl SessionRearmCapture(SessionHandle session) {
+    return ResolveSession(session).RearmCapture();
+}
 
-    g_lastError.clear();
-    return true;
+NIOH3AFFIXCORE_API bool __cdecl SessionGetCaptureStats(SessionHandle session, CaptureStats* outStats) {
+    return ResolveSession(session).GetCaptureStats(outStats);
 }
 
-NIOH3AFFIXCORE_API bool __cdecl ReadAffixEx(
-    int slotIndex,
-    int* outId,
-    int* outLevel,
-    uint8_t* outPrefix1,
-    uint8_t* outPrefix2,
-    uint8_t* outPrefix3,
-    uint8_t* outPrefix4
-) {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
+NIOH3AFFIXCORE_API void __cdecl SessionSetHookInstrumentation(SessionHandle session, bool enable) {
+    ResolveSession(session).SetHookInstrumentation(enable);
+}
 
-    if (g_processHandle == nullptr) {
-        SetLastError("Not attached to any process");
-        return false;
-    }
+NIOH3AFFIXCORE_API bool __cdecl SessionGetHookStats(SessionHandle session, int equipmentType, HookStats* outStats) {
+    return ResolveSession(session).GetHookStats(equipmentType, outStats);
+}
 
-    if (slotIndex < 0 || slotIndex >= MemoryLayout::AFFIX_SLOT_COUNT) {
-        SetLastError("Invalid slot index");
-        return false;
-    }
+NIOH3AFFIXCORE_API void __cdecl SessionSetOwnerCapture(SessionHandle session, bool enable) {
+    ResolveSession(session).SetOwnerCapture(enable);
+}
 
-    QWORD equipBase = GetActiveEquipmentBase();
-    if (equipBase == 0) {
-        SetLastError("Equipment base address not captured yet");
-        return false;
-    }
+NIOH3AFFIXCORE_API bool __cdecl SessionDeriveInventoryLayout(SessionHandle session, InventoryLayout* outLayout) {
+    return ResolveSession(session).DeriveInventoryLayout(outLayout);
+}
 
-    SIZE_T bytesRead;
+NIOH3AFFIXCORE_API int __cdecl SessionReadInventory(SessionHandle session, InventoryItem* outItems, int capacity) {
+    return ResolveSession(session).ReadInventory(outItems, capacity);
+}
 
-    // Read affix ID
-    int idOffset = MemoryLayout::GetAffixIdOffset(slotIndex);
-    QWORD idAddr = equipBase + idOffset;
-    int id = 0;
-    if (!ReadProcessMemory(g_processHandle, (LPCVOID)idAddr, &id, sizeof(id), &bytesRead)) {
-        SetLastError("Failed to read affix ID");
-        return false;
-    }
+NIOH3AFFIXCORE_API bool __cdecl SessionScanEquipment(SessionHandle session, const EquipmentScanConfig* config,
+    EquipmentScanStats* outStats) {
+    return ResolveSession(session).ScanEquipment(config, outStats);
+}
 
-    // Read affix level
-    int levelOffset = MemoryLayout::GetAffixLevelOffset(slotIndex);
-    QWORD levelAddr = equipBase + levelOffset;
-    int level = 0;
-    if (!ReadProcessMemory(g_processHandle, (LPCVOID)levelAddr, &level, sizeof(level), &bytesRead)) {
-        SetLastError("Failed to read affix level");
-        return false;
-    }
+NIOH3AFFIXCORE_API int __cdecl SessionGetScannedEquipment(SessionHandle session, InventoryItem* outItems, int capacity) {
+    return ResolveSession(session).GetScannedEquipment(outItems, capacity);
+}
 
-    // Read 4 prefix bytes (level offset + 4..+7)
-    int prefixOffset = MemoryLayout::GetAffixPrefixOffset(slotIndex, 0);
-    QWORD prefixAddr = equipBase + prefixOffset;
-    uint8_t prefixes[4] = { 0, 0, 0, 0 };
-    if (!ReadProcessMemory(g_processHandle, (LPCVOID)prefixAddr, prefixes, sizeof(prefixes), &bytesRead)) {
-        SetLastError("Failed to read affix prefixes");
-        return false;
-    }
+NIOH3AFFIXCORE_API bool __cdecl SessionAddFieldSample(SessionHandle session, QWORD base, uint32_t size,
+    const int32_t* labels, uint32_t labelCount) {
+    return ResolveSession(session).AddFieldSample(base, size, labels, labelCount);
+}
 
-    if (outId) *outId = id;
-    if (outLevel) *outLevel = level;
-    if (outPrefix1) *outPrefix1 = prefixes[0];
-    if (outPrefix2) *outPrefix2 = prefixes[1];
-    if (outPrefix3) *outPrefix3 = prefixes[2];
-    if (outPrefix4) *outPrefix4 = prefixes[3];
+NIOH3AFFIXCORE_API bool __cdecl SessionSaveFieldSamples(SessionHandle session, const char* path) {
+    return ResolveSession(session).SaveFieldSamples(path);
+}
 
-    g_lastError.clear();
-    return true;
+NIOH3AFFIXCORE_API bool __cdecl SessionLoadFieldSamples(SessionHandle session, const char* path) {
+    return ResolveSession(session).LoadFieldSamples(path);
+}
+
+NIOH3AFFIXCORE_API void __cdecl SessionClearFieldSamples(SessionHandle session) {
+    ResolveSession(session).ClearFieldSamples();
+}
+
+NIOH3AFFIXCORE_API int __cdecl SessionGetFieldSampleCount(SessionHandle session) {
+    return ResolveSession(session).GetFieldSampleCount();
+}
+
+NIOH3AFFIXCORE_API int __cdecl SessionAnalyzeFieldSamples(SessionHandle session, FieldCandidate* outCandidates, int capacity,
+    FieldAnalysisStats* outStats) {
+    return ResolveSession(session).AnalyzeFieldSamples(outCandidates, capacity, outStats);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl SessionLoadGameCatalog(SessionHandle session, const char* cachePath,
+    const CatalogTableSpec* specs, CatalogStats* outStats) {
+    return ResolveSession(session).LoadGameCatalog(cachePath, specs, outStats);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl SessionDumpGameTables(SessionHandle session, const char* path, const CatalogTableSpec* specs) {
+    return ResolveSession(session).DumpGameTables(path, specs);
+}
+
+NIOH3AFFIXCORE_API int __cdecl SessionGetCatalogEntries(SessionHandle session, int kind, CatalogEntry* outEntries, int capacity) {
+    return ResolveSession(session).GetCatalogEntries(kind, outEntries, capacity);
+}
+
+NIOH3AFFIXCORE_API int __cdecl SessionGetCatalogStrings(SessionHandle session, char* outBuffer, int capacity) {
+    return ResolveSession(session).GetCatalogStrings(outBuffer, capacity);
+}
+
+NIOH3AFFIXCORE_API const char* __cdecl SessionGetCatalogName(SessionHandle session, int kind, int32_t id) {
+    return ResolveSession(session).GetCatalogName(kind, id);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl SessionLoadRecordLayout(SessionHandle session, const char* path) {
+    return ResolveSession(session).LoadRecordLayout(path);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl SessionSaveRecordLayout(SessionHandle session, const char* path) {
+    return ResolveSession(session).SaveRecordLayout(path);
+}
+
+NIOH3AFFIXCORE_API int __cdecl SessionGetRecordLayout(SessionHandle session, RecordFieldDesc* outFields, int capacity) {
+    return ResolveSession(session).GetRecordLayout(outFields, capacity);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl SessionApplyAffixPreset(SessionHandle session, const AffixPreset* preset,
+    const QWORD* bases, int count, int32_t* outResults, PresetApplyStats* outStats) {
+    return ResolveSession(session).ApplyAffixPreset(preset, bases, count, outResults, outStats);
+}
+
+NIOH3AFFIXCORE_API void __cdecl SessionSetIntegrityInterval(SessionHandle session, uint32_t intervalMs) {
+    ResolveSession(session).SetIntegrityInterval(intervalMs);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl SessionCheckIntegrity(SessionHandle session, IntegrityStats* outStats) {
+    return ResolveSession(session).CheckIntegrity(outStats);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl SessionGetIntegrityStats(SessionHandle session, IntegrityStats* outStats) {
+    return ResolveSession(session).GetIntegrityStats(outStats);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl SessionScanPointerPaths(SessionHandle session, QWORD target, const PointerScanConfig* config,
+    const char* outputPath, PointerScanStats* outStats) {
+    return ResolveSession(session).ScanPointerPaths(target, config, outputPath, outStats);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl SessionIntersectPointerPaths(SessionHandle session, const char* first, const char* second,
+    const char* outputPath, uint64_t* outCount) {
+    return ResolveSession(session).IntersectPointerPaths(first, second, outputPath, outCount);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl SessionResolvePointerPath(SessionHandle session, const PointerPath* path, QWORD* outAddress) {
+    return ResolveSession(session).ResolvePointerPath(path, outAddress);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl SessionFirstScan(SessionHandle session, const ValueScanQuery* query, ValueScanStats* outStats) {
+    return ResolveSession(session).FirstScan(query, outStats);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl SessionNextScan(SessionHandle session, const ValueScanQuery* query, ValueScanStats* outStats) {
+    return ResolveSession(session).NextScan(query, outStats);
+}
+
+NIOH3AFFIXCORE_API int __cdecl SessionGetScanResults(SessionHandle session, ValueScanResult* outResults, int capacity) {
+    return ResolveSession(session).GetScanResults(outResults, capacity);
+}
+
+NIOH3AFFIXCORE_API void __cdecl SessionResetScan(SessionHandle session) {
+    ResolveSession(session).ResetScan();
+}
+
+// ---------------------------------------------------------------------------
+// 旧导出 - 默认会话的薄封装
+// ---------------------------------------------------------------------------
+
+NIOH3AFFIXCORE_API bool __cdecl AttachProcess(DWORD processId) {
+    return SessionAttachProcess(nullptr, processId);
+}
+
+NIOH3AFFIXCORE_API void __cdecl DetachProcess() {
+    SessionDetachProcess(nullptr);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl IsAttached() {
+    return SessionIsAttached(nullptr);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl EnableCapture() {
+    return SessionEnableCapture(nullptr);
+}
+
+NIOH3AFFIXCORE_API void __cdecl DisableCapture() {
+    SessionDisableCapture(nullptr);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl IsCaptureEnabled() {
+    return SessionIsCaptureEnabled(nullptr);
+}
+
+NIOH3AFFIXCORE_API int __cdecl GetCurrentEquipmentType() {
+    return SessionGetCurrentEquipmentType(nullptr);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl IsWeaponMode() {
+    return SessionIsWeaponMode(nullptr);
+}
+
+NIOH3AFFIXCORE_API QWORD __cdecl GetEquipmentBase() {
+    return SessionGetEquipmentBase(nullptr);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl IsWeaponHookEnabled() {
+    return SessionIsWeaponHookEnabled(nullptr);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl IsArmorHookEnabled() {
+    return SessionIsArmorHookEnabled(nullptr);
+}
+
+NIOH3AFFIXCORE_API QWORD __cdecl GetWeaponBase() {
+    return SessionGetWeaponBase(nullptr);
+}
+
+NIOH3AFFIXCORE_API QWORD __cdecl GetArmorBase() {
+    return SessionGetArmorBase(nullptr);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl ReadAffix(int slotIndex, int* outId, int* outLevel) {
+    return SessionReadAffix(nullptr, slotIndex, outId, outLevel);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl WriteAffix(int slotIndex, int id, int level) {
+    return SessionWriteAffix(nullptr, slotIndex, id, level);
+}
+
+NIOH3AFFIXCORE_API bool __cdecl ReadAffixEx(
+    int slotIndex,
+    int* outId,
+    int* outLevel,
+    uint8_t* outPrefix1,
+    uint8_t* outPrefix2,
+    uint8_t* outPrefix3,
+    uint8_t* outPrefix4
+) {
+    return SessionReadAffixEx(nullptr, slotIndex, outId, outLevel, outPrefix1, outPrefix2, outPrefix3, outPrefix4);
 }
 
 NIOH3AFFIXCORE_API bool __cdecl WriteAffixExMasked(
@@ -418,89 +492,11 @@ NIOH3AFFIXCORE_API bool __cdecl WriteAffixExMasked(
     uint8_t prefix4,
     uint32_t fieldMask
 ) {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-
-    if (g_processHandle == nullptr) {
-        SetLastError("Not attached to any process");
-        return false;
-    }
-
-    if (slotIndex < 0 || slotIndex >= MemoryLayout::AFFIX_SLOT_COUNT) {
-        SetLastError("Invalid slot index");
-        return false;
-    }
-
-    if (fieldMask == 0) {
-        g_lastError.clear();
-        return true;
-    }
-
-    QWORD equipBase = GetActiveEquipmentBase();
-    if (equipBase == 0) {
-        SetLastError("Equipment base address not captured yet");
-        return false;
-    }
-
-    SIZE_T bytesWritten;
-
-    // bit0: id
-    if ((fieldMask & (1u << 0)) != 0) {
-        int idOffset = MemoryLayout::GetAffixIdOffset(slotIndex);
-        QWORD idAddr = equipBase + idOffset;
-        if (!WriteProcessMemory(g_processHandle, (LPVOID)idAddr, &id, sizeof(id), &bytesWritten)) {
-            SetLastError("Failed to write affix ID");
-            return false;
-        }
-    }
-
-    // bit1: level
-    if ((fieldMask & (1u << 1)) != 0) {
-        int levelOffset = MemoryLayout::GetAffixLevelOffset(slotIndex);
-        QWORD levelAddr = equipBase + levelOffset;
-        if (!WriteProcessMemory(g_processHandle, (LPVOID)levelAddr, &level, sizeof(level), &bytesWritten)) {
-            SetLastError("Failed to write affix level");
-            return false;
-        }
-    }
-
-    // bit2..bit5: prefix1..prefix4
-    if ((fieldMask & ((1u << 2) | (1u << 3) | (1u << 4) | (1u << 5))) != 0) {
-        int prefixOffset = MemoryLayout::GetAffixPrefixOffset(slotIndex, 0);
-        QWORD prefixAddr = equipBase + prefixOffset;
-
-        if ((fieldMask & (1u << 2)) != 0) {
-            if (!WriteProcessMemory(g_processHandle, (LPVOID)(prefixAddr + 0), &prefix1, sizeof(prefix1), &bytesWritten)) {
-                SetLastError("Failed to write affix prefix1");
-                return false;
-            }
-        }
-        if ((fieldMask & (1u << 3)) != 0) {
-            if (!WriteProcessMemory(g_processHandle, (LPVOID)(prefixAddr + 1), &prefix2, sizeof(prefix2), &bytesWritten)) {
-                SetLastError("Failed to write affix prefix2");
-                return false;
-            }
-        }
-        if ((fieldMask & (1u << 4)) != 0) {
-            if (!WriteProcessMemory(g_processHandle, (LPVOID)(prefixAddr + 2), &prefix3, sizeof(prefix3), &bytesWritten)) {
-                SetLastError("Failed to write affix prefix3");
-                return false;
-            }
-        }
-        if ((fieldMask & (1u << 5)) != 0) {
-            if (!WriteProcessMemory(g_processHandle, (LPVOID)(prefixAddr + 3), &prefix4, sizeof(prefix4), &bytesWritten)) {
-                SetLastError("Failed to write affix prefix4");
-                return false;
-            }
-        }
-    }
-
-    g_lastError.clear();
-    return true;
+    return SessionWriteAffixExMasked(nullptr, slotIndex, id, level, prefix1, prefix2, prefix3, prefix4, fieldMask);
 }
 
 NIOH3AFFIXCORE_API const char* __cdecl GetLastErrorMessage() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-    return g_lastError.c_str();
+    return SessionGetLastErrorMessage(nullptr);
 }
 
 NIOH3AFFIXCORE_API bool __cdecl ReadEquipmentBasics(
@@ -511,98 +507,9 @@ NIOH3AFFIXCORE_API bool __cdecl ReadEquipmentBasics(
     int* outFamiliarity,
     bool* outIsUnderworld
 ) {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-
-    if (g_processHandle == nullptr) {
-        SetLastError("Not attached to any process");
-        return false;
-    }
-
-    QWORD equipBase = GetActiveEquipmentBase();
-    if (equipBase == 0) {
-        SetLastError("Equipment base address not captured yet");
-        return false;
-    }
-
-    SIZE_T bytesRead;
-    bool isWeapon = IsWeaponMode();
-
-    // 读取物品ID (2 bytes)
-    if (outItemId) {
-        short itemId = 0;
-        QWORD addr = equipBase + EquipmentLayout::ITEM_ID_OFFSET;
-        if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &itemId, sizeof(itemId), &bytesRead)) {
-            SetLastError("Failed to read item ID");
-            return false;
-        }
-        *outItemId = itemId;
-    }
-
-    // 读取幻化ID (2 bytes)
-    if (outTransmogId) {
-        short transmogId = 0;
-        QWORD addr = equipBase + EquipmentLayout::TRANSMOG_ID_OFFSET;
-        if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &transmogId, sizeof(transmogId), &bytesRead)) {
-            SetLastError("Failed to read transmog ID");
-            return false;
-        }
-        *outTransmogId = transmogId;
-    }
-
-    // 读取等级 (2 bytes)
-    if (outLevel) {
-        short level = 0;
-        QWORD addr = equipBase + EquipmentLayout::LEVEL_OFFSET;
-        if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &level, sizeof(level), &bytesRead)) {
-            SetLastError("Failed to read level");
-            return false;
-        }
-        *outLevel = level;
-    }
-
-    // 以下字段只有武器才有
-    if (isWeapon) {
-        // 读取地狱技能ID (4 bytes)
-        if (outUnderworldSkillId) {
-            int skillId = 0;
-            QWORD addr = equipBase + EquipmentLayout::UNDERWORLD_SKILL_ID_OFFSET;
-            if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &skillId, sizeof(skillId), &bytesRead)) {
-                SetLastError("Failed to read underworld skill ID");
-                return false;
-            }
-            *outUnderworldSkillId = skillId;
-        }
-
-        // 读取爱用度 (4 bytes)
-        if (outFamiliarity) {
-            int familiarity = 0;
-            QWORD addr = equipBase + EquipmentLayout::FAMILIARITY_OFFSET;
-            if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &familiarity, sizeof(familiarity), &bytesRead)) {
-                SetLastError("Failed to read familiarity");
-                return false;
-            }
-            *outFamiliarity = familiarity;
-        }
-
-        // 读取是否是地狱武器 (1 bit)
-        if (outIsUnderworld) {
-            BYTE flagByte = 0;
-            QWORD addr = equipBase + EquipmentLayout::UNDERWORLD_FLAG_OFFSET;
-            if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &flagByte, sizeof(flagByte), &bytesRead)) {
-                SetLastError("Failed to read underworld flag");
-                return false;
-            }
-            *outIsUnderworld = (flagByte & (1 << EquipmentLayout::UNDERWORLD_FLAG_BIT)) != 0;
-        }
-    } else {
-        // 装备模式下，武器独有字段返回默认值
-        if (outUnderworldSkillId) *outUnderworldSkillId = 0;
-        if (outFamiliarity) *outFamiliarity = 0;
-        if (outIsUnderworld) *outIsUnderworld = false;
-    }
-
-    g_lastError.clear();
-    return true;
+    return DefaultSession().ReadEquipmentBasics(
+        outItemId, outTransmogId, outLevel, nullptr, nullptr,
+        outUnderworldSkillId, outFamiliarity, outIsUnderworld);
 }
 
 NIOH3AFFIXCORE_API bool __cdecl ReadEquipmentBasicsEx(
@@ -615,119 +522,9 @@ NIOH3AFFIXCORE_API bool __cdecl ReadEquipmentBasicsEx(
     int* outFamiliarity,
     bool* outIsUnderworld
 ) {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-
-    if (g_processHandle == nullptr) {
-        SetLastError("Not attached to any process");
-        return false;
-    }
-
-    QWORD equipBase = GetActiveEquipmentBase();
-    if (equipBase == 0) {
-        SetLastError("Equipment base address not captured yet");
-        return false;
-    }
-
-    SIZE_T bytesRead;
-    bool isWeapon = IsWeaponMode();
-
-    // 读取物品ID (2 bytes)
-    if (outItemId) {
-        short itemId = 0;
-        QWORD addr = equipBase + EquipmentLayout::ITEM_ID_OFFSET;
-        if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &itemId, sizeof(itemId), &bytesRead)) {
-            SetLastError("Failed to read item ID");
-            return false;
-        }
-        *outItemId = itemId;
-    }
-
-    // 读取幻化ID (2 bytes)
-    if (outTransmogId) {
-        short transmogId = 0;
-        QWORD addr = equipBase + EquipmentLayout::TRANSMOG_ID_OFFSET;
-        if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &transmogId, sizeof(transmogId), &bytesRead)) {
-            SetLastError("Failed to read transmog ID");
-            return false;
-        }
-        *outTransmogId = transmogId;
-    }
-
-    // 读取等级 (2 bytes)
-    if (outLevel) {
-        short level = 0;
-        QWORD addr = equipBase + EquipmentLayout::LEVEL_OFFSET;
-        if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &level, sizeof(level), &bytesRead)) {
-            SetLastError("Failed to read level");
-            return false;
-        }
-        *outLevel = level;
-    }
-
-    if (outEquipPlusValue) {
-        uint8_t equipPlusValue = 0;
-        QWORD addr = equipBase + EquipmentLayout::EQUIPMENT_PLUS_VALUE_OFFSET;
-        if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &equipPlusValue, sizeof(equipPlusValue), &bytesRead)) {
-            SetLastError("Failed to read equip plus value");
-            return false;
-        }
-        *outEquipPlusValue = equipPlusValue;
-    }
-
-    // 读取品质/稀有度 (4 bytes)
-    if (outQuality) {
-        int quality = 0;
-        QWORD addr = equipBase + EquipmentLayout::QUALITY_OFFSET;
-        if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &quality, sizeof(quality), &bytesRead)) {
-            SetLastError("Failed to read quality");
-            return false;
-        }
-        *outQuality = quality;
-    }
-
-    // 以下字段只有武器才有
-    if (isWeapon) {
-        // 读取地狱技能ID (4 bytes)
-        if (outUnderworldSkillId) {
-            int skillId = 0;
-            QWORD addr = equipBase + EquipmentLayout::UNDERWORLD_SKILL_ID_OFFSET;
-            if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &skillId, sizeof(skillId), &bytesRead)) {
-                SetLastError("Failed to read underworld skill ID");
-                return false;
-            }
-            *outUnderworldSkillId = skillId;
-        }
-
-        // 读取爱用度 (4 bytes)
-        if (outFamiliarity) {
-            int familiarity = 0;
-            QWORD addr = equipBase + EquipmentLayout::FAMILIARITY_OFFSET;
-            if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &familiarity, sizeof(familiarity), &bytesRead)) {
-                SetLastError("Failed to read familiarity");
-                return false;
-            }
-            *outFamiliarity = familiarity;
-        }
-
-        // 读取是否是地狱武器 (1 bit)
-        if (outIsUnderworld) {
-            BYTE flagByte = 0;
-            QWORD addr = equipBase + EquipmentLayout::UNDERWORLD_FLAG_OFFSET;
-            if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &flagByte, sizeof(flagByte), &bytesRead)) {
-                SetLastError("Failed to read underworld flag");
-                return false;
-            }
-            *outIsUnderworld = (flagByte & (1 << EquipmentLayout::UNDERWORLD_FLAG_BIT)) != 0;
-        }
-    } else {
-        // 装备模式下，武器独有字段返回默认值
-        if (outUnderworldSkillId) *outUnderworldSkillId = 0;
-        if (outFamiliarity) *outFamiliarity = 0;
-        if (outIsUnderworld) *outIsUnderworld = false;
-    }
-
-    g_lastError.clear();
-    return true;
+    return SessionReadEquipmentBasicsEx(
+        nullptr, outItemId, outTransmogId, outLevel, outEquipPlusValue, outQuality,
+        outUnderworldSkillId, outFamiliarity, outIsUnderworld);
 }
 
 NIOH3AFFIXCORE_API bool __cdecl WriteEquipmentBasics(
@@ -738,94 +535,9 @@ NIOH3AFFIXCORE_API bool __cdecl WriteEquipmentBasics(
     int familiarity,
     bool isUnderworld
 ) {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-
-    if (g_processHandle == nullptr) {
-        SetLastError("Not attached to any process");
-        return false;
-    }
-
-    QWORD equipBase = GetActiveEquipmentBase();
-    if (equipBase == 0) {
-        SetLastError("Equipment base address not captured yet");
-        return false;
-    }
-
-    SIZE_T bytesWritten;
-    SIZE_T bytesRead;
-    bool isWeapon = IsWeaponMode();
-
-    // 写入物品ID (2 bytes)
-    {
-        QWORD addr = equipBase + EquipmentLayout::ITEM_ID_OFFSET;
-        if (!WriteProcessMemory(g_processHandle, (LPVOID)addr, &itemId, sizeof(itemId), &bytesWritten)) {
-            SetLastError("Failed to write item ID");
-            return false;
-        }
-    }
-
-    // 写入幻化ID (2 bytes)
-    {
-        QWORD addr = equipBase + EquipmentLayout::TRANSMOG_ID_OFFSET;
-        if (!WriteProcessMemory(g_processHandle, (LPVOID)addr, &transmogId, sizeof(transmogId), &bytesWritten)) {
-            SetLastError("Failed to write transmog ID");
-            return false;
-        }
-    }
-
-    // 写入等级 (2 bytes)
-    {
-        QWORD addr = equipBase + EquipmentLayout::LEVEL_OFFSET;
-        if (!WriteProcessMemory(g_processHandle, (LPVOID)addr, &level, sizeof(level), &bytesWritten)) {
-            SetLastError("Failed to write level");
-            return false;
-        }
-    }
-
-    // 以下字段只有武器才写入
-    if (isWeapon) {
-        // 写入地狱技能ID (4 bytes)
-        {
-            QWORD addr = equipBase + EquipmentLayout::UNDERWORLD_SKILL_ID_OFFSET;
-            if (!WriteProcessMemory(g_processHandle, (LPVOID)addr, &underworldSkillId, sizeof(underworldSkillId), &bytesWritten)) {
-                SetLastError("Failed to write underworld skill ID");
-                return false;
-            }
-        }
-
-        // 写入爱用度 (4 bytes)
-        {
-            QWORD addr = equipBase + EquipmentLayout::FAMILIARITY_OFFSET;
-            if (!WriteProcessMemory(g_processHandle, (LPVOID)addr, &familiarity, sizeof(familiarity), &bytesWritten)) {
-                SetLastError("Failed to write familiarity");
-                return false;
-            }
-        }
-
-        // 写入是否是地狱武器 (1 bit) - 需要读取-修改-写入
-        {
-            QWORD addr = equipBase + EquipmentLayout::UNDERWORLD_FLAG_OFFSET;
-            BYTE flagByte = 0;
-            if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &flagByte, sizeof(flagByte), &bytesRead)) {
-                SetLastError("Failed to read underworld flag for modification");
-                return false;
-            }
-
-            if (isUnderworld) {
-                flagByte |= (1 << EquipmentLayout::UNDERWORLD_FLAG_BIT);
-            } else {
-                flagByte &= ~(1 << EquipmentLayout::UNDERWORLD_FLAG_BIT);
-            }
-
-            if (!WriteProcessMemory(g_processHandle, (LPVOID)addr, &flagByte, sizeof(flagByte), &bytesWritten)) {
-                SetLastError("Failed to write underworld flag");
-                return false;
-            }
-        }
-    }
-
-    g_lastError.clear();
-    return true;
+    return DefaultSession().WriteEquipmentBasics(
+        itemId, transmogId, level, false, 0, 0,
+        underworldSkillId, familiarity, isUnderworld);
 }
 
 NIOH3AFFIXCORE_API bool __cdecl WriteEquipmentBasicsEx(
@@ -838,162 +550,22 @@ NIOH3AFFIXCORE_API bool __cdecl WriteEquipmentBasicsEx(
     int familiarity,
     bool isUnderworld
 ) {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-
-    if (g_processHandle == nullptr) {
-        SetLastError("Not attached to any process");
-        return false;
-    }
-
-    QWORD equipBase = GetActiveEquipmentBase();
-    if (equipBase == 0) {
-        SetLastError("Equipment base address not captured yet");
-        return false;
-    }
-
-    SIZE_T bytesWritten;
-    SIZE_T bytesRead;
-    bool isWeapon = IsWeaponMode();
-
-    // 写入物品ID (2 bytes)
-    {
-        QWORD addr = equipBase + EquipmentLayout::ITEM_ID_OFFSET;
-        if (!WriteProcessMemory(g_processHandle, (LPVOID)addr, &itemId, sizeof(itemId), &bytesWritten)) {
-            SetLastError("Failed to write item ID");
-            return false;
-        }
-    }
-
-    // 写入幻化ID (2 bytes)
-    {
-        QWORD addr = equipBase + EquipmentLayout::TRANSMOG_ID_OFFSET;
-        if (!WriteProcessMemory(g_processHandle, (LPVOID)addr, &transmogId, sizeof(transmogId), &bytesWritten)) {
-            SetLastError("Failed to write transmog ID");
-            return false;
-        }
-    }
-
-    // 写入等级 (2 bytes)
-    {
-        QWORD addr = equipBase + EquipmentLayout::LEVEL_OFFSET;
-        if (!WriteProcessMemory(g_processHandle, (LPVOID)addr, &level, sizeof(level), &bytesWritten)) {
-            SetLastError("Failed to write level");
-            return false;
-        }
-    }
-
-    {
-        QWORD addr = equipBase + EquipmentLayout::EQUIPMENT_PLUS_VALUE_OFFSET;
-        if (!WriteProcessMemory(g_processHandle, (LPVOID)addr, &equipPlusValue, sizeof(equipPlusValue), &bytesWritten)) {
-            SetLastError("Failed to write equip plus value");
-            return false;
-        }
-    }
-
-    // 写入品质/稀有度 (4 bytes)
-    {
-        QWORD addr = equipBase + EquipmentLayout::QUALITY_OFFSET;
-        if (!WriteProcessMemory(g_processHandle, (LPVOID)addr, &quality, sizeof(quality), &bytesWritten)) {
-            SetLastError("Failed to write quality");
-            return false;
-        }
-    }
-
-    // 以下字段只有武器才写入
-    if (isWeapon) {
-        // 写入地狱技能ID (4 bytes)
-    if (isWeapon) {
-        {
-            QWORD addr = equipBase + EquipmentLayout::UNDERWORLD_SKILL_ID_OFFSET;
-            if (!WriteProcessMemory(g_processHandle, (LPVOID)addr, &underworldSkillId, sizeof(underworldSkillId), &bytesWritten)) {
-                SetLastError("Failed to write underworld skill ID");
-                return false;
-            }
-        }
-
-        // 写入爱用度 (4 bytes)
-        {
-            QWORD addr = equipBase + EquipmentLayout::FAMILIARITY_OFFSET;
-            if (!WriteProcessMemory(g_processHandle, (LPVOID)addr, &familiarity, sizeof(familiarity), &bytesWritten)) {
-                SetLastError("Failed to write familiarity");
-                return false;
-            }
-        }
-
-        // 写入是否是地狱武器 (1 bit) - 需要读-改-写
-        {
-        {
-            QWORD addr = equipBase + EquipmentLayout::UNDERWORLD_FLAG_OFFSET;
-            BYTE flagByte = 0;
-            if (!ReadProcessMemory(g_processHandle, (LPCVOID)addr, &flagByte, sizeof(flagByte), &bytesRead)) {
-                SetLastError("Failed to read underworld flag for modification");
-                return false;
-            }
-
-            if (isUnderworld) {
-                flagByte |= (1 << EquipmentLayout::UNDERWORLD_FLAG_BIT);
-            } else {
-                flagByte &= ~(1 << EquipmentLayout::UNDERWORLD_FLAG_BIT);
-            }
-
-            if (!WriteProcessMemory(g_processHandle, (LPVOID)addr, &flagByte, sizeof(flagByte), &bytesWritten)) {
-                SetLastError("Failed to write underworld flag");
-                return false;
-            }
-        }
-    }
-
-    g_lastError.clear();
-    return true;
+    return SessionWriteEquipmentBasicsEx(
+        nullptr, itemId, transmogId, level, equipPlusValue, quality,
+        underworldSkillId, familiarity, isUnderworld);
 }
 
 NIOH3AFFIXCORE_API bool __cdecl EnableSkillBypass() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-
-    if (g_processHandle == nullptr) {
-        SetLastError("Not attached to any process");
-        return false;
-    }
-
-    // 如果已经启用，直接返回成功
-    if (g_skillBypassInjector.IsEnabled()) {
-        return true;
-    }
-
-    // 初始化（如果还没初始化）
-    if (!g_skillBypassInjector.Initialize(g_processHandle)) {
-        SetLastError("Failed to find skill bypass hook points. Game version may be incompatible.");
-        return false;
-    }
-
-    if (!g_skillBypassInjector.Enable()) {
-        SetLastError("Failed to enable skill bypass");
-        return false;
-    }
-
-    g_lastError.clear();
-    return true;
+    return SessionEnableSkillBypass(nullptr);
 }
 
 NIOH3AFFIXCORE_API bool __cdecl DisableSkillBypass() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-
-    if (!g_skillBypassInjector.IsEnabled()) {
-        return true;
-    }
-
-    if (!g_skillBypassInjector.Disable()) {
-        SetLastError("Failed to disable skill bypass");
-        return false;
-    }
-
-    g_lastError.clear();
-    return true;
+    return SessionDisableSkillBypass(nullptr);
 }
 
 NIOH3AFFIXCORE_API bool __cdecl IsSkillBypassEnabled() {
-    std::lock_guard<std::recursive_mutex> lock(g_mutex);
-    return g_skillBypassInjector.IsEnabled();
+    return SessionIsSkillBypassEnabled(nullptr);
 }
 
 } // extern "C"
+
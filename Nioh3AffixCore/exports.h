@@ -2,8 +2,7 @@
 
 #include <windows.h>
 #include <cstdint>
-
-typedef uint64_t QWORD;
+#include "session.h"
 
 #ifdef NIOH3AFFIXCORE_EXPORTS
 #define NIOH3AFFIXCORE_API __declspec(dllexport)
@@ -11,12 +10,9 @@ typedef uint64_t QWORD;
 #define NIOH3AFFIXCORE_API __declspec(dllimport)
 #endif
 
-// 装备类型枚举
-enum EquipmentType {
-    EQUIP_TYPE_UNKNOWN = 0,
-    EQUIP_TYPE_WEAPON = 1,
-    EQUIP_TYPE_ARMOR = 2
-};
+// 会话句柄 (不透明指针)
+// 所有 Session* 导出在 session 为 nullptr 时作用于默认会话，无前缀的旧导出同样作用于默认会话。
+typedef Session* SessionHandle;
 
 extern "C" {
     // 进程管理
@@ -118,4 +114,205 @@ extern "C" {
     NIOH3AFFIXCORE_API bool __cdecl EnableSkillBypass();
     NIOH3AFFIXCORE_API bool __cdecl DisableSkillBypass();
     NIOH3AFFIXCORE_API bool __cdecl IsSkillBypassEnabled();
+
+    // 会话 API - 每个会话独立附加一个进程，可在不同线程上并发使用
+    NIOH3AFFIXCORE_API SessionHandle __cdecl CreateSession();
+    NIOH3AFFIXCORE_API void __cdecl DestroySession(SessionHandle session);
+
+    NIOH3AFFIXCORE_API bool __cdecl SessionAttachProcess(SessionHandle session, DWORD processId);
+    NIOH3AFFIXCORE_API void __cdecl SessionDetachProcess(SessionHandle session);
+    NIOH3AFFIXCORE_API bool __cdecl SessionIsAttached(SessionHandle session);
+
+    NIOH3AFFIXCORE_API bool __cdecl SessionEnableCapture(SessionHandle session);
+    NIOH3AFFIXCORE_API void __cdecl SessionDisableCapture(SessionHandle session);
+    NIOH3AFFIXCORE_API bool __cdecl SessionIsCaptureEnabled(SessionHandle session);
+
+    NIOH3AFFIXCORE_API int __cdecl SessionGetCurrentEquipmentType(SessionHandle session);
+    NIOH3AFFIXCORE_API bool __cdecl SessionIsWeaponMode(SessionHandle session);
+    NIOH3AFFIXCORE_API QWORD __cdecl SessionGetEquipmentBase(SessionHandle session);
+    NIOH3AFFIXCORE_API bool __cdecl SessionIsWeaponHookEnabled(SessionHandle session);
+    NIOH3AFFIXCORE_API bool __cdecl SessionIsArmorHookEnabled(SessionHandle session);
+    NIOH3AFFIXCORE_API QWORD __cdecl SessionGetWeaponBase(SessionHandle session);
+    NIOH3AFFIXCORE_API QWORD __cdecl SessionGetArmorBase(SessionHandle session);
+
+    NIOH3AFFIXCORE_API bool __cdecl SessionReadAffix(SessionHandle session, int slotIndex, int* outId, int* outLevel);
+    NIOH3AFFIXCORE_API bool __cdecl SessionWriteAffix(SessionHandle session, int slotIndex, int id, int level);
+    NIOH3AFFIXCORE_API bool __cdecl SessionReadAffixEx(
+        SessionHandle session,
+        int slotIndex,
+        int* outId,
+        int* outLevel,
+        uint8_t* outPrefix1,
+        uint8_t* outPrefix2,
+        uint8_t* outPrefix3,
+        uint8_t* outPrefix4
+    );
+    NIOH3AFFIXCORE_API bool __cdecl SessionWriteAffixExMasked(
+        SessionHandle session,
+        int slotIndex,
+        int id,
+        int level,
+        uint8_t prefix1,
+        uint8_t prefix2,
+        uint8_t prefix3,
+        uint8_t prefix4,
+        uint32_t fieldMask
+    );
+
+    NIOH3AFFIXCORE_API bool __cdecl SessionReadEquipmentBasicsEx(
+        SessionHandle session,
+        short* outItemId,
+        short* outTransmogId,
+        short* outLevel,
+        uint8_t* outEquipPlusValue,
+        int* outQuality,
+        int* outUnderworldSkillId,
+        int* outFamiliarity,
+        bool* outIsUnderworld
+    );
+    NIOH3AFFIXCORE_API bool __cdecl SessionWriteEquipmentBasicsEx(
+        SessionHandle session,
+        short itemId,
+        short transmogId,
+        short level,
+        uint8_t equipPlusValue,
+        int quality,
+        int underworldSkillId,
+        int familiarity,
+        bool isUnderworld
+    );
+
+    NIOH3AFFIXCORE_API bool __cdecl SessionEnableSkillBypass(SessionHandle session);
+    NIOH3AFFIXCORE_API bool __cdecl SessionDisableSkillBypass(SessionHandle session);
+    NIOH3AFFIXCORE_API bool __cdecl SessionIsSkillBypassEnabled(SessionHandle session);
+
+    NIOH3AFFIXCORE_API const char* __cdecl SessionGetLastErrorMessage(SessionHandle session);
+
+    // 共享状态页 - name 为映射名称 (如 "Local\\Nioh3AffixEditor.State.1234")，布局见 state_page.h
+    NIOH3AFFIXCORE_API bool __cdecl SessionEnableStatePage(SessionHandle session, const char* name);
+    NIOH3AFFIXCORE_API void __cdecl SessionDisableStatePage(SessionHandle session);
+
+    // 远程操作跟踪 - 在下一次 SessionAttachProcess 时生效，path 为空或 nullptr 表示关闭
+    NIOH3AFFIXCORE_API void __cdecl SessionSetTraceFile(SessionHandle session, const char* path);
+
+    // 编辑日志 - 撤销/重做/恢复作用于当前装备，每个操作对目标进程只有一次读和一次写
+    NIOH3AFFIXCORE_API bool __cdecl SessionUndoEdits(SessionHandle session, int steps, int* outApplied);
+    NIOH3AFFIXCORE_API bool __cdecl SessionRedoEdits(SessionHandle session, int steps, int* outApplied);
+    NIOH3AFFIXCORE_API bool __cdecl SessionRestoreOriginal(SessionHandle session);
+    NIOH3AFFIXCORE_API bool __cdecl SessionGetEditDepth(SessionHandle session, int* outUndoDepth, int* outRedoDepth);
+    NIOH3AFFIXCORE_API void __cdecl SessionSetJournalLimit(SessionHandle session, QWORD bytes);
+    NIOH3AFFIXCORE_API bool __cdecl SessionEnableJournalFile(SessionHandle session, const char* path);
+    NIOH3AFFIXCORE_API void __cdecl SessionDisableJournalFile(SessionHandle session);
+
+    // 捕获传输 - 允许时 hook 数据放在同时映射进目标进程的共享内存中，读取不产生跨进程调用；
+    // 不支持时退回到 ReadProcessMemory。设置在附加后首次 SessionEnableCapture 时生效
+    NIOH3AFFIXCORE_API void __cdecl SessionSetSharedCapture(SessionHandle session, bool allow);
+    NIOH3AFFIXCORE_API bool __cdecl SessionIsCaptureShared(SessionHandle session);
+
+    // 编辑信箱 - 开启后对 hook 正在捕获的装备的写入由 hook 在游戏线程上应用 (默认关闭)
+    // SessionGetPendingEdits 返回尚未被游戏应用的写入数，不为 0 时新的写入会失败
+    NIOH3AFFIXCORE_API void __cdecl SessionSetEditMailbox(SessionHandle session, bool enable);
+    NIOH3AFFIXCORE_API int __cdecl SessionGetPendingEdits(SessionHandle session);
+
+    // 常驻 hook - cachePath 非空时分离会话后捕获 hook 留在游戏中，下一次附加 (同一路径) 时直接接管，不再扫描
+    // 在 SessionAttachProcess 之前设置；SessionGetResidentState 返回最近一次附加的接管结果 (ResidentState)
+    NIOH3AFFIXCORE_API void __cdecl SessionSetResidentHooks(SessionHandle session, const char* cachePath);
+    NIOH3AFFIXCORE_API int __cdecl SessionGetResidentState(SessionHandle session);
+
+    // 捕获代数 - 每次 hook 命中加一，与上次相同时调用者可以跳过刷新
+    NIOH3AFFIXCORE_API QWORD __cdecl SessionGetCaptureGeneration(SessionHandle session);
+
+    // 捕获过的装备列表 - 按最近捕获排序，返回总数 (可能大于 capacity)，outItems 为 nullptr 时只返回总数
+    NIOH3AFFIXCORE_API int __cdecl SessionGetCapturedItems(SessionHandle session, CapturedItem* outItems, int capacity);
+    NIOH3AFFIXCORE_API void __cdecl SessionClearCapturedItems(SessionHandle session);
+
+    // 单次捕获 - 开启后 hook 捕获到基址即自动恢复原始代码，SessionRearmCapture 重新挂上 (用户选择新装备时调用)
+    // SessionGetCaptureStats 返回 hook 命中次数和处于 hook 状态的累计时间
+    NIOH3AFFIXCORE_API void __cdecl SessionSetOneShotCapture(SessionHandle session, bool enable);
+    NIOH3AFFIXCORE_API bool __cdecl SessionRearmCapture(SessionHandle session);
+    NIOH3AFFIXCORE_API bool __cdecl SessionGetCaptureStats(SessionHandle session, CaptureStats* outStats);
+
+    // hook 插桩 - 开启后下一次挂上的 hook 统计命中次数并采样耗时 (rdtsc 周期直方图)
+    // equipmentType: 1 武器 / 2 装备 (EquipmentType)
+    NIOH3AFFIXCORE_API void __cdecl SessionSetHookInstrumentation(SessionHandle session, bool enable);
+    NIOH3AFFIXCORE_API bool __cdecl SessionGetHookStats(SessionHandle session, int equipmentType, HookStats* outStats);
+
+    // 容器捕获 - 开启后下一次挂上的装备 hook 同时记录容器指针，捕获过几件装备后可推导背包数组布局
+    // SessionReadInventory 批量读出背包中的全部装备，返回总数 (可能大于 capacity)，失败返回 -1；
+    // outItems 为 nullptr 时只返回总数
+    NIOH3AFFIXCORE_API void __cdecl SessionSetOwnerCapture(SessionHandle session, bool enable);
+    NIOH3AFFIXCORE_API bool __cdecl SessionDeriveInventoryLayout(SessionHandle session, InventoryLayout* outLayout);
+    NIOH3AFFIXCORE_API int __cdecl SessionReadInventory(SessionHandle session, InventoryItem* outItems, int capacity);
+
+    // 结构扫描 - 不依赖 hook，在游戏的可写内存中按装备记录的布局找出全部装备，结果替换上一次的索引
+    // SessionGetScannedEquipment 返回索引中的装备总数 (按地址升序)，最多填充 capacity 项；outItems 为 nullptr 时只返回总数
+    // config / outStats 可为空
+    NIOH3AFFIXCORE_API bool __cdecl SessionScanEquipment(SessionHandle session, const EquipmentScanConfig* config,
+        EquipmentScanStats* outStats);
+    NIOH3AFFIXCORE_API int __cdecl SessionGetScannedEquipment(SessionHandle session, InventoryItem* outItems, int capacity);
+
+    // 字段发现 - 收集带标签 (稀有度、装备类型等已知属性) 的装备记录样本，按偏移统计取值并提出候选字段
+    // SessionAddFieldSample 读出 base (0 表示当前装备) 开始的 size 字节；同一组样本的 size 和 labelCount 必须相同
+    // 样本文件为列式格式，Save/Load 不需要附加；样本在分离后保留，SessionClearFieldSamples 清空
+    // SessionAnalyzeFieldSamples 返回候选字段总数 (按偏移排序)，最多填充 capacity 项，没有样本时返回 -1；outStats 可为空
+    NIOH3AFFIXCORE_API bool __cdecl SessionAddFieldSample(SessionHandle session, QWORD base, uint32_t size,
+        const int32_t* labels, uint32_t labelCount);
+    NIOH3AFFIXCORE_API bool __cdecl SessionSaveFieldSamples(SessionHandle session, const char* path);
+    NIOH3AFFIXCORE_API bool __cdecl SessionLoadFieldSamples(SessionHandle session, const char* path);
+    NIOH3AFFIXCORE_API void __cdecl SessionClearFieldSamples(SessionHandle session);
+    NIOH3AFFIXCORE_API int __cdecl SessionGetFieldSampleCount(SessionHandle session);
+    NIOH3AFFIXCORE_API int __cdecl SessionAnalyzeFieldSamples(SessionHandle session, FieldCandidate* outCandidates, int capacity,
+        FieldAnalysisStats* outStats);
+
+    // 游戏数据表目录 - 从游戏内存读出词条表和地狱技能表 (ID 与名称)，代替手工维护的 CSV
+    // SessionLoadGameCatalog: cachePath 中的缓存与当前游戏版本相符时直接读取，否则读取游戏内存并写入缓存；cachePath 可为空
+    // specs 为 2 项 (CATALOG_AFFIX、CATALOG_UNDERWORLD_SKILL)，为空时使用内置的特征码和布局 (尚未在所有版本上确认，不像数据表的结果被丢弃)；outStats 可为空
+    // SessionGetCatalogEntries 按 ID 升序返回 kind 表的条目数，最多填充 capacity 项；
+    // SessionGetCatalogStrings 复制字符串池 (UTF-8，每个名称以 0 结尾) 并返回池的长度；
+    // SessionGetCatalogName 返回名称 (在下一次载入目录之前有效)，没有时返回 nullptr
+    // SessionDumpGameTables 把读取各表时读到的内存写入 path，供离线解码
+    NIOH3AFFIXCORE_API bool __cdecl SessionLoadGameCatalog(SessionHandle session, const char* cachePath,
+        const CatalogTableSpec* specs, CatalogStats* outStats);
+    NIOH3AFFIXCORE_API bool __cdecl SessionDumpGameTables(SessionHandle session, const char* path, const CatalogTableSpec* specs);
+    NIOH3AFFIXCORE_API int __cdecl SessionGetCatalogEntries(SessionHandle session, int kind, CatalogEntry* outEntries, int capacity);
+    NIOH3AFFIXCORE_API int __cdecl SessionGetCatalogStrings(SessionHandle session, char* outBuffer, int capacity);
+    NIOH3AFFIXCORE_API const char* __cdecl SessionGetCatalogName(SessionHandle session, int kind, int32_t id);
+
+    // 装备记录布局 - 游戏更新后字段偏移变化时从文本文件载入新布局，不需要重新编译
+    // SessionLoadRecordLayout: 每行 "名称 偏移 [字节数 [位号]]"，未列出的字段保持内置值；path 为空时恢复内置布局
+    // SessionSaveRecordLayout 把当前布局写成同样的格式；SessionGetRecordLayout 返回字段数 (RECORD_FIELD_COUNT)，
+    // 按 RecordFieldId 的顺序最多填充 capacity 项
+    NIOH3AFFIXCORE_API bool __cdecl SessionLoadRecordLayout(SessionHandle session, const char* path);
+    NIOH3AFFIXCORE_API bool __cdecl SessionSaveRecordLayout(SessionHandle session, const char* path);
+    NIOH3AFFIXCORE_API int __cdecl SessionGetRecordLayout(SessionHandle session, RecordFieldDesc* outFields, int capacity);
+
+    // 预设批量应用 - 把一套词条 (和可选的基础属性) 写入多件装备 (如 SessionReadInventory / SessionGetScannedEquipment 的结果)，
+    // 按地址合并读取和读回，只写回每件装备变化的字节，逐件核对；outResults 为 count 项 PresetItemResult，可为空；outStats 可为空
+    // 有装备失败时返回 false 但仍填充 outResults 和 outStats，SessionGetLastErrorMessage 给出第一件失败装备的原因
+    NIOH3AFFIXCORE_API bool __cdecl SessionApplyAffixPreset(SessionHandle session, const AffixPreset* preset,
+        const QWORD* bases, int count, int32_t* outResults, PresetApplyStats* outStats);
+
+    // 补丁完整性 - 核对所有改写过的位置，被游戏恢复的当作已撤下，被其它程序改写的不再写回原始字节
+    // intervalMs 非 0 时读取捕获结果 (SessionGetWeaponBase 等) 时按此间隔自动检查；SessionGetIntegrityStats 返回最近一次的结果，不访问游戏内存
+    NIOH3AFFIXCORE_API void __cdecl SessionSetIntegrityInterval(SessionHandle session, uint32_t intervalMs);
+    NIOH3AFFIXCORE_API bool __cdecl SessionCheckIntegrity(SessionHandle session, IntegrityStats* outStats);
+    NIOH3AFFIXCORE_API bool __cdecl SessionGetIntegrityStats(SessionHandle session, IntegrityStats* outStats);
+
+    // 指针路径扫描 - 对 target (0 表示当前装备) 反向搜索主模块静态数据出发的指针链，结果写入 outputPath
+    // 两次扫描 (例如游戏重启前后) 的结果文件用 SessionIntersectPointerPaths 求交集，只保留稳定的路径；
+    // SessionResolvePointerPath 按路径读出地址。config / outStats 可为空
+    NIOH3AFFIXCORE_API bool __cdecl SessionScanPointerPaths(SessionHandle session, QWORD target, const PointerScanConfig* config,
+        const char* outputPath, PointerScanStats* outStats);
+    NIOH3AFFIXCORE_API bool __cdecl SessionIntersectPointerPaths(SessionHandle session, const char* first, const char* second,
+        const char* outputPath, uint64_t* outCount);
+    NIOH3AFFIXCORE_API bool __cdecl SessionResolvePointerPath(SessionHandle session, const PointerPath* path, QWORD* outAddress);
+
+    // 数值扫描 - SessionFirstScan 在全部可写数据区域中找出等于某值 (或在某范围内) 的位置，
+    // 之后每次 SessionNextScan 只检查上一次的候选 (变化/不变/增大/减小/等于/范围)，用于定位装备记录中未知字段的偏移
+    // SessionGetScanResults 按地址顺序填充前 capacity 个候选，返回总数；outResults 为 nullptr 时只返回总数
+    // 失败时之前的结果不变；outStats 可为空
+    NIOH3AFFIXCORE_API bool __cdecl SessionFirstScan(SessionHandle session, const ValueScanQuery* query, ValueScanStats* outStats);
+    NIOH3AFFIXCORE_API bool __cdecl SessionNextScan(SessionHandle session, const ValueScanQuery* query, ValueScanStats* outStats);
+    NIOH3AFFIXCORE_API int __cdecl SessionGetScanResults(SessionHandle session, ValueScanResult* outResults, int capacity);
+    NIOH3AFFIXCORE_API void __cdecl SessionResetScan(SessionHandle session);
 }
@@ -0,0 +1,682 @@
+#include "field_samples.h"
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// x86-64 上 SSE2 总是可用
+#if defined(__SSE2__) || defined(_M_X64)
+#define FIELD_SAMPLES_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // 平方和的 32 位通道每次最多增加 4 * 255 * 255，这么多次后并入 64 位累加器
+    constexpr uint32_t SQUARE_FLUSH = 8192;
+
+    // 每个标签预先算好的列: 减去均值后的 double 值，以及相关比用的分组
+    struct LabelColumn {
+        std::vector<double> centered;
+        double sumSquares = 0;
+        std::vector<uint32_t> groups;       // 每条记录所属的组 (标签的第几个不同值)
+        std::vector<double> groupSizes;     // 为空表示不同值太多 (或只有一个)，不计算相关比
+    };
+
+    uint64_t ElapsedMicroseconds(std::chrono::steady_clock::time_point start) {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    uint64_t WidthMask(uint32_t width) {
+        return width >= 8 ? ~0ull : (1ull << (width * 8)) - 1;
+    }
+
+    uint64_t RawValue(const FieldSampleSet& samples, uint32_t offset, uint32_t width, size_t record) {
+        uint64_t value = 0;
+        for (uint32_t i = 0; i < width; i++) {
+            value |= (uint64_t)samples.GetColumn(offset + i)[record] << (i * 8);
+        }
+        return value;
+    }
+
+    double ToDouble(uint64_t raw, uint32_t width, int32_t kind) {
+        switch (width) {
+        case 1:
+            return (double)(uint8_t)raw;
+        case 2:
+            return (double)(int16_t)(uint16_t)raw;
+        case 4:
+            if (kind == FIELD_KIND_FLOAT) {
+                float value;
+                uint32_t bits = (uint32_t)raw;
+                memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+            return (double)(int32_t)(uint32_t)raw;
+        default:
+            return kind == FIELD_KIND_POINTER ? (double)raw : (double)(int64_t)raw;
+        }
+    }
+
+    bool IsPlausibleFloat(uint32_t bits) {
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        double magnitude = std::fabs((double)value);
+        return std::isfinite(value) && magnitude >= FieldSampleLayout::FLOAT_MIN && magnitude <= FieldSampleLayout::FLOAT_MAX;
+    }
+
+    bool IsPointerLike(uint64_t value) {
+        QWORD high = value >> 32;
+        return value == 0 || (high >= 1 && high <= 0x7FFF && (value & 7) == 0);
+    }
+
+    bool Varies(const std::vector<uint64_t>& values) {
+        return std::any_of(values.begin(), values.end(), [&](uint64_t value) { return value != values[0]; });
+    }
+
+    // ------------------------------------------------------------------
+    // 字段取值 -> double 列
+    // ------------------------------------------------------------------
+
+#ifdef FIELD_SAMPLES_SSE2
+    void StoreInt32x4(__m128i values, bool isFloat, double* out) {
+        if (isFloat) {
+            __m128 floats = _mm_castsi128_ps(values);
+            _mm_storeu_pd(out, _mm_cvtps_pd(floats));
+            _mm_storeu_pd(out + 2, _mm_cvtps_pd(_mm_movehl_ps(floats, floats)));
+        } else {
+            _mm_storeu_pd(out, _mm_cvtepi32_pd(values));
+            _mm_storeu_pd(out + 2, _mm_cvtepi32_pd(_mm_srli_si128(values, 8)));
+        }
+    }
+
+    // 处理 [0, 返回值) 的记录，每次 16 条；8 字节字段不处理
+    // 由 width 个字节列交错拼出 16 个整数: 1 字节零扩展，2 字节符号扩展，4 字节直接转换 (或按位当作 float)
+    size_t GatherSimd(const FieldSampleSet& samples, uint32_t offset, uint32_t width, bool isFloat, double* out) {
+        if (width == 8) {
+            return 0;
+        }
+        const size_t count = samples.GetCount();
+        const __m128i zero = _mm_setzero_si128();
+        const uint8_t* c0 = samples.GetColumn(offset);
+        const uint8_t* c1 = width >= 2 ? samples.GetColumn(offset + 1) : nullptr;
+        const uint8_t* c2 = width >= 4 ? samples.GetColumn(offset + 2) : nullptr;
+        const uint8_t* c3 = width >= 4 ? samples.GetColumn(offset + 3) : nullptr;
+
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i b0 = _mm_loadu_si128((const __m128i*)(c0 + i));
+            __m128i lanes[4];
+            if (width == 1) {
+                __m128i low = _mm_unpacklo_epi8(b0, zero);
+                __m128i high = _mm_unpackhi_epi8(b0, zero);
+                lanes[0] = _mm_unpacklo_epi16(low, zero);
+                lanes[1] = _mm_unpackhi_epi16(low, zero);
+                lanes[2] = _mm_unpacklo_epi16(high, zero);
+                lanes[3] = _mm_unpackhi_epi16(high, zero);
+            } else if (width == 2) {
+                __m128i b1 = _mm_loadu_si128((const __m128i*)(c1 + i));
+                __m128i low = _mm_unpacklo_epi8(b0, b1);
+                __m128i high = _mm_unpackhi_epi8(b0, b1);
+                lanes[0] = _mm_srai_epi32(_mm_unpacklo_epi16(low, low), 16);
+                lanes[1] = _mm_srai_epi32(_mm_unpackhi_epi16(low, low), 16);
+                lanes[2] = _mm_srai_epi32(_mm_unpacklo_epi16(high, high), 16);
+                lanes[3] = _mm_srai_epi32(_mm_unpackhi_epi16(high, high), 16);
+            } else {
+                __m128i b1 = _mm_loadu_si128((const __m128i*)(c1 + i));
+                __m128i b2 = _mm_loadu_si128((const __m128i*)(c2 + i));
+                __m128i b3 = _mm_loadu_si128((const __m128i*)(c3 + i));
+                __m128i low01 = _mm_unpacklo_epi8(b0, b1);
+                __m128i low23 = _mm_unpacklo_epi8(b2, b3);
+                __m128i high01 = _mm_unpackhi_epi8(b0, b1);
+                __m128i high23 = _mm_unpackhi_epi8(b2, b3);
+                lanes[0] = _mm_unpacklo_epi16(low01, low23);
+                lanes[1] = _mm_unpackhi_epi16(low01, low23);
+                lanes[2] = _mm_unpacklo_epi16(high01, high23);
+                lanes[3] = _mm_unpackhi_epi16(high01, high23);
+            }
+            for (int lane = 0; lane < 4; lane++) {
+                StoreInt32x4(lanes[lane], isFloat, out + i + lane * 4);
+            }
+        }
+        return i;
+    }
+#endif
+
+    // 非有限的 float (NaN / 无穷) 记为 0，避免污染统计
+    void GatherField(const FieldSampleSet& samples, const FieldCandidate& field, double* out, bool useSimd) {
+        const bool isFloat = field.kind == FIELD_KIND_FLOAT;
+        size_t i = 0;
+#ifdef FIELD_SAMPLES_SSE2
+        if (useSimd) {
+            i = GatherSimd(samples, field.offset, field.width, isFloat, out);
+        }
+#else
+        (void)useSimd;
+#endif
+        for (; i < samples.GetCount(); i++) {
+            out[i] = ToDouble(RawValue(samples, field.offset, field.width, i), field.width, field.kind);
+        }
+        if (isFloat) {
+            for (size_t j = 0; j < samples.GetCount(); j++) {
+                if (!std::isfinite(out[j])) out[j] = 0;
+            }
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // double 列的矩
+    // ------------------------------------------------------------------
+
+    struct Moments {
+        double minValue;
+        double maxValue;
+        double mean;
+        double sumSquares;      // 中心化后的平方和
+    };
+
+    // values 在返回时已减去均值
+    Moments ComputeMoments(double* values, size_t count, bool useSimd) {
+        Moments moments;
+        double sum = 0;
+        moments.minValue = values[0];
+        moments.maxValue = values[0];
+        size_t i = 0;
+#ifdef FIELD_SAMPLES_SSE2
+        if (useSimd && count >= 2) {
+            __m128d vsum = _mm_setzero_pd();
+            __m128d vmin = _mm_set1_pd(values[0]);
+            __m128d vmax = vmin;
+            for (; i + 2 <= count; i += 2) {
+                __m128d v = _mm_loadu_pd(values + i);
+                vsum = _mm_add_pd(vsum, v);
+                vmin = _mm_min_pd(vmin, v);
+                vmax = _mm_max_pd(vmax, v);
+            }
+            double lanes[2];
+            _mm_storeu_pd(lanes, vsum);
+            sum = lanes[0] + lanes[1];
+            _mm_storeu_pd(lanes, vmin);
+            moments.minValue = std::min(lanes[0], lanes[1]);
+            _mm_storeu_pd(lanes, vmax);
+            moments.maxValue = std::max(lanes[0], lanes[1]);
+        }
+#endif
+        for (; i < count; i++) {
+            sum += values[i];
+            moments.minValue = std::min(moments.minValue, values[i]);
+            moments.maxValue = std::max(moments.maxValue, values[i]);
+        }
+        moments.mean = sum / (double)count;
+
+        double squares = 0;
+        i = 0;
+#ifdef FIELD_SAMPLES_SSE2
+        if (useSimd) {
+            const __m128d mean = _mm_set1_pd(moments.mean);
+            __m128d vsquares = _mm_setzero_pd();
+            for (; i + 2 <= count; i += 2) {
+                __m128d d = _mm_sub_pd(_mm_loadu_pd(values + i), mean);
+                _mm_storeu_pd(values + i, d);
+                vsquares = _mm_add_pd(vsquares, _mm_mul_pd(d, d));
+            }
+            double lanes[2];
+            _mm_storeu_pd(lanes, vsquares);
+            squares = lanes[0] + lanes[1];
+        }
+#endif
+        for (; i < count; i++) {
+            values[i] -= moments.mean;
+            squares += values[i] * values[i];
+        }
+        moments.sumSquares = squares;
+        return moments;
+    }
+
+    double Dot(const double* a, const double* b, size_t count, bool useSimd) {
+        double sum = 0;
+        size_t i = 0;
+#ifdef FIELD_SAMPLES_SSE2
+        if (useSimd) {
+            __m128d even = _mm_setzero_pd();
+            __m128d odd = _mm_setzero_pd();
+            for (; i + 4 <= count; i += 4) {
+                even = _mm_add_pd(even, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+                odd = _mm_add_pd(odd, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+            }
+            double lanes[2];
+            _mm_storeu_pd(lanes, _mm_add_pd(even, odd));
+            sum = lanes[0] + lanes[1];
+        }
+#endif
+        for (; i < count; i++) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+
+    LabelColumn PrepareLabel(const int32_t* labels, size_t count) {
+        LabelColumn column;
+        double sum = 0;
+        for (size_t i = 0; i < count; i++) {
+            sum += labels[i];
+        }
+        double mean = sum / (double)count;
+        column.centered.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            column.centered[i] = labels[i] - mean;
+            column.sumSquares += column.centered[i] * column.centered[i];
+        }
+
+        std::vector<int32_t> distinct(labels, labels + count);
+        std::sort(distinct.begin(), distinct.end());
+        distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+        if (distinct.size() < 2 || distinct.size() > FieldSampleLayout::MAX_LABEL_GROUPS) {
+            return column;
+        }
+        column.groups.resize(count);
+        column.groupSizes.assign(distinct.size(), 0);
+        for (size_t i = 0; i < count; i++) {
+            column.groups[i] = (uint32_t)(std::lower_bound(distinct.begin(), distinct.end(), labels[i]) - distinct.begin());
+            column.groupSizes[column.groups[i]] += 1;
+        }
+        return column;
+    }
+
+    // 相关比 η = sqrt(组间平方和 / 总平方和)，centered 已减去总均值
+    double CorrelationRatio(const double* centered, double sumSquares, const LabelColumn& label, std::vector<double>& groupSums) {
+        if (label.groupSizes.empty() || sumSquares <= 0) {
+            return 0;
+        }
+        groupSums.assign(label.groupSizes.size(), 0);
+        for (size_t i = 0; i < label.groups.size(); i++) {
+            groupSums[label.groups[i]] += centered[i];
+        }
+        double between = 0;
+        for (size_t g = 0; g < groupSums.size(); g++) {
+            between += groupSums[g] * groupSums[g] / label.groupSizes[g];
+        }
+        return std::min(1.0, std::sqrt(between / sumSquares));
+    }
+
+    // ------------------------------------------------------------------
+    // 划分字段
+    // ------------------------------------------------------------------
+
+    class FieldProposer {
+    public:
+        explicit FieldProposer(std::vector<FieldCandidate>& out) : m_out(out) {}
+
+        // values 为每条记录在 [offset, offset + width) 的原始值
+        void Propose(uint32_t offset, uint32_t width, const std::vector<uint64_t>& values) {
+            if (!Varies(values)) {
+                return;
+            }
+            if (width == 8 && std::all_of(values.begin(), values.end(), IsPointerLike)) {
+                Emit(offset, width, FIELD_KIND_POINTER);
+                return;
+            }
+            if (width == 4 && IsFloatColumn(values)) {
+                Emit(offset, width, FIELD_KIND_FLOAT);
+                return;
+            }
+            if (width == 1) {
+                Emit(offset, width, IsFlagColumn(values) ? FIELD_KIND_FLAGS : FIELD_KIND_BYTE);
+                return;
+            }
+
+            const uint32_t half = width / 2;
+            const uint64_t mask = WidthMask(half);
+            std::vector<uint64_t> low(values.size());
+            std::vector<uint64_t> high(values.size());
+            for (size_t i = 0; i < values.size(); i++) {
+                low[i] = values[i] & mask;
+                high[i] = (values[i] >> (half * 8)) & mask;
+            }
+            if (Varies(low) && Varies(high) && (IsSignExtension(low, high, half) || (width <= 4 && CarriesInto(low, half)))) {
+                Emit(offset, width, FIELD_KIND_INT);
+                return;
+            }
+            Propose(offset, half, low);
+            Propose(offset + half, half, high);
+        }
+
+    private:
+        std::vector<FieldCandidate>& m_out;
+
+        void Emit(uint32_t offset, uint32_t width, int32_t kind) {
+            FieldCandidate field;
+            memset(&field, 0, sizeof(field));
+            field.offset = offset;
+            field.width = width;
+            field.kind = kind;
+            field.bestLabel = -1;
+            m_out.push_back(field);
+        }
+
+        // 高 16 位 (符号、指数和尾数的高位) 必须变化: 高 16 位不变的 4 字节更像是常量旁边的一个 16 位整数
+        static bool IsFloatColumn(const std::vector<uint64_t>& values) {
+            if (std::all_of(values.begin(), values.end(), [&](uint64_t value) { return (value >> 16) == (values[0] >> 16); })) {
+                return false;
+            }
+            size_t nonZero = 0;
+            size_t plausible = 0;
+            for (uint64_t value : values) {
+                if (value != 0) {
+                    nonZero++;
+                    plausible += IsPlausibleFloat((uint32_t)value) ? 1 : 0;
+                }
+            }
+            return nonZero != 0 && (double)plausible >= FieldSampleLayout::FLOAT_RATIO * (double)nonZero;
+        }
+
+        // 取值的按位或不超过 3 个位，且不是 0..2^k-1 这种小整数的形式
+        static bool IsFlagColumn(const std::vector<uint64_t>& values) {
+            uint64_t bits = 0;
+            for (uint64_t value : values) {
+                bits |= value;
+            }
+            return std::bitset<8>(bits).count() <= 3 && (bits & (bits + 1)) != 0;
+        }
+
+        // 每条记录的高半部分都是低半部分的符号扩展 (有符号整数的正负取值)
+        static bool IsSignExtension(const std::vector<uint64_t>& low, const std::vector<uint64_t>& high, uint32_t half) {
+            const uint64_t signBit = 1ull << (half * 8 - 1);
+            const uint64_t ones = WidthMask(half);
+            for (size_t i = 0; i < low.size(); i++) {
+                if (high[i] != ((low[i] & signBit) != 0 ? ones : 0)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // 低半部分的取值跨过了一半以上的范围: 更可能是同一个整数的进位，而不是两个独立的小字段
+        static bool CarriesInto(const std::vector<uint64_t>& low, uint32_t half) {
+            auto range = std::minmax_element(low.begin(), low.end());
+            return *range.second - *range.first >= (1ull << (half * 8 - 1));
+        }
+    };
+
+    std::vector<uint64_t> LoadValues(const FieldSampleSet& samples, uint32_t offset, uint32_t width) {
+        std::vector<uint64_t> values(samples.GetCount());
+        for (size_t i = 0; i < values.size(); i++) {
+            values[i] = RawValue(samples, offset, width, i);
+        }
+        return values;
+    }
+
+    // 1 / 2 字节字段的不同值个数: 按原始值标记，不需要排序
+    uint32_t CountDistinctSmall(const FieldSampleSet& samples, const FieldCandidate& field, std::vector<uint8_t>& seen) {
+        seen.assign((size_t)1 << (field.width * 8), 0);
+        const uint8_t* low = samples.GetColumn(field.offset);
+        const uint8_t* high = field.width == 2 ? samples.GetColumn(field.offset + 1) : nullptr;
+        uint32_t distinct = 0;
+        for (size_t i = 0; i < samples.GetCount(); i++) {
+            uint8_t& mark = seen[low[i] | (high != nullptr ? (size_t)high[i] << 8 : 0)];
+            distinct += mark == 0 ? 1 : 0;
+            mark = 1;
+        }
+        return distinct;
+    }
+
+    bool HasVaryingByte(const std::vector<ByteColumnStats>& bytes, uint32_t offset, uint32_t width) {
+        for (uint32_t i = offset; i < offset + width; i++) {
+            if (bytes[i].minValue != bytes[i].maxValue) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+// ----------------------------------------------------------------------
+// 字节列统计
+// ----------------------------------------------------------------------
+
+void ComputeByteColumnStats(const uint8_t* column, size_t count, ByteColumnStats& outStats, bool useSimd) {
+    uint8_t low = 0xFF;
+    uint8_t high = 0;
+    uint64_t sum = 0;
+    uint64_t squares = 0;
+    size_t i = 0;
+#ifdef FIELD_SAMPLES_SSE2
+    if (useSimd) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i vmin = _mm_set1_epi8((char)0xFF);
+        __m128i vmax = zero;
+        __m128i sums = zero;        // 2 个 u64 通道
+        __m128i squares32 = zero;   // 4 个 u32 通道
+        __m128i squares64 = zero;   // 2 个 u64 通道
+        uint32_t pending = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(column + i));
+            vmin = _mm_min_epu8(vmin, v);
+            vmax = _mm_max_epu8(vmax, v);
+            sums = _mm_add_epi64(sums, _mm_sad_epu8(v, zero));
+            __m128i lowWords = _mm_unpacklo_epi8(v, zero);
+            __m128i highWords = _mm_unpackhi_epi8(v, zero);
+            squares32 = _mm_add_epi32(squares32, _mm_add_epi32(_mm_madd_epi16(lowWords, lowWords), _mm_madd_epi16(highWords, highWords)));
+            if (++pending == SQUARE_FLUSH) {
+                squares64 = _mm_add_epi64(squares64, _mm_unpacklo_epi32(squares32, zero));
+                squares64 = _mm_add_epi64(squares64, _mm_unpackhi_epi32(squares32, zero));
+                squares32 = zero;
+                pending = 0;
+            }
+        }
+        squares64 = _mm_add_epi64(squares64, _mm_unpacklo_epi32(squares32, zero));
+        squares64 = _mm_add_epi64(squares64, _mm_unpackhi_epi32(squares32, zero));
+
+        alignas(16) uint8_t minBytes[16];
+        alignas(16) uint8_t maxBytes[16];
+        alignas(16) uint64_t words[2];
+        _mm_store_si128((__m128i*)minBytes, vmin);
+        _mm_store_si128((__m128i*)maxBytes, vmax);
+        for (int lane = 0; lane < 16; lane++) {
+            low = std::min(low, minBytes[lane]);
+            high = std::max(high, maxBytes[lane]);
+        }
+        _mm_store_si128((__m128i*)words, sums);
+        sum = words[0] + words[1];
+        _mm_store_si128((__m128i*)words, squares64);
+        squares = words[0] + words[1];
+    }
+#else
+    (void)useSimd;
+#endif
+    for (; i < count; i++) {
+        low = std::min(low, column[i]);
+        high = std::max(high, column[i]);
+        sum += column[i];
+        squares += (uint64_t)column[i] * column[i];
+    }
+    outStats.minValue = count != 0 ? low : 0;
+    outStats.maxValue = high;
+    outStats.sum = sum;
+    outStats.sumSquares = squares;
+}
+
+// ----------------------------------------------------------------------
+// 样本集
+// ----------------------------------------------------------------------
+
+FieldSampleSet::FieldSampleSet()
+    : m_recordSize(0)
+    , m_labelCount(0)
+{
+}
+
+bool FieldSampleSet::Reset(uint32_t recordSize, uint32_t labelCount) {
+    Clear();
+    if (recordSize == 0 || recordSize > FieldSampleLayout::MAX_RECORD_SIZE || labelCount > FieldSampleLayout::MAX_LABELS) {
+        return false;
+    }
+    m_recordSize = recordSize;
+    m_labelCount = labelCount;
+    m_columns.resize(recordSize);
+    m_labels.resize(labelCount);
+    return true;
+}
+
+void FieldSampleSet::Clear() {
+    m_recordSize = 0;
+    m_labelCount = 0;
+    m_bases.clear();
+    m_columns.clear();
+    m_labels.clear();
+}
+
+void FieldSampleSet::Add(QWORD base, const uint8_t* record, const int32_t* labels) {
+    m_bases.push_back(base);
+    for (uint32_t offset = 0; offset < m_recordSize; offset++) {
+        m_columns[offset].push_back(record[offset]);
+    }
+    for (uint32_t label = 0; label < m_labelCount; label++) {
+        m_labels[label].push_back(labels[label]);
+    }
+}
+
+bool FieldSampleSet::Write(const char* path) const {
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    FieldSampleFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = FieldSampleLayout::FILE_MAGIC;
+    header.version = FieldSampleLayout::FILE_VERSION;
+    header.recordSize = m_recordSize;
+    header.labelCount = m_labelCount;
+    header.count = m_bases.size();
+
+    const size_t count = m_bases.size();
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        (count == 0 || fwrite(m_bases.data(), sizeof(QWORD), count, file) == count);
+    for (uint32_t label = 0; ok && count != 0 && label < m_labelCount; label++) {
+        ok = fwrite(m_labels[label].data(), sizeof(int32_t), count, file) == count;
+    }
+    for (uint32_t offset = 0; ok && count != 0 && offset < m_recordSize; offset++) {
+        ok = fwrite(m_columns[offset].data(), 1, count, file) == count;
+    }
+    return fclose(file) == 0 && ok;
+}
+
+bool FieldSampleSet::Read(const char* path) {
+    Clear();
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    FieldSampleFileHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+        header.magic == FieldSampleLayout::FILE_MAGIC &&
+        header.version == FieldSampleLayout::FILE_VERSION &&
+        header.count <= FieldSampleLayout::MAX_SAMPLES &&
+        Reset(header.recordSize, header.labelCount);
+    const size_t count = ok ? (size_t)header.count : 0;
+    if (ok && count != 0) {
+        m_bases.resize(count);
+        ok = fread(m_bases.data(), sizeof(QWORD), count, file) == count;
+    }
+    for (uint32_t label = 0; ok && count != 0 && label < m_labelCount; label++) {
+        m_labels[label].resize(count);
+        ok = fread(m_labels[label].data(), sizeof(int32_t), count, file) == count;
+    }
+    for (uint32_t offset = 0; ok && count != 0 && offset < m_recordSize; offset++) {
+        m_columns[offset].resize(count);
+        ok = fread(m_columns[offset].data(), 1, count, file) == count;
+    }
+    fclose(file);
+    if (!ok) {
+        Clear();
+    }
+    return ok;
+}
+
+// ----------------------------------------------------------------------
+// 分析
+// ----------------------------------------------------------------------
+
+bool AnalyzeFieldSamples(const FieldSampleSet& samples, std::vector<FieldCandidate>& outCandidates,
+    FieldAnalysisStats& outStats, bool useSimd) {
+    auto start = std::chrono::steady_clock::now();
+    memset(&outStats, 0, sizeof(outStats));
+    outCandidates.clear();
+
+    const size_t count = samples.GetCount();
+    const uint32_t recordSize = samples.GetRecordSize();
+    if (count == 0) {
+        return false;
+    }
+    outStats.records = (uint32_t)count;
+    outStats.recordSize = recordSize;
+
+    std::vector<ByteColumnStats> bytes(recordSize);
+    for (uint32_t offset = 0; offset < recordSize; offset++) {
+        ComputeByteColumnStats(samples.GetColumn(offset), count, bytes[offset], useSimd);
+        outStats.constantBytes += bytes[offset].minValue == bytes[offset].maxValue ? 1 : 0;
+    }
+
+    // 按 8 字节块划分，末尾不足 8 字节的部分按 4 / 2 / 1 字节划分
+    FieldProposer proposer(outCandidates);
+    uint32_t offset = 0;
+    for (uint32_t width = 8; width != 0; width /= 2) {
+        for (; offset + width <= recordSize; offset += width) {
+            if (HasVaryingByte(bytes, offset, width)) {
+                proposer.Propose(offset, width, LoadValues(samples, offset, width));
+            }
+        }
+    }
+
+    std::vector<LabelColumn> labels;
+    for (uint32_t label = 0; label < samples.GetLabelCount(); label++) {
+        labels.push_back(PrepareLabel(samples.GetLabels(label), count));
+    }
+
+    std::vector<double> values(count);
+    std::vector<double> sorted;
+    std::vector<uint8_t> seen;
+    std::vector<double> groupSums;
+    for (FieldCandidate& field : outCandidates) {
+        GatherField(samples, field, values.data(), useSimd);
+
+        if (field.width <= 2) {
+            field.distinct = CountDistinctSmall(samples, field, seen);
+        } else {
+            sorted = values;
+            std::sort(sorted.begin(), sorted.end());
+            field.distinct = (uint32_t)(std::unique(sorted.begin(), sorted.end()) - sorted.begin());
+        }
+
+        Moments moments = ComputeMoments(values.data(), count, useSimd);
+        field.minValue = moments.minValue;
+        field.maxValue = moments.maxValue;
+        field.mean = moments.mean;
+        field.stddev = std::sqrt(moments.sumSquares / (double)count);
+
+        double bestScore = -1;
+        for (uint32_t label = 0; label < labels.size(); label++) {
+            const LabelColumn& column = labels[label];
+            double correlation = 0;
+            if (moments.sumSquares > 0 && column.sumSquares > 0) {
+                correlation = Dot(values.data(), column.centered.data(), count, useSimd) /
+                    std::sqrt(moments.sumSquares * column.sumSquares);
+            }
+            double association = CorrelationRatio(values.data(), moments.sumSquares, column, groupSums);
+            double score = std::max(std::fabs(correlation), association);
+            if (score > bestScore) {
+                bestScore = score;
+                field.bestLabel = (int32_t)label;
+                field.correlation = correlation;
+                field.association = association;
+            }
+        }
+    }
+
+    outStats.candidates = (uint32_t)outCandidates.size();
+    outStats.microseconds = ElapsedMicroseconds(start);
+    return true;
+}
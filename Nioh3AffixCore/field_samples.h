@@ -0,0 +1,127 @@
+#pragma once
+
+#include "process_memory.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 字段发现: 从大量带标签的装备记录样本中统计每个偏移的取值，提出候选字段供人工确认
+//
+// 样本: 若干条等长的记录 (从装备基址开始的 recordSize 字节)，每条带 labelCount 个已知属性 (稀有度、装备类型等，int32)。
+// 样本按列保存: 每个字节偏移一列 (所有记录在该偏移的字节连续存放)，每个标签一列。
+//
+// 分析:
+//   1. 每个字节列的最小值/最大值/和/平方和 (SSE2，每次 16 条记录)，最小值等于最大值的字节为常量
+//   2. 按 8 字节块把变化的字节划分为字段 (宽度为容纳变化的最小宽度): 块整体像指针时为 8 字节指针；
+//      两半都变化时，高半部分是低半部分的符号扩展 (或 4 字节以下、低半部分的取值跨过一半以上的范围，像是进位) 时
+//      为一个整数，否则两半分别划分；只有一半变化时只看这一半。4 字节的取值大多是合理的浮点数时当作 float
+//   3. 每个字段的取值转为 double 列 (SSE2 由字节列拼出 16/32 位整数)，计算均值、标准差、取值范围、不同值个数，
+//      以及与每个标签的 Pearson 相关系数 (SSE2) 和相关比 η (按标签值分组，适用于装备类型这类无序标签)
+//
+// 样本文件 (列式): [FieldSampleFileHeader][基址 u64 * count][标签列 int32 * count * labelCount][字节列 u8 * count * recordSize]
+namespace FieldSampleLayout {
+    constexpr uint32_t MAX_RECORD_SIZE = 0x1000;
+    constexpr uint32_t MAX_LABELS = 16;
+    constexpr uint32_t MAX_SAMPLES = 1000000;
+    constexpr uint32_t MAX_LABEL_GROUPS = 1024;     // 相关比: 标签的不同值超过这么多时不计算
+
+    // 4 字节字段: 非 0 的取值中至少 FLOAT_RATIO 是绝对值在 [FLOAT_MIN, FLOAT_MAX] 内的浮点数时当作 float
+    constexpr double FLOAT_RATIO = 0.95;
+    constexpr double FLOAT_MIN = 1e-4;
+    constexpr double FLOAT_MAX = 1e7;
+
+    constexpr uint32_t FILE_MAGIC = 0x5346334E;     // "N3FS"
+    constexpr uint32_t FILE_VERSION = 1;
+}
+
+// 与导出函数 SessionAnalyzeFieldSamples 共用
+enum FieldKind {
+    FIELD_KIND_BYTE = 1,        // 无符号字节
+    FIELD_KIND_FLAGS = 2,       // 取值只用到不超过 3 个位的字节
+    FIELD_KIND_INT = 3,         // 有符号整数 (2/4/8 字节)
+    FIELD_KIND_FLOAT = 4,
+    FIELD_KIND_POINTER = 5      // 8 字节，非 0 的取值都像用户空间地址
+};
+
+// 一个候选字段 (与导出函数 SessionAnalyzeFieldSamples 共用)
+struct FieldCandidate {
+    uint32_t offset;
+    uint32_t width;             // 1 / 2 / 4 / 8
+    int32_t kind;               // FieldKind
+    int32_t bestLabel;          // 关联最强的标签序号，没有标签时为 -1
+    double minValue;
+    double maxValue;
+    double mean;
+    double stddev;
+    double correlation;         // 与 bestLabel 的 Pearson 相关系数
+    double association;         // 与 bestLabel 的相关比 η (0..1)
+    uint32_t distinct;          // 不同值的个数
+    uint32_t reserved;
+};
+
+struct FieldAnalysisStats {
+    uint32_t records;
+    uint32_t recordSize;
+    uint32_t constantBytes;
+    uint32_t candidates;
+    uint64_t microseconds;
+};
+
+#pragma pack(push, 1)
+
+struct FieldSampleFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t labelCount;
+    uint64_t count;
+    uint64_t reserved;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(FieldSampleFileHeader) == 32, "FieldSampleFileHeader size mismatch");
+
+// 一个字节列的统计 (分析的第一步)
+struct ByteColumnStats {
+    uint8_t minValue;
+    uint8_t maxValue;
+    uint64_t sum;
+    uint64_t sumSquares;
+};
+
+// useSimd 为 false 时使用逐个计算的实现 (用于基准对比和校验)
+void ComputeByteColumnStats(const uint8_t* column, size_t count, ByteColumnStats& outStats, bool useSimd);
+
+class FieldSampleSet {
+public:
+    FieldSampleSet();
+
+    // 清空并设置记录长度和标签个数
+    bool Reset(uint32_t recordSize, uint32_t labelCount);
+    void Clear();
+
+    // labels 为 labelCount 个值 (labelCount 为 0 时可为空)
+    void Add(QWORD base, const uint8_t* record, const int32_t* labels);
+
+    size_t GetCount() const { return m_bases.size(); }
+    uint32_t GetRecordSize() const { return m_recordSize; }
+    uint32_t GetLabelCount() const { return m_labelCount; }
+    QWORD GetBase(size_t index) const { return m_bases[index]; }
+    const uint8_t* GetColumn(uint32_t offset) const { return m_columns[offset].data(); }
+    const int32_t* GetLabels(uint32_t label) const { return m_labels[label].data(); }
+
+    bool Write(const char* path) const;
+    bool Read(const char* path);
+
+private:
+    uint32_t m_recordSize;
+    uint32_t m_labelCount;
+    std::vector<QWORD> m_bases;
+    std::vector<std::vector<uint8_t>> m_columns;    // recordSize 列
+    std::vector<std::vector<int32_t>> m_labels;     // labelCount 列
+};
+
+// 分析样本，outCandidates 按偏移排序。没有样本时返回 false
+bool AnalyzeFieldSamples(const FieldSampleSet& samples, std::vector<FieldCandidate>& outCandidates,
+    FieldAnalysisStats& outStats, bool useSimd = true);
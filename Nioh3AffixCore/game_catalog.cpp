@@ -0,0 +1,721 @@
+#include "game_catalog.h"
+#include "aob_scanner.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace {
+    constexpr uint64_t FNV_OFFSET = 0xCBF29CE484222325ull;
+    constexpr uint64_t FNV_PRIME = 0x100000001B3ull;
+
+    // 完美哈希: 平均每桶的 ID 数和槽的最低空闲比例 (槽数为不小于 count / MAX_LOAD 的 2 的幂)
+    constexpr uint32_t BUCKET_SIZE = 4;
+    constexpr double MAX_LOAD = 0.8;
+    constexpr uint32_t MAX_SEED_ATTEMPTS = 1u << 16;
+
+    uint64_t Fnv1a(uint64_t hash, const void* data, size_t size) {
+        const uint8_t* bytes = (const uint8_t*)data;
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * FNV_PRIME;
+        }
+        return hash;
+    }
+
+    uint64_t Mix(int32_t id, uint32_t seed) {
+        uint64_t x = ((uint64_t)seed << 32) | (uint32_t)id;
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    uint64_t ElapsedMicroseconds(std::chrono::steady_clock::time_point start) {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template <typename T>
+    T Load(const uint8_t* data) {
+        T value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    void SetSignature(CatalogTableSpec& spec, const char* signature) {
+        memset(spec.signature, 0, sizeof(spec.signature));
+        strncpy(spec.signature, signature, sizeof(spec.signature) - 1);
+    }
+
+    // 追加 UTF-16LE 名称 (最多 maxUnits 个代码单元，遇到 0 结束) 的 UTF-8 编码，孤立的代理项记为 U+FFFD
+    void AppendUtf16AsUtf8(const uint8_t* data, size_t maxUnits, std::string& out) {
+        for (size_t i = 0; i < maxUnits; i++) {
+            uint32_t code = Load<uint16_t>(data + i * 2);
+            if (code == 0) {
+                break;
+            }
+            if (code >= 0xD800 && code < 0xDC00 && i + 1 < maxUnits) {
+                uint32_t low = Load<uint16_t>(data + (i + 1) * 2);
+                if (low >= 0xDC00 && low < 0xE000) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    i++;
+                } else {
+                    code = 0xFFFD;
+                }
+            } else if (code >= 0xD800 && code < 0xE000) {
+                code = 0xFFFD;
+            }
+
+            if (code < 0x80) {
+                out.push_back((char)code);
+            } else if (code < 0x800) {
+                out.push_back((char)(0xC0 | (code >> 6)));
+                out.push_back((char)(0x80 | (code & 0x3F)));
+            } else if (code < 0x10000) {
+                out.push_back((char)(0xE0 | (code >> 12)));
+                out.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back((char)(0x80 | (code & 0x3F)));
+            } else {
+                out.push_back((char)(0xF0 | (code >> 18)));
+                out.push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+                out.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back((char)(0x80 | (code & 0x3F)));
+            }
+        }
+    }
+
+    // 带计数的读取
+    struct TableReader {
+        ProcessMemory* memory;
+        CatalogStats& stats;
+
+        bool Read(QWORD address, void* buffer, size_t size) {
+            if (!memory->Read(address, buffer, size)) {
+                return false;
+            }
+            stats.reads++;
+            stats.bytesRead += size;
+            return true;
+        }
+
+        // 按 CHUNK_SIZE 分块读取一段连续内存
+        bool ReadRange(QWORD address, uint8_t* buffer, size_t size) {
+            for (size_t done = 0; done < size; done += CatalogLayout::CHUNK_SIZE) {
+                if (!Read(address + done, buffer + done, std::min<size_t>(CatalogLayout::CHUNK_SIZE, size - done))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    // 读取一批分散的地址 (每个地址需要 length 字节): 排序后相邻的合并成一次读取
+    // 合并读取失败时逐个读取；逐个读取也失败时只读到页尾 (名称可能紧挨着区域末尾)
+    class SpanReader {
+    public:
+        void Load(TableReader& reader, std::vector<QWORD> addresses, uint32_t length) {
+            m_bases.clear();
+            m_offsets.clear();
+            m_sizes.clear();
+            m_bytes.clear();
+            std::sort(addresses.begin(), addresses.end());
+            addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+
+            size_t first = 0;
+            while (first < addresses.size()) {
+                QWORD start = addresses[first];
+                QWORD end = start + length;
+                size_t last = first + 1;
+                while (last < addresses.size() && addresses[last] <= end + CatalogLayout::MERGE_GAP &&
+                    addresses[last] + length - start <= CatalogLayout::CHUNK_SIZE) {
+                    end = std::max<QWORD>(end, addresses[last] + length);
+                    last++;
+                }
+                if (!AddSpan(reader, start, (uint32_t)(end - start))) {
+                    for (size_t i = first; i < last; i++) {
+                        QWORD pageEnd = (addresses[i] | 0xFFF) + 1;
+                        if (!AddSpan(reader, addresses[i], length)) {
+                            AddSpan(reader, addresses[i], (uint32_t)std::min<QWORD>(length, pageEnd - addresses[i]));
+                        }
+                    }
+                }
+                first = last;
+            }
+        }
+
+        // 地址开始的已读字节，outAvailable 为可用长度；没有读到时返回 nullptr
+        const uint8_t* Find(QWORD address, uint32_t& outAvailable) const {
+            auto it = std::upper_bound(m_bases.begin(), m_bases.end(), address);
+            if (it == m_bases.begin()) {
+                return nullptr;
+            }
+            size_t index = (size_t)(it - m_bases.begin()) - 1;
+            QWORD delta = address - m_bases[index];
+            if (delta >= m_sizes[index]) {
+                return nullptr;
+            }
+            outAvailable = (uint32_t)(m_sizes[index] - delta);
+            return m_bytes.data() + m_offsets[index] + delta;
+        }
+
+    private:
+        std::vector<QWORD> m_bases;     // 按地址升序 (逐个读取的区间可能互相重叠)
+        std::vector<size_t> m_offsets;
+        std::vector<uint32_t> m_sizes;
+        std::vector<uint8_t> m_bytes;
+
+        bool AddSpan(TableReader& reader, QWORD address, uint32_t size) {
+            size_t offset = m_bytes.size();
+            m_bytes.resize(offset + size);
+            if (size == 0 || !reader.Read(address, m_bytes.data() + offset, size)) {
+                m_bytes.resize(offset);
+                return false;
+            }
+            m_bases.push_back(address);
+            m_offsets.push_back(offset);
+            m_sizes.push_back(size);
+            return true;
+        }
+    };
+
+    // 定位表头，outMatch 为特征码匹配的地址
+    bool LocateTable(ProcessMemory* scanMemory, TableReader& reader, const CatalogTableSpec& spec, QWORD& outMatch, QWORD& outHeader) {
+        outMatch = AobScan(scanMemory, spec.signature);
+        if (outMatch == 0) {
+            return false;
+        }
+        int32_t displacement = 0;
+        if (!reader.Read(outMatch + spec.displacementOffset, &displacement, sizeof(displacement))) {
+            return false;
+        }
+        QWORD target = outMatch + spec.instructionLength + displacement;
+        if (spec.dereference == 0) {
+            outHeader = target;
+            return true;
+        }
+        return reader.Read(target, &outHeader, sizeof(outHeader)) && outHeader != 0;
+    }
+
+    // 读出一个表的全部条目并加入 catalog，返回加入的条目数
+    uint32_t ExtractTable(ProcessMemory* scanMemory, TableReader& reader, const CatalogTableSpec& spec, CatalogKind kind,
+        GameCatalog& catalog, QWORD& outMatch) {
+        QWORD header = 0;
+        if (!IsValidCatalogSpec(spec) || !LocateTable(scanMemory, reader, spec, outMatch, header)) {
+            return 0;
+        }
+        QWORD entries = 0;
+        uint32_t count = 0;
+        if (!reader.Read(header + spec.entriesOffset, &entries, sizeof(entries)) ||
+            !reader.Read(header + spec.countOffset, &count, sizeof(count)) ||
+            entries == 0 || count < CatalogLayout::MIN_ENTRIES || count > CatalogLayout::MAX_ENTRIES) {
+            return 0;
+        }
+
+        // 条目内容: 内联数组整段读取；指针数组先读指针，再合并读取各条目
+        std::vector<uint8_t> inlineEntries;
+        SpanReader entrySpans;
+        std::vector<QWORD> entryAddresses(count);
+        if (spec.entryIndirect == 0) {
+            inlineEntries.resize((size_t)count * spec.entryStride);
+            if (!reader.ReadRange(entries, inlineEntries.data(), inlineEntries.size())) {
+                return 0;
+            }
+        } else {
+            if (!reader.ReadRange(entries, (uint8_t*)entryAddresses.data(), entryAddresses.size() * sizeof(QWORD))) {
+                return 0;
+            }
+            std::vector<QWORD> nonNull;
+            std::copy_if(entryAddresses.begin(), entryAddresses.end(), std::back_inserter(nonNull), [](QWORD address) { return address != 0; });
+            entrySpans.Load(reader, nonNull, spec.entryStride);
+        }
+
+        // 读到的 ID 按数组顺序不减 (特征码匹配到别处时读出的通常是杂乱的数据)
+        std::vector<int32_t> ids(count);
+        std::vector<QWORD> names(count, 0);
+        bool ordered = true;
+        bool anyId = false;
+        int32_t previousId = 0;
+        for (uint32_t i = 0; i < count && ordered; i++) {
+            const uint8_t* entry = nullptr;
+            uint32_t available = 0;
+            if (spec.entryIndirect == 0) {
+                entry = inlineEntries.data() + (size_t)i * spec.entryStride;
+            } else if (entryAddresses[i] != 0) {
+                entry = entrySpans.Find(entryAddresses[i], available);
+                entry = available >= spec.entryStride ? entry : nullptr;
+            }
+            if (entry != nullptr) {
+                ids[i] = Load<int32_t>(entry + spec.idOffset);
+                names[i] = Load<QWORD>(entry + spec.nameOffset);
+                ordered = !anyId || ids[i] >= previousId;
+                previousId = ids[i];
+                anyId = true;
+            }
+        }
+        if (!ordered) {
+            return 0;
+        }
+
+        std::vector<QWORD> nameAddresses;
+        nameAddresses.reserve(count);
+        for (QWORD name : names) {
+            if (name != 0) {
+                nameAddresses.push_back(name);
+            }
+        }
+        SpanReader nameSpans;
+        nameSpans.Load(reader, nameAddresses, CatalogLayout::MAX_NAME_BYTES);
+
+        std::vector<std::pair<int32_t, std::string>> named;
+        std::string name;
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t available = 0;
+            const uint8_t* text = names[i] != 0 ? nameSpans.Find(names[i], available) : nullptr;
+            if (text == nullptr) {
+                continue;
+            }
+            name.clear();
+            if (spec.nameEncoding == CATALOG_NAME_UTF16) {
+                AppendUtf16AsUtf8(text, std::min(available, CatalogLayout::MAX_NAME_BYTES) / 2, name);
+            } else {
+                const uint8_t* end = (const uint8_t*)memchr(text, 0, std::min(available, CatalogLayout::MAX_NAME_BYTES));
+                name.assign((const char*)text, end != nullptr ? (size_t)(end - text) : std::min(available, CatalogLayout::MAX_NAME_BYTES - 1));
+            }
+            if (!name.empty()) {
+                named.emplace_back(ids[i], name);
+            }
+        }
+
+        // 有名称的条目太少时不像名称表
+        if ((uint64_t)named.size() * 100 < (uint64_t)count * CatalogLayout::MIN_NAMED_PERCENT) {
+            return 0;
+        }
+        for (const auto& item : named) {
+            catalog.Add(kind, item.first, item.second.data(), item.second.size());
+        }
+        return (uint32_t)named.size();
+    }
+
+    bool ExtractTables(ProcessMemory* scanMemory, ProcessMemory* memory, const CatalogTableSpec* specs, GameCatalog& outCatalog,
+        CatalogStats& outStats, QWORD* outMatches) {
+        TableReader reader{ memory, outStats };
+        outCatalog.Clear();
+        bool found = false;
+        for (uint32_t kind = 0; kind < CatalogLayout::KIND_COUNT; kind++) {
+            outMatches[kind] = 0;
+            ExtractTable(scanMemory, reader, specs[kind], (CatalogKind)kind, outCatalog, outMatches[kind]);
+        }
+        outCatalog.Finalize();
+        for (uint32_t kind = 0; kind < CatalogLayout::KIND_COUNT; kind++) {
+            outStats.entries[kind] = outCatalog.GetCount((CatalogKind)kind);
+            found = found || outStats.entries[kind] != 0;
+        }
+        return found;
+    }
+
+    // 转发给被包装的后端，并记录开启记录后成功读取的内容 (导出内存用)
+    class RecordingMemory : public ProcessMemory {
+    public:
+        explicit RecordingMemory(ProcessMemory* inner) : m_inner(inner) {}
+
+        bool Read(QWORD address, void* buffer, size_t size, size_t* bytesRead = nullptr) override {
+            bool ok = m_inner->Read(address, buffer, size, bytesRead);
+            if (ok && size != 0) {
+                const uint8_t* bytes = (const uint8_t*)buffer;
+                std::vector<uint8_t>& region = m_regions[address];
+                if (region.size() < size) {
+                    region.assign(bytes, bytes + size);
+                }
+            }
+            return ok;
+        }
+        bool Write(QWORD, const void*, size_t) override { return false; }
+        bool Query(QWORD address, MemoryRegion& outRegion) override { return m_inner->Query(address, outRegion); }
+        bool Protect(QWORD, size_t, uint32_t, uint32_t*) override { return false; }
+        QWORD Allocate(QWORD, size_t, uint32_t) override { return 0; }
+        bool Free(QWORD) override { return false; }
+        bool GetMainModule(QWORD& baseAddress, QWORD& size) override { return m_inner->GetMainModule(baseAddress, size); }
+
+        // 合并重叠和相邻的区域
+        std::vector<std::pair<QWORD, std::vector<uint8_t>>> MergedRegions() const {
+            std::vector<std::pair<QWORD, std::vector<uint8_t>>> merged;
+            for (const auto& region : m_regions) {
+                if (!merged.empty() && region.first <= merged.back().first + merged.back().second.size()) {
+                    auto& last = merged.back();
+                    size_t overlap = (size_t)(last.first + last.second.size() - region.first);
+                    if (region.second.size() > overlap) {
+                        last.second.insert(last.second.end(), region.second.begin() + overlap, region.second.end());
+                    }
+                } else {
+                    merged.emplace_back(region.first, region.second);
+                }
+            }
+            return merged;
+        }
+
+    private:
+        ProcessMemory* m_inner;
+        std::map<QWORD, std::vector<uint8_t>> m_regions;
+    };
+}
+
+// ----------------------------------------------------------------------
+// 表描述
+// ----------------------------------------------------------------------
+
+CatalogTableSpec GetDefaultCatalogSpec(CatalogKind kind) {
+    CatalogTableSpec spec;
+    memset(&spec, 0, sizeof(spec));
+    if (kind == CATALOG_AFFIX) {
+        // mov rax, [rip+disp32] (表管理器指针); movsxd rdx, ecx; mov rcx, [rax+??]
+        SetSignature(spec, "48 8B 05 ?? ?? ?? ?? 48 63 D1 48 8B 48 ?? 48 8D 04 52");
+        spec.displacementOffset = 3;
+        spec.instructionLength = 7;
+        spec.dereference = 1;
+        spec.entriesOffset = 0x08;
+        spec.countOffset = 0x10;
+        spec.entryIndirect = 0;
+        spec.entryStride = 0x20;
+        spec.idOffset = 0x00;
+        spec.nameOffset = 0x08;
+        spec.nameEncoding = CATALOG_NAME_UTF16;
+    } else {
+        // lea rcx, [rip+disp32] (表头); call ??; test rax, rax
+        SetSignature(spec, "48 8D 0D ?? ?? ?? ?? E8 ?? ?? ?? ?? 48 85 C0 74 ?? 8B 50");
+        spec.displacementOffset = 3;
+        spec.instructionLength = 7;
+        spec.dereference = 0;
+        spec.entriesOffset = 0x00;
+        spec.countOffset = 0x08;
+        spec.entryIndirect = 1;
+        spec.entryStride = 0x18;
+        spec.idOffset = 0x00;
+        spec.nameOffset = 0x10;
+        spec.nameEncoding = CATALOG_NAME_UTF8;
+    }
+    return spec;
+}
+
+bool IsValidCatalogSpec(const CatalogTableSpec& spec) {
+    size_t signatureLength = strnlen(spec.signature, sizeof(spec.signature));
+    return signatureLength != 0 && signatureLength < sizeof(spec.signature) &&
+        spec.displacementOffset >= 0 && spec.instructionLength >= spec.displacementOffset + 4 &&
+        spec.entryStride != 0 && spec.entryStride <= CatalogLayout::MAX_ENTRY_STRIDE &&
+        spec.idOffset + sizeof(int32_t) <= spec.entryStride && spec.nameOffset + sizeof(QWORD) <= spec.entryStride &&
+        (spec.nameEncoding == CATALOG_NAME_UTF8 || spec.nameEncoding == CATALOG_NAME_UTF16);
+}
+
+uint64_t ComputeGameBuildKey(ProcessMemory* memory) {
+    QWORD moduleBase = 0;
+    QWORD moduleSize = 0;
+    std::vector<uint8_t> header(CatalogLayout::PE_HEADER_SIZE);
+    if (!GetMainModuleInfo(memory, moduleBase, moduleSize) || !memory->Read(moduleBase, header.data(), header.size())) {
+        return 0;
+    }
+    return Fnv1a(Fnv1a(FNV_OFFSET, &moduleSize, sizeof(moduleSize)), header.data(), header.size());
+}
+
+// 特征码结尾之后的字节不参与哈希
+uint64_t HashCatalogSpecs(const CatalogTableSpec* specs) {
+    uint64_t hash = FNV_OFFSET;
+    for (uint32_t kind = 0; kind < CatalogLayout::KIND_COUNT; kind++) {
+        CatalogTableSpec spec = specs[kind];
+        SetSignature(spec, std::string(specs[kind].signature, strnlen(specs[kind].signature, sizeof(spec.signature))).c_str());
+        hash = Fnv1a(hash, &spec, sizeof(spec));
+    }
+    return hash;
+}
+
+// ----------------------------------------------------------------------
+// 完美哈希
+// ----------------------------------------------------------------------
+
+void CatalogIndex::Clear() {
+    m_slotMask = 0;
+    m_seeds.clear();
+    m_slots.clear();
+}
+
+void CatalogIndex::Build(const int32_t* ids, uint32_t count) {
+    Clear();
+    if (count == 0) {
+        return;
+    }
+
+    uint32_t slotCount = 1;
+    while (slotCount < (double)count / MAX_LOAD) {
+        slotCount <<= 1;
+    }
+    const uint32_t bucketCount = (count + BUCKET_SIZE - 1) / BUCKET_SIZE;
+
+    for (;;) {
+        m_slotMask = slotCount - 1;
+        m_seeds.assign(bucketCount, 0);
+        m_slots.assign(slotCount, EMPTY);
+
+        std::vector<std::vector<uint32_t>> buckets(bucketCount);
+        for (uint32_t i = 0; i < count; i++) {
+            buckets[Mix(ids[i], 0) % bucketCount].push_back(i);
+        }
+        std::vector<uint32_t> order(bucketCount);
+        for (uint32_t b = 0; b < bucketCount; b++) {
+            order[b] = b;
+        }
+        std::stable_sort(order.begin(), order.end(),
+            [&](uint32_t a, uint32_t b) { return buckets[a].size() > buckets[b].size(); });
+
+        // 从最大的桶开始，为每个桶找一个使桶内 ID 都落在空槽且互不冲突的种子
+        bool placed = true;
+        std::vector<uint32_t> slots;
+        for (uint32_t b : order) {
+            const std::vector<uint32_t>& bucket = buckets[b];
+            if (bucket.empty()) {
+                break;
+            }
+            bool found = false;
+            for (uint32_t seed = 1; seed < MAX_SEED_ATTEMPTS && !found; seed++) {
+                slots.clear();
+                found = true;
+                for (uint32_t index : bucket) {
+                    uint32_t slot = (uint32_t)Mix(ids[index], seed) & m_slotMask;
+                    if (m_slots[slot] != EMPTY || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                        found = false;
+                        break;
+                    }
+                    slots.push_back(slot);
+                }
+                if (found) {
+                    m_seeds[b] = seed;
+                    for (size_t i = 0; i < bucket.size(); i++) {
+                        m_slots[slots[i]] = bucket[i];
+                    }
+                }
+            }
+            if (!found) {
+                placed = false;
+                break;
+            }
+        }
+        if (placed) {
+            return;
+        }
+        slotCount <<= 1;
+    }
+}
+
+uint32_t CatalogIndex::Lookup(int32_t id) const {
+    if (m_seeds.empty()) {
+        return EMPTY;
+    }
+    uint32_t seed = m_seeds[Mix(id, 0) % m_seeds.size()];
+    return seed == 0 ? EMPTY : m_slots[(uint32_t)Mix(id, seed) & m_slotMask];
+}
+
+// ----------------------------------------------------------------------
+// 目录
+// ----------------------------------------------------------------------
+
+GameCatalog::GameCatalog() {
+    Clear();
+}
+
+void GameCatalog::Clear() {
+    m_entries.clear();
+    m_strings.clear();
+    for (uint32_t kind = 0; kind < CatalogLayout::KIND_COUNT; kind++) {
+        m_kindStarts[kind] = 0;
+        m_kindCounts[kind] = 0;
+        m_indexes[kind].Clear();
+    }
+}
+
+void GameCatalog::Add(CatalogKind kind, int32_t id, const char* name, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    CatalogEntry entry;
+    entry.id = id;
+    entry.kind = kind;
+    entry.nameOffset = (uint32_t)m_strings.size();
+    entry.nameLength = (uint32_t)length;
+    m_strings.insert(m_strings.end(), name, name + length);
+    m_strings.push_back('\0');
+    m_entries.push_back(entry);
+}
+
+void GameCatalog::Finalize() {
+    // 稳定排序后去重，重复的 ID 保留先加入的；字符串池按新的顺序重建，只保留仍被引用的名称
+    std::stable_sort(m_entries.begin(), m_entries.end(), [](const CatalogEntry& a, const CatalogEntry& b) {
+        return a.kind != b.kind ? a.kind < b.kind : a.id < b.id;
+    });
+    m_entries.erase(std::unique(m_entries.begin(), m_entries.end(), [](const CatalogEntry& a, const CatalogEntry& b) {
+        return a.kind == b.kind && a.id == b.id;
+    }), m_entries.end());
+
+    std::vector<char> strings;
+    strings.reserve(m_strings.size());
+    for (CatalogEntry& entry : m_entries) {
+        const char* name = m_strings.data() + entry.nameOffset;
+        entry.nameOffset = (uint32_t)strings.size();
+        strings.insert(strings.end(), name, name + entry.nameLength + 1);
+    }
+    m_strings.swap(strings);
+
+    std::vector<int32_t> ids;
+    for (uint32_t kind = 0; kind < CatalogLayout::KIND_COUNT; kind++) {
+        auto first = std::lower_bound(m_entries.begin(), m_entries.end(), (int32_t)kind,
+            [](const CatalogEntry& entry, int32_t value) { return entry.kind < value; });
+        auto last = std::upper_bound(first, m_entries.end(), (int32_t)kind,
+            [](int32_t value, const CatalogEntry& entry) { return value < entry.kind; });
+        m_kindStarts[kind] = (uint32_t)(first - m_entries.begin());
+        m_kindCounts[kind] = (uint32_t)(last - first);
+
+        ids.clear();
+        for (auto it = first; it != last; ++it) {
+            ids.push_back(it->id);
+        }
+        m_indexes[kind].Build(ids.data(), (uint32_t)ids.size());
+    }
+}
+
+const CatalogEntry* GameCatalog::Find(CatalogKind kind, int32_t id) const {
+    if ((uint32_t)kind >= CatalogLayout::KIND_COUNT) {
+        return nullptr;
+    }
+    uint32_t index = m_indexes[kind].Lookup(id);
+    if (index == CatalogIndex::EMPTY) {
+        return nullptr;
+    }
+    const CatalogEntry& entry = m_entries[m_kindStarts[kind] + index];
+    return entry.id == id ? &entry : nullptr;
+}
+
+bool GameCatalog::Write(const char* path, uint64_t buildKey, uint64_t specHash) const {
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    CatalogCacheHeader header;
+    header.magic = CatalogLayout::CACHE_MAGIC;
+    header.version = CatalogLayout::CACHE_VERSION;
+    header.buildKey = buildKey;
+    header.specHash = specHash;
+    header.entryCount = (uint32_t)m_entries.size();
+    header.poolSize = (uint32_t)m_strings.size();
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        (m_entries.empty() || fwrite(m_entries.data(), sizeof(CatalogEntry), m_entries.size(), file) == m_entries.size()) &&
+        (m_strings.empty() || fwrite(m_strings.data(), 1, m_strings.size(), file) == m_strings.size());
+    return fclose(file) == 0 && ok;
+}
+
+bool GameCatalog::Read(const char* path, uint64_t buildKey, uint64_t specHash) {
+    Clear();
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    CatalogCacheHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+        header.magic == CatalogLayout::CACHE_MAGIC && header.version == CatalogLayout::CACHE_VERSION &&
+        header.buildKey == buildKey && header.specHash == specHash &&
+        header.entryCount <= CatalogLayout::MAX_ENTRIES * CatalogLayout::KIND_COUNT &&
+        header.poolSize <= (uint64_t)header.entryCount * CatalogLayout::MAX_NAME_BYTES * 2;
+    if (ok) {
+        m_entries.resize(header.entryCount);
+        m_strings.resize(header.poolSize);
+        ok = (m_entries.empty() || fread(m_entries.data(), sizeof(CatalogEntry), m_entries.size(), file) == m_entries.size()) &&
+            (m_strings.empty() || fread(m_strings.data(), 1, m_strings.size(), file) == m_strings.size());
+    }
+    fclose(file);
+
+    // 每个名称都必须在字符串池内并以 0 结尾
+    for (size_t i = 0; ok && i < m_entries.size(); i++) {
+        const CatalogEntry& entry = m_entries[i];
+        ok = (uint32_t)entry.kind < CatalogLayout::KIND_COUNT &&
+            (uint64_t)entry.nameOffset + entry.nameLength < m_strings.size() &&
+            m_strings[entry.nameOffset + entry.nameLength] == '\0';
+    }
+    if (!ok) {
+        Clear();
+        return false;
+    }
+    Finalize();
+    return true;
+}
+
+// ----------------------------------------------------------------------
+// 读取
+// ----------------------------------------------------------------------
+
+bool ExtractGameCatalog(ProcessMemory* memory, const CatalogTableSpec* specs, GameCatalog& outCatalog, CatalogStats& outStats) {
+    auto start = std::chrono::steady_clock::now();
+    memset(&outStats, 0, sizeof(outStats));
+    outStats.buildKey = ComputeGameBuildKey(memory);
+
+    QWORD matches[CatalogLayout::KIND_COUNT];
+    bool ok = ExtractTables(memory, memory, specs, outCatalog, outStats, matches);
+    outStats.microseconds = ElapsedMicroseconds(start);
+    return ok;
+}
+
+bool DumpCatalogImage(ProcessMemory* memory, const CatalogTableSpec* specs, const char* path) {
+    QWORD moduleBase = 0;
+    QWORD moduleSize = 0;
+    if (!GetMainModuleInfo(memory, moduleBase, moduleSize)) {
+        return false;
+    }
+
+    // 特征码扫描直接访问后端 (不记录整个主模块)，之后的读取都经过记录层
+    RecordingMemory recorder(memory);
+    GameCatalog catalog;
+    CatalogStats stats;
+    memset(&stats, 0, sizeof(stats));
+    QWORD matches[CatalogLayout::KIND_COUNT];
+    ExtractTables(memory, &recorder, specs, catalog, stats, matches);
+
+    // 载入后需要能重新计算版本键、找到特征码
+    std::vector<uint8_t> buffer(CatalogLayout::PE_HEADER_SIZE);
+    recorder.Read(moduleBase, buffer.data(), buffer.size());
+    for (QWORD match : matches) {
+        if (match == 0) {
+            continue;
+        }
+        QWORD first = std::max<QWORD>(moduleBase, match - std::min<QWORD>(match, CatalogLayout::IMAGE_CONTEXT));
+        QWORD last = std::min<QWORD>(moduleBase + moduleSize, match + CatalogLayout::IMAGE_CONTEXT);
+        buffer.resize((size_t)(last - first));
+        if (!recorder.Read(first, buffer.data(), buffer.size())) {
+            // 靠近区域边界时逐页读取
+            for (QWORD page = first & ~0xFFFull; page < last; page += 0x1000) {
+                buffer.resize(0x1000);
+                recorder.Read(page, buffer.data(), buffer.size());
+            }
+        }
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    auto regions = recorder.MergedRegions();
+    CatalogImageHeader header;
+    header.magic = CatalogLayout::IMAGE_MAGIC;
+    header.version = CatalogLayout::IMAGE_VERSION;
+    header.moduleBase = moduleBase;
+    header.moduleSize = moduleSize;
+    header.regionCount = (uint32_t)regions.size();
+    header.reserved = 0;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (size_t i = 0; ok && i < regions.size(); i++) {
+        uint64_t range[2] = { regions[i].first, regions[i].second.size() };
+        ok = fwrite(range, sizeof(range), 1, file) == 1 &&
+            fwrite(regions[i].second.data(), 1, regions[i].second.size(), file) == regions[i].second.size();
+    }
+    return fclose(file) == 0 && ok;
+}
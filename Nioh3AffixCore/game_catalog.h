@@ -0,0 +1,174 @@
+#pragma once
+
+#include "process_memory.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 游戏数据表目录: 从游戏内存中的词条表和地狱技能表直接读出 ID 与名称 (代替手工维护的 CSV)
+//
+// 定位: 按 CatalogTableSpec 的特征码在主模块中找到引用表的 RIP 相对寻址指令，由 disp32 得到表头
+// (dereference 为 1 时该地址中保存的是表头指针)。表头中是条目数组指针和条目数；条目数组可以是内联的
+// (每项 entryStride 字节)，也可以是指向条目的指针数组 (entryIndirect)。条目中是 int32 ID 和名称指针。
+// 读取: 表头、条目数组按 CHUNK_SIZE 分块整段读取；分散的条目和名称按地址排序后把相邻的合并成一次读取
+// (间隔不超过 MERGE_GAP、总长不超过 CHUNK_SIZE)，失败时退回逐个读取。
+// 目录: 所有表的条目放在一个按 (表, ID) 排序的数组中，名称 (UTF-8，以 0 结尾) 放在一个字符串池中，
+// 每个表另建一个完美哈希 (hash-and-displace: 先按 ID 分桶，再为每个桶找一个种子使桶内 ID 落在空槽)，查找只访问一个槽。
+// 缓存: 目录连同游戏版本键 (主模块 PE 头的哈希) 和表描述的哈希写入文件，两者都相同时直接读取，不再访问游戏内存。
+//
+// 校验: 特征码可能匹配到别的代码，读出的表必须像一张数据表才加入目录: 条目数不少于 MIN_ENTRIES，
+// 读到的 ID 按数组顺序不减，至少 MIN_NAMED_PERCENT% 的条目有名称；不符时按找不到处理 (不加入目录，也不写缓存)。
+// 内置的特征码和条目布局 (GetDefaultCatalogSpec) 尚未在所有游戏版本上确认，同样经过上述校验；
+// 与游戏不符时可以由调用者传入自己的 CatalogTableSpec，或用 DumpCatalogImage 导出读到的内存离线分析。
+namespace CatalogLayout {
+    constexpr uint32_t KIND_COUNT = 2;
+    constexpr uint32_t MAX_SIGNATURE = 128;
+    constexpr uint32_t MIN_ENTRIES = 4;
+    constexpr uint32_t MAX_ENTRIES = 0x100000;
+    constexpr uint32_t MIN_NAMED_PERCENT = 50;
+    constexpr uint32_t MAX_ENTRY_STRIDE = 0x1000;
+    constexpr uint32_t MAX_NAME_BYTES = 256;            // 游戏中一个名称最多读取的字节数 (含结尾的 0)
+    constexpr uint32_t CHUNK_SIZE = 0x100000;
+    constexpr uint32_t MERGE_GAP = 0x1000;
+    constexpr uint32_t PE_HEADER_SIZE = 0x1000;         // 版本键覆盖的主模块开头字节数
+    constexpr uint32_t IMAGE_CONTEXT = 0x2000;          // 导出内存时特征码前后各保留的字节数
+
+    constexpr uint32_t CACHE_MAGIC = 0x4347334E;        // "N3GC"
+    constexpr uint32_t CACHE_VERSION = 1;
+    constexpr uint32_t IMAGE_MAGIC = 0x4954334E;        // "N3TI"
+    constexpr uint32_t IMAGE_VERSION = 1;
+}
+
+// 与导出函数 SessionLoadGameCatalog 等共用
+enum CatalogKind {
+    CATALOG_AFFIX = 0,
+    CATALOG_UNDERWORLD_SKILL = 1
+};
+
+enum CatalogNameEncoding {
+    CATALOG_NAME_UTF8 = 0,
+    CATALOG_NAME_UTF16 = 1
+};
+
+// 一个表的定位方式和条目布局 (与导出函数 SessionLoadGameCatalog 共用)
+struct CatalogTableSpec {
+    char signature[CatalogLayout::MAX_SIGNATURE];   // AOB 特征码 (?? 为通配符)，以 0 结尾
+    int32_t displacementOffset;     // disp32 相对匹配开头的偏移
+    int32_t instructionLength;      // disp32 相对于匹配开头 + instructionLength
+    uint32_t dereference;           // 1: 目标地址中保存表头指针；0: 目标地址就是表头
+    uint32_t entriesOffset;         // 表头中条目数组指针的偏移
+    uint32_t countOffset;           // 表头中条目数 (uint32) 的偏移
+    uint32_t entryIndirect;         // 1: 条目数组中是指向条目的指针
+    uint32_t entryStride;           // 条目长度 (内联数组的间隔)
+    uint32_t idOffset;              // 条目中 int32 ID 的偏移
+    uint32_t nameOffset;            // 条目中名称指针的偏移
+    uint32_t nameEncoding;          // CatalogNameEncoding
+};
+
+// 目录中的一项 (与导出函数 SessionGetCatalogEntries 共用)
+struct CatalogEntry {
+    int32_t id;
+    int32_t kind;                   // CatalogKind
+    uint32_t nameOffset;            // 名称在字符串池中的偏移
+    uint32_t nameLength;            // 字节数 (不含结尾的 0)
+};
+
+struct CatalogStats {
+    uint64_t buildKey;              // 游戏版本键
+    uint64_t bytesRead;             // 从游戏内存读取的字节数 (特征码扫描除外)
+    uint64_t microseconds;
+    uint32_t entries[CatalogLayout::KIND_COUNT];    // 每个表的条目数
+    uint32_t reads;                 // 读取次数 (特征码扫描除外)
+    uint32_t fromCache;             // 1: 从缓存文件读取
+};
+
+#pragma pack(push, 1)
+
+struct CatalogCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t buildKey;
+    uint64_t specHash;
+    uint32_t entryCount;
+    uint32_t poolSize;
+};
+
+struct CatalogImageHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t moduleBase;
+    uint64_t moduleSize;
+    uint32_t regionCount;           // 之后每个区域为 u64 基址、u64 长度和内容
+    uint32_t reserved;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(CatalogCacheHeader) == 32, "CatalogCacheHeader size mismatch");
+static_assert(sizeof(CatalogImageHeader) == 32, "CatalogImageHeader size mismatch");
+
+CatalogTableSpec GetDefaultCatalogSpec(CatalogKind kind);
+bool IsValidCatalogSpec(const CatalogTableSpec& spec);
+
+// 主模块 PE 头的 FNV-1a (含模块大小)，读取失败时返回 0
+uint64_t ComputeGameBuildKey(ProcessMemory* memory);
+uint64_t HashCatalogSpecs(const CatalogTableSpec* specs);
+
+// 完美哈希查找表 (只保存条目下标，不复制 ID)
+class CatalogIndex {
+public:
+    // ids[i] 互不相同
+    void Build(const int32_t* ids, uint32_t count);
+    void Clear();
+
+    // 返回可能匹配的条目下标 (调用者需核对 ID)，没有时返回 EMPTY
+    uint32_t Lookup(int32_t id) const;
+
+    static constexpr uint32_t EMPTY = 0xFFFFFFFFu;
+
+private:
+    uint32_t m_slotMask = 0;
+    std::vector<uint32_t> m_seeds;      // 每个桶的种子
+    std::vector<uint32_t> m_slots;      // 条目下标
+};
+
+class GameCatalog {
+public:
+    GameCatalog();
+
+    void Clear();
+
+    // 同一个表中重复的 ID 只保留第一个；名称为空的不加入
+    void Add(CatalogKind kind, int32_t id, const char* name, size_t length);
+
+    // 排序并为每个表建完美哈希 (Add 之后、查找之前调用)
+    void Finalize();
+
+    bool IsEmpty() const { return m_entries.empty(); }
+    uint32_t GetCount(CatalogKind kind) const { return m_kindCounts[kind]; }
+    const CatalogEntry* GetEntries(CatalogKind kind) const { return m_entries.data() + m_kindStarts[kind]; }
+    const std::vector<char>& GetStrings() const { return m_strings; }
+    const char* GetName(const CatalogEntry& entry) const { return m_strings.data() + entry.nameOffset; }
+
+    // 没有时返回 nullptr
+    const CatalogEntry* Find(CatalogKind kind, int32_t id) const;
+
+    bool Write(const char* path, uint64_t buildKey, uint64_t specHash) const;
+    // 文件的版本键或表描述的哈希与参数不同时返回 false
+    bool Read(const char* path, uint64_t buildKey, uint64_t specHash);
+
+private:
+    std::vector<CatalogEntry> m_entries;
+    std::vector<char> m_strings;
+    uint32_t m_kindStarts[CatalogLayout::KIND_COUNT];
+    uint32_t m_kindCounts[CatalogLayout::KIND_COUNT];
+    CatalogIndex m_indexes[CatalogLayout::KIND_COUNT];
+};
+
+// 按 specs (KIND_COUNT 项) 读出所有表，结果替换 outCatalog (已 Finalize)
+// 找不到的表条目数为 0；所有表都找不到时返回 false
+bool ExtractGameCatalog(ProcessMemory* memory, const CatalogTableSpec* specs, GameCatalog& outCatalog, CatalogStats& outStats);
+
+// 与 ExtractGameCatalog 读取相同的内容，把读到的内存 (外加主模块 PE 头和特征码前后 IMAGE_CONTEXT 字节) 写入 path
+// 文件可在任意平台上重新载入为进程快照并用同样的 specs 解码
+bool DumpCatalogImage(ProcessMemory* memory, const CatalogTableSpec* specs, const char* path);
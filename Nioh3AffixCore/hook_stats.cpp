@@ -0,0 +1,100 @@
+#include "hook_stats.h"
+#include <cstddef>
+
+bool HookStatsBlock::Initialize(ProcessMemory* memory, RemoteArena* arena, bool allowShared) {
+    Release();
+    return m_block.Initialize(memory, arena, TOTAL_SIZE, allowShared);
+}
+
+QWORD HookStatsBlock::GetSlotAddress(uint8_t source) const {
+    if (!m_block.IsInitialized() || source == 0 || source > HookStatsLayout::SLOT_COUNT) {
+        return 0;
+    }
+    return m_block.GetAddress() + (QWORD)(source - 1) * sizeof(HookStats);
+}
+
+bool HookStatsBlock::Read(uint8_t source, HookStats& outStats) {
+    if (GetSlotAddress(source) == 0) {
+        return false;
+    }
+    return m_block.Read((size_t)(source - 1) * sizeof(HookStats), &outStats, sizeof(outStats));
+}
+
+bool HookStatsBlock::EmitBegin(X64Emitter& emitter, QWORD slotAddress, X64Reg startRegister) {
+    /*
+        (以 startRegister = r10 为例)
+        4D 31 D2                ; xor r10, r10          (start = 0 表示本次不采样)
+        B8 01000000             ; mov eax, 1
+        F0 48 0F C1 05 [hits]   ; lock xadd [rip+hits], rax
+        48 25 [imm32]           ; and rax, SAMPLE_INTERVAL-1
+        0F 85 [skip]            ; jne skip
+        0F 31                   ; rdtsc
+        48 C1 E2 20             ; shl rdx, 32
+        48 09 D0                ; or rax, rdx
+        49 89 C2                ; mov r10, rax
+    skip:
+    */
+    if (slotAddress == 0) {
+        return false;
+    }
+
+    X64Label skip;
+    emitter.XorReg(startRegister, startRegister);
+    emitter.MovImm32(X64Reg::Rax, 1);
+    emitter.LockXaddRip(slotAddress + offsetof(HookStats, hits), X64Reg::Rax);
+    emitter.AndImm32(X64Reg::Rax, (int32_t)(HookStatsLayout::SAMPLE_INTERVAL - 1));
+    emitter.Jcc(X64Cond::NotEqual, skip);
+    emitter.Rdtsc();
+    emitter.ShlImm8(X64Reg::Rdx, 32);
+    emitter.OrReg(X64Reg::Rax, X64Reg::Rdx);
+    emitter.MovReg(startRegister, X64Reg::Rax);
+    emitter.Bind(skip);
+    return emitter.Ok();
+}
+
+bool HookStatsBlock::EmitEnd(X64Emitter& emitter, QWORD slotAddress, X64Reg startRegister) {
+    /*
+        4D 85 D2                ; test r10, r10
+        0F 84 [done]            ; je done
+        0F 31                   ; rdtsc
+        48 C1 E2 20             ; shl rdx, 32
+        48 09 D0                ; or rax, rdx
+        4C 29 D0                ; sub rax, r10          -> 周期数
+        48 8D 15 [slot]         ; lea rdx, [rip+slot]
+        F0 48 01 42 10          ; lock add [rdx+totalCycles], rax
+        41 B8 01000000          ; mov r8d, 1
+        F0 4C 01 42 08          ; lock add [rdx+samples], r8
+        48 0F BD C8             ; bsr rcx, rax
+        0F 85 [bucket]          ; jne bucket            (rax 为 0 时 ZF=1)
+        48 31 C9                ; xor rcx, rcx
+    bucket:
+        48 C1 E1 03             ; shl rcx, 3
+        48 01 CA                ; add rdx, rcx
+        F0 4C 01 42 18          ; lock add [rdx+histogram], r8
+    done:
+    */
+    if (slotAddress == 0) {
+        return false;
+    }
+
+    X64Label bucket, done;
+    emitter.TestReg(startRegister, startRegister);
+    emitter.Jcc(X64Cond::Equal, done);
+    emitter.Rdtsc();
+    emitter.ShlImm8(X64Reg::Rdx, 32);
+    emitter.OrReg(X64Reg::Rax, X64Reg::Rdx);
+    emitter.SubReg(X64Reg::Rax, startRegister);
+    emitter.LeaRip(X64Reg::Rdx, slotAddress);
+    emitter.LockAdd(X64Reg::Rdx, (int32_t)offsetof(HookStats, totalCycles), X64Reg::Rax);
+    emitter.MovImm32(X64Reg::R8, 1);
+    emitter.LockAdd(X64Reg::Rdx, (int32_t)offsetof(HookStats, samples), X64Reg::R8);
+    emitter.Bsr(X64Reg::Rcx, X64Reg::Rax);
+    emitter.Jcc(X64Cond::NotEqual, bucket);
+    emitter.XorReg(X64Reg::Rcx, X64Reg::Rcx);
+    emitter.Bind(bucket);
+    emitter.ShlImm8(X64Reg::Rcx, 3);
+    emitter.AddReg(X64Reg::Rdx, X64Reg::Rcx);
+    emitter.LockAdd(X64Reg::Rdx, (int32_t)offsetof(HookStats, histogram), X64Reg::R8);
+    emitter.Bind(done);
+    return emitter.Ok();
+}
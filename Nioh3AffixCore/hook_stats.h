@@ -0,0 +1,80 @@
+#pragma once
+
+#include "process_memory.h"
+#include "remote_arena.h"
+#include "remote_block.h"
+#include "x64_emitter.h"
+#include <cstdint>
+
+// hook 命中统计 (插桩版 hook 代码写入，由所有捕获 hook 共用，传输方式同 RemoteBlock)
+//
+// 布局: HookStats * SLOT_COUNT，下标为捕获来源 - 1 (CaptureRingLayout::SOURCE_*)
+//
+// 插桩代码包在 hook 主体 (环形缓冲区追加 + 信箱应用) 两侧:
+//   old = lock xadd [hits], 1
+//   if ((old & (SAMPLE_INTERVAL - 1)) == 0) start = rdtsc      ; 每 SAMPLE_INTERVAL 次命中采样一次
+//   ... hook 主体 ...
+//   if (start) {
+//       delta = rdtsc - start
+//       lock add [totalCycles], delta; lock add [samples], 1
+//       lock add [histogram[bsr(delta)]], 1                     ; 按 2 的幂分桶
+//   }
+//
+// rdtsc 不是串行化指令，单次采样只是近似值，看分布和均值即可。
+// 不包括寄存器保存/恢复和跳转本身 (这部分开销在 Linux 上用 hook_bench 测量)。
+namespace HookStatsLayout {
+    constexpr uint32_t SAMPLE_INTERVAL = 16;    // 必须是 2 的幂
+    constexpr int HISTOGRAM_BUCKETS = 64;       // 第 i 桶: [2^i, 2^(i+1)) 周期 (0 周期计入第 0 桶)
+    constexpr int SLOT_COUNT = 2;
+}
+
+#pragma pack(push, 1)
+
+// 布局与导出函数 SessionGetHookStats 共用
+struct HookStats {
+    uint64_t hits;          // 命中次数
+    uint64_t samples;       // 采样次数
+    uint64_t totalCycles;   // 采样的周期数之和
+    uint64_t histogram[HookStatsLayout::HISTOGRAM_BUCKETS];
+};
+
+#pragma pack(pop)
+
+static_assert((HookStatsLayout::SAMPLE_INTERVAL & (HookStatsLayout::SAMPLE_INTERVAL - 1)) == 0, "sample interval must be a power of two");
+
+class HookStatsBlock {
+public:
+    static constexpr size_t TOTAL_SIZE = sizeof(HookStats) * HookStatsLayout::SLOT_COUNT;
+
+    HookStatsBlock() = default;
+    ~HookStatsBlock() { Release(); }
+
+    HookStatsBlock(const HookStatsBlock&) = delete;
+    HookStatsBlock& operator=(const HookStatsBlock&) = delete;
+
+    bool Initialize(ProcessMemory* memory, RemoteArena* arena, bool allowShared = true);
+    void Release() { m_block.Release(); }
+    void Abandon() { m_block.Abandon(); }
+
+    // 接管常驻代码洞中的统计块 (计数保留)
+    bool Adopt(ProcessMemory* memory, RemoteArena* arena, QWORD address) { return m_block.Adopt(memory, arena, address, TOTAL_SIZE); }
+
+    bool IsInitialized() const { return m_block.IsInitialized(); }
+    bool IsShared() const { return m_block.IsShared(); }
+    QWORD GetAddress() const { return m_block.GetAddress(); }
+
+    // 某个捕获来源的统计槽位地址，来源无效或未分配时返回 0
+    QWORD GetSlotAddress(uint8_t source) const;
+
+    // 读出某个来源的统计
+    bool Read(uint8_t source, HookStats& outStats);
+
+    // 生成插桩代码，放在 hook 主体前后
+    // 会改写 rax/rcx/rdx/r8 和标志位；startRegister 在两段之间保存起始时间戳，主体不能改写它
+    // 均由调用者保存和恢复
+    static bool EmitBegin(X64Emitter& emitter, QWORD slotAddress, X64Reg startRegister);
+    static bool EmitEnd(X64Emitter& emitter, QWORD slotAddress, X64Reg startRegister);
+
+private:
+    RemoteBlock m_block;
+};
@@ -0,0 +1,68 @@
+#include "integrity_monitor.h"
+#include "resident_cave.h"
+#include <algorithm>
+#include <vector>
+
+void CheckIntegrityRanges(ProcessMemory* memory, const IntegrityRange* ranges, size_t count, uint8_t* outStates,
+    uint32_t& outReads, uint32_t& outBytes) {
+    outReads = 0;
+    outBytes = 0;
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < count; i++) {
+        outStates[i] = INTEGRITY_UNWATCHED;
+        if (ranges[i].size != 0) {
+            order.push_back(i);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return ranges[a].address < ranges[b].address; });
+
+    std::vector<uint8_t> buffer;
+    size_t next = 0;
+    while (next < order.size()) {
+        // 从 next 开始合并相邻的范围
+        QWORD start = ranges[order[next]].address;
+        QWORD end = start + ranges[order[next]].size;
+        size_t last = next + 1;
+        while (last < order.size()) {
+            const IntegrityRange& range = ranges[order[last]];
+            QWORD rangeEnd = std::max(end, range.address + range.size);
+            if (range.address > end + IntegrityLayout::MERGE_GAP || rangeEnd - start > IntegrityLayout::MAX_MERGED_READ) {
+                break;
+            }
+            end = rangeEnd;
+            last++;
+        }
+
+        buffer.resize((size_t)(end - start));
+        bool merged = memory->Read(start, buffer.data(), buffer.size());
+        outReads++;
+        outBytes += merged ? (uint32_t)buffer.size() : 0;
+
+        const bool single = last - next == 1;
+        for (; next < last; next++) {
+            const IntegrityRange& range = ranges[order[next]];
+            uint8_t* bytes = buffer.data() + (range.address - start);
+            // 合并读取失败时单独重读 (只有一个范围时不再重复读取)
+            bool ok = merged;
+            if (!ok && !single) {
+                ok = memory->Read(range.address, bytes, range.size);
+                outReads++;
+                outBytes += ok ? range.size : 0;
+            }
+            if (!ok) {
+                outStates[order[next]] = INTEGRITY_UNKNOWN;
+                continue;
+            }
+
+            uint64_t hash = HashResidentBytes(bytes, range.size);
+            if (hash == range.expectedHash) {
+                outStates[order[next]] = INTEGRITY_INTACT;
+            } else if (range.originalHash != 0 && hash == range.originalHash) {
+                outStates[order[next]] = INTEGRITY_REVERTED;
+            } else {
+                outStates[order[next]] = INTEGRITY_FOREIGN;
+            }
+        }
+    }
+}
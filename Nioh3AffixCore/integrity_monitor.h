@@ -0,0 +1,67 @@
+#pragma once
+
+#include "process_memory.h"
+#include <cstddef>
+#include <cstdint>
+
+// 补丁完整性检查
+//
+// 游戏自己重新改写代码、或其它工具/覆盖层 hook 了同一位置时，注入器仍然认为自己处于启用状态，
+// 撤下时会把过期的原始字节写回去。完整性检查定期核对我们改写过的所有位置:
+//   - 注入点 (capture hook 的跳转、技能绕过的 nop): 当前字节是我们写入的 -> INTACT
+//                                                    是原始字节 (被游戏恢复) -> REVERTED
+//                                                    都不是 -> FOREIGN
+//   - 代码洞中的 hook 代码: 与写入时一致 -> INTACT，否则 -> FOREIGN
+//   - 读不到的位置 -> UNKNOWN (无法判断，不改变注入器状态，下次检查再读)
+// 每个位置只保存写入时的 64 位哈希 (FNV-1a)，不保存副本。所有位置按地址排序，相距不超过 MERGE_GAP 的
+// 合并为一次读取: 注入点都在主模块代码段中，hook 代码都在代码洞中，通常只需 2~3 次读取。
+// 合并读取失败 (如间隔中有未提交的页) 时逐个位置重读，一个位置读不到不会牵连相邻的位置。
+//
+// REVERTED 的位置已经不再跳向代码洞，可以直接当作已撤下；FOREIGN 的位置不能再写回原始字节
+// (会覆盖别人的改写，别人的跳板也可能仍然跳向我们的代码洞)，注入器拒绝撤下，分离时代码洞保留。
+namespace IntegrityLayout {
+    constexpr uint32_t MERGE_GAP = 0x1000;
+    constexpr uint32_t MAX_MERGED_READ = 0x10000;   // 超过时分成多次读取
+}
+
+// 受监视的位置 (与导出函数 SessionCheckIntegrity 共用)
+enum IntegritySite {
+    INTEGRITY_SITE_WEAPON_PATCH = 0,
+    INTEGRITY_SITE_WEAPON_CODE = 1,
+    INTEGRITY_SITE_ARMOR_PATCH = 2,
+    INTEGRITY_SITE_ARMOR_CODE = 3,
+    INTEGRITY_SITE_SKILL_PATCH1 = 4,
+    INTEGRITY_SITE_SKILL_PATCH2 = 5,
+    INTEGRITY_SITE_COUNT = 6
+};
+
+enum IntegrityState {
+    INTEGRITY_UNWATCHED = 0,    // 当前没有改写 (未启用或未找到)
+    INTEGRITY_INTACT = 1,
+    INTEGRITY_REVERTED = 2,     // 已是原始字节
+    INTEGRITY_FOREIGN = 3,      // 被其它程序改写
+    INTEGRITY_UNKNOWN = 4       // 读取失败，无法判断
+};
+
+// 一个受监视的范围，size 为 0 表示不监视
+struct IntegrityRange {
+    QWORD address;
+    uint32_t size;
+    uint64_t expectedHash;      // 我们写入的字节的哈希
+    uint64_t originalHash;      // 原始字节的哈希 (hook 代码没有原始字节，为 0)
+};
+
+// 检查的开销 (与导出函数 SessionCheckIntegrity 共用)
+struct IntegrityStats {
+    uint64_t checks;                // 累计检查次数
+    uint64_t lastCheckMicroseconds; // 最近一次检查的耗时
+    uint32_t lastReads;             // 最近一次检查的读取次数
+    uint32_t lastBytes;             // 最近一次检查读取的字节数
+    uint8_t states[INTEGRITY_SITE_COUNT];   // IntegrityState
+    uint8_t reserved[2];
+};
+
+// 一次检查所有范围，outStates[i] 为 ranges[i] 的 IntegrityState
+// 合并读取失败时逐个范围重读，仍读不到的范围为 UNKNOWN；outReads / outBytes 返回读取次数和字节数
+void CheckIntegrityRanges(ProcessMemory* memory, const IntegrityRange* ranges, size_t count, uint8_t* outStates,
+    uint32_t& outReads, uint32_t& outBytes);
@@ -0,0 +1,312 @@
+#include "inventory_layout.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+namespace {
+    // 数组指针字段附近可能的元素数字段 (相对数组指针字段的偏移)
+    struct CountCandidate {
+        int32_t delta;
+        InventoryCountKind kind;
+    };
+
+    const CountCandidate COUNT_CANDIDATES[] = {
+        { 8, INVENTORY_COUNT_END_POINTER },     // { begin, end, capacity }
+        { 8, INVENTORY_COUNT_U32 },             // { data, count, capacity }
+        { 16, INVENTORY_COUNT_U32 },            // { data, capacity, count }
+        { -8, INVENTORY_COUNT_U32 },            // { count, data }
+        { -4, INVENTORY_COUNT_U32 }
+    };
+
+    // 低于此值的 qword 不会是数组指针
+    constexpr QWORD MIN_POINTER = 0x10000;
+
+    uint64_t Gcd(uint64_t a, uint64_t b) {
+        while (b != 0) {
+            uint64_t t = a % b;
+            a = b;
+            b = t;
+        }
+        return a;
+    }
+
+    // 读出容器开头，靠近区域末尾读不满时逐次减半
+    bool ReadOwnerWindow(ProcessMemory* memory, QWORD owner, std::vector<uint8_t>& outWindow) {
+        for (uint32_t size = InventoryScanLayout::OWNER_SCAN_SIZE; size >= InventoryScanLayout::MIN_OWNER_SCAN_SIZE; size /= 2) {
+            outWindow.resize(size);
+            if (memory->Read(owner, outWindow.data(), size)) {
+                return true;
+            }
+        }
+        outWindow.clear();
+        return false;
+    }
+
+    bool LoadField(const std::vector<uint8_t>& window, int64_t offset, size_t size, uint64_t& outValue) {
+        if (offset < 0 || (size_t)offset + size > window.size()) {
+            return false;
+        }
+        outValue = 0;
+        memcpy(&outValue, window.data() + offset, size);
+        return true;
+    }
+
+    size_t CountFieldSize(InventoryCountKind kind) {
+        return kind == INVENTORY_COUNT_END_POINTER ? sizeof(QWORD) : sizeof(uint32_t);
+    }
+
+    // 元素数字段的值 -> 元素数；推导时 (allowEmpty 为 false) 数组中至少有已捕获的装备
+    bool CountFromField(InventoryCountKind kind, uint64_t value, QWORD arrayAddress, uint32_t elementSize, bool allowEmpty,
+        uint32_t& outCount) {
+        uint64_t count;
+        if (kind == INVENTORY_COUNT_END_POINTER) {
+            if (value < arrayAddress || (value - arrayAddress) % elementSize != 0) {
+                return false;
+            }
+            count = (value - arrayAddress) / elementSize;
+        } else {
+            count = (uint32_t)value;
+        }
+        if (count > InventoryScanLayout::MAX_COUNT || (count == 0 && !allowEmpty)) {
+            return false;
+        }
+        outCount = (uint32_t)count;
+        return true;
+    }
+
+    // 不小于一条装备记录、8 字节对齐的 g 的最小约数，没有时返回 0
+    uint32_t SmallestRecordDivisor(uint64_t g) {
+        for (uint32_t stride = (InventoryScanLayout::RECORD_SIZE + 7) & ~7u; stride <= InventoryScanLayout::MAX_STRIDE; stride += 8) {
+            if (g % stride == 0) {
+                return stride;
+            }
+        }
+        return 0;
+    }
+
+    bool MatchPointerArray(ProcessMemory* memory, QWORD arrayAddress, uint32_t count, const QWORD* itemBases, size_t itemCount) {
+        if (count < itemCount) {
+            return false;
+        }
+        std::vector<QWORD> pointers(count);
+        if (!memory->Read(arrayAddress, pointers.data(), pointers.size() * sizeof(QWORD))) {
+            return false;
+        }
+        std::unordered_set<QWORD> present(pointers.begin(), pointers.end());
+        for (size_t i = 0; i < itemCount; i++) {
+            if (present.count(itemBases[i]) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 内联数组: 返回 stride，不符合时返回 0
+    // spanBytes 非 0 时 (结束指针) stride 同时要整除数组总长度；count 非 0 时所有下标都要小于它
+    uint32_t MatchInlineArray(QWORD arrayAddress, uint64_t spanBytes, uint32_t count, const QWORD* itemBases, size_t itemCount) {
+        uint64_t g = 0;
+        for (size_t i = 0; i < itemCount; i++) {
+            if (itemBases[i] < arrayAddress) {
+                return 0;
+            }
+            g = Gcd(g, itemBases[i] - arrayAddress);
+        }
+        // 只有位于数组开头的一件装备时无法确定 stride
+        uint32_t stride = g != 0 ? SmallestRecordDivisor(Gcd(g, spanBytes)) : 0;
+        if (stride == 0) {
+            return 0;
+        }
+
+        uint64_t elements = spanBytes != 0 ? spanBytes / stride : count;
+        if (elements == 0 || elements > InventoryScanLayout::MAX_COUNT) {
+            return 0;
+        }
+        for (size_t i = 0; i < itemCount; i++) {
+            if ((itemBases[i] - arrayAddress) / stride >= elements) {
+                return 0;
+            }
+        }
+        return stride;
+    }
+
+    void AppendRecord(const uint8_t* bytes, std::vector<uint8_t>& outRecords) {
+        outRecords.insert(outRecords.end(), bytes, bytes + InventoryScanLayout::RECORD_SIZE);
+    }
+
+    // 指针数组中的装备: 按地址排序后相邻的合并为一次读取，再按数组顺序输出
+    bool ReadPointedRecords(ProcessMemory* memory, const std::vector<QWORD>& bases, std::vector<uint8_t>& outRecords) {
+        std::vector<QWORD> sorted(bases);
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+        struct Span {
+            QWORD start;
+            QWORD end;
+            std::vector<uint8_t> bytes;
+        };
+        std::vector<Span> spans;
+        for (QWORD base : sorted) {
+            QWORD end = base + InventoryScanLayout::RECORD_SIZE;
+            if (!spans.empty() && base <= spans.back().end + InventoryScanLayout::MERGE_GAP &&
+                end - spans.back().start <= InventoryScanLayout::MAX_MERGED_READ) {
+                spans.back().end = std::max(spans.back().end, end);
+            } else {
+                spans.push_back({ base, end, {} });
+            }
+        }
+        for (Span& span : spans) {
+            span.bytes.resize((size_t)(span.end - span.start));
+            if (!memory->Read(span.start, span.bytes.data(), span.bytes.size())) {
+                return false;
+            }
+        }
+
+        for (QWORD base : bases) {
+            auto span = std::upper_bound(spans.begin(), spans.end(), base,
+                [](QWORD address, const Span& s) { return address < s.start; }) - 1;
+            AppendRecord(span->bytes.data() + (base - span->start), outRecords);
+        }
+        return true;
+    }
+}
+
+bool DeriveInventoryLayout(ProcessMemory* memory, QWORD owner, const QWORD* itemBases, size_t itemCount,
+    InventoryLayout& outLayout) {
+    if (owner == 0 || itemBases == nullptr || itemCount == 0) {
+        return false;
+    }
+
+    std::vector<uint8_t> window;
+    if (!ReadOwnerWindow(memory, owner, window)) {
+        return false;
+    }
+
+    InventoryLayout layout;
+    memset(&layout, 0, sizeof(layout));
+    layout.owner = owner;
+
+    // 第一遍: 指针数组；第二遍: 内联数组
+    for (int pass = 0; pass < 2; pass++) {
+        const bool pointers = pass == 0;
+        for (uint32_t offset = 0; offset + sizeof(QWORD) <= window.size(); offset += sizeof(QWORD)) {
+            QWORD arrayAddress = 0;
+            LoadField(window, offset, sizeof(QWORD), arrayAddress);
+            if (arrayAddress < MIN_POINTER || (arrayAddress & 7) != 0) {
+                continue;
+            }
+
+            for (const CountCandidate& candidate : COUNT_CANDIDATES) {
+                int64_t countOffset = (int64_t)offset + candidate.delta;
+                uint64_t value = 0;
+                if (!LoadField(window, countOffset, CountFieldSize(candidate.kind), value)) {
+                    continue;
+                }
+
+                uint32_t count = 0;
+                uint32_t stride = 0;
+                if (pointers) {
+                    if (!CountFromField(candidate.kind, value, arrayAddress, sizeof(QWORD), false, count) ||
+                        !MatchPointerArray(memory, arrayAddress, count, itemBases, itemCount)) {
+                        continue;
+                    }
+                    stride = sizeof(QWORD);
+                } else {
+                    uint64_t spanBytes = 0;
+                    if (candidate.kind == INVENTORY_COUNT_END_POINTER) {
+                        if (value <= arrayAddress ||
+                            value - arrayAddress > (uint64_t)InventoryScanLayout::MAX_COUNT * InventoryScanLayout::MAX_STRIDE) {
+                            continue;
+                        }
+                        spanBytes = value - arrayAddress;
+                    } else if (!CountFromField(candidate.kind, value, arrayAddress, 1, false, count)) {
+                        continue;
+                    }
+                    stride = MatchInlineArray(arrayAddress, spanBytes, count, itemBases, itemCount);
+                    if (stride == 0) {
+                        continue;
+                    }
+                    if (spanBytes != 0) {
+                        count = (uint32_t)(spanBytes / stride);
+                    }
+                }
+
+                layout.arrayAddress = arrayAddress;
+                layout.arrayFieldOffset = offset;
+                layout.countFieldOffset = (uint32_t)countOffset;
+                layout.stride = stride;
+                layout.count = count;
+                layout.arrayKind = pointers ? INVENTORY_ARRAY_POINTERS : INVENTORY_ARRAY_INLINE;
+                layout.countKind = candidate.kind;
+                outLayout = layout;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool ReadInventoryRecords(ProcessMemory* memory, InventoryLayout& layout, std::vector<QWORD>& outBases,
+    std::vector<uint8_t>& outRecords) {
+    outBases.clear();
+    outRecords.clear();
+    if (layout.arrayKind != INVENTORY_ARRAY_INLINE && layout.arrayKind != INVENTORY_ARRAY_POINTERS) {
+        return false;
+    }
+    const bool pointers = layout.arrayKind == INVENTORY_ARRAY_POINTERS;
+    const InventoryCountKind countKind = (InventoryCountKind)layout.countKind;
+    if ((pointers && layout.stride != sizeof(QWORD)) || (!pointers && layout.stride < InventoryScanLayout::RECORD_SIZE)) {
+        return false;
+    }
+
+    // 一次读出容器中的数组指针和元素数字段
+    uint32_t first = std::min(layout.arrayFieldOffset, layout.countFieldOffset);
+    uint32_t last = std::max(layout.arrayFieldOffset + (uint32_t)sizeof(QWORD),
+        layout.countFieldOffset + (uint32_t)CountFieldSize(countKind));
+    std::vector<uint8_t> fields(last - first);
+    if (!memory->Read(layout.owner + first, fields.data(), fields.size())) {
+        return false;
+    }
+
+    QWORD arrayAddress = 0;
+    uint64_t countValue = 0;
+    uint32_t count = 0;
+    LoadField(fields, layout.arrayFieldOffset - first, sizeof(QWORD), arrayAddress);
+    LoadField(fields, layout.countFieldOffset - first, CountFieldSize(countKind), countValue);
+    if (!CountFromField(countKind, countValue, arrayAddress, layout.stride, true, count)) {
+        return false;
+    }
+    layout.arrayAddress = arrayAddress;
+    layout.count = count;
+    if (count == 0) {
+        return true;
+    }
+
+    std::vector<uint8_t> elements((size_t)count * layout.stride);
+    if (!memory->Read(arrayAddress, elements.data(), elements.size())) {
+        return false;
+    }
+
+    if (!pointers) {
+        outRecords.reserve((size_t)count * InventoryScanLayout::RECORD_SIZE);
+        for (uint32_t i = 0; i < count; i++) {
+            outBases.push_back(arrayAddress + (QWORD)i * layout.stride);
+            AppendRecord(elements.data() + (size_t)i * layout.stride, outRecords);
+        }
+        return true;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        QWORD base;
+        memcpy(&base, elements.data() + (size_t)i * sizeof(QWORD), sizeof(base));
+        if (base != 0) {
+            outBases.push_back(base);
+        }
+    }
+    outRecords.reserve(outBases.size() * InventoryScanLayout::RECORD_SIZE);
+    if (!ReadPointedRecords(memory, outBases, outRecords)) {
+        outBases.clear();
+        outRecords.clear();
+        return false;
+    }
+    return true;
+}
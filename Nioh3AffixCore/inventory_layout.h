@@ -0,0 +1,63 @@
+#pragma once
+
+#include "memory_layout.h"
+#include "process_memory.h"
+#include <cstdint>
+#include <vector>
+
+// 背包数组布局推导
+//
+// 装备 hook 的原始指令是 lea rcx,[r12+00000148]，r12 指向拥有该装备的容器。开启容器捕获后，
+// 每条捕获记录同时带有 rbx (装备) 和 r12 (容器)。同一容器下已捕获的装备基址足以推导出容器中的装备数组:
+//   1. 一次读出容器开头 OWNER_SCAN_SIZE 字节，把其中每个对齐的 qword 当作候选数组指针 A
+//   2. A 后面/前面的字段作为元素数: 结束指针 (A, end) 或 32 位计数
+//   3. 指针数组: 一次读出 A[0..count)，所有已捕获的基址都在其中
+//      内联数组: 所有基址都在 [A, A + count * stride) 内且 (base - A) 都是 stride 的倍数；
+//                stride 取 (base - A) 的最大公约数中不小于一条装备记录的最小约数，
+//                已捕获的装备越多 (尤其是相邻的两件) 越准确
+//   先接受指针数组 (每个基址都必须逐一出现，偶然满足的可能极小)，其次按字段顺序接受第一个内联数组。
+//
+// 推导出的布局只记录字段偏移；读取背包时重新读一次容器中的这两个字段，再读数组:
+//   内联数组: 2 次读取；指针数组: 2 次读取 + 按地址合并后的装备区间数
+namespace InventoryScanLayout {
+    constexpr uint32_t OWNER_SCAN_SIZE = 0x400;     // 容器中查找数组字段的范围
+    constexpr uint32_t MIN_OWNER_SCAN_SIZE = 0x100; // 容器靠近区域末尾时逐次减半，最小到这里
+    constexpr uint32_t RECORD_SIZE =                // 每件装备读出的字节数 (基础属性 + 全部词条)
+        MemoryLayout::FIRST_AFFIX_OFFSET + MemoryLayout::AFFIX_SLOT_SIZE * MemoryLayout::AFFIX_SLOT_COUNT;
+    constexpr uint32_t MAX_STRIDE = 0x1000;
+    constexpr uint32_t MAX_COUNT = 4096;
+    constexpr uint32_t MERGE_GAP = 0x1000;          // 指针数组中相距不超过这么多的装备合并为一次读取
+    constexpr uint32_t MAX_MERGED_READ = 0x40000;
+}
+
+// 与导出函数 SessionDeriveInventoryLayout 共用
+enum InventoryArrayKind {
+    INVENTORY_ARRAY_NONE = 0,
+    INVENTORY_ARRAY_INLINE = 1,     // 装备记录依次存放在数组中
+    INVENTORY_ARRAY_POINTERS = 2    // 数组中是装备记录的指针
+};
+
+enum InventoryCountKind {
+    INVENTORY_COUNT_END_POINTER = 1,    // 数组结束指针 (元素数 = (end - A) / 元素大小)
+    INVENTORY_COUNT_U32 = 2             // 32 位元素数
+};
+
+struct InventoryLayout {
+    QWORD owner;                // 容器地址 (捕获的 r12)
+    QWORD arrayAddress;         // 最近一次读到的数组地址
+    uint32_t arrayFieldOffset;  // 数组指针字段相对容器的偏移
+    uint32_t countFieldOffset;  // 元素数字段相对容器的偏移
+    uint32_t stride;            // 元素大小 (指针数组为 8)
+    uint32_t count;             // 最近一次读到的元素数
+    int32_t arrayKind;          // InventoryArrayKind
+    int32_t countKind;          // InventoryCountKind
+};
+
+// 由容器地址和该容器下已捕获的装备基址推导数组布局，找不到时返回 false
+bool DeriveInventoryLayout(ProcessMemory* memory, QWORD owner, const QWORD* itemBases, size_t itemCount,
+    InventoryLayout& outLayout);
+
+// 按布局读出全部装备: outBases 为每件装备的基址 (指针数组中的空指针跳过)，
+// outRecords 依次为每件装备开头 RECORD_SIZE 字节；layout 的 arrayAddress / count 更新为本次读到的值
+bool ReadInventoryRecords(ProcessMemory* memory, InventoryLayout& layout, std::vector<QWORD>& outBases,
+    std::vector<uint8_t>& outRecords);
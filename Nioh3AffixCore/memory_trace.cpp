@@ -0,0 +1,202 @@
+#include "memory_trace.h"
+#include <cstring>
+
+namespace {
+    uint64_t HashBytes(const void* data, size_t size) {
+        // FNV-1a
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ull;
+        }
+        return hash;
+    }
+}
+
+const char* GetTraceOpName(TraceOp op) {
+    switch (op) {
+    case TraceOp::Read: return "Read";
+    case TraceOp::Write: return "Write";
+    case TraceOp::Query: return "Query";
+    case TraceOp::Protect: return "Protect";
+    case TraceOp::Allocate: return "Allocate";
+    case TraceOp::Free: return "Free";
+    case TraceOp::GetMainModule: return "GetMainModule";
+    case TraceOp::Phase: return "Phase";
+    }
+    return "Unknown";
+}
+
+// ---------------------------------------------------------------------------
+// TraceWriter
+// ---------------------------------------------------------------------------
+
+TraceWriter::TraceWriter()
+    : m_file(nullptr)
+{
+}
+
+TraceWriter::~TraceWriter() {
+    Close();
+}
+
+bool TraceWriter::Open(const char* path) {
+    Close();
+
+    if (path == nullptr || path[0] == '\0') {
+        return false;
+    }
+
+    m_file = fopen(path, "wb");
+    if (m_file == nullptr) {
+        return false;
+    }
+
+    uint32_t header[4] = { MemoryTrace::TRACE_MAGIC, MemoryTrace::TRACE_VERSION, 0, 0 };
+    if (fwrite(header, sizeof(header), 1, m_file) != 1) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void TraceWriter::Close() {
+    if (m_file != nullptr) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+    m_lastReadHash.clear();
+}
+
+void TraceWriter::Append(TraceOp op, bool ok, uint32_t durationNs, QWORD address, uint64_t size, uint32_t arg,
+    const void* payload, uint32_t payloadSize) {
+    if (m_file == nullptr) {
+        return;
+    }
+
+    TraceRecordHeader header;
+    header.op = (uint8_t)op;
+    header.flags = ok ? MemoryTrace::TRACE_FLAG_OK : 0;
+    header.reserved = 0;
+    header.durationNs = durationNs;
+    header.address = address;
+    header.size = size;
+    header.arg = arg;
+    header.payloadSize = payloadSize;
+
+    if (fwrite(&header, sizeof(header), 1, m_file) != 1 || (payloadSize != 0 && fwrite(payload, payloadSize, 1, m_file) != 1)) {
+        // 写失败时停止跟踪，不影响被跟踪的操作
+        Close();
+    }
+}
+
+void TraceWriter::AppendRead(bool ok, uint32_t durationNs, QWORD address, uint64_t size, const void* data, uint32_t dataSize) {
+    if (m_file == nullptr) {
+        return;
+    }
+
+    // 轮询类读取 (基址变量等) 内容大多不变，只在变化时保存
+    QWORD key = address ^ (size << 48);
+    uint64_t hash = HashBytes(data, dataSize) ^ dataSize;
+    auto it = m_lastReadHash.find(key);
+    if (it != m_lastReadHash.end() && it->second == hash) {
+        TraceRecordHeader header;
+        header.op = (uint8_t)TraceOp::Read;
+        header.flags = (uint8_t)((ok ? MemoryTrace::TRACE_FLAG_OK : 0) | MemoryTrace::TRACE_FLAG_SAME_AS_LAST);
+        header.reserved = 0;
+        header.durationNs = durationNs;
+        header.address = address;
+        header.size = size;
+        header.arg = dataSize;
+        header.payloadSize = 0;
+        if (fwrite(&header, sizeof(header), 1, m_file) != 1) {
+            Close();
+        }
+        return;
+    }
+
+    m_lastReadHash[key] = hash;
+    Append(TraceOp::Read, ok, durationNs, address, size, 0, data, dataSize);
+}
+
+// ---------------------------------------------------------------------------
+// TraceReader
+// ---------------------------------------------------------------------------
+
+TraceReader::TraceReader()
+    : m_file(nullptr)
+{
+}
+
+TraceReader::~TraceReader() {
+    Close();
+}
+
+bool TraceReader::Open(const char* path) {
+    Close();
+
+    m_file = fopen(path, "rb");
+    if (m_file == nullptr) {
+        return false;
+    }
+
+    uint32_t header[4] = {};
+    if (fread(header, sizeof(header), 1, m_file) != 1
+        || header[0] != MemoryTrace::TRACE_MAGIC
+        || header[1] != MemoryTrace::TRACE_VERSION) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void TraceReader::Close() {
+    if (m_file != nullptr) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool TraceReader::Next(TraceRecord& outRecord) {
+    if (m_file == nullptr) {
+        return false;
+    }
+
+    TraceRecordHeader header;
+    if (fread(&header, sizeof(header), 1, m_file) != 1) {
+        return false;
+    }
+
+    if (header.op == 0 || header.op >= TRACE_OP_COUNT) {
+        return false;
+    }
+
+    outRecord.op = (TraceOp)header.op;
+    outRecord.ok = (header.flags & MemoryTrace::TRACE_FLAG_OK) != 0;
+    outRecord.sameAsLast = (header.flags & MemoryTrace::TRACE_FLAG_SAME_AS_LAST) != 0;
+    outRecord.durationNs = header.durationNs;
+    outRecord.address = header.address;
+    outRecord.size = header.size;
+    outRecord.arg = header.arg;
+    outRecord.payload.resize(header.payloadSize);
+    if (header.payloadSize != 0 && fread(outRecord.payload.data(), header.payloadSize, 1, m_file) != 1) {
+        return false;
+    }
+    return true;
+}
+
+bool TraceReader::LoadAll(const char* path, std::vector<TraceRecord>& outRecords) {
+    outRecords.clear();
+
+    TraceReader reader;
+    if (!reader.Open(path)) {
+        return false;
+    }
+
+    TraceRecord record;
+    while (reader.Next(record)) {
+        outRecords.push_back(std::move(record));
+    }
+    return true;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "process_memory.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 远程内存操作跟踪文件
+//
+// 文件头: [u32 magic "N3TR"][u32 version][u64 reserved]
+// 记录:   [TraceRecordHeader][payload * payloadSize]
+//
+// 各操作的字段含义:
+//   Read          address/size, payload = 实际读到的字节 (与上次同地址同大小的内容相同时省略，置 TRACE_FLAG_SAME_AS_LAST)
+//   Write         address/size, payload = 写入的字节
+//   Query         address, payload = TraceRegion
+//   Protect       address/size, arg = newProtect, payload = u32 oldProtect
+//   Allocate      address = preferredAddress, size, arg = protect, payload = u64 结果地址
+//   Free          address
+//   GetMainModule payload = u64 base, u64 size
+//   Phase         payload = 阶段名 (不含结尾 0)
+namespace MemoryTrace {
+    constexpr uint32_t TRACE_MAGIC = 0x5254334E;   // "N3TR"
+    constexpr uint32_t TRACE_VERSION = 1;
+
+    constexpr uint8_t TRACE_FLAG_OK = 1u << 0;
+    constexpr uint8_t TRACE_FLAG_SAME_AS_LAST = 1u << 1;
+}
+
+enum class TraceOp : uint8_t {
+    Read = 1,
+    Write = 2,
+    Query = 3,
+    Protect = 4,
+    Allocate = 5,
+    Free = 6,
+    GetMainModule = 7,
+    Phase = 8
+};
+
+constexpr int TRACE_OP_COUNT = 9;
+
+const char* GetTraceOpName(TraceOp op);
+
+#pragma pack(push, 1)
+
+struct TraceRecordHeader {
+    uint8_t op;
+    uint8_t flags;
+    uint16_t reserved;
+    uint32_t durationNs;    // 后端调用耗时，超过 u32 时截断
+    uint64_t address;
+    uint64_t size;
+    uint32_t arg;
+    uint32_t payloadSize;
+};
+
+struct TraceRegion {
+    uint64_t baseAddress;
+    uint64_t regionSize;
+    uint32_t state;
+    uint32_t protect;
+    uint32_t type;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(TraceRecordHeader) == 32, "trace layout changed");
+static_assert(sizeof(TraceRegion) == 28, "trace layout changed");
+
+// 写者 (TracingProcessMemory 使用)
+class TraceWriter {
+public:
+    TraceWriter();
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    bool Open(const char* path);
+    void Close();
+    bool IsOpen() const { return m_file != nullptr; }
+
+    void Append(TraceOp op, bool ok, uint32_t durationNs, QWORD address, uint64_t size, uint32_t arg,
+        const void* payload, uint32_t payloadSize);
+
+    // Read 专用: 同一地址/大小的内容未变化时省略 payload
+    void AppendRead(bool ok, uint32_t durationNs, QWORD address, uint64_t size, const void* data, uint32_t dataSize);
+
+private:
+    FILE* m_file;
+    std::unordered_map<QWORD, uint64_t> m_lastReadHash;   // (address ^ size 混合) -> 内容哈希
+};
+
+// 读出的一条记录
+struct TraceRecord {
+    TraceOp op;
+    bool ok;
+    bool sameAsLast;
+    uint32_t durationNs;
+    QWORD address;
+    uint64_t size;
+    uint32_t arg;
+    std::vector<uint8_t> payload;
+};
+
+// 读者 (回放工具使用)
+class TraceReader {
+public:
+    TraceReader();
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    bool Open(const char* path);
+    void Close();
+
+    // 读下一条记录，文件结束或损坏时返回 false
+    bool Next(TraceRecord& outRecord);
+
+    // 读取全部记录
+    static bool LoadAll(const char* path, std::vector<TraceRecord>& outRecords);
+
+private:
+    FILE* m_file;
+};
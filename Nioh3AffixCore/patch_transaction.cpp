@@ -0,0 +1,261 @@
+#include "patch_transaction.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr QWORD PAGE_SIZE = 0x1000;
+
+    // 包含 [address, address + size) 的最小对齐 8/16 字节窗口；都放不进时返回原范围
+    void GetAlignedWindow(QWORD address, size_t size, QWORD& outStart, QWORD& outEnd) {
+        const QWORD widths[] = { 8, 16 };
+        for (QWORD width : widths) {
+            QWORD start = address & ~(width - 1);
+            if (address + size <= start + width) {
+                outStart = start;
+                outEnd = start + width;
+                return;
+            }
+        }
+        outStart = address;
+        outEnd = address + size;
+    }
+}
+
+PatchTransaction::PatchTransaction(ProcessMemory* memory)
+    : m_memory(memory)
+{
+}
+
+void PatchTransaction::Add(QWORD address, const uint8_t* newBytes, const uint8_t* expected, size_t size) {
+    if (size == 0) {
+        return;
+    }
+
+    Patch patch;
+    patch.address = address;
+    patch.newBytes.assign(newBytes, newBytes + size);
+    if (expected != nullptr) {
+        patch.expected.assign(expected, expected + size);
+    }
+    m_patches.push_back(std::move(patch));
+}
+
+bool PatchTransaction::BuildGroups(std::vector<PageGroup>& outGroups) {
+    outGroups.clear();
+
+    std::sort(m_patches.begin(), m_patches.end(), [](const Patch& a, const Patch& b) {
+        return a.address < b.address;
+    });
+
+    // 补丁互相重叠时无法确定最终内容
+    for (size_t i = 1; i < m_patches.size(); i++) {
+        if (m_patches[i - 1].address + m_patches[i - 1].newBytes.size() > m_patches[i].address) {
+            return false;
+        }
+    }
+
+    // 对齐窗口，重叠或相邻的合并
+    std::vector<std::pair<QWORD, QWORD>> windows;
+    for (const Patch& patch : m_patches) {
+        QWORD start;
+        QWORD end;
+        GetAlignedWindow(patch.address, patch.newBytes.size(), start, end);
+        if (!windows.empty() && start < windows.back().second) {
+            windows.back().second = std::max(windows.back().second, end);
+        } else {
+            windows.emplace_back(start, end);
+        }
+    }
+
+    // 按页分组: 窗口的起始页与上一组的最后一页相同时并入该组，保证每页只修改一次保护属性
+    for (const auto& range : windows) {
+        QWORD page = range.first & ~(PAGE_SIZE - 1);
+        if (outGroups.empty() || ((outGroups.back().end - 1) & ~(PAGE_SIZE - 1)) < page) {
+            PageGroup group;
+            group.start = range.first;
+            group.end = range.second;
+            outGroups.push_back(std::move(group));
+        }
+
+        PageGroup& group = outGroups.back();
+        group.end = std::max(group.end, range.second);
+
+        Window window;
+        window.address = range.first;
+        window.original.resize((size_t)(range.second - range.first));
+        group.windows.push_back(std::move(window));
+    }
+    return true;
+}
+
+bool PatchTransaction::ReadAndVerify(std::vector<PageGroup>& groups) {
+    size_t patchIndex = 0;
+    for (PageGroup& group : groups) {
+        // 每组一次读取
+        std::vector<uint8_t> current((size_t)(group.end - group.start));
+        m_stats.reads++;
+        if (!m_memory->Read(group.start, current.data(), current.size())) {
+            return false;
+        }
+
+        for (Window& window : group.windows) {
+            size_t offset = (size_t)(window.address - group.start);
+            memcpy(window.original.data(), &current[offset], window.original.size());
+            window.patched = window.original;
+
+            QWORD windowEnd = window.address + window.original.size();
+            while (patchIndex < m_patches.size() && m_patches[patchIndex].address < windowEnd) {
+                const Patch& patch = m_patches[patchIndex];
+                size_t patchOffset = (size_t)(patch.address - window.address);
+                if (!patch.expected.empty()
+                    && memcmp(&window.original[patchOffset], patch.expected.data(), patch.expected.size()) != 0) {
+                    return false;
+                }
+                memcpy(&window.patched[patchOffset], patch.newBytes.data(), patch.newBytes.size());
+                patchIndex++;
+            }
+        }
+    }
+    return true;
+}
+
+void PatchTransaction::RestoreProtection(PageGroup& group) {
+    if (group.protectChanged) {
+        uint32_t ignored;
+        m_stats.protects++;
+        m_memory->Protect(group.start, (size_t)(group.end - group.start), group.oldProtect, &ignored);
+        group.protectChanged = false;
+    }
+}
+
+void PatchTransaction::Rollback(std::vector<PageGroup>& groups) {
+    m_stats.rolledBack = true;
+
+    for (PageGroup& group : groups) {
+        bool anyWritten = false;
+        for (const Window& window : group.windows) {
+            anyWritten = anyWritten || window.written;
+        }
+        if (!anyWritten) {
+            RestoreProtection(group);
+            continue;
+        }
+
+        if (!group.protectChanged) {
+            m_stats.protects++;
+            group.protectChanged = m_memory->Protect(group.start, (size_t)(group.end - group.start),
+                MemProtect::ExecuteReadWrite, &group.oldProtect);
+        }
+
+        for (Window& window : group.windows) {
+            if (window.written) {
+                m_stats.writes++;
+                m_memory->Write(window.address, window.original.data(), window.original.size());
+                window.written = false;
+            }
+        }
+
+        RestoreProtection(group);
+    }
+}
+
+bool PatchTransaction::Commit() {
+    m_stats = PatchStats();
+
+    if (m_patches.empty()) {
+        return true;
+    }
+    if (m_memory == nullptr) {
+        return false;
+    }
+
+    std::vector<PageGroup> groups;
+    if (!BuildGroups(groups) || !ReadAndVerify(groups)) {
+        return false;
+    }
+
+    bool changed = false;
+    for (const PageGroup& group : groups) {
+        for (const Window& window : group.windows) {
+            changed = changed || window.patched != window.original;
+        }
+    }
+    if (!changed) {
+        return true;
+    }
+
+    // 挂起线程后检查指令地址: 停在补丁起点的线程会执行完整的新指令，停在中间的会执行半条
+    std::vector<QWORD> instructionPointers;
+    m_stats.threadsSuspended = m_memory->SuspendThreads(&instructionPointers);
+    if (m_stats.threadsSuspended) {
+        for (QWORD address : instructionPointers) {
+            if (IsInsideChangedBytes(groups, address)) {
+                m_stats.threadBlocked = true;
+                m_memory->ResumeThreads();
+                return false;
+            }
+        }
+    }
+
+    bool ok = WriteGroups(groups);
+    if (m_stats.threadsSuspended) {
+        m_memory->ResumeThreads();
+    }
+    return ok;
+}
+
+bool PatchTransaction::IsInsideChangedBytes(const std::vector<PageGroup>& groups, QWORD address) const {
+    for (const Patch& patch : m_patches) {
+        if (address <= patch.address || address >= patch.address + patch.newBytes.size()) {
+            continue;
+        }
+        // 补丁内容与当前内容相同时不会写入
+        for (const PageGroup& group : groups) {
+            for (const Window& window : group.windows) {
+                if (patch.address >= window.address && patch.address < window.address + window.original.size()) {
+                    size_t offset = (size_t)(patch.address - window.address);
+                    return memcmp(&window.original[offset], &window.patched[offset], patch.newBytes.size()) != 0;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool PatchTransaction::WriteGroups(std::vector<PageGroup>& groups) {
+    for (PageGroup& group : groups) {
+        // 整组已是目标内容时跳过
+        bool changed = false;
+        for (const Window& window : group.windows) {
+            changed = changed || window.patched != window.original;
+        }
+        if (!changed) {
+            continue;
+        }
+
+        m_stats.protects++;
+        if (!m_memory->Protect(group.start, (size_t)(group.end - group.start),
+            MemProtect::ExecuteReadWrite, &group.oldProtect)) {
+            Rollback(groups);
+            return false;
+        }
+        group.protectChanged = true;
+
+        for (Window& window : group.windows) {
+            if (window.patched == window.original) {
+                continue;
+            }
+            // 写入失败时窗口可能已部分写入，同样需要回滚
+            window.written = true;
+            m_stats.writes++;
+            if (!m_memory->Write(window.address, window.patched.data(), window.patched.size())) {
+                Rollback(groups);
+                return false;
+            }
+        }
+
+        RestoreProtection(group);
+    }
+
+    return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "process_memory.h"
+#include <vector>
+
+// 补丁事务统计
+struct PatchStats {
+    uint32_t reads = 0;
+    uint32_t writes = 0;
+    uint32_t protects = 0;
+    bool threadsSuspended = false;  // 写入期间目标进程的线程处于挂起状态
+    bool threadBlocked = false;     // 有线程停在被改写的字节中间，没有写入
+    bool rolledBack = false;
+};
+
+// 代码补丁事务
+// 收集若干 (地址, 新字节, 期望的旧字节)，Commit 时:
+//   1. 每个补丁扩展为包含它的对齐 8/16 字节窗口 (放不进时保持原范围)，重叠窗口合并
+//   2. 按页分组 (窗口所在的页互不重叠)，每组一次读取校验期望字节 (任一不符则什么都不写)
+//   3. 后端支持时挂起目标进程的线程；有线程停在被改写的字节中间 (不在补丁起点) 时什么都不写并返回失败
+//   4. 每组只修改一次保护属性，每个窗口一次写入，写完恢复保护属性，最后恢复线程
+//   5. 任一步失败时把已写入的窗口恢复为原内容 (全部提交或全部回滚)
+// 线程挂起时游戏线程只会看到整个事务之前或之后的代码。后端不支持挂起时没有这个保证:
+// ProcessMemory::Write (WriteProcessMemory) 不承诺单次存储，对齐窗口只减少撕裂的机会。
+class PatchTransaction {
+public:
+    explicit PatchTransaction(ProcessMemory* memory);
+
+    // expected 为空表示不校验
+    void Add(QWORD address, const uint8_t* newBytes, const uint8_t* expected, size_t size);
+
+    bool IsEmpty() const { return m_patches.empty(); }
+
+    // 提交；失败时目标进程保持提交前的状态 (尽力回滚)
+    bool Commit();
+
+    const PatchStats& GetStats() const { return m_stats; }
+
+private:
+    struct Patch {
+        QWORD address;
+        std::vector<uint8_t> newBytes;
+        std::vector<uint8_t> expected;
+    };
+
+    // 实际写入的窗口
+    struct Window {
+        QWORD address;
+        std::vector<uint8_t> original;
+        std::vector<uint8_t> patched;
+        bool written = false;
+    };
+
+    // 所在页与其它组不重叠的一组窗口
+    struct PageGroup {
+        QWORD start;
+        QWORD end;
+        std::vector<Window> windows;
+        uint32_t oldProtect = 0;
+        bool protectChanged = false;
+    };
+
+    ProcessMemory* m_memory;
+    std::vector<Patch> m_patches;
+    PatchStats m_stats;
+
+    bool BuildGroups(std::vector<PageGroup>& outGroups);
+    bool ReadAndVerify(std::vector<PageGroup>& groups);
+    bool IsInsideChangedBytes(const std::vector<PageGroup>& groups, QWORD address) const;
+    bool WriteGroups(std::vector<PageGroup>& groups);
+    void Rollback(std::vector<PageGroup>& groups);
+    void RestoreProtection(PageGroup& group);
+};
@@ -0,0 +1,565 @@
+#include "pointer_scan.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+namespace {
+    // 每个线程在搜索/建表时攒够这么多再更新共享计数
+    constexpr uint64_t COUNTER_BATCH = 4096;
+
+    // 每个线程对应的分区数 (分区越多，建表后各线程排序的负载越均匀)
+    constexpr uint32_t PARTITIONS_PER_THREAD = 4;
+
+    uint64_t ElapsedMicroseconds(std::chrono::steady_clock::time_point start) {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+PointerScanConfig NormalizePointerScanConfig(const PointerScanConfig& config) {
+    PointerScanConfig result = config;
+    if (result.maxMapBytes == 0) result.maxMapBytes = PointerScanLayout::DEFAULT_MAX_MAP_BYTES;
+    if (result.maxDepth == 0) result.maxDepth = PointerScanLayout::DEFAULT_MAX_DEPTH;
+    if (result.maxDepth > PointerScanLayout::MAX_DEPTH) result.maxDepth = PointerScanLayout::MAX_DEPTH;
+    if (result.maxOffset == 0) result.maxOffset = PointerScanLayout::DEFAULT_MAX_OFFSET;
+    if (result.maxResults == 0) result.maxResults = PointerScanLayout::DEFAULT_MAX_RESULTS;
+    result.threads = ResolveScanThreads(result.threads);
+    return result;
+}
+
+bool operator<(const PointerPath& a, const PointerPath& b) {
+    if (a.moduleOffset != b.moduleOffset) return a.moduleOffset < b.moduleOffset;
+    if (a.depth != b.depth) return a.depth < b.depth;
+    return std::lexicographical_compare(a.offsets, a.offsets + a.depth, b.offsets, b.offsets + b.depth);
+}
+
+bool operator==(const PointerPath& a, const PointerPath& b) {
+    return a.moduleOffset == b.moduleOffset && a.depth == b.depth &&
+        std::equal(a.offsets, a.offsets + a.depth, b.offsets);
+}
+
+// ---------------------------------------------------------------------------
+// PointerMap
+// ---------------------------------------------------------------------------
+
+struct PointerMap::SearchContext {
+    const PointerScanConfig& config;
+    std::vector<PointerPath> results;
+    std::atomic<uint64_t>& resultCount;
+    std::atomic<uint64_t>& nodeCount;
+    std::atomic<bool>& stop;
+    uint64_t pendingNodes;
+
+    SearchContext(const PointerScanConfig& c, std::atomic<uint64_t>& r, std::atomic<uint64_t>& n, std::atomic<bool>& s)
+        : config(c), resultCount(r), nodeCount(n), stop(s), pendingNodes(0) {}
+
+    // 访问一个节点，超过节点上限时停止搜索
+    void CountNode() {
+        if (++pendingNodes < COUNTER_BATCH) {
+            return;
+        }
+        uint64_t total = nodeCount.fetch_add(pendingNodes) + pendingNodes;
+        pendingNodes = 0;
+        if (config.maxNodes != 0 && total >= config.maxNodes) {
+            stop = true;
+        }
+    }
+
+    void Flush() {
+        nodeCount.fetch_add(pendingNodes);
+        pendingNodes = 0;
+    }
+
+    // chain 中依次为从目标向上每一级的偏移，路径中的顺序相反
+    void Emit(uint32_t moduleOffset, const uint32_t* chain, uint32_t depth) {
+        PointerPath path;
+        memset(&path, 0, sizeof(path));
+        path.moduleOffset = moduleOffset;
+        path.depth = (uint16_t)depth;
+        for (uint32_t i = 0; i < depth; i++) {
+            path.offsets[i] = chain[depth - 1 - i];
+        }
+        results.push_back(path);
+        if (resultCount.fetch_add(1) + 1 >= config.maxResults) {
+            stop = true;
+        }
+    }
+};
+
+PointerMap::PointerMap()
+    : m_pageCount(0)
+    , m_moduleBase(0)
+    , m_moduleSize(0)
+{
+}
+
+void PointerMap::Clear() {
+    m_ranges.clear();
+    m_partitions.clear();
+    m_pageCount = 0;
+    m_moduleBase = 0;
+    m_moduleSize = 0;
+}
+
+uint64_t PointerMap::GetCount() const {
+    uint64_t count = 0;
+    for (const Partition& partition : m_partitions) {
+        count += partition.entries.size();
+    }
+    return count;
+}
+
+bool PointerMap::CollectRanges(ProcessMemory* memory) {
+    if (!memory->GetMainModule(m_moduleBase, m_moduleSize)) {
+        return false;
+    }
+
+    std::vector<MemoryRegion> regions;
+    if (!CollectDataRegions(memory, 0, 0, regions)) {
+        return false;
+    }
+
+    uint64_t pages = 0;
+    for (const MemoryRegion& region : regions) {
+        m_ranges.push_back({ region.baseAddress, region.regionSize, (uint32_t)pages });
+        pages += region.regionSize / PointerScanLayout::PAGE_SIZE;
+        if (pages > PointerScanLayout::MAX_PAGES) {
+            return false;
+        }
+    }
+    m_pageCount = (uint32_t)pages;
+    return true;
+}
+
+bool PointerMap::Encode(QWORD address, uint32_t& outKey) const {
+    auto it = std::upper_bound(m_ranges.begin(), m_ranges.end(), address,
+        [](QWORD value, const Range& range) { return value < range.base; });
+    if (it == m_ranges.begin()) {
+        return false;
+    }
+    --it;
+    if (address - it->base >= it->size) {
+        return false;
+    }
+    outKey = (it->firstPage << 9) + (uint32_t)((address - it->base) >> 3);
+    return true;
+}
+
+QWORD PointerMap::Decode(uint32_t key) const {
+    uint32_t page = key >> 9;
+    auto it = std::upper_bound(m_ranges.begin(), m_ranges.end(), page,
+        [](uint32_t value, const Range& range) { return value < range.firstPage; }) - 1;
+    return it->base + (QWORD)(key - (it->firstPage << 9)) * 8;
+}
+
+uint64_t PointerMap::LowerKey(QWORD address) const {
+    auto it = std::upper_bound(m_ranges.begin(), m_ranges.end(), address,
+        [](QWORD value, const Range& range) { return value < range.base + range.size; });
+    if (it == m_ranges.end()) {
+        return (uint64_t)m_pageCount << 9;
+    }
+    if (address <= it->base) {
+        return (uint64_t)it->firstPage << 9;
+    }
+    return ((uint64_t)it->firstPage << 9) + ((address - it->base + 7) >> 3);
+}
+
+size_t PointerMap::FindPartition(uint64_t key) const {
+    auto it = std::upper_bound(m_partitions.begin(), m_partitions.end(), key,
+        [](uint64_t value, const Partition& partition) { return value < partition.firstKey; });
+    return it == m_partitions.begin() ? 0 : (size_t)(it - m_partitions.begin() - 1);
+}
+
+template <typename Visit>
+void PointerMap::ForEachPointerTo(QWORD low, QWORD high, Visit&& visit) const {
+    uint64_t first = LowerKey(low);
+    uint64_t last = LowerKey(high + 1);
+    for (size_t p = FindPartition(first); p < m_partitions.size() && m_partitions[p].firstKey < last; p++) {
+        const std::vector<Entry>& entries = m_partitions[p].entries;
+        auto it = std::lower_bound(entries.begin(), entries.end(), first,
+            [](const Entry& entry, uint64_t key) { return entry.value < key; });
+        for (; it != entries.end() && it->value < last; ++it) {
+            visit(Decode(it->value), Decode(it->source));
+        }
+    }
+}
+
+bool PointerMap::Build(ProcessMemory* memory, const PointerScanConfig& requested, PointerScanStats& stats) {
+    auto start = std::chrono::steady_clock::now();
+    const PointerScanConfig config = NormalizePointerScanConfig(requested);
+    Clear();
+
+    if (!CollectRanges(memory)) {
+        Clear();
+        return false;
+    }
+
+    // 分区按值所在页均分: 页 o 属于分区 o * P / pageCount
+    const uint32_t threads = config.threads;
+    const uint32_t partitionCount = threads * PARTITIONS_PER_THREAD;
+    m_partitions.resize(partitionCount);
+    for (uint32_t p = 0; p < partitionCount; p++) {
+        uint64_t firstPage = ((uint64_t)p * m_pageCount + partitionCount - 1) / partitionCount;
+        m_partitions[p].firstKey = (uint32_t)(firstPage << 9);
+    }
+    auto partitionOf = [&](uint32_t key) { return (uint32_t)((uint64_t)(key >> 9) * partitionCount / m_pageCount); };
+
+    struct Chunk {
+        QWORD address;
+        uint32_t size;
+        uint32_t firstKey;      // 块中第一个 qword 的编码 (同一区域内的编码连续)
+    };
+    std::vector<Chunk> chunks;
+    for (const Range& range : m_ranges) {
+        for (QWORD offset = 0; offset < range.size; offset += PointerScanLayout::CHUNK_SIZE) {
+            uint32_t size = (uint32_t)std::min<QWORD>(PointerScanLayout::CHUNK_SIZE, range.size - offset);
+            chunks.push_back({ range.base + offset, size, (range.firstPage << 9) + (uint32_t)(offset >> 3) });
+        }
+    }
+
+    const QWORD lowest = m_ranges.front().base;
+    const QWORD highest = m_ranges.back().base + m_ranges.back().size;
+    const uint64_t entryLimit = config.maxMapBytes / sizeof(Entry);
+
+    std::mutex readLock;
+    std::atomic<size_t> nextChunk(0);
+    std::atomic<uint64_t> entryCount(0);
+    std::atomic<uint64_t> scannedBytes(0);
+    std::atomic<bool> overflow(false);
+    std::vector<std::vector<std::vector<Entry>>> pieces(threads, std::vector<std::vector<Entry>>(partitionCount));
+
+    RunScanWorkers(threads, [&](uint32_t worker) {
+        std::vector<std::vector<Entry>>& out = pieces[worker];
+        std::vector<uint8_t> buffer(PointerScanLayout::CHUNK_SIZE);
+        uint64_t pending = 0;
+
+        auto scan = [&](const uint8_t* data, size_t size, uint32_t firstKey) {
+            for (size_t offset = 0; offset + sizeof(QWORD) <= size; offset += sizeof(QWORD)) {
+                QWORD value;
+                memcpy(&value, data + offset, sizeof(value));
+                uint32_t valueKey;
+                if (value < lowest || value >= highest || (value & 7) != 0 || !Encode(value, valueKey)) {
+                    continue;
+                }
+                out[partitionOf(valueKey)].push_back({ valueKey, firstKey + (uint32_t)(offset >> 3) });
+                if (++pending == COUNTER_BATCH) {
+                    if (entryCount.fetch_add(pending) + pending > entryLimit) {
+                        overflow = true;
+                    }
+                    pending = 0;
+                }
+            }
+        };
+
+        for (size_t i = nextChunk++; i < chunks.size() && !overflow; i = nextChunk++) {
+            const Chunk& chunk = chunks[i];
+            bool ok;
+            {
+                std::lock_guard<std::mutex> lock(readLock);
+                ok = memory->Read(chunk.address, buffer.data(), chunk.size);
+            }
+            if (ok) {
+                scan(buffer.data(), chunk.size, chunk.firstKey);
+                scannedBytes += chunk.size;
+                continue;
+            }
+
+            // 块中有不可读的页 (扫描期间被释放或改了保护)，逐页读取
+            for (uint32_t offset = 0; offset < chunk.size; offset += PointerScanLayout::PAGE_SIZE) {
+                {
+                    std::lock_guard<std::mutex> lock(readLock);
+                    ok = memory->Read(chunk.address + offset, buffer.data(), PointerScanLayout::PAGE_SIZE);
+                }
+                if (ok) {
+                    scan(buffer.data(), PointerScanLayout::PAGE_SIZE, chunk.firstKey + (offset >> 3));
+                    scannedBytes += PointerScanLayout::PAGE_SIZE;
+                }
+            }
+        }
+        if (entryCount.fetch_add(pending) + pending > entryLimit) {
+            overflow = true;
+        }
+    });
+
+    stats.regions = (uint32_t)m_ranges.size();
+    stats.threads = threads;
+    stats.scannedBytes = scannedBytes;
+    stats.pointers = entryCount;
+    stats.mapBytes = stats.pointers * sizeof(Entry);
+    if (overflow) {
+        stats.truncated = 1;
+        stats.buildMicroseconds = ElapsedMicroseconds(start);
+        Clear();
+        return false;
+    }
+
+    // 各线程的分片按分区拼接后排序，拼接完立即释放分片
+    std::atomic<uint32_t> nextPartition(0);
+    RunScanWorkers(threads, [&](uint32_t) {
+        for (uint32_t p = nextPartition++; p < partitionCount; p = nextPartition++) {
+            size_t total = 0;
+            for (uint32_t w = 0; w < threads; w++) {
+                total += pieces[w][p].size();
+            }
+            std::vector<Entry>& entries = m_partitions[p].entries;
+            entries.reserve(total);
+            for (uint32_t w = 0; w < threads; w++) {
+                entries.insert(entries.end(), pieces[w][p].begin(), pieces[w][p].end());
+                std::vector<Entry>().swap(pieces[w][p]);
+            }
+            std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+                return a.value != b.value ? a.value < b.value : a.source < b.source;
+            });
+        }
+    });
+
+    stats.buildMicroseconds = ElapsedMicroseconds(start);
+    return true;
+}
+
+void PointerMap::SearchFrom(SearchContext& context, QWORD address, uint32_t depth, uint32_t* chain) const {
+    const uint32_t maxOffset = context.config.maxOffset;
+    QWORD low = address > maxOffset ? address - maxOffset : 0;
+    ForEachPointerTo(low, address, [&](QWORD value, QWORD source) {
+        if (context.stop) {
+            return;
+        }
+        context.CountNode();
+        chain[depth] = (uint32_t)(address - value);
+        if (source - m_moduleBase < m_moduleSize) {
+            context.Emit((uint32_t)(source - m_moduleBase), chain, depth + 1);
+        } else if (depth + 1 < context.config.maxDepth) {
+            SearchFrom(context, source, depth + 1, chain);
+        }
+    });
+}
+
+void PointerMap::Search(QWORD target, const PointerScanConfig& requested, std::vector<PointerPath>& outPaths,
+    PointerScanStats& stats) const {
+    auto start = std::chrono::steady_clock::now();
+    const PointerScanConfig config = NormalizePointerScanConfig(requested);
+    outPaths.clear();
+
+    std::atomic<uint64_t> resultCount(0);
+    std::atomic<uint64_t> nodeCount(0);
+    std::atomic<bool> stop(false);
+
+    // 第一级在调用线程上展开，之后每个第一级节点作为一个任务
+    struct Task {
+        QWORD source;
+        uint32_t offset;
+    };
+    std::vector<Task> tasks;
+    SearchContext root(config, resultCount, nodeCount, stop);
+    QWORD low = target > config.maxOffset ? target - config.maxOffset : 0;
+    ForEachPointerTo(low, target, [&](QWORD value, QWORD source) {
+        if (stop) {
+            return;
+        }
+        root.CountNode();
+        uint32_t offset = (uint32_t)(target - value);
+        if (source - m_moduleBase < m_moduleSize) {
+            root.Emit((uint32_t)(source - m_moduleBase), &offset, 1);
+        } else if (config.maxDepth > 1) {
+            tasks.push_back({ source, offset });
+        }
+    });
+    root.Flush();
+
+    const uint32_t threads = (uint32_t)std::max<size_t>(1, std::min<size_t>(config.threads, tasks.size()));
+    std::vector<SearchContext> contexts;
+    contexts.reserve(threads);
+    for (uint32_t i = 0; i < threads; i++) {
+        contexts.emplace_back(config, resultCount, nodeCount, stop);
+    }
+
+    std::atomic<size_t> nextTask(0);
+    RunScanWorkers(threads, [&](uint32_t worker) {
+        SearchContext& context = contexts[worker];
+        uint32_t chain[PointerScanLayout::MAX_DEPTH];
+        for (size_t i = nextTask++; i < tasks.size() && !stop; i = nextTask++) {
+            chain[0] = tasks[i].offset;
+            SearchFrom(context, tasks[i].source, 1, chain);
+        }
+        context.Flush();
+    });
+
+    outPaths.swap(root.results);
+    for (SearchContext& context : contexts) {
+        outPaths.insert(outPaths.end(), context.results.begin(), context.results.end());
+    }
+    std::sort(outPaths.begin(), outPaths.end());
+    outPaths.erase(std::unique(outPaths.begin(), outPaths.end()), outPaths.end());
+    if (outPaths.size() > config.maxResults) {
+        outPaths.resize(config.maxResults);
+    }
+
+    stats.nodes = nodeCount;
+    stats.results = (uint32_t)outPaths.size();
+    stats.truncated = stop ? 1 : 0;
+    stats.searchMicroseconds = ElapsedMicroseconds(start);
+}
+
+// ---------------------------------------------------------------------------
+// 路径解析与结果文件
+// ---------------------------------------------------------------------------
+
+bool ResolvePointerPath(ProcessMemory* memory, QWORD moduleBase, const PointerPath& path, QWORD& outAddress) {
+    if (path.depth == 0 || path.depth > PointerScanLayout::MAX_DEPTH) {
+        return false;
+    }
+
+    QWORD pointer = 0;
+    if (!memory->Read(moduleBase + path.moduleOffset, &pointer, sizeof(pointer))) {
+        return false;
+    }
+    for (uint32_t i = 0; i + 1 < path.depth; i++) {
+        if (pointer == 0 || !memory->Read(pointer + path.offsets[i], &pointer, sizeof(pointer))) {
+            return false;
+        }
+    }
+    if (pointer == 0) {
+        return false;
+    }
+    outAddress = pointer + path.offsets[path.depth - 1];
+    return true;
+}
+
+namespace {
+    bool IsValidDepth(uint32_t depth) {
+        return depth >= 1 && depth <= PointerScanLayout::MAX_DEPTH;
+    }
+
+    bool ReadHeader(FILE* file, PointerPathFileHeader& outHeader) {
+        return fread(&outHeader, sizeof(outHeader), 1, file) == 1 &&
+            outHeader.magic == PointerScanLayout::FILE_MAGIC &&
+            outHeader.version == PointerScanLayout::FILE_VERSION &&
+            IsValidDepth(outHeader.maxDepth);
+    }
+
+    // 文件头之后实际存放的路径条数 (读完后回到原位置)，文件头中的条数不能超过它
+    bool CountStoredPaths(FILE* file, uint64_t& outCount) {
+        long position = ftell(file);
+        if (position < 0 || fseek(file, 0, SEEK_END) != 0) {
+            return false;
+        }
+        long end = ftell(file);
+        if (end < position || fseek(file, position, SEEK_SET) != 0) {
+            return false;
+        }
+        outCount = (uint64_t)(end - position) / sizeof(PointerPath);
+        return true;
+    }
+
+    // 读取下一条路径: 已读完 left 条时返回 false；文件提前结束或深度超出范围时整个文件无效 (ok 置为 false)
+    bool NextPath(FILE* file, uint64_t left, PointerPath& outPath, bool& ok) {
+        if (left == 0) {
+            return false;
+        }
+        if (fread(&outPath, sizeof(outPath), 1, file) != 1 || !IsValidDepth(outPath.depth)) {
+            ok = false;
+            return false;
+        }
+        return true;
+    }
+}
+
+bool WritePointerPathFile(const char* path, QWORD moduleSize, const PointerScanConfig& config,
+    const std::vector<PointerPath>& paths) {
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    PointerPathFileHeader header;
+    header.magic = PointerScanLayout::FILE_MAGIC;
+    header.version = PointerScanLayout::FILE_VERSION;
+    header.moduleSize = moduleSize;
+    header.maxDepth = config.maxDepth;
+    header.maxOffset = config.maxOffset;
+    header.count = paths.size();
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        (paths.empty() || fwrite(paths.data(), sizeof(PointerPath), paths.size(), file) == paths.size());
+    return fclose(file) == 0 && ok;
+}
+
+bool ReadPointerPathFile(const char* path, PointerPathFileHeader& outHeader, std::vector<PointerPath>& outPaths) {
+    outPaths.clear();
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    uint64_t stored = 0;
+    bool ok = ReadHeader(file, outHeader) && CountStoredPaths(file, stored) && outHeader.count <= stored;
+    if (ok) {
+        outPaths.resize((size_t)outHeader.count);
+        ok = outPaths.empty() || fread(outPaths.data(), sizeof(PointerPath), outPaths.size(), file) == outPaths.size();
+    }
+    for (size_t i = 0; ok && i < outPaths.size(); i++) {
+        ok = IsValidDepth(outPaths[i].depth);
+    }
+    fclose(file);
+    if (!ok) {
+        outPaths.clear();
+    }
+    return ok;
+}
+
+bool IntersectPointerPathFiles(const char* first, const char* second, const char* outputPath, uint64_t& outCount) {
+    outCount = 0;
+    FILE* a = fopen(first, "rb");
+    FILE* b = fopen(second, "rb");
+    FILE* out = nullptr;
+
+    PointerPathFileHeader headerA, headerB;
+    bool ok = a != nullptr && b != nullptr && ReadHeader(a, headerA) && ReadHeader(b, headerB) &&
+        headerA.moduleSize == headerB.moduleSize;
+    if (ok) {
+        out = fopen(outputPath, "wb");
+        ok = out != nullptr;
+    }
+
+    // 先写占位的文件头，归并结束后回填条数
+    PointerPathFileHeader header;
+    memset(&header, 0, sizeof(header));
+    if (ok) {
+        header = headerA;
+        header.maxDepth = std::min(headerA.maxDepth, headerB.maxDepth);
+        header.maxOffset = std::min(headerA.maxOffset, headerB.maxOffset);
+        header.count = 0;
+        ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    }
+
+    // 两边都已排序，逐条归并
+    PointerPath pathA, pathB;
+    uint64_t leftA = ok ? headerA.count : 0;
+    uint64_t leftB = ok ? headerB.count : 0;
+    bool hasA = NextPath(a, leftA, pathA, ok);
+    bool hasB = NextPath(b, leftB, pathB, ok);
+    while (ok && hasA && hasB) {
+        bool advanceA = !(pathB < pathA);
+        bool advanceB = !(pathA < pathB);
+        if (advanceA && advanceB) {
+            ok = fwrite(&pathA, sizeof(pathA), 1, out) == 1;
+            outCount++;
+        }
+        if (advanceA) hasA = NextPath(a, --leftA, pathA, ok);
+        if (advanceB) hasB = NextPath(b, --leftB, pathB, ok);
+    }
+
+    if (ok) {
+        header.count = outCount;
+        ok = fseek(out, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, out) == 1;
+    }
+
+    if (a != nullptr) fclose(a);
+    if (b != nullptr) fclose(b);
+    if (out != nullptr && fclose(out) != 0) {
+        ok = false;
+    }
+    return ok;
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "process_memory.h"
+#include "region_scan.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 指针路径扫描
+//
+// 不改写游戏代码定位装备: 从已知的装备基址反向查找 "主模块静态数据 -> ... -> 基址" 的指针链，
+// 游戏重启后按同一条链重新读出基址。
+//
+// 反向指针表 (一次快照):
+//   - 只扫描已提交、可读写的 Private / Image 区域 (见 region_scan.h，代码和只读数据中不会有对象指针)
+//   - 每个 8 字节对齐、值落在这些区域内且 8 字节对齐的 qword 记为一条 (值 -> 所在地址)
+//   - 地址编码为 32 位: (页序号 << 9) | (页内偏移 >> 3)，页序号按地址顺序编号，所以编码的顺序与地址顺序一致；
+//     每条只占 8 字节，可编码 32GB 可读写内存
+//   - 按值所在页分成若干分区，每个分区单独排序，查找时二分
+//   - 快照内容不保留: 各线程每次只持有一个 CHUNK_SIZE 的读缓冲；表的大小受 maxMapBytes 限制，超过时放弃
+//
+// 搜索: 从基址开始逐级查找值在 [地址 - maxOffset, 地址] 内的指针，所在地址位于主模块中时得到一条路径
+// (静态地址不再继续向上查找)。第一级的结果分给各线程各自深度优先搜索。
+//
+// 结果文件: [PointerPathFileHeader][PointerPath * count]，路径按 (moduleOffset, depth, offsets) 排序，
+// 两次扫描 (例如游戏重启前后) 的结果文件可以流式求交集，只保留稳定的路径。
+namespace PointerScanLayout {
+    constexpr uint32_t MAX_DEPTH = 6;
+    constexpr uint32_t PAGE_SIZE = RegionScanLayout::PAGE_SIZE;
+    constexpr uint32_t CHUNK_SIZE = 0x100000;           // 每次读取 (每个线程一个缓冲)
+    constexpr uint64_t MAX_PAGES = 1ull << 23;          // 地址编码可容纳的页数 (32GB)
+
+    constexpr uint32_t DEFAULT_MAX_DEPTH = 4;
+    constexpr uint32_t DEFAULT_MAX_OFFSET = 0x1000;
+    constexpr uint32_t DEFAULT_MAX_RESULTS = 100000;
+    constexpr uint64_t DEFAULT_MAX_MAP_BYTES = 512ull * 1024 * 1024;
+
+    constexpr uint32_t FILE_MAGIC = 0x5050334E;         // "N3PP"
+    constexpr uint32_t FILE_VERSION = 1;
+}
+
+// 扫描参数 (与导出函数 SessionScanPointerPaths 共用)，为 0 的字段取默认值
+struct PointerScanConfig {
+    uint64_t maxMapBytes;   // 反向指针表的内存上限
+    uint64_t maxNodes;      // 搜索访问的节点数上限，0 表示不限
+    uint32_t maxDepth;      // 1..MAX_DEPTH
+    uint32_t maxOffset;     // 每一级的偏移上限 (字节)
+    uint32_t maxResults;
+    uint32_t threads;       // 0 表示按 CPU 核数
+};
+
+// 一条指针路径 (与导出函数共用)
+// p = [module + moduleOffset]; p = [p + offsets[i]] (i < depth - 1); 目标地址 = p + offsets[depth - 1]
+struct PointerPath {
+    uint32_t moduleOffset;
+    uint16_t depth;
+    uint16_t reserved;
+    uint32_t offsets[PointerScanLayout::MAX_DEPTH];
+};
+
+// 一次扫描的统计 (与导出函数 SessionScanPointerPaths 共用)
+struct PointerScanStats {
+    uint64_t scannedBytes;          // 读取的字节数
+    uint64_t pointers;              // 反向指针表条目数
+    uint64_t mapBytes;              // 反向指针表占用
+    uint64_t nodes;                 // 搜索访问的节点数
+    uint64_t buildMicroseconds;
+    uint64_t searchMicroseconds;
+    uint32_t regions;
+    uint32_t threads;
+    uint32_t results;
+    uint32_t truncated;             // 达到 maxResults / maxNodes 而提前结束
+};
+
+#pragma pack(push, 1)
+
+struct PointerPathFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t moduleSize;            // 主模块大小 (不同版本的游戏不能求交集)
+    uint32_t maxDepth;
+    uint32_t maxOffset;
+    uint64_t count;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(PointerPath) == 32, "pointer path layout changed");
+static_assert(sizeof(PointerPathFileHeader) == 32, "pointer path file layout changed");
+
+// 为 0 的字段换成默认值，超出范围的截断
+PointerScanConfig NormalizePointerScanConfig(const PointerScanConfig& config);
+
+bool operator<(const PointerPath& a, const PointerPath& b);
+bool operator==(const PointerPath& a, const PointerPath& b);
+
+// 反向指针表
+class PointerMap {
+public:
+    PointerMap();
+
+    PointerMap(const PointerMap&) = delete;
+    PointerMap& operator=(const PointerMap&) = delete;
+
+    // 扫描目标进程建表；memory->Read 在内部串行调用 (后端不必线程安全)，解析和排序并行
+    // 表超过 maxMapBytes 时返回 false 并置 stats.truncated
+    bool Build(ProcessMemory* memory, const PointerScanConfig& config, PointerScanStats& stats);
+
+    // 从 target 反向搜索路径，结果已排序
+    void Search(QWORD target, const PointerScanConfig& config, std::vector<PointerPath>& outPaths, PointerScanStats& stats) const;
+
+    void Clear();
+    uint64_t GetCount() const;
+
+private:
+    struct Entry {
+        uint32_t value;     // 编码后的指针值
+        uint32_t source;    // 编码后的指针所在地址
+    };
+
+    struct Range {
+        QWORD base;
+        QWORD size;
+        uint32_t firstPage;
+    };
+
+    struct Partition {
+        uint32_t firstKey;  // 分区覆盖 [firstKey, 下一分区的 firstKey)
+        std::vector<Entry> entries;
+    };
+
+    struct SearchContext;
+
+    std::vector<Range> m_ranges;        // 按地址排序
+    std::vector<Partition> m_partitions;
+    uint32_t m_pageCount;
+    QWORD m_moduleBase;
+    QWORD m_moduleSize;
+
+    bool CollectRanges(ProcessMemory* memory);
+    bool Encode(QWORD address, uint32_t& outKey) const;
+    QWORD Decode(uint32_t key) const;
+    uint64_t LowerKey(QWORD address) const;     // 不小于 address 的最小编码 (超出所有区域时为页数 << 9)
+    size_t FindPartition(uint64_t key) const;
+
+    // 值在 [low, high] 内的条目
+    template <typename Visit>
+    void ForEachPointerTo(QWORD low, QWORD high, Visit&& visit) const;
+
+    void SearchFrom(SearchContext& context, QWORD address, uint32_t depth, uint32_t* chain) const;
+};
+
+// 按路径从目标进程读出地址
+bool ResolvePointerPath(ProcessMemory* memory, QWORD moduleBase, const PointerPath& path, QWORD& outAddress);
+
+// 结果文件；读取和求交集时文件头中的条数多于文件中实际存放的、深度不在 1..MAX_DEPTH 内时失败
+bool WritePointerPathFile(const char* path, QWORD moduleSize, const PointerScanConfig& config,
+    const std::vector<PointerPath>& paths);
+bool ReadPointerPathFile(const char* path, PointerPathFileHeader& outHeader, std::vector<PointerPath>& outPaths);
+
+// 两个结果文件流式求交集 (不整体读入)，写到 outputPath；模块大小不同 (不是同一版本的游戏) 时失败
+bool IntersectPointerPathFiles(const char* first, const char* second, const char* outputPath, uint64_t& outCount);
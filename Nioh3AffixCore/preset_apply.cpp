@@ -0,0 +1,266 @@
+#include "preset_apply.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+    uint64_t ElapsedMicroseconds(std::chrono::steady_clock::time_point start) {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    // 一件装备的一个计划区间 (第 item 件装备的第 s 个区间是 spans[item * plan.spanCount + s])
+    struct ItemSpan {
+        QWORD address;
+        size_t position;        // 在缓冲中的位置
+        uint32_t item;          // 去重后的装备序号
+        uint32_t span;          // 计划中的区间序号
+        uint32_t batch;         // 所在的读取批
+    };
+
+    // 一段改写了的字节
+    struct DirtyRange {
+        QWORD address;
+        size_t position;
+        uint32_t size;
+        uint32_t item;
+        uint32_t batch;         // 所在的读取批
+    };
+
+    // 一次远程读取 (读取批或读回批) 覆盖的连续地址，覆盖的区间为 [first, last)
+    struct Batch {
+        QWORD address;
+        size_t size;
+        size_t position;
+        size_t first;
+        size_t last;
+        bool complete;          // 整批读出 (间隔中的字节有效)
+    };
+
+    // 每件装备只记录第一个失败 (之后的步骤不再处理它)
+    struct ItemState {
+        int32_t failure = 0;
+        bool changed = false;
+    };
+}
+
+uint64_t GetPresetFields(const AffixPreset& preset) {
+    uint64_t fields = preset.basicsMask & ((1u << RECORD_FIELD_AFFIX_FIRST) - 1);
+    for (int slot = 0; slot < MemoryLayout::AFFIX_SLOT_COUNT; slot++) {
+        fields |= AffixSlotFields(slot, preset.slots[slot].fieldMask & RecordFieldSets::AFFIX_ALL_PARTS);
+    }
+    return fields;
+}
+
+size_t GetPresetWrites(const AffixPreset& preset, RecordWrite* outWrites) {
+    size_t count = 0;
+    for (int field = 0; field < RECORD_FIELD_AFFIX_FIRST; field++) {
+        if ((preset.basicsMask & (1u << field)) != 0) {
+            outWrites[count++] = { field, preset.basics[field] };
+        }
+    }
+    for (int slot = 0; slot < MemoryLayout::AFFIX_SLOT_COUNT; slot++) {
+        const AffixPresetSlot& source = preset.slots[slot];
+        for (int part = 0; part < AFFIX_PART_COUNT; part++) {
+            if ((source.fieldMask & (1u << part)) == 0) {
+                continue;
+            }
+            int64_t value = part == AFFIX_PART_ID ? source.id
+                : part == AFFIX_PART_LEVEL ? source.level
+                : source.prefixes[part - AFFIX_PART_PREFIX1];
+            outWrites[count++] = { AffixFieldId(slot, part), value };
+        }
+    }
+    return count;
+}
+
+PresetApplyStatus ApplyPresetToRecords(ProcessMemory* memory, const RecordFieldTable& table, const RecordPlan& plan,
+    const AffixPreset& preset, const QWORD* bases, size_t count, std::vector<int32_t>& outResults,
+    std::vector<PresetItemEdit>& outEdits, std::vector<uint8_t>& outEditBytes, PresetApplyStats& outStats) {
+    auto start = std::chrono::steady_clock::now();
+    outResults.assign(count, PRESET_ITEM_UNCHANGED);
+    outEdits.clear();
+    outEditBytes.clear();
+    outStats = {};
+
+    std::vector<QWORD> items(bases, bases + count);
+    std::sort(items.begin(), items.end());
+    items.erase(std::unique(items.begin(), items.end()), items.end());
+    outStats.items = (uint32_t)items.size();
+    if (plan.spanCount == 0 || items.empty()) {
+        outStats.unchanged = outStats.items;
+        outStats.microseconds = ElapsedMicroseconds(start);
+        return PRESET_APPLY_OK;
+    }
+
+    // 记录互不重叠时各件装备的区间依次展开即按地址有序
+    const uint32_t planStart = plan.spans[0].offset;
+    const uint32_t planEnd = plan.spans[plan.spanCount - 1].offset + plan.spans[plan.spanCount - 1].size;
+    for (size_t i = 1; i < items.size(); i++) {
+        if (items[i] + planStart < items[i - 1] + planEnd) {
+            return PRESET_APPLY_RECORDS_OVERLAP;
+        }
+    }
+
+    // 1. 相近的区间合并为读取批；合并读取失败时逐个区间重读
+    std::vector<ItemSpan> spans;
+    std::vector<Batch> reads;
+    spans.reserve(items.size() * plan.spanCount);
+    size_t bufferSize = 0;
+    for (uint32_t item = 0; item < (uint32_t)items.size(); item++) {
+        for (uint32_t s = 0; s < plan.spanCount; s++) {
+            QWORD address = items[item] + plan.spans[s].offset;
+            QWORD end = address + plan.spans[s].size;
+            if (reads.empty() || address > reads.back().address + reads.back().size + PresetApplyLayout::MERGE_GAP ||
+                end - reads.back().address > PresetApplyLayout::MAX_BATCH) {
+                reads.push_back({ address, 0, bufferSize, spans.size(), spans.size(), true });
+            }
+            Batch& batch = reads.back();
+            batch.size = (size_t)(end - batch.address);
+            batch.last = spans.size() + 1;
+            spans.push_back({ address, batch.position + (size_t)(address - batch.address), item, s, (uint32_t)(reads.size() - 1) });
+            bufferSize = batch.position + batch.size;
+        }
+    }
+
+    std::vector<ItemState> states(items.size());
+    std::vector<uint8_t> before(bufferSize);
+    for (Batch& batch : reads) {
+        outStats.reads++;
+        if (memory->Read(batch.address, &before[batch.position], batch.size)) {
+            outStats.bytesRead += batch.size;
+            continue;
+        }
+        batch.complete = false;
+        for (size_t k = batch.first; k < batch.last; k++) {
+            const ItemSpan& span = spans[k];
+            outStats.reads++;
+            if (memory->Read(span.address, &before[span.position], plan.spans[span.span].size)) {
+                outStats.bytesRead += plan.spans[span.span].size;
+            } else if (states[span.item].failure == 0) {
+                states[span.item].failure = PRESET_ITEM_READ_FAILED;
+            }
+        }
+    }
+
+    // 2. 就地编码各字段，每个区间只保留首尾变化字节之间的部分
+    RecordWrite writes[RECORD_FIELD_COUNT];
+    const size_t writeCount = GetPresetWrites(preset, writes);
+    uint32_t writeSpans[RECORD_FIELD_COUNT];
+    uint32_t writeOffsets[RECORD_FIELD_COUNT];
+    for (size_t w = 0; w < writeCount; w++) {
+        uint32_t position = plan.bufferOffsets[writes[w].field];
+        uint32_t spanStart = 0;
+        uint32_t s = 0;
+        while (position >= spanStart + plan.spans[s].size) {
+            spanStart += plan.spans[s++].size;
+        }
+        writeSpans[w] = s;
+        writeOffsets[w] = position - spanStart;
+    }
+
+    std::vector<uint8_t> after(before);
+    std::vector<uint8_t> bitMasks(bufferSize, 0);
+    std::vector<DirtyRange> dirty;
+    for (uint32_t item = 0; item < (uint32_t)items.size(); item++) {
+        if (states[item].failure != 0) {
+            continue;
+        }
+        const ItemSpan* itemSpans = &spans[(size_t)item * plan.spanCount];
+        for (size_t w = 0; w < writeCount; w++) {
+            size_t position = itemSpans[writeSpans[w]].position + writeOffsets[w];
+            EncodeRecordField(table.fields[writes[w].field], writes[w].value, &after[position], &bitMasks[position]);
+        }
+        for (uint32_t s = 0; s < plan.spanCount; s++) {
+            size_t first = itemSpans[s].position;
+            size_t last = first + plan.spans[s].size;
+            while (first < last && before[first] == after[first]) first++;
+            while (last > first && before[last - 1] == after[last - 1]) last--;
+            if (first < last) {
+                dirty.push_back({ itemSpans[s].address + (first - itemSpans[s].position), first, (uint32_t)(last - first),
+                    item, itemSpans[s].batch });
+                states[item].changed = true;
+            }
+        }
+    }
+
+    // 3. 每个脏区间单独写入: 区间之间的字节可能在读出之后被游戏改写，不能用读出的值写回
+    std::vector<bool> written(dirty.size(), false);
+    for (size_t i = 0; i < dirty.size(); i++) {
+        const DirtyRange& range = dirty[i];
+        outStats.writes++;
+        if (memory->Write(range.address, &after[range.position], range.size)) {
+            written[i] = true;
+            outStats.bytesWritten += range.size;
+        } else if (states[range.item].failure == 0) {
+            states[range.item].failure = PRESET_ITEM_WRITE_FAILED;
+        }
+    }
+
+    // 4. 同一 (整批读出的) 读取批中相近的已写入区间合并为一次读回，核对本次改写的位；
+    //    写入成功的改写交给调用者记入日志
+    std::vector<Batch> checks;
+    size_t previous = 0;
+    for (size_t i = 0; i < dirty.size(); i++) {
+        if (!written[i]) {
+            continue;
+        }
+        const DirtyRange& range = dirty[i];
+        if (checks.empty() || range.batch != dirty[previous].batch || !reads[range.batch].complete ||
+            range.address > checks.back().address + checks.back().size + PresetApplyLayout::MERGE_GAP) {
+            checks.push_back({ range.address, 0, range.position, i, i, false });
+        }
+        checks.back().size = (size_t)(range.address + range.size - checks.back().address);
+        checks.back().last = i + 1;
+        previous = i;
+    }
+
+    std::vector<uint8_t> check;
+    for (Batch& batch : checks) {
+        check.resize(batch.size);
+        outStats.reads++;
+        batch.complete = memory->Read(batch.address, check.data(), batch.size);
+        if (batch.complete) {
+            outStats.bytesRead += batch.size;
+        }
+        for (size_t i = batch.first; i < batch.last; i++) {
+            if (!written[i]) {
+                continue;
+            }
+            const DirtyRange& range = dirty[i];
+            const uint8_t* actual = check.data() + (size_t)(range.address - batch.address);
+            bool verified = batch.complete;
+            for (uint32_t j = 0; j < range.size && verified; j++) {
+                verified = ((actual[j] ^ after[range.position + j]) & bitMasks[range.position + j]) == 0;
+            }
+            if (!verified && states[range.item].failure == 0) {
+                states[range.item].failure = PRESET_ITEM_VERIFY_FAILED;
+            }
+
+            QWORD base = items[range.item];
+            outEdits.push_back({ base, (uint32_t)(range.address - base), range.size, outEditBytes.size() });
+            outEditBytes.insert(outEditBytes.end(), &before[range.position], &before[range.position] + range.size);
+            outEditBytes.insert(outEditBytes.end(), &after[range.position], &after[range.position] + range.size);
+        }
+    }
+
+    std::vector<int32_t> itemResults(items.size());
+    for (size_t item = 0; item < items.size(); item++) {
+        const ItemState& state = states[item];
+        itemResults[item] = state.failure != 0 ? state.failure : state.changed ? PRESET_ITEM_APPLIED : PRESET_ITEM_UNCHANGED;
+        outStats.applied += itemResults[item] == PRESET_ITEM_APPLIED ? 1 : 0;
+        outStats.unchanged += itemResults[item] == PRESET_ITEM_UNCHANGED ? 1 : 0;
+        outStats.failed += state.failure != 0 ? 1 : 0;
+    }
+    PresetApplyStatus status = PRESET_APPLY_OK;
+    for (size_t i = 0; i < count; i++) {
+        outResults[i] = itemResults[std::lower_bound(items.begin(), items.end(), bases[i]) - items.begin()];
+        if (status == PRESET_APPLY_OK) {
+            status = outResults[i] == PRESET_ITEM_READ_FAILED ? PRESET_APPLY_READ_FAILED :
+                outResults[i] == PRESET_ITEM_WRITE_FAILED ? PRESET_APPLY_WRITE_FAILED :
+                outResults[i] == PRESET_ITEM_VERIFY_FAILED ? PRESET_APPLY_VERIFY_FAILED : PRESET_APPLY_OK;
+        }
+    }
+    outStats.microseconds = ElapsedMicroseconds(start);
+    return status;
+}
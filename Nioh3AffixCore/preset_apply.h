@@ -0,0 +1,89 @@
+#pragma once
+
+#include "memory_layout.h"
+#include "process_memory.h"
+#include "record_layout.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 预设批量应用: 把同一套词条 (和可选的基础属性) 写入多件装备，不需要逐件在游戏中选中
+//
+// 逐件写入 (ApplyRecordWrites) 每件装备每个槽位至少一次读 + 一次写。批量应用把全部装备一起处理:
+//   1. 每件装备按同一个读写计划得到若干绝对地址区间，按地址排序后相距不超过 MERGE_GAP 的
+//      合并为一次读取 (单次不超过 MAX_BATCH 字节)；合并读取失败时该批逐个区间重读
+//   2. 在读出的缓冲中就地编码各字段，每个区间只保留首尾变化字节之间的部分 (脏区间)
+//   3. 每个脏区间单独写入: 脏区间之间的字节不属于这次改写，读出之后可能已被游戏改变，不能写回
+//   4. 同一读取批中相距不超过 MERGE_GAP 的已写入区间合并为一次读回，逐件核对本次改写的字节
+//      (位字段只核对该位)
+// 背包数组中相邻的装备通常只需要 1 次读 + 每件 1 次写 + 1 次读回。
+namespace PresetApplyLayout {
+    constexpr uint32_t MERGE_GAP = RecordPlanLayout::MERGE_GAP;
+    constexpr uint32_t MAX_BATCH = 0x40000;
+    constexpr uint32_t MAX_ITEMS = 0x10000;
+}
+
+// 预设中的一个词条槽位；fieldMask 与 WriteAffixExMasked 相同: bit0 id、bit1 level、bit2..bit5 prefix1..prefix4
+struct AffixPresetSlot {
+    int32_t id;
+    int32_t level;
+    uint8_t prefixes[4];
+    uint32_t fieldMask;
+};
+
+// 与导出函数 SessionApplyAffixPreset 共用
+struct AffixPreset {
+    AffixPresetSlot slots[MemoryLayout::AFFIX_SLOT_COUNT];
+    int32_t basics[RECORD_FIELD_AFFIX_FIRST];   // 按 RecordFieldId 排列的基础属性 (地狱武器标志非 0 即置位)
+    uint32_t basicsMask;                        // bit i 表示写入 basics[i]
+};
+
+enum PresetItemResult {
+    PRESET_ITEM_UNCHANGED = 0,      // 已经是预设的值，没有写入
+    PRESET_ITEM_APPLIED = 1,        // 写入后读回一致
+    PRESET_ITEM_READ_FAILED = 2,
+    PRESET_ITEM_WRITE_FAILED = 3,
+    PRESET_ITEM_VERIFY_FAILED = 4   // 读回的值与写入的不同 (游戏同时改写了该装备) 或读回失败
+};
+
+// ApplyPresetToRecords 的整体结果；有装备失败时给出输入顺序中第一件失败装备的原因
+enum PresetApplyStatus {
+    PRESET_APPLY_OK = 0,
+    PRESET_APPLY_RECORDS_OVERLAP = 1,   // 装备记录的计划区间互相重叠，没有访问内存
+    PRESET_APPLY_READ_FAILED = 2,
+    PRESET_APPLY_WRITE_FAILED = 3,
+    PRESET_APPLY_VERIFY_FAILED = 4
+};
+
+struct PresetApplyStats {
+    uint64_t microseconds;
+    uint64_t bytesRead;             // 含读回
+    uint64_t bytesWritten;
+    uint32_t items;                 // 去重后的装备数
+    uint32_t applied;
+    uint32_t unchanged;
+    uint32_t failed;
+    uint32_t reads;                 // 远程读取次数 (含读回)
+    uint32_t writes;                // 远程写入次数
+};
+
+// 一件装备上写入成功的一段改写 (供会话写入编辑日志)
+// before/after 依次存放在 editBytes[position, position + 2 * size) 中
+struct PresetItemEdit {
+    QWORD base;
+    uint32_t offset;
+    uint32_t size;
+    size_t position;
+};
+
+// 预设涉及的字段集合与写入列表 (outWrites 至少 RECORD_FIELD_COUNT 项)，返回写入数
+uint64_t GetPresetFields(const AffixPreset& preset);
+size_t GetPresetWrites(const AffixPreset& preset, RecordWrite* outWrites);
+
+// 把 preset 写入 bases 中的每件装备；plan 必须是 table 下 GetPresetFields(preset) 的计划
+// 重复的基址只处理一次，outResults 中每一项都给出结果 (PresetItemResult)
+// 装备记录的计划区间互相重叠时不访问内存，返回 PRESET_APPLY_RECORDS_OVERLAP；
+// 其余情况 outResults、outEdits 和 outStats 都有效，有装备失败时返回第一件失败装备对应的状态
+PresetApplyStatus ApplyPresetToRecords(ProcessMemory* memory, const RecordFieldTable& table, const RecordPlan& plan,
+    const AffixPreset& preset, const QWORD* bases, size_t count, std::vector<int32_t>& outResults,
+    std::vector<PresetItemEdit>& outEdits, std::vector<uint8_t>& outEditBytes, PresetApplyStats& outStats);
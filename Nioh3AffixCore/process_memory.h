@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+typedef uint64_t QWORD;
+
+class SharedMemory;
+
+// 内存保护/状态常量 (取值与 Win32 PAGE_* / MEM_* 一致，Win32 后端可直接透传)
+namespace MemProtect {
+    constexpr uint32_t NoAccess = 0x01;
+    constexpr uint32_t ReadOnly = 0x02;
+    constexpr uint32_t ReadWrite = 0x04;
+    constexpr uint32_t WriteCopy = 0x08;
+    constexpr uint32_t Execute = 0x10;
+    constexpr uint32_t ExecuteRead = 0x20;
+    constexpr uint32_t ExecuteReadWrite = 0x40;
+    constexpr uint32_t ExecuteWriteCopy = 0x80;
+    constexpr uint32_t Guard = 0x100;
+
+    // 是否可读 (不含 guard 页)
+    inline bool IsReadable(uint32_t protect) {
+        if ((protect & Guard) != 0) return false;
+        return (protect & (ReadOnly | ReadWrite | WriteCopy | ExecuteRead | ExecuteReadWrite | ExecuteWriteCopy)) != 0;
+    }
+}
+
+namespace MemState {
+    constexpr uint32_t Commit = 0x1000;
+    constexpr uint32_t Reserve = 0x2000;
+    constexpr uint32_t Free = 0x10000;
+}
+
+namespace MemType {
+    constexpr uint32_t Private = 0x20000;
+    constexpr uint32_t Mapped = 0x40000;
+    constexpr uint32_t Image = 0x1000000;
+}
+
+// VirtualQueryEx 结果
+struct MemoryRegion {
+    QWORD baseAddress = 0;
+    QWORD regionSize = 0;
+    uint32_t state = 0;
+    uint32_t protect = 0;
+    uint32_t type = 0;
+};
+
+// 同时映射到目标进程和本进程的共享内存 (见 ProcessMemory::MapShared)
+struct SharedView {
+    QWORD remoteAddress = 0;            // 目标进程中的地址
+    SharedMemory* section = nullptr;    // 本进程一侧的映射，由后端创建，UnmapShared 释放
+
+    bool IsMapped() const { return section != nullptr; }
+};
+
+// 目标进程内存访问接口
+// 所有注入器/扫描器都通过它访问目标进程，便于替换为假后端 (Linux 下验证) 或加装跟踪层
+class ProcessMemory {
+public:
+    virtual ~ProcessMemory() = default;
+
+    // 读取内存，bytesRead 可为空；部分读取时返回 false 并在 bytesRead 中给出已读字节数
+    virtual bool Read(QWORD address, void* buffer, size_t size, size_t* bytesRead = nullptr) = 0;
+
+    // 写入内存
+    virtual bool Write(QWORD address, const void* buffer, size_t size) = 0;
+
+    // 查询地址所在区域
+    virtual bool Query(QWORD address, MemoryRegion& outRegion) = 0;
+
+    // 修改保护属性，oldProtect 可为空
+    virtual bool Protect(QWORD address, size_t size, uint32_t newProtect, uint32_t* oldProtect) = 0;
+
+    // 分配内存 (MEM_COMMIT | MEM_RESERVE)，preferredAddress 为 0 表示由系统决定；失败返回 0
+    virtual QWORD Allocate(QWORD preferredAddress, size_t size, uint32_t protect) = 0;
+
+    // 释放 Allocate 分配的内存
+    virtual bool Free(QWORD address) = 0;
+
+    // 获取主模块基址和大小
+    virtual bool GetMainModule(QWORD& baseAddress, QWORD& moduleSize) = 0;
+
+    // 后端是否支持 MapShared (不支持时调用者不必逐个尝试地址)
+    virtual bool CanMapShared() const { return false; }
+
+    // 创建一块共享内存，映射到目标进程的 preferredAddress (必须按 64KB 对齐，可读写) 和本进程
+    // 本进程通过普通读写访问，不再需要跨进程调用；后端不支持或该地址不可用时返回 false
+    virtual bool MapShared(QWORD preferredAddress, size_t size, SharedView& outView) {
+        (void)preferredAddress; (void)size; (void)outView;
+        return false;
+    }
+
+    // 解除 MapShared 建立的两侧映射
+    virtual void UnmapShared(SharedView& view) { (void)view; }
+
+    // 挂起目标进程的全部线程 (改写代码期间使用)，outInstructionPointers 可为空，否则返回各线程挂起时的指令地址
+    // 后端不支持或挂起失败时返回 false 且没有线程处于挂起状态；返回 true 后必须调用 ResumeThreads
+    virtual bool SuspendThreads(std::vector<QWORD>* outInstructionPointers) {
+        (void)outInstructionPointers;
+        return false;
+    }
+
+    // 恢复 SuspendThreads 挂起的线程
+    virtual void ResumeThreads() {}
+
+    // 标记接下来的操作属于哪个阶段 (如 "EnableCapture")，供跟踪层记录；默认忽略
+    virtual void MarkPhase(const char* phase) { (void)phase; }
+};
@@ -0,0 +1,345 @@
+#include "record_layout.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    // 布局文件中的单个字段 (基础属性) 的名称，顺序与 RecordFieldId 相同
+    const char* const FIELD_NAMES[RECORD_FIELD_AFFIX_FIRST] = {
+        "item_id", "transmog_id", "level", "equip_plus_value", "quality", "underworld_skill_id", "familiarity",
+        "underworld_flag",
+    };
+
+    // 布局文件中各项最后出现的行号的下标: 基础属性为 RecordFieldId，之后是词条槽位的参数
+    enum LayoutItem {
+        ITEM_AFFIX_FIRST = RECORD_FIELD_AFFIX_FIRST,
+        ITEM_AFFIX_STRIDE,
+        ITEM_AFFIX_ID,
+        ITEM_AFFIX_LEVEL,
+        ITEM_AFFIX_PREFIX,
+        ITEM_COUNT
+    };
+
+    // 词条槽位的参数: 槽位 slot 的字段偏移为 first + slot * stride + 槽位内偏移
+    struct AffixSlotShape {
+        uint32_t first;
+        uint32_t stride;
+        RecordFieldDesc id;
+        RecordFieldDesc level;
+        RecordFieldDesc prefix;             // 第一个前缀字节，其余依次存放
+    };
+
+    AffixSlotShape GetAffixSlotShape(const RecordFieldTable& table) {
+        AffixSlotShape shape;
+        const RecordFieldDesc& slot0 = table.fields[AffixFieldId(0, AFFIX_PART_ID)];
+        const RecordFieldDesc& slot1 = table.fields[AffixFieldId(1, AFFIX_PART_ID)];
+        shape.first = std::min(slot0.offset,
+            std::min(table.fields[AffixFieldId(0, AFFIX_PART_LEVEL)].offset, table.fields[AffixFieldId(0, AFFIX_PART_PREFIX1)].offset));
+        shape.stride = slot1.offset - slot0.offset;
+        shape.id = slot0;
+        shape.level = table.fields[AffixFieldId(0, AFFIX_PART_LEVEL)];
+        shape.prefix = table.fields[AffixFieldId(0, AFFIX_PART_PREFIX1)];
+        shape.id.offset -= shape.first;
+        shape.level.offset -= shape.first;
+        shape.prefix.offset -= shape.first;
+        return shape;
+    }
+
+    void ApplyAffixSlotShape(const AffixSlotShape& shape, RecordFieldTable& table) {
+        for (int slot = 0; slot < MemoryLayout::AFFIX_SLOT_COUNT; slot++) {
+            uint32_t slotOffset = shape.first + slot * shape.stride;
+            RecordFieldDesc& id = table.fields[AffixFieldId(slot, AFFIX_PART_ID)];
+            RecordFieldDesc& level = table.fields[AffixFieldId(slot, AFFIX_PART_LEVEL)];
+            id = shape.id;
+            id.offset += slotOffset;
+            level = shape.level;
+            level.offset += slotOffset;
+            for (int i = 0; i < 4; i++) {
+                RecordFieldDesc& prefix = table.fields[AffixFieldId(slot, AFFIX_PART_PREFIX1 + i)];
+                prefix = shape.prefix;
+                prefix.offset += slotOffset + i;
+            }
+        }
+    }
+
+    // 槽位内字段从最低偏移到最高末尾的字节数
+    uint32_t GetAffixSlotExtent(const AffixSlotShape& shape) {
+        uint32_t start = std::min(shape.id.offset, std::min(shape.level.offset, shape.prefix.offset));
+        uint32_t end = std::max(shape.id.offset + shape.id.size, std::max(shape.level.offset + shape.level.size, shape.prefix.offset + 4));
+        return end - start;
+    }
+
+    // 槽位之间不重叠 (stride 不小于槽位内字段的范围)，最后一个槽位的末尾不超过记录的上限
+    bool IsValidAffixSlotShape(const AffixSlotShape& shape) {
+        uint64_t extent = GetAffixSlotExtent(shape);
+        uint64_t end = (uint64_t)shape.first + (uint64_t)(MemoryLayout::AFFIX_SLOT_COUNT - 1) * shape.stride +
+            std::max<uint64_t>({ shape.id.offset + shape.id.size, shape.level.offset + shape.level.size, shape.prefix.offset + 4 });
+        return shape.stride >= extent && end <= RecordPlanLayout::MAX_EXTENT;
+    }
+
+    // 两个字段的字节是否重叠 (同一字节中不同位的两个位字段不算)
+    bool FieldsOverlap(const RecordFieldDesc& a, const RecordFieldDesc& b) {
+        if (a.offset >= b.offset + b.size || b.offset >= a.offset + a.size) {
+            return false;
+        }
+        return a.bit == RecordPlanLayout::NO_BIT || b.bit == RecordPlanLayout::NO_BIT || a.bit == b.bit;
+    }
+
+    // 第一个不合法或与编号更小的字段重叠的字段 (outOther 为后者，不合法时为 -1)；全部合法时返回 -1
+    int FindInvalidField(const RecordFieldTable& table, int& outOther) {
+        outOther = -1;
+        for (int field = 0; field < RECORD_FIELD_COUNT; field++) {
+            if (!IsValidRecordField(table.fields[field])) {
+                return field;
+            }
+            for (int other = 0; other < field; other++) {
+                if (FieldsOverlap(table.fields[field], table.fields[other])) {
+                    outOther = other;
+                    return field;
+                }
+            }
+        }
+        return -1;
+    }
+
+    // 字段的值由哪些行决定: 词条字段取决于槽位参数和槽位内的字段，取其中最后的一行
+    int GetFieldLine(const int* itemLines, int field) {
+        if (field < RECORD_FIELD_AFFIX_FIRST) {
+            return itemLines[field];
+        }
+        int part = (field - RECORD_FIELD_AFFIX_FIRST) % AFFIX_PART_COUNT;
+        int item = part == AFFIX_PART_ID ? ITEM_AFFIX_ID : part == AFFIX_PART_LEVEL ? ITEM_AFFIX_LEVEL : ITEM_AFFIX_PREFIX;
+        return std::max(itemLines[item], std::max(itemLines[ITEM_AFFIX_FIRST], itemLines[ITEM_AFFIX_STRIDE]));
+    }
+
+    bool ParseNumber(const char* text, uint32_t& outValue) {
+        char* end = nullptr;
+        unsigned long long value = strtoull(text, &end, 0);
+        if (end == text || *end != '\0' || value > 0xFFFFFFFFull) {
+            return false;
+        }
+        outValue = (uint32_t)value;
+        return true;
+    }
+
+    // "名称 偏移 [字节数 [位号]]"，数值个数超出该项允许的范围时返回 false；outItem 为该行设置的项 (空行为 -1)
+    bool ApplyLine(char* line, RecordFieldTable& table, AffixSlotShape& shape, int& outItem) {
+        outItem = -1;
+        const char* tokens[5] = {};
+        int count = 0;
+        for (char* p = line; *p != '\0';) {
+            if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+                *p++ = '\0';
+                continue;
+            }
+            if (count == 5) {
+                return false;
+            }
+            tokens[count++] = p;
+            while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+        }
+        if (count == 0) {
+            return true;
+        }
+        uint32_t values[4] = {};
+        for (int i = 1; i < count; i++) {
+            if (!ParseNumber(tokens[i], values[i - 1])) {
+                return false;
+            }
+        }
+        const int valueCount = count - 1;
+        const char* name = tokens[0];
+
+        if (strcmp(name, "affix_first") == 0 || strcmp(name, "affix_stride") == 0) {
+            if (valueCount != 1) {
+                return false;
+            }
+            (name[6] == 'f' ? shape.first : shape.stride) = values[0];
+            outItem = name[6] == 'f' ? ITEM_AFFIX_FIRST : ITEM_AFFIX_STRIDE;
+            return true;
+        }
+
+        RecordFieldDesc* desc = nullptr;
+        if (strcmp(name, "affix_id") == 0) {
+            desc = &shape.id;
+            outItem = ITEM_AFFIX_ID;
+        } else if (strcmp(name, "affix_level") == 0) {
+            desc = &shape.level;
+            outItem = ITEM_AFFIX_LEVEL;
+        } else if (strcmp(name, "affix_prefix") == 0) {
+            desc = &shape.prefix;
+            outItem = ITEM_AFFIX_PREFIX;
+        } else {
+            for (int field = 0; field < RECORD_FIELD_AFFIX_FIRST; field++) {
+                if (strcmp(name, FIELD_NAMES[field]) == 0) {
+                    desc = &table.fields[field];
+                    outItem = field;
+                }
+            }
+        }
+        // 只有位字段可以指定位号，前缀字节固定为 1 字节
+        bool isBitField = desc == &table.fields[RECORD_FIELD_UNDERWORLD_FLAG];
+        if (desc == nullptr || valueCount < 1 || valueCount > (isBitField ? 3 : 2) ||
+            (desc == &shape.prefix && valueCount == 2 && values[1] != 1)) {
+            return false;
+        }
+        desc->offset = values[0];
+        if (valueCount >= 2) {
+            if ((values[1] != 1 && values[1] != 2 && values[1] != 4) || (isBitField && values[1] != 1)) {
+                return false;
+            }
+            desc->size = (uint8_t)values[1];
+        }
+        if (valueCount == 3) {
+            if (values[2] > 7) {
+                return false;
+            }
+            desc->bit = (uint8_t)values[2];
+        }
+        return true;
+    }
+}
+
+bool IsValidRecordField(const RecordFieldDesc& desc) {
+    if (desc.size != 1 && desc.size != 2 && desc.size != 4) {
+        return false;
+    }
+    if (desc.bit != RecordPlanLayout::NO_BIT && (desc.bit > 7 || desc.size != 1)) {
+        return false;
+    }
+    return desc.isSigned <= 1 && desc.offset <= RecordPlanLayout::MAX_EXTENT - desc.size;
+}
+
+void RecordLayout::Reset() {
+    m_table = DEFAULT_RECORD_FIELDS;
+    m_isDefault = true;
+}
+
+bool RecordLayout::Set(const RecordFieldTable& table) {
+    int other;
+    if (FindInvalidField(table, other) >= 0) {
+        return false;
+    }
+    bool isDefault = true;
+    for (int field = 0; field < RECORD_FIELD_COUNT; field++) {
+        const RecordFieldDesc& desc = table.fields[field];
+        const RecordFieldDesc& builtIn = DEFAULT_RECORD_FIELDS.fields[field];
+        isDefault = isDefault && desc.offset == builtIn.offset && desc.size == builtIn.size &&
+            desc.bit == builtIn.bit && desc.isSigned == builtIn.isSigned;
+    }
+    m_table = table;
+    for (RecordFieldDesc& desc : m_table.fields) {
+        desc.reserved = 0;
+    }
+    m_isDefault = isDefault;
+    return true;
+}
+
+bool LoadRecordLayout(const char* path, RecordLayout& outLayout, int* outLine) {
+    if (outLine != nullptr) {
+        *outLine = 0;
+    }
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        return false;
+    }
+
+    RecordFieldTable table = DEFAULT_RECORD_FIELDS;
+    AffixSlotShape shape = GetAffixSlotShape(table);
+    char line[RecordPlanLayout::MAX_LINE];
+    int lineNumber = 0;
+    int itemLines[ITEM_COUNT] = {};
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file) != nullptr) {
+        lineNumber++;
+        size_t length = strlen(line);
+        if (length == sizeof(line) - 1 && line[length - 1] != '\n' && !feof(file)) {
+            ok = false;     // 行太长
+            break;
+        }
+        char* comment = strchr(line, '#');
+        if (comment != nullptr) {
+            *comment = '\0';
+        }
+        int item;
+        ok = ApplyLine(line, table, shape, item);
+        if (ok && item >= 0) {
+            itemLines[item] = lineNumber;
+        }
+    }
+    bool readError = ferror(file) != 0;
+    fclose(file);
+    if (!ok || readError) {
+        if (outLine != nullptr) {
+            *outLine = readError ? 0 : lineNumber;
+        }
+        return false;
+    }
+
+    // 各行单独合法但组合起来不合法时，出错的行为决定相关字段的最后一行
+    int badLine = 0;
+    if (!IsValidAffixSlotShape(shape)) {
+        badLine = GetFieldLine(itemLines, AffixFieldId(0, AFFIX_PART_ID));
+        badLine = std::max(badLine, std::max(itemLines[ITEM_AFFIX_LEVEL], itemLines[ITEM_AFFIX_PREFIX]));
+    } else {
+        ApplyAffixSlotShape(shape, table);
+        int other;
+        int field = FindInvalidField(table, other);
+        if (field >= 0) {
+            badLine = std::max(GetFieldLine(itemLines, field), other >= 0 ? GetFieldLine(itemLines, other) : 0);
+        }
+    }
+    if (badLine != 0 || !outLayout.Set(table)) {
+        if (outLine != nullptr) {
+            *outLine = badLine != 0 ? badLine : lineNumber;
+        }
+        return false;
+    }
+    return true;
+}
+
+bool WriteRecordLayout(const char* path, const RecordLayout& layout) {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    const RecordFieldTable& table = layout.GetTable();
+    bool ok = fprintf(file, "# 装备记录布局: 名称 偏移 [字节数 [位号]]\n") > 0;
+    for (int field = 0; field < RECORD_FIELD_AFFIX_FIRST && ok; field++) {
+        const RecordFieldDesc& desc = table.fields[field];
+        ok = desc.bit != RecordPlanLayout::NO_BIT
+            ? fprintf(file, "%-20s 0x%02X %u %u\n", FIELD_NAMES[field], desc.offset, desc.size, desc.bit) > 0
+            : fprintf(file, "%-20s 0x%02X %u\n", FIELD_NAMES[field], desc.offset, desc.size) > 0;
+    }
+
+    // 词条字段写成槽位参数 (载入时按槽位 0 和 1 重新推出全部槽位)
+    AffixSlotShape shape = GetAffixSlotShape(table);
+    ok = ok && fprintf(file, "\n# 词条槽位: 偏移相对于槽位开头\n") > 0 &&
+        fprintf(file, "%-20s 0x%02X\n", "affix_first", shape.first) > 0 &&
+        fprintf(file, "%-20s 0x%02X\n", "affix_stride", shape.stride) > 0 &&
+        fprintf(file, "%-20s 0x%02X %u\n", "affix_id", shape.id.offset, shape.id.size) > 0 &&
+        fprintf(file, "%-20s 0x%02X %u\n", "affix_level", shape.level.offset, shape.level.size) > 0 &&
+        fprintf(file, "%-20s 0x%02X %u\n", "affix_prefix", shape.prefix.offset, shape.prefix.size) > 0;
+    return fclose(file) == 0 && ok;
+}
+
+const RecordPlan& RecordPlanCache::Get(const RecordLayout& layout, uint64_t fields) {
+    auto it = m_plans.find(fields);
+    if (it == m_plans.end()) {
+        it = m_plans.emplace(fields, CompileRecordPlan(layout.GetTable(), fields)).first;
+    }
+    return it->second;
+}
+
+bool ReadRecordPlan(ProcessMemory* memory, QWORD base, const RecordPlan& plan, uint8_t* buffer) {
+    for (uint32_t i = 0; i < plan.spanCount; i++) {
+        const RecordSpan& span = plan.spans[i];
+        if (!memory->Read(base + span.offset, buffer, span.size)) {
+            return false;
+        }
+        buffer += span.size;
+    }
+    return true;
+}
@@ -0,0 +1,267 @@
+#pragma once
+
+#include "memory_layout.h"
+#include "process_memory.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+
+// 装备记录的字段描述和读写计划
+//
+// 字段描述: 每个字段的偏移、字节数、位号和符号，默认值来自 EquipmentLayout / MemoryLayout，
+// 游戏更新后偏移变化时可以载入布局文件 (文本，见 LoadRecordLayout) 覆盖，不需要重新编译。
+// 读写计划: 把一组字段 (64 位掩码) 编译为覆盖它们的最少区间。字段按偏移排序后，相邻字段的间隔
+// 不超过 MERGE_GAP 时合并为一个区间 (一次远程读取的开销远大于多读几百字节)；区间依次存放在一个缓冲中，
+// 计划中记录每个字段在缓冲中的位置。
+// 布局为内置默认值时，编译期已知的字段集合直接使用 constexpr 生成的计划 (DefaultRecordPlan)，
+// 其余情况按字段集合缓存运行期编译的计划 (RecordPlanCache)。
+namespace RecordPlanLayout {
+    constexpr uint32_t MERGE_GAP = 0x100;
+    constexpr uint32_t MAX_EXTENT = 0x10000;        // 字段末尾相对基址的上限
+    constexpr uint8_t NO_BIT = 0xFF;
+    constexpr uint32_t MAX_LINE = 256;              // 布局文件一行的最大长度
+}
+
+// 字段编号 (与导出函数 SessionGetRecordLayout 共用)
+// 词条字段从 RECORD_FIELD_AFFIX_FIRST 开始，每个槽位 AFFIX_PART_COUNT 个 (见 AffixFieldId)
+enum RecordFieldId {
+    RECORD_FIELD_ITEM_ID = 0,
+    RECORD_FIELD_TRANSMOG_ID = 1,
+    RECORD_FIELD_LEVEL = 2,
+    RECORD_FIELD_EQUIP_PLUS_VALUE = 3,
+    RECORD_FIELD_QUALITY = 4,
+    RECORD_FIELD_UNDERWORLD_SKILL_ID = 5,
+    RECORD_FIELD_FAMILIARITY = 6,
+    RECORD_FIELD_UNDERWORLD_FLAG = 7,
+    RECORD_FIELD_AFFIX_FIRST = 8
+};
+
+enum AffixPart {
+    AFFIX_PART_ID = 0,
+    AFFIX_PART_LEVEL = 1,
+    AFFIX_PART_PREFIX1 = 2,         // 4 个前缀字节依次为 PREFIX1..PREFIX1 + 3
+    AFFIX_PART_COUNT = 6
+};
+
+constexpr int RECORD_FIELD_COUNT = RECORD_FIELD_AFFIX_FIRST + MemoryLayout::AFFIX_SLOT_COUNT * AFFIX_PART_COUNT;
+static_assert(RECORD_FIELD_COUNT <= 64, "Field sets are 64-bit masks");
+
+constexpr int AffixFieldId(int slotIndex, int part) {
+    return RECORD_FIELD_AFFIX_FIRST + slotIndex * AFFIX_PART_COUNT + part;
+}
+
+constexpr uint64_t RecordFieldBit(int field) {
+    return 1ull << field;
+}
+
+// parts 的第 i 位选择 AffixPart i
+constexpr uint64_t AffixSlotFields(int slotIndex, uint32_t parts) {
+    return (uint64_t)(parts & ((1u << AFFIX_PART_COUNT) - 1)) << AffixFieldId(slotIndex, 0);
+}
+
+namespace RecordFieldSets {
+    constexpr uint64_t BASICS = RecordFieldBit(RECORD_FIELD_ITEM_ID) | RecordFieldBit(RECORD_FIELD_TRANSMOG_ID) |
+        RecordFieldBit(RECORD_FIELD_LEVEL);
+    constexpr uint64_t EXTENDED = RecordFieldBit(RECORD_FIELD_EQUIP_PLUS_VALUE) | RecordFieldBit(RECORD_FIELD_QUALITY);
+    constexpr uint64_t WEAPON = RecordFieldBit(RECORD_FIELD_UNDERWORLD_SKILL_ID) | RecordFieldBit(RECORD_FIELD_FAMILIARITY) |
+        RecordFieldBit(RECORD_FIELD_UNDERWORLD_FLAG);
+    constexpr uint32_t AFFIX_ID_LEVEL = (1u << AFFIX_PART_ID) | (1u << AFFIX_PART_LEVEL);
+    constexpr uint32_t AFFIX_ALL_PARTS = (1u << AFFIX_PART_COUNT) - 1;
+    constexpr uint64_t ALL = RECORD_FIELD_COUNT == 64 ? ~0ull : (1ull << RECORD_FIELD_COUNT) - 1;
+}
+
+// 一个字段的描述 (与导出函数 SessionGetRecordLayout 共用)
+struct RecordFieldDesc {
+    uint32_t offset;        // 相对装备基址
+    uint8_t size;           // 1、2 或 4
+    uint8_t bit;            // 位字段的位号 (0..7，size 为 1)，整字段为 NO_BIT
+    uint8_t isSigned;       // 整字段读出时是否符号扩展
+    uint8_t reserved;
+};
+
+static_assert(sizeof(RecordFieldDesc) == 8, "RecordFieldDesc size mismatch");
+
+struct RecordFieldTable {
+    RecordFieldDesc fields[RECORD_FIELD_COUNT];
+};
+
+constexpr RecordFieldTable MakeDefaultRecordFields() {
+    RecordFieldTable table{};
+    table.fields[RECORD_FIELD_ITEM_ID] = { EquipmentLayout::ITEM_ID_OFFSET, 2, RecordPlanLayout::NO_BIT, 1, 0 };
+    table.fields[RECORD_FIELD_TRANSMOG_ID] = { EquipmentLayout::TRANSMOG_ID_OFFSET, 2, RecordPlanLayout::NO_BIT, 1, 0 };
+    table.fields[RECORD_FIELD_LEVEL] = { EquipmentLayout::LEVEL_OFFSET, 2, RecordPlanLayout::NO_BIT, 1, 0 };
+    table.fields[RECORD_FIELD_EQUIP_PLUS_VALUE] = { EquipmentLayout::EQUIPMENT_PLUS_VALUE_OFFSET, 1, RecordPlanLayout::NO_BIT, 0, 0 };
+    table.fields[RECORD_FIELD_QUALITY] = { EquipmentLayout::QUALITY_OFFSET, 4, RecordPlanLayout::NO_BIT, 1, 0 };
+    table.fields[RECORD_FIELD_UNDERWORLD_SKILL_ID] = { EquipmentLayout::UNDERWORLD_SKILL_ID_OFFSET, 4, RecordPlanLayout::NO_BIT, 1, 0 };
+    table.fields[RECORD_FIELD_FAMILIARITY] = { EquipmentLayout::FAMILIARITY_OFFSET, 4, RecordPlanLayout::NO_BIT, 1, 0 };
+    table.fields[RECORD_FIELD_UNDERWORLD_FLAG] = { EquipmentLayout::UNDERWORLD_FLAG_OFFSET, 1, EquipmentLayout::UNDERWORLD_FLAG_BIT, 0, 0 };
+    for (int slot = 0; slot < MemoryLayout::AFFIX_SLOT_COUNT; slot++) {
+        uint32_t slotOffset = MemoryLayout::FIRST_AFFIX_OFFSET + slot * MemoryLayout::AFFIX_SLOT_SIZE;
+        table.fields[AffixFieldId(slot, AFFIX_PART_ID)] = { slotOffset + MemoryLayout::AFFIX_ID_OFFSET, 4, RecordPlanLayout::NO_BIT, 1, 0 };
+        table.fields[AffixFieldId(slot, AFFIX_PART_LEVEL)] = { slotOffset + MemoryLayout::AFFIX_LEVEL_OFFSET, 4, RecordPlanLayout::NO_BIT, 1, 0 };
+        for (int i = 0; i < 4; i++) {
+            table.fields[AffixFieldId(slot, AFFIX_PART_PREFIX1 + i)] =
+                { slotOffset + MemoryLayout::AFFIX_PREFIX1_OFFSET + i, 1, RecordPlanLayout::NO_BIT, 0, 0 };
+        }
+    }
+    return table;
+}
+
+constexpr RecordFieldTable DEFAULT_RECORD_FIELDS = MakeDefaultRecordFields();
+
+struct RecordSpan {
+    uint32_t offset;        // 相对装备基址
+    uint32_t size;
+};
+
+// 一组字段的读写计划: spans 按偏移升序，依次存放在 bufferSize 字节的缓冲中
+struct RecordPlan {
+    uint64_t fields;
+    uint32_t spanCount;
+    uint32_t bufferSize;
+    RecordSpan spans[RECORD_FIELD_COUNT];
+    uint32_t bufferOffsets[RECORD_FIELD_COUNT];     // 字段在缓冲中的位置 (只有 fields 中的字段有效)
+};
+
+constexpr RecordPlan CompileRecordPlan(const RecordFieldTable& table, uint64_t fields) {
+    RecordPlan plan{};
+    plan.fields = fields & RecordFieldSets::ALL;
+
+    // 按偏移排序 (插入排序，字段数很少)
+    int order[RECORD_FIELD_COUNT] = {};
+    int count = 0;
+    for (int field = 0; field < RECORD_FIELD_COUNT; field++) {
+        if ((plan.fields & RecordFieldBit(field)) == 0) {
+            continue;
+        }
+        int i = count++;
+        while (i > 0 && table.fields[order[i - 1]].offset > table.fields[field].offset) {
+            order[i] = order[i - 1];
+            i--;
+        }
+        order[i] = field;
+    }
+
+    uint32_t spanEnd = 0;
+    for (int i = 0; i < count; i++) {
+        const RecordFieldDesc& desc = table.fields[order[i]];
+        uint32_t end = desc.offset + desc.size;
+        if (plan.spanCount == 0 || desc.offset > spanEnd + RecordPlanLayout::MERGE_GAP) {
+            plan.spans[plan.spanCount++] = { desc.offset, desc.size };
+            spanEnd = end;
+        } else if (end > spanEnd) {
+            plan.spans[plan.spanCount - 1].size += end - spanEnd;
+            spanEnd = end;
+        }
+    }
+
+    uint32_t spanStart = 0;
+    for (uint32_t s = 0, i = 0; s < plan.spanCount; s++) {
+        const RecordSpan& span = plan.spans[s];
+        for (; i < (uint32_t)count && table.fields[order[i]].offset < span.offset + span.size; i++) {
+            plan.bufferOffsets[order[i]] = spanStart + (table.fields[order[i]].offset - span.offset);
+        }
+        spanStart += span.size;
+    }
+    plan.bufferSize = spanStart;
+    return plan;
+}
+
+// 内置布局下编译期已知字段集合的计划
+template <uint64_t Fields>
+struct DefaultRecordPlan {
+    static constexpr RecordPlan plan = CompileRecordPlan(DEFAULT_RECORD_FIELDS, Fields);
+};
+
+template <uint32_t Parts, size_t... Slots>
+constexpr std::array<RecordPlan, sizeof...(Slots)> CompileAffixSlotPlans(std::index_sequence<Slots...>) {
+    return { { CompileRecordPlan(DEFAULT_RECORD_FIELDS, AffixSlotFields((int)Slots, Parts))... } };
+}
+
+// 内置布局下每个词条槽位的 Parts 字段的计划
+template <uint32_t Parts>
+struct DefaultAffixSlotPlans {
+    static constexpr std::array<RecordPlan, MemoryLayout::AFFIX_SLOT_COUNT> plans =
+        CompileAffixSlotPlans<Parts>(std::make_index_sequence<MemoryLayout::AFFIX_SLOT_COUNT>());
+};
+
+// 字段描述表: 默认为内置布局
+class RecordLayout {
+public:
+    RecordLayout() { Reset(); }
+
+    void Reset();
+    bool IsDefault() const { return m_isDefault; }
+    const RecordFieldTable& GetTable() const { return m_table; }
+    const RecordFieldDesc& Get(int field) const { return m_table.fields[field]; }
+
+    // 替换全部字段，有不合法或互相重叠的字段时返回 false 且不修改
+    bool Set(const RecordFieldTable& table);
+
+private:
+    RecordFieldTable m_table;
+    bool m_isDefault;
+};
+
+bool IsValidRecordField(const RecordFieldDesc& desc);
+
+// 布局文件: 每行 "名称 偏移 [字节数 [位号]]"，# 之后为注释，数值可以是十进制或 0x 开头的十六进制
+// 名称为 item_id、transmog_id、level、equip_plus_value、quality、underworld_skill_id、familiarity、
+// underworld_flag，以及词条槽位的 affix_first、affix_stride (只有偏移) 和槽位内的 affix_id、affix_level、
+// affix_prefix (4 个前缀字节依次存放，字节数为 1)。文件中没有出现的项保持内置值。
+// 有不认识的名称、不合法的值、字段互相重叠、槽位间距小于槽位内字段的范围或槽位超出记录上限时返回 false，
+// outLine 为出错的行号 (组合起来才不合法时为相关项中最后的一行；文件无法打开时为 0)
+bool LoadRecordLayout(const char* path, RecordLayout& outLayout, int* outLine);
+bool WriteRecordLayout(const char* path, const RecordLayout& layout);
+
+// 运行期编译的计划，按字段集合缓存 (布局变化后必须 Clear)；返回的引用在 Clear 之前有效
+class RecordPlanCache {
+public:
+    const RecordPlan& Get(const RecordLayout& layout, uint64_t fields);
+    void Clear() { m_plans.clear(); }
+    size_t GetSize() const { return m_plans.size(); }
+
+private:
+    std::unordered_map<uint64_t, RecordPlan> m_plans;
+};
+
+// 对装备记录中一个字段的写入 (字段的偏移和宽度来自记录布局)
+// 位字段只改写该位 (value 非 0 时置位)，其余位保持目标进程中的原值
+struct RecordWrite {
+    int field;          // RecordFieldId 或 AffixFieldId
+    int64_t value;
+};
+
+// 按计划读出各区间，依次存入 buffer (plan.bufferSize 字节)
+bool ReadRecordPlan(ProcessMemory* memory, QWORD base, const RecordPlan& plan, uint8_t* buffer);
+
+// 字段的值 (小端；整字段按 isSigned 扩展，位字段为 0 或 1)
+inline int64_t DecodeRecordField(const RecordFieldDesc& desc, const uint8_t* bytes) {
+    uint32_t raw = 0;
+    for (uint32_t i = 0; i < desc.size; i++) {
+        raw |= (uint32_t)bytes[i] << (i * 8);
+    }
+    if (desc.bit != RecordPlanLayout::NO_BIT) {
+        return (raw >> desc.bit) & 1;
+    }
+    if (desc.isSigned && desc.size < 4 && (raw & (1u << (desc.size * 8 - 1))) != 0) {
+        raw |= ~0u << (desc.size * 8);
+    }
+    return desc.isSigned ? (int64_t)(int32_t)raw : (int64_t)raw;
+}
+
+// 把 value 写入 bytes 中的字段 (位字段只改写该位，value 非 0 时置位)，bitMasks 中标出改写的位
+inline void EncodeRecordField(const RecordFieldDesc& desc, int64_t value, uint8_t* bytes, uint8_t* bitMasks) {
+    if (desc.bit != RecordPlanLayout::NO_BIT) {
+        uint8_t mask = (uint8_t)(1u << desc.bit);
+        bytes[0] = (uint8_t)(value != 0 ? bytes[0] | mask : bytes[0] & ~mask);
+        bitMasks[0] |= mask;
+        return;
+    }
+    for (uint32_t i = 0; i < desc.size; i++) {
+        bytes[i] = (uint8_t)((uint64_t)value >> (i * 8));
+        bitMasks[i] = 0xFF;
+    }
+}
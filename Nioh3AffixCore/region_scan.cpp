@@ -0,0 +1,36 @@
+#include "region_scan.h"
+#include <algorithm>
+
+namespace {
+    bool IsWritable(uint32_t protect) {
+        return MemProtect::IsReadable(protect) &&
+            (protect & (MemProtect::ReadWrite | MemProtect::WriteCopy | MemProtect::ExecuteReadWrite | MemProtect::ExecuteWriteCopy)) != 0;
+    }
+}
+
+bool CollectDataRegions(ProcessMemory* memory, QWORD startAddress, QWORD endAddress, std::vector<MemoryRegion>& outRegions) {
+    outRegions.clear();
+    const QWORD pageMask = RegionScanLayout::PAGE_SIZE - 1;
+    QWORD low = std::max(startAddress & ~pageMask, RegionScanLayout::FIRST_ADDRESS);
+    QWORD high = endAddress != 0 ? std::min(endAddress, RegionScanLayout::USER_SPACE_END) : RegionScanLayout::USER_SPACE_END;
+
+    // 按区域跳跃，每次 Query 跳过整个区域
+    QWORD address = low;
+    MemoryRegion region;
+    while (address < high && memory->Query(address, region)) {
+        QWORD regionEnd = region.baseAddress + region.regionSize;
+        if (region.state == MemState::Commit && IsWritable(region.protect) &&
+            (region.type == MemType::Private || region.type == MemType::Image)) {
+            QWORD base = std::max(region.baseAddress, low);
+            QWORD end = std::min(regionEnd, high) & ~pageMask;
+            if ((base & pageMask) == 0 && end > base) {
+                MemoryRegion clipped = region;
+                clipped.baseAddress = base;
+                clipped.regionSize = end - base;
+                outRegions.push_back(clipped);
+            }
+        }
+        address = std::max(regionEnd, address + RegionScanLayout::PAGE_SIZE);
+    }
+    return !outRegions.empty();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "process_memory.h"
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// 整个地址空间扫描 (指针路径扫描、数值扫描) 共用的区域枚举和工作线程
+//
+// 游戏数据只会在已提交、可读写的 Private / Image 区域中 (代码和只读数据不会被游戏修改)，
+// 扫描器都只看这些区域。区域按地址排序，按页对齐，[startAddress, endAddress) 之外的部分裁掉。
+namespace RegionScanLayout {
+    constexpr uint32_t PAGE_SIZE = 0x1000;
+    constexpr QWORD FIRST_ADDRESS = 0x10000;
+    constexpr QWORD USER_SPACE_END = 0x7FFFFFFF0000ull;
+}
+
+// 可写数据区域；endAddress 为 0 表示到用户空间末尾。没有这样的区域时返回 false
+bool CollectDataRegions(ProcessMemory* memory, QWORD startAddress, QWORD endAddress, std::vector<MemoryRegion>& outRegions);
+
+// 0 表示按 CPU 核数
+inline uint32_t ResolveScanThreads(uint32_t requested) {
+    if (requested != 0) {
+        return requested;
+    }
+    uint32_t cores = std::thread::hardware_concurrency();
+    return cores != 0 ? cores : 1;
+}
+
+// 在 count 个线程上运行 work(i)，count 为 1 时直接在调用线程运行
+template <typename Work>
+void RunScanWorkers(uint32_t count, Work&& work) {
+    if (count <= 1) {
+        work(0u);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        workers.emplace_back([&work, i] { work(i); });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
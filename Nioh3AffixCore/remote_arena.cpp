@@ -0,0 +1,281 @@
+#include "remote_arena.h"
+
+namespace {
+    // Windows 分配粒度
+    constexpr QWORD ALLOCATION_GRANULARITY = 0x10000;
+
+    // 留出余量，保证块内任意位置到 [nearStart, nearEnd) 都在 rel32 范围内
+    constexpr QWORD NEAR_RANGE = 0x70000000;
+
+    QWORD AlignUp(QWORD value, QWORD alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// RangeAllocator
+// ---------------------------------------------------------------------------
+
+void RemoteArena::RangeAllocator::Reset(QWORD base, size_t size) {
+    m_free.clear();
+    m_allocated.clear();
+    m_used = 0;
+    if (size != 0) {
+        m_free[base] = size;
+    }
+}
+
+QWORD RemoteArena::RangeAllocator::Allocate(size_t size, size_t alignment) {
+    if (size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        return 0;
+    }
+
+    for (auto it = m_free.begin(); it != m_free.end(); ++it) {
+        QWORD start = it->first;
+        QWORD end = start + it->second;
+        QWORD aligned = AlignUp(start, alignment);
+        if (aligned + size > end) {
+            continue;
+        }
+
+        // 拆分空闲块: [start, aligned) 和 [aligned + size, end) 留在空闲链表中
+        m_free.erase(it);
+        if (aligned > start) {
+            m_free[start] = (size_t)(aligned - start);
+        }
+        if (aligned + size < end) {
+            m_free[aligned + size] = (size_t)(end - aligned - size);
+        }
+
+        m_allocated[aligned] = size;
+        m_used += size;
+        return aligned;
+    }
+    return 0;
+}
+
+bool RemoteArena::RangeAllocator::Claim(QWORD address, size_t size) {
+    if (size == 0) {
+        return false;
+    }
+
+    // 包含 address 的空闲块
+    auto it = m_free.upper_bound(address);
+    if (it == m_free.begin()) {
+        return false;
+    }
+    --it;
+
+    QWORD start = it->first;
+    QWORD end = start + it->second;
+    if (address + size > end) {
+        return false;
+    }
+
+    m_free.erase(it);
+    if (address > start) {
+        m_free[start] = (size_t)(address - start);
+    }
+    if (address + size < end) {
+        m_free[address + size] = (size_t)(end - address - size);
+    }
+
+    m_allocated[address] = size;
+    m_used += size;
+    return true;
+}
+
+bool RemoteArena::RangeAllocator::Free(QWORD address) {
+    auto allocated = m_allocated.find(address);
+    if (allocated == m_allocated.end()) {
+        return false;
+    }
+
+    QWORD start = address;
+    size_t size = allocated->second;
+    m_allocated.erase(allocated);
+    m_used -= size;
+
+    // 与后一个空闲块合并
+    auto next = m_free.find(start + size);
+    if (next != m_free.end()) {
+        size += next->second;
+        m_free.erase(next);
+    }
+
+    // 与前一个空闲块合并
+    auto prev = m_free.lower_bound(start);
+    if (prev != m_free.begin()) {
+        --prev;
+        if (prev->first + prev->second == start) {
+            prev->second += size;
+            return true;
+        }
+    }
+
+    m_free[start] = size;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// RemoteArena
+// ---------------------------------------------------------------------------
+
+RemoteArena::RemoteArena()
+    : m_memory(nullptr)
+    , m_base(0)
+{
+}
+
+RemoteArena::~RemoteArena() {
+    Release();
+}
+
+QWORD RemoteArena::FindNearFreeBlock(QWORD low, QWORD high, size_t size, const std::function<QWORD(QWORD)>& reserve) {
+    // 按区域跳跃: 每次 Query 跳过整个区域，而不是按 64KB 步进
+    QWORD addr = AlignUp(low, ALLOCATION_GRANULARITY);
+    MemoryRegion region;
+    while (addr + size <= high) {
+        if (!m_memory->Query(addr, region) || region.regionSize == 0) {
+            addr += ALLOCATION_GRANULARITY;
+            continue;
+        }
+
+        QWORD regionEnd = region.baseAddress + region.regionSize;
+        if (region.state == MemState::Free) {
+            QWORD candidate = AlignUp(addr, ALLOCATION_GRANULARITY);
+            if (candidate + size <= regionEnd && candidate + size <= high) {
+                QWORD reserved = reserve(candidate);
+                if (reserved != 0) {
+                    return reserved;
+                }
+            }
+        }
+
+        addr = AlignUp(regionEnd > addr ? regionEnd : addr + 1, ALLOCATION_GRANULARITY);
+    }
+    return 0;
+}
+
+QWORD RemoteArena::FindNear(QWORD nearStart, QWORD nearEnd, size_t size, const std::function<QWORD(QWORD)>& reserve) {
+    QWORD low = nearEnd > NEAR_RANGE ? nearEnd - NEAR_RANGE : ALLOCATION_GRANULARITY;
+    QWORD high = nearStart + NEAR_RANGE;
+    if (low < ALLOCATION_GRANULARITY) {
+        low = ALLOCATION_GRANULARITY;
+    }
+
+    // 先在之后找 (通常是空闲的大片地址)，再在之前找
+    QWORD base = FindNearFreeBlock(nearEnd, high, size, reserve);
+    if (base == 0) {
+        base = FindNearFreeBlock(low, nearStart, size, reserve);
+    }
+    return base;
+}
+
+bool RemoteArena::Initialize(ProcessMemory* memory, QWORD nearStart, QWORD nearEnd) {
+    Release();
+
+    if (memory == nullptr || nearEnd < nearStart) {
+        return false;
+    }
+
+    m_memory = memory;
+
+    QWORD base = FindNear(nearStart, nearEnd, TOTAL_SIZE, [memory](QWORD candidate) {
+        return memory->Allocate(candidate, TOTAL_SIZE, MemProtect::ExecuteReadWrite);
+    });
+    if (base == 0) {
+        m_memory = nullptr;
+        return false;
+    }
+
+    // 数据区去掉执行权限
+    uint32_t oldProtect;
+    m_memory->Protect(base + CODE_SIZE, DATA_SIZE, MemProtect::ReadWrite, &oldProtect);
+
+    m_base = base;
+    m_code.Reset(base, CODE_SIZE);
+    m_data.Reset(base + CODE_SIZE + HEADER_SIZE, DATA_SIZE - HEADER_SIZE);
+    return true;
+}
+
+bool RemoteArena::Adopt(ProcessMemory* memory, QWORD base) {
+    Release();
+
+    if (memory == nullptr || base == 0 || base % ALLOCATION_GRANULARITY != 0) {
+        return false;
+    }
+
+    // 代码区和数据区 (保护属性不同，是两个区域) 必须都仍是已提交的内存
+    MemoryRegion code;
+    MemoryRegion data;
+    if (!memory->Query(base, code) || code.state != MemState::Commit || code.baseAddress != base ||
+        !memory->Query(base + CODE_SIZE, data) || data.state != MemState::Commit ||
+        data.baseAddress + data.regionSize < base + TOTAL_SIZE) {
+        return false;
+    }
+
+    m_memory = memory;
+    m_base = base;
+    m_code.Reset(base, CODE_SIZE);
+    m_data.Reset(base + CODE_SIZE + HEADER_SIZE, DATA_SIZE - HEADER_SIZE);
+    return true;
+}
+
+void RemoteArena::Release() {
+    if (m_base != 0 && m_memory != nullptr) {
+        m_memory->Free(m_base);
+    }
+
+    m_base = 0;
+    m_memory = nullptr;
+    m_code.Reset(0, 0);
+    m_data.Reset(0, 0);
+}
+
+void RemoteArena::Abandon() {
+    m_base = 0;
+    Release();
+}
+
+QWORD RemoteArena::AllocateCode(size_t size, size_t alignment) {
+    if (m_base == 0) {
+        return 0;
+    }
+    return m_code.Allocate(size, alignment);
+}
+
+QWORD RemoteArena::AllocateData(size_t size, size_t alignment) {
+    if (m_base == 0) {
+        return 0;
+    }
+    return m_data.Allocate(size, alignment);
+}
+
+bool RemoteArena::MapSharedNear(size_t size, SharedView& outView) {
+    if (m_base == 0 || size == 0 || !m_memory->CanMapShared()) {
+        return false;
+    }
+
+    // 目标进程中的视图地址必须按分配粒度对齐
+    size_t mappedSize = (size_t)AlignUp(size, ALLOCATION_GRANULARITY);
+    ProcessMemory* memory = m_memory;
+    QWORD remote = FindNear(m_base, m_base + CODE_SIZE, mappedSize, [memory, mappedSize, &outView](QWORD candidate) {
+        return memory->MapShared(candidate, mappedSize, outView) ? outView.remoteAddress : 0;
+    });
+    return remote != 0;
+}
+
+bool RemoteArena::Free(QWORD address) {
+    if (!Contains(address)) {
+        return false;
+    }
+    return address < m_base + CODE_SIZE ? m_code.Free(address) : m_data.Free(address);
+}
+
+bool RemoteArena::Claim(QWORD address, size_t size) {
+    if (!Contains(address) || size == 0) {
+        return false;
+    }
+    return address < m_base + CODE_SIZE ? m_code.Claim(address, size) : m_data.Claim(address, size);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "process_memory.h"
+#include <functional>
+#include <map>
+
+// 目标进程中的代码洞分配器
+// 会话附加后只做一次近址搜索，在主模块 ±2GB 范围内保留一整块内存，再切分给各个注入器:
+//   [代码区 CODE_SIZE, RWX][数据区 DATA_SIZE, RW]
+// 代码与数据分开存放，数据区不可执行；槽位释放后合并回空闲链表，Release 一次释放整块。
+// 数据区开头 HEADER_SIZE 字节不参与分配，留给常驻头部 (见 resident_cave.h)。
+// 不做内部加锁，由会话锁串行化调用。
+class RemoteArena {
+public:
+    static constexpr size_t CODE_SIZE = 0x4000;
+    static constexpr size_t DATA_SIZE = 0xC000;
+    static constexpr size_t TOTAL_SIZE = CODE_SIZE + DATA_SIZE;
+    static constexpr size_t HEADER_SIZE = 0x200;
+
+    RemoteArena();
+    ~RemoteArena();
+
+    RemoteArena(const RemoteArena&) = delete;
+    RemoteArena& operator=(const RemoteArena&) = delete;
+
+    // 在 [nearStart, nearEnd) 任意位置都可用 rel32 到达的范围内保留整块内存
+    // 找不到近址空闲区时返回 false (不退回到远址分配，远址无法用 rel32 跳转)
+    bool Initialize(ProcessMemory* memory, QWORD nearStart, QWORD nearEnd);
+
+    // 接管上一次会话留在目标进程中的整块内存 (见 resident_cave.h)
+    // 所有槽位都是空闲的，仍在使用的槽位由调用者用 Claim 逐个认领
+    bool Adopt(ProcessMemory* memory, QWORD base);
+
+    // 释放所有槽位和整块内存
+    void Release();
+
+    // 不释放目标进程中的内存，只丢弃本地状态 (仍有注入点跳向代码洞时使用)
+    void Abandon();
+
+    bool IsInitialized() const { return m_base != 0; }
+    QWORD GetBase() const { return m_base; }
+    bool Contains(QWORD address) const { return m_base != 0 && address >= m_base && address < m_base + TOTAL_SIZE; }
+    QWORD GetHeaderAddress() const { return m_base != 0 ? m_base + CODE_SIZE : 0; }
+
+    // 分配可执行槽位 / 数据槽位，alignment 必须是 2 的幂；失败返回 0
+    QWORD AllocateCode(size_t size, size_t alignment = 16);
+    QWORD AllocateData(size_t size, size_t alignment = 8);
+
+    // 归还槽位 (代码或数据)
+    bool Free(QWORD address);
+
+    // 把 [address, address + size) 标记为已分配 (接管时恢复仍在使用的槽位)；区间不完全空闲时返回 false
+    bool Claim(QWORD address, size_t size);
+
+    // 在代码区任意位置都可用 rel32 到达的范围内映射一块共享内存 (见 ProcessMemory::MapShared)
+    // 映射不属于代码洞，由调用者用 ProcessMemory::UnmapShared 解除；后端不支持时返回 false
+    bool MapSharedNear(size_t size, SharedView& outView);
+
+    // 已用字节数 (含对齐填充)
+    size_t GetCodeUsed() const { return m_code.GetUsed(); }
+    size_t GetDataUsed() const { return m_data.GetUsed(); }
+
+private:
+    // 首次适配 + 合并的区间分配器
+    class RangeAllocator {
+    public:
+        void Reset(QWORD base, size_t size);
+        QWORD Allocate(size_t size, size_t alignment);
+        bool Claim(QWORD address, size_t size);
+        bool Free(QWORD address);
+        size_t GetUsed() const { return m_used; }
+
+    private:
+        std::map<QWORD, size_t> m_free;         // 起始地址 -> 长度
+        std::map<QWORD, size_t> m_allocated;    // 起始地址 -> 长度
+        size_t m_used = 0;
+    };
+
+    ProcessMemory* m_memory;
+    QWORD m_base;
+    RangeAllocator m_code;
+    RangeAllocator m_data;
+
+    // 在 [low, high) 的空闲区域中逐个尝试 reserve(候选地址)，返回第一个成功的结果
+    QWORD FindNearFreeBlock(QWORD low, QWORD high, size_t size, const std::function<QWORD(QWORD)>& reserve);
+
+    // 以 [nearStart, nearEnd) 为中心，先后再前地搜索
+    QWORD FindNear(QWORD nearStart, QWORD nearEnd, size_t size, const std::function<QWORD(QWORD)>& reserve);
+};
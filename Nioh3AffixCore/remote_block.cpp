@@ -0,0 +1,118 @@
+#include "remote_block.h"
+#include "shared_memory.h"
+#include <atomic>
+#include <vector>
+
+RemoteBlock::RemoteBlock()
+    : m_memory(nullptr)
+    , m_arena(nullptr)
+    , m_address(0)
+    , m_size(0)
+    , m_local(nullptr)
+{
+}
+
+RemoteBlock::~RemoteBlock() {
+    Release();
+}
+
+bool RemoteBlock::Initialize(ProcessMemory* memory, RemoteArena* arena, size_t size, bool allowShared) {
+    Release();
+
+    if (arena == nullptr || !arena->IsInitialized() || size == 0 || size % sizeof(uint64_t) != 0) {
+        return false;
+    }
+
+    QWORD address = 0;
+    if (allowShared && arena->MapSharedNear(size, m_view)) {
+        // 新建的共享内存已经是全零
+        address = m_view.remoteAddress;
+        m_local = (uint8_t*)m_view.section->GetData();
+    } else {
+        address = arena->AllocateData(size, 64);
+        if (address == 0) {
+            return false;
+        }
+
+        std::vector<uint8_t> zero(size, 0);
+        if (!memory->Write(address, zero.data(), zero.size())) {
+            arena->Free(address);
+            return false;
+        }
+    }
+
+    m_memory = memory;
+    m_arena = arena;
+    m_address = address;
+    m_size = size;
+    return true;
+}
+
+bool RemoteBlock::Adopt(ProcessMemory* memory, RemoteArena* arena, QWORD address, size_t size) {
+    Release();
+
+    if (arena == nullptr || size == 0 || size % sizeof(uint64_t) != 0 || !arena->Claim(address, size)) {
+        return false;
+    }
+
+    m_memory = memory;
+    m_arena = arena;
+    m_address = address;
+    m_size = size;
+    return true;
+}
+
+void RemoteBlock::Release() {
+    if (m_view.IsMapped()) {
+        m_memory->UnmapShared(m_view);
+    } else if (m_arena != nullptr && m_address != 0) {
+        m_arena->Free(m_address);
+    }
+    Abandon();
+}
+
+void RemoteBlock::Abandon() {
+    // 注入点可能仍在访问视图，目标进程一侧不解除，只关闭本进程一侧
+    delete m_view.section;
+    m_view = SharedView();
+    m_local = nullptr;
+    m_memory = nullptr;
+    m_arena = nullptr;
+    m_address = 0;
+    m_size = 0;
+}
+
+bool RemoteBlock::Read(size_t offset, void* buffer, size_t size) {
+    if (m_address == 0 || offset + size > m_size) {
+        return false;
+    }
+    if (m_local == nullptr) {
+        return m_memory->Read(m_address + offset, buffer, size);
+    }
+
+    // x86 上普通读取之间不会重排，按地址递增读取即与远程读取的顺序语义一致
+    const volatile uint64_t* source = (const volatile uint64_t*)(m_local + offset);
+    uint64_t* destination = (uint64_t*)buffer;
+    for (size_t i = 0; i < size / sizeof(uint64_t); i++) {
+        destination[i] = source[i];
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+}
+
+bool RemoteBlock::Write(size_t offset, const void* buffer, size_t size) {
+    if (m_address == 0 || offset + size > m_size) {
+        return false;
+    }
+    if (m_local == nullptr) {
+        return m_memory->Write(m_address + offset, buffer, size);
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+    volatile uint64_t* destination = (volatile uint64_t*)(m_local + offset);
+    const uint64_t* source = (const uint64_t*)buffer;
+    for (size_t i = 0; i < size / sizeof(uint64_t); i++) {
+        destination[i] = source[i];
+    }
+    return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "process_memory.h"
+#include "remote_arena.h"
+#include <cstddef>
+#include <cstdint>
+
+// 与 hook 代码交换数据的一块目标进程内存
+// 后端支持共享视图 (ProcessMemory::MapShared) 时放在同时映射进目标进程和本进程的共享内存中，
+// 读写都是本进程内的普通内存访问；否则放在代码洞数据区，通过 ProcessMemory::Read/Write 访问。
+// 两种方式的读写都按地址递增、以 8 字节为单位进行，布局设计可以依赖这个顺序
+// (例如把提交标记放在数据之后，一次写入即可发布)。
+class RemoteBlock {
+public:
+    RemoteBlock();
+    ~RemoteBlock();
+
+    RemoteBlock(const RemoteBlock&) = delete;
+    RemoteBlock& operator=(const RemoteBlock&) = delete;
+
+    // 分配 size 字节 (8 的倍数) 并清零；allowShared 为 true 时优先放在共享视图中
+    bool Initialize(ProcessMemory* memory, RemoteArena* arena, size_t size, bool allowShared);
+
+    // 接管代码洞数据区中已有的一块 (内容保持不变，通过 ProcessMemory 访问)
+    bool Adopt(ProcessMemory* memory, RemoteArena* arena, QWORD address, size_t size);
+
+    // 解除共享视图或把槽位还给代码洞分配器
+    void Release();
+
+    // 不访问目标进程，直接丢弃状态 (目标进程中的共享视图保留，hook 仍可能访问)
+    void Abandon();
+
+    bool IsInitialized() const { return m_address != 0; }
+    bool IsShared() const { return m_local != nullptr; }
+    QWORD GetAddress() const { return m_address; }
+    size_t GetSize() const { return m_size; }
+
+    // 读写 [offset, offset + size)，offset 和 size 必须是 8 的倍数
+    bool Read(size_t offset, void* buffer, size_t size);
+    bool Write(size_t offset, const void* buffer, size_t size);
+
+private:
+    ProcessMemory* m_memory;
+    RemoteArena* m_arena;
+    QWORD m_address;
+    size_t m_size;
+    SharedView m_view;
+    uint8_t* m_local;       // 共享视图在本进程中的地址，远程访问时为空
+};
@@ -0,0 +1,138 @@
+#include "resident_cave.h"
+#include "x64_emitter.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+    struct ResidentCacheFile {
+        uint32_t magic;
+        uint32_t version;
+        ResidentCacheEntry entry;
+    };
+
+    uint64_t HeaderChecksum(const ResidentCaveHeader& header) {
+        return HashResidentBytes(&header, offsetof(ResidentCaveHeader, checksum));
+    }
+
+    bool IsInRange(QWORD address, size_t size, QWORD start, QWORD end) {
+        return address >= start && address + size >= address && address + size <= end;
+    }
+}
+
+uint64_t HashResidentBytes(const void* data, size_t size) {
+    // FNV-1a
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+bool WriteResidentHeader(ProcessMemory* memory, QWORD address, ResidentCaveHeader& header) {
+    header.magic = ResidentCaveLayout::MAGIC;
+    header.version = ResidentCaveLayout::VERSION;
+    header.headerSize = sizeof(ResidentCaveHeader);
+    header.checksum = HeaderChecksum(header);
+    return memory->Write(address, &header, sizeof(header));
+}
+
+bool ReadResidentHeader(ProcessMemory* memory, QWORD address, ResidentCaveHeader& outHeader) {
+    if (!memory->Read(address, &outHeader, sizeof(outHeader))) {
+        return false;
+    }
+    if (outHeader.magic != ResidentCaveLayout::MAGIC || outHeader.version != ResidentCaveLayout::VERSION ||
+        outHeader.headerSize != sizeof(ResidentCaveHeader) || outHeader.checksum != HeaderChecksum(outHeader)) {
+        return false;
+    }
+
+    // 头部固定在数据区开头，hook 代码在代码区，数据块在数据区
+    QWORD base = outHeader.arenaBase;
+    QWORD dataStart = base + RemoteArena::CODE_SIZE + RemoteArena::HEADER_SIZE;
+    QWORD end = base + RemoteArena::TOTAL_SIZE;
+    if (address != base + RemoteArena::CODE_SIZE || outHeader.ringAddress == 0 ||
+        !IsInRange(outHeader.ringAddress, 8, dataStart, end) ||
+        (outHeader.mailboxAddress != 0 && !IsInRange(outHeader.mailboxAddress, 8, dataStart, end)) ||
+        (outHeader.statsAddress != 0 && !IsInRange(outHeader.statsAddress, 8, dataStart, end))) {
+        return false;
+    }
+
+    if (outHeader.hookCount == 0 || outHeader.hookCount > ResidentCaveLayout::MAX_HOOKS) {
+        return false;
+    }
+    for (uint32_t i = 0; i < outHeader.hookCount; i++) {
+        const ResidentHookRecord& hook = outHeader.hooks[i];
+        if (hook.patchSize < X64Emitter::JMP_REL32_SIZE || hook.patchSize > ResidentCaveLayout::MAX_PATCH_SIZE ||
+            hook.codeSize == 0 || !IsInRange(hook.codeAddress, hook.codeSize, base, base + RemoteArena::CODE_SIZE)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ClearResidentHeader(ProcessMemory* memory, QWORD address) {
+    uint32_t magic = 0;
+    return memory->Write(address + offsetof(ResidentCaveHeader, magic), &magic, sizeof(magic));
+}
+
+ResidentHookState CheckResidentHook(ProcessMemory* memory, const ResidentHookRecord& record) {
+    // 记录中的跳转字节必须确实跳向记录中的 hook 代码，否则不能当作自己的补丁恢复
+    uint8_t expectedJump[ResidentCaveLayout::MAX_PATCH_SIZE];
+    X64Emitter jump(expectedJump, sizeof(expectedJump), record.injectionPoint);
+    jump.JmpRel32(record.codeAddress);
+    jump.Nop(record.patchSize - X64Emitter::JMP_REL32_SIZE);
+    if (!jump.Ok() || memcmp(expectedJump, record.jumpBytes, record.patchSize) != 0) {
+        return ResidentHookState::Foreign;
+    }
+
+    uint8_t current[ResidentCaveLayout::MAX_PATCH_SIZE];
+    if (!memory->Read(record.injectionPoint, current, record.patchSize)) {
+        return ResidentHookState::Foreign;
+    }
+    if (memcmp(current, record.originalBytes, record.patchSize) == 0) {
+        return ResidentHookState::Original;
+    }
+    if (memcmp(current, record.jumpBytes, record.patchSize) != 0) {
+        return ResidentHookState::Foreign;
+    }
+
+    std::vector<uint8_t> code(record.codeSize);
+    if (!memory->Read(record.codeAddress, code.data(), code.size()) ||
+        HashResidentBytes(code.data(), code.size()) != record.codeHash) {
+        return ResidentHookState::Damaged;
+    }
+    return ResidentHookState::Intact;
+}
+
+bool SaveResidentCache(const char* path, const ResidentCacheEntry& entry) {
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    ResidentCacheFile contents;
+    contents.magic = ResidentCaveLayout::CACHE_MAGIC;
+    contents.version = ResidentCaveLayout::CACHE_VERSION;
+    contents.entry = entry;
+    bool ok = fwrite(&contents, sizeof(contents), 1, file) == 1;
+    return fclose(file) == 0 && ok;
+}
+
+bool LoadResidentCache(const char* path, ResidentCacheEntry& outEntry) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    ResidentCacheFile contents;
+    bool ok = fread(&contents, sizeof(contents), 1, file) == 1;
+    fclose(file);
+    if (!ok || contents.magic != ResidentCaveLayout::CACHE_MAGIC || contents.version != ResidentCaveLayout::CACHE_VERSION) {
+        return false;
+    }
+
+    outEntry = contents.entry;
+    return true;
+}
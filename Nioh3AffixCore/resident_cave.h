@@ -0,0 +1,92 @@
+#pragma once
+
+#include "process_memory.h"
+#include "remote_arena.h"
+#include <cstddef>
+#include <cstdint>
+
+// 常驻代码洞 (工具重启后免扫描重新附加)
+//
+// 开启常驻模式后，会话分离时不恢复捕获 hook，而是在代码洞数据区开头 (RemoteArena::GetHeaderAddress)
+// 写入 ResidentCaveHeader: 每个 hook 的注入点、原始字节、跳转字节、hook 代码的位置和哈希，以及各数据块的地址；
+// 头部相对主模块的偏移 (RVA) 写入本地缓存文件。
+// 下一次附加时只按缓存的 RVA 读取一次头部。头部完好、每个注入点仍是记录的跳转字节且 hook 代码未被改动时
+// 直接接管这些 hook (不做 AOB 扫描、近址搜索和改写)；任一项不符时恢复仍指向代码洞的注入点，
+// 清除头部，没有无法识别的注入点时释放代码洞。
+namespace ResidentCaveLayout {
+    constexpr uint32_t MAGIC = 0x4352334E;          // "N3RC"
+    constexpr uint32_t VERSION = 4;                 // 2: 捕获环形缓冲区条目增加 owner；3: 编辑信箱改为认领协议；4: 条目增加 seal
+    constexpr uint32_t MAX_HOOKS = 2;
+    constexpr uint32_t MAX_PATCH_SIZE = 16;
+
+    constexpr uint32_t CACHE_MAGIC = 0x4B52334E;    // "N3RK"
+    constexpr uint32_t CACHE_VERSION = 1;
+}
+
+#pragma pack(push, 1)
+
+struct ResidentHookRecord {
+    uint64_t injectionPoint;
+    uint64_t codeAddress;       // hook 代码槽位 (代码区)
+    uint64_t statsAddress;      // 插桩统计槽位，0 表示 hook 代码不带插桩
+    uint64_t codeHash;          // hook 代码的 FNV-1a
+    uint32_t codeSize;
+    uint8_t source;             // CaptureRingLayout::SOURCE_*
+    uint8_t patchSize;          // 注入点被改写的字节数 (原始指令长度)
+    uint8_t reserved[2];
+    uint8_t originalBytes[ResidentCaveLayout::MAX_PATCH_SIZE];
+    uint8_t jumpBytes[ResidentCaveLayout::MAX_PATCH_SIZE];
+};
+
+struct ResidentCaveHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;        // sizeof(ResidentCaveHeader)
+    uint32_t hookCount;
+    uint64_t arenaBase;
+    uint64_t moduleBase;
+    uint64_t moduleSize;
+    uint64_t ringAddress;       // 以下数据块都在代码洞数据区中
+    uint64_t mailboxAddress;    // 0 表示没有
+    uint64_t statsAddress;      // 0 表示没有
+    ResidentHookRecord hooks[ResidentCaveLayout::MAX_HOOKS];
+    uint64_t checksum;          // 之前所有字节的 FNV-1a
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(ResidentHookRecord) == 72, "resident cave layout changed");
+static_assert(sizeof(ResidentCaveHeader) % 8 == 0, "resident cave layout changed");
+static_assert(sizeof(ResidentCaveHeader) <= RemoteArena::HEADER_SIZE, "resident cave header does not fit the arena header area");
+
+// 缓存文件中记录的位置
+struct ResidentCacheEntry {
+    uint64_t moduleSize;        // 主模块大小不同 (游戏更新) 时缓存作废
+    int64_t headerRva;          // 头部地址 - 主模块基址
+};
+
+// 注入点当前的状态
+enum class ResidentHookState {
+    Intact,     // 跳转字节和 hook 代码都与记录一致
+    Damaged,    // 仍是跳转字节，但 hook 代码已被改动
+    Original,   // 已是原始字节
+    Foreign     // 既不是跳转字节也不是原始字节 (被其它程序改写)
+};
+
+uint64_t HashResidentBytes(const void* data, size_t size);
+
+// 填写 magic/version/headerSize/checksum 后一次写入
+bool WriteResidentHeader(ProcessMemory* memory, QWORD address, ResidentCaveHeader& header);
+
+// 读出并校验头部 (magic、版本、校验和、各地址落在代码洞内)
+bool ReadResidentHeader(ProcessMemory* memory, QWORD address, ResidentCaveHeader& outHeader);
+
+// 清除 magic，之后的附加不会再接管
+bool ClearResidentHeader(ProcessMemory* memory, QWORD address);
+
+// 检查一个 hook 记录对应的注入点 (一次读取注入点，跳转字节完好时再读一次 hook 代码)
+// 读取失败按 Foreign 处理
+ResidentHookState CheckResidentHook(ProcessMemory* memory, const ResidentHookRecord& record);
+
+bool SaveResidentCache(const char* path, const ResidentCacheEntry& entry);
+bool LoadResidentCache(const char* path, ResidentCacheEntry& outEntry);
@@ -0,0 +1,2278 @@
+#include "session.h"
+#include "aob_scanner.h"
+#include "memory_layout.h"
+#include "patch_transaction.h"
+#include "tracing_process_memory.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <vector>
+
+Session::Session()
+    : m_lastWeaponBase(0)
+    , m_lastArmorBase(0)
+    , m_lastCaptureType(EQUIP_TYPE_UNKNOWN)
+    , m_allowSharedCapture(true)
+    , m_useEditMailbox(false)
+    , m_editsWithdrawn(false)
+    , m_captureOwners(false)
+    , m_residentState(RESIDENT_NONE)
+    , m_integrityIntervalMs(0)
+    , m_instrumentHooks(false)
+    , m_oneShotCapture(false)
+    , m_rearmCount(0)
+{
+    memset(&m_publishedState, 0, sizeof(m_publishedState));
+    memset(&m_inventoryLayout, 0, sizeof(m_inventoryLayout));
+    memset(&m_integrityStats, 0, sizeof(m_integrityStats));
+}
+
+Session::~Session() {
+    Detach();
+    DisableStatePage();
+}
+
+void Session::SetLastError(const char* msg) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_lastError = msg;
+}
+
+void Session::ResetCaptureCache() {
+    m_lastWeaponBase = 0;
+    m_lastArmorBase = 0;
+    m_lastCaptureType = EQUIP_TYPE_UNKNOWN;
+    m_capturedItems.clear();
+    memset(&m_inventoryLayout, 0, sizeof(m_inventoryLayout));
+    m_scannedBases.clear();
+    m_scannedRecords.clear();
+
+    m_weaponCapture = HookCaptureState();
+    m_armorCapture = HookCaptureState();
+    m_weaponInjector.ResetHookedTime();
+    m_armorInjector.ResetHookedTime();
+    m_rearmCount = 0;
+}
+
+bool Session::CheckAttached() {
+    if (m_memory == nullptr) {
+        SetLastError("Not attached to any process");
+        return false;
+    }
+    return true;
+}
+
+bool Session::EnsureArena() {
+    if (m_arena.IsInitialized()) {
+        return true;
+    }
+
+    QWORD moduleBase = 0;
+    QWORD moduleSize = 0;
+    if (!GetMainModuleInfo(m_memory.get(), moduleBase, moduleSize)) {
+        SetLastError("Failed to get main module info");
+        return false;
+    }
+
+    if (!m_arena.Initialize(m_memory.get(), moduleBase, moduleBase + moduleSize)) {
+        SetLastError("Failed to allocate code cave near the main module");
+        return false;
+    }
+    return true;
+}
+
+// 读取捕获环形缓冲区头部，代数变化时消费新记录；返回是否有变化
+// 代数未变时只有一次 16 字节的读取
+bool Session::PollCaptures() {
+    MaybeCheckIntegrity();
+
+    if (!m_captureRing.IsInitialized() || (!IsWeaponCaptureActive() && !IsArmorCaptureActive())) {
+        return false;
+    }
+
+    bool generationChanged = false;
+    m_captureEvents.clear();
+    if (!m_captureRing.Drain(m_captureEvents, &generationChanged)) {
+        return false;
+    }
+
+    bool changed = generationChanged || !m_captureEvents.empty();
+    for (const CaptureEvent& event : m_captureEvents) {
+        EquipmentType type;
+        HookCaptureState* state;
+        if (event.source == CaptureRingLayout::SOURCE_WEAPON) {
+            m_lastWeaponBase = event.base;
+            type = EQUIP_TYPE_WEAPON;
+            state = &m_weaponCapture;
+        } else if (event.source == CaptureRingLayout::SOURCE_ARMOR) {
+            m_lastArmorBase = event.base;
+            type = EQUIP_TYPE_ARMOR;
+            state = &m_armorCapture;
+        } else {
+            continue;
+        }
+
+        state->hits++;
+        if (event.base != 0) {
+            state->capturedSinceArm = true;
+            m_lastCaptureType = type;
+            RecordCapturedItem(event, type);
+        }
+    }
+
+    // 新记录全部被覆盖时，头部记录的最后命中的 hook 仍能给出当前类型
+    if (changed && m_captureEvents.empty()) {
+        uint8_t lastSource = m_captureRing.GetLastSource();
+        if (lastSource == CaptureRingLayout::SOURCE_WEAPON && m_lastWeaponBase != 0) {
+            m_lastCaptureType = EQUIP_TYPE_WEAPON;
+            m_weaponCapture.capturedSinceArm = true;
+        } else if (lastSource == CaptureRingLayout::SOURCE_ARMOR && m_lastArmorBase != 0) {
+            m_lastCaptureType = EQUIP_TYPE_ARMOR;
+            m_armorCapture.capturedSinceArm = true;
+        }
+    }
+
+    if (m_oneShotCapture) {
+        ParkCapturedHooks();
+    }
+    return changed;
+}
+
+// 自动检查间隔到期时检查一次补丁完整性
+void Session::MaybeCheckIntegrity() {
+    if (m_integrityIntervalMs == 0 || m_memory == nullptr) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (m_integrityStats.checks != 0 && now - m_lastIntegrityCheck < std::chrono::milliseconds(m_integrityIntervalMs)) {
+        return;
+    }
+    RunIntegrityCheck();
+}
+
+// 一次核对所有已改写的位置，按结果更新注入器状态:
+//   已恢复为原始字节 -> 视为已撤下；被其它程序改写 -> 标记 foreign，之后拒绝撤下；
+//   读不到 (UNKNOWN) -> 不改变状态，下次检查再判断
+void Session::RunIntegrityCheck() {
+    auto start = std::chrono::steady_clock::now();
+
+    IntegrityRange ranges[INTEGRITY_SITE_COUNT];
+    m_weaponInjector.DescribeIntegrity(ranges[INTEGRITY_SITE_WEAPON_PATCH], ranges[INTEGRITY_SITE_WEAPON_CODE]);
+    m_armorInjector.DescribeIntegrity(ranges[INTEGRITY_SITE_ARMOR_PATCH], ranges[INTEGRITY_SITE_ARMOR_CODE]);
+    m_skillBypassInjector.DescribeIntegrity(ranges[INTEGRITY_SITE_SKILL_PATCH1], ranges[INTEGRITY_SITE_SKILL_PATCH2]);
+
+    uint8_t* states = m_integrityStats.states;
+    CheckIntegrityRanges(m_memory.get(), ranges, INTEGRITY_SITE_COUNT, states,
+        m_integrityStats.lastReads, m_integrityStats.lastBytes);
+
+    struct CaptureSites {
+        CodeInjector& injector;
+        int patch;
+        int code;
+    };
+    CaptureSites captureSites[] = {
+        { m_weaponInjector, INTEGRITY_SITE_WEAPON_PATCH, INTEGRITY_SITE_WEAPON_CODE },
+        { m_armorInjector, INTEGRITY_SITE_ARMOR_PATCH, INTEGRITY_SITE_ARMOR_CODE }
+    };
+    for (CaptureSites& sites : captureSites) {
+        if (states[sites.patch] == INTEGRITY_FOREIGN || states[sites.code] == INTEGRITY_FOREIGN) {
+            sites.injector.MarkForeign();
+        } else if (states[sites.patch] == INTEGRITY_REVERTED) {
+            sites.injector.MarkReverted();
+        }
+    }
+    // hook 都不再执行时信箱中的批次不会被应用
+    if (!m_weaponInjector.IsEnabled() && !m_armorInjector.IsEnabled()) {
+        CancelMailbox();
+    }
+
+    if (states[INTEGRITY_SITE_SKILL_PATCH1] == INTEGRITY_FOREIGN || states[INTEGRITY_SITE_SKILL_PATCH2] == INTEGRITY_FOREIGN) {
+        m_skillBypassInjector.MarkForeign();
+    } else {
+        if (states[INTEGRITY_SITE_SKILL_PATCH1] == INTEGRITY_REVERTED) m_skillBypassInjector.MarkReverted(1);
+        if (states[INTEGRITY_SITE_SKILL_PATCH2] == INTEGRITY_REVERTED) m_skillBypassInjector.MarkReverted(2);
+    }
+
+    m_lastIntegrityCheck = std::chrono::steady_clock::now();
+    m_integrityStats.checks++;
+    m_integrityStats.lastCheckMicroseconds =
+        (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(m_lastIntegrityCheck - start).count();
+}
+
+// 单次捕获: 已捕获到基址的 hook 立即恢复原始代码，之后游戏的热路径不再经过代码洞
+void Session::ParkCapturedHooks() {
+    bool parked = false;
+    if (m_weaponInjector.IsEnabled() && m_weaponCapture.capturedSinceArm && m_weaponInjector.Disable()) {
+        m_weaponCapture.parked = true;
+        parked = true;
+    }
+    if (m_armorInjector.IsEnabled() && m_armorCapture.capturedSinceArm && m_armorInjector.Disable()) {
+        m_armorCapture.parked = true;
+        parked = true;
+    }
+
+    // hook 不再执行，信箱中的批次不会被应用
+    if (parked && !m_weaponInjector.IsEnabled() && !m_armorInjector.IsEnabled()) {
+        CancelMailbox();
+    }
+}
+
+// 按当前设置为两个注入器选择插桩或普通 hook 代码，以及是否记录容器指针 (下一次写入 hook 代码时生效)
+// 统计槽位在第一次需要时分配，分配失败时退回到普通 hook 代码
+void Session::ApplyHookInstrumentation() {
+    if (m_instrumentHooks && !m_hookStats.IsInitialized() && m_arena.IsInitialized()) {
+        m_hookStats.Initialize(m_memory.get(), &m_arena, AllowSharedBlocks());
+    }
+
+    bool instrument = m_instrumentHooks && m_hookStats.IsInitialized();
+    m_weaponInjector.SetStatsAddress(instrument ? m_hookStats.GetSlotAddress(CaptureRingLayout::SOURCE_WEAPON) : 0);
+    m_armorInjector.SetStatsAddress(instrument ? m_hookStats.GetSlotAddress(CaptureRingLayout::SOURCE_ARMOR) : 0);
+    m_weaponInjector.SetOwnerCapture(m_captureOwners);
+    m_armorInjector.SetOwnerCapture(m_captureOwners);
+}
+
+bool Session::RearmParkedHooks() {
+    if (!m_weaponCapture.parked && !m_armorCapture.parked) {
+        return true;
+    }
+
+    // 先消费撤下之前留下的记录，避免重新挂上后被当作新的捕获
+    PollCaptures();
+    ApplyHookInstrumentation();
+
+    PatchTransaction transaction(m_memory.get());
+    bool weapon = m_weaponCapture.parked && m_weaponInjector.PrepareEnable(transaction);
+    bool armor = m_armorCapture.parked && m_armorInjector.PrepareEnable(transaction);
+    if ((!weapon && !armor) || !transaction.Commit()) {
+        SetLastError("Failed to rearm capture hooks");
+        return false;
+    }
+
+    if (weapon) {
+        m_weaponInjector.SetEnabled(true);
+        m_weaponCapture.parked = false;
+        m_weaponCapture.capturedSinceArm = false;
+    }
+    if (armor) {
+        m_armorInjector.SetEnabled(true);
+        m_armorCapture.parked = false;
+        m_armorCapture.capturedSinceArm = false;
+    }
+    m_rearmCount++;
+    return true;
+}
+
+void Session::RecordCapturedItem(const CaptureEvent& event, EquipmentType type) {
+    auto it = m_capturedItems.find(event.base);
+    if (it == m_capturedItems.end()) {
+        if (m_capturedItems.size() >= MAX_CAPTURED_ITEMS) {
+            auto oldest = std::min_element(m_capturedItems.begin(), m_capturedItems.end(),
+                [](const auto& a, const auto& b) { return a.second.lastSequence < b.second.lastSequence; });
+            m_capturedItems.erase(oldest);
+        }
+
+        CapturedItem item;
+        item.base = event.base;
+        item.lastSequence = event.sequence;
+        item.hitCount = 0;
+        item.equipmentType = (int32_t)type;
+        item.owner = 0;
+        it = m_capturedItems.emplace(event.base, item).first;
+    }
+
+    if (event.owner != 0) {
+        it->second.owner = event.owner;
+    }
+
+    it->second.lastSequence = event.sequence;
+    it->second.hitCount++;
+    it->second.equipmentType = (int32_t)type;
+}
+
+// 最后一条捕获记录的来源决定类型；对应的 hook 未启用时退回到另一种
+EquipmentType Session::ResolveType() const {
+    QWORD weaponBase = IsWeaponCaptureActive() ? m_lastWeaponBase : 0;
+    QWORD armorBase = IsArmorCaptureActive() ? m_lastArmorBase : 0;
+
+    if (m_lastCaptureType == EQUIP_TYPE_ARMOR && armorBase != 0) {
+        return EQUIP_TYPE_ARMOR;
+    } else if (weaponBase != 0) {
+        return EQUIP_TYPE_WEAPON;
+    } else if (armorBase != 0) {
+        return EQUIP_TYPE_ARMOR;
+    }
+    return EQUIP_TYPE_UNKNOWN;
+}
+
+// 消费新的捕获记录并返回当前活动的基址
+QWORD Session::GetActiveEquipmentBase() {
+    PollCaptures();
+
+    switch (ResolveType()) {
+    case EQUIP_TYPE_ARMOR:
+        return m_lastArmorBase;
+    case EQUIP_TYPE_WEAPON:
+        return m_lastWeaponBase;
+    default:
+        return 0;
+    }
+}
+
+// 获取当前装备类型
+EquipmentType Session::GetCurrentType() {
+    PollCaptures();
+    return ResolveType();
+}
+
+// 当前基址对应的记录快照，基址变化时清空
+StateRecord& Session::SnapshotFor(QWORD base) {
+    StateRecord& record = m_statePage.Staging().record;
+    if (record.base != base) {
+        memset(&record, 0, sizeof(record));
+        record.base = base;
+    }
+    return record;
+}
+
+// 把会话状态写入状态页暂存区，内容有变化时发布 (不产生远程访问)
+void Session::PublishState() {
+    if (!m_statePage.IsOpen()) {
+        return;
+    }
+
+    StatePageBody& body = m_statePage.Staging();
+
+    QWORD weaponBase = IsWeaponCaptureActive() ? m_lastWeaponBase : 0;
+    QWORD armorBase = IsArmorCaptureActive() ? m_lastArmorBase : 0;
+    EquipmentType type = ResolveType();
+
+    body.flags = 0;
+    if (m_memory != nullptr) body.flags |= StatePageLayout::FLAG_ATTACHED;
+    if (m_weaponInjector.IsEnabled()) body.flags |= StatePageLayout::FLAG_WEAPON_HOOK;
+    if (m_armorInjector.IsEnabled()) body.flags |= StatePageLayout::FLAG_ARMOR_HOOK;
+    if (m_skillBypassInjector.IsEnabled()) body.flags |= StatePageLayout::FLAG_SKILL_BYPASS;
+    if (m_editsWithdrawn) body.flags |= StatePageLayout::FLAG_EDITS_WITHDRAWN;
+    body.equipmentType = (int32_t)type;
+    body.weaponBase = weaponBase;
+    body.armorBase = armorBase;
+    body.equipmentBase = type == EQUIP_TYPE_ARMOR ? armorBase : (type == EQUIP_TYPE_WEAPON ? weaponBase : 0);
+
+    if (m_memory != nullptr) {
+        RemoteOpStats stats = m_memory->GetStats();
+        body.counters.remoteReads = stats.reads;
+        body.counters.remoteWrites = stats.writes;
+        body.counters.remoteQueries = stats.queries;
+        body.counters.remoteProtects = stats.protects;
+        body.counters.remoteAllocations = stats.allocations;
+        body.counters.bytesRead = stats.bytesRead;
+        body.counters.bytesWritten = stats.bytesWritten;
+        body.counters.remoteFailures = stats.failures;
+    }
+
+    // publishCount 由 Publish 递增，比较时排除
+    body.counters.publishCount = m_publishedState.counters.publishCount;
+    if (memcmp(&body, &m_publishedState, sizeof(body)) == 0) {
+        return;
+    }
+
+    m_statePage.Publish();
+    m_publishedState = body;
+}
+
+bool Session::CheckMailboxIdle() {
+    SettleMailbox();
+    if (m_editMailbox.IsPending()) {
+        SetLastError("Previous edits have not been applied by the game yet");
+        return false;
+    }
+    return true;
+}
+
+void Session::SettleMailbox() {
+    if (m_mailboxJournal.empty()) {
+        return;
+    }
+
+    MailboxBatchState state = m_editMailbox.Poll();
+    if (state == MAILBOX_BATCH_PENDING) {
+        return;
+    }
+    if (state == MAILBOX_BATCH_APPLIED) {
+        for (const JournalAction& action : m_mailboxJournal) {
+            ApplyJournalAction(action);
+        }
+    } else {
+        // 没有任何写入落地，日志和快照保持投递前的状态
+        m_editsWithdrawn = true;
+        SetLastError("Pending edits were withdrawn before the game applied them");
+    }
+    m_mailboxJournal.clear();
+}
+
+void Session::CancelMailbox() {
+    m_editMailbox.Cancel();
+    SettleMailbox();
+}
+
+bool Session::UsesEditMailbox(QWORD base) {
+    if (!m_useEditMailbox || !m_editMailbox.IsInitialized() || base == 0) {
+        return false;
+    }
+    // 接管的 hook 可能是在没有信箱时生成的，只有检查本信箱的 hook 才能应用
+    QWORD mailbox = m_editMailbox.GetAddress();
+    return (m_weaponInjector.IsEnabled() && m_weaponInjector.GetMailboxAddress() == mailbox && base == m_lastWeaponBase) ||
+           (m_armorInjector.IsEnabled() && m_armorInjector.GetMailboxAddress() == mailbox && base == m_lastArmorBase);
+}
+
+bool Session::CommitEquipmentBytes(QWORD base, uint32_t offset, const uint8_t* bytes, const uint8_t* bitMasks, size_t size,
+    bool& outPosted) {
+    outPosted = false;
+    if (UsesEditMailbox(base)) {
+        std::vector<MailboxEdit> edits;
+        if (EditMailbox::BuildEdits(base, offset, bytes, bitMasks, size, edits)) {
+            if (edits.empty()) {
+                return true;
+            }
+            if (!m_editMailbox.Post(base, edits)) {
+                SetLastError("Failed to post edits to the edit mailbox");
+                return false;
+            }
+            outPosted = true;
+            m_editsWithdrawn = false;
+            return true;
+        }
+        // 超过一批的容量，退回到直接写入
+    }
+
+    // 直接写入也只写掩码覆盖的字节段: 段之间的字节是之前读到的前像，游戏可能已经改过
+    size_t i = 0;
+    while (i < size) {
+        if (bitMasks[i] == 0) {
+            i++;
+            continue;
+        }
+        size_t end = i + 1;
+        while (end < size && bitMasks[end] != 0) {
+            end++;
+        }
+        if (!m_memory->Write(base + offset + i, bytes + i, end - i)) {
+            SetLastError("Failed to write equipment fields");
+            return false;
+        }
+        i = end;
+    }
+    return true;
+}
+
+void Session::CommitJournalAction(JournalAction action, bool posted) {
+    if (posted) {
+        m_mailboxJournal.push_back(std::move(action));
+    } else {
+        ApplyJournalAction(action);
+    }
+}
+
+void Session::ApplyJournalAction(const JournalAction& action) {
+    switch (action.kind) {
+    case JOURNAL_ACTION_RECORD:
+        m_journal.Record(action.base, action.offset, action.before.data(), action.after.data(), action.after.size());
+        break;
+    case JOURNAL_ACTION_UNDO:
+        m_journal.CommitUndo(action.base, action.steps);
+        break;
+    case JOURNAL_ACTION_REDO:
+        m_journal.CommitRedo(action.base, action.steps);
+        break;
+    }
+}
+
+bool Session::ReadRecordFields(QWORD base, const RecordPlan& plan, int64_t* outValues) {
+    m_recordBuffer.resize(plan.bufferSize);
+    if (!ReadRecordPlan(m_memory.get(), base, plan, m_recordBuffer.data())) {
+        SetLastError("Failed to read equipment fields");
+        return false;
+    }
+    for (int field = 0; field < RECORD_FIELD_COUNT; field++) {
+        if ((plan.fields & RecordFieldBit(field)) != 0) {
+            outValues[field] = DecodeRecordField(m_recordLayout.Get(field), m_recordBuffer.data() + plan.bufferOffsets[field]);
+        }
+    }
+    return true;
+}
+
+bool Session::ApplyRecordWrites(QWORD base, const RecordPlan& plan, const RecordWrite* writes, size_t count) {
+    if (count == 0 || plan.spanCount == 0) {
+        return true;
+    }
+
+    // 上一批尚未应用时不能再写，否则之后应用的旧批次会覆盖这次的结果
+    if (!CheckMailboxIdle()) {
+        return false;
+    }
+
+    // 读出覆盖区间的前像
+    std::vector<uint8_t> before(plan.bufferSize);
+    if (!ReadRecordPlan(m_memory.get(), base, plan, before.data())) {
+        SetLastError("Failed to read equipment fields");
+        return false;
+    }
+
+    // 信箱只改写各字段覆盖的位，其余位保持游戏应用时的值
+    std::vector<uint8_t> after(before);
+    std::vector<uint8_t> bitMasks(after.size(), 0);
+    for (size_t i = 0; i < count; i++) {
+        const RecordWrite& write = writes[i];
+        uint32_t position = plan.bufferOffsets[write.field];
+        EncodeRecordField(m_recordLayout.Get(write.field), write.value, &after[position], &bitMasks[position]);
+    }
+
+    // 每个区间只写回首尾变化字节之间的部分 (内置布局下只有一个区间，也就只有一步日志)
+    size_t spanStart = 0;
+    for (uint32_t s = 0; s < plan.spanCount; s++) {
+        const RecordSpan& span = plan.spans[s];
+        const size_t spanBegin = spanStart;
+        size_t first = spanBegin;
+        size_t last = spanBegin + span.size;
+        spanStart = last;
+        while (first < last && before[first] == after[first]) first++;
+        while (last > first && before[last - 1] == after[last - 1]) last--;
+        if (first == last) {
+            continue;
+        }
+
+        uint32_t offset = span.offset + (uint32_t)(first - spanBegin);
+        bool posted;
+        if (!CommitEquipmentBytes(base, offset, &after[first], &bitMasks[first], last - first, posted)) {
+            return false;
+        }
+        CommitJournalAction({ JOURNAL_ACTION_RECORD, base, offset, 0,
+            std::vector<uint8_t>(&before[first], &before[last]), std::vector<uint8_t>(&after[first], &after[last]) }, posted);
+    }
+    return true;
+}
+
+bool Session::ApplyJournalPatch(QWORD base, const JournalPatch& patch, JournalActionKind kind, int steps) {
+    if (!CheckMailboxIdle()) {
+        return false;
+    }
+
+    std::vector<uint8_t> before(patch.bytes.size());
+    if (!m_memory->Read(base + patch.offset, before.data(), before.size())) {
+        SetLastError("Failed to read equipment fields");
+        return false;
+    }
+
+    std::vector<uint8_t> after(before);
+    std::vector<uint8_t> bitMasks(after.size(), 0);
+    for (size_t i = 0; i < after.size(); i++) {
+        if (patch.mask[i]) {
+            after[i] = patch.bytes[i];
+            bitMasks[i] = 0xFF;
+        }
+    }
+
+    bool posted = false;
+    if (after != before && !CommitEquipmentBytes(base, patch.offset, after.data(), bitMasks.data(), after.size(), posted)) {
+        return false;
+    }
+    if (kind != JOURNAL_ACTION_RECORD || after != before) {
+        CommitJournalAction({ kind, base, patch.offset, steps, std::move(before), std::move(after) }, posted);
+    }
+
+    // 快照中该记录的所有字段都已过期
+    SnapshotFor(base).validMask = 0;
+    return true;
+}
+
+bool Session::EnableStatePage(const char* name) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    if (name == nullptr || name[0] == '\0') {
+        SetLastError("Invalid state page name");
+        return false;
+    }
+
+    if (!m_statePage.Open(name)) {
+        SetLastError("Failed to create state page mapping");
+        return false;
+    }
+
+    memset(&m_publishedState, 0, sizeof(m_publishedState));
+    PublishState();
+    m_lastError.clear();
+    return true;
+}
+
+void Session::DisableStatePage() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_statePage.Close();
+}
+
+bool Session::Attach(std::unique_ptr<ProcessMemory> memory) {
+    StateScope scope(*this, "Attach");
+
+    if (m_memory != nullptr) {
+        SetLastError("Already attached to a process");
+        return false;
+    }
+
+    if (memory == nullptr) {
+        SetLastError("Failed to open process");
+        return false;
+    }
+
+    // 跟踪层在计数层之下，记录的是真实的后端调用
+    if (!m_tracePath.empty()) {
+        std::unique_ptr<TracingProcessMemory> tracing(new TracingProcessMemory(std::move(memory)));
+        if (!tracing->Open(m_tracePath.c_str())) {
+            SetLastError("Failed to open trace file");
+            return false;
+        }
+        memory = std::move(tracing);
+    }
+
+    m_memory.reset(new CountingProcessMemory(std::move(memory)));
+    m_memory->MarkPhase("Attach");
+
+    // 重置捕获缓存
+    ResetCaptureCache();
+
+    m_lastError.clear();
+    AdoptResidentHooks();
+    return true;
+}
+
+void Session::Detach() {
+    StateScope scope(*this, "Detach");
+
+    // 注入器持有后端指针，必须在释放后端之前清理
+    // 常驻模式下 hook 和代码洞留在目标进程中，只丢弃本地状态
+    // 恢复失败时注入点仍跳向代码洞，此时不能释放代码洞，只能放弃
+    // 被其它程序改写的 hook 同样可能仍跳向代码洞: 其它位置照常恢复，代码洞放弃
+    if (LeaveHooksResident()) {
+        m_weaponInjector.Abandon();
+        m_armorInjector.Abandon();
+        m_skillBypassInjector.Cleanup();
+        m_editMailbox.Abandon();
+        m_hookStats.Abandon();
+        m_captureRing.Abandon();
+        m_arena.Abandon();
+    } else if (RestorePatches(true) && !HasForeignHooks()) {
+        m_weaponInjector.Cleanup();
+        m_armorInjector.Cleanup();
+        m_skillBypassInjector.Cleanup();
+        m_editMailbox.Release();
+        m_hookStats.Release();
+        m_captureRing.Release();
+        m_arena.Release();
+    } else {
+        m_weaponInjector.Abandon();
+        m_armorInjector.Abandon();
+        m_skillBypassInjector.Abandon();
+        m_editMailbox.Abandon();
+        m_hookStats.Abandon();
+        m_captureRing.Abandon();
+        m_arena.Abandon();
+    }
+
+    m_memory.reset();
+
+    // 重置捕获缓存；基址在分离后失效，日志历史一并丢弃 (日志文件保留)
+    ResetCaptureCache();
+    memset(&m_statePage.Staging().record, 0, sizeof(StateRecord));
+    m_journal.Clear();
+    m_mailboxJournal.clear();
+    m_editsWithdrawn = false;
+    m_valueScanner.Reset();
+
+    m_lastError.clear();
+}
+
+bool Session::IsAttached() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return m_memory != nullptr;
+}
+
+bool Session::EnableCapture() {
+    StateScope scope(*this, "EnableCapture");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+
+    // 单次捕获后撤下的 hook 直接重新挂上，保留已捕获的基址
+    if (!RearmParkedHooks()) {
+        return false;
+    }
+
+    bool weaponEnabled = m_weaponInjector.IsEnabled();
+    bool armorEnabled = m_armorInjector.IsEnabled();
+
+    // 如果两个都已启用，直接返回成功
+    if (weaponEnabled && armorEnabled) {
+        return true;
+    }
+
+    // 整个会话只做一次近址搜索，环形缓冲区同样只分配一次
+    if (!EnsureArena()) {
+        return false;
+    }
+    if (!m_captureRing.IsInitialized() && !m_captureRing.Initialize(m_memory.get(), &m_arena, AllowSharedBlocks())) {
+        SetLastError("Failed to allocate capture ring buffer");
+        return false;
+    }
+    // 信箱分配失败不影响捕获，hook 只是不检查信箱
+    if (!m_editMailbox.IsInitialized()) {
+        m_editMailbox.Initialize(m_memory.get(), &m_arena, AllowSharedBlocks());
+    }
+
+    // 初始化武器Hook
+    if (!weaponEnabled) {
+        QWORD weaponInjectionPoint = AobScan(m_memory.get(), AobPatterns::WEAPON_CAPTURE_AOB);
+        if (weaponInjectionPoint == 0) {
+            SetLastError("Weapon AOB pattern not found. Game version may be incompatible.");
+            return false;
+        }
+
+        if (!m_weaponInjector.Initialize(m_memory.get(), &m_arena, &m_captureRing, &m_editMailbox, weaponInjectionPoint, HookType::Weapon)) {
+            SetLastError("Failed to initialize weapon code injector");
+            return false;
+        }
+        m_lastWeaponBase = 0;
+        m_weaponCapture.capturedSinceArm = false;
+    }
+
+    // 初始化装备Hook
+    // 装备Hook找不到或初始化失败不算致命错误，只记录警告，武器Hook成功即可继续
+    const char* armorWarning = nullptr;
+    bool armorReady = false;
+    if (!armorEnabled) {
+        QWORD armorInjectionPoint = AobScan(m_memory.get(), AobPatterns::ARMOR_CAPTURE_AOB);
+        if (armorInjectionPoint == 0) {
+            armorWarning = "Armor AOB pattern not found. Armor editing may not work.";
+        } else if (!m_armorInjector.Initialize(m_memory.get(), &m_arena, &m_captureRing, &m_editMailbox, armorInjectionPoint, HookType::Armor)) {
+            armorWarning = "Failed to initialize armor code injector. Armor editing may not work.";
+        } else {
+            m_lastArmorBase = 0;
+            m_armorCapture.capturedSinceArm = false;
+            armorReady = true;
+        }
+    }
+
+    ApplyHookInstrumentation();
+
+    // 两个注入点在同一事务中改写
+    PatchTransaction transaction(m_memory.get());
+    if (!weaponEnabled && !m_weaponInjector.PrepareEnable(transaction)) {
+        SetLastError("Failed to enable weapon hook");
+        return false;
+    }
+    if (armorReady && !m_armorInjector.PrepareEnable(transaction)) {
+        armorReady = false;
+        armorWarning = "Failed to enable armor hook. Armor editing may not work.";
+    }
+
+    if (transaction.Commit()) {
+        if (!weaponEnabled) m_weaponInjector.SetEnabled(true);
+        if (armorReady) m_armorInjector.SetEnabled(true);
+    } else {
+        // 事务已整体回滚；装备Hook可能是失败原因，单独再试武器Hook
+        if (!armorReady || weaponEnabled || !m_weaponInjector.Enable()) {
+            SetLastError("Failed to enable weapon hook");
+            return false;
+        }
+        armorWarning = "Failed to enable armor hook. Armor editing may not work.";
+    }
+
+    if (armorWarning != nullptr) {
+        m_lastError = armorWarning;
+        return true; // 仍然返回成功，因为武器Hook已启用
+    }
+
+    m_lastError.clear();
+    return true;
+}
+
+void Session::DisableCapture() {
+    StateScope scope(*this, "DisableCapture");
+    RestorePatches(false);
+}
+
+bool Session::RestorePatches(bool includeSkillBypass) {
+    if (m_memory == nullptr) {
+        return true;
+    }
+
+    // 所有注入点在同一事务中恢复
+    PatchTransaction transaction(m_memory.get());
+    bool weapon = m_weaponInjector.PrepareDisable(transaction);
+    bool armor = m_armorInjector.PrepareDisable(transaction);
+    bool skillBypass = includeSkillBypass && m_skillBypassInjector.PrepareDisable(transaction);
+
+    if (!transaction.Commit()) {
+        SetLastError("Failed to restore original code");
+        return false;
+    }
+
+    if (weapon) m_weaponInjector.SetEnabled(false);
+    if (armor) m_armorInjector.SetEnabled(false);
+    if (skillBypass) m_skillBypassInjector.SetEnabled(false);
+    m_weaponCapture.parked = false;
+    m_armorCapture.parked = false;
+
+    // hook 已全部撤下，未应用的批次不会再被应用
+    if (!m_weaponInjector.IsEnabled() && !m_armorInjector.IsEnabled()) {
+        CancelMailbox();
+    }
+    if (HasForeignHooks() || (includeSkillBypass && m_skillBypassInjector.IsForeign())) {
+        SetLastError("A patched site was modified by another program and was left in place");
+    }
+    return true;
+}
+
+// 按缓存的 RVA 找到上一次会话留下的头部，hook 全部完好时接管，否则清除
+// 没有缓存或头部无效 (游戏已重启、不是同一版本) 时什么都不做，之后照常扫描
+void Session::AdoptResidentHooks() {
+    m_residentState = RESIDENT_NONE;
+    if (m_residentCachePath.empty()) {
+        return;
+    }
+
+    ResidentCacheEntry cache;
+    if (!LoadResidentCache(m_residentCachePath.c_str(), cache)) {
+        return;
+    }
+
+    QWORD moduleBase = 0;
+    QWORD moduleSize = 0;
+    if (!GetMainModuleInfo(m_memory.get(), moduleBase, moduleSize) || moduleSize != cache.moduleSize) {
+        return;
+    }
+
+    QWORD headerAddress = moduleBase + (QWORD)cache.headerRva;
+    ResidentCaveHeader header;
+    if (!ReadResidentHeader(m_memory.get(), headerAddress, header) ||
+        header.moduleBase != moduleBase || header.moduleSize != moduleSize) {
+        return;
+    }
+
+    ResidentHookState states[ResidentCaveLayout::MAX_HOOKS];
+    bool intact = true;
+    for (uint32_t i = 0; i < header.hookCount; i++) {
+        states[i] = CheckResidentHook(m_memory.get(), header.hooks[i]);
+        intact = intact && states[i] == ResidentHookState::Intact;
+    }
+
+    if (intact && AdoptResidentCave(header)) {
+        m_residentState = RESIDENT_ADOPTED;
+        // 分离期间的捕获记录仍在环中，立即得到当前装备
+        PollCaptures();
+        return;
+    }
+
+    UninstallResidentCave(headerAddress, header, states);
+    m_residentState = RESIDENT_UNINSTALLED;
+}
+
+bool Session::AdoptResidentCave(const ResidentCaveHeader& header) {
+    bool adopted = m_arena.Adopt(m_memory.get(), header.arenaBase) &&
+        m_captureRing.Adopt(m_memory.get(), &m_arena, header.ringAddress) &&
+        (header.mailboxAddress == 0 || m_editMailbox.Adopt(m_memory.get(), &m_arena, header.mailboxAddress)) &&
+        (header.statsAddress == 0 || m_hookStats.Adopt(m_memory.get(), &m_arena, header.statsAddress));
+
+    for (uint32_t i = 0; adopted && i < header.hookCount; i++) {
+        const ResidentHookRecord& record = header.hooks[i];
+        CodeInjector& injector = record.source == CaptureRingLayout::SOURCE_ARMOR ? m_armorInjector : m_weaponInjector;
+        adopted = !injector.IsEnabled() && injector.Adopt(m_memory.get(), &m_arena, &m_captureRing, &m_editMailbox, record);
+    }
+
+    if (!adopted) {
+        // 只丢弃本地状态，目标进程中的代码洞由调用者清除
+        m_weaponInjector.Abandon();
+        m_armorInjector.Abandon();
+        m_editMailbox.Abandon();
+        m_hookStats.Abandon();
+        m_captureRing.Abandon();
+        m_arena.Abandon();
+    }
+    return adopted;
+}
+
+// 恢复仍跳向代码洞的注入点并清除头部；还有无法识别的注入点时保留代码洞 (可能仍有代码跳向其中)
+void Session::UninstallResidentCave(QWORD headerAddress, const ResidentCaveHeader& header, const ResidentHookState* states) {
+    PatchTransaction transaction(m_memory.get());
+    bool foreign = false;
+    for (uint32_t i = 0; i < header.hookCount; i++) {
+        const ResidentHookRecord& record = header.hooks[i];
+        if (states[i] == ResidentHookState::Intact || states[i] == ResidentHookState::Damaged) {
+            transaction.Add(record.injectionPoint, record.originalBytes, record.jumpBytes, record.patchSize);
+        } else if (states[i] == ResidentHookState::Foreign) {
+            foreign = true;
+        }
+    }
+
+    bool restored = transaction.Commit();
+    ClearResidentHeader(m_memory.get(), headerAddress);
+    if (restored && !foreign) {
+        m_memory->Free(header.arenaBase);
+        m_lastError = "Resident hooks were no longer intact and have been removed";
+    } else {
+        m_lastError = "Resident hooks were no longer intact; the code cave was left in place";
+    }
+}
+
+// 写入常驻头部和缓存；不满足常驻条件或写入失败时返回 false，由调用者照常恢复
+bool Session::LeaveHooksResident() {
+    if (m_residentCachePath.empty() || m_memory == nullptr || !m_arena.IsInitialized() || !m_captureRing.IsInitialized()) {
+        return false;
+    }
+    if (!m_weaponInjector.IsEnabled() && !m_armorInjector.IsEnabled()) {
+        return false;
+    }
+
+    // 被其它程序改写的 hook 不能再当作自己的补丁接管
+    if (HasForeignHooks()) {
+        return false;
+    }
+
+    // 共享视图在本进程退出后无法再接管 (开启常驻模式之前分配的)
+    if (m_captureRing.IsShared() || m_editMailbox.IsShared() || m_hookStats.IsShared()) {
+        return false;
+    }
+
+    QWORD moduleBase = 0;
+    QWORD moduleSize = 0;
+    if (!GetMainModuleInfo(m_memory.get(), moduleBase, moduleSize)) {
+        return false;
+    }
+
+    // 技能绕过不常驻
+    if (m_skillBypassInjector.IsEnabled() && !m_skillBypassInjector.Disable()) {
+        return false;
+    }
+
+    ResidentCaveHeader header;
+    memset(&header, 0, sizeof(header));
+    header.arenaBase = m_arena.GetBase();
+    header.moduleBase = moduleBase;
+    header.moduleSize = moduleSize;
+    header.ringAddress = m_captureRing.GetAddress();
+    header.mailboxAddress = m_editMailbox.GetAddress();
+    header.statsAddress = m_hookStats.GetAddress();
+
+    // 单次捕获后撤下的 hook 不常驻
+    if (m_weaponInjector.Describe(header.hooks[header.hookCount])) header.hookCount++;
+    if (m_armorInjector.Describe(header.hooks[header.hookCount])) header.hookCount++;
+
+    QWORD headerAddress = m_arena.GetHeaderAddress();
+    ResidentCacheEntry cache;
+    cache.moduleSize = moduleSize;
+    cache.headerRva = (int64_t)(headerAddress - moduleBase);
+
+    if (!WriteResidentHeader(m_memory.get(), headerAddress, header)) {
+        return false;
+    }
+    if (!SaveResidentCache(m_residentCachePath.c_str(), cache)) {
+        ClearResidentHeader(m_memory.get(), headerAddress);
+        return false;
+    }
+    return true;
+}
+
+bool Session::IsCaptureEnabled() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    // 只要武器Hook启用就算启用 (单次捕获后自动撤下的也算)
+    return IsWeaponCaptureActive();
+}
+
+EquipmentType Session::GetCurrentEquipmentType() {
+    StateScope scope(*this, "GetCurrentEquipmentType");
+    return GetCurrentType();
+}
+
+bool Session::IsWeaponMode() {
+    StateScope scope(*this, "IsWeaponMode");
+    EquipmentType type = GetCurrentType();
+    return type == EQUIP_TYPE_WEAPON || type == EQUIP_TYPE_UNKNOWN;
+}
+
+QWORD Session::GetEquipmentBase() {
+    StateScope scope(*this, "GetEquipmentBase");
+    return GetActiveEquipmentBase();
+}
+
+bool Session::IsWeaponHookEnabled() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return m_weaponInjector.IsEnabled();
+}
+
+bool Session::IsArmorHookEnabled() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return m_armorInjector.IsEnabled();
+}
+
+QWORD Session::GetWeaponBase() {
+    StateScope scope(*this, "GetWeaponBase");
+    PollCaptures();
+    return IsWeaponCaptureActive() ? m_lastWeaponBase : 0;
+}
+
+QWORD Session::GetArmorBase() {
+    StateScope scope(*this, "GetArmorBase");
+    PollCaptures();
+    return IsArmorCaptureActive() ? m_lastArmorBase : 0;
+}
+
+void Session::SetSharedCapture(bool allow) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_allowSharedCapture = allow;
+}
+
+bool Session::IsCaptureShared() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return m_captureRing.IsShared();
+}
+
+void Session::SetOneShotCapture(bool enable) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_oneShotCapture = enable;
+}
+
+bool Session::RearmCapture() {
+    StateScope scope(*this, "RearmCapture");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+    return RearmParkedHooks();
+}
+
+bool Session::GetCaptureStats(CaptureStats* outStats) {
+    StateScope scope(*this, "GetCaptureStats");
+
+    if (outStats == nullptr) {
+        SetLastError("Invalid parameters");
+        return false;
+    }
+
+    PollCaptures();
+
+    memset(outStats, 0, sizeof(CaptureStats));
+    outStats->weaponHits = m_weaponCapture.hits;
+    outStats->armorHits = m_armorCapture.hits;
+    outStats->lostHits = m_captureRing.GetLostCount();
+    outStats->weaponHookedMs = m_weaponInjector.GetHookedMilliseconds();
+    outStats->armorHookedMs = m_armorInjector.GetHookedMilliseconds();
+    outStats->rearmCount = m_rearmCount;
+    if (m_oneShotCapture) outStats->flags |= CaptureStatsLayout::FLAG_ONE_SHOT;
+    if (m_weaponInjector.IsEnabled()) outStats->flags |= CaptureStatsLayout::FLAG_WEAPON_HOOKED;
+    if (m_armorInjector.IsEnabled()) outStats->flags |= CaptureStatsLayout::FLAG_ARMOR_HOOKED;
+    if (m_weaponCapture.parked) outStats->flags |= CaptureStatsLayout::FLAG_WEAPON_PARKED;
+    if (m_armorCapture.parked) outStats->flags |= CaptureStatsLayout::FLAG_ARMOR_PARKED;
+    return true;
+}
+
+void Session::SetHookInstrumentation(bool enable) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_instrumentHooks = enable;
+}
+
+bool Session::GetHookStats(int equipmentType, HookStats* outStats) {
+    StateScope scope(*this, "GetHookStats");
+
+    if (outStats == nullptr || (equipmentType != EQUIP_TYPE_WEAPON && equipmentType != EQUIP_TYPE_ARMOR)) {
+        SetLastError("Invalid parameters");
+        return false;
+    }
+    if (!CheckAttached()) {
+        return false;
+    }
+    if (!m_hookStats.IsInitialized()) {
+        SetLastError("Hook instrumentation has not been enabled");
+        return false;
+    }
+
+    uint8_t source = equipmentType == EQUIP_TYPE_WEAPON ? CaptureRingLayout::SOURCE_WEAPON : CaptureRingLayout::SOURCE_ARMOR;
+    if (!m_hookStats.Read(source, *outStats)) {
+        SetLastError("Failed to read hook statistics");
+        return false;
+    }
+    return true;
+}
+
+void Session::SetEditMailbox(bool enable) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_useEditMailbox = enable;
+}
+
+int Session::GetPendingEdits() {
+    StateScope scope(*this, "GetPendingEdits");
+    if (m_memory == nullptr) {
+        return 0;
+    }
+    SettleMailbox();
+    return m_editMailbox.GetPendingCount();
+}
+
+void Session::SetResidentHooks(const char* cachePath) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_residentCachePath = cachePath != nullptr ? cachePath : "";
+}
+
+int Session::GetResidentState() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return m_residentState;
+}
+
+QWORD Session::GetCaptureGeneration() {
+    StateScope scope(*this, "GetCaptureGeneration");
+    PollCaptures();
+    return m_captureRing.GetGeneration();
+}
+
+int Session::GetCapturedItems(CapturedItem* outItems, int capacity) {
+    StateScope scope(*this, "GetCapturedItems");
+    PollCaptures();
+
+    std::vector<CapturedItem> items;
+    items.reserve(m_capturedItems.size());
+    for (const auto& entry : m_capturedItems) {
+        items.push_back(entry.second);
+    }
+    std::sort(items.begin(), items.end(),
+        [](const CapturedItem& a, const CapturedItem& b) { return a.lastSequence > b.lastSequence; });
+
+    if (outItems != nullptr) {
+        int count = std::min(capacity, (int)items.size());
+        for (int i = 0; i < count; i++) {
+            outItems[i] = items[i];
+        }
+    }
+    return (int)items.size();
+}
+
+void Session::ClearCapturedItems() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_capturedItems.clear();
+}
+
+void Session::SetIntegrityInterval(uint32_t milliseconds) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_integrityIntervalMs = milliseconds;
+}
+
+bool Session::CheckIntegrity(IntegrityStats* outStats) {
+    StateScope scope(*this, "CheckIntegrity");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+    RunIntegrityCheck();
+    if (outStats != nullptr) {
+        *outStats = m_integrityStats;
+    }
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::GetIntegrityStats(IntegrityStats* outStats) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    if (outStats == nullptr) {
+        SetLastError("Invalid parameters");
+        return false;
+    }
+    *outStats = m_integrityStats;
+    return true;
+}
+
+bool Session::ScanPointerPaths(QWORD target, const PointerScanConfig* config, const char* outputPath,
+    PointerScanStats* outStats) {
+    StateScope scope(*this, "ScanPointerPaths");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+    if (outputPath == nullptr || outputPath[0] == '\0') {
+        SetLastError("Invalid parameters");
+        return false;
+    }
+    if (target == 0) {
+        target = GetActiveEquipmentBase();
+        if (target == 0) {
+            SetLastError("Equipment base address not captured yet");
+            return false;
+        }
+    }
+
+    PointerScanConfig requested;
+    memset(&requested, 0, sizeof(requested));
+    if (config != nullptr) {
+        requested = *config;
+    }
+    const PointerScanConfig normalized = NormalizePointerScanConfig(requested);
+
+    PointerScanStats stats;
+    memset(&stats, 0, sizeof(stats));
+    std::vector<PointerPath> paths;
+    {
+        PointerMap map;
+        if (!map.Build(m_memory.get(), normalized, stats)) {
+            if (outStats != nullptr) {
+                *outStats = stats;
+            }
+            SetLastError(stats.truncated ? "Pointer map exceeds the memory limit" : "Failed to enumerate process memory");
+            return false;
+        }
+        map.Search(target, normalized, paths, stats);
+    }
+
+    QWORD moduleBase = 0;
+    QWORD moduleSize = 0;
+    if (!GetMainModuleInfo(m_memory.get(), moduleBase, moduleSize) ||
+        !WritePointerPathFile(outputPath, moduleSize, normalized, paths)) {
+        SetLastError("Failed to write pointer path file");
+        return false;
+    }
+
+    if (outStats != nullptr) {
+        *outStats = stats;
+    }
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::IntersectPointerPaths(const char* first, const char* second, const char* outputPath, uint64_t* outCount) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    if (first == nullptr || second == nullptr || outputPath == nullptr) {
+        SetLastError("Invalid parameters");
+        return false;
+    }
+
+    uint64_t count = 0;
+    if (!IntersectPointerPathFiles(first, second, outputPath, count)) {
+        SetLastError("Failed to intersect pointer path files (missing file or different game version)");
+        return false;
+    }
+    if (outCount != nullptr) {
+        *outCount = count;
+    }
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::ResolvePointerPath(const PointerPath* path, QWORD* outAddress) {
+    StateScope scope(*this, "ResolvePointerPath");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+    if (path == nullptr || outAddress == nullptr) {
+        SetLastError("Invalid parameters");
+        return false;
+    }
+
+    QWORD moduleBase = 0;
+    QWORD moduleSize = 0;
+    if (!GetMainModuleInfo(m_memory.get(), moduleBase, moduleSize) || path->moduleOffset >= moduleSize ||
+        !::ResolvePointerPath(m_memory.get(), moduleBase, *path, *outAddress)) {
+        SetLastError("Pointer path does not resolve");
+        return false;
+    }
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::FirstScan(const ValueScanQuery* query, ValueScanStats* outStats) {
+    StateScope scope(*this, "FirstScan");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+    if (query == nullptr || !IsValidValueQuery(*query, true)) {
+        SetLastError("Invalid parameters");
+        return false;
+    }
+
+    ValueScanStats stats;
+    bool ok = m_valueScanner.FirstScan(m_memory.get(), *query, stats);
+    if (outStats != nullptr) {
+        *outStats = stats;
+    }
+    if (!ok) {
+        SetLastError(stats.scannedBytes != 0 ? "Scan candidates exceed the memory limit" : "Failed to enumerate process memory");
+        return false;
+    }
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::NextScan(const ValueScanQuery* query, ValueScanStats* outStats) {
+    StateScope scope(*this, "NextScan");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+    if (!m_valueScanner.HasResults()) {
+        SetLastError("No previous scan");
+        return false;
+    }
+    if (query == nullptr || !IsValidValueQuery(*query, false)) {
+        SetLastError("Invalid parameters");
+        return false;
+    }
+    if (query->valueType != m_valueScanner.GetValueType()) {
+        SetLastError("Value type differs from the previous scan");
+        return false;
+    }
+
+    ValueScanStats stats;
+    bool ok = m_valueScanner.NextScan(m_memory.get(), *query, stats);
+    if (outStats != nullptr) {
+        *outStats = stats;
+    }
+    if (!ok) {
+        SetLastError("Scan candidates exceed the memory limit");
+        return false;
+    }
+    m_lastError.clear();
+    return true;
+}
+
+int Session::GetScanResults(ValueScanResult* outResults, int capacity) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    uint64_t total = m_valueScanner.GetResults(outResults, capacity > 0 ? (uint64_t)capacity : 0);
+    return (int)std::min<uint64_t>(total, INT_MAX);
+}
+
+void Session::ResetScan() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_valueScanner.Reset();
+}
+
+void Session::SetOwnerCapture(bool enable) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_captureOwners = enable;
+}
+
+// 按容器对已捕获的装备分组，从装备最多的容器开始推导，第一个成功的布局生效
+bool Session::DeriveInventoryLayoutLocked() {
+    PollCaptures();
+
+    std::unordered_map<QWORD, std::vector<QWORD>> byOwner;
+    for (const auto& entry : m_capturedItems) {
+        if (entry.second.owner != 0) {
+            byOwner[entry.second.owner].push_back(entry.second.base);
+        }
+    }
+    if (byOwner.empty()) {
+        SetLastError("No captured item has an owner pointer (enable owner capture and select some armor)");
+        return false;
+    }
+
+    std::vector<std::pair<QWORD, std::vector<QWORD>>> owners(byOwner.begin(), byOwner.end());
+    std::sort(owners.begin(), owners.end(),
+        [](const auto& a, const auto& b) { return a.second.size() > b.second.size(); });
+    for (const auto& owner : owners) {
+        if (::DeriveInventoryLayout(m_memory.get(), owner.first, owner.second.data(), owner.second.size(), m_inventoryLayout)) {
+            return true;
+        }
+    }
+
+    memset(&m_inventoryLayout, 0, sizeof(m_inventoryLayout));
+    SetLastError("Failed to derive the inventory layout from the captured items");
+    return false;
+}
+
+bool Session::DeriveInventoryLayout(InventoryLayout* outLayout) {
+    StateScope scope(*this, "DeriveInventoryLayout");
+
+    if (!CheckAttached() || !DeriveInventoryLayoutLocked()) {
+        return false;
+    }
+    if (outLayout != nullptr) {
+        *outLayout = m_inventoryLayout;
+    }
+    m_lastError.clear();
+    return true;
+}
+
+int Session::ReadInventory(InventoryItem* outItems, int capacity) {
+    StateScope scope(*this, "ReadInventory");
+
+    if (!CheckAttached()) {
+        return -1;
+    }
+    if (m_inventoryLayout.arrayKind == INVENTORY_ARRAY_NONE && !DeriveInventoryLayoutLocked()) {
+        return -1;
+    }
+    if (!ReadInventoryRecords(m_memory.get(), m_inventoryLayout, m_inventoryBases, m_inventoryRecords)) {
+        SetLastError("Failed to read the inventory");
+        return -1;
+    }
+
+    m_lastError.clear();
+    return CopyInventoryItems(m_inventoryBases, m_inventoryRecords, outItems, capacity);
+}
+
+bool Session::ScanEquipment(const EquipmentScanConfig* config, EquipmentScanStats* outStats) {
+    StateScope scope(*this, "ScanEquipment");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+
+    EquipmentScanConfig requested;
+    memset(&requested, 0, sizeof(requested));
+    if (config != nullptr) {
+        requested = *config;
+    }
+
+    EquipmentScanStats stats;
+    bool ok = ScanEquipmentRecords(m_memory.get(), requested, m_scannedBases, m_scannedRecords, stats);
+    if (outStats != nullptr) {
+        *outStats = stats;
+    }
+    if (!ok) {
+        SetLastError("Failed to enumerate process memory");
+        return false;
+    }
+    m_lastError.clear();
+    return true;
+}
+
+int Session::GetScannedEquipment(InventoryItem* outItems, int capacity) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return CopyInventoryItems(m_scannedBases, m_scannedRecords, outItems, capacity);
+}
+
+bool Session::AddFieldSample(QWORD base, uint32_t size, const int32_t* labels, uint32_t labelCount) {
+    StateScope scope(*this, "AddFieldSample");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+    if (size == 0 || size > FieldSampleLayout::MAX_RECORD_SIZE || labelCount > FieldSampleLayout::MAX_LABELS ||
+        (labelCount != 0 && labels == nullptr)) {
+        SetLastError("Invalid parameters");
+        return false;
+    }
+    if (m_fieldSamples.GetCount() != 0 &&
+        (m_fieldSamples.GetRecordSize() != size || m_fieldSamples.GetLabelCount() != labelCount)) {
+        SetLastError("Sample size or label count differs from the existing samples");
+        return false;
+    }
+    if (m_fieldSamples.GetCount() >= FieldSampleLayout::MAX_SAMPLES) {
+        SetLastError("Too many samples");
+        return false;
+    }
+
+    if (base == 0) {
+        base = GetActiveEquipmentBase();
+        if (base == 0) {
+            SetLastError("Equipment base address not captured yet");
+            return false;
+        }
+    }
+    std::vector<uint8_t> record(size);
+    if (!m_memory->Read(base, record.data(), record.size())) {
+        SetLastError("Failed to read the sample record");
+        return false;
+    }
+
+    if (m_fieldSamples.GetCount() == 0) {
+        m_fieldSamples.Reset(size, labelCount);
+    }
+    m_fieldSamples.Add(base, record.data(), labels);
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::SaveFieldSamples(const char* path) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    if (path == nullptr || path[0] == '\0') {
+        SetLastError("Invalid parameters");
+        return false;
+    }
+    if (!m_fieldSamples.Write(path)) {
+        SetLastError("Failed to write the sample file");
+        return false;
+    }
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::LoadFieldSamples(const char* path) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    if (path == nullptr || path[0] == '\0') {
+        SetLastError("Invalid parameters");
+        return false;
+    }
+    if (!m_fieldSamples.Read(path)) {
+        SetLastError("Failed to read the sample file");
+        return false;
+    }
+    m_lastError.clear();
+    return true;
+}
+
+void Session::ClearFieldSamples() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_fieldSamples.Clear();
+}
+
+int Session::GetFieldSampleCount() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return (int)m_fieldSamples.GetCount();
+}
+
+int Session::AnalyzeFieldSamples(FieldCandidate* outCandidates, int capacity, FieldAnalysisStats* outStats) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    std::vector<FieldCandidate> candidates;
+    FieldAnalysisStats stats;
+    bool ok = ::AnalyzeFieldSamples(m_fieldSamples, candidates, stats);
+    if (outStats != nullptr) {
+        *outStats = stats;
+    }
+    if (!ok) {
+        SetLastError("No field samples");
+        return -1;
+    }
+
+    int total = (int)candidates.size();
+    int count = outCandidates != nullptr ? std::min(capacity, total) : 0;
+    for (int i = 0; i < count; i++) {
+        outCandidates[i] = candidates[i];
+    }
+    m_lastError.clear();
+    return total;
+}
+
+bool Session::ResolveCatalogSpecs(const CatalogTableSpec* specs, CatalogTableSpec* outSpecs) {
+    for (uint32_t kind = 0; kind < CatalogLayout::KIND_COUNT; kind++) {
+        outSpecs[kind] = specs != nullptr ? specs[kind] : GetDefaultCatalogSpec((CatalogKind)kind);
+        if (!IsValidCatalogSpec(outSpecs[kind])) {
+            SetLastError("Invalid parameters");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Session::LoadGameCatalog(const char* cachePath, const CatalogTableSpec* specs, CatalogStats* outStats) {
+    StateScope scope(*this, "LoadGameCatalog");
+
+    CatalogTableSpec resolved[CatalogLayout::KIND_COUNT];
+    if (!CheckAttached() || !ResolveCatalogSpecs(specs, resolved)) {
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    CatalogStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.buildKey = ComputeGameBuildKey(m_memory.get());
+    const uint64_t specHash = HashCatalogSpecs(resolved);
+    const bool useCache = cachePath != nullptr && cachePath[0] != '\0' && stats.buildKey != 0;
+
+    bool ok = false;
+    if (useCache && m_catalog.Read(cachePath, stats.buildKey, specHash)) {
+        stats.fromCache = 1;
+        for (uint32_t kind = 0; kind < CatalogLayout::KIND_COUNT; kind++) {
+            stats.entries[kind] = m_catalog.GetCount((CatalogKind)kind);
+        }
+        stats.microseconds = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        ok = true;
+    } else {
+        ok = ExtractGameCatalog(m_memory.get(), resolved, m_catalog, stats);
+        bool complete = std::all_of(stats.entries, stats.entries + CatalogLayout::KIND_COUNT,
+            [](uint32_t count) { return count != 0; });
+        if (ok && complete && useCache) {
+            m_catalog.Write(cachePath, stats.buildKey, specHash);
+        }
+    }
+
+    if (outStats != nullptr) {
+        *outStats = stats;
+    }
+    if (!ok) {
+        SetLastError("Game data tables not found");
+        return false;
+    }
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::DumpGameTables(const char* path, const CatalogTableSpec* specs) {
+    StateScope scope(*this, "DumpGameTables");
+
+    CatalogTableSpec resolved[CatalogLayout::KIND_COUNT];
+    if (!CheckAttached() || !ResolveCatalogSpecs(specs, resolved)) {
+        return false;
+    }
+    if (path == nullptr || path[0] == '\0') {
+        SetLastError("Invalid parameters");
+        return false;
+    }
+    if (!DumpCatalogImage(m_memory.get(), resolved, path)) {
+        SetLastError("Failed to write the table image");
+        return false;
+    }
+    m_lastError.clear();
+    return true;
+}
+
+int Session::GetCatalogEntries(int kind, CatalogEntry* outEntries, int capacity) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    if (kind < 0 || kind >= (int)CatalogLayout::KIND_COUNT) {
+        return 0;
+    }
+    int total = (int)m_catalog.GetCount((CatalogKind)kind);
+    int count = outEntries != nullptr ? std::min(capacity, total) : 0;
+    if (count > 0) {
+        memcpy(outEntries, m_catalog.GetEntries((CatalogKind)kind), (size_t)count * sizeof(CatalogEntry));
+    }
+    return total;
+}
+
+int Session::GetCatalogStrings(char* outBuffer, int capacity) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    const std::vector<char>& strings = m_catalog.GetStrings();
+    int total = (int)strings.size();
+    int count = outBuffer != nullptr ? std::min(capacity, total) : 0;
+    if (count > 0) {
+        memcpy(outBuffer, strings.data(), (size_t)count);
+    }
+    return total;
+}
+
+const char* Session::GetCatalogName(int kind, int32_t id) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    if (kind < 0 || kind >= (int)CatalogLayout::KIND_COUNT) {
+        return nullptr;
+    }
+    const CatalogEntry* entry = m_catalog.Find((CatalogKind)kind, id);
+    return entry != nullptr ? m_catalog.GetName(*entry) : nullptr;
+}
+
+bool Session::LoadRecordLayout(const char* path) {
+    StateScope scope(*this, "LoadRecordLayout");
+
+    if (path == nullptr || path[0] == '\0') {
+        m_recordLayout.Reset();
+    } else {
+        RecordLayout layout;
+        int line = 0;
+        if (!::LoadRecordLayout(path, layout, &line)) {
+            SetLastError(line == 0 ? "Failed to read the record layout file" : "Invalid record layout file");
+            return false;
+        }
+        m_recordLayout = layout;
+    }
+    m_recordPlans.Clear();
+
+    // 快照中的字段是按旧布局读出的
+    m_statePage.Staging().record.validMask = 0;
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::SaveRecordLayout(const char* path) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    if (path == nullptr || path[0] == '\0') {
+        SetLastError("Invalid parameters");
+        return false;
+    }
+    if (!WriteRecordLayout(path, m_recordLayout)) {
+        SetLastError("Failed to write the record layout file");
+        return false;
+    }
+    m_lastError.clear();
+    return true;
+}
+
+int Session::GetRecordLayout(RecordFieldDesc* outFields, int capacity) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    int count = outFields != nullptr ? std::min(capacity, RECORD_FIELD_COUNT) : 0;
+    if (count > 0) {
+        memcpy(outFields, m_recordLayout.GetTable().fields, (size_t)count * sizeof(RecordFieldDesc));
+    }
+    return RECORD_FIELD_COUNT;
+}
+
+bool Session::ApplyAffixPreset(const AffixPreset* preset, const QWORD* bases, int count, int32_t* outResults,
+    PresetApplyStats* outStats) {
+    StateScope scope(*this, "ApplyAffixPreset");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+
+    if (preset == nullptr || bases == nullptr || count <= 0 || count > (int)PresetApplyLayout::MAX_ITEMS ||
+        std::find(bases, bases + count, (QWORD)0) != bases + count) {
+        SetLastError("Invalid parameters");
+        return false;
+    }
+
+    // 信箱中尚未应用的旧批次之后会覆盖当前装备上的这次写入
+    if (!CheckMailboxIdle()) {
+        return false;
+    }
+
+    std::vector<int32_t> results;
+    std::vector<PresetItemEdit> edits;
+    std::vector<uint8_t> editBytes;
+    PresetApplyStats stats;
+    PresetApplyStatus status = ApplyPresetToRecords(m_memory.get(), m_recordLayout.GetTable(),
+        PlanFor(GetPresetFields(*preset)), *preset, bases, (size_t)count, results, edits, editBytes, stats);
+    if (status == PRESET_APPLY_RECORDS_OVERLAP) {
+        SetLastError("Equipment records overlap");
+        return false;
+    }
+
+    StateRecord& snapshot = m_statePage.Staging().record;
+    for (const PresetItemEdit& edit : edits) {
+        const uint8_t* before = editBytes.data() + edit.position;
+        m_journal.Record(edit.base, edit.offset, before, before + edit.size, edit.size);
+        if (snapshot.base == edit.base) {
+            snapshot.validMask = 0;
+        }
+    }
+
+    if (outResults != nullptr) {
+        std::copy(results.begin(), results.end(), outResults);
+    }
+    if (outStats != nullptr) {
+        *outStats = stats;
+    }
+
+    // 部分装备失败时其余装备的改写已经生效并记入日志，结果和统计照常返回
+    switch (status) {
+    case PRESET_APPLY_READ_FAILED:
+        SetLastError("Failed to read equipment records");
+        return false;
+    case PRESET_APPLY_WRITE_FAILED:
+        SetLastError("Failed to write equipment records");
+        return false;
+    case PRESET_APPLY_VERIFY_FAILED:
+        SetLastError("Equipment records changed after writing");
+        return false;
+    default:
+        break;
+    }
+    m_lastError.clear();
+    return true;
+}
+
+int Session::CopyInventoryItems(const std::vector<QWORD>& bases, const std::vector<uint8_t>& records,
+    InventoryItem* outItems, int capacity) {
+    int total = (int)bases.size();
+    int count = outItems != nullptr ? std::min(capacity, total) : 0;
+    auto decode = [this](const uint8_t* record, int field) -> int64_t {
+        const RecordFieldDesc& desc = m_recordLayout.Get(field);
+        return desc.offset + desc.size <= InventoryScanLayout::RECORD_SIZE ? DecodeRecordField(desc, record + desc.offset) : 0;
+    };
+    for (int i = 0; i < count; i++) {
+        const uint8_t* record = records.data() + (size_t)i * InventoryScanLayout::RECORD_SIZE;
+        InventoryItem& item = outItems[i];
+        memset(&item, 0, sizeof(item));
+        item.base = bases[i];
+        item.itemId = (int16_t)decode(record, RECORD_FIELD_ITEM_ID);
+        item.transmogId = (int16_t)decode(record, RECORD_FIELD_TRANSMOG_ID);
+        item.level = (int16_t)decode(record, RECORD_FIELD_LEVEL);
+        item.equipPlusValue = (uint8_t)decode(record, RECORD_FIELD_EQUIP_PLUS_VALUE);
+        item.quality = (int32_t)decode(record, RECORD_FIELD_QUALITY);
+        for (int slot = 0; slot < MemoryLayout::AFFIX_SLOT_COUNT; slot++) {
+            item.affixIds[slot] = (int32_t)decode(record, AffixFieldId(slot, AFFIX_PART_ID));
+            item.affixLevels[slot] = (int32_t)decode(record, AffixFieldId(slot, AFFIX_PART_LEVEL));
+        }
+    }
+    return total;
+}
+
+bool Session::ReadAffix(int slotIndex, int* outId, int* outLevel) {
+    StateScope scope(*this, "ReadAffix");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+
+    if (slotIndex < 0 || slotIndex >= MemoryLayout::AFFIX_SLOT_COUNT) {
+        SetLastError("Invalid slot index");
+        return false;
+    }
+
+    QWORD equipBase = GetActiveEquipmentBase();
+    if (equipBase == 0) {
+        SetLastError("Equipment base address not captured yet");
+        return false;
+    }
+
+    // 词条 ID 和等级
+    int64_t values[RECORD_FIELD_COUNT];
+    if (!ReadRecordFields(equipBase, AffixSlotPlanFor<RecordFieldSets::AFFIX_ID_LEVEL>(slotIndex), values)) {
+        return false;
+    }
+
+    if (outId) *outId = (int)values[AffixFieldId(slotIndex, AFFIX_PART_ID)];
+    if (outLevel) *outLevel = (int)values[AffixFieldId(slotIndex, AFFIX_PART_LEVEL)];
+
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::WriteAffix(int slotIndex, int id, int level) {
+    StateScope scope(*this, "WriteAffix");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+
+    if (slotIndex < 0 || slotIndex >= MemoryLayout::AFFIX_SLOT_COUNT) {
+        SetLastError("Invalid slot index");
+        return false;
+    }
+
+    QWORD equipBase = GetActiveEquipmentBase();
+    if (equipBase == 0) {
+        SetLastError("Equipment base address not captured yet");
+        return false;
+    }
+
+    RecordWrite writes[] = {
+        { AffixFieldId(slotIndex, AFFIX_PART_ID), id },
+        { AffixFieldId(slotIndex, AFFIX_PART_LEVEL), level }
+    };
+    if (!ApplyRecordWrites(equipBase, AffixSlotPlanFor<RecordFieldSets::AFFIX_ID_LEVEL>(slotIndex), writes, 2)) {
+        return false;
+    }
+
+    // 状态页快照中的该槽位已过期
+    SnapshotFor(equipBase).validMask &= ~(StatePageLayout::RECORD_AFFIX_SLOT0_VALID << slotIndex);
+
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::ReadAffixEx(int slotIndex, int* outId, int* outLevel, uint8_t* outPrefixes) {
+    StateScope scope(*this, "ReadAffixEx");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+
+    if (slotIndex < 0 || slotIndex >= MemoryLayout::AFFIX_SLOT_COUNT) {
+        SetLastError("Invalid slot index");
+        return false;
+    }
+
+    QWORD equipBase = GetActiveEquipmentBase();
+    if (equipBase == 0) {
+        SetLastError("Equipment base address not captured yet");
+        return false;
+    }
+
+    // 词条 ID、等级和 4 个前缀字节
+    int64_t values[RECORD_FIELD_COUNT];
+    if (!ReadRecordFields(equipBase, AffixSlotPlanFor<RecordFieldSets::AFFIX_ALL_PARTS>(slotIndex), values)) {
+        return false;
+    }
+
+    int id = (int)values[AffixFieldId(slotIndex, AFFIX_PART_ID)];
+    int level = (int)values[AffixFieldId(slotIndex, AFFIX_PART_LEVEL)];
+    uint8_t prefixes[4];
+    for (int i = 0; i < 4; i++) {
+        prefixes[i] = (uint8_t)values[AffixFieldId(slotIndex, AFFIX_PART_PREFIX1 + i)];
+    }
+
+    if (outId) *outId = id;
+    if (outLevel) *outLevel = level;
+    if (outPrefixes) {
+        for (int i = 0; i < 4; i++) {
+            outPrefixes[i] = prefixes[i];
+        }
+    }
+
+    // 更新状态页快照
+    StateRecord& record = SnapshotFor(equipBase);
+    record.affixes[slotIndex].id = id;
+    record.affixes[slotIndex].level = level;
+    memcpy(record.affixes[slotIndex].prefixes, prefixes, sizeof(prefixes));
+    record.validMask |= StatePageLayout::RECORD_AFFIX_SLOT0_VALID << slotIndex;
+
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::WriteAffixExMasked(int slotIndex, int id, int level, const uint8_t* prefixes, uint32_t fieldMask) {
+    StateScope scope(*this, "WriteAffixExMasked");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+
+    if (slotIndex < 0 || slotIndex >= MemoryLayout::AFFIX_SLOT_COUNT) {
+        SetLastError("Invalid slot index");
+        return false;
+    }
+
+    if (fieldMask == 0) {
+        m_lastError.clear();
+        return true;
+    }
+
+    QWORD equipBase = GetActiveEquipmentBase();
+    if (equipBase == 0) {
+        SetLastError("Equipment base address not captured yet");
+        return false;
+    }
+
+    // fieldMask 的 bit0 为 id、bit1 为 level、bit2..bit5 为 prefix1..prefix4，与 AffixPart 的编号相同
+    uint32_t parts = fieldMask & RecordFieldSets::AFFIX_ALL_PARTS;
+    RecordWrite writes[AFFIX_PART_COUNT];
+    size_t count = 0;
+    for (int part = 0; part < AFFIX_PART_COUNT; part++) {
+        if ((parts & (1u << part)) == 0) {
+            continue;
+        }
+        int64_t value = part == AFFIX_PART_ID ? id : part == AFFIX_PART_LEVEL ? level : prefixes[part - AFFIX_PART_PREFIX1];
+        writes[count++] = { AffixFieldId(slotIndex, part), value };
+    }
+
+    if (count > 0 && !ApplyRecordWrites(equipBase, PlanFor(AffixSlotFields(slotIndex, parts)), writes, count)) {
+        return false;
+    }
+
+    // 状态页快照中的该槽位已过期
+    SnapshotFor(equipBase).validMask &= ~(StatePageLayout::RECORD_AFFIX_SLOT0_VALID << slotIndex);
+
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::ReadEquipmentBasics(
+    short* outItemId,
+    short* outTransmogId,
+    short* outLevel,
+    uint8_t* outEquipPlusValue,
+    int* outQuality,
+    int* outUnderworldSkillId,
+    int* outFamiliarity,
+    bool* outIsUnderworld
+) {
+    StateScope scope(*this, "ReadEquipmentBasics");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+
+    QWORD equipBase = GetActiveEquipmentBase();
+    if (equipBase == 0) {
+        SetLastError("Equipment base address not captured yet");
+        return false;
+    }
+
+    EquipmentType type = GetCurrentType();
+    bool isWeapon = type == EQUIP_TYPE_WEAPON || type == EQUIP_TYPE_UNKNOWN;
+
+    // 基础属性都在记录开头，内置布局下一次读取覆盖全部字段，不再按输出参数逐个读取
+    // 武器独有的字段 (地狱技能ID、爱用度、地狱武器标志) 只对武器读取
+    int64_t values[RECORD_FIELD_COUNT];
+    const RecordPlan& plan = isWeapon
+        ? PlanFor<RecordFieldSets::BASICS | RecordFieldSets::EXTENDED | RecordFieldSets::WEAPON>()
+        : PlanFor<RecordFieldSets::BASICS | RecordFieldSets::EXTENDED>();
+    if (!ReadRecordFields(equipBase, plan, values)) {
+        return false;
+    }
+
+    StateRecord& record = SnapshotFor(equipBase);
+    record.itemId = (short)values[RECORD_FIELD_ITEM_ID];
+    record.transmogId = (short)values[RECORD_FIELD_TRANSMOG_ID];
+    record.level = (short)values[RECORD_FIELD_LEVEL];
+    record.equipPlusValue = (uint8_t)values[RECORD_FIELD_EQUIP_PLUS_VALUE];
+    record.quality = (int)values[RECORD_FIELD_QUALITY];
+    record.validMask |= StatePageLayout::RECORD_BASICS_VALID | StatePageLayout::RECORD_EXTENDED_VALID;
+
+    if (outItemId) *outItemId = record.itemId;
+    if (outTransmogId) *outTransmogId = record.transmogId;
+    if (outLevel) *outLevel = record.level;
+    if (outEquipPlusValue) *outEquipPlusValue = record.equipPlusValue;
+    if (outQuality) *outQuality = record.quality;
+
+    if (isWeapon) {
+        record.underworldSkillId = (int)values[RECORD_FIELD_UNDERWORLD_SKILL_ID];
+        record.familiarity = (int)values[RECORD_FIELD_FAMILIARITY];
+        record.isUnderworld = values[RECORD_FIELD_UNDERWORLD_FLAG] != 0 ? 1 : 0;
+        record.validMask |= StatePageLayout::RECORD_WEAPON_FIELDS_VALID;
+
+        if (outUnderworldSkillId) *outUnderworldSkillId = record.underworldSkillId;
+        if (outFamiliarity) *outFamiliarity = record.familiarity;
+        if (outIsUnderworld) *outIsUnderworld = record.isUnderworld != 0;
+    } else {
+        // 装备模式下，武器独有字段返回默认值
+        if (outUnderworldSkillId) *outUnderworldSkillId = 0;
+        if (outFamiliarity) *outFamiliarity = 0;
+        if (outIsUnderworld) *outIsUnderworld = false;
+    }
+
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::WriteEquipmentBasics(
+    short itemId,
+    short transmogId,
+    short level,
+    bool hasExtended,
+    uint8_t equipPlusValue,
+    int quality,
+    int underworldSkillId,
+    int familiarity,
+    bool isUnderworld
+) {
+    StateScope scope(*this, "WriteEquipmentBasics");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+
+    QWORD equipBase = GetActiveEquipmentBase();
+    if (equipBase == 0) {
+        SetLastError("Equipment base address not captured yet");
+        return false;
+    }
+
+    EquipmentType type = GetCurrentType();
+    bool isWeapon = type == EQUIP_TYPE_WEAPON || type == EQUIP_TYPE_UNKNOWN;
+
+    RecordWrite writes[8];
+    size_t count = 0;
+    uint64_t fields = RecordFieldSets::BASICS;
+
+    // 物品ID / 幻化ID / 等级
+    writes[count++] = { RECORD_FIELD_ITEM_ID, itemId };
+    writes[count++] = { RECORD_FIELD_TRANSMOG_ID, transmogId };
+    writes[count++] = { RECORD_FIELD_LEVEL, level };
+
+    if (hasExtended) {
+        writes[count++] = { RECORD_FIELD_EQUIP_PLUS_VALUE, equipPlusValue };
+        writes[count++] = { RECORD_FIELD_QUALITY, quality };
+        fields |= RecordFieldSets::EXTENDED;
+    }
+
+    // 以下字段只有武器才写入；地狱武器标志只修改该位，其余位保持原值
+    if (isWeapon) {
+        writes[count++] = { RECORD_FIELD_UNDERWORLD_SKILL_ID, underworldSkillId };
+        writes[count++] = { RECORD_FIELD_FAMILIARITY, familiarity };
+        writes[count++] = { RECORD_FIELD_UNDERWORLD_FLAG, isUnderworld ? 1 : 0 };
+        fields |= RecordFieldSets::WEAPON;
+    }
+
+    if (!ApplyRecordWrites(equipBase, PlanFor(fields), writes, count)) {
+        return false;
+    }
+
+    // 状态页快照中的基础属性已过期
+    SnapshotFor(equipBase).validMask &= ~(StatePageLayout::RECORD_BASICS_VALID
+        | StatePageLayout::RECORD_EXTENDED_VALID
+        | StatePageLayout::RECORD_WEAPON_FIELDS_VALID);
+
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::EnableSkillBypass() {
+    StateScope scope(*this, "EnableSkillBypass");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+
+    // 如果已经启用，直接返回成功
+    if (m_skillBypassInjector.IsEnabled()) {
+        return true;
+    }
+
+    // 初始化（如果还没初始化）
+    if (!m_skillBypassInjector.Initialize(m_memory.get())) {
+        SetLastError("Failed to find skill bypass hook points. Game version may be incompatible.");
+        return false;
+    }
+
+    if (!m_skillBypassInjector.Enable()) {
+        SetLastError("Failed to enable skill bypass");
+        return false;
+    }
+
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::DisableSkillBypass() {
+    StateScope scope(*this, "DisableSkillBypass");
+
+    if (!m_skillBypassInjector.IsEnabled()) {
+        return true;
+    }
+
+    if (m_skillBypassInjector.IsForeign()) {
+        SetLastError("Skill bypass site was modified by another program; original code not restored");
+        return false;
+    }
+    if (!m_skillBypassInjector.Disable()) {
+        SetLastError("Failed to disable skill bypass");
+        return false;
+    }
+
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::IsSkillBypassEnabled() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return m_skillBypassInjector.IsEnabled();
+}
+
+const char* Session::GetLastErrorMessage() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return m_lastError.c_str();
+}
+
+void Session::SetTraceFile(const char* path) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_tracePath = path != nullptr ? path : "";
+}
+
+bool Session::UndoEdits(int steps, int* outApplied) {
+    StateScope scope(*this, "UndoEdits");
+
+    if (outApplied) *outApplied = 0;
+
+    if (!CheckAttached()) {
+        return false;
+    }
+
+    QWORD equipBase = GetActiveEquipmentBase();
+    if (equipBase == 0) {
+        SetLastError("Equipment base address not captured yet");
+        return false;
+    }
+
+    // 尚无结果的信箱批次可能还要记入日志
+    if (!CheckMailboxIdle()) {
+        return false;
+    }
+
+    JournalPatch patch;
+    int count = m_journal.PrepareUndo(equipBase, steps, patch);
+    if (count > 0 && !ApplyJournalPatch(equipBase, patch, JOURNAL_ACTION_UNDO, count)) {
+        return false;
+    }
+
+    if (outApplied) *outApplied = count;
+
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::RedoEdits(int steps, int* outApplied) {
+    StateScope scope(*this, "RedoEdits");
+
+    if (outApplied) *outApplied = 0;
+
+    if (!CheckAttached()) {
+        return false;
+    }
+
+    QWORD equipBase = GetActiveEquipmentBase();
+    if (equipBase == 0) {
+        SetLastError("Equipment base address not captured yet");
+        return false;
+    }
+
+    if (!CheckMailboxIdle()) {
+        return false;
+    }
+
+    JournalPatch patch;
+    int count = m_journal.PrepareRedo(equipBase, steps, patch);
+    if (count > 0 && !ApplyJournalPatch(equipBase, patch, JOURNAL_ACTION_REDO, count)) {
+        return false;
+    }
+
+    if (outApplied) *outApplied = count;
+
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::RestoreOriginal() {
+    StateScope scope(*this, "RestoreOriginal");
+
+    if (!CheckAttached()) {
+        return false;
+    }
+
+    QWORD equipBase = GetActiveEquipmentBase();
+    if (equipBase == 0) {
+        SetLastError("Equipment base address not captured yet");
+        return false;
+    }
+
+    if (!CheckMailboxIdle()) {
+        return false;
+    }
+
+    // 恢复本身作为新的一步记入日志，可以再撤销
+    JournalPatch patch;
+    if (m_journal.PrepareRestore(equipBase, patch) && !ApplyJournalPatch(equipBase, patch, JOURNAL_ACTION_RECORD, 0)) {
+        return false;
+    }
+
+    m_lastError.clear();
+    return true;
+}
+
+bool Session::GetEditDepth(int* outUndoDepth, int* outRedoDepth) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    if (!CheckAttached()) {
+        return false;
+    }
+
+    SettleMailbox();
+    QWORD equipBase = GetActiveEquipmentBase();
+    if (outUndoDepth) *outUndoDepth = m_journal.GetUndoDepth(equipBase);
+    if (outRedoDepth) *outRedoDepth = m_journal.GetRedoDepth(equipBase);
+    return true;
+}
+
+void Session::SetJournalLimit(size_t bytes) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_journal.SetMemoryLimit(bytes);
+}
+
+bool Session::EnableJournalFile(const char* path) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    if (!m_journal.OpenFile(path)) {
+        SetLastError("Failed to open journal file");
+        return false;
+    }
+
+    m_lastError.clear();
+    return true;
+}
+
+void Session::DisableJournalFile() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_journal.CloseFile();
+}
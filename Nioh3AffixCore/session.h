@@ -0,0 +1,495 @@
+#pragma once
+
+#include "capture_ring.h"
+#include "code_injector.h"
+#include "counting_process_memory.h"
+#include "edit_journal.h"
+#include "edit_mailbox.h"
+#include "equipment_scan.h"
+#include "field_samples.h"
+#include "game_catalog.h"
+#include "hook_stats.h"
+#include "integrity_monitor.h"
+#include "inventory_layout.h"
+#include "pointer_scan.h"
+#include "preset_apply.h"
+#include "process_memory.h"
+#include "record_layout.h"
+#include "remote_arena.h"
+#include "resident_cave.h"
+#include "skill_bypass_injector.h"
+#include "state_page.h"
+#include "value_scan.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 装备类型枚举
+enum EquipmentType {
+    EQUIP_TYPE_UNKNOWN = 0,
+    EQUIP_TYPE_WEAPON = 1,
+    EQUIP_TYPE_ARMOR = 2
+};
+
+// 捕获到的一件装备 (被游戏处理过的装备记录，按基址去重)
+// 布局与导出函数 SessionGetCapturedItems 共用
+struct CapturedItem {
+    QWORD base;
+    uint64_t lastSequence;  // 最近一次捕获的序号 (捕获环形缓冲区中的全局顺序)
+    uint32_t hitCount;
+    int32_t equipmentType;  // EquipmentType
+    QWORD owner;            // 最近一次捕获到的容器指针 (开启容器捕获后的装备)，0 表示没有
+};
+
+// 背包中的一件装备 (从一次批量读取的记录中解出)
+// 布局与导出函数 SessionReadInventory 共用
+struct InventoryItem {
+    QWORD base;
+    int16_t itemId;
+    int16_t transmogId;
+    int16_t level;
+    uint8_t equipPlusValue;
+    uint8_t reserved;
+    int32_t quality;
+    int32_t affixIds[MemoryLayout::AFFIX_SLOT_COUNT];
+    int32_t affixLevels[MemoryLayout::AFFIX_SLOT_COUNT];
+};
+
+// 捕获 hook 的开销统计
+// 布局与导出函数 SessionGetCaptureStats 共用
+namespace CaptureStatsLayout {
+    constexpr uint32_t FLAG_ONE_SHOT = 1u << 0;         // 单次捕获模式
+    constexpr uint32_t FLAG_WEAPON_HOOKED = 1u << 1;    // 注入点当前处于 hook 状态
+    constexpr uint32_t FLAG_ARMOR_HOOKED = 1u << 2;
+    constexpr uint32_t FLAG_WEAPON_PARKED = 1u << 3;    // 捕获后已自动撤下，等待重新挂上
+    constexpr uint32_t FLAG_ARMOR_PARKED = 1u << 4;
+}
+
+struct CaptureStats {
+    uint64_t weaponHits;        // 消费到的 hook 命中次数
+    uint64_t armorHits;
+    uint64_t lostHits;          // 被覆盖而无法归属的命中
+    uint64_t weaponHookedMs;    // 注入点处于 hook 状态的累计时间
+    uint64_t armorHookedMs;
+    uint32_t rearmCount;        // 重新挂上的次数
+    uint32_t flags;             // CaptureStatsLayout::FLAG_*
+};
+
+// 最近一次附加时对上一次会话留下的常驻 hook 的处理结果
+// 与导出函数 SessionGetResidentState 共用
+enum ResidentState {
+    RESIDENT_NONE = 0,          // 没有找到常驻代码洞 (未开启常驻模式、没有缓存或游戏已重启)
+    RESIDENT_ADOPTED = 1,       // 已接管仍然完好的 hook，不需要再扫描
+    RESIDENT_UNINSTALLED = 2    // 代码洞已不完好，已恢复注入点并清除
+};
+
+// 附加会话
+// 每个会话拥有独立的进程后端、注入器、缓存和锁，多个会话可在不同线程上并发使用而互不争用。
+// 导出函数 (exports.cpp) 只是对会话方法的薄封装。
+class Session {
+public:
+    Session();
+    ~Session();
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    // 进程管理
+    // Attach 接管 memory 的所有权；memory 可以是 Win32 后端，也可以是测试用的假后端
+    bool Attach(std::unique_ptr<ProcessMemory> memory);
+    void Detach();
+    bool IsAttached();
+
+    // Hook 管理
+    bool EnableCapture();
+    void DisableCapture();
+    bool IsCaptureEnabled();
+
+    // 装备类型查询
+    EquipmentType GetCurrentEquipmentType();
+    bool IsWeaponMode();
+
+    // 装备基址
+    QWORD GetEquipmentBase();
+    bool IsWeaponHookEnabled();
+    bool IsArmorHookEnabled();
+    QWORD GetWeaponBase();
+    QWORD GetArmorBase();
+
+    // 捕获数据的传输方式 (见 capture_ring.h): 允许时优先用共享视图，不支持时退回到远程读取
+    // 在下一次分配捕获缓冲区 (附加后首次 EnableCapture) 时生效
+    void SetSharedCapture(bool allow);
+    bool IsCaptureShared();
+
+    // 单次捕获: 开启后每个 hook 捕获到基址即恢复原始代码，游戏热路径上不再有额外开销，
+    // 已捕获的基址保持有效；用户选中新的装备前调用 RearmCapture 重新挂上 (EnableCapture 同样会重新挂上)
+    void SetOneShotCapture(bool enable);
+    bool RearmCapture();
+
+    // hook 命中次数和处于 hook 状态的时间
+    bool GetCaptureStats(CaptureStats* outStats);
+
+    // hook 插桩 (见 hook_stats.h): 开启后之后写入的 hook 代码统计命中次数并采样 rdtsc 耗时分布
+    // 在下一次挂上 hook (EnableCapture / RearmCapture) 时生效，已挂上的 hook 代码不会被改写
+    // equipmentType 为 EQUIP_TYPE_WEAPON 或 EQUIP_TYPE_ARMOR；计数只增不减，调用者按帧取差值
+    void SetHookInstrumentation(bool enable);
+    bool GetHookStats(int equipmentType, HookStats* outStats);
+
+    // 编辑信箱 (见 edit_mailbox.h): 开启后对当前被 hook 捕获的装备的写入不直接写内存，
+    // 而是投递给 hook，由游戏线程在下次处理该装备时应用；默认关闭
+    // GetPendingEdits 返回尚未被应用的写入数 (0 表示已全部应用)，期间新的写入会失败
+    void SetEditMailbox(bool enable);
+    int GetPendingEdits();
+
+    // 常驻 hook (见 resident_cave.h): cachePath 非空时分离会话不恢复捕获 hook，而是把它们和代码洞留在游戏中，
+    // 位置记入 cachePath；之后附加时 (同一路径) 直接接管，不再扫描。为空表示关闭，分离时正常恢复
+    // 常驻模式下捕获数据块都放在代码洞中 (不使用共享视图)，技能绕过不常驻
+    // GetResidentState 返回最近一次附加的接管结果 (ResidentState)
+    void SetResidentHooks(const char* cachePath);
+    int GetResidentState();
+
+    // 补丁完整性检查 (见 integrity_monitor.h)
+    // SetIntegrityInterval 设置自动检查的间隔 (毫秒，0 表示关闭，默认关闭)，到期后在下一次轮询捕获时检查
+    // CheckIntegrity 立即检查一次；GetIntegrityStats 只返回最近一次的结果，不访问目标进程
+    // 被其它程序改写的 hook 不再撤下，分离时代码洞保留
+    void SetIntegrityInterval(uint32_t milliseconds);
+    bool CheckIntegrity(IntegrityStats* outStats);
+    bool GetIntegrityStats(IntegrityStats* outStats);
+
+    // 指针路径扫描 (见 pointer_scan.h)
+    // ScanPointerPaths 对 target (0 表示当前装备) 建反向指针表并搜索，结果写到 outputPath；
+    // 扫描期间持有会话锁，反向指针表在返回前释放。config / outStats 可为空
+    // IntersectPointerPaths 对两次扫描的结果文件求交集 (不需要附加)
+    // ResolvePointerPath 按路径读出地址，可在不挂 hook 的情况下重新定位装备
+    bool ScanPointerPaths(QWORD target, const PointerScanConfig* config, const char* outputPath, PointerScanStats* outStats);
+    bool IntersectPointerPaths(const char* first, const char* second, const char* outputPath, uint64_t* outCount);
+    bool ResolvePointerPath(const PointerPath* path, QWORD* outAddress);
+
+    // 数值扫描 (见 value_scan.h)
+    // FirstScan 扫描全部可写数据区域并替换之前的结果；NextScan 只检查上一次的候选。失败时之前的结果不变
+    // GetScanResults 按地址顺序填充前 capacity 个候选，返回总数 (outResults 为 nullptr 时只返回总数)
+    // 结果只保存在本进程中，分离时丢弃
+    bool FirstScan(const ValueScanQuery* query, ValueScanStats* outStats);
+    bool NextScan(const ValueScanQuery* query, ValueScanStats* outStats);
+    int GetScanResults(ValueScanResult* outResults, int capacity);
+    void ResetScan();
+
+    // 捕获代数 (每次 hook 命中加一)，与上次相同时说明当前装备和类型都没有变化
+    QWORD GetCaptureGeneration();
+
+    // 捕获过的装备列表 (按最近捕获排序)，返回总数，最多填充 capacity 项
+    int GetCapturedItems(CapturedItem* outItems, int capacity);
+    void ClearCapturedItems();
+
+    // 容器捕获 (见 inventory_layout.h): 开启后装备 hook 同时记录容器指针 (r12)，在下一次挂上 hook 时生效
+    // DeriveInventoryLayout 用捕获装备最多的容器推导背包数组布局；ReadInventory 按布局批量读出全部装备
+    // (还没有布局时先推导)，返回装备总数，最多填充 capacity 项，失败返回 -1
+    void SetOwnerCapture(bool enable);
+    bool DeriveInventoryLayout(InventoryLayout* outLayout);
+    int ReadInventory(InventoryItem* outItems, int capacity);
+
+    // 结构扫描 (见 equipment_scan.h): 不依赖 hook，在全部可写数据区域中按布局识别装备记录，
+    // 结果替换上一次的索引；GetScannedEquipment 返回索引中的装备总数，最多填充 capacity 项 (记录内容为扫描时读到的值)
+    // 索引分离时丢弃。config / outStats 可为空
+    bool ScanEquipment(const EquipmentScanConfig* config, EquipmentScanStats* outStats);
+    int GetScannedEquipment(InventoryItem* outItems, int capacity);
+
+    // 字段发现 (见 field_samples.h)
+    // AddFieldSample 读出 base (0 表示当前装备) 开始的 size 字节作为一条样本，labels 为 labelCount 个已知属性；
+    // 同一组样本的 size 和 labelCount 必须相同。样本保存在本进程中，分离后仍保留 (可跨多次附加收集)
+    // Save/LoadFieldSamples 读写列式样本文件 (不需要附加)
+    // AnalyzeFieldSamples 返回候选字段总数，最多填充 capacity 项 (按偏移排序)，没有样本时返回 -1。outStats 可为空
+    bool AddFieldSample(QWORD base, uint32_t size, const int32_t* labels, uint32_t labelCount);
+    bool SaveFieldSamples(const char* path);
+    bool LoadFieldSamples(const char* path);
+    void ClearFieldSamples();
+    int GetFieldSampleCount();
+    int AnalyzeFieldSamples(FieldCandidate* outCandidates, int capacity, FieldAnalysisStats* outStats);
+
+    // 游戏数据表目录 (见 game_catalog.h)
+    // LoadGameCatalog: cachePath 中的缓存与当前游戏版本和表描述都相符时直接读取，否则从游戏内存读出全部表并写入缓存
+    // (所有表都找到时才写入；cachePath 为空表示不使用缓存)。specs 为 KIND_COUNT 项，为空时使用内置的表描述
+    // (读出的表都要通过 game_catalog.h 中的校验，不像数据表时按找不到处理)
+    // 目录在分离后仍保留；GetCatalogEntries 按 ID 升序填充 kind 表的前 capacity 项并返回条目数，
+    // GetCatalogStrings 复制字符串池 (CatalogEntry::nameOffset 指向其中) 并返回池的长度，
+    // GetCatalogName 用完美哈希查找名称 (UTF-8，在下一次载入目录之前有效)，没有或 kind 不是 CatalogKind 时返回 nullptr
+    // DumpGameTables 把读取各表时读到的内存写入 path，供离线解码 (tools/catalog_tool)
+    bool LoadGameCatalog(const char* cachePath, const CatalogTableSpec* specs, CatalogStats* outStats);
+    bool DumpGameTables(const char* path, const CatalogTableSpec* specs);
+    int GetCatalogEntries(int kind, CatalogEntry* outEntries, int capacity);
+    int GetCatalogStrings(char* outBuffer, int capacity);
+    const char* GetCatalogName(int kind, int32_t id);
+
+    // 装备记录布局 (见 record_layout.h)，所有装备字段的读写都按布局编译的计划执行
+    // LoadRecordLayout 载入布局文件 (path 为空时恢复内置布局)，失败时布局不变；SaveRecordLayout 写出当前布局
+    // GetRecordLayout 填充前 capacity 个字段描述 (按 RecordFieldId 编号)，返回字段总数。布局在分离后仍保留
+    bool LoadRecordLayout(const char* path);
+    bool SaveRecordLayout(const char* path);
+    int GetRecordLayout(RecordFieldDesc* outFields, int capacity);
+
+    // 预设批量应用 (见 preset_apply.h): 把 preset 写入 bases 中的 count 件装备，不需要在游戏中逐件选中
+    // outResults 为每件装备的结果 (PresetItemResult，可为空)，outStats 可为空；有装备失败时仍填充两者并记录成功的改写，
+    // 但返回 false，错误信息按第一件失败装备的原因 (读取、写入或读回) 区分
+    // 直接写入内存 (不经过编辑信箱)，每件装备的改写记入该装备自己的编辑日志
+    bool ApplyAffixPreset(const AffixPreset* preset, const QWORD* bases, int count, int32_t* outResults,
+        PresetApplyStats* outStats);
+
+    // 词条读写
+    bool ReadAffix(int slotIndex, int* outId, int* outLevel);
+    bool WriteAffix(int slotIndex, int id, int level);
+    bool ReadAffixEx(int slotIndex, int* outId, int* outLevel, uint8_t* outPrefixes);
+    bool WriteAffixExMasked(int slotIndex, int id, int level, const uint8_t* prefixes, uint32_t fieldMask);
+
+    // 装备基础属性读写
+    // outEquipPlusValue / outQuality 为空时不读取 (对应非 Ex 版本)
+    bool ReadEquipmentBasics(
+        short* outItemId,
+        short* outTransmogId,
+        short* outLevel,
+        uint8_t* outEquipPlusValue,
+        int* outQuality,
+        int* outUnderworldSkillId,
+        int* outFamiliarity,
+        bool* outIsUnderworld
+    );
+
+    // hasExtended 为 false 时不写 equipPlusValue / quality (对应非 Ex 版本)
+    bool WriteEquipmentBasics(
+        short itemId,
+        short transmogId,
+        short level,
+        bool hasExtended,
+        uint8_t equipPlusValue,
+        int quality,
+        int underworldSkillId,
+        int familiarity,
+        bool isUnderworld
+    );
+
+    // 技能学习条件绕过
+    bool EnableSkillBypass();
+    bool DisableSkillBypass();
+    bool IsSkillBypassEnabled();
+
+    // 最后一次错误信息 (指针在下一次调用本会话之前有效)
+    const char* GetLastErrorMessage();
+
+    // 共享状态页 (见 state_page.h)
+    bool EnableStatePage(const char* name);
+    void DisableStatePage();
+
+    // 远程操作跟踪 (见 tracing_process_memory.h)，在下一次 Attach 时生效；path 为空表示关闭
+    void SetTraceFile(const char* path);
+
+    // 编辑日志 (见 edit_journal.h)，作用于当前装备
+    // outApplied 返回实际撤销/重做的步数，可为空
+    bool UndoEdits(int steps, int* outApplied);
+    bool RedoEdits(int steps, int* outApplied);
+    bool RestoreOriginal();
+    bool GetEditDepth(int* outUndoDepth, int* outRedoDepth);
+    void SetJournalLimit(size_t bytes);
+    bool EnableJournalFile(const char* path);
+    void DisableJournalFile();
+
+private:
+    // 持有会话锁，退出作用域时 (仍在锁内) 发布状态页
+    // phase 为当前操作名，转发给后端 (跟踪层据此划分阶段)
+    class StateScope {
+    public:
+        StateScope(Session& session, const char* phase) : m_session(session), m_lock(session.m_mutex) {
+            if (session.m_memory != nullptr) {
+                session.m_memory->MarkPhase(phase);
+            }
+        }
+        ~StateScope() { m_session.PublishState(); }
+
+    private:
+        Session& m_session;
+        std::lock_guard<std::recursive_mutex> m_lock;
+    };
+
+    std::recursive_mutex m_mutex;
+    std::string m_lastError;
+
+    // 后端必须先于注入器声明，保证注入器析构时后端仍然有效
+    // Attach 时用计数装饰器包装，计数发布到状态页
+    std::unique_ptr<CountingProcessMemory> m_memory;
+    RemoteArena m_arena;                        // 所有注入器共用的代码洞 (先于注入器声明，后于其析构)
+    CaptureRing m_captureRing;                  // 所有捕获 hook 共用的环形缓冲区 (位于代码洞数据区)
+    EditMailbox m_editMailbox;                  // 所有捕获 hook 共用的编辑信箱
+    HookStatsBlock m_hookStats;                 // 插桩 hook 的命中统计 (开启插桩后分配)
+    CodeInjector m_weaponInjector;              // 武器Hook
+    CodeInjector m_armorInjector;               // 装备Hook
+    SkillBypassInjector m_skillBypassInjector;  // 技能学习条件绕过
+
+    // 从捕获环形缓冲区消费到的最新状态，最后一条记录的来源决定当前装备类型
+    QWORD m_lastWeaponBase;
+    QWORD m_lastArmorBase;
+    EquipmentType m_lastCaptureType;
+    std::vector<CaptureEvent> m_captureEvents;  // 消费缓冲 (复用)
+
+    // 捕获过的装备 (基址 -> 记录)，超过上限时淘汰最久未捕获的
+    static constexpr size_t MAX_CAPTURED_ITEMS = 1024;
+    std::unordered_map<QWORD, CapturedItem> m_capturedItems;
+
+    // 共享状态页
+    StatePagePublisher m_statePage;
+    StatePageBody m_publishedState;
+
+    // 编辑日志
+    EditJournal m_journal;
+
+    // 跟踪文件路径 (Attach 时使用)
+    std::string m_tracePath;
+
+    // 是否允许用共享视图传输捕获数据
+    bool m_allowSharedCapture;
+
+    // 是否通过编辑信箱写入当前装备
+    bool m_useEditMailbox;
+
+    // 投递到信箱的写入对应的日志操作: hook 应用后才记入日志，撤回时丢弃
+    enum JournalActionKind {
+        JOURNAL_ACTION_RECORD,
+        JOURNAL_ACTION_UNDO,
+        JOURNAL_ACTION_REDO
+    };
+    struct JournalAction {
+        JournalActionKind kind;
+        QWORD base;
+        uint32_t offset;                        // RECORD: 前像/后像相对基址的偏移
+        int steps;                              // UNDO/REDO: 步数
+        std::vector<uint8_t> before;
+        std::vector<uint8_t> after;
+    };
+    std::vector<JournalAction> m_mailboxJournal;
+    bool m_editsWithdrawn;                      // 最近一批信箱写入被撤回 (发布到状态页，下一次投递时清除)
+
+    // 是否在装备 hook 中记录容器指针，以及推导出的背包布局 (arrayKind 为 NONE 表示还没有)
+    bool m_captureOwners;
+    InventoryLayout m_inventoryLayout;
+    std::vector<QWORD> m_inventoryBases;        // 批量读取的缓冲 (复用)
+    std::vector<uint8_t> m_inventoryRecords;
+
+    // 最近一次结构扫描找到的装备 (按地址升序)
+    std::vector<QWORD> m_scannedBases;
+    std::vector<uint8_t> m_scannedRecords;
+
+    // 字段发现的样本
+    FieldSampleSet m_fieldSamples;
+
+    // 游戏数据表目录
+    GameCatalog m_catalog;
+
+    // 装备记录布局和运行期编译的计划 (布局变化时清空)
+    RecordLayout m_recordLayout;
+    RecordPlanCache m_recordPlans;
+    std::vector<uint8_t> m_recordBuffer;        // 按计划读取的缓冲 (复用)
+
+    // 常驻 hook 的缓存文件路径 (为空表示关闭) 和最近一次附加的接管结果
+    std::string m_residentCachePath;
+    ResidentState m_residentState;
+
+    // 每个捕获 hook 的单次捕获状态和统计
+    struct HookCaptureState {
+        bool parked = false;                // 捕获后已自动撤下 (基址仍有效，可重新挂上)
+        bool capturedSinceArm = false;      // 本次挂上后是否已捕获到基址
+        uint64_t hits = 0;
+    };
+
+    // 补丁完整性检查
+    uint32_t m_integrityIntervalMs;
+    std::chrono::steady_clock::time_point m_lastIntegrityCheck;
+    IntegrityStats m_integrityStats;
+
+    // 数值扫描的候选
+    ValueScanner m_valueScanner;
+
+    bool m_instrumentHooks;
+    bool m_oneShotCapture;
+    HookCaptureState m_weaponCapture;
+    HookCaptureState m_armorCapture;
+    uint32_t m_rearmCount;
+
+    void SetLastError(const char* msg);
+    void ResetCaptureCache();
+
+    // specs 为空时填入内置的表描述；有不合法的表描述时设置错误并返回 false
+    bool ResolveCatalogSpecs(const CatalogTableSpec* specs, CatalogTableSpec* outSpecs);
+
+    // 把 bases / records (每件 RECORD_SIZE 字节) 按记录布局解为 InventoryItem，最多填充 capacity 项，返回总数
+    // 超出 RECORD_SIZE 的字段解为 0
+    int CopyInventoryItems(const std::vector<QWORD>& bases, const std::vector<uint8_t>& records,
+        InventoryItem* outItems, int capacity);
+
+    // 字段集合的读写计划: 布局为内置布局时使用编译期生成的计划，否则使用缓存的计划
+    template <uint64_t Fields>
+    const RecordPlan& PlanFor() {
+        return m_recordLayout.IsDefault() ? DefaultRecordPlan<Fields>::plan : m_recordPlans.Get(m_recordLayout, Fields);
+    }
+    template <uint32_t Parts>
+    const RecordPlan& AffixSlotPlanFor(int slotIndex) {
+        return m_recordLayout.IsDefault() ? DefaultAffixSlotPlans<Parts>::plans[slotIndex]
+                                          : m_recordPlans.Get(m_recordLayout, AffixSlotFields(slotIndex, Parts));
+    }
+    const RecordPlan& PlanFor(uint64_t fields) { return m_recordPlans.Get(m_recordLayout, fields); }
+
+    // 以下函数要求调用者已持有 m_mutex
+    bool PollCaptures();
+    void MaybeCheckIntegrity();
+    void RunIntegrityCheck();
+    bool HasForeignHooks() const { return m_weaponInjector.IsForeign() || m_armorInjector.IsForeign(); }
+    void ParkCapturedHooks();
+    bool RearmParkedHooks();
+    void ApplyHookInstrumentation();
+    bool DeriveInventoryLayoutLocked();
+    bool IsWeaponCaptureActive() const { return m_weaponInjector.IsEnabled() || m_weaponCapture.parked; }
+    bool IsArmorCaptureActive() const { return m_armorInjector.IsEnabled() || m_armorCapture.parked; }
+    void RecordCapturedItem(const CaptureEvent& event, EquipmentType type);
+    QWORD GetActiveEquipmentBase();
+    EquipmentType GetCurrentType();
+    EquipmentType ResolveType() const;
+    bool CheckAttached();
+    bool EnsureArena();
+    bool AllowSharedBlocks() const { return m_allowSharedCapture && m_residentCachePath.empty(); }
+    bool RestorePatches(bool includeSkillBypass);
+
+    // 常驻 hook: 附加时按缓存接管或清除上一次留下的代码洞，分离时写入头部和缓存
+    void AdoptResidentHooks();
+    bool AdoptResidentCave(const ResidentCaveHeader& header);
+    void UninstallResidentCave(QWORD headerAddress, const ResidentCaveHeader& header, const ResidentHookState* states);
+    bool LeaveHooksResident();
+    StateRecord& SnapshotFor(QWORD base);
+    void PublishState();
+
+    // 信箱中有尚无结果的批次时设置错误并返回 false
+    bool CheckMailboxIdle();
+    bool UsesEditMailbox(QWORD base);
+
+    // 信箱批次有结果后处理等待中的日志操作；撤回时设置错误
+    void SettleMailbox();
+
+    // hook 都不再执行时撤回信箱中的批次
+    void CancelMailbox();
+
+    // 写回装备记录的一段字节: 基址是 hook 正在捕获的装备且开启了信箱时投递给 hook (outPosted 为 true)，否则直接写入
+    // bitMasks 标出每个字节中需要改写的位；直接写入时只写掩码非零的字节段，段之间的字节不写回
+    bool CommitEquipmentBytes(QWORD base, uint32_t offset, const uint8_t* bytes, const uint8_t* bitMasks, size_t size,
+        bool& outPosted);
+
+    // 写入成功后的日志操作: 直接写入时立即执行，投递到信箱时等 hook 应用后执行
+    void CommitJournalAction(JournalAction action, bool posted);
+    void ApplyJournalAction(const JournalAction& action);
+
+    // 按计划读出字段，outValues 以字段编号为下标 (只填写计划中的字段)
+    bool ReadRecordFields(QWORD base, const RecordPlan& plan, int64_t* outValues);
+
+    // 按计划读出覆盖所有字段的区间，每个区间记入日志后一次写回变化的部分 (writes 中的字段都必须在计划中)
+    bool ApplyRecordWrites(QWORD base, const RecordPlan& plan, const RecordWrite* writes, size_t count);
+    // 写入日志合成的补丁，写入成功后执行 kind 对应的日志操作 (RECORD 把这次写入作为新的一步)
+    bool ApplyJournalPatch(QWORD base, const JournalPatch& patch, JournalActionKind kind, int steps);
+};
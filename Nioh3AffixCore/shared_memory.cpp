@@ -0,0 +1,204 @@
+#include "shared_memory.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+SharedMemory::SharedMemory()
+    : m_handle(-1)
+    , m_data(nullptr)
+    , m_size(0)
+    , m_owner(false)
+{
+}
+
+SharedMemory::~SharedMemory() {
+    Close();
+}
+
+bool SharedMemory::Create(const char* name, size_t size) {
+    return Map(name, size, true, true);
+}
+
+bool SharedMemory::Open(const char* name, size_t size, bool writable) {
+    return Map(name, size, false, writable);
+}
+
+#ifdef _WIN32
+
+bool SharedMemory::Map(const char* name, size_t size, bool create, bool writable) {
+    Close();
+
+    HANDLE mapping;
+    if (create) {
+        mapping = CreateFileMappingA(
+            INVALID_HANDLE_VALUE,
+            nullptr,
+            PAGE_READWRITE,
+            (DWORD)((uint64_t)size >> 32),
+            (DWORD)((uint64_t)size & 0xFFFFFFFF),
+            name
+        );
+    } else {
+        mapping = OpenFileMappingA(writable ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, FALSE, name);
+    }
+    if (mapping == nullptr) {
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, writable ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, size);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    m_handle = (intptr_t)mapping;
+    m_data = view;
+    m_size = size;
+    m_name = name;
+    m_owner = create;
+    return true;
+}
+
+bool SharedMemory::CreateAnonymous(size_t size) {
+    Close();
+
+    HANDLE mapping = CreateFileMappingA(
+        INVALID_HANDLE_VALUE,
+        nullptr,
+        PAGE_READWRITE,
+        (DWORD)((uint64_t)size >> 32),
+        (DWORD)((uint64_t)size & 0xFFFFFFFF),
+        nullptr
+    );
+    if (mapping == nullptr) {
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    m_handle = (intptr_t)mapping;
+    m_data = view;
+    m_size = size;
+    m_owner = false;
+    return true;
+}
+
+void SharedMemory::Close() {
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+        m_data = nullptr;
+    }
+    if (m_handle != -1) {
+        CloseHandle((HANDLE)m_handle);
+        m_handle = -1;
+    }
+    m_size = 0;
+    m_name.clear();
+    m_owner = false;
+}
+
+#else
+
+bool SharedMemory::Map(const char* name, size_t size, bool create, bool writable) {
+    Close();
+
+    std::string posixName = name;
+    if (posixName.empty() || posixName[0] != '/') {
+        posixName.insert(posixName.begin(), '/');
+    }
+
+    int flags = writable ? O_RDWR : O_RDONLY;
+    if (create) {
+        flags |= O_CREAT;
+    }
+    int fd = shm_open(posixName.c_str(), flags, 0600);
+    if (fd < 0) {
+        return false;
+    }
+
+    if (create && ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        shm_unlink(posixName.c_str());
+        return false;
+    }
+
+    int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* view = mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        close(fd);
+        if (create) shm_unlink(posixName.c_str());
+        return false;
+    }
+
+    m_handle = fd;
+    m_data = view;
+    m_size = size;
+    m_name = posixName;
+    m_owner = create;
+    return true;
+}
+
+bool SharedMemory::CreateAnonymous(size_t size) {
+    Close();
+
+    int fd = -1;
+#ifdef SYS_memfd_create
+    fd = (int)syscall(SYS_memfd_create, "nioh3-shared", 1u /* MFD_CLOEXEC */);
+#endif
+    if (fd < 0) {
+        // 没有 memfd 时退回到立即解除链接的 shm_open 对象
+        std::string name = "/nioh3-shared-" + std::to_string((long)getpid()) + "-" + std::to_string((uintptr_t)this);
+        fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            return false;
+        }
+        shm_unlink(name.c_str());
+    }
+
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    m_handle = fd;
+    m_data = view;
+    m_size = size;
+    m_owner = false;
+    return true;
+}
+
+void SharedMemory::Close() {
+    if (m_data != nullptr) {
+        munmap(m_data, m_size);
+        m_data = nullptr;
+    }
+    if (m_handle != -1) {
+        close((int)m_handle);
+        m_handle = -1;
+    }
+    if (m_owner && !m_name.empty()) {
+        shm_unlink(m_name.c_str());
+    }
+    m_size = 0;
+    m_name.clear();
+    m_owner = false;
+}
+
+#endif
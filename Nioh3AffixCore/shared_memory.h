@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 命名共享内存映射
+// Windows: 页面文件支持的 CreateFileMapping 节 (名称如 "Local\\Nioh3AffixCore.State")
+// POSIX:   shm_open 对象 (名称会自动补上前导 '/')
+// 匿名映射 (CreateAnonymous) 没有名称，通过句柄共享给其他进程:
+// Windows 为无名节 (可用 MapViewOfFile2 映射进目标进程)，Linux 为 memfd (可随 fork 继承或经 SCM_RIGHTS 传递)
+class SharedMemory {
+public:
+    SharedMemory();
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    // 创建 (或打开已存在的) 可读写映射
+    bool Create(const char* name, size_t size);
+
+    // 打开已存在的映射
+    bool Open(const char* name, size_t size, bool writable);
+
+    // 创建匿名可读写映射
+    bool CreateAnonymous(size_t size);
+
+    // 解除映射并关闭句柄；创建者会在 POSIX 下移除对象名称
+    void Close();
+
+    void* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+    const std::string& GetName() const { return m_name; }
+
+    // Windows 节句柄或 POSIX 文件描述符，未打开时为 -1
+    intptr_t GetNativeHandle() const { return m_handle; }
+
+private:
+    intptr_t m_handle;   // Windows 节句柄或 POSIX 文件描述符
+    void* m_data;
+    size_t m_size;
+    std::string m_name;
+    bool m_owner;
+
+    bool Map(const char* name, size_t size, bool create, bool writable);
+};
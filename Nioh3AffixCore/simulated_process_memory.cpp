@@ -0,0 +1,360 @@
+#include "simulated_process_memory.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+    constexpr QWORD ALLOCATION_GRANULARITY = 0x10000;
+    constexpr QWORD USER_SPACE_END = 0x7FFFFFFF0000ull;
+    constexpr QWORD DEFAULT_ALLOCATION_START = 0x10000000000ull;
+
+    void SpinFor(uint32_t nanoseconds) {
+        if (nanoseconds == 0) {
+            return;
+        }
+        auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(nanoseconds);
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    }
+}
+
+SimulatedProcessMemory::SimulatedProcessMemory()
+    : m_moduleBase(0)
+    , m_moduleSize(0)
+    , m_allocationCount(0)
+{
+    memset(m_latency, 0, sizeof(m_latency));
+    memset(m_opCounts, 0, sizeof(m_opCounts));
+}
+
+void SimulatedProcessMemory::AddRegion(const MemoryRegion& region) {
+    if (region.state == MemState::Free || region.regionSize == 0) {
+        return;
+    }
+    if (Overlaps(region.baseAddress, region.regionSize)) {
+        return;
+    }
+    m_regions[region.baseAddress] = region;
+}
+
+void SimulatedProcessMemory::SetBytes(QWORD address, const void* data, size_t size, bool onlyIfUnknown) {
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    size_t done = 0;
+    while (done < size) {
+        QWORD addr = address + done;
+        Page& page = m_pages[addr & ~(PAGE_SIZE - 1)];
+        size_t offset = (size_t)(addr & (PAGE_SIZE - 1));
+        size_t chunk = std::min((size_t)PAGE_SIZE - offset, size - done);
+        for (size_t i = offset; i < offset + chunk; i++) {
+            uint64_t bit = 1ull << (i % 64);
+            if (onlyIfUnknown && (page.known[i / 64] & bit) != 0) {
+                continue;
+            }
+            page.bytes[i] = src[done + (i - offset)];
+            page.known[i / 64] |= bit;
+        }
+        done += chunk;
+    }
+}
+
+void SimulatedProcessMemory::SetMainModule(QWORD baseAddress, QWORD moduleSize) {
+    m_moduleBase = baseAddress;
+    m_moduleSize = moduleSize;
+}
+
+void SimulatedProcessMemory::SetLatency(TraceOp op, uint32_t nanoseconds) {
+    m_latency[(int)op] = nanoseconds;
+}
+
+void SimulatedProcessMemory::ResetOpCounts() {
+    memset(m_opCounts, 0, sizeof(m_opCounts));
+}
+
+void SimulatedProcessMemory::LoadFromTrace(const std::vector<TraceRecord>& records) {
+    // 跟踪期间由核心分配的区域
+    std::vector<std::pair<QWORD, QWORD>> allocated;
+    for (const TraceRecord& record : records) {
+        if (record.op == TraceOp::Allocate && record.ok && record.payload.size() == sizeof(uint64_t)) {
+            QWORD result = 0;
+            memcpy(&result, record.payload.data(), sizeof(result));
+            allocated.emplace_back(result, (record.size + ALLOCATION_GRANULARITY - 1) & ~(ALLOCATION_GRANULARITY - 1));
+        }
+    }
+
+    m_seeds.assign(allocated.size(), AllocationSeed());
+
+    // 返回所在分配的下标，不在任何分配中时返回 -1
+    auto findAllocation = [&](QWORD address) -> int {
+        for (size_t i = 0; i < allocated.size(); i++) {
+            if (address >= allocated[i].first && address < allocated[i].first + allocated[i].second) {
+                return (int)i;
+            }
+        }
+        return -1;
+    };
+    auto isAllocated = [&](QWORD address) { return findAllocation(address) >= 0; };
+
+    for (const TraceRecord& record : records) {
+        switch (record.op) {
+        case TraceOp::Query:
+            if (record.ok && record.payload.size() == sizeof(TraceRegion)) {
+                TraceRegion traced;
+                memcpy(&traced, record.payload.data(), sizeof(traced));
+                if (!isAllocated(traced.baseAddress)) {
+                    MemoryRegion region;
+                    region.baseAddress = traced.baseAddress;
+                    region.regionSize = traced.regionSize;
+                    region.state = traced.state;
+                    region.protect = traced.protect;
+                    region.type = traced.type;
+                    AddRegion(region);
+                }
+            }
+            break;
+
+        case TraceOp::Read: {
+            int allocation = findAllocation(record.address);
+            if (allocation >= 0) {
+                if (!record.ok) {
+                    break;
+                }
+                auto key = std::make_pair(record.address - allocated[allocation].first, record.size);
+                std::vector<std::vector<uint8_t>>& contents = m_seeds[allocation].reads[key];
+                if (record.sameAsLast && !contents.empty()) {
+                    contents.push_back(contents.back());
+                } else if (!record.sameAsLast) {
+                    contents.push_back(record.payload);
+                }
+            } else if (!record.sameAsLast && !record.payload.empty()) {
+                SetBytes(record.address, record.payload.data(), record.payload.size(), true);
+            }
+            break;
+        }
+
+        case TraceOp::GetMainModule:
+            if (record.ok && record.payload.size() == 2 * sizeof(uint64_t)) {
+                uint64_t module[2];
+                memcpy(module, record.payload.data(), sizeof(module));
+                SetMainModule(module[0], module[1]);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+const MemoryRegion* SimulatedProcessMemory::FindRegion(QWORD address) const {
+    auto it = m_regions.upper_bound(address);
+    if (it == m_regions.begin()) {
+        return nullptr;
+    }
+    --it;
+    if (address < it->second.baseAddress + it->second.regionSize) {
+        return &it->second;
+    }
+    return nullptr;
+}
+
+bool SimulatedProcessMemory::Overlaps(QWORD address, QWORD size) const {
+    auto it = m_regions.lower_bound(address);
+    if (it != m_regions.end() && it->first < address + size) {
+        return true;
+    }
+    return FindRegion(address) != nullptr;
+}
+
+void SimulatedProcessMemory::ApplySeed(QWORD address, size_t size) {
+    if (m_seedByBase.empty()) {
+        return;
+    }
+
+    auto it = m_seedByBase.upper_bound(address);
+    if (it == m_seedByBase.begin()) {
+        return;
+    }
+    --it;
+
+    const MemoryRegion* region = FindRegion(it->first);
+    if (region == nullptr || address >= it->first + region->regionSize) {
+        return;
+    }
+
+    AllocationSeed& seed = m_seeds[it->second];
+    auto key = std::make_pair(address - it->first, (QWORD)size);
+    auto contents = seed.reads.find(key);
+    if (contents == seed.reads.end() || contents->second.empty()) {
+        return;
+    }
+
+    size_t& cursor = seed.cursors[key];
+    const std::vector<uint8_t>& content = contents->second[std::min(cursor, contents->second.size() - 1)];
+    cursor++;
+    SetBytes(address, content.data(), content.size());
+}
+
+void SimulatedProcessMemory::Account(TraceOp op) {
+    m_opCounts[(int)op]++;
+    SpinFor(m_latency[(int)op]);
+}
+
+bool SimulatedProcessMemory::Read(QWORD address, void* buffer, size_t size, size_t* bytesRead) {
+    Account(TraceOp::Read);
+    ApplySeed(address, size);
+
+    uint8_t* dst = static_cast<uint8_t*>(buffer);
+    size_t done = 0;
+    while (done < size) {
+        QWORD addr = address + done;
+        QWORD pageAddr = addr & ~(PAGE_SIZE - 1);
+        size_t offset = (size_t)(addr - pageAddr);
+        size_t chunk = std::min((size_t)PAGE_SIZE - offset, size - done);
+
+        auto page = m_pages.find(pageAddr);
+        const MemoryRegion* region = FindRegion(addr);
+        bool readable = region != nullptr
+            ? region->state == MemState::Commit && MemProtect::IsReadable(region->protect)
+            : page != m_pages.end();
+        if (!readable) {
+            break;
+        }
+
+        if (page != m_pages.end()) {
+            memcpy(dst + done, page->second.bytes + offset, chunk);
+        } else {
+            memset(dst + done, 0, chunk);
+        }
+        done += chunk;
+    }
+
+    if (bytesRead) *bytesRead = done;
+    return done == size;
+}
+
+bool SimulatedProcessMemory::Write(QWORD address, const void* buffer, size_t size) {
+    Account(TraceOp::Write);
+
+    // 只检查首字节所在区域，与跨进程写入的常见失败模式一致即可
+    const MemoryRegion* region = FindRegion(address);
+    if (region != nullptr && region->state != MemState::Commit) {
+        return false;
+    }
+    if (region == nullptr && m_pages.find(address & ~(PAGE_SIZE - 1)) == m_pages.end()) {
+        return false;
+    }
+
+    SetBytes(address, buffer, size);
+    return true;
+}
+
+bool SimulatedProcessMemory::Query(QWORD address, MemoryRegion& outRegion) {
+    Account(TraceOp::Query);
+
+    const MemoryRegion* region = FindRegion(address);
+    if (region != nullptr) {
+        outRegion = *region;
+        return true;
+    }
+
+    if (address >= USER_SPACE_END) {
+        return false;
+    }
+
+    // 未知地址视为空闲，区域延伸到下一个已知区域
+    QWORD start = address & ~(PAGE_SIZE - 1);
+    auto next = m_regions.upper_bound(address);
+    QWORD end = next == m_regions.end() ? USER_SPACE_END : next->first;
+    outRegion.baseAddress = start;
+    outRegion.regionSize = end - start;
+    outRegion.state = MemState::Free;
+    outRegion.protect = MemProtect::NoAccess;
+    outRegion.type = 0;
+    return true;
+}
+
+bool SimulatedProcessMemory::Protect(QWORD address, size_t size, uint32_t newProtect, uint32_t* oldProtect) {
+    Account(TraceOp::Protect);
+    (void)size;
+
+    // 简化: 修改整个区域的保护属性
+    auto it = m_regions.upper_bound(address);
+    if (it != m_regions.begin()) {
+        --it;
+        if (address < it->first + it->second.regionSize) {
+            if (oldProtect) *oldProtect = it->second.protect;
+            it->second.protect = newProtect;
+            return true;
+        }
+    }
+
+    if (m_pages.find(address & ~(PAGE_SIZE - 1)) != m_pages.end()) {
+        if (oldProtect) *oldProtect = MemProtect::ReadWrite;
+        return true;
+    }
+    return false;
+}
+
+QWORD SimulatedProcessMemory::Allocate(QWORD preferredAddress, size_t size, uint32_t protect) {
+    Account(TraceOp::Allocate);
+
+    QWORD regionSize = (size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+    if (regionSize == 0) {
+        return 0;
+    }
+
+    QWORD address = preferredAddress & ~(ALLOCATION_GRANULARITY - 1);
+    if (preferredAddress != 0) {
+        if (Overlaps(address, regionSize)) {
+            return 0;
+        }
+    } else {
+        address = DEFAULT_ALLOCATION_START;
+        while (Overlaps(address, regionSize)) {
+            address += ALLOCATION_GRANULARITY;
+            if (address + regionSize > USER_SPACE_END) {
+                return 0;
+            }
+        }
+    }
+
+    MemoryRegion region;
+    region.baseAddress = address;
+    region.regionSize = regionSize;
+    region.state = MemState::Commit;
+    region.protect = protect;
+    region.type = MemType::Private;
+    m_regions[address] = region;
+
+    if (m_allocationCount < m_seeds.size()) {
+        m_seedByBase[address] = m_allocationCount;
+    }
+    m_allocationCount++;
+    return address;
+}
+
+bool SimulatedProcessMemory::Free(QWORD address) {
+    Account(TraceOp::Free);
+
+    auto it = m_regions.find(address);
+    if (it == m_regions.end()) {
+        return false;
+    }
+
+    QWORD end = it->first + it->second.regionSize;
+    m_pages.erase(m_pages.lower_bound(address), m_pages.lower_bound(end));
+    m_regions.erase(it);
+    m_seedByBase.erase(address);
+    return true;
+}
+
+bool SimulatedProcessMemory::GetMainModule(QWORD& baseAddress, QWORD& moduleSize) {
+    Account(TraceOp::GetMainModule);
+
+    if (m_moduleSize == 0) {
+        return false;
+    }
+    baseAddress = m_moduleBase;
+    moduleSize = m_moduleSize;
+    return true;
+}
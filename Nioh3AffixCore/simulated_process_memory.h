@@ -0,0 +1,66 @@
+#pragma once
+
+#include "memory_trace.h"
+#include "process_memory.h"
+#include <map>
+#include <vector>
+
+// 内存中模拟的目标进程地址空间
+// 可从跟踪文件重建 (区域取首次 Query 结果，内容取首次读到的字节)，用于在没有游戏进程的机器上
+// 回放附加/捕获流程并比较扫描器、批量读写等改动的远程操作次数和耗时。
+// SetLatency 可为每类操作加上忙等延迟，近似真实跨进程调用的开销。
+class SimulatedProcessMemory : public ProcessMemory {
+public:
+    static constexpr QWORD PAGE_SIZE = 0x1000;
+
+    SimulatedProcessMemory();
+
+    // 构建地址空间
+    void AddRegion(const MemoryRegion& region);
+    void SetBytes(QWORD address, const void* data, size_t size, bool onlyIfUnknown = false);
+    void SetMainModule(QWORD baseAddress, QWORD moduleSize);
+    void SetLatency(TraceOp op, uint32_t nanoseconds);
+
+    // 用跟踪记录重建初始状态 (不套用其中的写入；跟踪期间分配的区域留给回放时重新分配)
+    // 跟踪中对分配区域的读取 (如 hook 写入的基址变量) 按分配顺序和偏移映射到回放时的新分配上，
+    // 回放读到同一偏移时依次返回录制的内容，模拟游戏线程执行 hook 的效果
+    void LoadFromTrace(const std::vector<TraceRecord>& records);
+
+    uint64_t GetOpCount(TraceOp op) const { return m_opCounts[(int)op]; }
+    void ResetOpCounts();
+
+    bool Read(QWORD address, void* buffer, size_t size, size_t* bytesRead = nullptr) override;
+    bool Write(QWORD address, const void* buffer, size_t size) override;
+    bool Query(QWORD address, MemoryRegion& outRegion) override;
+    bool Protect(QWORD address, size_t size, uint32_t newProtect, uint32_t* oldProtect) override;
+    QWORD Allocate(QWORD preferredAddress, size_t size, uint32_t protect) override;
+    bool Free(QWORD address) override;
+    bool GetMainModule(QWORD& baseAddress, QWORD& moduleSize) override;
+
+private:
+    // 一次分配中各偏移被读到的内容序列
+    struct AllocationSeed {
+        std::map<std::pair<QWORD, QWORD>, std::vector<std::vector<uint8_t>>> reads;   // (offset, size) -> 内容
+        std::map<std::pair<QWORD, QWORD>, size_t> cursors;
+    };
+
+    struct Page {
+        uint8_t bytes[PAGE_SIZE];
+        uint64_t known[PAGE_SIZE / 64];     // 已知字节位图
+    };
+
+    std::map<QWORD, MemoryRegion> m_regions;     // 按基址排序，互不重叠
+    std::map<QWORD, Page> m_pages;
+    QWORD m_moduleBase;
+    QWORD m_moduleSize;
+    uint32_t m_latency[TRACE_OP_COUNT];
+    uint64_t m_opCounts[TRACE_OP_COUNT];
+    std::vector<AllocationSeed> m_seeds;        // 按跟踪中的分配顺序
+    std::map<QWORD, size_t> m_seedByBase;       // 回放分配基址 -> m_seeds 下标
+    size_t m_allocationCount;
+
+    const MemoryRegion* FindRegion(QWORD address) const;
+    bool Overlaps(QWORD address, QWORD size) const;
+    void Account(TraceOp op);
+    void ApplySeed(QWORD address, size_t size);
+};
@@ -1,14 +1,19 @@
 #include "skill_bypass_injector.h"
 #include "aob_scanner.h"
+#include "patch_transaction.h"
+#include "resident_cave.h"
 #include <cstring>
 
 SkillBypassInjector::SkillBypassInjector()
-    : m_process(nullptr)
+    : m_memory(nullptr)
     , m_enabled(false)
+    , m_foreign(false)
     , m_hook1Address(0)
     , m_hook1Found(false)
+    , m_hook1Reverted(false)
     , m_hook2Address(0)
     , m_hook2Found(false)
+    , m_hook2Reverted(false)
 {
     memset(m_hook1OriginalBytes, 0, sizeof(m_hook1OriginalBytes));
     memset(m_hook2OriginalBytes, 0, sizeof(m_hook2OriginalBytes));
@@ -18,32 +23,30 @@ SkillBypassInjector::~SkillBypassInjector() {
     Cleanup();
 }
 
-bool SkillBypassInjector::Initialize(HANDLE process) {
+bool SkillBypassInjector::Initialize(ProcessMemory* memory) {
     if (m_enabled) {
         return false;
     }
 
-    m_process = process;
+    m_memory = memory;
     return FindHookPoints();
 }
 
 bool SkillBypassInjector::FindHookPoints() {
     // 查找Hook点1
-    m_hook1Address = AobScan(m_process, SkillBypassAob::HOOK1_AOB);
+    m_hook1Address = AobScan(m_memory, SkillBypassAob::HOOK1_AOB);
     if (m_hook1Address != 0) {
         // 备份原始字节 (5 bytes: 75 43 0F B7 CF)
-        SIZE_T bytesRead;
-        if (ReadProcessMemory(m_process, (LPCVOID)m_hook1Address, m_hook1OriginalBytes, 5, &bytesRead) && bytesRead == 5) {
+        if (m_memory->Read(m_hook1Address, m_hook1OriginalBytes, 5)) {
             m_hook1Found = true;
         }
     }
 
     // 查找Hook点2
-    m_hook2Address = AobScan(m_process, SkillBypassAob::HOOK2_AOB);
+    m_hook2Address = AobScan(m_memory, SkillBypassAob::HOOK2_AOB);
     if (m_hook2Address != 0) {
         // 备份原始字节 (6 bytes: 0F 85 xx xx xx xx)
-        SIZE_T bytesRead;
-        if (ReadProcessMemory(m_process, (LPCVOID)m_hook2Address, m_hook2OriginalBytes, 6, &bytesRead) && bytesRead == 6) {
+        if (m_memory->Read(m_hook2Address, m_hook2OriginalBytes, 6)) {
             m_hook2Found = true;
         }
     }
@@ -52,8 +55,14 @@ bool SkillBypassInjector::FindHookPoints() {
     return m_hook1Found || m_hook2Found;
 }
 
-bool SkillBypassInjector::ApplyHook1() {
-    if (!m_hook1Found) return true; // 没找到就跳过
+namespace {
+    const uint8_t HOOK1_PATCH_BYTES[5] = { 0x90, 0x90, 0x0F, 0xB7, 0xCF };
+    const uint8_t HOOK2_PATCH_BYTES[6] = { 0x90, 0x90, 0x90, 0x90, 0x90, 0x90 };
+}
+
+void SkillBypassInjector::AddHook1(PatchTransaction& transaction, bool enable) {
+    if (!m_hook1Found) return; // 没找到就跳过
+    if (!enable && m_hook1Reverted) return; // 已是原始字节
 
     /*
     原始代码:
@@ -68,23 +77,16 @@ bool SkillBypassInjector::ApplyHook1() {
     这样就不会跳过，直接执行后面的代码
     */
 
-    BYTE patchBytes[5] = { 0x90, 0x90, 0x0F, 0xB7, 0xCF };
-
-    DWORD oldProtect;
-    if (!VirtualProtectEx(m_process, (LPVOID)m_hook1Address, 5, PAGE_EXECUTE_READWRITE, &oldProtect)) {
-        return false;
+    if (enable) {
+        transaction.Add(m_hook1Address, HOOK1_PATCH_BYTES, m_hook1OriginalBytes, sizeof(HOOK1_PATCH_BYTES));
+    } else {
+        transaction.Add(m_hook1Address, m_hook1OriginalBytes, HOOK1_PATCH_BYTES, sizeof(HOOK1_PATCH_BYTES));
     }
-
-    SIZE_T bytesWritten;
-    bool success = WriteProcessMemory(m_process, (LPVOID)m_hook1Address, patchBytes, 5, &bytesWritten) && bytesWritten == 5;
-
-    VirtualProtectEx(m_process, (LPVOID)m_hook1Address, 5, oldProtect, &oldProtect);
-
-    return success;
 }
 
-bool SkillBypassInjector::ApplyHook2() {
-    if (!m_hook2Found) return true; // 没找到就跳过
+void SkillBypassInjector::AddHook2(PatchTransaction& transaction, bool enable) {
+    if (!m_hook2Found) return; // 没找到就跳过
+    if (!enable && m_hook2Reverted) return; // 已是原始字节
 
     /*
     原始代码:
@@ -96,93 +98,105 @@ bool SkillBypassInjector::ApplyHook2() {
     这样就不会跳过，直接执行后面的代码
     */
 
-    BYTE patchBytes[6] = { 0x90, 0x90, 0x90, 0x90, 0x90, 0x90 };
-
-    DWORD oldProtect;
-    if (!VirtualProtectEx(m_process, (LPVOID)m_hook2Address, 6, PAGE_EXECUTE_READWRITE, &oldProtect)) {
-        return false;
+    if (enable) {
+        transaction.Add(m_hook2Address, HOOK2_PATCH_BYTES, m_hook2OriginalBytes, sizeof(HOOK2_PATCH_BYTES));
+    } else {
+        transaction.Add(m_hook2Address, m_hook2OriginalBytes, HOOK2_PATCH_BYTES, sizeof(HOOK2_PATCH_BYTES));
     }
+}
+
+bool SkillBypassInjector::PrepareEnable(PatchTransaction& transaction) {
+    if (m_enabled || m_memory == nullptr) return false;
 
-    SIZE_T bytesWritten;
-    bool success = WriteProcessMemory(m_process, (LPVOID)m_hook2Address, patchBytes, 6, &bytesWritten) && bytesWritten == 6;
+    AddHook1(transaction, true);
+    AddHook2(transaction, true);
+    return true;
+}
 
-    VirtualProtectEx(m_process, (LPVOID)m_hook2Address, 6, oldProtect, &oldProtect);
+bool SkillBypassInjector::PrepareDisable(PatchTransaction& transaction) {
+    if (!m_enabled || m_foreign) return false;
 
-    return success;
+    AddHook1(transaction, false);
+    AddHook2(transaction, false);
+    return true;
 }
 
-bool SkillBypassInjector::RestoreHook1() {
-    if (!m_hook1Found) return true;
+bool SkillBypassInjector::Enable() {
+    if (m_enabled) return true;
+    if (m_memory == nullptr) return false;
 
-    DWORD oldProtect;
-    if (!VirtualProtectEx(m_process, (LPVOID)m_hook1Address, 5, PAGE_EXECUTE_READWRITE, &oldProtect)) {
+    // 两个 hook 点在同一事务中提交，失败时自动回滚
+    PatchTransaction transaction(m_memory);
+    if (!PrepareEnable(transaction) || !transaction.Commit()) {
         return false;
     }
 
-    SIZE_T bytesWritten;
-    bool success = WriteProcessMemory(m_process, (LPVOID)m_hook1Address, m_hook1OriginalBytes, 5, &bytesWritten) && bytesWritten == 5;
-
-    VirtualProtectEx(m_process, (LPVOID)m_hook1Address, 5, oldProtect, &oldProtect);
-
-    return success;
+    m_enabled = true;
+    return true;
 }
 
-bool SkillBypassInjector::RestoreHook2() {
-    if (!m_hook2Found) return true;
+bool SkillBypassInjector::Disable() {
+    if (!m_enabled) return true;
+    if (m_foreign) return false;
 
-    DWORD oldProtect;
-    if (!VirtualProtectEx(m_process, (LPVOID)m_hook2Address, 6, PAGE_EXECUTE_READWRITE, &oldProtect)) {
+    PatchTransaction transaction(m_memory);
+    if (!PrepareDisable(transaction) || !transaction.Commit()) {
         return false;
     }
 
-    SIZE_T bytesWritten;
-    bool success = WriteProcessMemory(m_process, (LPVOID)m_hook2Address, m_hook2OriginalBytes, 6, &bytesWritten) && bytesWritten == 6;
-
-    VirtualProtectEx(m_process, (LPVOID)m_hook2Address, 6, oldProtect, &oldProtect);
-
-    return success;
+    m_enabled = false;
+    return true;
 }
 
-bool SkillBypassInjector::Enable() {
-    if (m_enabled) return true;
-    if (m_process == nullptr) return false;
-
-    bool success1 = ApplyHook1();
-    bool success2 = ApplyHook2();
-
-    if (success1 && success2) {
-        m_enabled = true;
-        return true;
+void SkillBypassInjector::DescribeIntegrity(IntegrityRange& outHook1, IntegrityRange& outHook2) const {
+    memset(&outHook1, 0, sizeof(outHook1));
+    memset(&outHook2, 0, sizeof(outHook2));
+    if (!m_enabled) {
+        return;
     }
 
-    // 如果失败，尝试恢复
-    RestoreHook1();
-    RestoreHook2();
-    return false;
+    if (m_hook1Found && !m_hook1Reverted) {
+        outHook1.address = m_hook1Address;
+        outHook1.size = sizeof(HOOK1_PATCH_BYTES);
+        outHook1.expectedHash = HashResidentBytes(HOOK1_PATCH_BYTES, sizeof(HOOK1_PATCH_BYTES));
+        outHook1.originalHash = HashResidentBytes(m_hook1OriginalBytes, sizeof(HOOK1_PATCH_BYTES));
+    }
+    if (m_hook2Found && !m_hook2Reverted) {
+        outHook2.address = m_hook2Address;
+        outHook2.size = sizeof(HOOK2_PATCH_BYTES);
+        outHook2.expectedHash = HashResidentBytes(HOOK2_PATCH_BYTES, sizeof(HOOK2_PATCH_BYTES));
+        outHook2.originalHash = HashResidentBytes(m_hook2OriginalBytes, sizeof(HOOK2_PATCH_BYTES));
+    }
 }
 
-bool SkillBypassInjector::Disable() {
-    if (!m_enabled) return true;
-
-    bool success1 = RestoreHook1();
-    bool success2 = RestoreHook2();
+void SkillBypassInjector::MarkReverted(int hookIndex) {
+    if (hookIndex == 1) m_hook1Reverted = true;
+    if (hookIndex == 2) m_hook2Reverted = true;
 
-    if (success1 && success2) {
-        m_enabled = false;
-        return true;
+    // 找到的改写点都已恢复
+    if ((!m_hook1Found || m_hook1Reverted) && (!m_hook2Found || m_hook2Reverted)) {
+        SetEnabled(false);
     }
-
-    return false;
 }
 
 void SkillBypassInjector::Cleanup() {
+    // 被改写的位置不再写回
+    if (m_foreign) {
+        m_enabled = false;
+        m_foreign = false;
+    }
     if (m_enabled) {
         Disable();
     }
 
-    m_process = nullptr;
+    m_memory = nullptr;
     m_hook1Address = 0;
     m_hook2Address = 0;
     m_hook1Found = false;
     m_hook2Found = false;
 }
+
+void SkillBypassInjector::Abandon() {
+    m_enabled = false;
+    Cleanup();
+}
@@ -1,9 +1,9 @@
 #pragma once
 
-#include <windows.h>
-#include <cstdint>
+#include "integrity_monitor.h"
+#include "process_memory.h"
 
-typedef uint64_t QWORD;
+class PatchTransaction;
 
 /// <summary>
 /// 技能学习条件绕过Hook
@@ -17,9 +17,9 @@ public:
     /// <summary>
     /// 初始化注入器
     /// </summary>
-    /// <param name="process">目标进程句柄</param>
+    /// <param name="memory">目标进程内存接口</param>
     /// <returns>成功返回true</returns>
-    bool Initialize(HANDLE process);
+    bool Initialize(ProcessMemory* memory);
 
     /// <summary>
     /// 启用技能学习条件绕过
@@ -31,35 +31,65 @@ public:
     /// </summary>
     bool Disable();
 
+    /// <summary>
+    /// 把启用/禁用的改写加入事务，由调用者统一提交，提交成功后调用 SetEnabled
+    /// </summary>
+    bool PrepareEnable(PatchTransaction& transaction);
+    bool PrepareDisable(PatchTransaction& transaction);
+    void SetEnabled(bool enabled) {
+        m_enabled = enabled;
+        m_hook1Reverted = false;
+        m_hook2Reverted = false;
+    }
+
     /// <summary>
     /// 检查是否已启用
     /// </summary>
     bool IsEnabled() const { return m_enabled; }
 
+    /// <summary>
+    /// 完整性检查 (见 integrity_monitor.h): 启用时填写两个改写点的范围，未找到或已恢复的 size 为 0
+    /// </summary>
+    void DescribeIntegrity(IntegrityRange& outHook1, IntegrityRange& outHook2) const;
+
+    /// <summary>
+    /// 检查结果: 已是原始字节的改写点 (hookIndex 为 1 或 2) 禁用时跳过，两处都恢复时视为已禁用；
+    /// 被其它程序改写时拒绝禁用，Cleanup 不再访问改写点
+    /// </summary>
+    void MarkReverted(int hookIndex);
+    void MarkForeign() { m_foreign = true; }
+    bool IsForeign() const { return m_foreign; }
+
     /// <summary>
     /// 清理资源
     /// </summary>
     void Cleanup();
 
+    /// <summary>
+    /// 不访问目标进程，直接丢弃状态
+    /// </summary>
+    void Abandon();
+
 private:
-    HANDLE m_process;
+    ProcessMemory* m_memory;
     bool m_enabled;
+    bool m_foreign;
 
     // Hook点1: jne -> nop+jmp (绕过第一个条件检查)
     QWORD m_hook1Address;
-    BYTE m_hook1OriginalBytes[5];
+    uint8_t m_hook1OriginalBytes[5];
     bool m_hook1Found;
+    bool m_hook1Reverted;
 
     // Hook点2: jne -> nop*6 (绕过第二个条件检查)
     QWORD m_hook2Address;
-    BYTE m_hook2OriginalBytes[6];
+    uint8_t m_hook2OriginalBytes[6];
     bool m_hook2Found;
+    bool m_hook2Reverted;
 
     bool FindHookPoints();
-    bool ApplyHook1();
-    bool ApplyHook2();
-    bool RestoreHook1();
-    bool RestoreHook2();
+    void AddHook1(PatchTransaction& transaction, bool enable);
+    void AddHook2(PatchTransaction& transaction, bool enable);
 };
 
 // AOB patterns
@@ -0,0 +1,102 @@
+#include "state_page.h"
+#include <cstring>
+
+StatePagePublisher::StatePagePublisher()
+    : m_page(nullptr)
+{
+    memset(&m_staging, 0, sizeof(m_staging));
+}
+
+StatePagePublisher::~StatePagePublisher() {
+    Close();
+}
+
+bool StatePagePublisher::Open(const char* name) {
+    Close();
+
+    if (!m_memory.Create(name, sizeof(SharedStatePage))) {
+        return false;
+    }
+
+    m_page = static_cast<SharedStatePage*>(m_memory.GetData());
+
+    // 先把 sequence 置为奇数，读者在页头写好之前会看到 "正在写"
+    m_page->sequence.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_page->magic = StatePageLayout::STATE_PAGE_MAGIC;
+    m_page->version = StatePageLayout::STATE_PAGE_VERSION;
+    m_page->size = (uint32_t)sizeof(SharedStatePage);
+    m_page->reserved = 0;
+    memcpy(&m_page->body, &m_staging, sizeof(m_staging));
+    m_page->sequence.store(2, std::memory_order_release);
+    return true;
+}
+
+void StatePagePublisher::Close() {
+    m_page = nullptr;
+    m_memory.Close();
+}
+
+void StatePagePublisher::Publish() {
+    if (m_page == nullptr) {
+        return;
+    }
+
+    m_staging.counters.publishCount++;
+
+    uint64_t sequence = m_page->sequence.load(std::memory_order_relaxed);
+    m_page->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&m_page->body, &m_staging, sizeof(m_staging));
+    m_page->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+StatePageReader::StatePageReader()
+    : m_page(nullptr)
+{
+}
+
+bool StatePageReader::Open(const char* name) {
+    Close();
+
+    if (!m_memory.Open(name, sizeof(SharedStatePage), false)) {
+        return false;
+    }
+
+    m_page = static_cast<const SharedStatePage*>(m_memory.GetData());
+    return true;
+}
+
+void StatePageReader::Close() {
+    m_page = nullptr;
+    m_memory.Close();
+}
+
+StatePageReadResult StatePageReader::TryRead(StatePageBody& outBody, uint64_t& lastSequence) const {
+    if (m_page == nullptr) {
+        return StatePageReadResult::Invalid;
+    }
+
+    uint64_t before = m_page->sequence.load(std::memory_order_acquire);
+    if ((before & 1) != 0) {
+        return StatePageReadResult::Torn;
+    }
+    if (m_page->magic != StatePageLayout::STATE_PAGE_MAGIC
+        || m_page->version != StatePageLayout::STATE_PAGE_VERSION) {
+        return StatePageReadResult::Invalid;
+    }
+    if (before == lastSequence) {
+        return StatePageReadResult::Unchanged;
+    }
+
+    memcpy(&outBody, (const void*)&m_page->body, sizeof(outBody));
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    uint64_t after = m_page->sequence.load(std::memory_order_relaxed);
+    if (after != before) {
+        return StatePageReadResult::Torn;
+    }
+
+    lastSequence = before;
+    return StatePageReadResult::Ok;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "shared_memory.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+typedef uint64_t QWORD;
+
+// 共享状态页
+// 核心把附加/Hook 状态、当前装备和最近一次解码的记录发布到命名共享内存中，
+// 前端 (C# MemoryMappedFile) 无需 P/Invoke 即可读取。
+//
+// 协议 (seqlock, 单写者):
+//   写者: sequence 置为奇数 -> 写入正文 -> sequence 置为下一个偶数 (release)
+//   读者: 读 sequence (acquire)，奇数表示正在写；复制正文；再读 sequence，
+//         两次不等表示读到撕裂数据，需要重试；与上次相同表示内容未变化。
+// 布局修改时必须递增 STATE_PAGE_VERSION，并同步 Engine/SharedStatePage.cs。
+namespace StatePageLayout {
+    constexpr uint32_t STATE_PAGE_MAGIC = 0x5053334E;   // "N3SP"
+    constexpr uint32_t STATE_PAGE_VERSION = 1;
+    constexpr int AFFIX_SLOT_COUNT = 7;
+
+    // flags
+    constexpr uint32_t FLAG_ATTACHED = 1u << 0;
+    constexpr uint32_t FLAG_WEAPON_HOOK = 1u << 1;
+    constexpr uint32_t FLAG_ARMOR_HOOK = 1u << 2;
+    constexpr uint32_t FLAG_SKILL_BYPASS = 1u << 3;
+    constexpr uint32_t FLAG_EDITS_WITHDRAWN = 1u << 4;     // 最近一批信箱写入在游戏应用前被撤回
+
+    // StateRecord.validMask
+    constexpr uint32_t RECORD_BASICS_VALID = 1u << 0;
+    constexpr uint32_t RECORD_EXTENDED_VALID = 1u << 1;    // equipPlusValue / quality
+    constexpr uint32_t RECORD_WEAPON_FIELDS_VALID = 1u << 2;
+    constexpr uint32_t RECORD_AFFIX_SLOT0_VALID = 1u << 8;  // bit8..bit14: 各词条槽位
+}
+
+#pragma pack(push, 8)
+
+struct StateAffixSlot {
+    int32_t id;
+    int32_t level;
+    uint8_t prefixes[4];
+    uint32_t reserved;
+};
+
+// 最近一次解码的装备记录
+struct StateRecord {
+    uint64_t base;
+    uint32_t validMask;
+    int16_t itemId;
+    int16_t transmogId;
+    int16_t level;
+    uint8_t equipPlusValue;
+    uint8_t isUnderworld;
+    int32_t quality;
+    int32_t underworldSkillId;
+    int32_t familiarity;
+    uint32_t reserved;
+    StateAffixSlot affixes[StatePageLayout::AFFIX_SLOT_COUNT];
+};
+
+// 统计计数
+struct StateCounters {
+    uint64_t remoteReads;
+    uint64_t remoteWrites;
+    uint64_t remoteQueries;
+    uint64_t remoteProtects;
+    uint64_t remoteAllocations;
+    uint64_t bytesRead;
+    uint64_t bytesWritten;
+    uint64_t remoteFailures;
+    uint64_t publishCount;
+};
+
+// 共享页正文 (sequence 之后的部分)
+struct StatePageBody {
+    uint32_t flags;
+    int32_t equipmentType;
+    uint64_t equipmentBase;
+    uint64_t weaponBase;
+    uint64_t armorBase;
+    StateRecord record;
+    StateCounters counters;
+};
+
+struct SharedStatePage {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;          // sizeof(SharedStatePage)
+    uint32_t reserved;
+    std::atomic<uint64_t> sequence;
+    StatePageBody body;
+};
+
+#pragma pack(pop)
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "sequence must be lock-free to live in shared memory");
+static_assert(offsetof(SharedStatePage, sequence) == 16, "state page layout changed");
+static_assert(offsetof(SharedStatePage, body) == 24, "state page layout changed");
+static_assert(sizeof(StateRecord) == 152, "state page layout changed");
+static_assert(sizeof(SharedStatePage) == 280, "state page layout changed");
+
+// 写者 - 由会话在持有自身锁时调用
+class StatePagePublisher {
+public:
+    StatePagePublisher();
+    ~StatePagePublisher();
+
+    // 创建命名映射并写入页头
+    bool Open(const char* name);
+    void Close();
+    bool IsOpen() const { return m_page != nullptr; }
+    const char* GetName() const { return m_memory.GetName().c_str(); }
+
+    // 本地暂存区，调用者修改后 Publish
+    StatePageBody& Staging() { return m_staging; }
+
+    // 以 seqlock 协议把暂存区复制到共享页
+    void Publish();
+
+private:
+    SharedMemory m_memory;
+    SharedStatePage* m_page;
+    StatePageBody m_staging;
+};
+
+// 读者 (C++ 侧，供工具/Linux 验证使用；前端的 C# 实现遵循同一协议)
+enum class StatePageReadResult {
+    Ok,          // 读到新的一致快照
+    Unchanged,   // sequence 与上次相同
+    Torn,        // 写者正在写或读到撕裂数据，稍后重试
+    Invalid      // 未打开或页头不匹配
+};
+
+class StatePageReader {
+public:
+    StatePageReader();
+
+    bool Open(const char* name);
+    void Close();
+
+    // lastSequence: 上次成功读取的 sequence (首次传 0)，成功时更新
+    StatePageReadResult TryRead(StatePageBody& outBody, uint64_t& lastSequence) const;
+
+private:
+    SharedMemory m_memory;
+    const SharedStatePage* m_page;
+};
@@ -0,0 +1,334 @@
+// 代码洞分配器检查 (模拟的地址空间，不需要游戏进程)
+//
+// 用法:
+//   arena_check [--check]
+//
+// 在模拟的地址空间中摆放主模块和占用的区域，检查近址搜索、槽位分配/释放/合并和整块释放，
+// 再用模拟的游戏进程 (tools/simulated_game.h) 检查会话只做一次近址搜索。
+// 要求:
+//   整块内存按分配粒度对齐，块内任意位置都能用 rel32 到达主模块的两端；模块之后被占满时在之前找，两边都占满时失败且不分配；
+//   搜索按区域跳跃，查询次数与区域数量相当；整块只分配一次，数据区改为不可执行；
+//   代码槽位在代码区、数据槽位在数据区 (跳过常驻头部)，按要求对齐且互不重叠；非法对齐、大小为 0、空间不足时返回 0；
+//   随机的分配/释放序列中已用字节数与模型一致，全部释放后空闲块合并为整个代码区；重复释放和槽位内部地址的释放失败；
+//   Release 释放整块，Abandon 保留目标进程中的内存；注入器清理时注入点恢复失败则保留槽位，恢复成功才归还；
+//   会话启用两个 hook、撤下后再启用只分配一次代码洞，分离时释放。
+
+#include "capture_ring.h"
+#include "check_tool.h"
+#include "code_injector.h"
+#include "remote_arena.h"
+#include "session.h"
+#include "simulated_game.h"
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr QWORD GRANULARITY = 0x10000;
+    constexpr QWORD REL32_LIMIT = 0x80000000ull;
+
+    using CheckTool::Expect;
+
+    // 记录保护属性的修改
+    class RecordingMemory : public BorrowedProcessMemory {
+    public:
+        explicit RecordingMemory(ProcessMemory& inner) : BorrowedProcessMemory(inner) {}
+
+        struct ProtectCall {
+            QWORD address;
+            size_t size;
+            uint32_t protect;
+        };
+        std::vector<ProtectCall> protects;
+
+        bool Protect(QWORD address, size_t size, uint32_t newProtect, uint32_t* oldProtect) override {
+            protects.push_back({ address, size, newProtect });
+            return BorrowedProcessMemory::Protect(address, size, newProtect, oldProtect);
+        }
+    };
+
+    bool Reaches(QWORD from, QWORD to) {
+        return (from > to ? from - to : to - from) < REL32_LIMIT;
+    }
+
+    // 整块的两端都能到达模块的两端
+    bool IsNear(QWORD base) {
+        QWORD moduleEnd = SimulatedGame::MODULE_BASE + SimulatedGame::MODULE_SIZE;
+        QWORD arenaEnd = base + RemoteArena::TOTAL_SIZE;
+        return Reaches(base, SimulatedGame::MODULE_BASE) && Reaches(base, moduleEnd) &&
+            Reaches(arenaEnd, SimulatedGame::MODULE_BASE) && Reaches(arenaEnd, moduleEnd);
+    }
+
+    void AddModule(SimulatedProcessMemory& memory) {
+        SimulatedGame::AddRegion(memory, SimulatedGame::MODULE_BASE, SimulatedGame::MODULE_SIZE, MemProtect::ExecuteRead, MemType::Image);
+        memory.SetMainModule(SimulatedGame::MODULE_BASE, SimulatedGame::MODULE_SIZE);
+    }
+
+    void Occupy(SimulatedProcessMemory& memory, QWORD base, QWORD size) {
+        MemoryRegion region;
+        region.baseAddress = base;
+        region.regionSize = size;
+        region.state = MemState::Commit;
+        region.protect = MemProtect::ReadWrite;
+        region.type = MemType::Private;
+        memory.AddRegion(region);
+    }
+
+    bool CheckNearSearch() {
+        const QWORD moduleEnd = SimulatedGame::MODULE_BASE + SimulatedGame::MODULE_SIZE;
+        bool ok = true;
+
+        // 模块之后先是几块占用的区域
+        {
+            SimulatedProcessMemory memory;
+            AddModule(memory);
+            Occupy(memory, moduleEnd, 0x30000);
+            Occupy(memory, moduleEnd + 0x30000, 0x8000);
+            Occupy(memory, moduleEnd + 0x40000, 0x20000);
+            RecordingMemory recording(memory);
+            RemoteArena arena;
+            memory.ResetOpCounts();
+            ok = Expect(arena.Initialize(&recording, SimulatedGame::MODULE_BASE, moduleEnd), "initialize after the module") && ok;
+            QWORD base = arena.GetBase();
+            ok = Expect(base == moduleEnd + 0x60000, "first free block after the module") && ok;
+            ok = Expect(base % GRANULARITY == 0 && IsNear(base), "arena alignment / reach") && ok;
+            ok = Expect(memory.GetOpCount(TraceOp::Allocate) == 1, "arena allocated more than once") && ok;
+            ok = Expect(memory.GetOpCount(TraceOp::Query) <= 5, "search does not skip whole regions") && ok;
+            ok = Expect(recording.protects.size() == 1 && recording.protects[0].address == base + RemoteArena::CODE_SIZE &&
+                recording.protects[0].size == RemoteArena::DATA_SIZE && recording.protects[0].protect == MemProtect::ReadWrite,
+                "data area is still executable") && ok;
+            MemoryRegion region;
+            ok = Expect(memory.Query(base, region) && region.state == MemState::Commit &&
+                region.regionSize >= RemoteArena::TOTAL_SIZE, "arena not committed") && ok;
+        }
+
+        // 模块之后的可达范围全部占满: 在模块之前找
+        {
+            SimulatedProcessMemory memory;
+            AddModule(memory);
+            Occupy(memory, moduleEnd, 0x80000000ull);
+            Occupy(memory, SimulatedGame::MODULE_BASE - 0x100000, 0x100000);
+            RemoteArena arena;
+            ok = Expect(arena.Initialize(&memory, SimulatedGame::MODULE_BASE, moduleEnd), "initialize before the module") && ok;
+            QWORD base = arena.GetBase();
+            ok = Expect(base + RemoteArena::TOTAL_SIZE <= SimulatedGame::MODULE_BASE - 0x100000 && base % GRANULARITY == 0 &&
+                IsNear(base), "block before the module") && ok;
+        }
+
+        // 两边都占满: 失败，不分配
+        {
+            SimulatedProcessMemory memory;
+            AddModule(memory);
+            Occupy(memory, moduleEnd, 0x80000000ull);
+            Occupy(memory, SimulatedGame::MODULE_BASE - 0x80000000ull, 0x80000000ull);
+            RemoteArena arena;
+            memory.ResetOpCounts();
+            ok = Expect(!arena.Initialize(&memory, SimulatedGame::MODULE_BASE, moduleEnd) && !arena.IsInitialized() &&
+                arena.AllocateCode(16) == 0, "initialize without a near block") && ok;
+            ok = Expect(memory.GetOpCount(TraceOp::Allocate) == 0, "allocated without a near block") && ok;
+        }
+        return CheckTool::Report("near search", ok);
+    }
+
+    bool CheckSlots() {
+        SimulatedProcessMemory memory;
+        AddModule(memory);
+        RemoteArena arena;
+        bool ok = Expect(arena.Initialize(&memory, SimulatedGame::MODULE_BASE, SimulatedGame::MODULE_BASE + SimulatedGame::MODULE_SIZE),
+            "initialize");
+        if (!ok) {
+            return false;
+        }
+        const QWORD base = arena.GetBase();
+        const QWORD dataStart = base + RemoteArena::CODE_SIZE + RemoteArena::HEADER_SIZE;
+        const QWORD end = base + RemoteArena::TOTAL_SIZE;
+
+        struct Slot {
+            QWORD address;
+            size_t size;
+            size_t alignment;
+            bool code;
+        };
+        const size_t sizes[] = { 1, 24, 100, 384, 13, 512 };
+        const size_t alignments[] = { 1, 8, 16, 64, 256, 4096 };
+        std::vector<Slot> slots;
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            slots.push_back({ arena.AllocateCode(sizes[i], alignments[i]), sizes[i], alignments[i], true });
+            slots.push_back({ arena.AllocateData(sizes[i], alignments[i]), sizes[i], alignments[i], false });
+        }
+        for (size_t i = 0; i < slots.size(); i++) {
+            const Slot& slot = slots[i];
+            bool inside = slot.code ? slot.address >= base && slot.address + slot.size <= base + RemoteArena::CODE_SIZE
+                                    : slot.address >= dataStart && slot.address + slot.size <= end;
+            ok = Expect(slot.address != 0 && inside, "slot outside its area") && ok;
+            ok = Expect(slot.address % slot.alignment == 0, "slot not aligned") && ok;
+            for (size_t j = 0; j < i; j++) {
+                ok = Expect(slot.address + slot.size <= slots[j].address || slots[j].address + slots[j].size <= slot.address,
+                    "slots overlap") && ok;
+            }
+        }
+
+        ok = Expect(arena.AllocateCode(16, 3) == 0 && arena.AllocateData(8, 0) == 0, "invalid alignment") && ok;
+        ok = Expect(arena.AllocateCode(0) == 0 && arena.AllocateData(0) == 0, "zero size") && ok;
+        ok = Expect(arena.AllocateCode(RemoteArena::CODE_SIZE) == 0, "code larger than the free space") && ok;
+        ok = Expect(arena.AllocateData(RemoteArena::DATA_SIZE - RemoteArena::HEADER_SIZE) == 0, "data larger than the free space") && ok;
+        ok = Expect(arena.Contains(base) && arena.Contains(end - 1) && !arena.Contains(end) && arena.GetHeaderAddress() == base + RemoteArena::CODE_SIZE,
+            "arena bounds") && ok;
+        return CheckTool::Report("slots", ok);
+    }
+
+    bool CheckFreeAndCoalesce() {
+        SimulatedProcessMemory memory;
+        AddModule(memory);
+        RemoteArena arena;
+        bool ok = Expect(arena.Initialize(&memory, SimulatedGame::MODULE_BASE, SimulatedGame::MODULE_BASE + SimulatedGame::MODULE_SIZE),
+            "initialize");
+        if (!ok) {
+            return false;
+        }
+        const QWORD base = arena.GetBase();
+
+        // 模型: 已分配的代码槽位 起始地址 -> 大小
+        std::map<QWORD, size_t> model;
+        size_t used = 0;
+        std::mt19937_64 random(31);
+        for (int step = 0; step < 20000 && ok; step++) {
+            if (model.empty() || random() % 3 != 0) {
+                size_t size = 1 + (size_t)(random() % 600);
+                size_t alignment = (size_t)1 << (random() % 7);
+                QWORD address = arena.AllocateCode(size, alignment);
+                if (address == 0) {
+                    continue;
+                }
+                auto next = model.lower_bound(address);
+                bool overlaps = (next != model.end() && next->first < address + size) ||
+                    (next != model.begin() && std::prev(next)->first + std::prev(next)->second > address);
+                ok = Expect(!overlaps && address % alignment == 0 && address + size <= base + RemoteArena::CODE_SIZE,
+                    "random allocation overlaps or is misaligned") && ok;
+                model[address] = size;
+                used += size;
+            } else {
+                auto it = model.begin();
+                std::advance(it, (long)(random() % model.size()));
+                if (it->second > 1) {
+                    ok = Expect(!arena.Free(it->first + 1), "freed an address inside a slot") && ok;
+                }
+                ok = Expect(arena.Free(it->first), "free an allocated slot") && ok;
+                ok = Expect(!arena.Free(it->first), "double free succeeded") && ok;
+                used -= it->second;
+                model.erase(it);
+            }
+            ok = Expect(arena.GetCodeUsed() == used, "used bytes differ from the model") && ok;
+        }
+
+        for (const auto& slot : model) {
+            ok = Expect(arena.Free(slot.first), "free the remaining slots") && ok;
+        }
+        ok = Expect(arena.GetCodeUsed() == 0, "used bytes after freeing everything") && ok;
+        ok = Expect(arena.AllocateCode(RemoteArena::CODE_SIZE) == base, "free blocks not coalesced") && ok;
+        ok = Expect(!arena.Free(base + RemoteArena::TOTAL_SIZE) && !arena.Free(0), "free outside the arena") && ok;
+        return CheckTool::Report("free / coalesce", ok);
+    }
+
+    bool CheckRelease() {
+        SimulatedProcessMemory memory;
+        AddModule(memory);
+        const QWORD moduleEnd = SimulatedGame::MODULE_BASE + SimulatedGame::MODULE_SIZE;
+        bool ok = true;
+
+        RemoteArena arena;
+        ok = Expect(arena.Initialize(&memory, SimulatedGame::MODULE_BASE, moduleEnd), "initialize") && ok;
+        QWORD base = arena.GetBase();
+        arena.AllocateCode(64);
+        arena.AllocateData(8);
+        arena.Release();
+        ok = Expect(SimulatedGame::CommittedRegion(memory, base) == 0, "release did not free the block") && ok;
+        ok = Expect(!arena.IsInitialized() && arena.AllocateCode(16) == 0 && arena.AllocateData(8) == 0, "allocate after release") && ok;
+
+        ok = Expect(arena.Initialize(&memory, SimulatedGame::MODULE_BASE, moduleEnd) && arena.GetBase() == base, "initialize again") && ok;
+        arena.Abandon();
+        ok = Expect(SimulatedGame::CommittedRegion(memory, base) == base && !arena.IsInitialized(), "abandon freed the block") && ok;
+
+        // 接管留下的整块: 所有槽位空闲，认领的区间不能再分配
+        RemoteArena unaligned;
+        ok = Expect(!unaligned.Adopt(&memory, base + 0x1000) && !unaligned.Adopt(&memory, base + GRANULARITY),
+            "adopt an unaligned or uncommitted base") && ok;
+        ok = Expect(arena.Adopt(&memory, base), "adopt") && ok;
+        ok = Expect(arena.Claim(base + 0x40, 0x40) && !arena.Claim(base + 0x60, 0x10), "claim") && ok;
+        QWORD first = arena.AllocateCode(0x40, 0x40);
+        QWORD second = arena.AllocateCode(0x40, 0x40);
+        ok = Expect(first == base && second == base + 0x80, "allocation over a claimed range") && ok;
+        arena.Release();
+        ok = Expect(SimulatedGame::CommittedRegion(memory, base) == 0, "release after adopt") && ok;
+        return CheckTool::Report("release", ok);
+    }
+
+    // 注入点恢复失败时注入点仍跳向 hook 代码，槽位不能归还
+    bool CheckInjectorCleanup() {
+        SimulatedProcessMemory memory;
+        SimulatedGame::Build(memory);
+        BorrowedProcessMemory borrowed(memory);
+        const QWORD moduleEnd = SimulatedGame::MODULE_BASE + SimulatedGame::MODULE_SIZE;
+        RemoteArena arena;
+        CaptureRing ring;
+        bool ok = Expect(arena.Initialize(&borrowed, SimulatedGame::MODULE_BASE, moduleEnd) && ring.Initialize(&borrowed, &arena),
+            "initialize arena and ring");
+        const size_t baseline = arena.GetCodeUsed();
+
+        CodeInjector injector;
+        ok = Expect(injector.Initialize(&borrowed, &arena, &ring, nullptr, SimulatedGame::WEAPON_SITE, HookType::Weapon) &&
+            injector.Enable(), "enable") && ok;
+        const size_t used = arena.GetCodeUsed();
+        const QWORD stub = SimulatedGame::JumpTarget(memory, SimulatedGame::WEAPON_SITE);
+        borrowed.writeFailStart = SimulatedGame::WEAPON_SITE;
+        borrowed.writeFailEnd = SimulatedGame::WEAPON_SITE + 1;
+        injector.Cleanup();
+        borrowed.writeFailStart = borrowed.writeFailEnd = 0;
+        ok = Expect(used > baseline && arena.GetCodeUsed() == used && SimulatedGame::JumpTarget(memory, SimulatedGame::WEAPON_SITE) == stub,
+            "slot freed while the site still jumps into it") && ok;
+
+        // 槽位仍被占用，第二个注入器分到别处；恢复成功后归还
+        CodeInjector second;
+        ok = Expect(second.Initialize(&borrowed, &arena, &ring, nullptr, SimulatedGame::ARMOR_SITE, HookType::Armor) &&
+            second.Enable() && SimulatedGame::JumpTarget(memory, SimulatedGame::ARMOR_SITE) != stub, "second injector") && ok;
+        const size_t withSecond = arena.GetCodeUsed();
+        second.Cleanup();
+        ok = Expect(arena.GetCodeUsed() == used && SimulatedGame::JumpTarget(memory, SimulatedGame::ARMOR_SITE) == 0 &&
+            withSecond > used, "restored slot not freed") && ok;
+        return CheckTool::Report("injector cleanup", ok);
+    }
+
+    // 会话中所有 hook 共用一个代码洞
+    bool CheckSession() {
+        SimulatedProcessMemory memory;
+        SimulatedGame::Build(memory);
+        Session session;
+        bool ok = Expect(session.Attach(std::unique_ptr<ProcessMemory>(new BorrowedProcessMemory(memory))), "attach");
+        memory.ResetOpCounts();
+        ok = Expect(session.EnableCapture() && session.IsWeaponHookEnabled() && session.IsArmorHookEnabled(), "enable capture") && ok;
+        ok = Expect(memory.GetOpCount(TraceOp::Allocate) == 1, "hooks did not share one code cave") && ok;
+
+        QWORD weapon = SimulatedGame::JumpTarget(memory, SimulatedGame::WEAPON_SITE);
+        QWORD armor = SimulatedGame::JumpTarget(memory, SimulatedGame::ARMOR_SITE);
+        QWORD arena = SimulatedGame::CommittedRegion(memory, weapon);
+        ok = Expect(arena != 0 && SimulatedGame::CommittedRegion(memory, armor) == arena && weapon != armor, "hook stubs") && ok;
+
+        session.DisableCapture();
+        ok = Expect(session.EnableCapture() && memory.GetOpCount(TraceOp::Allocate) == 1, "re-enable allocated again") && ok;
+        ok = Expect(SimulatedGame::CommittedRegion(memory, SimulatedGame::JumpTarget(memory, SimulatedGame::WEAPON_SITE)) == arena,
+            "re-enabled stub outside the code cave") && ok;
+
+        session.Detach();
+        ok = Expect(SimulatedGame::CommittedRegion(memory, arena) == 0 && memory.GetOpCount(TraceOp::Free) == 1,
+            "code cave not freed on detach") && ok;
+        return CheckTool::Report("session", ok);
+    }
+}
+
+int main(int argc, char** argv) {
+    return CheckTool::Run(argc, argv, "arena", {
+        CheckNearSearch, CheckSlots, CheckFreeAndCoalesce, CheckRelease, CheckInjectorCleanup, CheckSession
+    });
+}
@@ -0,0 +1,427 @@
+// 游戏数据表目录: 解码导出的表内存，或用合成的游戏内存校验和计时
+//
+// 用法:
+//   catalog_tool <image.n3ti>           载入 SessionDumpGameTables 导出的内存，用内置的表描述解码并列出全部条目
+//   catalog_tool --synthetic N          生成 N 个词条的合成游戏内存，计时读取、完美哈希查找和缓存读写
+//   catalog_tool --check                只用合成游戏内存检查正确性
+//
+// 合成游戏内存 (按内置的表描述布局):
+//   词条表: 主模块中 mov rax, [rip+disp32] 指向的全局变量保存表管理器指针，管理器中是内联条目数组
+//   (0x20 字节，名称为 UTF-16，含中文、代理对、空名称、空指针和重复 ID)；
+//   地狱技能表: lea rcx, [rip+disp32] 直接指向表头，表头中是指向条目的指针数组 (含空指针，名称为 UTF-8)。
+//   有一个名称紧挨着堆区域的末尾 (合并读取失败后逐个读取)。
+// --check 要求: 读出的条目与植入的一致 (重复 ID 保留第一个)；每个 ID 都能用完美哈希查到，不存在的 ID 查不到；
+// 缓存文件在版本键和表描述都相同时读回相同的目录，任一不同时拒绝；导出的内存载入后解码结果相同；
+// ID 不按顺序或大部分条目没有名称的表不加入目录；未知的表类型查不到。
+
+#include "game_catalog.h"
+#include "snapshot_memory.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr QWORD MODULE_BASE = 0x140000000ull;
+    constexpr QWORD MODULE_SIZE = 0x400000;
+    constexpr QWORD CODE_OFFSET = 0x1000;
+    constexpr QWORD DATA_OFFSET = 0x300000;         // .data 段
+    constexpr QWORD HEAP_BASE = 0x200000000ull;
+    constexpr QWORD HEAP_SIZE = 0x1000000;
+
+    const char* const SAMPLE_NAMES[] = {
+        "攻击力", "防御力", "武技伤害", "气力回复速度", "Ki Pulse 加成", "雷属性伤害", "生命值",
+        "暴击率 \xF0\x9F\x94\xA5",      // 含 BMP 以外的字符 (UTF-16 代理对)
+        "妖怪技能伤害", "Amrita 获取量",
+    };
+
+    double Milliseconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // UTF-8 -> UTF-16LE (输入都是合法的 UTF-8)
+    std::vector<uint16_t> ToUtf16(const std::string& text) {
+        std::vector<uint16_t> units;
+        for (size_t i = 0; i < text.size();) {
+            uint8_t lead = (uint8_t)text[i];
+            uint32_t code;
+            int length = lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+            code = length == 1 ? lead : lead & (0x7F >> length);
+            for (int k = 1; k < length; k++) {
+                code = (code << 6) | ((uint8_t)text[i + k] & 0x3F);
+            }
+            i += length;
+            if (code >= 0x10000) {
+                code -= 0x10000;
+                units.push_back((uint16_t)(0xD800 + (code >> 10)));
+                units.push_back((uint16_t)(0xDC00 + (code & 0x3FF)));
+            } else {
+                units.push_back((uint16_t)code);
+            }
+        }
+        return units;
+    }
+
+    // 植入的表和期望的解码结果 (每个表 ID -> 名称)
+    struct SyntheticGame {
+        SnapshotMemory memory;
+        std::map<int32_t, std::string> expected[CatalogLayout::KIND_COUNT];
+        QWORD affixEntries = 0;         // 词条表的内联条目数组
+    };
+
+    class HeapAllocator {
+    public:
+        explicit HeapAllocator(SnapshotMemory& memory) : m_memory(memory), m_next(HEAP_BASE) {}
+
+        QWORD Allocate(size_t size) {
+            QWORD address = m_next;
+            m_next += (size + 15) & ~(size_t)15;
+            return address;
+        }
+
+        void Write(QWORD address, const void* data, size_t size) {
+            memcpy(m_memory.At(address, size), data, size);
+        }
+
+    private:
+        SnapshotMemory& m_memory;
+        QWORD m_next;
+    };
+
+    void PutBytes(SnapshotMemory& memory, QWORD address, const char* pattern, int32_t displacement) {
+        std::vector<uint8_t> bytes;
+        for (const char* p = pattern; *p != '\0';) {
+            while (*p == ' ') p++;
+            if (*p == '\0') break;
+            bytes.push_back(p[0] == '?' ? 0xCC : (uint8_t)strtoul(std::string(p, 2).c_str(), nullptr, 16));
+            p += 2;
+        }
+        memcpy(memory.At(address, bytes.size()), bytes.data(), bytes.size());
+        memcpy(memory.At(address + 3, sizeof(displacement)), &displacement, sizeof(displacement));
+    }
+
+    std::string MakeName(std::mt19937_64& random, int32_t id) {
+        return std::string(SAMPLE_NAMES[random() % (sizeof(SAMPLE_NAMES) / sizeof(SAMPLE_NAMES[0]))]) + " " + std::to_string(id);
+    }
+
+    void MakeGame(SyntheticGame& game, uint32_t affixCount, uint32_t skillCount) {
+        std::mt19937_64 random(0x4E334743);
+        SnapshotMemory& memory = game.memory;
+        memory.moduleBase = MODULE_BASE;
+        memory.moduleSize = MODULE_SIZE;
+        memory.regions.push_back({ MODULE_BASE, MemProtect::ExecuteRead, MemType::Image, std::vector<uint8_t>(MODULE_SIZE) });
+        memory.regions.push_back({ HEAP_BASE, MemProtect::ReadWrite, MemType::Private, std::vector<uint8_t>(HEAP_SIZE) });
+        for (uint8_t& byte : memory.regions[0].bytes) {
+            byte = (uint8_t)random();
+        }
+        memory.regions[0].bytes[0] = 'M';
+        memory.regions[0].bytes[1] = 'Z';
+        HeapAllocator heap(memory);
+
+        CatalogTableSpec affixSpec = GetDefaultCatalogSpec(CATALOG_AFFIX);
+        CatalogTableSpec skillSpec = GetDefaultCatalogSpec(CATALOG_UNDERWORLD_SKILL);
+
+        // 词条表: 代码中的 mov rax, [rip+disp32] -> 全局变量 -> 管理器 -> 内联条目数组
+        const QWORD affixCode = MODULE_BASE + CODE_OFFSET + 0x12345;
+        const QWORD affixGlobal = MODULE_BASE + DATA_OFFSET + 0x100;
+        PutBytes(memory, affixCode, affixSpec.signature, (int32_t)(affixGlobal - (affixCode + affixSpec.instructionLength)));
+        QWORD manager = heap.Allocate(0x40);
+        QWORD affixEntries = heap.Allocate((size_t)affixCount * affixSpec.entryStride);
+        game.affixEntries = affixEntries;
+        memory.Put(affixGlobal, manager);
+        memory.Put(manager + affixSpec.entriesOffset, affixEntries);
+        uint32_t count = affixCount;
+        heap.Write(manager + affixSpec.countOffset, &count, sizeof(count));
+
+        std::vector<uint8_t> entry(affixSpec.entryStride);
+        for (uint32_t i = 0; i < affixCount; i++) {
+            // 每 97 个有一个重复前一项的 ID，每 101 个有一个空名称，每 103 个有一个空指针
+            int32_t id = (i % 97 == 96) ? (int32_t)(1000 + (i - 1) * 7) : (int32_t)(1000 + i * 7);
+            std::string name = i % 101 == 100 ? std::string() : MakeName(random, id);
+            QWORD namePointer = 0;
+            if (i % 103 != 102) {
+                std::vector<uint16_t> units = ToUtf16(name);
+                units.push_back(0);
+                namePointer = heap.Allocate(units.size() * 2);
+                heap.Write(namePointer, units.data(), units.size() * 2);
+                if (!name.empty() && game.expected[CATALOG_AFFIX].count(id) == 0) {
+                    game.expected[CATALOG_AFFIX][id] = name;
+                }
+            }
+            memset(entry.data(), 0xAB, entry.size());
+            memcpy(entry.data() + affixSpec.idOffset, &id, sizeof(id));
+            memcpy(entry.data() + affixSpec.nameOffset, &namePointer, sizeof(namePointer));
+            heap.Write(affixEntries + (QWORD)i * affixSpec.entryStride, entry.data(), entry.size());
+        }
+
+        // 地狱技能表: lea rcx, [rip+disp32] -> 表头 (主模块 .data) -> 指针数组 -> 条目
+        const QWORD skillCode = MODULE_BASE + CODE_OFFSET + 0x23456;
+        const QWORD skillHeader = MODULE_BASE + DATA_OFFSET + 0x200;
+        PutBytes(memory, skillCode, skillSpec.signature, (int32_t)(skillHeader - (skillCode + skillSpec.instructionLength)));
+        QWORD pointers = heap.Allocate((size_t)skillCount * sizeof(QWORD));
+        memory.Put(skillHeader + skillSpec.entriesOffset, pointers);
+        count = skillCount;
+        memcpy(memory.At(skillHeader + skillSpec.countOffset, sizeof(count)), &count, sizeof(count));
+
+        entry.assign(skillSpec.entryStride, 0);
+        for (uint32_t i = 0; i < skillCount; i++) {
+            QWORD pointer = 0;
+            if (i % 13 != 12) {
+                int32_t id = (int32_t)(i + 1);
+                std::string name = MakeName(random, id);
+                QWORD namePointer;
+                if (i == skillCount - 2) {
+                    // 最后一个名称放在堆区域的末尾
+                    namePointer = HEAP_BASE + HEAP_SIZE - (name.size() + 1);
+                } else {
+                    namePointer = heap.Allocate(name.size() + 1);
+                }
+                heap.Write(namePointer, name.c_str(), name.size() + 1);
+                pointer = heap.Allocate(skillSpec.entryStride);
+                memcpy(entry.data() + skillSpec.idOffset, &id, sizeof(id));
+                memcpy(entry.data() + skillSpec.nameOffset, &namePointer, sizeof(namePointer));
+                heap.Write(pointer, entry.data(), entry.size());
+                game.expected[CATALOG_UNDERWORLD_SKILL][id] = name;
+            }
+            memory.Put(pointers + (QWORD)i * sizeof(QWORD), pointer);
+        }
+    }
+
+    bool LoadImage(const char* path, SnapshotMemory& memory) {
+        FILE* file = fopen(path, "rb");
+        if (file == nullptr) {
+            return false;
+        }
+        CatalogImageHeader header;
+        bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+            header.magic == CatalogLayout::IMAGE_MAGIC && header.version == CatalogLayout::IMAGE_VERSION;
+        memory.regions.clear();
+        memory.moduleBase = ok ? header.moduleBase : 0;
+        memory.moduleSize = ok ? header.moduleSize : 0;
+        for (uint32_t i = 0; ok && i < header.regionCount; i++) {
+            uint64_t range[2];
+            ok = fread(range, sizeof(range), 1, file) == 1 && range[1] <= 0x40000000;
+            if (ok) {
+                memory.regions.push_back({ range[0], MemProtect::ReadWrite, MemType::Private, std::vector<uint8_t>((size_t)range[1]) });
+                ok = fread(memory.regions.back().bytes.data(), 1, (size_t)range[1], file) == range[1];
+            }
+        }
+        fclose(file);
+        return ok;
+    }
+
+    void DefaultSpecs(CatalogTableSpec* specs) {
+        for (uint32_t kind = 0; kind < CatalogLayout::KIND_COUNT; kind++) {
+            specs[kind] = GetDefaultCatalogSpec((CatalogKind)kind);
+        }
+    }
+
+    bool Matches(const GameCatalog& catalog, const SyntheticGame& game) {
+        for (uint32_t kind = 0; kind < CatalogLayout::KIND_COUNT; kind++) {
+            const auto& expected = game.expected[kind];
+            if (catalog.GetCount((CatalogKind)kind) != expected.size()) {
+                fprintf(stderr, "table %u: %u entries decoded, %zu expected\n", kind, catalog.GetCount((CatalogKind)kind), expected.size());
+                return false;
+            }
+            const CatalogEntry* entries = catalog.GetEntries((CatalogKind)kind);
+            size_t i = 0;
+            for (const auto& item : expected) {
+                const CatalogEntry& entry = entries[i++];
+                if (entry.id != item.first || item.second != catalog.GetName(entry) || entry.nameLength != item.second.size()) {
+                    fprintf(stderr, "table %u: entry %d decoded as %d \"%s\"\n", kind, item.first, entry.id, catalog.GetName(entry));
+                    return false;
+                }
+                const CatalogEntry* found = catalog.Find((CatalogKind)kind, item.first);
+                if (found != &entry) {
+                    fprintf(stderr, "table %u: perfect hash misses id %d\n", kind, item.first);
+                    return false;
+                }
+            }
+            for (int32_t id = -5; id < 200000; id += 3) {
+                if (expected.count(id) == 0 && catalog.Find((CatalogKind)kind, id) != nullptr) {
+                    fprintf(stderr, "table %u: perfect hash finds absent id %d\n", kind, id);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool RunCheck() {
+        SyntheticGame game;
+        MakeGame(game, 2000, 300);
+        CatalogTableSpec specs[CatalogLayout::KIND_COUNT];
+        DefaultSpecs(specs);
+
+        GameCatalog catalog;
+        CatalogStats stats;
+        if (!ExtractGameCatalog(&game.memory, specs, catalog, stats) || !Matches(catalog, game)) {
+            fprintf(stderr, "extraction failed\n");
+            return false;
+        }
+        bool ok = true;
+
+        const uint64_t specHash = HashCatalogSpecs(specs);
+        const char* cachePath = "catalog_tool_check.n3gc";
+        GameCatalog cached;
+        if (!catalog.Write(cachePath, stats.buildKey, specHash) || !cached.Read(cachePath, stats.buildKey, specHash) ||
+            !Matches(cached, game)) {
+            fprintf(stderr, "cache round trip failed\n");
+            ok = false;
+        }
+        CatalogTableSpec changed[CatalogLayout::KIND_COUNT];
+        DefaultSpecs(changed);
+        changed[CATALOG_AFFIX].entryStride += 8;
+        if (cached.Read(cachePath, stats.buildKey + 1, specHash) || cached.Read(cachePath, stats.buildKey, HashCatalogSpecs(changed)) ||
+            !cached.IsEmpty()) {
+            fprintf(stderr, "stale cache was accepted\n");
+            ok = false;
+        }
+        remove(cachePath);
+
+        // 特征码结尾之后的内容不影响表描述的哈希
+        DefaultSpecs(changed);
+        changed[CATALOG_AFFIX].signature[CatalogLayout::MAX_SIGNATURE - 1] = 'x';
+        if (HashCatalogSpecs(changed) != specHash) {
+            fprintf(stderr, "spec hash depends on bytes after the signature\n");
+            ok = false;
+        }
+
+        const char* imagePath = "catalog_tool_check.n3ti";
+        SnapshotMemory image;
+        GameCatalog decoded;
+        CatalogStats decodedStats;
+        if (!DumpCatalogImage(&game.memory, specs, imagePath) || !LoadImage(imagePath, image) ||
+            !ExtractGameCatalog(&image, specs, decoded, decodedStats) || !Matches(decoded, game) ||
+            decodedStats.buildKey != stats.buildKey) {
+            fprintf(stderr, "table image does not decode to the same catalog\n");
+            ok = false;
+        }
+        remove(imagePath);
+
+        // 特征码匹配到别处: ID 不按顺序、大部分条目没有名称时词条表按找不到处理，地狱技能表不受影响
+        const CatalogTableSpec& affixSpec = specs[CATALOG_AFFIX];
+        for (int variant = 0; variant < 2; variant++) {
+            SyntheticGame bad;
+            MakeGame(bad, 2000, 300);
+            for (uint32_t i = 0; i < 2000; i++) {
+                QWORD entry = bad.affixEntries + (QWORD)i * affixSpec.entryStride;
+                if (variant == 0 && i == 1500) {
+                    const int32_t id = 5;
+                    memcpy(bad.memory.At(entry + affixSpec.idOffset, sizeof(id)), &id, sizeof(id));
+                } else if (variant == 1 && i % 3 != 0) {
+                    bad.memory.Put(entry + affixSpec.nameOffset, (QWORD)0);
+                }
+            }
+            if (!ExtractGameCatalog(&bad.memory, specs, decoded, decodedStats) || decodedStats.entries[CATALOG_AFFIX] != 0 ||
+                decodedStats.entries[CATALOG_UNDERWORLD_SKILL] != bad.expected[CATALOG_UNDERWORLD_SKILL].size()) {
+                fprintf(stderr, "implausible affix table accepted (%s)\n", variant == 0 ? "unordered ids" : "missing names");
+                ok = false;
+            }
+        }
+        if (decoded.Find((CatalogKind)CatalogLayout::KIND_COUNT, 1) != nullptr || decoded.Find((CatalogKind)-1, 1) != nullptr) {
+            fprintf(stderr, "lookup accepted an unknown table kind\n");
+            ok = false;
+        }
+
+        SnapshotMemory empty;
+        empty.moduleBase = MODULE_BASE;
+        empty.moduleSize = MODULE_SIZE;
+        empty.regions.push_back({ MODULE_BASE, MemProtect::ExecuteRead, MemType::Image, std::vector<uint8_t>(MODULE_SIZE) });
+        if (ExtractGameCatalog(&empty, specs, decoded, decodedStats) || !decoded.IsEmpty()) {
+            fprintf(stderr, "tables found in an empty module\n");
+            ok = false;
+        }
+        return ok;
+    }
+
+    bool RunSynthetic(uint32_t count) {
+        SyntheticGame game;
+        MakeGame(game, count, std::max<uint32_t>(count / 8, 16));
+        CatalogTableSpec specs[CatalogLayout::KIND_COUNT];
+        DefaultSpecs(specs);
+
+        GameCatalog catalog;
+        CatalogStats stats;
+        auto start = std::chrono::steady_clock::now();
+        if (!ExtractGameCatalog(&game.memory, specs, catalog, stats)) {
+            fprintf(stderr, "extraction failed\n");
+            return false;
+        }
+        double extractMs = Milliseconds(start);
+        printf("extract      %.3f ms (%u affixes, %u skills, %u reads, %llu bytes)\n", extractMs,
+            stats.entries[CATALOG_AFFIX], stats.entries[CATALOG_UNDERWORLD_SKILL], stats.reads, (unsigned long long)stats.bytesRead);
+
+        const CatalogEntry* entries = catalog.GetEntries(CATALOG_AFFIX);
+        const uint32_t entryCount = catalog.GetCount(CATALOG_AFFIX);
+        const uint32_t lookups = 10000000;
+        uint64_t hits = 0;
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < lookups; i++) {
+            int32_t id = (i & 1) != 0 ? entries[(i * 2654435761u) % entryCount].id : (int32_t)(i * 13);
+            hits += catalog.Find(CATALOG_AFFIX, id) != nullptr ? 1 : 0;
+        }
+        double lookupMs = Milliseconds(start);
+        printf("lookup       %.1f M/s (%llu hits of %u)\n", lookups / (lookupMs * 1000.0), (unsigned long long)hits, lookups);
+
+        const char* cachePath = "catalog_tool_bench.n3gc";
+        const uint64_t specHash = HashCatalogSpecs(specs);
+        catalog.Write(cachePath, stats.buildKey, specHash);
+        GameCatalog cached;
+        start = std::chrono::steady_clock::now();
+        bool ok = cached.Read(cachePath, stats.buildKey, specHash);
+        printf("cache load   %.3f ms\n", Milliseconds(start));
+        remove(cachePath);
+        return ok && Matches(catalog, game);
+    }
+
+    bool RunImage(const char* path) {
+        SnapshotMemory memory;
+        if (!LoadImage(path, memory)) {
+            fprintf(stderr, "failed to read %s\n", path);
+            return false;
+        }
+        CatalogTableSpec specs[CatalogLayout::KIND_COUNT];
+        DefaultSpecs(specs);
+        GameCatalog catalog;
+        CatalogStats stats;
+        if (!ExtractGameCatalog(&memory, specs, catalog, stats)) {
+            fprintf(stderr, "no table found in %s\n", path);
+            return false;
+        }
+        printf("build key %016llX, %u affixes, %u skills\n", (unsigned long long)stats.buildKey,
+            stats.entries[CATALOG_AFFIX], stats.entries[CATALOG_UNDERWORLD_SKILL]);
+        for (uint32_t kind = 0; kind < CatalogLayout::KIND_COUNT; kind++) {
+            const CatalogEntry* entries = catalog.GetEntries((CatalogKind)kind);
+            for (uint32_t i = 0; i < catalog.GetCount((CatalogKind)kind); i++) {
+                printf("%u,%d,%s\n", kind, entries[i].id, catalog.GetName(entries[i]));
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc == 2 && strcmp(argv[1], "--check") == 0) {
+        if (!RunCheck()) {
+            fprintf(stderr, "catalog checks failed\n");
+            return 1;
+        }
+        printf("ok\n");
+        return 0;
+    }
+    if (argc == 3 && strcmp(argv[1], "--synthetic") == 0) {
+        uint32_t count = (uint32_t)strtoul(argv[2], nullptr, 0);
+        return count != 0 && count <= CatalogLayout::MAX_ENTRIES && RunSynthetic(count) ? 0 : 1;
+    }
+    if (argc == 2 && argv[1][0] != '-') {
+        return RunImage(argv[1]) ? 0 : 1;
+    }
+    fprintf(stderr, "usage: %s <image.n3ti> | --synthetic N | --check\n", argv[0]);
+    return 2;
+}
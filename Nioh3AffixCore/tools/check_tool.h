@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+
+// 检查工具共用的骨架 (用法 "<工具> [--check]"，ctest 用 --check 运行)
+// 每节检查返回是否通过，并用 Report 打印一行结果；一节失败不影响后面的节
+namespace CheckTool {
+    typedef bool (*Section)();
+
+    // 条件不成立时打印一行失败说明
+    inline bool Expect(bool condition, const char* what) {
+        if (!condition) {
+            printf("  FAIL %s\n", what);
+        }
+        return condition;
+    }
+
+    inline bool Report(const char* section, bool ok) {
+        printf("%-24s %s\n", section, ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // detail 为 printf 格式的附加说明 (计数、耗时等)，打印在结果之后的括号中
+    inline bool Report(const char* section, bool ok, const char* detail, ...) {
+        printf("%-24s %s (", section, ok ? "ok" : "FAILED");
+        va_list args;
+        va_start(args, detail);
+        vprintf(detail, args);
+        va_end(args);
+        printf(")\n");
+        return ok;
+    }
+
+    // 依次运行全部节，返回进程退出码: 0 全部通过，1 有节失败，2 参数错误
+    inline int Run(int argc, char** argv, const char* name, std::initializer_list<Section> sections) {
+        if (argc > 2 || (argc == 2 && strcmp(argv[1], "--check") != 0)) {
+            fprintf(stderr, "usage: %s [--check]\n", argv[0]);
+            return 2;
+        }
+        bool ok = true;
+        for (Section section : sections) {
+            ok = section() && ok;
+        }
+        if (!ok) {
+            fprintf(stderr, "%s checks failed\n", name);
+            return 1;
+        }
+        printf("ok\n");
+        return 0;
+    }
+}
@@ -0,0 +1,1144 @@
+// 指令解码与搬移检查 (不需要游戏进程)
+//
+// 用法:
+//   decoder_check [--check]
+//
+// 语料中每种 (助记符, 长度, RIP 相对, 分支类型) 保留一条编码，参考值取自 objdump 对系统库和编译产物的反汇编
+// (含 VEX/EVEX、x87、带前缀和 16 位立即数的形式)；搬移用例在近处和远处的目标地址上重新解码搬移结果。
+// 要求:
+//   语料中每条编码的长度、RIP 相对标记和分支类型与参考值相同，少一个字节时解码失败；xbegin 和 64 位模式下无效的操作码被拒绝；
+//   搬移后每条指令的跳转/调用目标和 RIP 相对操作数的地址与原位置相同，不可达的分支改为绝对形式，RIP 相对不可达时失败；
+//   跳回被覆盖区域内部的分支和 loop/jrcxz 无法搬移；随机字节的解码长度不超过可读字节数。
+
+#include "check_tool.h"
+#include "x64_decoder.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr QWORD SOURCE = 0x140001000ull;
+    constexpr QWORD NEAR_TARGET = 0x150000000ull;
+    constexpr QWORD FAR_TARGET = 0x7FF000000000ull;
+    constexpr int RANDOM_ITERATIONS = 500000;
+
+    // kind: N 无分支, J jmp, K jcc, C call, L loop/jrcxz, X 应被拒绝 (xbegin 的 rel32 不能搬移)
+    struct CorpusEntry {
+        const char* hex;
+        bool ripRelative;
+        char kind;
+        const char* mnemonic;
+    };
+
+    const CorpusEntry CORPUS[] = {
+        { "C8200001", false, 'N', "enter" },
+        { "C9", false, 'N', "leave" },
+        { "48A18877665544332211", false, 'N', "movabs" },
+        { "A08877665544332211", false, 'N', "movabs" },
+        { "66B83412", false, 'N', "mov" },
+        { "66053412", false, 'N', "add" },
+        { "F6400401", false, 'N', "test" },
+        { "F7050001000078563412", true, 'N', "test" },
+        { "66F7033412", false, 'N', "test" },
+        { "F710", false, 'N', "not" },
+        { "E3BF", false, 'L', "jrcxz" },
+        { "E2BD", false, 'L', "loop" },
+        { "EBBB", false, 'J', "jmp" },
+        { "75B9", false, 'K', "jne" },
+        { "E8B4FFFFFF", false, 'C', "call" },
+        { "803D341200007F", true, 'N', "cmp" },
+        { "498D8C2448010000", false, 'N', "lea" },
+        { "4889EA", false, 'N', "mov" },
+        { "62F16D49FE0D40000000", true, 'N', "vpaddd" },
+        { "C5FD700D800000001B", true, 'N', "vpshufd" },
+        { "C5F877", false, 'N', "vzeroupper" },
+        { "C5FC77", false, 'N', "vzeroall" },
+        { "C4E3FD00C14E", false, 'N', "vpermq" },
+        { "62F375482544D840FF", false, 'N', "vpternlogd" },
+        { "660F7044241055", false, 'N', "pshufd" },
+        { "660F3A0FC104", false, 'N', "palignr" },
+        { "660FC5C102", false, 'N', "pextrw" },
+        { "0FA4D803", false, 'N', "shld" },
+        { "0FBA2105", false, 'N', "bt" },
+        { "F20F38F002", false, 'N', "crc32" },
+        { "C20800", false, 'N', "ret" },
+        { "CC", false, 'N', "int3" },
+        { "CD2E", false, 'N', "int" },
+        { "6878563412", false, 'N', "push" },
+        { "6A12", false, 'N', "push" },
+        { "69051000000000100000", true, 'N', "imul" },
+        { "6BC107", false, 'N', "imul" },
+        { "F04D0FB108", false, 'N', "cmpxchg" },
+        { "F0480FC10500010000", true, 'N', "xadd" },
+        { "0F31", false, 'N', "rdtsc" },
+        { "0FA2", false, 'N', "cpuid" },
+        { "490FCC", false, 'N', "bswap" },
+        { "DD4008", false, 'N', "fld" },
+        { "DDD9", false, 'N', "fstp" },
+        { "48630508000000", true, 'N', "movsxd" },
+        { "E460", false, 'N', "in" },
+        { "E660", false, 'N', "out" },
+        { "6690", false, 'N', "xchg" },
+        { "660F1F0400", false, 'N', "nop" },
+        { "64C604252800000001", false, 'N', "mov" },
+        { "F3A4", false, 'N', "movs" },
+        { "F2F0830001", false, 'N', "xacquire" },
+        { "C5F892C8", false, 'N', "kmovw" },
+        { "C4E26D920488", false, 'N', "vgatherdps" },
+        { "C4E37D1D0D2000000003", true, 'N', "vcvtps2ph" },
+        { "0F38F001", false, 'N', "movbe" },
+        { "660F38F6C3", false, 'N', "adcx" },
+        { "0F38CBCA", false, 'N', "sha256rnds2" },
+        { "660F3A44CA11", false, 'N', "pclmulhqhqdq" },
+        { "660F38DC0D30000000", true, 'N', "aesenc" },
+        { "F30F1EFA", false, 'N', "endbr64" },
+        { "0F0B", false, 'N', "ud2" },
+        { "0F05", false, 'N', "syscall" },
+        { "4863C2", false, 'N', "movsxd" },
+        { "85C0", false, 'N', "test" },
+        { "7E43", false, 'K', "jle" },
+        { "8D50FF", false, 'N', "lea" },
+        { "83FA02", false, 'N', "cmp" },
+        { "760D", false, 'K', "jbe" },
+        { "4C8D4E04", false, 'N', "lea" },
+        { "4C29CF", false, 'N', "sub" },
+        { "4883FF18", false, 'N', "cmp" },
+        { "772E", false, 'K', "ja" },
+        { "31C0", false, 'N', "xor" },
+        { "0F1F4000", false, 'N', "nop" },
+        { "C5FA100C06", false, 'N', "vmovss" },
+        { "C4E279A90C01", false, 'N', "vfmadd213ss" },
+        { "C3", false, 'N', "ret" },
+        { "0F86DE000000", false, 'K', "jbe" },
+        { "89C7", false, 'N', "mov" },
+        { "C1EF03", false, 'N', "shr" },
+        { "C4E27D18D0", false, 'N', "vbroadcastss" },
+        { "48C1E705", false, 'N', "shl" },
+        { "0F1F8000000000", false, 'N', "nop" },
+        { "C5FC100C16", false, 'N', "vmovups" },
+        { "C4E26DA80C11", false, 'N', "vfmadd213ps" },
+        { "83E2F8", false, 'N', "and" },
+        { "39D0", false, 'N', "cmp" },
+        { "74B6", false, 'K', "je" },
+        { "C4E261980CBE", false, 'N', "vfmadd132ps" },
+        { "01FA", false, 'N', "add" },
+        { "4183E003", false, 'N', "and" },
+        { "0F8477FFFFFF", false, 'K', "je" },
+        { "C4A17A100C8E", false, 'N', "vmovss" },
+        { "C4C279A908", false, 'N', "vfmadd213ss" },
+        { "0F8E4BFFFFFF", false, 'K', "jle" },
+        { "4C8D443904", false, 'N', "lea" },
+        { "83C202", false, 'N', "add" },
+        { "C5FA1020", false, 'N', "vmovss" },
+        { "C4E25999443E08", false, 'N', "vfmadd132ss" },
+        { "E96BFFFFFF", false, 'J', "jmp" },
+        { "8D04F500000000", false, 'N', "lea" },
+        { "29F0", false, 'N', "sub" },
+        { "0FB6F1", false, 'N', "movzx" },
+        { "C1F903", false, 'N', "sar" },
+        { "BEFF000000", false, 'N', "mov" },
+        { "62F27D287CDE", false, 'N', "vpbroadcastd" },
+        { "90", false, 'N', "nop" },
+        { "C5FE6F1417", false, 'N', "vmovdqu" },
+        { "C4C17E6F0C11", false, 'N', "vmovdqu" },
+        { "C5FD72F203", false, 'N', "vpslld" },
+        { "C5FDFAC2", false, 'N', "vpsubd" },
+        { "C5F5DBD3", false, 'N', "vpand" },
+        { "C5FDFEC2", false, 'N', "vpaddd" },
+        { "C5F572E103", false, 'N', "vpsrad" },
+        { "C5FDEFC1", false, 'N', "vpxor" },
+        { "450FB6D8", false, 'N', "movzx" },
+        { "41C1F803", false, 'N', "sar" },
+        { "4431C1", false, 'N', "xor" },
+        { "C5F957C0", false, 'N', "vxorpd" },
+        { "662E0F1F840000000000", false, 'N', "nop" },
+        { "C5FD102407", false, 'N', "vmovupd" },
+        { "C5DD590C01", false, 'N', "vmulpd" },
+        { "C5FB58C1", false, 'N', "vaddsd" },
+        { "C5F115D1", false, 'N', "vunpckhpd" },
+        { "62F3FD2819CA01", false, 'N', "vextractf64x2" },
+        { "62F3F52803C903", false, 'N', "valignq" },
+        { "F6C201", false, 'N', "test" },
+        { "4898", false, 'N', "cdqe" },
+        { "C5FB102CC7", false, 'N', "vmovsd" },
+        { "C4E2D1B904C1", false, 'N', "vfmadd231sd" },
+        { "0F1F840000000000", false, 'N', "nop" },
+        { "0F1F00", false, 'N', "nop" },
+        { "62F17D486FD8", false, 'N', "vmovdqa32" },
+        { "62F17549FED8", false, 'N', "vpaddd" },
+        { "62F1FD486FC3", false, 'N', "vmovdqa64" },
+        { "FF35EACF1A00", true, 'N', "push" },
+        { "FF25ECCF1A00", true, 'N', "jmp" },
+        { "50", false, 'N', "push" },
+        { "488D1DC8EA1A00", true, 'N', "lea" },
+        { "4881ECA8000000", false, 'N', "sub" },
+        { "4889842498000000", false, 'N', "mov" },
+        { "F00FB1158FEA1A00", true, 'N', "cmpxchg" },
+        { "48892D86EA1A00", true, 'N', "mov" },
+        { "FF057CEA1A00", true, 'N', "inc" },
+        { "41BA08000000", false, 'N', "mov" },
+        { "C70565EA1A0001000000", true, 'N', "mov" },
+        { "8B0550EA1A00", true, 'N', "mov" },
+        { "FFC8", false, 'N', "dec" },
+        { "870514EA1A00", true, 'N', "xchg" },
+        { "F3AB", false, 'N', "stos" },
+        { "F4", false, 'N', "hlt" },
+        { "F70300800000", false, 'N', "test" },
+        { "488BBB88000000", false, 'N', "mov" },
+        { "F7450000800000", false, 'N', "test" },
+        { "41F7042400800000", false, 'N', "test" },
+        { "837C241000", false, 'N', "cmp" },
+        { "FF1424", false, 'N', "call" },
+        { "0FB6042500000000", false, 'N', "movzx" },
+        { "F30F6F06", false, 'N', "movdqu" },
+        { "0F29042500000000", false, 'N', "movaps" },
+        { "F30F6F460C", false, 'N', "movdqu" },
+        { "0F1104250C000000", false, 'N', "movups" },
+        { "4883EC10", false, 'N', "sub" },
+        { "5B", false, 'N', "pop" },
+        { "483982D8000000", false, 'N', "cmp" },
+        { "644833042530000000", false, 'N', "xor" },
+        { "48C1C011", false, 'N', "rol" },
+        { "FFD0", false, 'N', "call" },
+        { "F0FF0D2BC01A00", true, 'N', "dec" },
+        { "0F94C0", false, 'N', "sete" },
+        { "0F85DE000000", false, 'K', "jne" },
+        { "48C1EE03", false, 'N', "shr" },
+        { "FF9218030000", false, 'N', "call" },
+        { "4881C490000000", false, 'N', "add" },
+        { "415C", false, 'N', "pop" },
+        { "81FD00000200", false, 'N', "cmp" },
+        { "410F95C4", false, 'N', "setne" },
+        { "480F44F8", false, 'N', "cmove" },
+        { "2500F00000", false, 'N', "and" },
+        { "660F1F840000000000", false, 'N', "nop" },
+        { "48C1C811", false, 'N', "ror" },
+        { "FFE0", false, 'N', "jmp" },
+        { "644803042500000000", false, 'N', "add" },
+        { "64482B142528000000", false, 'N', "sub" },
+        { "0F87D6000000", false, 'K', "ja" },
+        { "48630482", false, 'N', "movsxd" },
+        { "660F1F440000", false, 'N', "nop" },
+        { "F7D8", false, 'N', "neg" },
+        { "19C0", false, 'N', "sbb" },
+        { "0F838D000000", false, 'K', "jae" },
+        { "4269742854E01F0000", false, 'N', "imul" },
+        { "83C808", false, 'N', "or" },
+        { "0F44D8", false, 'N', "cmove" },
+        { "0F8273FFFFFF", false, 'K', "jb" },
+        { "722E", false, 'K', "jb" },
+        { "48F7D8", false, 'N', "neg" },
+        { "73ED", false, 'K', "jae" },
+        { "480F45FE", false, 'N', "cmovne" },
+        { "660FEFC0", false, 'N', "pxor" },
+        { "410F114218", false, 'N', "movups" },
+        { "C78578FFFFFFFFFFFF7F", false, 'N', "mov" },
+        { "7C1B", false, 'K', "jl" },
+        { "7FE7", false, 'K', "jg" },
+        { "79E5", false, 'K', "jns" },
+        { "0F8F00010000", false, 'K', "jg" },
+        { "4C0F44B558FFFFFF", false, 'N', "cmove" },
+        { "66410F6E5710", false, 'N', "movd" },
+        { "660F6EC0", false, 'N', "movd" },
+        { "F3410F7E4C2410", false, 'N', "movq" },
+        { "660F62C2", false, 'N', "punpckldq" },
+        { "660FFEC1", false, 'N', "paddd" },
+        { "660F70D8E1", false, 'N', "pshufd" },
+        { "660F7E6590", false, 'N', "movd" },
+        { "660FD65D88", false, 'N', "movq" },
+        { "0F4EC1", false, 'N', "cmovle" },
+        { "0F4FF1", false, 'N', "cmovg" },
+        { "0F8CB7040000", false, 'K', "jl" },
+        { "4C0F4CC0", false, 'N', "cmovl" },
+        { "0F1600", false, 'N', "movhps" },
+        { "48833D38BD1A0000", true, 'N', "cmp" },
+        { "660F6F0554211700", true, 'N', "movdqa" },
+        { "0F114001", false, 'N', "movups" },
+        { "0F95C0", false, 'N', "setne" },
+        { "480FAFD0", false, 'N', "imul" },
+        { "0F2910", false, 'N', "movaps" },
+        { "0F295810", false, 'N', "movaps" },
+        { "4C0F49F3", false, 'N', "cmovns" },
+        { "7DEC", false, 'K', "jge" },
+        { "410F11442420", false, 'N', "movups" },
+        { "480FBE17", false, 'N', "movsx" },
+        { "490FBE5701", false, 'N', "movsx" },
+        { "490FBE542401", false, 'N', "movsx" },
+        { "418178FC2E736F00", false, 'N', "cmp" },
+        { "0F889B000000", false, 'K', "js" },
+        { "781F", false, 'K', "js" },
+        { "0FB7059C741700", true, 'N', "movzx" },
+        { "660F6CC1", false, 'N', "punpcklqdq" },
+        { "0F48C2", false, 'N', "cmovs" },
+        { "440FB652FF", false, 'N', "movzx" },
+        { "09C8", false, 'N', "or" },
+        { "490F4FC6", false, 'N', "cmovg" },
+        { "0FCA", false, 'N', "bswap" },
+        { "4519ED", false, 'N', "sbb" },
+        { "418344241401", false, 'N', "add" },
+        { "41836C241401", false, 'N', "sub" },
+        { "4803442468", false, 'N', "add" },
+        { "420FB6443A04", false, 'N', "movzx" },
+        { "FF742450", false, 'N', "push" },
+        { "0F8DC8000000", false, 'K', "jge" },
+        { "48C784248000000000000000", false, 'N', "mov" },
+        { "8D900028FFFF", false, 'N', "lea" },
+        { "0F97C1", false, 'N', "seta" },
+        { "D3FA", false, 'N', "sar" },
+        { "48018C2498000000", false, 'N', "add" },
+        { "410A0424", false, 'N', "or" },
+        { "2DC2000000", false, 'N', "sub" },
+        { "C1E006", false, 'N', "shl" },
+        { "D3E0", false, 'N', "shl" },
+        { "0A8C2482000000", false, 'N', "or" },
+        { "D3E8", false, 'N', "shr" },
+        { "F77108", false, 'N', "div" },
+        { "F7F1", false, 'N', "div" },
+        { "0F43C6", false, 'N', "cmovae" },
+        { "48C7051F371A0000000000", true, 'N', "mov" },
+        { "48031590321A00", true, 'N', "add" },
+        { "410F94C5", false, 'N', "sete" },
+        { "FF75A8", false, 'N', "push" },
+        { "3515110320", false, 'N', "xor" },
+        { "0FBE17", false, 'N', "movsx" },
+        { "0F1101", false, 'N', "movups" },
+        { "0F89F3FDFFFF", false, 'K', "jns" },
+        { "F348A5", false, 'N', "movs" },
+        { "4C63A5D8FEFFFF", false, 'N', "movsxd" },
+        { "0F291DEA0E1A00", true, 'N', "movaps" },
+        { "0F164038", false, 'N', "movhps" },
+        { "0F1105A60E1A00", true, 'N', "movups" },
+        { "F3410F6F4D00", false, 'N', "movdqu" },
+        { "0F298DE0FEFFFF", false, 'N', "movaps" },
+        { "F3410F6F9580000000", false, 'N', "movdqu" },
+        { "660F6F95E0FEFFFF", false, 'N', "movdqa" },
+        { "660F6F4DA0", false, 'N', "movdqa" },
+        { "0F11A080000000", false, 'N', "movups" },
+        { "660FC6C102", false, 'N', "shufpd" },
+        { "660FD40589CA1600", true, 'N', "paddq" },
+        { "F30F6F155BE71900", true, 'N', "movdqu" },
+        { "48C78560FEFFFF00000000", false, 'N', "mov" },
+        { "098540FEFFFF", false, 'N', "or" },
+        { "21C6", false, 'N', "and" },
+        { "48873D29001A00", true, 'N', "xchg" },
+        { "0F96C0", false, 'N', "setbe" },
+        { "4883D000", false, 'N', "adc" },
+        { "410F93C4", false, 'N', "setae" },
+        { "410F92C4", false, 'N', "setb" },
+        { "0F42C6", false, 'N', "cmovb" },
+        { "0F45D8", false, 'N', "cmovne" },
+        { "4169D4F00F0000", false, 'N', "imul" },
+        { "4C0F442586D11900", true, 'N', "cmove" },
+        { "0FB69530FEFFFF", false, 'N', "movzx" },
+        { "480F42F7", false, 'N', "cmovb" },
+        { "660FD4C1", false, 'N', "paddq" },
+        { "81E155550000", false, 'N', "and" },
+        { "41F7D4", false, 'N', "not" },
+        { "FFB424A8000000", false, 'N', "push" },
+        { "410F43F0", false, 'N', "cmovae" },
+        { "83D0FF", false, 'N', "adc" },
+        { "41FFE1", false, 'N', "jmp" },
+        { "F30F7E442418", false, 'N', "movq" },
+        { "0F294C2460", false, 'N', "movaps" },
+        { "660F6F442450", false, 'N', "movdqa" },
+        { "4863542410", false, 'N', "movsxd" },
+        { "0D0080FFFF", false, 'N', "or" },
+        { "FFC0", false, 'N', "inc" },
+        { "DB6C2418", false, 'N', "fld" },
+        { "D9E5", false, 'N', "fxam" },
+        { "DFE0", false, 'N', "fnstsw" },
+        { "D9E1", false, 'N', "fabs" },
+        { "D9E0", false, 'N', "fchs" },
+        { "D9C0", false, 'N', "fld" },
+        { "DEE1", false, 'N', "fsubrp" },
+        { "D9E8", false, 'N', "fld1" },
+        { "DEC9", false, 'N', "fmulp" },
+        { "4181E0FFFFFF7F", false, 'N', "and" },
+        { "DB4424FC", false, 'N', "fild" },
+        { "D9FD", false, 'N', "fscale" },
+        { "98", false, 'N', "cwde" },
+        { "DB7C24E8", false, 'N', "fstp" },
+        { "D80DAA681600", true, 'N', "fmul" },
+        { "D8C0", false, 'N', "fadd" },
+        { "DB2D0E5D1600", true, 'N', "fld" },
+        { "DFE9", false, 'N', "fucomip" },
+        { "D9EE", false, 'N', "fldz" },
+        { "D9C9", false, 'N', "fxch" },
+        { "DBE9", false, 'N', "fucomi" },
+        { "7A0E", false, 'K', "jp" },
+        { "DB3C24", false, 'N', "fstp" },
+        { "480FBAF13F", false, 'N', "btr" },
+        { "F30F7E15485C1600", true, 'N', "movq" },
+        { "660F28D8", false, 'N', "movapd" },
+        { "660F54D1", false, 'N', "andpd" },
+        { "660F55C3", false, 'N', "andnpd" },
+        { "660F56C2", false, 'N', "orpd" },
+        { "F20F110A", false, 'N', "movsd" },
+        { "F20F100D08601600", true, 'N', "movsd" },
+        { "F20F59C8", false, 'N', "mulsd" },
+        { "F20F5CD1", false, 'N', "subsd" },
+        { "660F540DD05A1600", true, 'N', "andpd" },
+        { "660F560DE85A1600", true, 'N', "orpd" },
+        { "F20F590DE05A1600", true, 'N', "mulsd" },
+        { "F20F58C8", false, 'N', "addsd" },
+        { "660F2EC1", false, 'N', "ucomisd" },
+        { "0F9AC1", false, 'N', "setp" },
+        { "660FD7C0", false, 'N', "pmovmskb" },
+        { "81F10000807F", false, 'N', "xor" },
+        { "F30F1015B8581600", true, 'N', "movss" },
+        { "0F54D1", false, 'N', "andps" },
+        { "0F55C3", false, 'N', "andnps" },
+        { "0F56C2", false, 'N', "orps" },
+        { "F30F5CC8", false, 'N', "subss" },
+        { "F30F1107", false, 'N', "movss" },
+        { "F30F590520631600", true, 'N', "mulss" },
+        { "0F540DA9571600", true, 'N', "andps" },
+        { "0F560DC2571600", true, 'N', "orps" },
+        { "F30F58C8", false, 'N', "addss" },
+        { "0F2EDA", false, 'N', "ucomiss" },
+        { "660F6FD0", false, 'N', "movdqa" },
+        { "660FDB0DAC551600", true, 'N', "pand" },
+        { "660FDFC2", false, 'N', "pandn" },
+        { "660FEBC1", false, 'N', "por" },
+        { "660FEB0533531600", true, 'N', "por" },
+        { "0F50C0", false, 'N', "movmskps" },
+        { "660FDBC3", false, 'N', "pand" },
+        { "D97C2406", false, 'N', "fnstcw" },
+        { "D96C2406", false, 'N', "fldcw" },
+        { "482305AD8E1900", true, 'N', "and" },
+        { "F348AB", false, 'N', "stos" },
+        { "0F49C1", false, 'N', "cmovns" },
+        { "48D3C0", false, 'N', "rol" },
+        { "482384DC80000000", false, 'N', "and" },
+        { "410FBDC5", false, 'N', "bsr" },
+        { "488305DC74190001", true, 'N', "add" },
+        { "F00FB113", false, 'N', "cmpxchg" },
+        { "418706", false, 'N', "xchg" },
+        { "99", false, 'N', "cdq" },
+        { "F7FE", false, 'N', "idiv" },
+        { "F20F100424", false, 'N', "movsd" },
+        { "F20F5C05302D1600", true, 'N', "subsd" },
+        { "0915DD6D1900", true, 'N', "or" },
+        { "D931", false, 'N', "fnstenv" },
+        { "D921", false, 'N', "fldenv" },
+        { "0FAE9FC0010000", false, 'N', "stmxcsr" },
+        { "480F48C7", false, 'N', "cmovs" },
+        { "4899", false, 'N', "cqo" },
+        { "48F7FE", false, 'N', "idiv" },
+        { "410F4DC3", false, 'N', "cmovge" },
+        { "480F46F0", false, 'N', "cmovbe" },
+        { "69176D4EC641", false, 'N', "imul" },
+        { "0FAE92C0010000", false, 'N', "ldmxcsr" },
+        { "660F2FC8", false, 'N', "comisd" },
+        { "F20F118424D0000000", false, 'N', "movsd" },
+        { "660F57059DF01500", true, 'N', "xorpd" },
+        { "0F94442460", false, 'N', "sete" },
+        { "DFF1", false, 'N', "fcomip" },
+        { "DBBC24D0000000", false, 'N', "fstp" },
+        { "660FEF05D2DF1500", true, 'N', "pxor" },
+        { "F20F11442410", false, 'N', "movsd" },
+        { "F30F5AC0", false, 'N', "cvtss2sd" },
+        { "DBAC24D0010000", false, 'N', "fld" },
+        { "490FBAE735", false, 'N', "bt" },
+        { "480FBA6D0034", false, 'N', "bts" },
+        { "F20F5805C8D61500", true, 'N', "addsd" },
+        { "0F92C2", false, 'N', "setb" },
+        { "480FAF1CC8", false, 'N', "imul" },
+        { "48F7E2", false, 'N', "mul" },
+        { "480FBD84C470020000", false, 'N', "bsr" },
+        { "4883F03F", false, 'N', "xor" },
+        { "4883DA00", false, 'N', "sbb" },
+        { "4883BC248000000000", false, 'N', "cmp" },
+        { "410F9CC1", false, 'N', "setl" },
+        { "F30F59C0", false, 'N', "mulss" },
+        { "F30F580560B31500", true, 'N', "addss" },
+        { "48814D0000008000", false, 'N', "or" },
+        { "0F570540971500", true, 'N', "xorps" },
+        { "D8C8", false, 'N', "fmul" },
+        { "DEC1", false, 'N', "faddp" },
+        { "48818C247801000000000100", false, 'N', "or" },
+        { "832D4696180001", true, 'N', "sub" },
+        { "11C0", false, 'N', "adc" },
+        { "49FFCB", false, 'N', "dec" },
+        { "4C0FADD0", false, 'N', "shrd" },
+        { "480FBAEA34", false, 'N', "bts" },
+        { "0F16842480000000", false, 'N', "movhps" },
+        { "480F45442410", false, 'N', "cmovne" },
+        { "480F4EDA", false, 'N', "cmovle" },
+        { "A4", false, 'N', "movs" },
+        { "42FF14C0", false, 'N', "call" },
+        { "440F50E3", false, 'N', "movmskps" },
+        { "410F9FC0", false, 'N', "setg" },
+        { "480F458D18FFFFFF", false, 'N', "cmovne" },
+        { "0F8A87210000", false, 'K', "jp" },
+        { "660F2E0DD6DF1400", true, 'N', "ucomisd" },
+        { "66440F50E0", false, 'N', "movmskpd" },
+        { "480FBD44D0F8", false, 'N', "bsr" },
+        { "D9BD5AFFFFFF", false, 'N', "fnstcw" },
+        { "F3480FBCC9", false, 'N', "tzcnt" },
+        { "F34F0FBC0429", false, 'N', "tzcnt" },
+        { "660F50D8", false, 'N', "movmskpd" },
+        { "DB0424", false, 'N', "fild" },
+        { "DBF1", false, 'N', "fcomi" },
+        { "D8F1", false, 'N', "fdiv" },
+        { "F2410F2ACE", false, 'N', "cvtsi2sd" },
+        { "F20F5EC1", false, 'N', "divsd" },
+        { "4C0F47E0", false, 'N', "cmova" },
+        { "0F9F442427", false, 'N', "setg" },
+        { "0F8141FEFFFF", false, 'K', "jno" },
+        { "7189", false, 'K', "jno" },
+        { "48F7A598F7FFFF", false, 'N', "mul" },
+        { "0F8039150000", false, 'K', "jo" },
+        { "41FF542438", false, 'N', "call" },
+        { "0F9EC0", false, 'N', "setle" },
+        { "81BD5CF7FFFFFFFFFF7F", false, 'N', "cmp" },
+        { "0F4DC3", false, 'N', "cmovge" },
+        { "818DD4F9FFFF00200000", false, 'N', "or" },
+        { "F785D4F9FFFF00210000", false, 'N', "test" },
+        { "0F9FC0", false, 'N', "setg" },
+        { "48D1A558F9FFFF", false, 'N', "shl" },
+        { "4883AD98F9FFFF01", false, 'N', "sub" },
+        { "4C0FBEA598F9FFFF", false, 'N', "movsx" },
+        { "0F4485E4F9FFFF", false, 'N', "cmove" },
+        { "0F9485F0F9FFFF", false, 'N', "sete" },
+        { "0F4544240C", false, 'N', "cmovne" },
+        { "660F60C0", false, 'N', "punpcklbw" },
+        { "660F61C0", false, 'N', "punpcklwd" },
+        { "660F6DCA", false, 'N', "punpckhqdq" },
+        { "660FFBC8", false, 'N', "psubq" },
+        { "0F12C8", false, 'N', "movhlps" },
+        { "41FF9680000000", false, 'N', "call" },
+        { "0F164C2408", false, 'N', "movhps" },
+        { "0F16058C581500", true, 'N', "movhps" },
+        { "41FF942480000000", false, 'N', "call" },
+        { "0F93C0", false, 'N', "setae" },
+        { "C7F800000000", false, 'X', "xbegin" },
+        { "C6F8FF", false, 'N', "xabort" },
+        { "F0410FB15500", false, 'N', "cmpxchg" },
+        { "41874500", false, 'N', "xchg" },
+        { "0F01D5", false, 'N', "xend" },
+        { "F00FB193E8100000", false, 'N', "cmpxchg" },
+        { "8783E8100000", false, 'N', "xchg" },
+        { "6448C704DD1005000000000000", false, 'N', "mov" },
+        { "F00FBAAF0803000005", false, 'N', "bts" },
+        { "F0410FB19008030000", false, 'N', "cmpxchg" },
+        { "0F46D0", false, 'N', "cmovbe" },
+        { "F0FF4320", false, 'N', "inc" },
+        { "F30F6FB880000000", false, 'N', "movdqu" },
+        { "F00FC14F10", false, 'N', "xadd" },
+        { "F00FC102", false, 'N', "xadd" },
+        { "F0440FC16724", false, 'N', "xadd" },
+        { "F0480FB10DE2C61400", true, 'N', "cmpxchg" },
+        { "418787E8100000", false, 'N', "xchg" },
+        { "F0FF05139A1400", true, 'N', "inc" },
+        { "0F44542454", false, 'N', "cmove" },
+        { "66410F6E8634060000", false, 'N', "movd" },
+        { "F0480FB15424F8", false, 'N', "cmpxchg" },
+        { "0F47C5", false, 'N', "cmova" },
+        { "0FBF15847A1400", true, 'N', "movsx" },
+        { "F390", false, 'N', "pause" },
+        { "400F96C5", false, 'N', "setbe" },
+        { "0F4CEA", false, 'N', "cmovl" },
+        { "390515121400", true, 'N', "cmp" },
+        { "C1C808", false, 'N', "ror" },
+        { "F048FF0D45D61300", true, 'N', "dec" },
+        { "F60546DE130002", true, 'N', "test" },
+        { "830DEADD130002", true, 'N', "or" },
+        { "F00FC11514D41300", true, 'N', "xadd" },
+        { "483394C880000000", false, 'N', "xor" },
+        { "0F90C0", false, 'N', "seto" },
+        { "0FC644243088", false, 'N', "shufps" },
+        { "7005", false, 'K', "jo" },
+        { "0FBCC7", false, 'N', "bsf" },
+        { "480FBCC7", false, 'N', "bsf" },
+        { "0F95442414", false, 'N', "setne" },
+        { "480F420424", false, 'N', "cmovb" },
+        { "430F920426", false, 'N', "setb" },
+        { "660F74C1", false, 'N', "pcmpeqb" },
+        { "660FDED8", false, 'N', "pmaxub" },
+        { "660F744F30", false, 'N', "pcmpeqb" },
+        { "FD", false, 'N', "std" },
+        { "FC", false, 'N', "cld" },
+        { "48FFC7", false, 'N', "inc" },
+        { "0F184E40", false, 'N', "prefetcht0" },
+        { "0F188E80000000", false, 'N', "prefetcht0" },
+        { "660FE707", false, 'N', "movntdq" },
+        { "660FE74F10", false, 'N', "movntdq" },
+        { "660FE7A700100000", false, 'N', "movntdq" },
+        { "0FAEF8", false, 'N', "sfence" },
+        { "66440FE78700200000", false, 'N', "movntdq" },
+        { "0FBDC0", false, 'N', "bsr" },
+        { "660FDAD5", false, 'N', "pminub" },
+        { "660F120F", false, 'N', "movlpd" },
+        { "660F164F08", false, 'N', "movhpd" },
+        { "66440FFCC1", false, 'N', "paddb" },
+        { "66440F64C6", false, 'N', "pcmpgtb" },
+        { "66440FDFC7", false, 'N', "pandn" },
+        { "660FF8C8", false, 'N', "psubb" },
+        { "91", false, 'N', "xchg" },
+        { "66440FD7C9", false, 'N', "pmovmskb" },
+        { "660F73FA0F", false, 'N', "pslldq" },
+        { "660F73DB01", false, 'N', "psrldq" },
+        { "660FDA6010", false, 'N', "pminub" },
+        { "66450FEFC9", false, 'N', "pxor" },
+        { "66420F6F4C1210", false, 'N', "movdqa" },
+        { "F3420F6F5C1010", false, 'N', "movdqu" },
+        { "480FABF2", false, 'N', "bts" },
+        { "C4E2A0F5DA", false, 'N', "bzhi" },
+        { "C4E1FB92CB", false, 'N', "kmovq" },
+        { "62F17FC96F0F", false, 'N', "vmovdqu8" },
+        { "62F2764926E1", false, 'N', "vptestnmb" },
+        { "C4E2A0F3D2", false, 'N', "blsmsk" },
+        { "62F27D487818", false, 'N', "vpbroadcastb" },
+        { "62F27D4878140F", false, 'N', "vpbroadcastb" },
+        { "62F37D483FC200", false, 'N', "vpcmpeqb" },
+        { "62F35D4A3FC104", false, 'N', "vpcmpneqb" },
+        { "C4E1F898C0", false, 'N', "kortestq" },
+        { "C4C2A0F3CB", false, 'N', "blsr" },
+        { "62D1FD486FB301000000", false, 'N', "vmovdqa64" },
+        { "62D165497433", false, 'N', "vpcmpeqb" },
+        { "62F1FE486F01", false, 'N', "vmovdqu64" },
+        { "C4E1EC46D2", false, 'N', "kxnorq" },
+        { "66410FEBDA", false, 'N', "por" },
+        { "F3C3", false, 'N', "ret" },
+        { "0F9CC0", false, 'N', "setl" },
+        { "660F76D0", false, 'N', "pcmpeqd" },
+        { "660F765710", false, 'N', "pcmpeqd" },
+        { "F30F7E06", false, 'N', "movq" },
+        { "4869342440420F00", false, 'N', "imul" },
+        { "DEE9", false, 'N', "fsubp" },
+        { "1D25FEFFFF", false, 'N', "sbb" },
+        { "4181D925FEFFFF", false, 'N', "sbb" },
+        { "660F6F842490000000", false, 'N', "movdqa" },
+        { "0F9DC2", false, 'N', "setge" },
+        { "FFB518FFFFFF", false, 'N', "push" },
+        { "48639424A0000000", false, 'N', "movsxd" },
+        { "480F4F8C24C0040000", false, 'N', "cmovg" },
+        { "440FB6253F771000", true, 'N', "movzx" },
+        { "410F118424180A0000", false, 'N', "movups" },
+        { "81A548FBFFFFFFFBFFFF", false, 'N', "and" },
+        { "480F467C2408", false, 'N', "cmovbe" },
+        { "440FB6842490000000", false, 'N', "movzx" },
+        { "400F97C7", false, 'N', "seta" },
+        { "660FFAC3", false, 'N', "psubd" },
+        { "410F9EC6", false, 'N', "setle" },
+        { "D1A398000000", false, 'N', "shl" },
+        { "66420FEB84B490280000", false, 'N', "por" },
+        { "F3410F6FBC30A8000000", false, 'N', "movdqu" },
+        { "660FDB0431", false, 'N', "pand" },
+        { "660FDB8424A0000000", false, 'N', "pand" },
+        { "66410FDB0C24", false, 'N', "pand" },
+        { "66410FDF0404", false, 'N', "pandn" },
+        { "410F29742410", false, 'N', "movaps" },
+        { "660FEB842490000000", false, 'N', "por" },
+        { "4881A42490000000FFFBFFFF", false, 'N', "and" },
+        { "4883A42490000000FE", false, 'N', "and" },
+        { "660FDF8C2490000000", false, 'N', "pandn" },
+        { "660FD69424EC010000", false, 'N', "movq" },
+        { "0F95842410020000", false, 'N', "setne" },
+        { "0F4E442470", false, 'N', "cmovle" },
+        { "440F44442408", false, 'N', "cmove" },
+        { "48F744241800000001", false, 'N', "test" },
+        { "41808C24A000000001", false, 'N', "or" },
+        { "81BC24880000000000FFFF", false, 'N', "cmp" },
+        { "660F6E9D10F9FFFF", false, 'N', "movd" },
+        { "0F168568F9FFFF", false, 'N', "movhps" },
+        { "8354243800", false, 'N', "adc" },
+        { "660F6AC0", false, 'N', "punpckhdq" },
+        { "0FA3C1", false, 'N', "bt" },
+        { "DEF9", false, 'N', "fdivp" },
+        { "0F01EE", false, 'N', "rdpkru" },
+        { "0F01EF", false, 'N', "wrpkru" },
+        { "F3490F2AC5", false, 'N', "cvtsi2ss" },
+        { "F30F2ACB", false, 'N', "cvtsi2ss" },
+        { "F30F5EC1", false, 'N', "divss" },
+        { "F30F2CC0", false, 'N', "cvttss2si" },
+        { "48F7B5F8FEFFFF", false, 'N', "div" },
+        { "410F16442408", false, 'N', "movhps" },
+        { "6641C1C408", false, 'N', "rol" },
+        { "66813D77400B000002", true, 'N', "cmp" },
+        { "F20F70C8E1", false, 'N', "pshuflw" },
+        { "660F71D008", false, 'N', "psrlw" },
+        { "660F71F108", false, 'N', "psllw" },
+        { "0F94842486000000", false, 'N', "sete" },
+        { "41818EF801000000002000", false, 'N', "or" },
+        { "33842488000000", false, 'N', "xor" },
+        { "660FD445B0", false, 'N', "paddq" },
+        { "49F77500", false, 'N', "div" },
+        { "F7E5", false, 'N', "mul" },
+        { "488105564C090080010000", true, 'N', "add" },
+        { "48812DD543090080010000", true, 'N', "sub" },
+        { "FFA038030000", false, 'N', "jmp" },
+        { "648704251C000000", false, 'N', "xchg" },
+        { "C5F96EC6", false, 'N', "vmovd" },
+        { "C4E27D78C0", false, 'N', "vpbroadcastb" },
+        { "C5FD740F", false, 'N', "vpcmpeqb" },
+        { "C5FDD7C1", false, 'N', "vpmovmskb" },
+        { "F30FBCC0", false, 'N', "tzcnt" },
+        { "C5FD744F01", false, 'N', "vpcmpeqb" },
+        { "C5EDEBE9", false, 'N', "vpor" },
+        { "C5FD748F81000000", false, 'N', "vpcmpeqb" },
+        { "C4E242F7C0", false, 'N', "sarx" },
+        { "C5FE6F0E", false, 'N', "vmovdqu" },
+        { "0F38F07C17FC", false, 'N', "movbe" },
+        { "480F38F007", false, 'N', "movbe" },
+        { "480F38F04417F8", false, 'N', "movbe" },
+        { "C5FD7F0F", false, 'N', "vmovdqa" },
+        { "C5FD7F5720", false, 'N', "vmovdqa" },
+        { "C5FE6FA600100000", false, 'N', "vmovdqu" },
+        { "C5FDE707", false, 'N', "vmovntdq" },
+        { "C5FDE74F20", false, 'N', "vmovntdq" },
+        { "C5FDE7A700100000", false, 'N', "vmovntdq" },
+        { "F30FBDC9", false, 'N', "lzcnt" },
+        { "F3480FBDC9", false, 'N', "lzcnt" },
+        { "C4E239F7C9", false, 'N', "shlx" },
+        { "C4E27958C0", false, 'N', "vpbroadcastd" },
+        { "C5F9D607", false, 'N', "vmovq" },
+        { "C5F9D64417F8", false, 'N', "vmovq" },
+        { "C5F97E4417FC", false, 'N', "vmovd" },
+        { "C5FD6F540E20", false, 'N', "vmovdqa" },
+        { "C5DDDAD5", false, 'N', "vpminub" },
+        { "C4A17A6F5C06F0", false, 'N', "vmovdqu" },
+        { "C44101EFFF", false, 'N', "vpxor" },
+        { "C57D6F15C9D40400", true, 'N', "vmovdqa" },
+        { "C4417DFCC2", false, 'N', "vpaddb" },
+        { "C4413D64C3", false, 'N', "vpcmpgtb" },
+        { "C4413DDFC4", false, 'N', "vpandn" },
+        { "C5EDDFC9", false, 'N', "vpandn" },
+        { "C5FA7E0417", false, 'N', "vmovq" },
+        { "C5F96E0417", false, 'N', "vmovd" },
+        { "C5FC2820", false, 'N', "vmovaps" },
+        { "C5DDDA6020", false, 'N', "vpminub" },
+        { "C5FC286840", false, 'N', "vmovaps" },
+        { "C4C17DD7C1", false, 'N', "vpmovmskb" },
+        { "C4E243F7C9", false, 'N', "shrx" },
+        { "C5FD76DA", false, 'N', "vpcmpeqd" },
+        { "C4E24D3BD2", false, 'N', "vpminud" },
+        { "C5FD764E20", false, 'N', "vpcmpeqd" },
+        { "C5FD764C06E0", false, 'N', "vpcmpeqd" },
+        { "C4E2753B5721", false, 'N', "vpminud" },
+        { "C5FD768F81000000", false, 'N', "vpcmpeqd" },
+        { "0F01D6", false, 'N', "xtest" },
+        { "C5FB93C0", false, 'N', "kmovd" },
+        { "62F3652825E2FE", false, 'N', "vpternlogd" },
+        { "62F36D223E0F04", false, 'N', "vpcmpnequb" },
+        { "62E1FE286F5601", false, 'N', "vmovdqu64" },
+        { "62F36D203E4F0104", false, 'N', "vpcmpnequb" },
+        { "62E1FE286F4C16FC", false, 'N', "vmovdqu64" },
+        { "62E1F520EF0F", false, 'N', "vpxorq" },
+        { "62E1ED20EF5701", false, 'N', "vpxorq" },
+        { "62E37520256703DE", false, 'N', "vpternlogd" },
+        { "62B25D2026CC", false, 'N', "vptestmb" },
+        { "62F375203E4C17FE04", false, 'N', "vpcmpnequb" },
+        { "62E1F520EF4C17FE", false, 'N', "vpxorq" },
+        { "62E1FD287F5701", false, 'N', "vmovdqa64" },
+        { "62E1FE286FA600100000", false, 'N', "vmovdqu64" },
+        { "62E17D28E707", false, 'N', "vmovntdq" },
+        { "62E17D28E74F01", false, 'N', "vmovntdq" },
+        { "62E17D28E7A700100000", false, 'N', "vmovntdq" },
+        { "62F37D203F4417FF00", false, 'N', "vpcmpeqb" },
+        { "62F37D203F480304", false, 'N', "vpcmpneqb" },
+        { "62A165A1DADA", false, 'N', "vpminub" },
+        { "C4E1F998E2", false, 'N', "kortestd" },
+        { "62E1FD286F540E01", false, 'N', "vmovdqa64" },
+        { "62E1FE086F9C16F1FFFFFF", false, 'N', "vmovdqu64" },
+        { "6261FD286F2D4CBE0300", true, 'N', "vmovdqa64" },
+        { "62017520F8DD", false, 'N', "vpsubb" },
+        { "629325203EEE01", false, 'N', "vpcmpltub" },
+        { "62A10525FCC9", false, 'N', "vpaddb" },
+        { "62E17520DA4801", false, 'N', "vpminub" },
+        { "C4E1F999C0", false, 'N', "ktestd" },
+        { "C4E1F545C0", false, 'N', "kord" },
+        { "C4E1F44BC0", false, 'N', "kunpckdq" },
+        { "62017520EFC8", false, 'N', "vpxord" },
+        { "62B2662027C3", false, 'N', "vptestnmd" },
+        { "62B375201FC200", false, 'N', "vpcmpeqd" },
+        { "62B365201FD104", false, 'N', "vpcmpneqd" },
+        { "62B2752027D1", false, 'N', "vptestmd" },
+        { "62F375221F4C06FF00", false, 'N', "vpcmpeqd" },
+        { "62E275203B5705", false, 'N', "vpminud" },
+        { "C5F54BC0", false, 'N', "kunpckbw" },
+        { "62E17E2A6F16", false, 'N', "vmovdqu32" },
+        { "62F36D201F4F0104", false, 'N', "vpcmpneqd" },
+        { "62F375201F4C97FE04", false, 'N', "vpcmpneqd" },
+        { "62F17C481006", false, 'N', "vmovups" },
+        { "62F17C48104E01", false, 'N', "vmovups" },
+        { "0F1816", false, 'N', "prefetcht1" },
+        { "0F185640", false, 'N', "prefetcht1" },
+        { "0F189680000000", false, 'N', "prefetcht1" },
+        { "C4E27100C0", false, 'N', "vpshufb" },
+        { "62F27D4818D0", false, 'N', "vbroadcastss" },
+        { "62F17C482917", false, 'N', "vmovaps" },
+        { "62F17C48295701", false, 'N', "vmovaps" },
+        { "0F2B4F10", false, 'N', "movntps" },
+        { "660FFCF9", false, 'N', "paddb" },
+        { "660F64FD", false, 'N', "pcmpgtb" },
+        { "660F3A63C11A", false, 'N', "pcmpistri" },
+        { "660F3A0F4417F001", false, 'N', "palignr" },
+        { "660F3A6304161A", false, 'N', "pcmpistri" },
+        { "660F3800C2", false, 'N', "pshufb" },
+        { "660F383B4050", false, 'N', "pminud" },
+        { "0FAE5C242C", false, 'N', "stmxcsr" },
+        { "D97424D8", false, 'N', "fnstenv" },
+        { "D96424D8", false, 'N', "fldenv" },
+        { "9B", false, 'N', "fwait" },
+        { "F30F5E0574790200", true, 'N', "divss" },
+        { "0F57C0", false, 'N', "xorps" },
+        { "48FF4D00", false, 'N', "dec" },
+        { "48813D7288530080DF4F00", true, 'N', "cmp" },
+        { "FF24C5404C6D00", false, 'N', "jmp" },
+        { "F30F7E83B4000000", false, 'N', "movq" },
+        { "FF15243E6100", true, 'N', "call" },
+        { "48832D5455610001", true, 'N', "sub" },
+        { "4981BC2490000000D0535400", false, 'N', "cmp" },
+        { "6641C1E908", false, 'N', "shr" },
+        { "F20F5AC0", false, 'N', "cvtsd2ss" },
+        { "F3410F110424", false, 'N', "movss" },
+        { "48F780A800000000000018", false, 'N', "test" },
+        { "660F6E0529492F00", true, 'N', "movd" },
+        { "48F77C2418", false, 'N', "idiv" },
+        { "F20F2AC8", false, 'N', "cvtsi2sd" },
+        { "F20F58842488000000", false, 'N', "addsd" },
+        { "48FF84FCB0020000", false, 'N', "inc" },
+        { "660F283C24", false, 'N', "movapd" },
+        { "660F2F3D7DA72F00", true, 'N', "comisd" },
+        { "F2480F2CC8", false, 'N', "cvttsd2si" },
+        { "F20F58442408", false, 'N', "addsd" },
+        { "F20F2CC0", false, 'N', "cvttsd2si" },
+        { "660F2F4C2428", false, 'N', "comisd" },
+        { "F20F5E351D5B3D00", true, 'N', "divsd" },
+        { "F2480F2A442448", false, 'N', "cvtsi2sd" },
+        { "0F9BC1", false, 'N', "setnp" },
+        { "F20F5C442408", false, 'N', "subsd" },
+        { "0F4D4C2424", false, 'N', "cmovge" },
+        { "4BC144900420", false, 'N', "rol" },
+        { "66430F6E445002", false, 'N', "movd" },
+        { "49FF442450", false, 'N', "inc" },
+        { "660F14C9", false, 'N', "unpcklpd" },
+        { "660F2E6C2408", false, 'N', "ucomisd" },
+        { "0F8B4AFFFFFF", false, 'K', "jnp" },
+        { "F2410F5C642418", false, 'N', "subsd" },
+        { "F2410F10442410", false, 'N', "movsd" },
+        { "F20F59442408", false, 'N', "mulsd" },
+        { "F2410F5800", false, 'N', "addsd" },
+        { "7B3B", false, 'K', "jnp" },
+        { "660F105010", false, 'N', "movupd" },
+        { "F20F5E442408", false, 'N', "divsd" },
+        { "F20F5880A85D8A00", false, 'N', "addsd" },
+        { "F2480F2A4D10", false, 'N', "cvtsi2sd" },
+        { "660F59C1", false, 'N', "mulpd" },
+        { "F20F590424", false, 'N', "mulsd" },
+        { "480FBA3D60615A003F", true, 'N', "btc" },
+        { "440F487C2414", false, 'N', "cmovs" },
+        { "48FF8088BAA500", false, 'N', "inc" },
+        { "440F2805F7C63E00", true, 'N', "movaps" },
+        { "F2440F103D6BC43E00", true, 'N', "movsd" },
+        { "F3440F7E357A662800", true, 'N', "movq" },
+        { "66450F14FF", false, 'N', "unpcklpd" },
+        { "660F2E4710", false, 'N', "ucomisd" },
+        { "41FF4C2404", false, 'N', "dec" },
+        { "660F57F8", false, 'N', "xorpd" },
+        { "660F28A0608DAC00", false, 'N', "movapd" },
+        { "F2480F2A05C81C5700", true, 'N', "cvtsi2sd" },
+        { "400F9AC7", false, 'N', "setp" },
+        { "660F5C3424", false, 'N', "subpd" },
+        { "660F5C6424E8", false, 'N', "subpd" },
+        { "400F9BC5", false, 'N', "setnp" },
+        { "48F77910", false, 'N', "idiv" },
+        { "660F586424E8", false, 'N', "addpd" },
+        { "660F15C0", false, 'N', "unpckhpd" },
+        { "660F595424E8", false, 'N', "mulpd" },
+        { "660F5CC8", false, 'N', "subpd" },
+        { "660F58D0", false, 'N', "addpd" },
+        { "66410FC4C701", false, 'N', "pinsrw" },
+        { "660FC4D601", false, 'N', "pinsrw" },
+        { "42FF24C530EA7100", false, 'N', "jmp" },
+        { "48C16C24080A", false, 'N', "shr" },
+        { "4881A3A8000000FFDFFFFF", false, 'N', "and" },
+        { "660FD4442430", false, 'N', "paddq" },
+        { "660F69CD", false, 'N', "punpckhwd" },
+        { "660F67C1", false, 'N', "packuswb" },
+        { "410F95442420", false, 'N', "setne" },
+        { "F20F5C4710", false, 'N', "subsd" },
+        { "48F75810", false, 'N', "neg" },
+        { "0FBE87A0A27300", false, 'N', "movsx" },
+        { "660F68C1", false, 'N', "punpckhbw" },
+        { "480FBF1485E0337400", false, 'N', "movsx" },
+        { "4C0F44BC24A8000000", false, 'N', "cmove" },
+        { "0F2F056FFE1B00", true, 'N', "comiss" },
+        { "F20F5E04C580107B00", false, 'N', "divsd" },
+        { "F20F5904FD80107B00", false, 'N', "mulsd" },
+        { "660F2E842488000000", false, 'N', "ucomisd" },
+        { "81AC248C00000000005003", false, 'N', "sub" },
+        { "66420F2E04DDA05EAC00", false, 'N', "ucomisd" },
+        { "F2420F5904DDA05EAC00", false, 'N', "mulsd" },
+        { "F2420F1104DDA05EAC00", false, 'N', "movsd" },
+        { "480FBAF93F", false, 'N', "btc" },
+        { "420F1604C5A0618500", false, 'N', "movhps" },
+        { "660F28642410", false, 'N', "movapd" },
+        { "F20F51C0", false, 'N', "sqrtsd" },
+        { "660F72D001", false, 'N', "psrld" },
+        { "66420F6E2C8D40C48500", false, 'N', "movd" },
+        { "F20FC2D806", false, 'N', "cmpnlesd" },
+        { "660F2F4710", false, 'N', "comisd" },
+        { "66440F70C155", false, 'N', "pshufd" },
+        { "66440F6AC1", false, 'N', "punpckhdq" },
+        { "66440F62C1", false, 'N', "punpckldq" },
+        { "66410F6CC8", false, 'N', "punpcklqdq" },
+        { "48F7742410", false, 'N', "div" },
+        { "F20F5FC2", false, 'N', "maxsd" },
+        { "F30F5A04B0", false, 'N', "cvtss2sd" },
+        { "66410F2F44C5F8", false, 'N', "comisd" },
+        { "660F73D308", false, 'N', "psrlq" },
+        { "660F73F138", false, 'N', "psllq" },
+        { "660FD48060FFFFFF", false, 'N', "paddq" },
+        { "F20FC2E501", false, 'N', "cmpltsd" },
+        { "660F5EF1", false, 'N', "divpd" },
+        { "0F2E15AEA62800", true, 'N', "ucomiss" },
+        { "660F72F10E", false, 'N', "pslld" },
+        { "660FFE442488", false, 'N', "paddd" },
+        { "0FC6C188", false, 'N', "shufps" },
+        { "660F65D0", false, 'N', "pcmpgtw" },
+        { "66440F69C2", false, 'N', "punpckhwd" },
+        { "66410FFEC0", false, 'N', "paddd" },
+        { "F20F5D05846B1000", true, 'N', "minsd" },
+        { "41FFB42440040000", false, 'N', "push" },
+        { "F20F1183A0000000", false, 'N', "movsd" },
+        { "F20F5F0D99B21100", true, 'N', "maxsd" },
+        { "480F494C2410", false, 'N', "cmovns" },
+        { "2305970E3C00", true, 'N', "and" },
+        { "F20F5983A0000000", false, 'N', "mulsd" },
+        { "66440F57E0", false, 'N', "xorpd" },
+        { "F2440F590DFF2F2000", true, 'N', "mulsd" },
+        { "F30F110498", false, 'N', "movss" },
+        { "0F4BD1", false, 'N', "cmovnp" },
+        { "660F10542420", false, 'N', "movupd" },
+        { "660F574424E8", false, 'N', "xorpd" },
+        { "66440F60C3", false, 'N', "punpcklbw" },
+        { "66440F61D3", false, 'N', "punpcklwd" },
+        { "66410F72F218", false, 'N', "pslld" },
+        { "0F96442426", false, 'N', "setbe" },
+        { "0F14C1", false, 'N', "unpcklps" },
+        { "0F134500", false, 'N', "movlps" },
+        { "D80565320E00", true, 'N', "fadd" },
+        { "DF3C24", false, 'N', "fistp" },
+        { "DCE1", false, 'N', "fsubr" },
+        { "F0410FC1442408", false, 'N', "xadd" },
+        { "66C70578D015000000", true, 'N', "mov" },
+        { "66440F6F1D9BE00C00", true, 'N', "movdqa" },
+        { "410FC6CD88", false, 'N', "shufps" },
+        { "490FBA78083F", false, 'N', "btc" },
+        { "0FC7F0", false, 'N', "rdrand" },
+        { "0FC7FA", false, 'N', "rdseed" },
+        { "440F29942420020000", false, 'N', "movaps" },
+        { "48F724DF", false, 'N', "mul" },
+        { "F3420F590490", false, 'N', "mulss" },
+        { "F3420F5E0490", false, 'N', "divss" },
+        { "480FBA6C245034", false, 'N', "bts" },
+        { "0F97442424", false, 'N', "seta" },
+        { "4883542430FF", false, 'N', "adc" },
+        { "D1CF", false, 'N', "ror" },
+        { "F30F5A442408", false, 'N', "cvtss2sd" },
+        { "480FACD008", false, 'N', "shrd" },
+        { "480FA4C201", false, 'N', "shld" },
+        { "48139D38FEFFFF", false, 'N', "adc" },
+        { "0F958570FEFFFF", false, 'N', "setne" },
+        { "48839508FFFFFFFF", false, 'N', "adc" },
+        { "0F938517FFFFFF", false, 'N', "setae" },
+        { "F3480F2CC0", false, 'N', "cvttss2si" },
+        { "F30F5C05DCD70100", true, 'N', "subss" },
+    };
+
+    // 64 位模式下无效的单字节操作码和 XOP 编码
+    const char* const INVALID[] = { "06", "07", "0E", "16", "17", "1E", "1F", "27", "2F", "37", "3F", "60", "61",
+        "82C001", "9A0000000000", "CE", "D40A", "D50A", "D6", "EA000000000000", "8FE87800C0" };
+
+    using CheckTool::Expect;
+
+    size_t FromHex(const char* hex, uint8_t* outBytes, size_t capacity) {
+        size_t size = strlen(hex) / 2;
+        for (size_t i = 0; i < size && i < capacity; i++) {
+            unsigned value = 0;
+            sscanf(hex + i * 2, "%2x", &value);
+            outBytes[i] = (uint8_t)value;
+        }
+        return size < capacity ? size : capacity;
+    }
+
+    X64BranchKind ToBranch(char kind) {
+        switch (kind) {
+        case 'J': return X64BranchKind::Jmp;
+        case 'K': return X64BranchKind::Jcc;
+        case 'C': return X64BranchKind::Call;
+        case 'L': return X64BranchKind::Loop;
+        default: return X64BranchKind::None;
+        }
+    }
+
+    bool CheckCorpus() {
+        bool ok = true;
+        size_t count = 0;
+        for (const CorpusEntry& entry : CORPUS) {
+            // 指令之后填 nop，解码器不能多读
+            uint8_t code[32];
+            memset(code, 0x90, sizeof(code));
+            size_t size = FromHex(entry.hex, code, sizeof(code));
+            X64Instruction instruction;
+            bool decoded = DecodeX64Instruction(code, sizeof(code), instruction);
+            bool same = entry.kind == 'X' ? !decoded :
+                decoded && instruction.length == size && instruction.ripRelative == entry.ripRelative &&
+                instruction.branch == ToBranch(entry.kind);
+            if (!same) {
+                printf("  FAIL %s %s: length %d, rip %d, branch %d\n", entry.mnemonic, entry.hex, decoded ? instruction.length : 0,
+                    decoded ? (int)instruction.ripRelative : 0, decoded ? (int)instruction.branch : 0);
+            }
+            if (entry.kind != 'X' && DecodeX64Instruction(code, size - 1, instruction)) {
+                printf("  FAIL %s %s: decoded from %zu bytes\n", entry.mnemonic, entry.hex, size - 1);
+                same = false;
+            }
+            ok = same && ok;
+            count++;
+        }
+        for (const char* hex : INVALID) {
+            uint8_t code[32];
+            memset(code, 0x90, sizeof(code));
+            FromHex(hex, code, sizeof(code));
+            X64Instruction instruction;
+            if (DecodeX64Instruction(code, sizeof(code), instruction)) {
+                printf("  FAIL invalid opcode %s decoded with length %d\n", hex, instruction.length);
+                ok = false;
+            }
+        }
+        return CheckTool::Report("corpus", ok, "%zu encodings", count);
+    }
+
+    // 按顺序解码，列出每条指令的跳转/调用目标和 RIP 相对操作数的地址
+    // 搬移生成的 jmp [rip+0]; dq / call [rip+2]; jmp +8; dq 按其中的绝对地址计
+    bool Targets(const uint8_t* code, size_t size, QWORD address, std::vector<QWORD>& outTargets) {
+        outTargets.clear();
+        size_t offset = 0;
+        while (offset < size) {
+            X64Instruction instruction;
+            if (!DecodeX64Instruction(code + offset, size - offset, instruction)) {
+                return false;
+            }
+            QWORD next = address + offset + instruction.length;
+            if (instruction.branch != X64BranchKind::None) {
+                int64_t displacement;
+                if (instruction.branchSize == 1) {
+                    displacement = (int8_t)code[offset + instruction.branchOffset];
+                } else {
+                    int32_t rel32;
+                    memcpy(&rel32, code + offset + instruction.branchOffset, sizeof(rel32));
+                    displacement = rel32;
+                }
+                outTargets.push_back(next + displacement);
+            } else if (instruction.ripRelative) {
+                int32_t rel32;
+                memcpy(&rel32, code + offset + instruction.displacementOffset, sizeof(rel32));
+                QWORD absolute;
+                if (code[offset] == 0xFF && code[offset + 1] == 0x25 && rel32 == 0 && offset + 14 <= size) {
+                    memcpy(&absolute, code + offset + 6, sizeof(absolute));
+                    outTargets.push_back(absolute);
+                    offset += 14;
+                    continue;
+                }
+                if (code[offset] == 0xFF && code[offset + 1] == 0x15 && rel32 == 2 && offset + 16 <= size) {
+                    memcpy(&absolute, code + offset + 8, sizeof(absolute));
+                    outTargets.push_back(absolute);
+                    offset += 16;
+                    continue;
+                }
+                outTargets.push_back(next + rel32);
+            }
+            offset += instruction.length;
+        }
+        return true;
+    }
+
+    bool Relocate(const uint8_t* code, size_t size, QWORD target, std::vector<uint8_t>& outCode) {
+        outCode.assign(256, 0);
+        X64Emitter emitter(outCode.data(), outCode.size(), target);
+        if (!RelocateX64Instructions(code, size, SOURCE, emitter)) {
+            return false;
+        }
+        outCode.resize(emitter.Size());
+        return true;
+    }
+
+    bool CheckRelocation() {
+        // 两个注入点的原始指令: 长度覆盖 5 字节，原样复制
+        const uint8_t weapon[] = { 0x48, 0x8B, 0xD5, 0x49, 0x8B, 0xCA };
+        const uint8_t armor[] = { 0x49, 0x8D, 0x8C, 0x24, 0x48, 0x01, 0x00, 0x00 };
+        std::vector<uint8_t> out;
+        bool ok = Expect(MeasureX64Instructions(weapon, sizeof(weapon), 5) == sizeof(weapon) &&
+            MeasureX64Instructions(armor, sizeof(armor), 5) == sizeof(armor), "site lengths");
+        ok = Expect(Relocate(weapon, sizeof(weapon), NEAR_TARGET, out) && out.size() == sizeof(weapon) &&
+            memcmp(out.data(), weapon, sizeof(weapon)) == 0, "plain instructions not copied as is") && ok;
+
+        // RIP 相对、带立即数的 RIP 相对、jne rel8、call rel32、jmp rel8
+        const uint8_t mixed[] = {
+            0x48, 0x8B, 0x05, 0x00, 0x01, 0x00, 0x00,           // mov rax,[rip+100]
+            0x80, 0x3D, 0x34, 0x12, 0x00, 0x00, 0x7F,           // cmp byte [rip+1234],7F
+            0x75, 0x20,                                         // jne +20
+            0xE8, 0x10, 0x00, 0x00, 0x00,                       // call +10
+            0xEB, 0xC0                                          // jmp -40
+        };
+        std::vector<QWORD> expected;
+        std::vector<QWORD> targets;
+        ok = Expect(Targets(mixed, sizeof(mixed), SOURCE, expected) && expected.size() == 5, "decode mixed") && ok;
+        ok = Expect(MeasureX64Instructions(mixed, sizeof(mixed), 5) == 7, "measure mixed") && ok;
+        for (QWORD target : { NEAR_TARGET, SOURCE - 0xF00 }) {
+            ok = Expect(Relocate(mixed, sizeof(mixed), target, out) && Targets(out.data(), out.size(), target, targets) &&
+                targets == expected, "near relocation changed a target") && ok;
+        }
+        ok = Expect(!Relocate(mixed, sizeof(mixed), FAR_TARGET, out), "unreachable rip-relative operand relocated") && ok;
+
+        // 只有分支时可以搬到远处: jcc 改为条件取反的短跳 + 绝对跳转，jmp/call 改为绝对形式
+        const uint8_t branches[] = {
+            0x75, 0x20,                                         // jne +20
+            0xE8, 0x10, 0x00, 0x00, 0x00,                       // call +10
+            0xEB, 0xF0,                                         // jmp -10
+            0x0F, 0x84, 0x00, 0x01, 0x00, 0x00                  // je +100
+        };
+        ok = Expect(Targets(branches, sizeof(branches), SOURCE, expected) && expected.size() == 4, "decode branches") && ok;
+        // targets[0] 和 targets[4] 是条件取反后跳过绝对跳转的短跳
+        bool far = Relocate(branches, sizeof(branches), FAR_TARGET, out) && Targets(out.data(), out.size(), FAR_TARGET, targets) &&
+            targets.size() == 6 && targets[1] == expected[0] && targets[2] == expected[1] && targets[3] == expected[2] &&
+            targets[5] == expected[3];
+        ok = Expect(far, "far relocation changed a branch target") && ok;
+
+        // 跳回被覆盖区域内部和 loop 无法搬移；跳回起点可以
+        const uint8_t inner[] = { 0x90, 0x90, 0x90, 0x75, 0xFC };
+        const uint8_t start[] = { 0x90, 0x90, 0x90, 0x75, 0xFB };
+        const uint8_t loop[] = { 0xE2, 0x10, 0x90, 0x90, 0x90 };
+        ok = Expect(!Relocate(inner, sizeof(inner), NEAR_TARGET, out), "branch into the overwritten range relocated") && ok;
+        ok = Expect(Relocate(start, sizeof(start), NEAR_TARGET, out), "branch to the start not relocated") && ok;
+        ok = Expect(!Relocate(loop, sizeof(loop), NEAR_TARGET, out), "loop relocated") && ok;
+        return CheckTool::Report("relocation", ok);
+    }
+
+    bool CheckRandom() {
+        std::mt19937 rng(1);
+        bool ok = true;
+        long accepted = 0;
+        for (int i = 0; i < RANDOM_ITERATIONS && ok; i++) {
+            uint8_t code[15];
+            size_t size = 1 + rng() % sizeof(code);
+            for (size_t b = 0; b < size; b++) {
+                code[b] = (uint8_t)rng();
+            }
+            X64Instruction instruction;
+            if (DecodeX64Instruction(code, size, instruction)) {
+                ok = Expect(instruction.length > 0 && instruction.length <= size, "decoded past the available bytes");
+                accepted++;
+            }
+        }
+        return CheckTool::Report("random bytes", ok, "%ld of %d decoded", accepted, RANDOM_ITERATIONS);
+    }
+}
+
+int main(int argc, char** argv) {
+    return CheckTool::Run(argc, argv, "decoder", { CheckCorpus, CheckRelocation, CheckRandom });
+}
@@ -0,0 +1,152 @@
+// 指令编码器检查 (不需要游戏进程)
+//
+// 用法:
+//   emitter_check [--check]
+//
+// 每条用例在固定的目标地址上生成指令，与参考编码逐字节比较 (参考编码已用 objdump 反汇编核对)。
+// 要求:
+//   每个编码方法生成的字节与参考编码相同，包括 REX 前缀、rsp/r12 基址的 SIB、rbp/r13 基址的 disp8、
+//   RIP 相对位移 (相对下一条指令)、rel32 可达与不可达时的跳转/调用形式和标签的前向/后向回填；
+//   RIP 相对位移或 rel32 超出范围、缓冲区不足时 Ok() 为 false。
+
+#include "check_tool.h"
+#include "x64_emitter.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    constexpr QWORD BASE = 0x140100000ull;
+    constexpr QWORD FAR_TARGET = 0x7FF612345678ull;
+
+    struct EncodingCase {
+        const char* name;
+        const char* expected;       // 十六进制
+        void (*emit)(X64Emitter& emitter);
+    };
+
+    const EncodingCase CASES[] = {
+        { "mov [rip],rbp", "48892DF9000000", [](X64Emitter& e) { e.MovRipStore(BASE + 0x100, X64Reg::Rbp); } },
+        { "mov [rip],r12", "4C8925F9000000", [](X64Emitter& e) { e.MovRipStore(BASE + 0x100, X64Reg::R12); } },
+        { "mov r9,[rip]", "4C8B0DF9DFFFFF", [](X64Emitter& e) { e.MovRipLoad(X64Reg::R9, BASE - 0x2000); } },
+        { "mov r11,imm64", "49BB8877665544332211", [](X64Emitter& e) { e.MovImm64(X64Reg::R11, 0x1122334455667788ull); } },
+        { "mov eax,imm32", "B801000000", [](X64Emitter& e) { e.MovImm32(X64Reg::Rax, 1); } },
+        { "mov r8d,imm32", "41B800000080", [](X64Emitter& e) { e.MovImm32(X64Reg::R8, 0x80000000u); } },
+        { "mov rcx,rax", "4889C1", [](X64Emitter& e) { e.MovReg(X64Reg::Rcx, X64Reg::Rax); } },
+        { "mov r10,rsp", "4989E2", [](X64Emitter& e) { e.MovReg(X64Reg::R10, X64Reg::Rsp); } },
+        { "mov [rdx+18],rax", "48894218", [](X64Emitter& e) { e.MovStore(X64Reg::Rdx, 0x18, X64Reg::Rax); } },
+        { "mov [r13-8],r9", "4D894DF8", [](X64Emitter& e) { e.MovStore(X64Reg::R13, -8, X64Reg::R9); } },
+        { "mov [rsp+10],rcx", "48894C2410", [](X64Emitter& e) { e.MovStore(X64Reg::Rsp, 0x10, X64Reg::Rcx); } },
+        { "mov [rbp],rax", "48894500", [](X64Emitter& e) { e.MovStore(X64Reg::Rbp, 0, X64Reg::Rax); } },
+        { "mov rax,[rdx+100]", "488B8200010000", [](X64Emitter& e) { e.MovLoad(X64Reg::Rax, X64Reg::Rdx, 0x100); } },
+        { "mov r12,[r12]", "4D8B642400", [](X64Emitter& e) { e.MovLoad(X64Reg::R12, X64Reg::R12, 0); } },
+        { "and rcx,[rax+8]", "48234808", [](X64Emitter& e) { e.AndLoad(X64Reg::Rcx, X64Reg::Rax, 8); } },
+        { "xor rdx,[r8+10]", "49335010", [](X64Emitter& e) { e.XorLoad(X64Reg::Rdx, X64Reg::R8, 0x10); } },
+        { "cmp rax,[rip]", "483B05F9010000", [](X64Emitter& e) { e.CmpRip(X64Reg::Rax, BASE + 0x200); } },
+        { "lock cmpxchg [rdx+8],rcx", "F0480FB14A08", [](X64Emitter& e) { e.LockCmpxchg(X64Reg::Rdx, 8, X64Reg::Rcx); } },
+        { "lock add [rax],rdx", "F048015000", [](X64Emitter& e) { e.LockAdd(X64Reg::Rax, 0, X64Reg::Rdx); } },
+        { "lea rdx,[rip]", "488D15F9EFFFFF", [](X64Emitter& e) { e.LeaRip(X64Reg::Rdx, BASE - 0x1000); } },
+        { "lock xadd [rip],rax", "F0480FC105F7000000", [](X64Emitter& e) { e.LockXaddRip(BASE + 0x100, X64Reg::Rax); } },
+        { "lock cmpxchg [rip],r9", "F04C0FB10DF7000000", [](X64Emitter& e) { e.LockCmpxchgRip(BASE + 0x100, X64Reg::R9); } },
+        { "add rax,rcx", "4801C8", [](X64Emitter& e) { e.AddReg(X64Reg::Rax, X64Reg::Rcx); } },
+        { "sub r8,rdx", "4929D0", [](X64Emitter& e) { e.SubReg(X64Reg::R8, X64Reg::Rdx); } },
+        { "or rcx,r10", "4C09D1", [](X64Emitter& e) { e.OrReg(X64Reg::Rcx, X64Reg::R10); } },
+        { "xor rax,rax", "4831C0", [](X64Emitter& e) { e.XorReg(X64Reg::Rax, X64Reg::Rax); } },
+        { "test rdx,rdx", "4885D2", [](X64Emitter& e) { e.TestReg(X64Reg::Rdx, X64Reg::Rdx); } },
+        { "cmp rcx,rax", "4839C1", [](X64Emitter& e) { e.CmpReg(X64Reg::Rcx, X64Reg::Rax); } },
+        { "bsr rcx,rdx", "480FBDCA", [](X64Emitter& e) { e.Bsr(X64Reg::Rcx, X64Reg::Rdx); } },
+        { "add rsp,28", "4883C428", [](X64Emitter& e) { e.AddImm8(X64Reg::Rsp, 0x28); } },
+        { "and rcx,ff", "4881E1FF000000", [](X64Emitter& e) { e.AndImm32(X64Reg::Rcx, 0xFF); } },
+        { "or rax,1", "4883C801", [](X64Emitter& e) { e.OrImm8(X64Reg::Rax, 1); } },
+        { "shl rax,8", "48C1E008", [](X64Emitter& e) { e.ShlImm8(X64Reg::Rax, 8); } },
+        { "inc r11", "49FFC3", [](X64Emitter& e) { e.Inc(X64Reg::R11); } },
+        { "dec rcx", "48FFC9", [](X64Emitter& e) { e.Dec(X64Reg::Rcx); } },
+        { "rdtsc", "0F31", [](X64Emitter& e) { e.Rdtsc(); } },
+        { "push/pop", "504150415F59", [](X64Emitter& e) {
+            e.Push(X64Reg::Rax); e.Push(X64Reg::R8); e.Pop(X64Reg::R15); e.Pop(X64Reg::Rcx);
+        } },
+        { "pushfq/popfq", "9C9D", [](X64Emitter& e) { e.Pushfq(); e.Popfq(); } },
+        { "lahf/seto/add al/sahf", "9F0F90C0047F9E", [](X64Emitter& e) { e.Lahf(); e.SetoAl(); e.AddAlImm8(0x7F); e.Sahf(); } },
+        { "jmp rel32", "E9FBEFFFFF", [](X64Emitter& e) { e.JmpRel32(BASE - 0x1000); } },
+        { "jmp abs", "FF250000000078563412F67F0000", [](X64Emitter& e) { e.JmpAbs(FAR_TARGET); } },
+        { "jmp near", "E9FB0F0000", [](X64Emitter& e) { e.Jmp(BASE + 0x1000); } },
+        { "jmp far", "FF250000000078563412F67F0000", [](X64Emitter& e) { e.Jmp(FAR_TARGET); } },
+        { "jne near", "0F853A000000", [](X64Emitter& e) { e.Jcc(X64Cond::NotEqual, BASE + 0x40); } },
+        { "jbe far", "770EFF250000000078563412F67F0000", [](X64Emitter& e) { e.Jcc(X64Cond::BelowOrEqual, FAR_TARGET); } },
+        { "call near", "E8FBFFEFFF", [](X64Emitter& e) { e.Call(BASE - 0x100000); } },
+        { "call far", "FF1502000000EB0878563412F67F0000", [](X64Emitter& e) { e.Call(FAR_TARGET); } },
+        // je forward; nop; nop; jmp back; jmp forward; forward: rdtsc
+        { "labels", "0F840C0000009090E9F3FFFFFFE9000000000F31", [](X64Emitter& e) {
+            X64Label forward;
+            X64Label back;
+            e.Bind(back);
+            e.Jcc(X64Cond::Equal, forward);
+            e.Nop(2);
+            e.Jmp(back);
+            e.Jmp(forward);
+            e.Bind(forward);
+            e.Rdtsc();
+        } },
+    };
+
+    // 不能编码的情况
+    const EncodingCase FAILURES[] = {
+        { "rip store out of range", nullptr, [](X64Emitter& e) { e.MovRipStore(FAR_TARGET, X64Reg::Rax); } },
+        { "rip load out of range", nullptr, [](X64Emitter& e) { e.MovRipLoad(X64Reg::Rax, BASE + 0x80000010ull); } },
+        { "lock xadd out of range", nullptr, [](X64Emitter& e) { e.LockXaddRip(BASE - 0x80000100ull, X64Reg::Rax); } },
+        { "jmp rel32 out of range", nullptr, [](X64Emitter& e) { e.JmpRel32(FAR_TARGET); } },
+        { "buffer full", nullptr, [](X64Emitter& e) { e.Nop(15); e.JmpAbs(FAR_TARGET); } },
+    };
+
+    bool Expect(bool condition, const char* what, const char* name) {
+        if (!condition) {
+            printf("  FAIL %s: %s\n", name, what);
+        }
+        return condition;
+    }
+
+    void ToHex(const uint8_t* bytes, size_t size, char* outText) {
+        for (size_t i = 0; i < size; i++) {
+            snprintf(outText + i * 2, 3, "%02X", bytes[i]);
+        }
+        outText[size * 2] = '\0';
+    }
+
+    bool CheckEncodings() {
+        bool ok = true;
+        for (const EncodingCase& encoding : CASES) {
+            uint8_t buffer[64];
+            char text[sizeof(buffer) * 2 + 1];
+            X64Emitter emitter(buffer, sizeof(buffer), BASE);
+            encoding.emit(emitter);
+            ToHex(buffer, emitter.Size(), text);
+            bool same = emitter.Ok() && strcmp(text, encoding.expected) == 0;
+            if (!same) {
+                printf("  FAIL %s: %s, expected %s\n", encoding.name, text, encoding.expected);
+            }
+            ok = same && ok;
+        }
+        return CheckTool::Report("encodings", ok);
+    }
+
+    bool CheckFailures() {
+        bool ok = true;
+        for (const EncodingCase& failure : FAILURES) {
+            uint8_t buffer[16];
+            X64Emitter emitter(buffer, sizeof(buffer), BASE);
+            failure.emit(emitter);
+            ok = Expect(!emitter.Ok(), "encoded without failing", failure.name) && ok;
+        }
+
+        // rel32 可达范围的边界 (相对下一条指令)
+        const QWORD next = BASE + X64Emitter::JMP_REL32_SIZE;
+        ok = Expect(X64Emitter::IsRel32Reachable(next, next + 0x7FFFFFFFull) &&
+            !X64Emitter::IsRel32Reachable(next, next + 0x80000000ull) &&
+            X64Emitter::IsRel32Reachable(next, next - 0x80000000ull) &&
+            !X64Emitter::IsRel32Reachable(next, next - 0x80000001ull), "rel32 range", "reachable") && ok;
+        return CheckTool::Report("failures", ok);
+    }
+}
+
+int main(int argc, char** argv) {
+    return CheckTool::Run(argc, argv, "emitter", { CheckEncodings, CheckFailures });
+}
@@ -0,0 +1,360 @@
+// 结构扫描基准 (预筛内核 + 植入装备记录的合成堆)
+//
+// 用法:
+//   equipment_bench [--heap-mb N] [--threads N]
+//   equipment_bench --check               只用小快照检查正确性
+//
+// 在本进程内存中生成合成的目标进程快照: 主模块 + 若干 16MB 堆区域，堆中混有 0、指针、随机数、
+// 成对的小整数、浮点数和 int16 小整数数组 (后者常常能通过物品 ID / 等级的预筛)。
+// 在随机选出的页中植入装备记录 (单独的，或 stride 为 0x140 的内联数组) 和 "近似记录"
+// (只有一处不合理: 词条等级过大、词条 ID 为 0、地狱标志没有地狱技能、没有词条)。
+// 报告预筛和完整扫描的吞吐、预筛通过率、召回率 (找到的植入记录 / 植入记录) 和精确率 (植入记录 / 找到的记录)。
+// --check 要求: SSE2 与逐个判断的预筛结果相同，召回率和精确率都为 1，近似记录全部被拒绝，
+// 单线程与多线程结果相同，maxResults 只保留地址最低的记录。
+
+#include "equipment_scan.h"
+#include "snapshot_memory.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+    constexpr QWORD MODULE_BASE = 0x140000000ull;
+    constexpr QWORD MODULE_SIZE = 0x400000;
+    constexpr QWORD DATA_OFFSET = 0x200000;         // .data 段 (可读写)
+    constexpr QWORD DATA_SIZE = 0x100000;
+    constexpr QWORD HEAP_REGION_SIZE = 0x1000000;
+    constexpr uint32_t ARRAY_STRIDE = 0x140;
+    constexpr uint32_t ARRAY_MAX_COUNT = 0x1000 / ARRAY_STRIDE;
+    constexpr uint32_t RECORD_SIZE = EquipmentScanLayout::RECORD_SIZE;
+
+    double Seconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template <typename T>
+    void Store(uint8_t* record, int offset, T value) {
+        memcpy(record + offset, &value, sizeof(value));
+    }
+
+    // 一条合理的装备记录
+    void MakeRecord(uint8_t* record, std::mt19937_64& random) {
+        for (uint32_t i = 0; i < RECORD_SIZE; i++) {
+            record[i] = (uint8_t)random();
+        }
+        Store<int16_t>(record, EquipmentLayout::ITEM_ID_OFFSET, (int16_t)(1 + random() % 0x5000));
+        Store<int16_t>(record, EquipmentLayout::TRANSMOG_ID_OFFSET, (int16_t)(random() % 0x5000));
+        Store<int16_t>(record, EquipmentLayout::LEVEL_OFFSET, (int16_t)(1 + random() % 800));
+        Store<int32_t>(record, EquipmentLayout::QUALITY_OFFSET, (int32_t)(random() % 6));
+
+        bool underworld = random() % 10 == 0;
+        uint8_t& flags = record[EquipmentLayout::UNDERWORLD_FLAG_OFFSET];
+        flags = (uint8_t)((flags & ~(1u << EquipmentLayout::UNDERWORLD_FLAG_BIT)) | (underworld ? 1u << EquipmentLayout::UNDERWORLD_FLAG_BIT : 0));
+        Store<int32_t>(record, EquipmentLayout::UNDERWORLD_SKILL_ID_OFFSET, underworld ? (int32_t)(1 + random() % 500) : 0);
+
+        int affixes = 1 + (int)(random() % MemoryLayout::AFFIX_SLOT_COUNT);
+        for (int slot = 0; slot < MemoryLayout::AFFIX_SLOT_COUNT; slot++) {
+            bool used = slot < affixes;
+            Store<int32_t>(record, MemoryLayout::GetAffixIdOffset(slot), used ? (int32_t)(1000 + random() % 200000) : EquipmentScanLayout::EMPTY_AFFIX_ID);
+            Store<int32_t>(record, MemoryLayout::GetAffixLevelOffset(slot), used ? (int32_t)(random() % 300) : 0);
+        }
+    }
+
+    // 只有一处不合理的记录
+    void MakeDecoy(uint8_t* record, std::mt19937_64& random) {
+        MakeRecord(record, random);
+        switch (random() % 4) {
+        case 0:
+            Store<int32_t>(record, MemoryLayout::GetAffixLevelOffset(0), 5000);
+            break;
+        case 1:
+            Store<int32_t>(record, MemoryLayout::GetAffixIdOffset((int)(random() % MemoryLayout::AFFIX_SLOT_COUNT)), 0);
+            break;
+        case 2:
+            record[EquipmentLayout::UNDERWORLD_FLAG_OFFSET] |= 1u << EquipmentLayout::UNDERWORLD_FLAG_BIT;
+            Store<int32_t>(record, EquipmentLayout::UNDERWORLD_SKILL_ID_OFFSET, 0);
+            break;
+        default:
+            for (int slot = 0; slot < MemoryLayout::AFFIX_SLOT_COUNT; slot++) {
+                Store<int32_t>(record, MemoryLayout::GetAffixIdOffset(slot), EquipmentScanLayout::EMPTY_AFFIX_ID);
+            }
+            break;
+        }
+    }
+
+    // 堆中的其它数据，按 qword 分类混合
+    void FillNoise(uint8_t* data, size_t size, const std::vector<QWORD>& heaps, std::mt19937_64& random) {
+        for (size_t i = 0; i + 8 <= size; i += 8) {
+            uint64_t r = random();
+            uint64_t word = 0;
+            switch (r % 20) {
+            case 0: case 1: case 2: case 3: case 4: case 5: case 6: case 7:
+                break;
+            case 8: case 9: case 10: case 11:
+                word = heaps[(r >> 8) % heaps.size()] + ((r >> 16) % HEAP_REGION_SIZE & ~7ull);
+                break;
+            case 12: case 13: case 14:
+                word = random();
+                break;
+            case 15: case 16:
+                word = ((r >> 8) % 100) | (((r >> 24) % 100) << 32);
+                break;
+            case 17: case 18: {
+                float values[2] = { (float)((r >> 8) % 1000) / 10.0f, 1.0f };
+                memcpy(&word, values, sizeof(word));
+                break;
+            }
+            default:
+                for (int lane = 0; lane < 4; lane++) {
+                    word |= ((r >> (8 + lane * 8)) % 50) << (lane * 16);
+                }
+                break;
+            }
+            memcpy(data + i, &word, sizeof(word));
+        }
+    }
+
+    struct Snapshot {
+        SnapshotMemory memory;
+        std::vector<QWORD> planted;     // 升序
+        uint32_t decoys = 0;
+    };
+
+    void Generate(Snapshot& snapshot, uint64_t seed, uint32_t heapMb) {
+        std::mt19937_64 random(seed);
+        SnapshotMemory& memory = snapshot.memory;
+        memory.regions.clear();
+        memory.moduleBase = MODULE_BASE;
+        memory.moduleSize = MODULE_SIZE;
+        memory.regions.push_back({ MODULE_BASE, MemProtect::ExecuteRead, MemType::Image, std::vector<uint8_t>(DATA_OFFSET) });
+        memory.regions.push_back({ MODULE_BASE + DATA_OFFSET, MemProtect::ReadWrite, MemType::Image, std::vector<uint8_t>(DATA_SIZE) });
+        memory.regions.push_back({ MODULE_BASE + DATA_OFFSET + DATA_SIZE, MemProtect::ReadOnly, MemType::Image,
+            std::vector<uint8_t>(MODULE_SIZE - DATA_OFFSET - DATA_SIZE) });
+
+        uint32_t heapRegions = std::max(1u, heapMb * 0x100000 / (uint32_t)HEAP_REGION_SIZE);
+        QWORD heapBase = 0x20000000000ull;
+        std::vector<QWORD> heaps;
+        for (uint32_t i = 0; i < heapRegions; i++) {
+            heaps.push_back(heapBase);
+            heapBase += HEAP_REGION_SIZE + (1 + random() % 16) * 0x10000;
+        }
+        FillNoise(memory.regions[1].bytes.data(), DATA_SIZE, heaps, random);
+        for (QWORD heap : heaps) {
+            memory.regions.push_back({ heap, MemProtect::ReadWrite, MemType::Private, std::vector<uint8_t>(HEAP_REGION_SIZE) });
+            FillNoise(memory.regions.back().bytes.data(), HEAP_REGION_SIZE, heaps, random);
+        }
+
+        // 每个选中的页放一条单独的记录、一个内联数组或一条近似记录，页之间互不重叠
+        const uint32_t pagesPerHeap = (uint32_t)(HEAP_REGION_SIZE / 0x1000);
+        const uint32_t totalPages = pagesPerHeap * heapRegions;
+        std::unordered_set<uint32_t> used;
+        snapshot.planted.clear();
+        snapshot.decoys = 0;
+        for (uint32_t n = 0; n < heapMb * 16; n++) {
+            uint32_t page = (uint32_t)(random() % totalPages);
+            if (!used.insert(page).second) {
+                continue;
+            }
+            QWORD pageAddress = heaps[page / pagesPerHeap] + (QWORD)(page % pagesPerHeap) * 0x1000;
+            uint32_t kind = (uint32_t)(random() % 4);
+            if (kind == 0) {
+                MakeDecoy(memory.At(pageAddress + (random() % 0xE0) * 16, RECORD_SIZE), random);
+                snapshot.decoys++;
+            } else if (kind == 1) {
+                uint32_t count = 2 + (uint32_t)(random() % (ARRAY_MAX_COUNT - 1));
+                for (uint32_t i = 0; i < count; i++) {
+                    QWORD address = pageAddress + i * ARRAY_STRIDE;
+                    MakeRecord(memory.At(address, RECORD_SIZE), random);
+                    snapshot.planted.push_back(address);
+                }
+            } else {
+                QWORD address = pageAddress + (random() % 0xE0) * 16;
+                MakeRecord(memory.At(address, RECORD_SIZE), random);
+                snapshot.planted.push_back(address);
+            }
+        }
+        std::sort(snapshot.planted.begin(), snapshot.planted.end());
+    }
+
+    EquipmentScanConfig MakeConfig(uint32_t threads) {
+        EquipmentScanConfig config;
+        memset(&config, 0, sizeof(config));
+        config.threads = threads;
+        return NormalizeEquipmentScanConfig(config);
+    }
+
+    // 预筛内核: 整个堆上 SSE2 与逐个判断的吞吐和结果
+    bool BenchPrefilter(Snapshot& snapshot, bool checkOnly) {
+        const EquipmentScanConfig config = MakeConfig(1);
+        const int rounds = checkOnly ? 1 : 4;
+        double seconds[2] = { 0, 0 };
+        uint64_t passed[2] = { 0, 0 };
+        uint64_t bytes = 0;
+        std::vector<uint64_t> bits[2];
+
+        for (const SnapshotMemory::Region& region : snapshot.memory.regions) {
+            if (region.protect != MemProtect::ReadWrite) {
+                continue;
+            }
+            size_t positions = (region.bytes.size() - RECORD_SIZE) / EquipmentScanLayout::RECORD_ALIGN + 1;
+            bytes += region.bytes.size();
+            for (int simd = 0; simd < 2; simd++) {
+                bits[simd].resize((positions + 63) / 64);
+                auto start = std::chrono::steady_clock::now();
+                for (int round = 0; round < rounds; round++) {
+                    PrefilterEquipmentRecords(region.bytes.data(), positions, config, bits[simd].data(), simd != 0);
+                }
+                seconds[simd] += Seconds(start);
+                for (uint64_t word : bits[simd]) {
+                    for (; word != 0; word &= word - 1) {
+                        passed[simd]++;
+                    }
+                }
+            }
+            if (bits[0] != bits[1]) {
+                fprintf(stderr, "SIMD and scalar prefilters disagree\n");
+                return false;
+            }
+        }
+
+        double gigabytes = (double)bytes * rounds / 1e9;
+        printf("prefilter    scalar %.2f GB/s, simd %.2f GB/s, %llu of %llu positions pass (%.3f%%)\n\n",
+            gigabytes / seconds[0], gigabytes / seconds[1], (unsigned long long)passed[1],
+            (unsigned long long)(bytes / EquipmentScanLayout::RECORD_ALIGN), 100.0 * passed[1] / (bytes / EquipmentScanLayout::RECORD_ALIGN));
+        return true;
+    }
+
+    struct Score {
+        uint64_t truePositives = 0;
+        uint64_t falsePositives = 0;
+    };
+
+    Score Compare(const std::vector<QWORD>& found, const std::vector<QWORD>& planted) {
+        Score score;
+        for (QWORD base : found) {
+            if (std::binary_search(planted.begin(), planted.end(), base)) {
+                score.truePositives++;
+            } else {
+                score.falsePositives++;
+            }
+        }
+        return score;
+    }
+
+    bool BenchScan(Snapshot& snapshot, uint32_t threads, bool checkOnly) {
+        printf("%-10s %8s %10s %10s %12s %10s %10s %8s %10s\n", "run", "threads", "ms", "GB/s", "candidates",
+            "records", "planted", "recall", "precision");
+
+        std::vector<QWORD> reference;
+        std::vector<uint8_t> referenceRecords;
+        for (uint32_t run = 0; run < (threads > 1 ? 2u : 1u); run++) {
+            uint32_t runThreads = run == 0 ? 1 : threads;
+            EquipmentScanConfig config = MakeConfig(runThreads);
+            config.maxResults = (uint32_t)snapshot.planted.size() * 4;
+            std::vector<QWORD> bases;
+            std::vector<uint8_t> records;
+            EquipmentScanStats stats;
+            if (!ScanEquipmentRecords(&snapshot.memory, config, bases, records, stats)) {
+                fprintf(stderr, "scan failed\n");
+                return false;
+            }
+
+            Score score = Compare(bases, snapshot.planted);
+            double recall = snapshot.planted.empty() ? 1.0 : (double)score.truePositives / snapshot.planted.size();
+            double precision = bases.empty() ? 1.0 : (double)score.truePositives / bases.size();
+            printf("%-10s %8u %10.1f %10.2f %12llu %10zu %10zu %8.4f %10.4f\n", run == 0 ? "single" : "parallel",
+                stats.threads, stats.microseconds / 1000.0, stats.scannedBytes / 1e3 / std::max<uint64_t>(stats.microseconds, 1),
+                (unsigned long long)stats.candidates, bases.size(), snapshot.planted.size(), recall, precision);
+
+            if (run == 0) {
+                reference = bases;
+                referenceRecords = records;
+            } else if (bases != reference || records != referenceRecords) {
+                fprintf(stderr, "parallel scan returned different records\n");
+                return false;
+            }
+            if (checkOnly && (score.truePositives != snapshot.planted.size() || score.falsePositives != 0)) {
+                fprintf(stderr, "recall or precision below 1 (%llu false positives, %u decoys planted)\n",
+                    (unsigned long long)score.falsePositives, snapshot.decoys);
+                return false;
+            }
+        }
+
+        // 记录内容与快照一致
+        for (size_t i = 0; i < reference.size(); i++) {
+            if (memcmp(snapshot.memory.At(reference[i], RECORD_SIZE), referenceRecords.data() + i * RECORD_SIZE, RECORD_SIZE) != 0) {
+                fprintf(stderr, "record contents differ at 0x%llX\n", (unsigned long long)reference[i]);
+                return false;
+            }
+        }
+
+        // maxResults: 只保留地址最低的记录
+        if (checkOnly) {
+            EquipmentScanConfig config = MakeConfig(threads);
+            config.maxResults = 10;
+            std::vector<QWORD> bases;
+            std::vector<uint8_t> records;
+            EquipmentScanStats stats;
+            if (!ScanEquipmentRecords(&snapshot.memory, config, bases, records, stats) || !stats.truncated ||
+                !std::equal(bases.begin(), bases.end(), reference.begin()) || bases.size() != 10 ||
+                records.size() != 10 * RECORD_SIZE) {
+                fprintf(stderr, "maxResults was not applied\n");
+                return false;
+            }
+        }
+        printf("\n");
+        return true;
+    }
+
+    struct Options {
+        uint32_t heapMb = 1024;
+        uint32_t threads = 0;
+        bool checkOnly = false;
+    };
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--check") == 0) {
+            options.checkOnly = true;
+        } else if (strcmp(argv[i], "--heap-mb") == 0 && hasValue) {
+            options.heapMb = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        } else {
+            fprintf(stderr, "usage: %s [--check] [--heap-mb N] [--threads N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (options.checkOnly) {
+        options.heapMb = 32;
+        options.threads = options.threads != 0 ? options.threads : 4;
+    }
+    if (options.heapMb == 0) {
+        fprintf(stderr, "invalid options\n");
+        return 2;
+    }
+    const uint32_t threads = options.threads != 0 ? options.threads : std::max(2u, std::thread::hardware_concurrency());
+
+    Snapshot* snapshot = new Snapshot();
+    Generate(*snapshot, 0xE0E0, options.heapMb);
+    printf("heap %u MB, %zu records and %u near-misses planted, %u threads\n\n", options.heapMb,
+        snapshot->planted.size(), snapshot->decoys, threads);
+
+    bool ok = BenchPrefilter(*snapshot, options.checkOnly) && BenchScan(*snapshot, threads, options.checkOnly);
+    delete snapshot;
+    if (!ok) {
+        fprintf(stderr, "equipment scan checks failed\n");
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,356 @@
+// 字段发现: 分析录制的样本文件，或用植入字段的合成样本校验和计时
+//
+// 用法:
+//   field_analyze <samples.n3fs> [--scalar]      分析录制的样本文件 (SessionSaveFieldSamples 写出)，按偏移列出候选字段
+//   field_analyze --synthetic N [--save path]    生成 N 条合成样本，分别用 SSE2 和逐个计算的实现分析并计时
+//   field_analyze --check                        只用合成样本检查正确性
+//
+// 合成样本: 0x100 字节的记录，两个标签 (稀有度 0..4、装备类型 0..7)。植入的字段:
+//   0x00 int16 物品 ID (按装备类型分段)    0x06 int16 等级          0x08 指针
+//   0x10 float (随稀有度增长，带噪声)     0x14 int32 品质 (= 稀有度) 0x18 位标志 (0x04 / 0x40)
+//   0x19 byte 类型编码 (类型的乱序映射)    0x1C int32 0..1000000     0x20 int16 -50..50
+//   0x24 int32 -100000..100000
+// 其余字节为常量。
+// --check 要求: 字节列统计的 SSE2 与逐个计算结果相同 (各种长度)；植入的字段都以正确的偏移、宽度和类型被提出，
+// 且没有多余的候选；品质与稀有度相关系数为 1，类型编码与装备类型的相关比为 1；
+// SSE2 与逐个计算的候选相同 (浮点统计在误差范围内)；样本文件写出再读回后分析结果不变。
+
+#include "field_samples.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr uint32_t RECORD_SIZE = 0x100;
+    constexpr uint32_t LABEL_COUNT = 2;
+    constexpr int32_t RARITY_COUNT = 5;
+    constexpr int32_t TYPE_COUNT = 8;
+
+    struct PlantedField {
+        uint32_t offset;
+        uint32_t width;
+        int32_t kind;
+    };
+
+    const PlantedField PLANTED[] = {
+        { 0x00, 2, FIELD_KIND_INT },
+        { 0x06, 2, FIELD_KIND_INT },
+        { 0x08, 8, FIELD_KIND_POINTER },
+        { 0x10, 4, FIELD_KIND_FLOAT },
+        { 0x14, 1, FIELD_KIND_BYTE },       // 品质 0..4: 只有最低字节变化
+        { 0x18, 1, FIELD_KIND_FLAGS },
+        { 0x19, 1, FIELD_KIND_BYTE },
+        { 0x1C, 4, FIELD_KIND_INT },
+        { 0x20, 2, FIELD_KIND_INT },
+        { 0x24, 4, FIELD_KIND_INT },
+    };
+
+    const uint8_t TYPE_CODES[TYPE_COUNT] = { 7, 2, 5, 0, 3, 6, 1, 4 };
+
+    // 防止计时循环被优化掉
+    volatile uint64_t g_sink;
+
+    double Milliseconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template <typename T>
+    void Store(uint8_t* record, uint32_t offset, T value) {
+        memcpy(record + offset, &value, sizeof(value));
+    }
+
+    void MakeSamples(size_t count, FieldSampleSet& samples) {
+        std::mt19937_64 random(0x4E334653);
+        uint8_t constant[RECORD_SIZE];
+        for (uint32_t i = 0; i < RECORD_SIZE; i++) {
+            constant[i] = (uint8_t)random();
+        }
+
+        samples.Reset(RECORD_SIZE, LABEL_COUNT);
+        uint8_t record[RECORD_SIZE];
+        for (size_t i = 0; i < count; i++) {
+            int32_t labels[LABEL_COUNT] = { (int32_t)(random() % RARITY_COUNT), (int32_t)(random() % TYPE_COUNT) };
+            int32_t rarity = labels[0];
+            int32_t type = labels[1];
+
+            memcpy(record, constant, sizeof(record));
+            Store<int16_t>(record, 0x00, (int16_t)(1 + type * 1000 + (int32_t)(random() % 500)));
+            Store<int16_t>(record, 0x06, (int16_t)(1 + random() % 800));
+            Store<uint64_t>(record, 0x08, 0x20000000000ull + (random() % 0x10000000) * 8);
+            Store<float>(record, 0x10, 1.0f + rarity * 0.5f + (float)(random() % 1000) / 10000.0f);
+            Store<int32_t>(record, 0x14, rarity);
+            record[0x18] = (uint8_t)((random() % 2 != 0 ? 0x04 : 0) | (random() % 2 != 0 ? 0x40 : 0));
+            record[0x19] = TYPE_CODES[type];
+            Store<int32_t>(record, 0x1C, (int32_t)(random() % 1000001));
+            Store<int16_t>(record, 0x20, (int16_t)((int32_t)(random() % 101) - 50));
+            Store<int32_t>(record, 0x24, (int32_t)(random() % 200001) - 100000);
+            samples.Add(0x200000000ull + i * RECORD_SIZE, record, labels);
+        }
+    }
+
+    double Score(const FieldCandidate& field) {
+        return std::max(std::fabs(field.correlation), field.association);
+    }
+
+    const char* KindName(int32_t kind) {
+        switch (kind) {
+        case FIELD_KIND_BYTE: return "byte";
+        case FIELD_KIND_FLAGS: return "flags";
+        case FIELD_KIND_INT: return "int";
+        case FIELD_KIND_FLOAT: return "float";
+        case FIELD_KIND_POINTER: return "pointer";
+        default: return "?";
+        }
+    }
+
+    void PrintCandidates(const std::vector<FieldCandidate>& candidates) {
+        printf("%-8s %5s %-8s %14s %14s %14s %12s %8s %6s %8s %8s\n", "offset", "width", "kind", "min", "max", "mean",
+            "stddev", "distinct", "label", "r", "eta");
+        for (const FieldCandidate& field : candidates) {
+            printf("0x%-6X %5u %-8s %14.6g %14.6g %14.6g %12.6g %8u %6d %8.4f %8.4f\n", field.offset, field.width,
+                KindName(field.kind), field.minValue, field.maxValue, field.mean, field.stddev, field.distinct,
+                field.bestLabel, field.correlation, field.association);
+        }
+    }
+
+    void PrintStats(const char* name, const FieldAnalysisStats& stats, double milliseconds) {
+        printf("%-8s %u records x %u bytes, %u constant bytes, %u candidates, %.3f ms\n", name, stats.records,
+            stats.recordSize, stats.constantBytes, stats.candidates, milliseconds);
+    }
+
+    bool Near(double a, double b) {
+        return std::fabs(a - b) <= 1e-9 * std::max(1.0, std::max(std::fabs(a), std::fabs(b)));
+    }
+
+    bool SameCandidates(const std::vector<FieldCandidate>& a, const std::vector<FieldCandidate>& b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].offset != b[i].offset || a[i].width != b[i].width || a[i].kind != b[i].kind ||
+                a[i].bestLabel != b[i].bestLabel || a[i].distinct != b[i].distinct ||
+                a[i].minValue != b[i].minValue || a[i].maxValue != b[i].maxValue || !Near(a[i].mean, b[i].mean) ||
+                !Near(a[i].stddev, b[i].stddev) || !Near(a[i].correlation, b[i].correlation) ||
+                !Near(a[i].association, b[i].association)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool CheckByteStats() {
+        std::mt19937_64 random(7);
+        for (size_t count : { (size_t)1, (size_t)15, (size_t)16, (size_t)17, (size_t)1000, (size_t)200003 }) {
+            std::vector<uint8_t> column(count);
+            for (uint8_t& value : column) {
+                value = (uint8_t)(random() % 3 == 0 ? 255 : random());
+            }
+            ByteColumnStats simd;
+            ByteColumnStats scalar;
+            ComputeByteColumnStats(column.data(), count, simd, true);
+            ComputeByteColumnStats(column.data(), count, scalar, false);
+            if (simd.minValue != scalar.minValue || simd.maxValue != scalar.maxValue || simd.sum != scalar.sum ||
+                simd.sumSquares != scalar.sumSquares) {
+                fprintf(stderr, "byte column stats differ for %zu values\n", count);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const FieldCandidate* FindCandidate(const std::vector<FieldCandidate>& candidates, uint32_t offset) {
+        for (const FieldCandidate& field : candidates) {
+            if (field.offset == offset) {
+                return &field;
+            }
+        }
+        return nullptr;
+    }
+
+    bool CheckPlanted(const std::vector<FieldCandidate>& candidates) {
+        bool ok = candidates.size() == sizeof(PLANTED) / sizeof(PLANTED[0]);
+        if (!ok) {
+            fprintf(stderr, "%zu candidates proposed, %zu planted\n", candidates.size(), sizeof(PLANTED) / sizeof(PLANTED[0]));
+        }
+        for (const PlantedField& planted : PLANTED) {
+            const FieldCandidate* field = FindCandidate(candidates, planted.offset);
+            if (field == nullptr || field->width != planted.width || field->kind != planted.kind) {
+                fprintf(stderr, "planted field 0x%X (width %u, %s) not recovered\n", planted.offset, planted.width, KindName(planted.kind));
+                ok = false;
+            }
+        }
+
+        const FieldCandidate* quality = FindCandidate(candidates, 0x14);
+        const FieldCandidate* typeCode = FindCandidate(candidates, 0x19);
+        const FieldCandidate* scale = FindCandidate(candidates, 0x10);
+        if (quality == nullptr || quality->bestLabel != 0 || !Near(quality->correlation, 1.0)) {
+            fprintf(stderr, "quality does not correlate with the rarity label\n");
+            ok = false;
+        }
+        if (typeCode == nullptr || typeCode->bestLabel != 1 || !Near(typeCode->association, 1.0)) {
+            fprintf(stderr, "type code is not associated with the type label\n");
+            ok = false;
+        }
+        if (scale == nullptr || scale->bestLabel != 0 || scale->correlation < 0.95) {
+            fprintf(stderr, "float field does not follow the rarity label\n");
+            ok = false;
+        }
+        return ok;
+    }
+
+    bool RunCheck() {
+        bool ok = CheckByteStats();
+
+        FieldSampleSet samples;
+        MakeSamples(4099, samples);
+        std::vector<FieldCandidate> simd;
+        std::vector<FieldCandidate> scalar;
+        FieldAnalysisStats stats;
+        AnalyzeFieldSamples(samples, simd, stats, true);
+        AnalyzeFieldSamples(samples, scalar, stats, false);
+        ok = CheckPlanted(simd) && ok;
+        if (!SameCandidates(simd, scalar)) {
+            fprintf(stderr, "SIMD and scalar analyses disagree\n");
+            ok = false;
+        }
+
+        const char* path = "field_analyze_check.n3fs";
+        FieldSampleSet loaded;
+        std::vector<FieldCandidate> reloaded;
+        if (!samples.Write(path) || !loaded.Read(path)) {
+            fprintf(stderr, "sample file round trip failed\n");
+            ok = false;
+        } else {
+            AnalyzeFieldSamples(loaded, reloaded, stats, true);
+            if (loaded.GetCount() != samples.GetCount() || loaded.GetBase(17) != samples.GetBase(17) ||
+                !SameCandidates(simd, reloaded)) {
+                fprintf(stderr, "reloaded samples analyze differently\n");
+                ok = false;
+            }
+        }
+        remove(path);
+
+        FieldSampleSet empty;
+        if (AnalyzeFieldSamples(empty, reloaded, stats, true)) {
+            fprintf(stderr, "empty sample set was analyzed\n");
+            ok = false;
+        }
+        return ok;
+    }
+
+    bool RunSynthetic(size_t count, const char* savePath) {
+        FieldSampleSet samples;
+        MakeSamples(count, samples);
+        if (savePath != nullptr && !samples.Write(savePath)) {
+            fprintf(stderr, "failed to write %s\n", savePath);
+            return false;
+        }
+
+        // 第一步 (字节列统计) 单独计时: 每个字节列都要扫一遍，是唯一与记录长度成正比的部分
+        double rates[2];
+        for (int run = 0; run < 2; run++) {
+            auto start = std::chrono::steady_clock::now();
+            ByteColumnStats column;
+            uint64_t checksum = 0;
+            for (int repeat = 0; repeat < 10; repeat++) {
+                for (uint32_t offset = 0; offset < RECORD_SIZE; offset++) {
+                    ComputeByteColumnStats(samples.GetColumn(offset), count, column, run == 1);
+                    checksum += column.sumSquares;
+                }
+            }
+            rates[run] = 10.0 * count * RECORD_SIZE / (Milliseconds(start) * 1e6);
+            g_sink = checksum;
+        }
+        printf("byte stats scalar %.2f GB/s, simd %.2f GB/s\n", rates[0], rates[1]);
+
+        std::vector<FieldCandidate> candidates[2];
+        FieldAnalysisStats stats;
+        for (int run = 0; run < 2; run++) {
+            // 先预热一次，计时取第二次
+            AnalyzeFieldSamples(samples, candidates[run], stats, run == 1);
+            auto start = std::chrono::steady_clock::now();
+            AnalyzeFieldSamples(samples, candidates[run], stats, run == 1);
+            PrintStats(run == 1 ? "simd" : "scalar", stats, Milliseconds(start));
+        }
+        printf("\n");
+        PrintCandidates(candidates[1]);
+        return CheckPlanted(candidates[1]) && SameCandidates(candidates[0], candidates[1]);
+    }
+
+    bool RunFile(const char* path, bool useSimd) {
+        FieldSampleSet samples;
+        if (!samples.Read(path)) {
+            fprintf(stderr, "failed to read %s\n", path);
+            return false;
+        }
+
+        std::vector<FieldCandidate> candidates;
+        FieldAnalysisStats stats;
+        auto start = std::chrono::steady_clock::now();
+        if (!AnalyzeFieldSamples(samples, candidates, stats, useSimd)) {
+            fprintf(stderr, "%s has no samples\n", path);
+            return false;
+        }
+        PrintStats(useSimd ? "simd" : "scalar", stats, Milliseconds(start));
+        printf("\n");
+        PrintCandidates(candidates);
+
+        // 关联最强的候选单独列出，便于先看
+        std::vector<FieldCandidate> ranked(candidates);
+        std::stable_sort(ranked.begin(), ranked.end(),
+            [](const FieldCandidate& a, const FieldCandidate& b) { return Score(a) > Score(b); });
+        printf("\nstrongest label associations:\n");
+        for (size_t i = 0; i < ranked.size() && i < 10 && ranked[i].bestLabel >= 0; i++) {
+            printf("  0x%-6X %-8s label %d  r %.4f  eta %.4f\n", ranked[i].offset, KindName(ranked[i].kind),
+                ranked[i].bestLabel, ranked[i].correlation, ranked[i].association);
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    bool check = false;
+    bool useSimd = true;
+    size_t synthetic = 0;
+    const char* savePath = nullptr;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--check") == 0) {
+            check = true;
+        } else if (strcmp(argv[i], "--scalar") == 0) {
+            useSimd = false;
+        } else if (strcmp(argv[i], "--synthetic") == 0 && hasValue) {
+            synthetic = (size_t)strtoull(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "--save") == 0 && hasValue) {
+            savePath = argv[++i];
+        } else if (argv[i][0] != '-' && path == nullptr) {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "usage: %s <samples.n3fs> [--scalar] | --synthetic N [--save path] | --check\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (check) {
+        if (!RunCheck()) {
+            fprintf(stderr, "field analysis checks failed\n");
+            return 1;
+        }
+        printf("ok\n");
+        return 0;
+    }
+    if (synthetic != 0) {
+        return RunSynthetic(synthetic, savePath) ? 0 : 1;
+    }
+    if (path == nullptr) {
+        fprintf(stderr, "usage: %s <samples.n3fs> [--scalar] | --synthetic N [--save path] | --check\n", argv[0]);
+        return 2;
+    }
+    return RunFile(path, useSimd) ? 0 : 1;
+}
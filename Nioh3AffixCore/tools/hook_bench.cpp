@@ -0,0 +1,1031 @@
+// hook 代码本机基准工具 (Linux x86-64)
+//
+// 用法:
+//   hook_bench [calls]        在本进程中构造一个带武器/装备注入点的假模块，用当前核心的会话把 hook 装上去，
+//                             先做正确性检查 (见下)，再从模拟的调用点循环执行，分别测量:
+//                               - 未挂 hook 的基线
+//                               - 普通 hook 代码
+//                               - 插桩 hook 代码 (SessionSetHookInstrumentation)
+//                             并打印插桩统计 (命中次数、平均周期、周期直方图)。
+//                             插桩版与普通版的差值即插桩本身的开销；直方图中的周期数不含 rdtsc 本身，
+//                             连续两次 rdtsc 的最小间隔作为测量下限一并打印。
+//   hook_bench --check        只做正确性检查，全部通过时返回 0
+//
+// 正确性检查: 寄存器探针把全部通用寄存器和标志位设为已知值后调用注入点，返回后记下全部寄存器和标志位。
+// 对普通、插桩和带待应用信箱批次的 hook 代码，每个注入点、每组标志位都要求:
+//   - 返回后的寄存器和标志位 (含 rsp) 与未挂 hook 时完全相同
+//   - 会话捕获到的基址是注入点捕获的寄存器的值
+//   - 插桩统计的命中次数等于调用次数；开启容器捕获时装备的容器指针是 r12；信箱批次被应用且写入可以读回
+// 信箱竞争: 多个线程同时对两条记录执行信箱代码，工具交替向两条记录投递批次并随机撤回，要求
+//   - 每一批要么只写到目标记录 (APPLIED)，要么什么都没写 (WITHDRAWN)；另一条记录始终不变
+//   - 撤回总能在等待上限内给出结果
+// 捕获环竞争: 多个线程同时追加记录 (owner 为 base 取反)，消费者同时读取，要求
+//   - 接受的每条记录的 base/owner 来自同一次写入，序号递增，同一线程的记录按写入顺序出现
+//   - 拷贝条目时刚读完第一条的 tag 整个环就被重写一圈 (确定地构造读取期间的覆盖)，被覆盖的条目计为丢失，
+//     接受的条目都是其序号对应的那次写入
+// 子进程共享视图: 后端支持 MapShared 时捕获环放在共享视图中，fork 出的子进程 (另一个进程) 执行 hook 代码，要求
+//   - 父进程按顺序收到子进程的全部记录，消费过程中没有一次后端读取
+//   - 会话的捕获环是共享的，子进程命中注入点后父进程读到的基址和代数不经过后端读取；后端不支持时退回到代码洞数据区
+//
+// 目标进程就是本进程: 后端直接访问本进程内存，hook 代码在本进程中真实执行。
+
+#include "capture_ring.h"
+#include "edit_mailbox.h"
+#include "hook_stats.h"
+#include "remote_arena.h"
+#include "session.h"
+#include "shared_memory.h"
+#include "x64_emitter.h"
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <x86intrin.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    // 本进程作为目标进程
+    // 区域信息取自 /proc/self/maps，分配用 MAP_FIXED_NOREPLACE 放在指定地址
+    class LocalProcessMemory : public ProcessMemory {
+    public:
+        LocalProcessMemory(QWORD moduleBase, QWORD moduleSize) : m_moduleBase(moduleBase), m_moduleSize(moduleSize) {}
+
+        bool Read(QWORD address, void* buffer, size_t size, size_t* bytesRead = nullptr) override {
+            memcpy(buffer, (const void*)address, size);
+            if (bytesRead != nullptr) {
+                *bytesRead = size;
+            }
+            return true;
+        }
+
+        bool Write(QWORD address, const void* buffer, size_t size) override {
+            memcpy((void*)address, buffer, size);
+            return true;
+        }
+
+        bool Query(QWORD address, MemoryRegion& outRegion) override {
+            FILE* maps = fopen("/proc/self/maps", "r");
+            if (maps == nullptr) {
+                return false;
+            }
+
+            QWORD previousEnd = 0x10000;
+            bool found = false;
+            char line[512];
+            while (fgets(line, sizeof(line), maps) != nullptr) {
+                unsigned long long start = 0, end = 0;
+                char perms[8] = {};
+                if (sscanf(line, "%llx-%llx %7s", &start, &end, perms) != 3) {
+                    continue;
+                }
+                if (address < start) {
+                    // 位于两个映射之间的空闲区
+                    outRegion.baseAddress = previousEnd > address ? address : previousEnd;
+                    outRegion.regionSize = start - outRegion.baseAddress;
+                    outRegion.state = MemState::Free;
+                    outRegion.protect = MemProtect::NoAccess;
+                    outRegion.type = 0;
+                    found = true;
+                    break;
+                }
+                if (address < end) {
+                    outRegion.baseAddress = start;
+                    outRegion.regionSize = end - start;
+                    outRegion.state = MemState::Commit;
+                    outRegion.protect = ToProtect(perms);
+                    outRegion.type = MemType::Private;
+                    found = true;
+                    break;
+                }
+                previousEnd = end;
+            }
+            fclose(maps);
+
+            if (!found) {
+                outRegion.baseAddress = address;
+                outRegion.regionSize = 0x7FFFFFFF0000ull > address ? 0x7FFFFFFF0000ull - address : 0;
+                outRegion.state = MemState::Free;
+                outRegion.protect = MemProtect::NoAccess;
+                outRegion.type = 0;
+            }
+            return true;
+        }
+
+        bool Protect(QWORD address, size_t size, uint32_t newProtect, uint32_t* oldProtect) override {
+            // 假模块和代码洞始终可读写执行，只记录调用
+            (void)address;
+            (void)size;
+            (void)newProtect;
+            if (oldProtect != nullptr) {
+                *oldProtect = MemProtect::ExecuteReadWrite;
+            }
+            return true;
+        }
+
+        QWORD Allocate(QWORD preferredAddress, size_t size, uint32_t protect) override {
+            (void)protect;
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS | (preferredAddress != 0 ? MAP_FIXED_NOREPLACE : 0);
+            void* p = mmap((void*)preferredAddress, size, PROT_READ | PROT_WRITE | PROT_EXEC, flags, -1, 0);
+            if (p == MAP_FAILED) {
+                return 0;
+            }
+            m_allocations[(QWORD)p] = size;
+            return (QWORD)p;
+        }
+
+        bool Free(QWORD address) override {
+            auto it = m_allocations.find(address);
+            if (it == m_allocations.end()) {
+                return false;
+            }
+            munmap((void*)address, it->second);
+            m_allocations.erase(it);
+            return true;
+        }
+
+        bool GetMainModule(QWORD& baseAddress, QWORD& moduleSize) override {
+            baseAddress = m_moduleBase;
+            moduleSize = m_moduleSize;
+            return true;
+        }
+
+    private:
+        QWORD m_moduleBase;
+        QWORD m_moduleSize;
+        std::map<QWORD, size_t> m_allocations;
+
+        static uint32_t ToProtect(const char* perms) {
+            bool r = perms[0] == 'r', w = perms[1] == 'w', x = perms[2] == 'x';
+            if (x) return w ? MemProtect::ExecuteReadWrite : (r ? MemProtect::ExecuteRead : MemProtect::Execute);
+            if (w) return MemProtect::ReadWrite;
+            return r ? MemProtect::ReadOnly : MemProtect::NoAccess;
+        }
+    };
+
+    // 假模块布局
+    constexpr size_t MODULE_SIZE = 0x10000;
+    constexpr QWORD RET_OFFSET = 0x000;
+    constexpr QWORD WEAPON_SITE_OFFSET = 0x100;
+    constexpr QWORD ARMOR_SITE_OFFSET = 0x200;
+    constexpr QWORD WEAPON_CALLER_OFFSET = 0x300;
+    constexpr QWORD ARMOR_CALLER_OFFSET = 0x340;
+    constexpr QWORD WEAPON_PROBE_OFFSET = 0x400;
+    constexpr QWORD ARMOR_PROBE_OFFSET = 0x500;
+    constexpr QWORD PROBE_SIZE = 0x100;
+    constexpr QWORD PROBE_OUT_OFFSET = 0x800;
+    constexpr QWORD PROBE_SAVED_RSP_OFFSET = 0x900;
+
+    typedef void (*SiteCaller)(void* record);
+
+    // 寄存器探针的输入/输出 (寄存器按 X64Reg 编码顺序，输入中的 rsp 不使用)
+    struct RegisterFrame {
+        uint64_t regs[16];
+        uint64_t flags;
+    };
+
+    typedef void (*RegisterProbe)(const RegisterFrame* in);
+
+    void PutRel32(uint8_t* at, QWORD next, QWORD target) {
+        int32_t rel = (int32_t)(target - next);
+        memcpy(at, &rel, 4);
+    }
+
+    // 注入点处是与 AOB 匹配的真实指令序列，调用的函数替换为模块内的 ret
+    // 调用者把 record 同时放进 rbp/rbx/r12/rsi (两个注入点用到的寄存器)，再 call 注入点
+    uint8_t* BuildModule() {
+        void* p = mmap(nullptr, MODULE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            return nullptr;
+        }
+        uint8_t* m = (uint8_t*)p;
+        QWORD base = (QWORD)m;
+        memset(m, 0xCC, MODULE_SIZE);
+        m[RET_OFFSET] = 0xC3;
+
+        // mov rdx,rbp; mov rcx,r10; call ret; mov rax,[rsi+0]; lea rcx,[rsi+0]; ret
+        uint8_t weapon[] = { 0x48, 0x8B, 0xD5, 0x49, 0x8B, 0xCA, 0xE8, 0, 0, 0, 0,
+            0x48, 0x8B, 0x86, 0, 0, 0, 0, 0x48, 0x8D, 0x8E, 0, 0, 0, 0, 0xC3 };
+        PutRel32(weapon + 7, base + WEAPON_SITE_OFFSET + 11, base + RET_OFFSET);
+        memcpy(m + WEAPON_SITE_OFFSET, weapon, sizeof(weapon));
+
+        // lea rcx,[r12+148]; mov rdx,rbx; call ret; mov al,[rbp+6F]; mov cl,[rbp+67]; ret
+        uint8_t armor[] = { 0x49, 0x8D, 0x8C, 0x24, 0x48, 0x01, 0x00, 0x00, 0x48, 0x8B, 0xD3, 0xE8, 0, 0, 0, 0,
+            0x8A, 0x45, 0x6F, 0x8A, 0x4D, 0x67, 0xC3 };
+        PutRel32(armor + 12, base + ARMOR_SITE_OFFSET + 16, base + RET_OFFSET);
+        memcpy(m + ARMOR_SITE_OFFSET, armor, sizeof(armor));
+
+        // push rbp/rbx/r12/rsi; mov rbp/rbx/r12/rsi, rdi; call site; pop rsi/r12/rbx/rbp; ret
+        const QWORD callers[2][2] = { { WEAPON_CALLER_OFFSET, WEAPON_SITE_OFFSET }, { ARMOR_CALLER_OFFSET, ARMOR_SITE_OFFSET } };
+        for (const auto& caller : callers) {
+            uint8_t code[] = { 0x55, 0x53, 0x41, 0x54, 0x56,
+                0x48, 0x89, 0xFD, 0x48, 0x89, 0xFB, 0x49, 0x89, 0xFC, 0x48, 0x89, 0xFE,
+                0xE8, 0, 0, 0, 0,
+                0x5E, 0x41, 0x5C, 0x5B, 0x5D, 0xC3 };
+            PutRel32(code + 18, base + caller[0] + 22, base + caller[1]);
+            memcpy(m + caller[0], code, sizeof(code));
+        }
+        return m;
+    }
+
+    // 寄存器探针 (rdi = 输入帧):
+    //   push 被调用者保存的寄存器; 保存 rsp; 按输入设置标志位和除 rsp 外的全部寄存器 (rdi 最后)
+    //   call 注入点
+    //   用 RIP 相对写入把全部寄存器 (含 rsp) 和标志位记入模块中的输出帧; 恢复 rsp 和被调用者保存的寄存器; ret
+    bool BuildProbe(uint8_t* module, QWORD probeOffset, QWORD siteOffset) {
+        QWORD base = (QWORD)module;
+        QWORD out = base + PROBE_OUT_OFFSET;
+        static const X64Reg calleeSaved[] = { X64Reg::Rbx, X64Reg::Rbp, X64Reg::R12, X64Reg::R13, X64Reg::R14, X64Reg::R15 };
+
+        X64Emitter e(module + probeOffset, PROBE_SIZE, base + probeOffset);
+        for (X64Reg reg : calleeSaved) {
+            e.Push(reg);
+        }
+        e.MovRipStore(base + PROBE_SAVED_RSP_OFFSET, X64Reg::Rsp);
+        e.MovLoad(X64Reg::Rax, X64Reg::Rdi, (int32_t)offsetof(RegisterFrame, flags));
+        e.Push(X64Reg::Rax);
+        e.Popfq();
+        for (int i = 0; i < 16; i++) {
+            X64Reg reg = (X64Reg)i;
+            if (reg != X64Reg::Rsp && reg != X64Reg::Rdi) {
+                e.MovLoad(reg, X64Reg::Rdi, i * 8);
+            }
+        }
+        e.MovLoad(X64Reg::Rdi, X64Reg::Rdi, (int32_t)X64Reg::Rdi * 8);
+
+        e.Call(base + siteOffset);
+
+        for (int i = 0; i < 16; i++) {
+            e.MovRipStore(out + i * 8, (X64Reg)i);
+        }
+        e.Pushfq();
+        e.Pop(X64Reg::Rax);
+        e.MovRipStore(out + offsetof(RegisterFrame, flags), X64Reg::Rax);
+        e.MovRipLoad(X64Reg::Rsp, base + PROBE_SAVED_RSP_OFFSET);
+        for (int i = (int)(sizeof(calleeSaved) / sizeof(calleeSaved[0])) - 1; i >= 0; i--) {
+            e.Pop(calleeSaved[i]);
+        }
+        const uint8_t ret = 0xC3;
+        e.Bytes(&ret, 1);
+        return e.Ok();
+    }
+
+    RegisterFrame RunProbe(uint8_t* module, QWORD probeOffset, const RegisterFrame& in) {
+        ((RegisterProbe)(void*)(module + probeOffset))(&in);
+        RegisterFrame out;
+        memcpy(&out, module + PROBE_OUT_OFFSET, sizeof(out));
+        // rsp 记为相对探针入口的值，期望帧和比较帧可以在不同的调用深度取得
+        uint64_t savedRsp;
+        memcpy(&savedRsp, module + PROBE_SAVED_RSP_OFFSET, sizeof(savedRsp));
+        out.regs[(int)X64Reg::Rsp] -= savedRsp;
+        return out;
+    }
+
+    const char* const REGISTER_NAMES[16] = {
+        "rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15"
+    };
+
+    // 比较寄存器帧，打印所有不同之处
+    bool SameFrame(const char* what, const RegisterFrame& expected, const RegisterFrame& actual) {
+        bool same = true;
+        for (int i = 0; i < 16; i++) {
+            if (expected.regs[i] != actual.regs[i]) {
+                printf("  FAIL %s: %s = %016llx, expected %016llx\n", what, REGISTER_NAMES[i],
+                    (unsigned long long)actual.regs[i], (unsigned long long)expected.regs[i]);
+                same = false;
+            }
+        }
+        if (expected.flags != actual.flags) {
+            printf("  FAIL %s: rflags = %llx, expected %llx\n", what, (unsigned long long)actual.flags, (unsigned long long)expected.flags);
+            same = false;
+        }
+        return same;
+    }
+
+    // 每次调用的纳秒数
+    double MeasureCall(SiteCaller caller, void* record, uint64_t calls) {
+        // 预热
+        for (uint64_t i = 0; i < calls / 16 + 1; i++) {
+            caller(record);
+        }
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < calls; i++) {
+            caller(record);
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (double)calls;
+    }
+
+    // rdtsc 频率 (周期/纳秒)
+    double CalibrateTsc() {
+        auto start = Clock::now();
+        uint64_t tscStart = __rdtsc();
+        while (Clock::now() - start < std::chrono::milliseconds(50)) {
+        }
+        uint64_t tscEnd = __rdtsc();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        return (double)(tscEnd - tscStart) / ns;
+    }
+
+    // 连续两次 rdtsc 的最小间隔 (插桩采样的测量下限)
+    uint64_t MinRdtscDelta() {
+        uint64_t best = ~0ull;
+        for (int i = 0; i < 100000; i++) {
+            uint64_t a = __rdtsc();
+            uint64_t b = __rdtsc();
+            if (b - a < best) {
+                best = b - a;
+            }
+        }
+        return best;
+    }
+
+    void PrintStats(const char* name, const HookStats& stats, double cyclesPerNs) {
+        double mean = stats.samples != 0 ? (double)stats.totalCycles / (double)stats.samples : 0;
+        printf("%-8s hits %llu, samples %llu, mean %.1f cycles (%.1f ns)\n", name,
+            (unsigned long long)stats.hits, (unsigned long long)stats.samples, mean, mean / cyclesPerNs);
+
+        uint64_t seen = 0;
+        for (int i = 0; i < HookStatsLayout::HISTOGRAM_BUCKETS; i++) {
+            if (stats.histogram[i] == 0) {
+                continue;
+            }
+            seen += stats.histogram[i];
+            printf("    [%6llu, %6llu) cycles %10llu  %6.2f%%  (cumulative %6.2f%%)\n",
+                i == 0 ? 0ull : (unsigned long long)(1ull << i), (unsigned long long)(2ull << i),
+                (unsigned long long)stats.histogram[i], 100.0 * stats.histogram[i] / stats.samples, 100.0 * seen / stats.samples);
+        }
+    }
+}
+
+namespace {
+    constexpr int PROBE_CALLS = 3;
+
+    struct CheckRecords {
+        alignas(64) uint8_t weapon[0x400];
+        alignas(64) uint8_t armor[0x400];
+        alignas(64) uint8_t other[0x400];
+    };
+
+    // 探针输入: 注入点会读取 rbp/rsi 指向的内存，rbx 是装备注入点捕获的寄存器，三者指向不同的记录；
+    // 其余寄存器为互不相同的常量。标志位使用四组 (不含 DF/AC)
+    RegisterFrame MakeProbeInput(CheckRecords& records, uint64_t flags) {
+        RegisterFrame in;
+        for (int i = 0; i < 16; i++) {
+            in.regs[i] = 0x1111111111111111ull * (uint64_t)(i + 1) ^ 0x0123456789ABCDEFull;
+        }
+        in.regs[(int)X64Reg::Rsp] = 0;
+        in.regs[(int)X64Reg::Rbp] = (uint64_t)records.weapon;
+        in.regs[(int)X64Reg::Rbx] = (uint64_t)records.armor;
+        in.regs[(int)X64Reg::Rsi] = (uint64_t)records.other;
+        in.flags = flags;
+        return in;
+    }
+
+    // OF|SF|ZF|AF|PF|CF / 全部清零 / 只有 OF / 除 OF 之外全部 (OF 与其余标志分开保存，要分别验证)
+    constexpr int PROBE_FLAG_COUNT = 4;
+    const uint64_t PROBE_FLAGS[PROBE_FLAG_COUNT] = { 0x8D5, 0x2, 0x802, 0xD7 };
+    const QWORD PROBE_OFFSETS[2] = { WEAPON_PROBE_OFFSET, ARMOR_PROBE_OFFSET };
+    const char* const SITE_NAMES[2] = { "weapon", "armor" };
+
+    // 用当前启用的 hook 运行两个探针，与未挂 hook 时的寄存器帧比较
+    bool CheckProbes(Session& session, uint8_t* module, CheckRecords& records,
+        const RegisterFrame (&expected)[2][PROBE_FLAG_COUNT], const char* mode) {
+        bool ok = true;
+        for (int site = 0; site < 2; site++) {
+            for (int f = 0; f < PROBE_FLAG_COUNT; f++) {
+                RegisterFrame in = MakeProbeInput(records, PROBE_FLAGS[f]);
+                for (int call = 0; call < PROBE_CALLS; call++) {
+                    char what[64];
+                    snprintf(what, sizeof(what), "%s %s flags %llx", mode, SITE_NAMES[site], (unsigned long long)PROBE_FLAGS[f]);
+                    ok = SameFrame(what, expected[site][f], RunProbe(module, PROBE_OFFSETS[site], in)) && ok;
+                }
+            }
+        }
+
+        if (session.GetWeaponBase() != (QWORD)records.weapon) {
+            printf("  FAIL %s: weapon base %llx, expected %llx (rbp)\n", mode,
+                (unsigned long long)session.GetWeaponBase(), (unsigned long long)(QWORD)records.weapon);
+            ok = false;
+        }
+        if (session.GetArmorBase() != (QWORD)records.armor) {
+            printf("  FAIL %s: armor base %llx, expected %llx (rbx)\n", mode,
+                (unsigned long long)session.GetArmorBase(), (unsigned long long)(QWORD)records.armor);
+            ok = false;
+        }
+        return ok;
+    }
+
+    bool CheckHitCounts(Session& session, const uint64_t (&before)[2], const char* mode) {
+        bool ok = true;
+        const int types[2] = { EQUIP_TYPE_WEAPON, EQUIP_TYPE_ARMOR };
+        for (int site = 0; site < 2; site++) {
+            HookStats stats = {};
+            uint64_t expected = before[site] + PROBE_FLAG_COUNT * PROBE_CALLS;
+            if (!session.GetHookStats(types[site], &stats) || stats.hits != expected) {
+                printf("  FAIL %s: %s hits %llu, expected %llu\n", mode, SITE_NAMES[site],
+                    (unsigned long long)stats.hits, (unsigned long long)expected);
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    // 容器捕获: 装备记录的 owner 是探针中的 r12，武器没有容器
+    bool CheckOwner(Session& session, CheckRecords& records, const char* mode) {
+        QWORD expected[2] = { 0, MakeProbeInput(records, 0).regs[(int)X64Reg::R12] };
+        QWORD bases[2] = { (QWORD)records.weapon, (QWORD)records.armor };
+        CapturedItem items[8];
+        int count = std::min(session.GetCapturedItems(items, 8), 8);
+        bool ok = true;
+        for (int site = 0; site < 2; site++) {
+            const CapturedItem* item = std::find_if(items, items + count, [&](const CapturedItem& i) { return i.base == bases[site]; });
+            QWORD owner = item != items + count ? item->owner : ~0ull;
+            if (owner != expected[site]) {
+                printf("  FAIL %s: %s owner %llx, expected %llx\n", mode, SITE_NAMES[site],
+                    (unsigned long long)owner, (unsigned long long)expected[site]);
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    constexpr int RACE_THREADS = 4;
+    constexpr int RACE_BATCHES = 4000;
+
+    typedef void (*MailboxStub)(void* record);
+
+    // 多个游戏线程同时执行同一段信箱代码 (rbx 为捕获的寄存器)
+    bool CheckMailboxRace(ProcessMemory& memory, uint8_t* module) {
+        RemoteArena arena;
+        EditMailbox mailbox;
+        QWORD code = 0;
+        if (!arena.Initialize(&memory, (QWORD)module, (QWORD)module + MODULE_SIZE) || !mailbox.Initialize(&memory, &arena, false) ||
+            (code = arena.AllocateCode(0x200)) == 0) {
+            printf("  FAIL race: failed to set up the mailbox\n");
+            return false;
+        }
+
+        // push rbx; mov rbx, rdi; [信箱]; pop rbx; ret (信箱改写的寄存器都是调用者保存的)
+        X64Emitter e((uint8_t*)code, 0x200, code);
+        e.Push(X64Reg::Rbx);
+        e.MovReg(X64Reg::Rbx, X64Reg::Rdi);
+        bool emitted = EditMailbox::EmitApply(e, mailbox.GetAddress(), X64Reg::Rbx);
+        e.Pop(X64Reg::Rbx);
+        const uint8_t ret = 0xC3;
+        e.Bytes(&ret, 1);
+        if (!emitted || !e.Ok()) {
+            printf("  FAIL race: failed to emit the mailbox code\n");
+            return false;
+        }
+        MailboxStub stub = (MailboxStub)(void*)code;
+
+        alignas(64) static uint64_t records[2][8];
+        memset(records, 0, sizeof(records));
+        std::atomic<bool> stop(false);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < RACE_THREADS; t++) {
+            threads.emplace_back([&, t]() {
+                uint64_t i = (uint64_t)t;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    stub(records[i++ & 1]);
+                }
+            });
+        }
+
+        // 每批把目标记录的前两个字写成批次号 (第二个字只改低 32 位)
+        std::mt19937_64 random(36);
+        uint64_t expected[2][2] = {};
+        int applied = 0;
+        int withdrawn = 0;
+        bool ok = true;
+        for (int batch = 1; batch <= RACE_BATCHES && ok; batch++) {
+            int target = (int)(random() % 2);
+            std::vector<MailboxEdit> edits = {
+                { 0, ~0ull, (uint64_t)batch },
+                { 8, 0xFFFFFFFFull, (uint64_t)batch }
+            };
+            if (!mailbox.Post((QWORD)records[target], edits)) {
+                printf("  FAIL race: post %d failed\n", batch);
+                ok = false;
+                break;
+            }
+
+            MailboxBatchState state;
+            if (random() % 4 == 0) {
+                state = mailbox.Cancel();
+            } else {
+                while ((state = mailbox.Poll()) == MAILBOX_BATCH_PENDING) {
+                    std::this_thread::yield();
+                }
+            }
+            if (state == MAILBOX_BATCH_APPLIED) {
+                expected[target][0] = (uint64_t)batch;
+                expected[target][1] = (uint64_t)batch;
+                applied++;
+            } else if (state == MAILBOX_BATCH_WITHDRAWN) {
+                withdrawn++;
+            } else {
+                printf("  FAIL race: batch %d has no result after cancel\n", batch);
+                ok = false;
+            }
+
+            for (int r = 0; r < 2 && ok; r++) {
+                if (records[r][0] != expected[r][0] || records[r][1] != expected[r][1]) {
+                    printf("  FAIL race: batch %d (target %d): record %d = %llx/%llx, expected %llx/%llx\n", batch, target, r,
+                        (unsigned long long)records[r][0], (unsigned long long)records[r][1],
+                        (unsigned long long)expected[r][0], (unsigned long long)expected[r][1]);
+                    ok = false;
+                }
+            }
+        }
+
+        stop = true;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        mailbox.Release();
+        arena.Release();
+        printf("%-14s %s (%d applied, %d withdrawn)\n", "mailbox race", ok ? "ok" : "FAILED", applied, withdrawn);
+        return ok;
+    }
+
+    // 读取时在拷贝完前 8 字节之后执行一次 tear (tear 只对至少一个条目大小的读取生效)
+    class TearingMemory : public LocalProcessMemory {
+    public:
+        using LocalProcessMemory::LocalProcessMemory;
+
+        std::function<void()> tear;
+
+        bool Read(QWORD address, void* buffer, size_t size, size_t* bytesRead = nullptr) override {
+            if (!tear || size < sizeof(CaptureRingEntry)) {
+                return LocalProcessMemory::Read(address, buffer, size, bytesRead);
+            }
+            std::function<void()> callback;
+            std::swap(callback, tear);
+            memcpy(buffer, (const void*)address, sizeof(uint64_t));
+            callback();
+            memcpy((uint8_t*)buffer + sizeof(uint64_t), (const void*)(address + sizeof(uint64_t)), size - sizeof(uint64_t));
+            if (bytesRead != nullptr) {
+                *bytesRead = size;
+            }
+            return true;
+        }
+    };
+
+    constexpr QWORD TORN_BASE = 0x7E000000;     // 序号 s 的记录 base 为 TORN_BASE + s
+    constexpr int TORN_FIRST = 10;
+
+    constexpr int RING_EVENTS = 20000;
+    constexpr int RING_SECONDS = 5;
+
+    typedef void (*AppendStub)(QWORD base, QWORD owner);
+
+    // 多个游戏线程同时执行同一段追加代码 (rdi 为捕获的寄存器，rsi 为容器寄存器)
+    bool CheckRingRace(uint8_t* module) {
+        TearingMemory memory((QWORD)module, MODULE_SIZE);
+        RemoteArena arena;
+        CaptureRing ring;
+        QWORD code = 0;
+        if (!arena.Initialize(&memory, (QWORD)module, (QWORD)module + MODULE_SIZE) || !ring.Initialize(&memory, &arena, false) ||
+            (code = arena.AllocateCode(0x100)) == 0) {
+            printf("  FAIL ring race: failed to set up the ring\n");
+            return false;
+        }
+
+        X64Emitter e((uint8_t*)code, 0x100, code);
+        bool emitted = CaptureRing::EmitAppend(e, ring.GetAddress(), X64Reg::Rdi, CaptureRingLayout::SOURCE_ARMOR, X64Reg::Rsi);
+        const uint8_t ret = 0xC3;
+        e.Bytes(&ret, 1);
+        if (!emitted || !e.Ok()) {
+            printf("  FAIL ring race: failed to emit the append code\n");
+            return false;
+        }
+        AppendStub stub = (AppendStub)(void*)code;
+
+        // 单线程: 消费者拷贝到第一条的 tag 之后生产者把整个环重写一圈
+        uint64_t written = 0;
+        auto append = [&](int count) {
+            for (int i = 0; i < count; i++, written++) {
+                stub(TORN_BASE + written, ~(TORN_BASE + written));
+            }
+        };
+        append(TORN_FIRST);
+        memory.tear = [&]() { append((int)CaptureRingLayout::CAPACITY); };
+        std::vector<CaptureEvent> events;
+        bool ok = true;
+        for (int drain = 0; drain < 2 && ok; drain++) {
+            events.clear();
+            ok = ring.Drain(events);
+            for (const CaptureEvent& event : events) {
+                if (event.base != TORN_BASE + event.sequence || event.owner != ~event.base) {
+                    printf("  FAIL ring race: torn event %llu has base %llx, owner %llx\n", (unsigned long long)event.sequence,
+                        (unsigned long long)event.base, (unsigned long long)event.owner);
+                    ok = false;
+                }
+            }
+        }
+        if (ok && (ring.GetNextSequence() != written || ring.GetLostCount() < (uint64_t)TORN_FIRST)) {
+            printf("  FAIL ring race: overwritten entries were not counted as lost (next %llu, lost %llu)\n",
+                (unsigned long long)ring.GetNextSequence(), (unsigned long long)ring.GetLostCount());
+            ok = false;
+        }
+        uint64_t nextSequence = ring.GetNextSequence();
+        uint64_t tornLost = ring.GetLostCount();
+
+        // base 的高 16 位为线程号，低 48 位为该线程的写入次数
+        std::atomic<bool> stop(false);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < RACE_THREADS; t++) {
+            threads.emplace_back([&, t]() {
+                for (uint64_t i = 0; !stop.load(std::memory_order_relaxed); i++) {
+                    QWORD base = ((QWORD)(t + 1) << 48) | i;
+                    stub(base, ~base);
+                }
+            });
+        }
+
+        uint64_t lastCount[RACE_THREADS + 1] = {};
+        bool seen[RACE_THREADS + 1] = {};
+        size_t accepted = 0;
+        auto deadline = Clock::now() + std::chrono::seconds(RING_SECONDS);
+        while (ok && accepted < (size_t)RING_EVENTS && Clock::now() < deadline) {
+            events.clear();
+            if (!ring.Drain(events)) {
+                printf("  FAIL ring race: drain failed\n");
+                ok = false;
+            }
+            for (const CaptureEvent& event : events) {
+                size_t thread = (size_t)(event.base >> 48);
+                uint64_t count = event.base & ((1ull << 48) - 1);
+                if (event.owner != ~event.base || thread == 0 || thread > (size_t)RACE_THREADS || event.sequence < nextSequence ||
+                    (seen[thread] && count <= lastCount[thread])) {
+                    printf("  FAIL ring race: event %llu has base %llx, owner %llx\n", (unsigned long long)event.sequence,
+                        (unsigned long long)event.base, (unsigned long long)event.owner);
+                    ok = false;
+                    break;
+                }
+                seen[thread] = true;
+                lastCount[thread] = count;
+                nextSequence = event.sequence + 1;
+                accepted++;
+            }
+            std::this_thread::yield();
+        }
+
+        stop = true;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        if (ok && accepted == 0) {
+            printf("  FAIL ring race: no event was accepted\n");
+            ok = false;
+        }
+        printf("%-14s %s (%llu torn, %zu accepted, %llu lost)\n", "ring race", ok ? "ok" : "FAILED", (unsigned long long)tornLost,
+            accepted, (unsigned long long)(ring.GetLostCount() - tornLost));
+        ring.Release();
+        arena.Release();
+        return ok;
+    }
+
+    // 支持 MapShared 的本进程后端: 共享内存是 memfd，映射到指定地址作为目标进程一侧，
+    // SharedMemory 自己的映射作为本进程一侧；fork 出的子进程继承目标一侧的 MAP_SHARED 映射
+    class SharedLocalMemory : public LocalProcessMemory {
+    public:
+        using LocalProcessMemory::LocalProcessMemory;
+
+        std::atomic<uint64_t> reads{ 0 };
+
+        bool Read(QWORD address, void* buffer, size_t size, size_t* bytesRead = nullptr) override {
+            reads++;
+            return LocalProcessMemory::Read(address, buffer, size, bytesRead);
+        }
+
+        bool CanMapShared() const override { return true; }
+
+        bool MapShared(QWORD preferredAddress, size_t size, SharedView& outView) override {
+            std::unique_ptr<SharedMemory> section(new SharedMemory());
+            if (!section->CreateAnonymous(size)) {
+                return false;
+            }
+            void* p = mmap((void*)preferredAddress, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED_NOREPLACE,
+                (int)section->GetNativeHandle(), 0);
+            if (p == MAP_FAILED) {
+                return false;
+            }
+            outView.remoteAddress = (QWORD)p;
+            outView.section = section.release();
+            return true;
+        }
+
+        void UnmapShared(SharedView& view) override {
+            if (view.section != nullptr) {
+                munmap((void*)view.remoteAddress, view.section->GetSize());
+                delete view.section;
+            }
+            view.section = nullptr;
+            view.remoteAddress = 0;
+        }
+    };
+
+    constexpr int CHILD_EVENTS = 100;
+    constexpr QWORD CHILD_BASE = 0x7D000000;    // 子进程第 i 次写入的记录 base 为 CHILD_BASE + i
+
+    // 在子进程中执行 body 后退出，父进程每次轮询调用 poll 直到子进程退出 (最后再轮询一次)
+    bool RunChild(const std::function<void()>& body, const std::function<void()>& poll) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            return false;
+        }
+        if (pid == 0) {
+            body();
+            _exit(0);
+        }
+        int status = 0;
+        while (waitpid(pid, &status, WNOHANG) == 0) {
+            poll();
+            usleep(100);
+        }
+        poll();
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    // 子进程通过共享视图写入捕获环，父进程不经过后端读取
+    bool CheckSharedChild(uint8_t* module) {
+        SharedLocalMemory memory((QWORD)module, MODULE_SIZE);
+        RemoteArena arena;
+        CaptureRing ring;
+        QWORD code = 0;
+        if (!arena.Initialize(&memory, (QWORD)module, (QWORD)module + MODULE_SIZE) || !ring.Initialize(&memory, &arena) ||
+            (code = arena.AllocateCode(0x100)) == 0) {
+            printf("  FAIL shared child: failed to set up the ring\n");
+            return false;
+        }
+        bool ok = true;
+        if (!ring.IsShared()) {
+            printf("  FAIL shared child: ring is not in a shared view\n");
+            ok = false;
+        }
+
+        X64Emitter e((uint8_t*)code, 0x100, code);
+        bool emitted = CaptureRing::EmitAppend(e, ring.GetAddress(), X64Reg::Rdi, CaptureRingLayout::SOURCE_ARMOR, X64Reg::Rsi);
+        const uint8_t ret = 0xC3;
+        e.Bytes(&ret, 1);
+        if (!emitted || !e.Ok()) {
+            printf("  FAIL shared child: failed to emit the append code\n");
+            return false;
+        }
+        AppendStub stub = (AppendStub)(void*)code;
+
+        memory.reads = 0;
+        uint64_t received = 0;
+        std::vector<CaptureEvent> events;
+        bool exited = RunChild([&]() {
+            for (int i = 0; i < CHILD_EVENTS; i++) {
+                stub(CHILD_BASE + i, ~(CHILD_BASE + i));
+                usleep(200);
+            }
+        }, [&]() {
+            events.clear();
+            if (!ring.Drain(events)) {
+                ok = false;
+            }
+            for (const CaptureEvent& event : events) {
+                if (event.base != CHILD_BASE + received || event.owner != ~event.base || event.source != CaptureRingLayout::SOURCE_ARMOR) {
+                    ok = false;
+                }
+                received++;
+            }
+        });
+        if (!exited || !ok || received != (uint64_t)CHILD_EVENTS || ring.GetLostCount() != 0) {
+            printf("  FAIL shared child: received %llu of %d events in order (lost %llu)\n", (unsigned long long)received,
+                CHILD_EVENTS, (unsigned long long)ring.GetLostCount());
+            ok = false;
+        }
+        uint64_t ringReads = memory.reads;
+        if (ringReads != 0) {
+            printf("  FAIL shared child: %llu backend reads while draining\n", (unsigned long long)ringReads);
+            ok = false;
+        }
+        ring.Release();
+        arena.Release();
+
+        // 会话: 子进程命中武器注入点，父进程从共享视图读到基址和代数
+        SharedLocalMemory* sessionMemory = new SharedLocalMemory((QWORD)module, MODULE_SIZE);
+        Session session;
+        if (!session.Attach(std::unique_ptr<ProcessMemory>(sessionMemory)) || !session.EnableCapture() || !session.IsCaptureShared()) {
+            printf("  FAIL shared child: session capture is not shared: %s\n", session.GetLastErrorMessage());
+            return false;
+        }
+        alignas(64) static uint8_t records[2][0x400];
+        SiteCaller weaponCaller = (SiteCaller)(void*)(module + WEAPON_CALLER_OFFSET);
+        uint64_t generation = session.GetCaptureGeneration();
+        sessionMemory->reads = 0;
+        exited = RunChild([&]() {
+            for (int i = 0; i < CHILD_EVENTS; i++) {
+                weaponCaller(records[i & 1]);
+            }
+        }, []() {});
+        QWORD weaponBase = session.GetWeaponBase();
+        uint64_t sessionReads = sessionMemory->reads;
+        if (!exited || weaponBase != (QWORD)records[(CHILD_EVENTS - 1) & 1] ||
+            session.GetCaptureGeneration() != generation + CHILD_EVENTS || sessionReads != 0) {
+            printf("  FAIL shared child: session saw base %llx, generation +%llu, %llu backend reads\n", (unsigned long long)weaponBase,
+                (unsigned long long)(session.GetCaptureGeneration() - generation), (unsigned long long)sessionReads);
+            ok = false;
+        }
+        session.Detach();
+
+        // 后端不支持 MapShared 时退回到代码洞数据区
+        Session fallback;
+        if (!fallback.Attach(std::unique_ptr<ProcessMemory>(new LocalProcessMemory((QWORD)module, MODULE_SIZE))) ||
+            !fallback.EnableCapture() || fallback.IsCaptureShared()) {
+            printf("  FAIL shared child: fallback capture: %s\n", fallback.GetLastErrorMessage());
+            ok = false;
+        }
+        fallback.Detach();
+
+        printf("%-14s %s (%llu events, %llu ring reads, %llu session reads)\n\n", "shared child", ok ? "ok" : "FAILED",
+            (unsigned long long)received, (unsigned long long)ringReads, (unsigned long long)sessionReads);
+        return ok;
+    }
+
+    bool RunChecks(Session& session, uint8_t* module) {
+        if (!BuildProbe(module, WEAPON_PROBE_OFFSET, WEAPON_SITE_OFFSET) ||
+            !BuildProbe(module, ARMOR_PROBE_OFFSET, ARMOR_SITE_OFFSET)) {
+            printf("failed to build register probes\n");
+            return false;
+        }
+
+        static CheckRecords records;
+        memset(&records, 0, sizeof(records));
+
+        // 未挂 hook 时的寄存器帧作为期望值
+        RegisterFrame expected[2][PROBE_FLAG_COUNT];
+        for (int site = 0; site < 2; site++) {
+            for (int f = 0; f < PROBE_FLAG_COUNT; f++) {
+                expected[site][f] = RunProbe(module, PROBE_OFFSETS[site], MakeProbeInput(records, PROBE_FLAGS[f]));
+            }
+        }
+
+        bool allOk = true;
+        for (int instrumented = 0; instrumented < 2; instrumented++) {
+            const char* mode = instrumented != 0 ? "instrumented" : "plain";
+            session.SetHookInstrumentation(instrumented != 0);
+            session.SetOwnerCapture(instrumented != 0);
+            if (!session.EnableCapture() || !session.IsArmorHookEnabled()) {
+                printf("  FAIL %s: enable capture failed: %s\n", mode, session.GetLastErrorMessage());
+                return false;
+            }
+
+            uint64_t hitsBefore[2] = {};
+            if (instrumented != 0) {
+                HookStats stats;
+                hitsBefore[0] = session.GetHookStats(EQUIP_TYPE_WEAPON, &stats) ? stats.hits : 0;
+                hitsBefore[1] = session.GetHookStats(EQUIP_TYPE_ARMOR, &stats) ? stats.hits : 0;
+            }
+            bool ok = CheckProbes(session, module, records, expected, mode);
+            if (instrumented != 0) {
+                ok = CheckHitCounts(session, hitsBefore, mode) && ok;
+                ok = CheckOwner(session, records, mode) && ok;
+            }
+            printf("%-14s %s\n", mode, ok ? "ok" : "FAILED");
+            allOk = allOk && ok;
+            session.DisableCapture();
+        }
+
+        // 信箱: 写入在武器 hook 的下一次命中时应用，应用前后寄存器都不受影响
+        session.SetHookInstrumentation(false);
+        session.SetOwnerCapture(false);
+        session.SetEditMailbox(true);
+        bool ok = session.EnableCapture();
+        if (!ok) {
+            printf("  FAIL mailbox: enable capture failed: %s\n", session.GetLastErrorMessage());
+        } else {
+            const char* mode = "mailbox";
+            RegisterFrame in = MakeProbeInput(records, PROBE_FLAGS[0]);
+            ok = SameFrame(mode, expected[0][0], RunProbe(module, WEAPON_PROBE_OFFSET, in));
+            if (!session.WriteAffix(0, 0x1234, 7) || session.GetPendingEdits() == 0) {
+                printf("  FAIL mailbox: write was not queued: %s\n", session.GetLastErrorMessage());
+                ok = false;
+            }
+            ok = SameFrame(mode, expected[0][0], RunProbe(module, WEAPON_PROBE_OFFSET, in)) && ok;
+            int id = 0;
+            int level = 0;
+            if (session.GetPendingEdits() != 0 || !session.ReadAffix(0, &id, &level) || id != 0x1234 || level != 7) {
+                printf("  FAIL mailbox: edit not applied (pending %d, id %x, level %d)\n", session.GetPendingEdits(), id, level);
+                ok = false;
+            }
+            session.DisableCapture();
+        }
+        session.SetEditMailbox(false);
+        printf("%-14s %s\n\n", "mailbox", ok ? "ok" : "FAILED");
+        return allOk && ok;
+    }
+}
+
+int main(int argc, char** argv) {
+    bool checkOnly = argc > 1 && strcmp(argv[1], "--check") == 0;
+    uint64_t calls = argc > 1 && !checkOnly ? strtoull(argv[1], nullptr, 10) : 2000000;
+    if (calls == 0) {
+        fprintf(stderr, "usage: hook_bench [calls | --check]\n");
+        return 1;
+    }
+
+    uint8_t* module = BuildModule();
+    if (module == nullptr) {
+        fprintf(stderr, "failed to map module\n");
+        return 1;
+    }
+    SiteCaller weaponCaller = (SiteCaller)(void*)(module + WEAPON_CALLER_OFFSET);
+    SiteCaller armorCaller = (SiteCaller)(void*)(module + ARMOR_CALLER_OFFSET);
+
+    alignas(64) static uint8_t record[0x400];
+    memset(record, 0, sizeof(record));
+
+    Session session;
+    if (!session.Attach(std::unique_ptr<ProcessMemory>(new LocalProcessMemory((QWORD)module, MODULE_SIZE)))) {
+        fprintf(stderr, "attach failed: %s\n", session.GetLastErrorMessage());
+        return 1;
+    }
+
+    if (!RunChecks(session, module)) {
+        fprintf(stderr, "register checks failed\n");
+        return 1;
+    }
+    LocalProcessMemory raceMemory((QWORD)module, MODULE_SIZE);
+    if (!CheckMailboxRace(raceMemory, module)) {
+        fprintf(stderr, "mailbox race check failed\n");
+        return 1;
+    }
+    if (!CheckRingRace(module)) {
+        fprintf(stderr, "ring race check failed\n");
+        return 1;
+    }
+    if (!CheckSharedChild(module)) {
+        fprintf(stderr, "shared child check failed\n");
+        return 1;
+    }
+    if (checkOnly) {
+        session.Detach();
+        munmap(module, MODULE_SIZE);
+        return 0;
+    }
+
+    double cyclesPerNs = CalibrateTsc();
+    printf("calls per run: %llu, tsc %.3f GHz, rdtsc floor %llu cycles\n\n",
+        (unsigned long long)calls, cyclesPerNs, (unsigned long long)MinRdtscDelta());
+
+    double baseline[2] = { MeasureCall(weaponCaller, record, calls), MeasureCall(armorCaller, record, calls) };
+
+    double hooked[2][2] = {};
+    for (int instrumented = 0; instrumented < 2; instrumented++) {
+        session.SetHookInstrumentation(instrumented != 0);
+        if (!session.EnableCapture() || !session.IsArmorHookEnabled()) {
+            fprintf(stderr, "enable capture failed: %s\n", session.GetLastErrorMessage());
+            return 1;
+        }
+        // 每轮之后立即检查捕获结果 (下一轮的记录会覆盖环形缓冲区)
+        hooked[instrumented][0] = MeasureCall(weaponCaller, record, calls);
+        bool captured = session.GetWeaponBase() == (QWORD)record;
+        hooked[instrumented][1] = MeasureCall(armorCaller, record, calls);
+        captured = captured && session.GetArmorBase() == (QWORD)record;
+        if (!captured) {
+            fprintf(stderr, "hook did not capture the record\n");
+            return 1;
+        }
+        if (instrumented != 0) {
+            HookStats stats;
+            if (session.GetHookStats(EQUIP_TYPE_WEAPON, &stats)) {
+                PrintStats("weapon", stats, cyclesPerNs);
+            }
+            if (session.GetHookStats(EQUIP_TYPE_ARMOR, &stats)) {
+                PrintStats("armor", stats, cyclesPerNs);
+            }
+            printf("\n");
+        }
+        session.DisableCapture();
+    }
+
+    const char* names[2] = { "weapon", "armor" };
+    printf("%-8s %12s %12s %12s %14s %14s\n", "site", "baseline ns", "hooked ns", "instr. ns", "hook cost ns", "instr. cost ns");
+    for (int i = 0; i < 2; i++) {
+        printf("%-8s %12.2f %12.2f %12.2f %14.2f %14.2f\n", names[i], baseline[i], hooked[0][i], hooked[1][i],
+            hooked[0][i] - baseline[i], hooked[1][i] - hooked[0][i]);
+    }
+
+    session.Detach();
+    munmap(module, MODULE_SIZE);
+    return 0;
+}
@@ -0,0 +1,238 @@
+// 补丁完整性检查的正确性检查 (不需要游戏进程)
+//
+// 用法:
+//   integrity_check [--check]
+//
+// 合成的范围直接交给 CheckIntegrityRanges，再用模拟的游戏进程 (tools/simulated_game.h) 跑会话，改写其中的字节。
+// 要求:
+//   完好 / 已恢复 / 被改写 / 未监视的范围分别判为 INTACT / REVERTED / FOREIGN / UNWATCHED，相近的范围一次读取；
+//   合并读取失败时逐个范围重读，读不到的范围为 UNKNOWN，相邻的范围照常判断；
+//   会话中注入点被其它程序改写后标为 FOREIGN，撤下时不写回原始字节，分离时代码洞保留；
+//   被游戏恢复为原始字节的注入点视为已撤下，之后可以重新启用；hook 代码被改动时为 FOREIGN；
+//   注入点暂时读不到时为 UNKNOWN，注入器状态不变，恢复可读后为 INTACT，撤下时照常写回原始字节；
+//   技能绕过的两个位置分别被恢复后整体视为已撤下；正常分离释放代码洞；自动检查按间隔执行。
+
+#include "check_tool.h"
+#include "integrity_monitor.h"
+#include "resident_cave.h"
+#include "session.h"
+#include "simulated_game.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr QWORD RANGE_BASE = 0x300000000ull;
+
+    using CheckTool::Expect;
+
+    IntegrityRange MakeRange(SimulatedProcessMemory& memory, QWORD address, uint32_t size, uint8_t ours, uint8_t original) {
+        std::vector<uint8_t> bytes(size, ours);
+        IntegrityRange range;
+        range.address = address;
+        range.size = size;
+        range.expectedHash = HashResidentBytes(bytes.data(), size);
+        memset(bytes.data(), original, size);
+        range.originalHash = HashResidentBytes(bytes.data(), size);
+        memory.SetBytes(address, bytes.data(), size);
+        return range;
+    }
+
+    // 合成的范围: 0 完好、1 已恢复、2 被改写、3 未监视、4 在另一个区域中
+    bool CheckRanges() {
+        SimulatedProcessMemory memory;
+        SimulatedGame::AddRegion(memory, RANGE_BASE, 0x2000, MemProtect::ReadWrite, MemType::Private);
+        SimulatedGame::AddRegion(memory, RANGE_BASE + 0x2000, 0x1000, MemProtect::ReadWrite, MemType::Private);
+        SimulatedGame::AddRegion(memory, RANGE_BASE + 0x3000, 0x1000, MemProtect::ReadWrite, MemType::Private);
+
+        IntegrityRange ranges[5];
+        ranges[0] = MakeRange(memory, RANGE_BASE + 0x100, 5, 0xE9, 0x48);
+        memory.SetBytes(ranges[0].address, std::vector<uint8_t>(5, 0xE9).data(), 5);
+        ranges[1] = MakeRange(memory, RANGE_BASE + 0x800, 8, 0x90, 0x75);
+        ranges[2] = MakeRange(memory, RANGE_BASE + 0x1800, 16, 0xCC, 0x0F);
+        memory.SetBytes(ranges[2].address, std::vector<uint8_t>(16, 0x11).data(), 16);
+        ranges[3] = {};
+        ranges[4] = MakeRange(memory, RANGE_BASE + 0x3100, 8, 0xAA, 0xBB);
+        memory.SetBytes(ranges[4].address, std::vector<uint8_t>(8, 0xAA).data(), 8);
+        IntegrityRange gap = MakeRange(memory, RANGE_BASE + 0x2100, 8, 0xAA, 0xBB);
+        memory.SetBytes(gap.address, std::vector<uint8_t>(8, 0xAA).data(), 8);
+        IntegrityRange withGap[6] = { ranges[0], ranges[1], ranges[2], ranges[3], gap, ranges[4] };
+
+        bool ok = true;
+        uint8_t states[6];
+        uint32_t reads = 0;
+        uint32_t bytes = 0;
+        CheckIntegrityRanges(&memory, withGap, 6, states, reads, bytes);
+        ok = Expect(states[0] == INTEGRITY_INTACT && states[1] == INTEGRITY_REVERTED && states[2] == INTEGRITY_FOREIGN &&
+            states[3] == INTEGRITY_UNWATCHED && states[4] == INTEGRITY_INTACT && states[5] == INTEGRITY_INTACT, "range states") && ok;
+        ok = Expect(reads == 1, "nearby ranges are not read at once") && ok;
+
+        // 中间的区域释放: 合并读取失败，每个范围单独重读
+        memory.Free(RANGE_BASE + 0x2000);
+        CheckIntegrityRanges(&memory, withGap, 6, states, reads, bytes);
+        ok = Expect(states[0] == INTEGRITY_INTACT && states[1] == INTEGRITY_REVERTED && states[2] == INTEGRITY_FOREIGN &&
+            states[4] == INTEGRITY_UNKNOWN && states[5] == INTEGRITY_INTACT, "ranges next to an unreadable range") && ok;
+        ok = Expect(reads == 1 + 5, "failed merged read is not retried per range") && ok;
+
+        // 单独一个读不到的范围只读一次
+        CheckIntegrityRanges(&memory, &gap, 1, states, reads, bytes);
+        ok = Expect(states[0] == INTEGRITY_UNKNOWN && reads == 1 && bytes == 0, "single unreadable range") && ok;
+
+        return CheckTool::Report("ranges", ok);
+    }
+
+    struct GameSession {
+        SimulatedProcessMemory memory;
+        BorrowedProcessMemory* borrowed = nullptr;
+        Session session;
+
+        bool Attach() {
+            SimulatedGame::Build(memory);
+            borrowed = new BorrowedProcessMemory(memory);
+            return session.Attach(std::unique_ptr<ProcessMemory>(borrowed));
+        }
+
+        IntegrityStats Check() {
+            IntegrityStats stats = {};
+            session.CheckIntegrity(&stats);
+            return stats;
+        }
+    };
+
+    // 注入点被其它程序改写，之后技能绕过的两个位置先后被游戏恢复
+    bool CheckForeignPatch() {
+        GameSession game;
+        bool ok = Expect(game.Attach(), "attach");
+        IntegrityStats stats = game.Check();
+        ok = Expect(stats.lastReads == 0 && stats.states[0] == INTEGRITY_UNWATCHED, "nothing to check before enabling") && ok;
+        ok = Expect(game.session.EnableCapture() && game.session.EnableSkillBypass(), "enable hooks") && ok;
+        if (!ok) {
+            return false;
+        }
+
+        stats = game.Check();
+        for (int site = 0; site < INTEGRITY_SITE_COUNT; site++) {
+            ok = Expect(stats.states[site] == INTEGRITY_INTACT, "enabled sites are not intact") && ok;
+        }
+
+        QWORD arena = SimulatedGame::CommittedRegion(game.memory, SimulatedGame::JumpTarget(game.memory, SimulatedGame::WEAPON_SITE));
+        const uint8_t foreign = 0xCC;
+        game.memory.SetBytes(SimulatedGame::WEAPON_SITE, &foreign, 1);
+        stats = game.Check();
+        ok = Expect(stats.states[INTEGRITY_SITE_WEAPON_PATCH] == INTEGRITY_FOREIGN &&
+            stats.states[INTEGRITY_SITE_ARMOR_PATCH] == INTEGRITY_INTACT, "overwritten patch is not foreign") && ok;
+
+        game.session.DisableCapture();
+        uint8_t current = 0;
+        game.memory.Read(SimulatedGame::WEAPON_SITE, &current, 1);
+        ok = Expect(current == foreign, "foreign patch was written back") && ok;
+        ok = Expect(!game.session.IsArmorHookEnabled() &&
+            SimulatedGame::Matches(game.memory, SimulatedGame::ARMOR_SITE, SimulatedGame::ARMOR_BYTES, sizeof(SimulatedGame::ARMOR_BYTES)),
+            "intact hook was not removed") && ok;
+
+        game.memory.SetBytes(SimulatedGame::SKILL_SITE1, SimulatedGame::SKILL1_BYTES, sizeof(SimulatedGame::SKILL1_BYTES));
+        stats = game.Check();
+        ok = Expect(stats.states[INTEGRITY_SITE_SKILL_PATCH1] == INTEGRITY_REVERTED && game.session.IsSkillBypassEnabled(),
+            "first reverted skill site") && ok;
+        stats = game.Check();
+        ok = Expect(stats.states[INTEGRITY_SITE_SKILL_PATCH1] == INTEGRITY_UNWATCHED &&
+            stats.states[INTEGRITY_SITE_SKILL_PATCH2] == INTEGRITY_INTACT, "reverted skill site is still watched") && ok;
+        game.memory.SetBytes(SimulatedGame::SKILL_SITE2, SimulatedGame::SKILL2_BYTES, sizeof(SimulatedGame::SKILL2_BYTES));
+        game.Check();
+        ok = Expect(!game.session.IsSkillBypassEnabled(), "skill bypass still enabled after both sites reverted") && ok;
+
+        game.session.Detach();
+        ok = Expect(arena != 0 && SimulatedGame::CommittedRegion(game.memory, arena) == arena, "code cave freed after a foreign patch") && ok;
+        return CheckTool::Report("foreign patch", ok);
+    }
+
+    // 游戏恢复了原始字节 -> 视为已撤下并可重新启用；hook 代码被改动 -> FOREIGN
+    bool CheckRevertedAndCode() {
+        GameSession game;
+        bool ok = Expect(game.Attach() && game.session.EnableCapture(), "attach and enable");
+        if (!ok) {
+            return false;
+        }
+
+        game.memory.SetBytes(SimulatedGame::WEAPON_SITE, SimulatedGame::WEAPON_BYTES, sizeof(SimulatedGame::WEAPON_BYTES));
+        IntegrityStats stats = game.Check();
+        ok = Expect(stats.states[INTEGRITY_SITE_WEAPON_PATCH] == INTEGRITY_REVERTED, "restored patch is not reverted") && ok;
+        ok = Expect(!game.session.IsWeaponHookEnabled() && game.session.IsArmorHookEnabled(), "reverted hook state") && ok;
+        stats = game.Check();
+        ok = Expect(stats.states[INTEGRITY_SITE_WEAPON_PATCH] == INTEGRITY_UNWATCHED &&
+            stats.states[INTEGRITY_SITE_WEAPON_CODE] == INTEGRITY_UNWATCHED, "reverted hook is still watched") && ok;
+        ok = Expect(game.session.EnableCapture() && game.session.IsWeaponHookEnabled() &&
+            SimulatedGame::JumpTarget(game.memory, SimulatedGame::WEAPON_SITE) != 0, "re-enable after revert") && ok;
+
+        QWORD code = SimulatedGame::JumpTarget(game.memory, SimulatedGame::WEAPON_SITE);
+        QWORD arena = SimulatedGame::CommittedRegion(game.memory, code);
+        uint8_t byte = 0;
+        game.memory.Read(code + 4, &byte, 1);
+        byte ^= 0xFF;
+        game.memory.SetBytes(code + 4, &byte, 1);
+        stats = game.Check();
+        ok = Expect(stats.states[INTEGRITY_SITE_WEAPON_CODE] == INTEGRITY_FOREIGN &&
+            stats.states[INTEGRITY_SITE_WEAPON_PATCH] == INTEGRITY_INTACT, "modified hook code is not foreign") && ok;
+
+        game.session.Detach();
+        ok = Expect(SimulatedGame::CommittedRegion(game.memory, arena) == arena, "code cave freed after foreign hook code") && ok;
+        return CheckTool::Report("reverted / code", ok);
+    }
+
+    // 注入点暂时读不到: UNKNOWN 不改变注入器状态
+    bool CheckUnknown() {
+        GameSession game;
+        bool ok = Expect(game.Attach() && game.session.EnableCapture(), "attach and enable");
+        if (!ok) {
+            return false;
+        }
+
+        game.borrowed->readFailStart = SimulatedGame::WEAPON_SITE;
+        game.borrowed->readFailEnd = SimulatedGame::WEAPON_SITE + 1;
+        IntegrityStats stats = game.Check();
+        ok = Expect(stats.states[INTEGRITY_SITE_WEAPON_PATCH] == INTEGRITY_UNKNOWN &&
+            stats.states[INTEGRITY_SITE_ARMOR_PATCH] == INTEGRITY_INTACT, "unreadable patch is not unknown") && ok;
+        ok = Expect(game.session.IsWeaponHookEnabled() && game.session.IsArmorHookEnabled(), "unknown changed the hook state") && ok;
+
+        game.borrowed->readFailStart = game.borrowed->readFailEnd = 0;
+        stats = game.Check();
+        ok = Expect(stats.states[INTEGRITY_SITE_WEAPON_PATCH] == INTEGRITY_INTACT, "readable patch is not intact again") && ok;
+
+        QWORD arena = SimulatedGame::CommittedRegion(game.memory, SimulatedGame::JumpTarget(game.memory, SimulatedGame::WEAPON_SITE));
+        game.session.DisableCapture();
+        ok = Expect(SimulatedGame::Matches(game.memory, SimulatedGame::WEAPON_SITE, SimulatedGame::WEAPON_BYTES,
+            sizeof(SimulatedGame::WEAPON_BYTES)), "hook not removed after an unknown check") && ok;
+        game.session.Detach();
+        ok = Expect(SimulatedGame::CommittedRegion(game.memory, arena) == 0, "code cave kept after a clean detach") && ok;
+        return CheckTool::Report("unknown", ok);
+    }
+
+    // 自动检查只在间隔到期后的轮询中执行
+    bool CheckInterval() {
+        GameSession game;
+        bool ok = Expect(game.Attach() && game.session.EnableCapture(), "attach and enable");
+        if (!ok) {
+            return false;
+        }
+
+        IntegrityStats stats = {};
+        game.session.SetIntegrityInterval(50);
+        game.session.GetWeaponBase();
+        ok = Expect(game.session.GetIntegrityStats(&stats) && stats.checks == 1, "first poll does not check") && ok;
+        game.session.GetWeaponBase();
+        ok = Expect(game.session.GetIntegrityStats(&stats) && stats.checks == 1, "poll within the interval checks again") && ok;
+        std::this_thread::sleep_for(std::chrono::milliseconds(60));
+        game.session.GetWeaponBase();
+        ok = Expect(game.session.GetIntegrityStats(&stats) && stats.checks == 2, "poll after the interval does not check") && ok;
+        return CheckTool::Report("interval", ok);
+    }
+}
+
+int main(int argc, char** argv) {
+    return CheckTool::Run(argc, argv, "integrity", {
+        CheckRanges, CheckForeignPatch, CheckRevertedAndCode, CheckUnknown, CheckInterval
+    });
+}
@@ -0,0 +1,203 @@
+// 背包数组布局推导检查 (模拟的游戏进程，不需要游戏进程)
+//
+// 用法:
+//   inventory_check [--check]
+//
+// 在模拟的内存中构造容器: 内联数组 (开始/结束/容量指针) 和指针数组 (32 位计数，装备分散在两块内存中)，
+// 容器中另放无关的向量和指向数组内部的指针作为干扰项；再让会话从带容器指针的捕获记录推导布局并读出背包。
+// 要求:
+//   推导出的数组种类、字段偏移、元素大小和元素数与构造的容器相同；只有一件位于开头的装备或装备不在任何数组中时推导失败；
+//   读取背包时内联数组共 2 次读取，数组增长或清空后读到新的元素数，指针数组跳过空指针；读出的装备字段与写入的相同；
+//   会话没有带容器指针的捕获时读取失败，有捕获时用捕获最多的容器推导并读出全部装备，容量不足时仍返回总数；
+//   同时开启容器捕获、插桩和信箱时两个 hook 都能安装。
+
+#include "check_tool.h"
+#include "inventory_layout.h"
+#include "session.h"
+#include "simulated_game.h"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+    constexpr QWORD POOL_BASE = 0x300000000ull;
+    constexpr QWORD SECOND_POOL_BASE = 0x400000000ull;
+    constexpr QWORD POOL_SIZE = 0x100000;
+
+    using CheckTool::Expect;
+
+    void Put64(ProcessMemory& memory, QWORD address, uint64_t value) {
+        memory.Write(address, &value, sizeof(value));
+    }
+
+    void Put32(ProcessMemory& memory, QWORD address, uint32_t value) {
+        memory.Write(address, &value, sizeof(value));
+    }
+
+    // 第 index 件装备: 物品 ID 1000 + index，词条 i 的 ID 为 index * 10 + i、等级为 i + 1
+    void PutItem(ProcessMemory& memory, QWORD base, int index) {
+        int16_t itemId = (int16_t)(1000 + index);
+        memory.Write(base + EquipmentLayout::ITEM_ID_OFFSET, &itemId, sizeof(itemId));
+        for (int slot = 0; slot < MemoryLayout::AFFIX_SLOT_COUNT; slot++) {
+            Put32(memory, base + MemoryLayout::GetAffixIdOffset(slot), (uint32_t)(index * 10 + slot));
+            Put32(memory, base + MemoryLayout::GetAffixLevelOffset(slot), (uint32_t)(slot + 1));
+        }
+    }
+
+    void AddPool(SimulatedProcessMemory& memory, QWORD base) {
+        SimulatedGame::AddRegion(memory, base, POOL_SIZE, MemProtect::ReadWrite, MemType::Private);
+    }
+
+    // 内联数组 {begin, end, capacity} 在容器 +158，元素大小 1A0，20 件装备
+    bool CheckInlineArray() {
+        SimulatedProcessMemory memory;
+        AddPool(memory, POOL_BASE);
+        const QWORD owner = POOL_BASE;
+        const QWORD array = POOL_BASE + 0x10000;
+        const uint32_t stride = 0x1A0;
+        Put64(memory, owner + 0x10, POOL_BASE + 0x20000);       // 无关的向量
+        Put64(memory, owner + 0x18, POOL_BASE + 0x20040);
+        Put64(memory, owner + 0x100, array + 0x20);             // 指向数组内部，与装备不对齐
+        Put64(memory, owner + 0x158, array);
+        Put64(memory, owner + 0x160, array + 20 * stride);
+        Put64(memory, owner + 0x168, array + 32 * stride);
+        for (int i = 0; i < 20; i++) {
+            PutItem(memory, array + i * stride, i);
+        }
+
+        const QWORD bases[] = { array + 3 * stride, array + 4 * stride, array + 9 * stride };
+        InventoryLayout layout;
+        memory.ResetOpCounts();
+        bool ok = Expect(DeriveInventoryLayout(&memory, owner, bases, 3, layout), "derive inline layout");
+        uint64_t deriveReads = memory.GetOpCount(TraceOp::Read);
+        ok = Expect(layout.arrayKind == INVENTORY_ARRAY_INLINE && layout.stride == stride && layout.count == 20 &&
+            layout.arrayFieldOffset == 0x158 && layout.countFieldOffset == 0x160 && layout.countKind == INVENTORY_COUNT_END_POINTER,
+            "inline layout fields") && ok;
+
+        std::vector<QWORD> items;
+        std::vector<uint8_t> records;
+        memory.ResetOpCounts();
+        ok = Expect(ReadInventoryRecords(&memory, layout, items, records) && memory.GetOpCount(TraceOp::Read) == 2, "read inline records") && ok;
+        int32_t affixId = 0;
+        if (records.size() == 20 * InventoryScanLayout::RECORD_SIZE) {
+            memcpy(&affixId, records.data() + 7 * InventoryScanLayout::RECORD_SIZE + MemoryLayout::GetAffixIdOffset(2), sizeof(affixId));
+        }
+        ok = Expect(items.size() == 20 && items[5] == array + 5 * stride && affixId == 72, "inline records") && ok;
+
+        // 背包增长和清空
+        Put64(memory, owner + 0x160, array + 25 * stride);
+        ok = Expect(ReadInventoryRecords(&memory, layout, items, records) && items.size() == 25 && layout.count == 25, "grown inventory") && ok;
+        Put64(memory, owner + 0x160, array);
+        ok = Expect(ReadInventoryRecords(&memory, layout, items, records) && items.empty(), "empty inventory") && ok;
+
+        // 只有位于开头的一件装备时元素大小无法确定；装备不在任何数组中
+        Put64(memory, owner + 0x160, array + 20 * stride);
+        const QWORD first[] = { array };
+        ok = Expect(!DeriveInventoryLayout(&memory, owner, first, 1, layout), "ambiguous single item derived") && ok;
+        const QWORD stray[] = { POOL_BASE + 0x80000, POOL_BASE + 0x80400 };
+        ok = Expect(!DeriveInventoryLayout(&memory, owner, stray, 2, layout), "items outside any array derived") && ok;
+        return CheckTool::Report("inline array", ok, "derive: %llu reads", (unsigned long long)deriveReads);
+    }
+
+    // 指针数组在容器 +150，32 位计数在 +158 (+15C 是容量)，装备分散在两块内存中，第 7 项为空指针
+    bool CheckPointerArray() {
+        SimulatedProcessMemory memory;
+        AddPool(memory, POOL_BASE);
+        AddPool(memory, SECOND_POOL_BASE);
+        const QWORD owner = POOL_BASE;
+        const QWORD table = POOL_BASE + 0x40000;
+        Put64(memory, owner + 0x150, table);
+        Put32(memory, owner + 0x158, 12);
+        Put32(memory, owner + 0x15C, 16);
+        std::vector<QWORD> bases;
+        for (int i = 0; i < 12; i++) {
+            QWORD base = i < 6 ? POOL_BASE + 0x50000 + i * 0x200 : SECOND_POOL_BASE + 0x10000 + i * 0x3000;
+            if (i == 7) {
+                base = 0;
+            }
+            bases.push_back(base);
+            Put64(memory, table + i * 8, base);
+            if (base != 0) {
+                PutItem(memory, base, i);
+            }
+        }
+
+        const QWORD captured[] = { bases[2], bases[9] };
+        InventoryLayout layout;
+        bool ok = Expect(DeriveInventoryLayout(&memory, owner, captured, 2, layout), "derive pointer layout");
+        ok = Expect(layout.arrayKind == INVENTORY_ARRAY_POINTERS && layout.count == 12 && layout.arrayFieldOffset == 0x150 &&
+            layout.countFieldOffset == 0x158 && layout.countKind == INVENTORY_COUNT_U32, "pointer layout fields") && ok;
+
+        std::vector<QWORD> items;
+        std::vector<uint8_t> records;
+        memory.ResetOpCounts();
+        ok = Expect(ReadInventoryRecords(&memory, layout, items, records), "read pointer records") && ok;
+        uint64_t reads = memory.GetOpCount(TraceOp::Read);
+        int16_t itemId = 0;
+        if (records.size() == 11 * InventoryScanLayout::RECORD_SIZE) {
+            memcpy(&itemId, records.data() + 7 * InventoryScanLayout::RECORD_SIZE + EquipmentLayout::ITEM_ID_OFFSET, sizeof(itemId));
+        }
+        ok = Expect(items.size() == 11 && items[7] == bases[8] && itemId == 1008, "pointer records skip the null entry") && ok;
+        return CheckTool::Report("pointer array", ok, "read: %llu reads", (unsigned long long)reads);
+    }
+
+    // 会话: 装备 hook 的捕获记录带有容器指针
+    bool CheckSession() {
+        SimulatedProcessMemory memory;
+        SimulatedGame::Build(memory);
+        AddPool(memory, POOL_BASE);
+        const QWORD owner = POOL_BASE;
+        const QWORD array = POOL_BASE + 0x10000;
+        const uint32_t stride = 0x100;
+        Put64(memory, owner + 0x150, array);
+        Put32(memory, owner + 0x158, 8);
+        for (int i = 0; i < 8; i++) {
+            PutItem(memory, array + i * stride, i);
+        }
+
+        Session session;
+        session.SetOwnerCapture(true);
+        bool ok = Expect(session.Attach(std::unique_ptr<ProcessMemory>(new BorrowedProcessMemory(memory))) && session.EnableCapture(),
+            "attach and enable");
+        if (!ok) {
+            return CheckTool::Report("session", false);
+        }
+        ok = Expect(session.ReadInventory(nullptr, 0) == -1, "inventory read without a captured owner") && ok;
+
+        QWORD ring = SimulatedGame::CaptureRingAddress(memory);
+        SimulatedGame::ProduceCapture(memory, ring, array + 1 * stride, CaptureRingLayout::SOURCE_ARMOR, owner);
+        SimulatedGame::ProduceCapture(memory, ring, array + 2 * stride, CaptureRingLayout::SOURCE_ARMOR, owner);
+        SimulatedGame::ProduceCapture(memory, ring, SimulatedGame::HEAP_BASE + 0x100, CaptureRingLayout::SOURCE_WEAPON);
+        CapturedItem captured[4];
+        int capturedCount = session.GetCapturedItems(captured, 4);
+        int owned = 0;
+        for (int i = 0; i < capturedCount; i++) {
+            owned += captured[i].owner == owner ? 1 : 0;
+        }
+        ok = Expect(capturedCount == 3 && owned == 2, "captured owners") && ok;
+
+        InventoryLayout layout;
+        ok = Expect(session.DeriveInventoryLayout(&layout) && layout.stride == stride && layout.count == 8, "session layout") && ok;
+        InventoryItem items[16];
+        ok = Expect(session.ReadInventory(items, 16) == 8, "inventory total") && ok;
+        ok = Expect(items[5].base == array + 5 * stride && items[5].itemId == 1005 && items[5].affixIds[6] == 56 &&
+            items[5].affixLevels[6] == 7, "inventory item fields") && ok;
+        ok = Expect(session.ReadInventory(items, 3) == 8, "total with a small buffer") && ok;
+        session.Detach();
+
+        // 容器捕获、插桩和信箱同时开启时装备 hook 代码最长
+        Session full;
+        full.SetOwnerCapture(true);
+        full.SetHookInstrumentation(true);
+        full.SetEditMailbox(true);
+        ok = Expect(full.Attach(std::unique_ptr<ProcessMemory>(new BorrowedProcessMemory(memory))) && full.EnableCapture() &&
+            full.IsWeaponHookEnabled() && full.IsArmorHookEnabled(), "hooks with every option") && ok;
+        full.Detach();
+        return CheckTool::Report("session", ok);
+    }
+}
+
+int main(int argc, char** argv) {
+    return CheckTool::Run(argc, argv, "inventory", { CheckInlineArray, CheckPointerArray, CheckSession });
+}
@@ -0,0 +1,229 @@
+// 编辑日志检查 (不需要游戏进程)
+//
+// 用法:
+//   journal_check [--check]
+//
+// 用一块内存中的装备记录代替目标进程，按会话的方式套用日志合成的补丁 (mask 为 0 的字节保持原值)。
+// 要求:
+//   随机的写入/撤销/重做/淘汰序列中，每次撤销或重做后记录与该步骤当时的快照逐字节相同；
+//   全部撤销后触发淘汰，剩余的重做步骤依次重做仍得到对应的快照 (淘汰不能丢掉下一个重做步骤)；
+//   恢复原始状态得到第一次写入前的记录，淘汰步骤不影响原始值；
+//   两段改写之间没有变化的字节不进入撤销、重做和恢复的补丁 (游戏在记录之后改写的值保持不变)。
+
+#include "check_tool.h"
+#include "edit_journal.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr QWORD RECORD_BASE = 0x200001000ull;
+    constexpr size_t RECORD_SIZE = 0x200;
+
+    // 一件装备: 当前内容和每一步之后的快照 (snapshots[0] 为首次写入前)
+    struct Record {
+        std::vector<uint8_t> bytes;
+        std::vector<std::vector<uint8_t>> snapshots;
+        size_t position = 0;            // 当前内容对应的快照
+    };
+
+    void ApplyPatch(Record& record, const JournalPatch& patch) {
+        for (size_t i = 0; i < patch.bytes.size(); i++) {
+            if (patch.mask[i] != 0) {
+                record.bytes[patch.offset + i] = patch.bytes[i];
+            }
+        }
+    }
+
+    // 随机改写几段字节 (可能与之前的步骤重叠)，记入日志
+    void RandomWrite(EditJournal& journal, Record& record, std::mt19937_64& random) {
+        uint32_t offset = (uint32_t)(random() % (RECORD_SIZE - 0x20));
+        uint32_t size = 1 + (uint32_t)(random() % 0x20);
+        std::vector<uint8_t> before(record.bytes.begin() + offset, record.bytes.begin() + offset + size);
+        for (uint32_t i = 0; i < size; i++) {
+            if (random() % 3 != 0) {
+                record.bytes[offset + i] = (uint8_t)random();
+            }
+        }
+        if (memcmp(before.data(), &record.bytes[offset], size) == 0) {
+            return;
+        }
+        journal.Record(RECORD_BASE, offset, before.data(), &record.bytes[offset], size);
+        record.snapshots.resize(record.position + 1);
+        record.snapshots.push_back(record.bytes);
+        record.position++;
+    }
+
+    using CheckTool::Expect;
+
+    bool Expect(bool condition, const char* what, int iteration) {
+        if (!condition) {
+            printf("  FAIL %s (iteration %d)\n", what, iteration);
+        }
+        return condition;
+    }
+
+    bool Undo(EditJournal& journal, Record& record, int steps, int iteration) {
+        JournalPatch patch;
+        int count = journal.PrepareUndo(RECORD_BASE, steps, patch);
+        ApplyPatch(record, patch);
+        journal.CommitUndo(RECORD_BASE, count);
+        record.position -= (size_t)count;
+        return Expect(record.bytes == record.snapshots[record.position], "undo result differs from snapshot", iteration);
+    }
+
+    bool Redo(EditJournal& journal, Record& record, int steps, int iteration) {
+        JournalPatch patch;
+        int count = journal.PrepareRedo(RECORD_BASE, steps, patch);
+        ApplyPatch(record, patch);
+        journal.CommitRedo(RECORD_BASE, count);
+        record.position += (size_t)count;
+        return Expect(record.bytes == record.snapshots[record.position], "redo result differs from snapshot", iteration);
+    }
+
+    bool Restore(EditJournal& journal, Record& record, int iteration) {
+        JournalPatch patch;
+        if (!journal.PrepareRestore(RECORD_BASE, patch)) {
+            return Expect(record.snapshots.empty() || record.bytes == record.snapshots[0], "restore unavailable", iteration);
+        }
+        std::vector<uint8_t> restored = record.bytes;
+        std::swap(restored, record.bytes);
+        ApplyPatch(record, patch);
+        std::swap(restored, record.bytes);
+        return Expect(restored == record.snapshots[0], "restore differs from the first snapshot", iteration);
+    }
+
+    Record NewRecord(std::mt19937_64& random) {
+        Record record;
+        record.bytes.resize(RECORD_SIZE);
+        for (uint8_t& b : record.bytes) {
+            b = (uint8_t)random();
+        }
+        record.snapshots.push_back(record.bytes);
+        return record;
+    }
+
+    // 写入若干步，全部撤销，压低上限触发淘汰，再全部重做
+    bool CheckEvictAfterUndoAll() {
+        std::mt19937_64 random(28);
+        bool ok = true;
+        for (int round = 0; round < 200; round++) {
+            EditJournal journal;
+            Record record = NewRecord(random);
+            int steps = 4 + (int)(random() % 12);
+            for (int i = 0; i < steps; i++) {
+                RandomWrite(journal, record, random);
+            }
+            ok = Undo(journal, record, journal.GetUndoDepth(RECORD_BASE), round) && ok;
+            ok = Expect(journal.GetUndoDepth(RECORD_BASE) == 0, "undo depth after undo all", round) && ok;
+
+            int redoBefore = journal.GetRedoDepth(RECORD_BASE);
+            journal.SetMemoryLimit(journal.GetMemoryUsage() - 1 - (size_t)(random() % 64));
+            int redoAfter = journal.GetRedoDepth(RECORD_BASE);
+            ok = Expect(redoAfter < redoBefore, "limit did not evict a step", round) && ok;
+
+            for (int i = 0; i < redoAfter; i++) {
+                ok = Redo(journal, record, 1, round) && ok;
+            }
+            ok = Undo(journal, record, redoAfter, round) && ok;
+            ok = Redo(journal, record, redoAfter, round) && ok;
+            ok = Restore(journal, record, round) && ok;
+            if (!ok) {
+                break;
+            }
+        }
+        return CheckTool::Report("evict after undo all", ok);
+    }
+
+    // 补丁只覆盖 offsets 中的字节
+    bool Covers(const JournalPatch& patch, std::initializer_list<uint32_t> offsets) {
+        size_t masked = 0;
+        for (size_t i = 0; i < patch.mask.size(); i++) {
+            if (patch.mask[i] != 0) {
+                masked++;
+                if (std::find(offsets.begin(), offsets.end(), patch.offset + (uint32_t)i) == offsets.end()) {
+                    return false;
+                }
+            }
+        }
+        return masked == offsets.size();
+    }
+
+    // 一次改写中相隔两个未变化字节的两段: 撤销/重做/恢复只写这两段
+    bool CheckGapBytes() {
+        std::vector<uint8_t> before(16, 0x11);
+        std::vector<uint8_t> after(before);
+        after[2] = 0x22;
+        after[5] = 0x33;
+        EditJournal journal;
+        journal.Record(RECORD_BASE, 0x40, before.data(), after.data(), before.size());
+
+        JournalPatch patch;
+        bool ok = Expect(journal.PrepareUndo(RECORD_BASE, 1, patch) == 1 && Covers(patch, { 0x42, 0x45 }), "undo writes gap bytes");
+        journal.CommitUndo(RECORD_BASE, 1);
+        ok = Expect(journal.PrepareRedo(RECORD_BASE, 1, patch) == 1 && Covers(patch, { 0x42, 0x45 }), "redo writes gap bytes") && ok;
+        journal.CommitRedo(RECORD_BASE, 1);
+        ok = Expect(journal.PrepareRestore(RECORD_BASE, patch) && Covers(patch, { 0x42, 0x45 }), "restore writes gap bytes") && ok;
+        return CheckTool::Report("gap bytes", ok);
+    }
+
+    // 随机的写入/撤销/重做/淘汰序列；淘汰后可撤销/可重做的范围只会收缩，不会对应到错误的快照
+    bool CheckRandomSequences() {
+        std::mt19937_64 random(2028);
+        bool ok = true;
+        for (int round = 0; round < 300 && ok; round++) {
+            EditJournal journal;
+            Record record = NewRecord(random);
+            for (int op = 0; op < 60 && ok; op++) {
+                int iteration = round * 100 + op;
+                switch (random() % 6) {
+                case 0:
+                case 1:
+                    RandomWrite(journal, record, random);
+                    break;
+                case 2:
+                    ok = Undo(journal, record, 1 + (int)(random() % 4), iteration);
+                    break;
+                case 3:
+                    ok = Redo(journal, record, 1 + (int)(random() % 4), iteration);
+                    break;
+                case 4:
+                    if (journal.GetMemoryUsage() > 0) {
+                        journal.SetMemoryLimit(journal.GetMemoryUsage() - (size_t)(random() % 200));
+                    }
+                    journal.SetMemoryLimit(EditJournal::DEFAULT_MEMORY_LIMIT);
+                    if (journal.GetUndoDepth(RECORD_BASE) + journal.GetRedoDepth(RECORD_BASE) == 0) {
+                        // 整条记录被淘汰，之后的写入重新记录原始值
+                        JournalPatch patch;
+                        if (!journal.PrepareRestore(RECORD_BASE, patch)) {
+                            record.snapshots.assign(1, record.bytes);
+                            record.position = 0;
+                        }
+                    }
+                    break;
+                default:
+                    ok = Restore(journal, record, iteration);
+                    break;
+                }
+                if (ok && journal.GetUndoDepth(RECORD_BASE) + journal.GetRedoDepth(RECORD_BASE) > 0) {
+                    size_t undo = (size_t)journal.GetUndoDepth(RECORD_BASE);
+                    size_t redo = (size_t)journal.GetRedoDepth(RECORD_BASE);
+                    ok = Expect(undo <= record.position && record.position + redo < record.snapshots.size(),
+                        "depths exceed the recorded steps", iteration);
+                }
+            }
+            if (ok) {
+                ok = Undo(journal, record, journal.GetUndoDepth(RECORD_BASE), round) &&
+                    Redo(journal, record, journal.GetRedoDepth(RECORD_BASE), round);
+            }
+        }
+        return CheckTool::Report("random sequences", ok);
+    }
+}
+
+int main(int argc, char** argv) {
+    return CheckTool::Run(argc, argv, "journal", { CheckEvictAfterUndoAll, CheckRandomSequences, CheckGapBytes });
+}
@@ -0,0 +1,440 @@
+// 记录布局与读写计划: 正确性检查和开销
+//
+// 用法:
+//   layout_bench                  计时计划编译、缓存查找和按计划读出/解码，对比逐字段读取的远程操作次数
+//   layout_bench --check          只检查正确性
+//
+// --check 要求:
+//   内置布局下全部字段编译为一个区间 [0, 最后一个字段末尾)；constexpr 生成的计划与运行期编译的计划逐字节相同；
+//   随机布局和随机字段集合的计划满足: 区间按偏移升序且互不重叠，相邻区间的间隔大于 MERGE_GAP，
+//   区间数等于独立计算的最少区间数，每个字段完整地落在一个区间内且缓冲位置正确；
+//   按计划读出并解码的值与直接从快照按字节解码的值完全相同 (含符号扩展和位字段)；
+//   按计划写入只改变字段覆盖的字节 (位字段只改变该位)；会话写入装备字段时，游戏在读出前像之后改写的字段间字节保持游戏的值；
+//   布局文件写出后读回与原布局相同，不合法的行、互相重叠的字段、槽位间距小于槽位内字段的范围或超出记录上限的槽位被拒绝并报告行号；缓存对同一字段集合返回同一个计划。
+
+#include "record_layout.h"
+#include "session.h"
+#include "simulated_game.h"
+#include "snapshot_memory.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr QWORD HEAP_BASE = 0x200000000ull;
+    constexpr uint32_t HEAP_SIZE = 0x20000;
+    constexpr uint32_t RANDOM_EXTENT = 0x3000;      // 随机布局的字段范围 (大于 MERGE_GAP，产生多个区间)
+
+    volatile int64_t g_sink;
+
+    double Nanoseconds(std::chrono::steady_clock::time_point start, uint64_t count) {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (double)count;
+    }
+
+    bool SamePlan(const RecordPlan& a, const RecordPlan& b) {
+        return memcmp(&a, &b, sizeof(RecordPlan)) == 0;
+    }
+
+    RecordFieldTable RandomTable(std::mt19937_64& random) {
+        RecordFieldTable table{};
+        for (RecordFieldDesc& desc : table.fields) {
+            static const uint8_t SIZES[] = { 1, 2, 4 };
+            desc.size = SIZES[random() % 3];
+            desc.offset = (uint32_t)(random() % (RANDOM_EXTENT - desc.size));
+            desc.bit = desc.size == 1 && random() % 4 == 0 ? (uint8_t)(random() % 8) : RecordPlanLayout::NO_BIT;
+            desc.isSigned = (uint8_t)(random() % 2);
+        }
+        return table;
+    }
+
+    // 直接从内存按字节解码 (不经过计划)
+    int64_t ReferenceDecode(const RecordFieldDesc& desc, const uint8_t* bytes) {
+        if (desc.bit != RecordPlanLayout::NO_BIT) {
+            return (bytes[0] >> desc.bit) & 1;
+        }
+        switch (desc.size) {
+        case 1: return desc.isSigned ? (int64_t)(int8_t)bytes[0] : (int64_t)bytes[0];
+        case 2: {
+            uint16_t value;
+            memcpy(&value, bytes, sizeof(value));
+            return desc.isSigned ? (int64_t)(int16_t)value : (int64_t)value;
+        }
+        default: {
+            uint32_t value;
+            memcpy(&value, bytes, sizeof(value));
+            return desc.isSigned ? (int64_t)(int32_t)value : (int64_t)value;
+        }
+        }
+    }
+
+    // 计划的结构性质和最少区间数
+    bool CheckPlanShape(const RecordFieldTable& table, uint64_t fields, const RecordPlan& plan) {
+        std::vector<std::pair<uint32_t, uint32_t>> ranges;
+        for (int field = 0; field < RECORD_FIELD_COUNT; field++) {
+            if ((fields & RecordFieldBit(field)) != 0) {
+                ranges.push_back({ table.fields[field].offset, table.fields[field].offset + table.fields[field].size });
+            }
+        }
+        std::sort(ranges.begin(), ranges.end());
+        uint32_t expectedSpans = 0;
+        uint32_t end = 0;
+        for (const auto& range : ranges) {
+            if (expectedSpans == 0 || range.first > end + RecordPlanLayout::MERGE_GAP) {
+                expectedSpans++;
+            }
+            end = std::max(end, range.second);
+        }
+        if (plan.fields != fields || plan.spanCount != expectedSpans) {
+            fprintf(stderr, "plan for %016llX has %u spans, %u expected\n", (unsigned long long)fields, plan.spanCount, expectedSpans);
+            return false;
+        }
+
+        uint32_t bufferStart = 0;
+        for (uint32_t s = 0; s < plan.spanCount; s++) {
+            const RecordSpan& span = plan.spans[s];
+            if (span.size == 0 || (s > 0 && span.offset <= plan.spans[s - 1].offset + plan.spans[s - 1].size + RecordPlanLayout::MERGE_GAP)) {
+                fprintf(stderr, "span %u of %016llX overlaps or is too close to the previous one\n", s, (unsigned long long)fields);
+                return false;
+            }
+            for (int field = 0; field < RECORD_FIELD_COUNT; field++) {
+                const RecordFieldDesc& desc = table.fields[field];
+                if ((fields & RecordFieldBit(field)) != 0 && desc.offset >= span.offset && desc.offset < span.offset + span.size &&
+                    (desc.offset + desc.size > span.offset + span.size || plan.bufferOffsets[field] != bufferStart + desc.offset - span.offset)) {
+                    fprintf(stderr, "field %d is not placed inside span %u\n", field, s);
+                    return false;
+                }
+            }
+            bufferStart += span.size;
+        }
+        if (bufferStart != plan.bufferSize) {
+            fprintf(stderr, "buffer size mismatch\n");
+            return false;
+        }
+        return true;
+    }
+
+    SnapshotMemory MakeHeap(std::mt19937_64& random) {
+        SnapshotMemory memory;
+        memory.regions.push_back({ HEAP_BASE, MemProtect::ReadWrite, MemType::Private, std::vector<uint8_t>(HEAP_SIZE) });
+        for (uint8_t& byte : memory.regions[0].bytes) {
+            byte = (uint8_t)random();
+        }
+        return memory;
+    }
+
+    bool CheckDefaults() {
+        const RecordPlan& all = DefaultRecordPlan<RecordFieldSets::ALL>::plan;
+        const RecordFieldDesc& last = DEFAULT_RECORD_FIELDS.fields[AffixFieldId(MemoryLayout::AFFIX_SLOT_COUNT - 1, AFFIX_PART_PREFIX1 + 3)];
+        if (all.spanCount != 1 || all.spans[0].offset != 0 || all.spans[0].size != last.offset + last.size) {
+            fprintf(stderr, "built-in layout does not compile to one span\n");
+            return false;
+        }
+        for (int field = 0; field < RECORD_FIELD_COUNT; field++) {
+            if (all.bufferOffsets[field] != DEFAULT_RECORD_FIELDS.fields[field].offset) {
+                fprintf(stderr, "field %d misplaced in the built-in plan\n", field);
+                return false;
+            }
+        }
+
+        bool ok = SamePlan(all, CompileRecordPlan(DEFAULT_RECORD_FIELDS, RecordFieldSets::ALL)) &&
+            SamePlan(DefaultRecordPlan<RecordFieldSets::BASICS | RecordFieldSets::EXTENDED>::plan,
+                CompileRecordPlan(DEFAULT_RECORD_FIELDS, RecordFieldSets::BASICS | RecordFieldSets::EXTENDED)) &&
+            SamePlan(DefaultRecordPlan<RecordFieldSets::WEAPON>::plan, CompileRecordPlan(DEFAULT_RECORD_FIELDS, RecordFieldSets::WEAPON));
+        for (int slot = 0; slot < MemoryLayout::AFFIX_SLOT_COUNT; slot++) {
+            ok = ok &&
+                SamePlan(DefaultAffixSlotPlans<RecordFieldSets::AFFIX_ID_LEVEL>::plans[slot],
+                    CompileRecordPlan(DEFAULT_RECORD_FIELDS, AffixSlotFields(slot, RecordFieldSets::AFFIX_ID_LEVEL))) &&
+                SamePlan(DefaultAffixSlotPlans<RecordFieldSets::AFFIX_ALL_PARTS>::plans[slot],
+                    CompileRecordPlan(DEFAULT_RECORD_FIELDS, AffixSlotFields(slot, RecordFieldSets::AFFIX_ALL_PARTS)));
+        }
+        if (!ok) {
+            fprintf(stderr, "compile-time plans differ from runtime plans\n");
+            return false;
+        }
+
+        // 间隔恰好为 MERGE_GAP 时合并，多一个字节时分开
+        RecordFieldTable table = DEFAULT_RECORD_FIELDS;
+        table.fields[RECORD_FIELD_ITEM_ID] = { 0x1000, 2, RecordPlanLayout::NO_BIT, 1, 0 };
+        table.fields[RECORD_FIELD_LEVEL] = { 0x1002 + RecordPlanLayout::MERGE_GAP, 2, RecordPlanLayout::NO_BIT, 1, 0 };
+        table.fields[RECORD_FIELD_QUALITY] = { 0x1004 + 2 * RecordPlanLayout::MERGE_GAP + 1, 4, RecordPlanLayout::NO_BIT, 1, 0 };
+        RecordPlan plan = CompileRecordPlan(table, RecordFieldBit(RECORD_FIELD_ITEM_ID) | RecordFieldBit(RECORD_FIELD_LEVEL) |
+            RecordFieldBit(RECORD_FIELD_QUALITY));
+        if (plan.spanCount != 2 || plan.spans[0].offset != 0x1000 || plan.spans[0].size != RecordPlanLayout::MERGE_GAP + 4 ||
+            plan.bufferOffsets[RECORD_FIELD_QUALITY] != RecordPlanLayout::MERGE_GAP + 4) {
+            fprintf(stderr, "merge gap boundary is wrong\n");
+            return false;
+        }
+        return true;
+    }
+
+    bool CheckRandomLayouts() {
+        std::mt19937_64 random(0x4C41594F);
+        SnapshotMemory memory = MakeHeap(random);
+        std::vector<uint8_t> buffer;
+        for (int round = 0; round < 2000; round++) {
+            RecordFieldTable table = RandomTable(random);
+            uint64_t fields = random() & RecordFieldSets::ALL;
+            if (round % 8 == 0) {
+                fields &= random();     // 稀疏的字段集合
+            }
+            RecordPlan plan = CompileRecordPlan(table, fields);
+            if (!CheckPlanShape(table, fields, plan)) {
+                return false;
+            }
+
+            // 解码
+            QWORD base = HEAP_BASE + random() % (HEAP_SIZE - RANDOM_EXTENT);
+            buffer.assign(plan.bufferSize, 0);
+            if (!ReadRecordPlan(&memory, base, plan, buffer.data())) {
+                fprintf(stderr, "plan read failed\n");
+                return false;
+            }
+            for (int field = 0; field < RECORD_FIELD_COUNT; field++) {
+                const RecordFieldDesc& desc = table.fields[field];
+                if ((fields & RecordFieldBit(field)) != 0 &&
+                    DecodeRecordField(desc, buffer.data() + plan.bufferOffsets[field]) != ReferenceDecode(desc, memory.At(base + desc.offset, desc.size))) {
+                    fprintf(stderr, "field %d decoded incorrectly (round %d)\n", field, round);
+                    return false;
+                }
+            }
+
+            // 编码: 每次只写一个字段 (随机布局中的字段可能重叠)，按区间写回后只有该字段的字节/位变化
+            for (int field = 0; field < RECORD_FIELD_COUNT; field++) {
+                if ((fields & RecordFieldBit(field)) == 0 || random() % 4 != 0) {
+                    continue;
+                }
+                const RecordFieldDesc& desc = table.fields[field];
+                std::vector<uint8_t> before(memory.At(base, RANDOM_EXTENT), memory.At(base, RANDOM_EXTENT) + RANDOM_EXTENT);
+                std::vector<uint8_t> masks(plan.bufferSize, 0);
+                int64_t value = (int64_t)random();
+                EncodeRecordField(desc, value, buffer.data() + plan.bufferOffsets[field], masks.data() + plan.bufferOffsets[field]);
+                uint32_t position = 0;
+                for (uint32_t s = 0; s < plan.spanCount; s++) {
+                    memory.Write(base + plan.spans[s].offset, buffer.data() + position, plan.spans[s].size);
+                    position += plan.spans[s].size;
+                }
+                const uint8_t* after = memory.At(base, RANDOM_EXTENT);
+                for (uint32_t i = 0; i < RANDOM_EXTENT; i++) {
+                    uint8_t allowed = 0;
+                    if (i >= desc.offset && i < desc.offset + desc.size) {
+                        allowed = desc.bit != RecordPlanLayout::NO_BIT ? (uint8_t)(1u << desc.bit) : 0xFF;
+                    }
+                    if (((before[i] ^ after[i]) & ~allowed) != 0) {
+                        fprintf(stderr, "writing field %d changed byte 0x%X\n", field, i);
+                        return false;
+                    }
+                }
+                int64_t expected = desc.bit != RecordPlanLayout::NO_BIT ? (value != 0 ? 1 : 0)
+                    : ReferenceDecode(desc, reinterpret_cast<const uint8_t*>(&value));
+                if (ReferenceDecode(desc, after + desc.offset) != expected) {
+                    fprintf(stderr, "field %d written incorrectly\n", field);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool ExpectRejected(const char* path, const char* text, int expectedLine) {
+        FILE* file = fopen(path, "w");
+        fputs(text, file);
+        fclose(file);
+        RecordLayout layout;
+        int line = -1;
+        if (LoadRecordLayout(path, layout, &line) || line != expectedLine || !layout.IsDefault()) {
+            fprintf(stderr, "layout file accepted or wrong line (%d, expected %d):\n%s\n", line, expectedLine, text);
+            return false;
+        }
+        return true;
+    }
+
+    bool CheckLayoutFile() {
+        const char* path = "layout_bench_check.txt";
+        RecordLayout layout;
+        int line = 0;
+        bool ok = WriteRecordLayout(path, layout) && LoadRecordLayout(path, layout, &line) && layout.IsDefault();
+        if (!ok) {
+            fprintf(stderr, "default layout does not round trip\n");
+        }
+
+        FILE* file = fopen(path, "w");
+        fputs("# 游戏更新后的偏移\nquality 0x34 4\n\naffix_first 0x40  # 槽位整体后移\naffix_stride 0x20\naffix_prefix 0x0C 1\n"
+              "underworld_flag 0x1B 1 2\r\n", file);
+        fclose(file);
+        RecordLayout changed;
+        if (!LoadRecordLayout(path, changed, &line) || changed.IsDefault() ||
+            changed.Get(RECORD_FIELD_QUALITY).offset != 0x34 || changed.Get(RECORD_FIELD_ITEM_ID).offset != 0 ||
+            changed.Get(AffixFieldId(2, AFFIX_PART_LEVEL)).offset != 0x40 + 2 * 0x20 + 4 ||
+            changed.Get(AffixFieldId(6, AFFIX_PART_PREFIX1 + 3)).offset != 0x40 + 6 * 0x20 + 0x0C + 3 ||
+            changed.Get(RECORD_FIELD_UNDERWORLD_FLAG).offset != 0x1B || changed.Get(RECORD_FIELD_UNDERWORLD_FLAG).bit != 2) {
+            fprintf(stderr, "edited layout file decoded incorrectly\n");
+            ok = false;
+        }
+        RecordLayout reloaded;
+        if (!WriteRecordLayout(path, changed) || !LoadRecordLayout(path, reloaded, &line) ||
+            memcmp(&reloaded.GetTable(), &changed.GetTable(), sizeof(RecordFieldTable)) != 0) {
+            fprintf(stderr, "edited layout does not round trip\n");
+            ok = false;
+        }
+
+        ok = ExpectRejected(path, "level 6 2\nitem_idx 0 2\n", 2) && ok;
+        ok = ExpectRejected(path, "quality 0x30 3\n", 1) && ok;
+        ok = ExpectRejected(path, "\nunderworld_flag 0x1A 1 8\n", 2) && ok;
+        ok = ExpectRejected(path, "level 6 2 1\n", 1) && ok;
+        ok = ExpectRejected(path, "underworld_flag 0x1A 2 1\n", 1) && ok;
+        ok = ExpectRejected(path, "affix_prefix 0x08 2\n", 1) && ok;
+        ok = ExpectRejected(path, "affix_stride\n", 1) && ok;
+        ok = ExpectRejected(path, "quality 0x30 4 0 0\n", 1) && ok;
+        ok = ExpectRejected(path, "quality 0x3O 4\n", 1) && ok;
+        ok = ExpectRejected(path, "quality 0xFFFE 4\n", 1) && ok;
+        ok = ExpectRejected(path, "level 6 2\naffix_stride 0\n", 2) && ok;
+        ok = ExpectRejected(path, "affix_stride 0x20\naffix_prefix 0x0C\n\naffix_stride 0x0E\n", 4) && ok;
+        ok = ExpectRejected(path, "affix_first 0xFFF0\n", 1) && ok;
+        ok = ExpectRejected(path, "affix_stride 0x40000000\n", 1) && ok;
+        ok = ExpectRejected(path, "quality 0x30 4\nfamiliarity 0x12 4\nlevel 6\n", 2) && ok;
+        ok = ExpectRejected(path, "affix_first 0x40\nquality 0x48 4\n", 2) && ok;
+        ok = ExpectRejected(path, "quality 0x3A 4\n# 槽位后移\naffix_first 0x3C\n", 3) && ok;
+        remove(path);
+        if (LoadRecordLayout(path, layout, &line) || line != 0) {
+            fprintf(stderr, "missing layout file accepted\n");
+            ok = false;
+        }
+
+        RecordPlanCache cache;
+        const RecordPlan* first = &cache.Get(changed, RecordFieldSets::BASICS);
+        const RecordPlan* second = &cache.Get(changed, RecordFieldSets::BASICS);
+        cache.Get(changed, RecordFieldSets::WEAPON);
+        if (first != second || cache.GetSize() != 2 || !SamePlan(*first, CompileRecordPlan(changed.GetTable(), RecordFieldSets::BASICS))) {
+            fprintf(stderr, "plan cache is inconsistent\n");
+            ok = false;
+        }
+        return ok;
+    }
+
+    // 读出覆盖 gap 的前像之后，模拟游戏改写 gap 处的字节 (只触发一次)
+    class GameWriteMemory : public BorrowedProcessMemory {
+    public:
+        explicit GameWriteMemory(ProcessMemory& inner) : BorrowedProcessMemory(inner), m_inner(inner) {}
+
+        QWORD gap = 0;
+        uint8_t gameValue = 0;
+
+        bool Read(QWORD address, void* buffer, size_t size, size_t* bytesRead = nullptr) override {
+            bool ok = BorrowedProcessMemory::Read(address, buffer, size, bytesRead);
+            if (gap != 0 && address <= gap && gap < address + size) {
+                m_inner.Write(gap, &gameValue, 1);
+                gap = 0;
+            }
+            return ok;
+        }
+
+    private:
+        ProcessMemory& m_inner;
+    };
+
+    // 会话按计划写入时只写字段覆盖的字节，字段之间的字节不按前像写回
+    bool CheckSessionWrites() {
+        SimulatedProcessMemory memory;
+        SimulatedGame::Build(memory);
+        const QWORD record = SimulatedGame::HEAP_BASE + 0x100;
+        const QWORD gap = record + 0x20;    // 熟练度 (0x14) 和地狱武器标志 (0x1A) 之后、品质 (0x30) 之前
+        GameWriteMemory* game = new GameWriteMemory(memory);
+        Session session;
+        if (!session.Attach(std::unique_ptr<ProcessMemory>(game)) || !session.EnableCapture() ||
+            !SimulatedGame::ProduceCapture(memory, SimulatedGame::CaptureRingAddress(memory), record, CaptureRingLayout::SOURCE_WEAPON) ||
+            session.GetWeaponBase() != record) {
+            fprintf(stderr, "session setup failed: %s\n", session.GetLastErrorMessage());
+            return false;
+        }
+
+        game->gap = gap;
+        game->gameValue = 0x5A;
+        bool ok = session.WriteEquipmentBasics(1234, 1235, 160, true, 5, 4, 77, 999, true);
+        uint8_t gapValue = 0;
+        int32_t quality = 0;
+        memory.Read(gap, &gapValue, 1);
+        memory.Read(record + EquipmentLayout::QUALITY_OFFSET, &quality, sizeof(quality));
+        if (!ok || game->gap != 0 || gapValue != 0x5A || quality != 4) {
+            fprintf(stderr, "session write overwrote a byte between fields (gap %02X, quality %d)\n", gapValue, quality);
+            ok = false;
+        }
+        session.Detach();
+        return ok;
+    }
+
+    void RunBench() {
+        std::mt19937_64 random(0x424E4348);
+        SnapshotMemory memory = MakeHeap(random);
+        const uint64_t iterations = 2000000;
+
+        // 计划编译和缓存查找
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations / 10; i++) {
+            g_sink = CompileRecordPlan(DEFAULT_RECORD_FIELDS, (random() & RecordFieldSets::ALL) | 1).spanCount;
+        }
+        printf("compile plan        %8.1f ns\n", Nanoseconds(start, iterations / 10));
+
+        RecordLayout layout;
+        RecordPlanCache cache;
+        const uint64_t masks[] = { RecordFieldSets::BASICS | RecordFieldSets::EXTENDED | RecordFieldSets::WEAPON,
+            RecordFieldSets::BASICS | RecordFieldSets::EXTENDED, AffixSlotFields(3, RecordFieldSets::AFFIX_ALL_PARTS),
+            AffixSlotFields(0, RecordFieldSets::AFFIX_ID_LEVEL) };
+        start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            g_sink = cache.Get(layout, masks[i & 3]).bufferSize;
+        }
+        printf("cached plan lookup  %8.1f ns\n", Nanoseconds(start, iterations));
+
+        // 按计划读出并解码 (快照在本进程内存中，只反映本地开销)
+        struct Shape {
+            const char* name;
+            const RecordPlan* plan;
+            uint32_t perFieldReads;         // 改为计划之前逐字段读取的次数
+        };
+        const Shape shapes[] = {
+            { "ReadEquipmentBasics", &DefaultRecordPlan<RecordFieldSets::BASICS | RecordFieldSets::EXTENDED | RecordFieldSets::WEAPON>::plan, 8 },
+            { "ReadAffixEx", &DefaultAffixSlotPlans<RecordFieldSets::AFFIX_ALL_PARTS>::plans[3], 3 },
+            { "all fields", &DefaultRecordPlan<RecordFieldSets::ALL>::plan, 8 + 3 * MemoryLayout::AFFIX_SLOT_COUNT },
+        };
+        uint8_t buffer[0x1000];
+        for (const Shape& shape : shapes) {
+            start = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < iterations; i++) {
+                QWORD base = HEAP_BASE + (i & 0xFF) * 0x100;
+                ReadRecordPlan(&memory, base, *shape.plan, buffer);
+                int64_t sum = 0;
+                for (int field = 0; field < RECORD_FIELD_COUNT; field++) {
+                    if ((shape.plan->fields & RecordFieldBit(field)) != 0) {
+                        sum += DecodeRecordField(DEFAULT_RECORD_FIELDS.fields[field], buffer + shape.plan->bufferOffsets[field]);
+                    }
+                }
+                g_sink = sum;
+            }
+            printf("%-20s%8.1f ns  %u remote read(s), %u bytes (per-field: %u reads)\n", shape.name, Nanoseconds(start, iterations),
+                shape.plan->spanCount, shape.plan->bufferSize, shape.perFieldReads);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    bool checkOnly = argc == 2 && strcmp(argv[1], "--check") == 0;
+    if (argc > 2 || (argc == 2 && !checkOnly)) {
+        fprintf(stderr, "usage: %s [--check]\n", argv[0]);
+        return 2;
+    }
+    if (!CheckDefaults() || !CheckRandomLayouts() || !CheckLayoutFile() || !CheckSessionWrites()) {
+        fprintf(stderr, "layout checks failed\n");
+        return 1;
+    }
+    if (checkOnly) {
+        printf("ok\n");
+        return 0;
+    }
+    RunBench();
+    return 0;
+}
@@ -0,0 +1,292 @@
+// 代码补丁事务检查 (模拟的游戏进程，不需要游戏进程)
+//
+// 用法:
+//   patch_check [--check]
+//
+// 在模拟的代码区域上提交补丁事务，记录每次写入的地址和长度，并在第 N 次写入或保护属性修改时注入失败；
+// 支持挂起线程的后端给出各线程停下的指令地址。
+// 要求:
+//   每组一次读取、两次保护属性修改，各组修改保护属性的页互不重叠；每个补丁扩展为包含它的对齐 8/16 字节窗口并整体写入一次，放不进时按原范围写入；
+//   提交后代码区域的内容为套用全部补丁的结果，保护属性恢复；
+//   任意一次写入 (包括只写了一半的写入) 或保护属性修改失败时全部回滚: 内容与提交前逐字节相同，保护属性恢复；
+//   期望字节不符或补丁互相重叠时不修改保护属性也不写入；内容已是目标字节时不写入；
+//   后端支持挂起时全部写入都在线程挂起期间，提交后线程恢复；有线程停在被改写的字节中间时不写入并返回失败，停在补丁起点时照常提交；
+//   会话撤下两个 hook 时两个注入点各一次读取、一次写入、两次保护属性修改。
+
+#include "check_tool.h"
+#include "patch_transaction.h"
+#include "session.h"
+#include "simulated_game.h"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+    constexpr QWORD CODE_BASE = 0x180000000ull;
+    constexpr QWORD CODE_SIZE = 0x4000;
+
+    using CheckTool::Expect;
+
+    // 记录写入和改为可写的保护属性修改，在第 failWriteAt 次写入 (只写前一半) 或第 failProtectAt 次保护属性修改时失败
+    // (从 0 开始，-1 表示不失败)；suspendable 时支持挂起线程，挂起的线程停在 threads 中的地址
+    class FaultMemory : public BorrowedProcessMemory {
+    public:
+        explicit FaultMemory(ProcessMemory& inner) : BorrowedProcessMemory(inner) {}
+
+        struct WriteCall {
+            QWORD address;
+            size_t size;
+        };
+        std::vector<WriteCall> writes;
+        std::vector<WriteCall> unprotects;
+        int failWriteAt = -1;
+        int failProtectAt = -1;
+        int protectCount = 0;
+
+        bool suspendable = false;
+        std::vector<QWORD> threads;
+        bool suspended = false;
+        int resumes = 0;
+        int writesWhileRunning = 0;
+
+        bool SuspendThreads(std::vector<QWORD>* outInstructionPointers) override {
+            if (!suspendable) {
+                return false;
+            }
+            if (outInstructionPointers != nullptr) {
+                *outInstructionPointers = threads;
+            }
+            suspended = true;
+            return true;
+        }
+        void ResumeThreads() override {
+            suspended = false;
+            resumes++;
+        }
+
+        bool Write(QWORD address, const void* buffer, size_t size) override {
+            writesWhileRunning += suspendable && !suspended ? 1 : 0;
+            bool fail = (int)writes.size() == failWriteAt;
+            writes.push_back({ address, size });
+            if (fail) {
+                BorrowedProcessMemory::Write(address, buffer, size / 2);
+                return false;
+            }
+            return BorrowedProcessMemory::Write(address, buffer, size);
+        }
+        bool Protect(QWORD address, size_t size, uint32_t newProtect, uint32_t* oldProtect) override {
+            if (protectCount++ == failProtectAt) {
+                return false;
+            }
+            if (newProtect == MemProtect::ExecuteReadWrite) {
+                unprotects.push_back({ address, size });
+            }
+            return BorrowedProcessMemory::Protect(address, size, newProtect, oldProtect);
+        }
+    };
+
+    struct PatchSpec {
+        QWORD offset;
+        size_t size;
+    };
+
+    // 0x1003/5 和 0x1009/2 各放进一个 8 字节窗口；0x101E/5 跨 16 字节边界按原范围写入；
+    // 0x2100/14 放进 16 字节窗口；0x2FFE/4 跨页，0x3010/2 与它共用 0x3000 页，三者同组
+    const PatchSpec PATCHES[] = { { 0x1003, 5 }, { 0x1009, 2 }, { 0x101E, 5 }, { 0x2100, 14 }, { 0x2FFE, 4 }, { 0x3010, 2 } };
+    const PatchSpec WINDOWS[] = { { 0x1000, 8 }, { 0x1008, 8 }, { 0x101E, 5 }, { 0x2100, 16 }, { 0x2FFE, 4 }, { 0x3010, 8 } };
+    constexpr int PATCH_COUNT = sizeof(PATCHES) / sizeof(PATCHES[0]);
+    constexpr uint32_t PAGE_GROUPS = 2;
+
+    struct CodeImage {
+        SimulatedProcessMemory memory;
+        std::vector<uint8_t> original;
+        std::vector<uint8_t> patched;
+
+        CodeImage() : original(CODE_SIZE) {
+            SimulatedGame::AddRegion(memory, CODE_BASE, CODE_SIZE, MemProtect::ExecuteRead, MemType::Image);
+            for (size_t i = 0; i < original.size(); i++) {
+                original[i] = (uint8_t)(i * 7 + 3);
+            }
+            memory.SetBytes(CODE_BASE, original.data(), original.size());
+            patched = original;
+            for (const PatchSpec& patch : PATCHES) {
+                memset(&patched[patch.offset], 0x90, patch.size);
+            }
+        }
+
+        void AddAll(PatchTransaction& transaction) const {
+            for (const PatchSpec& patch : PATCHES) {
+                transaction.Add(CODE_BASE + patch.offset, &patched[patch.offset], &original[patch.offset], patch.size);
+            }
+        }
+
+        bool Equals(const std::vector<uint8_t>& expected) {
+            std::vector<uint8_t> current(CODE_SIZE);
+            return memory.Read(CODE_BASE, current.data(), current.size()) && current == expected;
+        }
+
+        bool IsProtectionRestored() {
+            MemoryRegion region;
+            return memory.Query(CODE_BASE, region) && region.protect == MemProtect::ExecuteRead;
+        }
+    };
+
+    bool CheckCommit() {
+        CodeImage image;
+        FaultMemory memory(image.memory);
+        PatchTransaction transaction(&memory);
+        image.AddAll(transaction);
+        image.memory.ResetOpCounts();
+        bool ok = Expect(transaction.Commit(), "commit");
+        const PatchStats& stats = transaction.GetStats();
+        ok = Expect(stats.reads == PAGE_GROUPS && stats.protects == PAGE_GROUPS * 2 && stats.writes == PATCH_COUNT &&
+            !stats.rolledBack, "stats") && ok;
+        ok = Expect(image.memory.GetOpCount(TraceOp::Read) == PAGE_GROUPS && image.memory.GetOpCount(TraceOp::Protect) == PAGE_GROUPS * 2 &&
+            image.memory.GetOpCount(TraceOp::Write) == PATCH_COUNT, "backend calls differ from the stats") && ok;
+
+        bool windows = memory.writes.size() == PATCH_COUNT;
+        for (size_t i = 0; windows && i < memory.writes.size(); i++) {
+            windows = memory.writes[i].address == CODE_BASE + WINDOWS[i].offset && memory.writes[i].size == WINDOWS[i].size;
+        }
+        ok = Expect(windows, "patches not written as aligned windows") && ok;
+        bool disjoint = memory.unprotects.size() == PAGE_GROUPS;
+        for (size_t i = 1; disjoint && i < memory.unprotects.size(); i++) {
+            const FaultMemory::WriteCall& previous = memory.unprotects[i - 1];
+            QWORD lastPage = (previous.address + previous.size - 1) & ~(QWORD)0xFFF;
+            disjoint = lastPage < (memory.unprotects[i].address & ~(QWORD)0xFFF);
+        }
+        ok = Expect(disjoint, "a page was unprotected by two groups") && ok;
+        ok = Expect(image.Equals(image.patched), "patched bytes") && ok;
+        ok = Expect(image.IsProtectionRestored(), "protection not restored") && ok;
+
+        // 再次提交同样的补丁: 期望字节不符，不写入
+        PatchTransaction again(&memory);
+        image.AddAll(again);
+        image.memory.ResetOpCounts();
+        ok = Expect(!again.Commit() && image.memory.GetOpCount(TraceOp::Write) == 0 &&
+            image.memory.GetOpCount(TraceOp::Protect) == 0, "mismatched expected bytes") && ok;
+
+        // 不校验且已是目标字节: 不写入
+        PatchTransaction same(&memory);
+        for (const PatchSpec& patch : PATCHES) {
+            same.Add(CODE_BASE + patch.offset, &image.patched[patch.offset], nullptr, patch.size);
+        }
+        image.memory.ResetOpCounts();
+        ok = Expect(same.Commit() && image.memory.GetOpCount(TraceOp::Write) == 0 &&
+            image.memory.GetOpCount(TraceOp::Protect) == 0, "unchanged bytes were written") && ok;
+        return CheckTool::Report("commit", ok);
+    }
+
+    bool CheckRollback() {
+        bool ok = true;
+        // 第 N 次写入失败 (失败的写入只写了一半)
+        for (int failAt = 0; failAt < PATCH_COUNT; failAt++) {
+            CodeImage image;
+            FaultMemory memory(image.memory);
+            memory.failWriteAt = failAt;
+            PatchTransaction transaction(&memory);
+            image.AddAll(transaction);
+            ok = Expect(!transaction.Commit() && transaction.GetStats().rolledBack, "failed write did not roll back") && ok;
+            ok = Expect(image.Equals(image.original), "bytes differ after a failed write") && ok;
+            ok = Expect(image.IsProtectionRestored(), "protection not restored after a failed write") && ok;
+        }
+
+        // 保护属性修改失败: 第一页的改动 / 第一页的恢复 / 第二页的改动 (第一页已写入)
+        for (int failAt = 0; failAt < 3; failAt++) {
+            CodeImage image;
+            FaultMemory memory(image.memory);
+            memory.failProtectAt = failAt;
+            PatchTransaction transaction(&memory);
+            image.AddAll(transaction);
+            bool committed = transaction.Commit();
+            // 恢复保护属性失败不影响已经写入的内容
+            bool expected = failAt == 1;
+            ok = Expect(committed == expected, "commit result after a failed protect") && ok;
+            if (!committed) {
+                ok = Expect(transaction.GetStats().rolledBack && image.Equals(image.original), "bytes differ after a failed protect") && ok;
+                ok = Expect(image.IsProtectionRestored(), "protection not restored after a failed protect") && ok;
+            }
+        }
+
+        // 补丁互相重叠
+        {
+            CodeImage image;
+            PatchTransaction transaction(&image.memory);
+            image.AddAll(transaction);
+            transaction.Add(CODE_BASE + 0x1005, &image.patched[0x1005], nullptr, 4);
+            image.memory.ResetOpCounts();
+            ok = Expect(!transaction.Commit() && image.memory.GetOpCount(TraceOp::Write) == 0 &&
+                image.memory.GetOpCount(TraceOp::Protect) == 0 && image.Equals(image.original), "overlapping patches") && ok;
+        }
+        return CheckTool::Report("rollback", ok);
+    }
+
+    bool CheckSuspend() {
+        bool ok = true;
+        // 一个线程停在补丁起点，一个在补丁之外
+        {
+            CodeImage image;
+            FaultMemory memory(image.memory);
+            memory.suspendable = true;
+            memory.threads = { CODE_BASE + 0x1003, CODE_BASE + 0x2000 };
+            PatchTransaction transaction(&memory);
+            image.AddAll(transaction);
+            ok = Expect(transaction.Commit() && transaction.GetStats().threadsSuspended, "commit with suspended threads") && ok;
+            ok = Expect(memory.writes.size() == PATCH_COUNT && memory.writesWhileRunning == 0, "written while threads were running") && ok;
+            ok = Expect(!memory.suspended && memory.resumes == 1, "threads not resumed") && ok;
+            ok = Expect(image.Equals(image.patched), "patched bytes with suspended threads") && ok;
+        }
+
+        // 线程停在 0x1003/5 的中间
+        {
+            CodeImage image;
+            FaultMemory memory(image.memory);
+            memory.suspendable = true;
+            memory.threads = { CODE_BASE + 0x2000, CODE_BASE + 0x1005 };
+            PatchTransaction transaction(&memory);
+            image.AddAll(transaction);
+            image.memory.ResetOpCounts();
+            ok = Expect(!transaction.Commit() && transaction.GetStats().threadBlocked, "thread inside a patch not reported") && ok;
+            ok = Expect(image.memory.GetOpCount(TraceOp::Write) == 0 && image.memory.GetOpCount(TraceOp::Protect) == 0 &&
+                image.Equals(image.original), "written with a thread inside a patch") && ok;
+            ok = Expect(!memory.suspended && memory.resumes == 1, "threads not resumed after a blocked commit") && ok;
+
+            // 内容已是目标字节时不需要挂起
+            PatchTransaction same(&memory);
+            for (const PatchSpec& patch : PATCHES) {
+                same.Add(CODE_BASE + patch.offset, &image.original[patch.offset], nullptr, patch.size);
+            }
+            ok = Expect(same.Commit() && !same.GetStats().threadsSuspended, "suspended for unchanged bytes") && ok;
+        }
+        return CheckTool::Report("suspend", ok);
+    }
+
+    // 会话撤下 hook 时每个注入点一次读取、一次写入
+    bool CheckSession() {
+        SimulatedProcessMemory memory;
+        SimulatedGame::Build(memory);
+        Session session;
+        bool ok = Expect(session.Attach(std::unique_ptr<ProcessMemory>(new BorrowedProcessMemory(memory))) && session.EnableCapture(),
+            "attach and enable");
+        if (!ok) {
+            return false;
+        }
+
+        memory.ResetOpCounts();
+        session.DisableCapture();
+        uint64_t reads = memory.GetOpCount(TraceOp::Read);
+        uint64_t writes = memory.GetOpCount(TraceOp::Write);
+        uint64_t protects = memory.GetOpCount(TraceOp::Protect);
+        ok = Expect(reads == 2 && writes == 2 && protects == 4, "disable capture calls") && ok;
+        ok = Expect(SimulatedGame::Matches(memory, SimulatedGame::WEAPON_SITE, SimulatedGame::WEAPON_BYTES, sizeof(SimulatedGame::WEAPON_BYTES)) &&
+            SimulatedGame::Matches(memory, SimulatedGame::ARMOR_SITE, SimulatedGame::ARMOR_BYTES, sizeof(SimulatedGame::ARMOR_BYTES)),
+            "sites not restored") && ok;
+        return CheckTool::Report("session", ok, "disable: %llu reads, %llu writes, %llu protects",
+            (unsigned long long)reads, (unsigned long long)writes, (unsigned long long)protects);
+    }
+}
+
+int main(int argc, char** argv) {
+    return CheckTool::Run(argc, argv, "patch", { CheckCommit, CheckRollback, CheckSuspend, CheckSession });
+}
@@ -0,0 +1,343 @@
+// 指针路径扫描基准 (合成快照)
+//
+// 用法:
+//   pointer_bench [--heap-mb N] [--threads N] [--depth N] [--offset N]
+//   pointer_bench --check                 只用小快照检查正确性
+//
+// 在本进程内存中生成两份合成的目标进程快照，模拟同一游戏的两次启动:
+//   - 主模块 (可读写的 .data 段中有若干静态指针) + 若干 16MB 堆区域，每次启动的堆基址不同
+//   - 堆中约 1/8 的 qword 是指向随机堆对象的指针，其余为随机数据
+//   - 两条结构固定的指针链从 .data 指向 "装备记录"，其余静态指针每次启动都不同
+// 对每份快照建表、搜索 (单线程和多线程各一次，结果必须相同)，写结果文件后求交集，
+// 检查两条固定的链都留在交集中、可按路径重新定位，并报告建表/搜索耗时和反向指针表占用。
+// 另检查损坏的结果文件 (条数多于文件中实际存放的、文件头或路径的深度超出 MAX_DEPTH) 读取和求交集都失败。
+
+#include "pointer_scan.h"
+#include "snapshot_memory.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr QWORD MODULE_BASE = 0x140000000ull;
+    constexpr QWORD MODULE_SIZE = 0x400000;
+    constexpr QWORD DATA_OFFSET = 0x200000;         // .data 段 (可读写)
+    constexpr QWORD DATA_SIZE = 0x100000;
+    constexpr QWORD HEAP_REGION_SIZE = 0x1000000;
+    constexpr uint32_t OBJECT_ALIGN = 0x40;
+
+    // 固定的链: .data 中的槽位 -> 各级偏移 (最后一级为装备记录在对象中的偏移)
+    struct PlantedChain {
+        uint32_t moduleOffset;
+        uint32_t depth;
+        uint32_t offsets[PointerScanLayout::MAX_DEPTH];
+    };
+
+    const PlantedChain CHAINS[] = {
+        { (uint32_t)DATA_OFFSET + 0x1040, 3, { 0x30, 0x1A8, 0x58 } },
+        { (uint32_t)DATA_OFFSET + 0x2318, 2, { 0x2F0, 0x10 } }
+    };
+
+    struct Snapshot {
+        SnapshotMemory memory;
+        QWORD targets[sizeof(CHAINS) / sizeof(CHAINS[0])];
+    };
+
+    // seed 决定堆基址和全部随机内容；链的结构 (槽位和偏移) 每次都相同
+    void Generate(Snapshot& snapshot, uint64_t seed, uint32_t heapMb) {
+        std::mt19937_64 random(seed);
+        SnapshotMemory& memory = snapshot.memory;
+        memory.regions.clear();
+        memory.moduleBase = MODULE_BASE;
+        memory.moduleSize = MODULE_SIZE;
+
+        memory.regions.push_back({ MODULE_BASE, MemProtect::ExecuteRead, MemType::Image, std::vector<uint8_t>(DATA_OFFSET) });
+        memory.regions.push_back({ MODULE_BASE + DATA_OFFSET, MemProtect::ReadWrite, MemType::Image, std::vector<uint8_t>(DATA_SIZE) });
+        memory.regions.push_back({ MODULE_BASE + DATA_OFFSET + DATA_SIZE, MemProtect::ReadOnly, MemType::Image,
+            std::vector<uint8_t>(MODULE_SIZE - DATA_OFFSET - DATA_SIZE) });
+
+        uint32_t heapRegions = std::max(1u, heapMb * 0x100000 / (uint32_t)HEAP_REGION_SIZE);
+        QWORD heapBase = 0x20000000000ull + (random() % 0x100) * 0x100000000ull;
+        std::vector<QWORD> heaps;
+        for (uint32_t i = 0; i < heapRegions; i++) {
+            heaps.push_back(heapBase);
+            memory.regions.push_back({ heapBase, MemProtect::ReadWrite, MemType::Private, std::vector<uint8_t>(HEAP_REGION_SIZE) });
+            heapBase += HEAP_REGION_SIZE + (1 + random() % 16) * 0x10000;
+        }
+
+        auto randomObject = [&]() {
+            return heaps[random() % heaps.size()] + (random() % (HEAP_REGION_SIZE / OBJECT_ALIGN)) * OBJECT_ALIGN;
+        };
+
+        for (QWORD heap : heaps) {
+            uint64_t* words = (uint64_t*)memory.At(heap, HEAP_REGION_SIZE);
+            for (size_t i = 0; i < HEAP_REGION_SIZE / sizeof(uint64_t); i++) {
+                uint64_t r = random();
+                words[i] = (r & 7) == 0 ? randomObject() + ((r >> 8) % 8) * 8 : (r >> 3) & 0xFFFFFFFF;
+            }
+        }
+        uint64_t* statics = (uint64_t*)memory.At(MODULE_BASE + DATA_OFFSET, DATA_SIZE);
+        for (size_t i = 0; i < DATA_SIZE / sizeof(uint64_t); i++) {
+            uint64_t r = random();
+            statics[i] = (r & 15) == 0 ? randomObject() : 0;
+        }
+
+        // 链上的每个对象放在随机位置，只有槽位和偏移固定
+        for (size_t c = 0; c < sizeof(CHAINS) / sizeof(CHAINS[0]); c++) {
+            const PlantedChain& chain = CHAINS[c];
+            QWORD slot = MODULE_BASE + chain.moduleOffset;
+            for (uint32_t level = 0; level + 1 < chain.depth; level++) {
+                QWORD object = randomObject();
+                memory.Put(slot, object);
+                slot = object + chain.offsets[level];
+            }
+            QWORD record = randomObject();
+            memory.Put(slot, record);
+            snapshot.targets[c] = record + chain.offsets[chain.depth - 1];
+        }
+    }
+
+    bool Matches(const PointerPath& path, const PlantedChain& chain) {
+        return path.moduleOffset == chain.moduleOffset && path.depth == chain.depth &&
+            std::equal(chain.offsets, chain.offsets + chain.depth, path.offsets);
+    }
+
+    bool Contains(const std::vector<PointerPath>& paths, const PlantedChain& chain) {
+        return std::any_of(paths.begin(), paths.end(), [&](const PointerPath& path) { return Matches(path, chain); });
+    }
+
+    struct Options {
+        uint32_t heapMb = 256;
+        uint32_t threads = 0;
+        uint32_t depth = 4;
+        uint32_t offset = 0x400;
+        bool checkOnly = false;
+    };
+
+    PointerScanConfig MakeConfig(const Options& options, uint32_t threads) {
+        PointerScanConfig config;
+        memset(&config, 0, sizeof(config));
+        config.maxDepth = options.depth;
+        config.maxOffset = options.offset;
+        config.maxResults = 1000000;
+        config.threads = threads;
+        return config;
+    }
+
+    void PrintRow(const char* name, const PointerScanStats& stats) {
+        printf("%-12s %8u %10.1f %10.1f %12llu %10.1f %12llu %9u%s\n", name, stats.threads,
+            stats.buildMicroseconds / 1000.0, stats.searchMicroseconds / 1000.0,
+            (unsigned long long)stats.pointers, stats.mapBytes / 1048576.0,
+            (unsigned long long)stats.nodes, stats.results, stats.truncated ? " (truncated)" : "");
+    }
+
+    // 扫描一份快照: 单线程和多线程各一次，比较结果并写出结果文件
+    bool ScanSnapshot(Snapshot& snapshot, const Options& options, uint32_t threads, size_t targetIndex,
+        const char* outputPath, std::vector<PointerPath>& outPaths) {
+        std::vector<PointerPath> reference;
+        for (uint32_t run = 0; run < (threads > 1 ? 2u : 1u); run++) {
+            uint32_t runThreads = run == 0 ? 1 : threads;
+            PointerScanConfig config = MakeConfig(options, runThreads);
+            PointerScanStats stats;
+            memset(&stats, 0, sizeof(stats));
+
+            PointerMap map;
+            if (!map.Build(&snapshot.memory, config, stats)) {
+                fprintf(stderr, "build failed\n");
+                return false;
+            }
+            std::vector<PointerPath> paths;
+            map.Search(snapshot.targets[targetIndex], config, paths, stats);
+            PrintRow(run == 0 ? "single" : "parallel", stats);
+
+            if (run == 0) {
+                reference = paths;
+            } else if (paths != reference) {
+                fprintf(stderr, "parallel search returned different paths (%zu vs %zu)\n", paths.size(), reference.size());
+                return false;
+            }
+        }
+
+        outPaths = reference;
+        if (!WritePointerPathFile(outputPath, MODULE_SIZE, NormalizePointerScanConfig(MakeConfig(options, threads)), outPaths)) {
+            fprintf(stderr, "failed to write %s\n", outputPath);
+            return false;
+        }
+        return true;
+    }
+
+    bool WriteBytes(const char* path, const std::vector<uint8_t>& bytes) {
+        FILE* file = fopen(path, "wb");
+        bool ok = file != nullptr && fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        return file != nullptr && fclose(file) == 0 && ok;
+    }
+
+    // 损坏的结果文件: 读取和求交集都失败，不能按文件头中的条数分配内存或越界比较路径
+    bool CheckCorruptFiles() {
+        const char* files[3] = { "pointer_bench_valid.n3pp", "pointer_bench_corrupt.n3pp", "pointer_bench_out.n3pp" };
+        std::vector<PointerPath> paths(3);
+        for (size_t i = 0; i < paths.size(); i++) {
+            paths[i] = PointerPath{};
+            paths[i].moduleOffset = (uint32_t)(0x100 + i * 8);
+            paths[i].depth = 2;
+            paths[i].offsets[0] = 0x10;
+            paths[i].offsets[1] = 0x20;
+        }
+        PointerScanConfig config = NormalizePointerScanConfig(PointerScanConfig{});
+        PointerPathFileHeader header;
+        std::vector<PointerPath> read;
+        uint64_t count = 0;
+        bool ok = WritePointerPathFile(files[0], MODULE_SIZE, config, paths) && ReadPointerPathFile(files[0], header, read) &&
+            read == paths && IntersectPointerPathFiles(files[0], files[0], files[2], count) && count == paths.size();
+        if (!ok) {
+            fprintf(stderr, "valid result file rejected\n");
+        }
+
+        std::vector<uint8_t> valid(sizeof(PointerPathFileHeader) + paths.size() * sizeof(PointerPath));
+        FILE* file = fopen(files[0], "rb");
+        ok = file != nullptr && fread(valid.data(), 1, valid.size(), file) == valid.size() && ok;
+        if (file != nullptr) {
+            fclose(file);
+        }
+
+        const uint64_t hugeCount = 1ull << 40;
+        const uint32_t badDepth = PointerScanLayout::MAX_DEPTH + 1;
+        const struct {
+            const char* name;
+            size_t offset;
+            const void* value;
+            size_t size;
+        } corruptions[] = {
+            { "count beyond the file", offsetof(PointerPathFileHeader, count), &hugeCount, sizeof(hugeCount) },
+            { "header depth", offsetof(PointerPathFileHeader, maxDepth), &badDepth, sizeof(badDepth) },
+            { "path depth", sizeof(PointerPathFileHeader) + sizeof(PointerPath) + offsetof(PointerPath, depth), &badDepth, sizeof(uint16_t) },
+        };
+        for (const auto& corruption : corruptions) {
+            std::vector<uint8_t> bytes = valid;
+            memcpy(bytes.data() + corruption.offset, corruption.value, corruption.size);
+            if (!WriteBytes(files[1], bytes) || ReadPointerPathFile(files[1], header, read) || !read.empty() ||
+                IntersectPointerPathFiles(files[0], files[1], files[2], count) ||
+                IntersectPointerPathFiles(files[1], files[0], files[2], count)) {
+                fprintf(stderr, "corrupt result file accepted: %s\n", corruption.name);
+                ok = false;
+            }
+        }
+
+        for (const char* path : files) {
+            remove(path);
+        }
+        return ok;
+    }
+
+    bool Run(const Options& options) {
+        const uint32_t threads = options.threads != 0 ? options.threads : std::max(2u, std::thread::hardware_concurrency());
+        const char* files[3] = { "pointer_bench_1.n3pp", "pointer_bench_2.n3pp", "pointer_bench_stable.n3pp" };
+        bool ok = true;
+
+        printf("heap %u MB, depth %u, max offset 0x%X, %u threads\n\n", options.heapMb, options.depth, options.offset, threads);
+        printf("%-12s %8s %10s %10s %12s %10s %12s %9s\n", "run", "threads", "build ms", "search ms", "pointers", "map MB", "nodes", "results");
+
+        for (size_t c = 0; c < sizeof(CHAINS) / sizeof(CHAINS[0]) && ok; c++) {
+            std::vector<PointerPath> paths[2];
+            Snapshot* snapshots[2] = { new Snapshot(), new Snapshot() };
+            for (int launch = 0; launch < 2 && ok; launch++) {
+                Generate(*snapshots[launch], 0x1234 + launch * 0x1000 + c, options.heapMb);
+                printf("chain %zu, launch %d\n", c, launch + 1);
+                ok = ScanSnapshot(*snapshots[launch], options, threads, c, files[launch], paths[launch]);
+                if (ok && !Contains(paths[launch], CHAINS[c])) {
+                    fprintf(stderr, "planted chain %zu not found in launch %d\n", c, launch + 1);
+                    ok = false;
+                }
+            }
+
+            uint64_t stable = 0;
+            if (ok && !IntersectPointerPathFiles(files[0], files[1], files[2], stable)) {
+                fprintf(stderr, "intersection failed\n");
+                ok = false;
+            }
+
+            PointerPathFileHeader header;
+            std::vector<PointerPath> kept;
+            if (ok && (!ReadPointerPathFile(files[2], header, kept) || kept.size() != stable || !Contains(kept, CHAINS[c]))) {
+                fprintf(stderr, "planted chain %zu lost in the intersection\n", c);
+                ok = false;
+            }
+
+            // 交集中的每条路径都应在第二次启动中解析到目标
+            for (const PointerPath& path : kept) {
+                QWORD address = 0;
+                if (!ResolvePointerPath(&snapshots[1]->memory, MODULE_BASE, path, address) || address != snapshots[1]->targets[c]) {
+                    fprintf(stderr, "stable path does not resolve in launch 2\n");
+                    ok = false;
+                    break;
+                }
+            }
+            if (ok) {
+                printf("stable paths: %zu + %zu -> %llu\n\n", paths[0].size(), paths[1].size(), (unsigned long long)stable);
+            }
+
+            // 内存上限: 反向指针表放不下时建表失败
+            if (ok && c == 0) {
+                PointerScanConfig config = MakeConfig(options, threads);
+                config.maxMapBytes = 0x10000;
+                PointerScanStats stats;
+                memset(&stats, 0, sizeof(stats));
+                PointerMap map;
+                if (map.Build(&snapshots[0]->memory, config, stats) || !stats.truncated || map.GetCount() != 0) {
+                    fprintf(stderr, "memory limit was not enforced\n");
+                    ok = false;
+                }
+            }
+
+            delete snapshots[0];
+            delete snapshots[1];
+        }
+
+        for (const char* file : files) {
+            remove(file);
+        }
+        return ok;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--check") == 0) {
+            options.checkOnly = true;
+        } else if (strcmp(argv[i], "--heap-mb") == 0 && hasValue) {
+            options.heapMb = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "--depth") == 0 && hasValue) {
+            options.depth = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "--offset") == 0 && hasValue) {
+            options.offset = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        } else {
+            fprintf(stderr, "usage: %s [--check] [--heap-mb N] [--threads N] [--depth N] [--offset N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (options.checkOnly) {
+        options.heapMb = 32;
+        options.threads = options.threads != 0 ? options.threads : 4;
+    }
+    if (options.depth == 0 || options.depth > PointerScanLayout::MAX_DEPTH || options.heapMb == 0) {
+        fprintf(stderr, "invalid options\n");
+        return 2;
+    }
+
+    if (!CheckCorruptFiles() || !Run(options)) {
+        fprintf(stderr, "pointer scan checks failed\n");
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,524 @@
+// 预设批量应用: 正确性检查和吞吐
+//
+// 用法:
+//   preset_bench [--items N] [--latency-ns N]   对背包数组 (相邻装备) 和分散的装备计时，对比逐槽位写入
+//   preset_bench --check                        只检查正确性
+//
+// 目标进程用 SimulatedProcessMemory 模拟，--latency-ns 为每次读写加上忙等延迟 (近似跨进程调用的开销)。
+// 逐槽位写入模拟以前的做法: 每件装备先写基础属性，再对每个槽位调用一次 WriteAffixExMasked (各一次读 + 一次写)。
+//
+// --check 要求:
+//   随机的初始内容、预设 (含地狱武器标志位) 和布局 (内置布局以及字段相距很远、计划有多个区间的布局) 下，
+//   批量应用后的内存与逐槽位写入的结果逐字节相同；
+//   背包数组中的装备只需 1 次读 + 每个脏区间 1 次写 + 1 次读回，只写变化了的字节 (读出之后游戏改写的
+//   间隔字节保持不变)，再次应用时全部为 UNCHANGED 且不写入；
+//   重复的基址结果相同，记录重叠时不访问内存；合并读取失败时逐个区间重读，读不到的装备为 READ_FAILED，
+//   写入失败为 WRITE_FAILED，写入没有生效为 VERIFY_FAILED，其余装备不受影响；整体状态为输入顺序中第一件失败装备的原因；
+//   会话按整体状态给出不同的错误信息，部分装备失败时仍返回每件装备的结果；
+//   把返回的改写的前像写回后内存恢复原状。
+
+#include "preset_apply.h"
+#include "session.h"
+#include "simulated_game.h"
+#include "simulated_process_memory.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr QWORD HEAP_BASE = 0x200000000ull;
+    constexpr uint32_t INVENTORY_STRIDE = 0x1A0;    // 背包数组中的装备间隔
+    constexpr uint32_t SCATTER_STRIDE = 0x1000;     // 分散的装备间隔 (每件单独读写)
+
+    // 按地址区间让读写失败或写入不生效的后端装饰器 (读取失败时不填充缓冲)
+    class FaultyMemory : public ProcessMemory {
+    public:
+        explicit FaultyMemory(ProcessMemory* inner) : m_inner(inner) {}
+
+        QWORD readFailStart = 0, readFailEnd = 0;   // 与该区间相交的读取返回失败
+        QWORD failStart = 0, failEnd = 0;       // 与该区间相交的写入返回失败
+        QWORD dropStart = 0, dropEnd = 0;       // 与该区间相交的写入返回成功但不写入
+        QWORD raceAddress = 0;                  // 非 0 时在第一次写入之前把该字节改为 raceValue (模拟游戏同时写入)
+        uint8_t raceValue = 0;
+
+        bool Read(QWORD address, void* buffer, size_t size, size_t* bytesRead) override {
+            if (address < readFailEnd && address + size > readFailStart) {
+                return false;
+            }
+            return m_inner->Read(address, buffer, size, bytesRead);
+        }
+        bool Write(QWORD address, const void* buffer, size_t size) override {
+            if (raceAddress != 0) {
+                m_inner->Write(raceAddress, &raceValue, 1);
+                raceAddress = 0;
+            }
+            if (address < failEnd && address + size > failStart) {
+                return false;
+            }
+            if (address < dropEnd && address + size > dropStart) {
+                return true;
+            }
+            return m_inner->Write(address, buffer, size);
+        }
+        bool Query(QWORD address, MemoryRegion& outRegion) override { return m_inner->Query(address, outRegion); }
+        bool Protect(QWORD address, size_t size, uint32_t newProtect, uint32_t* oldProtect) override {
+            return m_inner->Protect(address, size, newProtect, oldProtect);
+        }
+        QWORD Allocate(QWORD preferredAddress, size_t size, uint32_t protect) override {
+            return m_inner->Allocate(preferredAddress, size, protect);
+        }
+        bool Free(QWORD address) override { return m_inner->Free(address); }
+        bool GetMainModule(QWORD& baseAddress, QWORD& moduleSize) override { return m_inner->GetMainModule(baseAddress, moduleSize); }
+
+    private:
+        ProcessMemory* m_inner;
+    };
+
+    void MakeHeap(SimulatedProcessMemory& memory, size_t size, uint64_t seed) {
+        MemoryRegion region;
+        region.baseAddress = HEAP_BASE;
+        region.regionSize = size;
+        region.state = MemState::Commit;
+        region.protect = MemProtect::ReadWrite;
+        region.type = MemType::Private;
+        memory.AddRegion(region);
+
+        std::mt19937_64 random(seed);
+        std::vector<uint8_t> bytes(size);
+        for (uint8_t& byte : bytes) {
+            byte = (uint8_t)random();
+        }
+        memory.SetBytes(HEAP_BASE, bytes.data(), bytes.size());
+    }
+
+    std::vector<uint8_t> ReadHeap(ProcessMemory& memory, size_t size) {
+        std::vector<uint8_t> bytes(size);
+        memory.Read(HEAP_BASE, bytes.data(), bytes.size());
+        return bytes;
+    }
+
+    uint64_t ReadOps(const SimulatedProcessMemory& memory) { return memory.GetOpCount(TraceOp::Read); }
+    uint64_t WriteOps(const SimulatedProcessMemory& memory) { return memory.GetOpCount(TraceOp::Write); }
+
+    AffixPreset RandomPreset(std::mt19937_64& random, bool allFields) {
+        AffixPreset preset{};
+        for (AffixPresetSlot& slot : preset.slots) {
+            slot.id = (int32_t)(random() % 2000) - 1;
+            slot.level = (int32_t)(random() % 100);
+            for (uint8_t& prefix : slot.prefixes) {
+                prefix = (uint8_t)random();
+            }
+            slot.fieldMask = allFields ? (uint32_t)RecordFieldSets::AFFIX_ALL_PARTS : (uint32_t)(random() & 0x3F);
+        }
+        for (int32_t& value : preset.basics) {
+            value = (int32_t)(random() % 0x10000) - 0x100;
+        }
+        preset.basicsMask = allFields ? (1u << RECORD_FIELD_AFFIX_FIRST) - 1 : (uint32_t)(random() & 0xFF);
+        return preset;
+    }
+
+    // 以前的做法: 基础属性一次，每个槽位一次，各自读出、编码、只写回首尾变化字节之间的部分
+    void ApplyWrites(ProcessMemory* memory, const RecordFieldTable& table, const RecordPlan& plan, QWORD base,
+        const RecordWrite* writes, size_t count) {
+        if (count == 0) {
+            return;
+        }
+        std::vector<uint8_t> before(plan.bufferSize);
+        if (!ReadRecordPlan(memory, base, plan, before.data())) {
+            return;
+        }
+        std::vector<uint8_t> after(before);
+        std::vector<uint8_t> masks(after.size());
+        for (size_t i = 0; i < count; i++) {
+            uint32_t position = plan.bufferOffsets[writes[i].field];
+            EncodeRecordField(table.fields[writes[i].field], writes[i].value, &after[position], &masks[position]);
+        }
+        size_t spanStart = 0;
+        for (uint32_t s = 0; s < plan.spanCount; s++) {
+            size_t first = spanStart;
+            size_t last = spanStart + plan.spans[s].size;
+            spanStart = last;
+            while (first < last && before[first] == after[first]) first++;
+            while (last > first && before[last - 1] == after[last - 1]) last--;
+            if (first < last) {
+                memory->Write(base + plan.spans[s].offset + (first - (spanStart - plan.spans[s].size)), &after[first], last - first);
+            }
+        }
+    }
+
+    void ApplyPerSlot(ProcessMemory* memory, const RecordFieldTable& table, const AffixPreset& preset, QWORD base) {
+        RecordWrite writes[RECORD_FIELD_COUNT];
+        size_t count = 0;
+        for (int field = 0; field < RECORD_FIELD_AFFIX_FIRST; field++) {
+            if ((preset.basicsMask & (1u << field)) != 0) {
+                writes[count++] = { field, preset.basics[field] };
+            }
+        }
+        ApplyWrites(memory, table, CompileRecordPlan(table, preset.basicsMask & 0xFF), base, writes, count);
+
+        for (int slot = 0; slot < MemoryLayout::AFFIX_SLOT_COUNT; slot++) {
+            AffixPreset single{};
+            single.slots[slot] = preset.slots[slot];
+            count = GetPresetWrites(single, writes);
+            ApplyWrites(memory, table, CompileRecordPlan(table, GetPresetFields(single)), base, writes, count);
+        }
+    }
+
+    struct Applied {
+        PresetApplyStatus status;
+        bool ok;
+        std::vector<int32_t> results;
+        std::vector<PresetItemEdit> edits;
+        std::vector<uint8_t> editBytes;
+        PresetApplyStats stats;
+    };
+
+    Applied Apply(ProcessMemory* memory, const RecordFieldTable& table, const AffixPreset& preset, const std::vector<QWORD>& bases) {
+        Applied applied;
+        RecordPlan plan = CompileRecordPlan(table, GetPresetFields(preset));
+        applied.status = ApplyPresetToRecords(memory, table, plan, preset, bases.data(), bases.size(), applied.results,
+            applied.edits, applied.editBytes, applied.stats);
+        applied.ok = applied.status == PRESET_APPLY_OK;
+        return applied;
+    }
+
+    std::vector<QWORD> MakeBases(size_t count, uint32_t stride, QWORD first = HEAP_BASE + 0x40) {
+        std::vector<QWORD> bases(count);
+        for (size_t i = 0; i < count; i++) {
+            bases[i] = first + i * stride;
+        }
+        return bases;
+    }
+
+    bool Fail(const char* message) {
+        fprintf(stderr, "%s\n", message);
+        return false;
+    }
+
+    // 批量应用与逐槽位写入的结果逐字节相同
+    bool CheckAgainstPerSlot() {
+        std::mt19937_64 random(0x50524553);
+        const size_t heapSize = 0x40000;
+        for (int round = 0; round < 200; round++) {
+            RecordFieldTable table = DEFAULT_RECORD_FIELDS;
+            if (round % 2 == 1) {
+                // 字段相距很远的布局: 计划有多个区间，各件装备的区间交错时记录仍然不能重叠
+                table.fields[RECORD_FIELD_QUALITY].offset = 0x300 + (uint32_t)(random() % 0x40) * 4;
+                table.fields[RECORD_FIELD_FAMILIARITY].offset = 0x500;
+                table.fields[RECORD_FIELD_UNDERWORLD_FLAG].bit = (uint8_t)(random() % 8);
+            }
+            const uint32_t stride = round % 4 < 2 ? (round % 2 == 1 ? 0x600 : INVENTORY_STRIDE) : SCATTER_STRIDE;
+            const size_t count = 1 + random() % 40;
+
+            SimulatedProcessMemory bulk, reference;
+            uint64_t seed = random();
+            MakeHeap(bulk, heapSize, seed);
+            MakeHeap(reference, heapSize, seed);
+            AffixPreset preset = RandomPreset(random, round % 5 == 0);
+            std::vector<QWORD> bases = MakeBases(count, stride);
+            std::shuffle(bases.begin(), bases.end(), random);
+
+            std::vector<uint8_t> original = ReadHeap(bulk, heapSize);
+            Applied applied = Apply(&bulk, table, preset, bases);
+            for (QWORD base : bases) {
+                ApplyPerSlot(&reference, table, preset, base);
+            }
+            if (!applied.ok || ReadHeap(bulk, heapSize) != ReadHeap(reference, heapSize)) {
+                fprintf(stderr, "round %d: bulk apply differs from per-slot writes\n", round);
+                return false;
+            }
+            for (int32_t result : applied.results) {
+                if (result != PRESET_ITEM_APPLIED && result != PRESET_ITEM_UNCHANGED) {
+                    fprintf(stderr, "round %d: unexpected result %d\n", round, result);
+                    return false;
+                }
+            }
+
+            // 前像写回后恢复原状
+            for (size_t i = applied.edits.size(); i-- > 0;) {
+                const PresetItemEdit& edit = applied.edits[i];
+                bulk.Write(edit.base + edit.offset, applied.editBytes.data() + edit.position, edit.size);
+            }
+            if (ReadHeap(bulk, heapSize) != original) {
+                fprintf(stderr, "round %d: edits do not restore the original bytes\n", round);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool CheckBatching() {
+        std::mt19937_64 random(0x42415443);
+        SimulatedProcessMemory memory;
+        MakeHeap(memory, 0x200000, 1);
+        AffixPreset preset = RandomPreset(random, true);
+
+        // 背包数组: 1 次读 + 每个脏区间 1 次写 + 1 次读回
+        std::vector<QWORD> bases = MakeBases(64, INVENTORY_STRIDE);
+        memory.ResetOpCounts();
+        Applied applied = Apply(&memory, DEFAULT_RECORD_FIELDS, preset, bases);
+        if (!applied.ok || applied.stats.applied != 64 || ReadOps(memory) != 2 || applied.stats.reads != 2 ||
+            WriteOps(memory) != applied.stats.writes || applied.stats.writes != applied.edits.size() || applied.edits.size() < 64) {
+            return Fail("inventory array is not read in one batch and written per dirty range");
+        }
+        memory.ResetOpCounts();
+        applied = Apply(&memory, DEFAULT_RECORD_FIELDS, preset, bases);
+        if (!applied.ok || applied.stats.unchanged != 64 || ReadOps(memory) != 1 || WriteOps(memory) != 0 || !applied.edits.empty()) {
+            return Fail("re-applying the preset writes again");
+        }
+
+        // 只有一个字段变化时每件只写该字段的字节 (相距超过 MERGE_GAP，各自一次写入)
+        AffixPreset levelOnly{};
+        levelOnly.slots[3] = preset.slots[3];
+        levelOnly.slots[3].level ^= 0x01010101;
+        applied = Apply(&memory, DEFAULT_RECORD_FIELDS, levelOnly, bases);
+        if (!applied.ok || applied.stats.applied != 64 || applied.stats.writes != 64 || applied.stats.bytesWritten != 64 * 4) {
+            return Fail("writes are not trimmed to the changed bytes");
+        }
+
+        // 读出之后游戏改写了两件装备之间的字节: 只写脏区间，该字节保持游戏写入的值
+        const uint32_t recordEnd = DEFAULT_RECORD_FIELDS.fields[RECORD_FIELD_COUNT - 1].offset + 1;
+        static_assert(DEFAULT_RECORD_FIELDS.fields[RECORD_FIELD_COUNT - 1].offset + 1 < INVENTORY_STRIDE, "no gap between records");
+        FaultyMemory racing(&memory);
+        racing.raceAddress = bases[0] + recordEnd;
+        uint8_t gap = 0;
+        memory.Read(racing.raceAddress, &gap, 1);
+        racing.raceValue = (uint8_t)~gap;
+        applied = Apply(&racing, DEFAULT_RECORD_FIELDS, RandomPreset(random, true), bases);
+        uint8_t raced = 0;
+        memory.Read(bases[0] + recordEnd, &raced, 1);
+        if (!applied.ok || applied.stats.applied != 64 || raced != (uint8_t)~gap) {
+            return Fail("bytes between dirty ranges are written back");
+        }
+
+        // 分散的装备: 每件一次读 + 一次写 + 一次读回
+        preset = RandomPreset(random, true);
+        bases = MakeBases(32, SCATTER_STRIDE, HEAP_BASE + 0x10000);
+        memory.ResetOpCounts();
+        applied = Apply(&memory, DEFAULT_RECORD_FIELDS, preset, bases);
+        if (!applied.ok || applied.stats.applied != 32 || ReadOps(memory) != 64 || WriteOps(memory) != 32) {
+            return Fail("scattered items are not read and written once each");
+        }
+
+        // 重复的基址
+        preset = RandomPreset(random, true);
+        bases = { HEAP_BASE + 0x80000, HEAP_BASE + 0x81000, HEAP_BASE + 0x80000 };
+        applied = Apply(&memory, DEFAULT_RECORD_FIELDS, preset, bases);
+        if (!applied.ok || applied.stats.items != 2 || applied.results[0] != PRESET_ITEM_APPLIED || applied.results[2] != applied.results[0]) {
+            return Fail("duplicate bases are not handled once");
+        }
+
+        // 记录重叠
+        bases = { HEAP_BASE + 0x90000, HEAP_BASE + 0x90010 };
+        memory.ResetOpCounts();
+        applied = Apply(&memory, DEFAULT_RECORD_FIELDS, preset, bases);
+        if (applied.status != PRESET_APPLY_RECORDS_OVERLAP || ReadOps(memory) != 0 || WriteOps(memory) != 0) {
+            return Fail("overlapping records are not rejected");
+        }
+
+        // 空预设
+        AffixPreset empty{};
+        bases = MakeBases(4, INVENTORY_STRIDE);
+        memory.ResetOpCounts();
+        applied = Apply(&memory, DEFAULT_RECORD_FIELDS, empty, bases);
+        if (!applied.ok || applied.stats.unchanged != 4 || ReadOps(memory) != 0) {
+            return Fail("empty preset touches memory");
+        }
+        return true;
+    }
+
+    bool CheckFailures() {
+        std::mt19937_64 random(0x4641494C);
+        const size_t heapSize = 0x10000;
+        SimulatedProcessMemory memory;
+        MakeHeap(memory, heapSize, 2);
+        AffixPreset preset = RandomPreset(random, true);
+        const uint32_t recordEnd = DEFAULT_RECORD_FIELDS.fields[RECORD_FIELD_COUNT - 1].offset + 1;
+
+        // 最后一件装备读不到: 合并读取失败，前面的装备逐个重读后照常写入 (不能连同没读到的间隔一起写)
+        FaultyMemory faulty(&memory);
+        std::vector<QWORD> bases = MakeBases(4, INVENTORY_STRIDE, HEAP_BASE + heapSize - 3 * INVENTORY_STRIDE - recordEnd / 2);
+        faulty.readFailStart = bases[3] + recordEnd / 2;
+        faulty.readFailEnd = bases[3] + recordEnd;
+        Applied applied = Apply(&faulty, DEFAULT_RECORD_FIELDS, preset, bases);
+        if (applied.status != PRESET_APPLY_READ_FAILED || applied.results[3] != PRESET_ITEM_READ_FAILED || applied.results[0] != PRESET_ITEM_APPLIED ||
+            applied.results[2] != PRESET_ITEM_APPLIED || applied.stats.failed != 1) {
+            return Fail("read failures are not isolated");
+        }
+        SimulatedProcessMemory reference;
+        MakeHeap(reference, heapSize, 2);
+        for (size_t i = 0; i < 3; i++) {
+            ApplyPerSlot(&reference, DEFAULT_RECORD_FIELDS, preset, bases[i]);
+        }
+        if (ReadHeap(memory, heapSize) != ReadHeap(reference, heapSize)) {
+            return Fail("items next to a read failure were written incorrectly");
+        }
+
+        // 写入失败 / 写入没有生效
+        preset = RandomPreset(random, true);
+        faulty.readFailStart = faulty.readFailEnd = 0;
+        bases = MakeBases(8, SCATTER_STRIDE / 4, HEAP_BASE + 0x40);
+        faulty.failStart = bases[2];
+        faulty.failEnd = bases[2] + 8;
+        faulty.dropStart = bases[5] + 0x40;
+        faulty.dropEnd = bases[5] + 0x41;
+        applied = Apply(&faulty, DEFAULT_RECORD_FIELDS, preset, bases);
+        if (applied.status != PRESET_APPLY_WRITE_FAILED || applied.results[2] != PRESET_ITEM_WRITE_FAILED || applied.results[5] != PRESET_ITEM_VERIFY_FAILED ||
+            applied.results[1] != PRESET_ITEM_APPLIED || applied.results[7] != PRESET_ITEM_APPLIED || applied.stats.failed != 2) {
+            return Fail("write failures are not reported per item");
+        }
+        for (const PresetItemEdit& edit : applied.edits) {
+            if (edit.base == bases[2]) {
+                return Fail("failed write recorded as an edit");
+            }
+        }
+
+        // 只有写入没有生效的装备
+        preset = RandomPreset(random, true);
+        faulty.failStart = faulty.failEnd = 0;
+        applied = Apply(&faulty, DEFAULT_RECORD_FIELDS, preset, bases);
+        if (applied.status != PRESET_APPLY_VERIFY_FAILED || applied.results[5] != PRESET_ITEM_VERIFY_FAILED || applied.stats.failed != 1) {
+            return Fail("verify failures are not reported as such");
+        }
+        return true;
+    }
+
+    // 会话: 整体失败的原因决定错误信息，部分装备失败时照常返回每件装备的结果
+    bool CheckSessionErrors() {
+        SimulatedProcessMemory memory;
+        SimulatedGame::Build(memory);
+        BorrowedProcessMemory* borrowed = new BorrowedProcessMemory(memory);
+        Session session;
+        if (!session.Attach(std::unique_ptr<ProcessMemory>(borrowed))) {
+            return Fail("attach failed");
+        }
+
+        std::mt19937_64 random(0x53455353);
+        const QWORD bases[] = { SimulatedGame::HEAP_BASE + 0x1000, SimulatedGame::HEAP_BASE + 0x2000, SimulatedGame::HEAP_BASE + 0x3000 };
+        const QWORD overlapping[] = { bases[0], bases[0] + 0x10 };
+        AffixPreset preset = RandomPreset(random, true);
+        int32_t results[3] = {};
+        PresetApplyStats stats{};
+        if (session.ApplyAffixPreset(&preset, overlapping, 2, results, &stats) ||
+            strcmp(session.GetLastErrorMessage(), "Equipment records overlap") != 0) {
+            return Fail("session overlap error");
+        }
+
+        const struct {
+            bool read;
+            const char* message;
+            int32_t result;
+        } cases[] = {
+            { true, "Failed to read equipment records", PRESET_ITEM_READ_FAILED },
+            { false, "Failed to write equipment records", PRESET_ITEM_WRITE_FAILED },
+        };
+        for (const auto& c : cases) {
+            preset = RandomPreset(random, true);
+            QWORD& failStart = c.read ? borrowed->readFailStart : borrowed->writeFailStart;
+            QWORD& failEnd = c.read ? borrowed->readFailEnd : borrowed->writeFailEnd;
+            failStart = bases[1];
+            failEnd = bases[1] + 0x1000;
+            bool applied = session.ApplyAffixPreset(&preset, bases, 3, results, &stats);
+            failStart = failEnd = 0;
+            if (applied || strcmp(session.GetLastErrorMessage(), c.message) != 0 || results[1] != c.result ||
+                results[0] != PRESET_ITEM_APPLIED || results[2] != PRESET_ITEM_APPLIED || stats.failed != 1) {
+                return Fail(c.message);
+            }
+        }
+
+        preset = RandomPreset(random, true);
+        if (!session.ApplyAffixPreset(&preset, bases, 3, results, &stats) || session.GetLastErrorMessage()[0] != 0) {
+            return Fail("session apply after failures");
+        }
+        session.Detach();
+        return true;
+    }
+
+    struct BenchResult {
+        double itemsPerSecond;
+        double readsPerItem;
+        double writesPerItem;
+    };
+
+    BenchResult Measure(size_t items, uint32_t stride, uint32_t latency, bool bulk) {
+        SimulatedProcessMemory memory;
+        MakeHeap(memory, items * stride + 0x1000, 3);
+        memory.SetLatency(TraceOp::Read, latency);
+        memory.SetLatency(TraceOp::Write, latency);
+        std::mt19937_64 random(4);
+        std::vector<QWORD> bases = MakeBases(items, stride);
+
+        // 两套预设交替应用，每次都有写入
+        AffixPreset presets[2] = { RandomPreset(random, true), RandomPreset(random, true) };
+        const int rounds = 4;
+        memory.ResetOpCounts();
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; round++) {
+            const AffixPreset& preset = presets[round & 1];
+            if (bulk) {
+                Apply(&memory, DEFAULT_RECORD_FIELDS, preset, bases);
+            } else {
+                for (QWORD base : bases) {
+                    ApplyPerSlot(&memory, DEFAULT_RECORD_FIELDS, preset, base);
+                }
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double total = (double)items * rounds;
+        return { total / seconds, ReadOps(memory) / total, WriteOps(memory) / total };
+    }
+
+    void RunBench(size_t items, uint32_t latency) {
+        printf("%zu items, %u ns per remote read/write\n", items, latency);
+        printf("%-12s %-10s %14s %10s %10s\n", "items", "method", "items/s", "reads/item", "writes/item");
+        const struct { const char* name; uint32_t stride; } shapes[] = {
+            { "inventory", INVENTORY_STRIDE },
+            { "scattered", SCATTER_STRIDE },
+        };
+        for (const auto& shape : shapes) {
+            for (bool bulk : { true, false }) {
+                BenchResult result = Measure(items, shape.stride, latency, bulk);
+                printf("%-12s %-10s %14.0f %10.3f %10.3f\n", shape.name, bulk ? "bulk" : "per-slot", result.itemsPerSecond,
+                    result.readsPerItem, result.writesPerItem);
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    bool checkOnly = false;
+    size_t items = 4096;
+    uint32_t latency = 5000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check") == 0) {
+            checkOnly = true;
+        } else if (strcmp(argv[i], "--items") == 0 && i + 1 < argc) {
+            items = (size_t)strtoul(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "--latency-ns") == 0 && i + 1 < argc) {
+            latency = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        } else {
+            fprintf(stderr, "usage: %s [--items N] [--latency-ns N] | --check\n", argv[0]);
+            return 2;
+        }
+    }
+    if (items == 0 || items > PresetApplyLayout::MAX_ITEMS) {
+        fprintf(stderr, "--items must be between 1 and %u\n", PresetApplyLayout::MAX_ITEMS);
+        return 2;
+    }
+
+    if (!CheckAgainstPerSlot() || !CheckBatching() || !CheckFailures() || !CheckSessionErrors()) {
+        fprintf(stderr, "preset checks failed\n");
+        return 1;
+    }
+    if (checkOnly) {
+        printf("ok\n");
+        return 0;
+    }
+    RunBench(items, latency);
+    return 0;
+}
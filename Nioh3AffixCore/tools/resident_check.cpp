@@ -0,0 +1,211 @@
+// 常驻代码洞接管检查 (模拟的游戏进程，不需要游戏进程)
+//
+// 用法:
+//   resident_check [--check]
+//
+// 会话开启常驻模式后分离，把 hook 和代码洞留在模拟的游戏进程中；之后的会话用同一个缓存文件附加，
+// 在各种改动 (游戏重启、hook 代码或注入点被改写、主模块大小变化、头部损坏) 之后检查接管结果。
+// 要求:
+//   没有缓存时正常扫描并安装；常驻分离后注入点仍指向代码洞，缓存记录头部位置；
+//   头部和 hook 都完好时直接接管: 只查询代码洞的两个区域，不分配、不写入，分离期间的捕获在接管后可以读到，再次启用捕获不分配；
+//   游戏重启后 (头部不在) 和主模块大小变化时不接管，后者不读取头部；头部校验和不符时不接管也不改写；
+//   hook 代码被改动时恢复两个注入点并释放代码洞；注入点被其它程序改写时恢复另一个注入点、清除头部并保留代码洞；
+//   关闭常驻模式后分离时注入点恢复为原始字节，代码洞被释放。
+
+#include "check_tool.h"
+#include "resident_cave.h"
+#include "session.h"
+#include "simulated_game.h"
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+
+namespace {
+    const char* CACHE_PATH = "resident_check.cache";
+
+    using CheckTool::Expect;
+
+    bool IsHooked(SimulatedProcessMemory& memory) {
+        return SimulatedGame::JumpTarget(memory, SimulatedGame::WEAPON_SITE) != 0 &&
+            SimulatedGame::JumpTarget(memory, SimulatedGame::ARMOR_SITE) != 0;
+    }
+
+    bool IsRestored(SimulatedProcessMemory& memory) {
+        return SimulatedGame::Matches(memory, SimulatedGame::WEAPON_SITE, SimulatedGame::WEAPON_BYTES, sizeof(SimulatedGame::WEAPON_BYTES)) &&
+            SimulatedGame::Matches(memory, SimulatedGame::ARMOR_SITE, SimulatedGame::ARMOR_BYTES, sizeof(SimulatedGame::ARMOR_BYTES));
+    }
+
+    QWORD ArenaBase(SimulatedProcessMemory& memory) {
+        return SimulatedGame::CommittedRegion(memory, SimulatedGame::JumpTarget(memory, SimulatedGame::WEAPON_SITE));
+    }
+
+    bool Attach(Session& session, SimulatedProcessMemory& memory, bool resident) {
+        session.SetResidentHooks(resident ? CACHE_PATH : nullptr);
+        return session.Attach(std::unique_ptr<ProcessMemory>(new BorrowedProcessMemory(memory)));
+    }
+
+    // 带插桩和信箱安装 hook 后常驻分离，再模拟一次武器 hook 命中 (工具不在时的捕获)；返回代码洞基址
+    QWORD LeaveResident(SimulatedProcessMemory& memory, QWORD base) {
+        Session session;
+        session.SetHookInstrumentation(true);
+        session.SetEditMailbox(true);
+        if (!Attach(session, memory, true) ||
+            (session.GetResidentState() != RESIDENT_ADOPTED && !session.EnableCapture())) {
+            return 0;
+        }
+        session.Detach();
+
+        QWORD arena = ArenaBase(memory);
+        ResidentCaveHeader header;
+        if (arena == 0 || !IsHooked(memory) || !ReadResidentHeader(&memory, arena + RemoteArena::CODE_SIZE, header) ||
+            !SimulatedGame::ProduceCapture(memory, header.ringAddress, base, CaptureRingLayout::SOURCE_WEAPON)) {
+            return 0;
+        }
+        return arena;
+    }
+
+    bool CheckAdopt() {
+        remove(CACHE_PATH);
+        SimulatedProcessMemory memory;
+        SimulatedGame::Build(memory);
+
+        // 没有缓存: 正常扫描并安装
+        QWORD first = SimulatedGame::HEAP_BASE + 0x100;
+        QWORD arena = LeaveResident(memory, first);
+        ResidentCacheEntry entry;
+        bool ok = Expect(arena != 0, "leave hooks resident without a cache");
+        ok = Expect(LoadResidentCache(CACHE_PATH, entry) && entry.moduleSize == SimulatedGame::MODULE_SIZE &&
+            SimulatedGame::MODULE_BASE + entry.headerRva == arena + RemoteArena::CODE_SIZE, "cache entry") && ok;
+        if (!ok) {
+            return CheckTool::Report("adopt", false);
+        }
+
+        // 接管: 不扫描、不分配、不改写，只查询代码洞的代码区和数据区 (校验仍已提交)
+        Session session;
+        memory.ResetOpCounts();
+        ok = Expect(Attach(session, memory, true) && session.GetResidentState() == RESIDENT_ADOPTED, "adopt") && ok;
+        uint64_t reads = memory.GetOpCount(TraceOp::Read);
+        ok = Expect(memory.GetOpCount(TraceOp::Query) == 2 && memory.GetOpCount(TraceOp::Allocate) == 0 &&
+            memory.GetOpCount(TraceOp::Write) == 0 && memory.GetOpCount(TraceOp::Protect) == 0, "adopt scanned or patched") && ok;
+        ok = Expect(session.IsWeaponHookEnabled() && session.IsArmorHookEnabled(), "adopted hooks not enabled") && ok;
+        ok = Expect(session.GetEquipmentBase() == first, "capture made while detached") && ok;
+
+        ResidentCaveHeader header;
+        ok = Expect(ReadResidentHeader(&memory, arena + RemoteArena::CODE_SIZE, header), "header after adopt") && ok;
+        QWORD second = SimulatedGame::HEAP_BASE + 0x200;
+        SimulatedGame::ProduceCapture(memory, header.ringAddress, second, CaptureRingLayout::SOURCE_ARMOR);
+        ok = Expect(session.GetEquipmentBase() == second && session.GetArmorBase() == second, "capture after adopt") && ok;
+        HookStats stats;
+        ok = Expect(session.GetHookStats(EQUIP_TYPE_WEAPON, &stats), "adopted hook stats") && ok;
+        memory.ResetOpCounts();
+        ok = Expect(session.EnableCapture() && memory.GetOpCount(TraceOp::Allocate) == 0, "enable capture after adopt allocated") && ok;
+
+        // 关闭常驻模式后分离: 完整恢复
+        session.SetResidentHooks(nullptr);
+        session.Detach();
+        ok = Expect(IsRestored(memory) && SimulatedGame::CommittedRegion(memory, arena) == 0, "normal detach after adopt") && ok;
+
+        // 游戏重启: 缓存还在，头部所在的位置已不是代码洞
+        SimulatedProcessMemory restarted;
+        SimulatedGame::Build(restarted);
+        Session fresh;
+        ok = Expect(Attach(fresh, restarted, true) && fresh.GetResidentState() == RESIDENT_NONE && fresh.EnableCapture(),
+            "attach after a game restart") && ok;
+        fresh.SetResidentHooks(nullptr);
+        fresh.Detach();
+        ok = Expect(IsRestored(restarted), "sites not restored after a game restart") && ok;
+        return CheckTool::Report("adopt", ok, "adopt: %llu reads", (unsigned long long)reads);
+    }
+
+    bool CheckUninstall() {
+        remove(CACHE_PATH);
+        SimulatedProcessMemory memory;
+        SimulatedGame::Build(memory);
+
+        // hook 代码被改动: 恢复注入点并释放代码洞
+        QWORD arena = LeaveResident(memory, SimulatedGame::HEAP_BASE + 0x300);
+        ResidentCaveHeader header;
+        bool ok = Expect(arena != 0 && ReadResidentHeader(&memory, arena + RemoteArena::CODE_SIZE, header), "leave hooks resident");
+        if (!ok) {
+            return CheckTool::Report("uninstall", false);
+        }
+        uint8_t code = 0;
+        memory.Read(header.hooks[0].codeAddress + 3, &code, 1);
+        code ^= 0xFF;
+        memory.SetBytes(header.hooks[0].codeAddress + 3, &code, 1);
+        {
+            Session session;
+            ok = Expect(Attach(session, memory, true) && session.GetResidentState() == RESIDENT_UNINSTALLED, "damaged hook code") && ok;
+            ok = Expect(IsRestored(memory) && SimulatedGame::CommittedRegion(memory, arena) == 0 && !session.IsWeaponHookEnabled(),
+                "damaged cave not uninstalled") && ok;
+            ok = Expect(session.EnableCapture(), "enable capture after uninstall") && ok;
+            session.SetResidentHooks(nullptr);
+            session.Detach();
+            ok = Expect(IsRestored(memory), "sites not restored") && ok;
+        }
+
+        // 注入点被其它程序改写: 恢复另一个注入点，清除头部，保留代码洞 (改写的注入点可能仍会跳进去)
+        arena = LeaveResident(memory, SimulatedGame::HEAP_BASE + 0x400);
+        const uint8_t foreign[8] = { 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC };
+        memory.SetBytes(SimulatedGame::ARMOR_SITE, foreign, sizeof(foreign));
+        {
+            Session session;
+            ok = Expect(Attach(session, memory, true) && session.GetResidentState() == RESIDENT_UNINSTALLED, "foreign site") && ok;
+            ok = Expect(SimulatedGame::Matches(memory, SimulatedGame::WEAPON_SITE, SimulatedGame::WEAPON_BYTES, sizeof(SimulatedGame::WEAPON_BYTES)) &&
+                SimulatedGame::Matches(memory, SimulatedGame::ARMOR_SITE, foreign, sizeof(foreign)), "sites after a foreign patch") && ok;
+            ok = Expect(SimulatedGame::CommittedRegion(memory, arena) == arena &&
+                !ReadResidentHeader(&memory, arena + RemoteArena::CODE_SIZE, header), "cave kept with its header cleared") && ok;
+            session.Detach();
+        }
+        Session again;
+        ok = Expect(Attach(again, memory, true) && again.GetResidentState() == RESIDENT_NONE, "cleared header adopted again") && ok;
+        again.Detach();
+        return CheckTool::Report("uninstall", ok);
+    }
+
+    bool CheckStale() {
+        remove(CACHE_PATH);
+        SimulatedProcessMemory memory;
+        SimulatedGame::Build(memory);
+        QWORD arena = LeaveResident(memory, SimulatedGame::HEAP_BASE + 0x500);
+        bool ok = Expect(arena != 0, "leave hooks resident");
+
+        // 主模块大小不同 (游戏更新): 不读取头部
+        memory.SetMainModule(SimulatedGame::MODULE_BASE, SimulatedGame::MODULE_SIZE + 0x1000);
+        {
+            Session session;
+            memory.ResetOpCounts();
+            ok = Expect(Attach(session, memory, true) && session.GetResidentState() == RESIDENT_NONE &&
+                memory.GetOpCount(TraceOp::Read) == 0, "module size changed") && ok;
+            session.Detach();
+        }
+        memory.SetMainModule(SimulatedGame::MODULE_BASE, SimulatedGame::MODULE_SIZE);
+
+        // 头部被改动 (校验和不符): 不接管也不改写
+        QWORD header = arena + RemoteArena::CODE_SIZE;
+        uint8_t byte = 0;
+        memory.Read(header + offsetof(ResidentCaveHeader, moduleSize), &byte, 1);
+        byte ^= 1;
+        memory.SetBytes(header + offsetof(ResidentCaveHeader, moduleSize), &byte, 1);
+        {
+            Session session;
+            memory.ResetOpCounts();
+            ok = Expect(Attach(session, memory, true) && session.GetResidentState() == RESIDENT_NONE &&
+                memory.GetOpCount(TraceOp::Write) == 0 && IsHooked(memory), "corrupted header") && ok;
+            session.Detach();
+        }
+
+        // 常驻模式关闭: 附加时不读缓存
+        {
+            Session session;
+            ok = Expect(Attach(session, memory, false) && session.GetResidentState() == RESIDENT_NONE, "resident mode off") && ok;
+            session.Detach();
+        }
+        remove(CACHE_PATH);
+        return CheckTool::Report("stale", ok);
+    }
+}
+
+int main(int argc, char** argv) {
+    return CheckTool::Run(argc, argv, "resident", { CheckAdopt, CheckUninstall, CheckStale });
+}
@@ -0,0 +1,187 @@
+// 多会话并发检查 (不需要游戏进程)
+//
+// 用法:
+//   session_check [--check]
+//
+// 每个线程用自己的会话附加到自己的模拟游戏进程 (tools/simulated_game.h)，反复启用捕获、模拟 hook 命中、读写词条和分离。
+// 要求:
+//   每个会话只看到自己进程中的捕获和记录，写入只落在自己的进程中，其它进程的字节保持不变；
+//   分离后注入点恢复为原始字节，代码洞被释放；
+//   一个会话的远程调用很慢时，其它会话的调用不等待它 (会话之间不共用锁)。
+
+#include "check_tool.h"
+#include "memory_layout.h"
+#include "session.h"
+#include "simulated_game.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr int SESSION_COUNT = 4;
+    constexpr int ROUNDS = 50;
+    constexpr QWORD RECORD_STRIDE = 0x400;
+    constexpr uint32_t SLOW_READ_NS = 300000000;   // 慢会话每次读取 300ms
+    constexpr int FAST_CALLS = 100;
+
+    using CheckTool::Expect;
+
+    // 会话 index 在第 round 轮使用的记录和词条
+    QWORD RecordBase(int index, int round) {
+        return SimulatedGame::HEAP_BASE + RECORD_STRIDE * (QWORD)((round % 8) + 1) + 0x10 * (QWORD)index;
+    }
+
+    int AffixId(int index, int round, int slot) {
+        return 100000 * (index + 1) + 100 * round + slot;
+    }
+
+    struct GameSession {
+        SimulatedProcessMemory memory;
+        Session session;
+
+        GameSession() { SimulatedGame::Build(memory); }
+
+        bool Attach() {
+            return session.Attach(std::unique_ptr<ProcessMemory>(new BorrowedProcessMemory(memory)));
+        }
+    };
+
+    // 一个会话的完整流程；失败时返回描述
+    const char* RunSession(GameSession& game, int index) {
+        for (int round = 0; round < ROUNDS; round++) {
+            if (!game.Attach() || !game.session.EnableCapture()) {
+                return "attach and enable";
+            }
+            QWORD ring = SimulatedGame::CaptureRingAddress(game.memory);
+            QWORD record = RecordBase(index, round);
+            if (!SimulatedGame::ProduceCapture(game.memory, ring, record, CaptureRingLayout::SOURCE_WEAPON)) {
+                return "produce capture";
+            }
+            if (game.session.GetEquipmentBase() != record || game.session.GetWeaponBase() != record) {
+                return "captured base belongs to another session";
+            }
+
+            for (int slot = 0; slot < MemoryLayout::AFFIX_SLOT_COUNT; slot++) {
+                if (!game.session.WriteAffix(slot, AffixId(index, round, slot), round % 10 + 1)) {
+                    return "write affix";
+                }
+            }
+            for (int slot = 0; slot < MemoryLayout::AFFIX_SLOT_COUNT; slot++) {
+                int id = 0;
+                int level = 0;
+                int32_t stored = 0;
+                if (!game.session.ReadAffix(slot, &id, &level) || id != AffixId(index, round, slot) || level != round % 10 + 1) {
+                    return "read affix differs from the write";
+                }
+                if (!game.memory.Read(record + MemoryLayout::GetAffixIdOffset(slot), &stored, sizeof(stored)) ||
+                    stored != AffixId(index, round, slot)) {
+                    return "affix not written to this session's process";
+                }
+            }
+
+            QWORD arena = SimulatedGame::CommittedRegion(game.memory, SimulatedGame::JumpTarget(game.memory, SimulatedGame::WEAPON_SITE));
+            game.session.Detach();
+            if (!SimulatedGame::Matches(game.memory, SimulatedGame::WEAPON_SITE, SimulatedGame::WEAPON_BYTES,
+                    sizeof(SimulatedGame::WEAPON_BYTES)) ||
+                !SimulatedGame::Matches(game.memory, SimulatedGame::ARMOR_SITE, SimulatedGame::ARMOR_BYTES,
+                    sizeof(SimulatedGame::ARMOR_BYTES))) {
+                return "hook sites not restored on detach";
+            }
+            if (arena == 0 || SimulatedGame::CommittedRegion(game.memory, arena) != 0) {
+                return "code cave not freed on detach";
+            }
+        }
+        return nullptr;
+    }
+
+    // 会话 index 的进程中只有它自己写过的记录；别的会话的词条 ID 不会出现在这里
+    bool OnlyOwnRecords(SimulatedProcessMemory& memory, int index) {
+        std::vector<uint8_t> heap(SimulatedGame::HEAP_SIZE);
+        if (!memory.Read(SimulatedGame::HEAP_BASE, heap.data(), heap.size())) {
+            return false;
+        }
+        for (size_t offset = 0; offset + sizeof(int32_t) <= heap.size(); offset += sizeof(int32_t)) {
+            int32_t value;
+            memcpy(&value, &heap[offset], sizeof(value));
+            int owner = value / 100000 - 1;
+            if (value > 0 && owner >= 0 && owner < SESSION_COUNT && owner != index) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool CheckConcurrentSessions() {
+        std::vector<std::unique_ptr<GameSession>> games;
+        for (int i = 0; i < SESSION_COUNT; i++) {
+            games.emplace_back(new GameSession());
+        }
+        const char* failures[SESSION_COUNT] = {};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < SESSION_COUNT; i++) {
+            threads.emplace_back([&, i]() { failures[i] = RunSession(*games[i], i); });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        bool ok = true;
+        for (int i = 0; i < SESSION_COUNT; i++) {
+            if (failures[i] != nullptr) {
+                printf("  FAIL session %d: %s\n", i, failures[i]);
+                ok = false;
+            }
+            ok = Expect(OnlyOwnRecords(games[i]->memory, i), "a session wrote into another session's process") && ok;
+        }
+        return CheckTool::Report("concurrent sessions", ok);
+    }
+
+    // 慢会话的一次读取进行期间，另一个会话完成多次调用
+    bool CheckNoSharedLock() {
+        GameSession slow;
+        GameSession fast;
+        bool ok = Expect(slow.Attach() && slow.session.EnableCapture() && fast.Attach() && fast.session.EnableCapture(),
+            "attach and enable");
+        if (!ok) {
+            return false;
+        }
+        QWORD record = RecordBase(0, 0);
+        SimulatedGame::ProduceCapture(slow.memory, SimulatedGame::CaptureRingAddress(slow.memory), record, CaptureRingLayout::SOURCE_WEAPON);
+        SimulatedGame::ProduceCapture(fast.memory, SimulatedGame::CaptureRingAddress(fast.memory), record, CaptureRingLayout::SOURCE_WEAPON);
+        ok = Expect(slow.session.GetEquipmentBase() == record && fast.session.GetEquipmentBase() == record, "captured bases") && ok;
+
+        std::atomic<bool> started(false);
+        std::atomic<bool> finished(false);
+        slow.memory.SetLatency(TraceOp::Read, SLOW_READ_NS);
+        std::thread thread([&]() {
+            started = true;
+            slow.session.ReadAffix(0, nullptr, nullptr);
+            finished = true;
+        });
+        while (!started) {
+            std::this_thread::yield();
+        }
+        // 让慢会话先进入读取 (持有它自己的锁)
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        int calls = 0;
+        while (calls < FAST_CALLS && fast.session.ReadAffix(0, nullptr, nullptr)) {
+            calls++;
+        }
+        bool overlapped = !finished;
+        thread.join();
+        slow.memory.SetLatency(TraceOp::Read, 0);
+
+        ok = Expect(calls == FAST_CALLS, "fast session calls failed") && ok;
+        ok = Expect(overlapped, "fast session waited for the slow session") && ok;
+        return CheckTool::Report("no shared lock", ok);
+    }
+}
+
+int main(int argc, char** argv) {
+    return CheckTool::Run(argc, argv, "session", { CheckConcurrentSessions, CheckNoSharedLock });
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "capture_ring.h"
+#include "process_memory.h"
+#include "remote_arena.h"
+#include "simulated_process_memory.h"
+#include <cstring>
+
+// 模拟的游戏进程 (会话检查工具使用)
+// 主模块中在固定位置放好武器/装备捕获点和两个技能绕过位置的原始指令 (特征码中的通配字节填 01 02 03 04)，
+// 另有一块可读写的堆。会话通过 BorrowedProcessMemory 访问，工具保留 SimulatedProcessMemory 直接检查和改写内存。
+namespace SimulatedGame {
+    constexpr QWORD MODULE_BASE = 0x140000000ull;
+    constexpr QWORD MODULE_SIZE = 0x20000;
+    constexpr QWORD WEAPON_SITE = MODULE_BASE + 0x1000;
+    constexpr QWORD ARMOR_SITE = MODULE_BASE + 0x5000;
+    constexpr QWORD SKILL_SITE1 = MODULE_BASE + 0x8000;
+    constexpr QWORD SKILL_SITE2 = MODULE_BASE + 0x9000;
+    constexpr QWORD HEAP_BASE = 0x200000000ull;
+    constexpr QWORD HEAP_SIZE = 0x10000;
+
+    // mov rdx,rbp; mov rcx,r10; call; mov rax,[rsi+..]; lea rcx,[rsi+..]
+    constexpr uint8_t WEAPON_BYTES[] = {
+        0x48, 0x8B, 0xD5, 0x49, 0x8B, 0xCA, 0xE8, 1, 2, 3, 4, 0x48, 0x8B, 0x86, 1, 2, 3, 4, 0x48, 0x8D, 0x8E, 1, 2, 3, 4
+    };
+    // lea rcx,[r12+148]; mov rdx,rbx; call; mov al,[rbp+6F]; mov cl,[rbp+67]
+    constexpr uint8_t ARMOR_BYTES[] = {
+        0x49, 0x8D, 0x8C, 0x24, 0x48, 0x01, 0x00, 0x00, 0x48, 0x8B, 0xD3, 0xE8, 1, 2, 3, 4, 0x8A, 0x45, 0x6F, 0x8A, 0x4D, 0x67
+    };
+    // jne +43; movzx ecx,di; call
+    constexpr uint8_t SKILL1_BYTES[] = { 0x75, 0x43, 0x0F, 0xB7, 0xCF, 0xE8, 1, 2, 3, 4 };
+    // jne rel32; mov rcx,[rip+..]; mov edx,imm32; mov byte [r13+..],1; mov rcx,[rcx+..]
+    constexpr uint8_t SKILL2_BYTES[] = {
+        0x0F, 0x85, 0x11, 0x22, 0x33, 0x44, 0x48, 0x8B, 0x0D, 1, 2, 3, 4, 0xBA, 1, 2, 3, 4,
+        0x41, 0xC6, 0x85, 1, 2, 3, 4, 0x01, 0x48, 0x8B, 0x89
+    };
+
+    inline void AddRegion(SimulatedProcessMemory& memory, QWORD base, QWORD size, uint32_t protect, uint32_t type) {
+        MemoryRegion region;
+        region.baseAddress = base;
+        region.regionSize = size;
+        region.state = MemState::Commit;
+        region.protect = protect;
+        region.type = type;
+        memory.AddRegion(region);
+
+        static const uint8_t zeros[0x1000] = {};
+        for (QWORD offset = 0; offset < size; offset += sizeof(zeros)) {
+            memory.SetBytes(base + offset, zeros, sizeof(zeros));
+        }
+    }
+
+    // skillSites 为 false 时不放技能绕过位置 (特征码扫描找不到)
+    inline void Build(SimulatedProcessMemory& memory, bool skillSites = true) {
+        AddRegion(memory, MODULE_BASE, MODULE_SIZE, MemProtect::ExecuteRead, MemType::Image);
+        AddRegion(memory, HEAP_BASE, HEAP_SIZE, MemProtect::ReadWrite, MemType::Private);
+        memory.SetMainModule(MODULE_BASE, MODULE_SIZE);
+        memory.SetBytes(WEAPON_SITE, WEAPON_BYTES, sizeof(WEAPON_BYTES));
+        memory.SetBytes(ARMOR_SITE, ARMOR_BYTES, sizeof(ARMOR_BYTES));
+        if (skillSites) {
+            memory.SetBytes(SKILL_SITE1, SKILL1_BYTES, sizeof(SKILL1_BYTES));
+            memory.SetBytes(SKILL_SITE2, SKILL2_BYTES, sizeof(SKILL2_BYTES));
+        }
+    }
+
+    // address 处是否为 bytes
+    inline bool Matches(ProcessMemory& memory, QWORD address, const uint8_t* bytes, size_t size) {
+        uint8_t current[64];
+        return size <= sizeof(current) && memory.Read(address, current, size) && memcmp(current, bytes, size) == 0;
+    }
+
+    // 注入点的 jmp rel32 的目标 (不是 E9 时返回 0)
+    inline QWORD JumpTarget(ProcessMemory& memory, QWORD site) {
+        uint8_t jump[5];
+        if (!memory.Read(site, jump, sizeof(jump)) || jump[0] != 0xE9) {
+            return 0;
+        }
+        int32_t displacement;
+        memcpy(&displacement, jump + 1, sizeof(displacement));
+        return site + sizeof(jump) + (int64_t)displacement;
+    }
+
+    // address 所在的已提交区域的基址 (不在已提交区域中时返回 0)
+    inline QWORD CommittedRegion(ProcessMemory& memory, QWORD address) {
+        MemoryRegion region;
+        return address != 0 && memory.Query(address, region) && region.state == MemState::Commit ? region.baseAddress : 0;
+    }
+
+    // 会话的捕获环地址: 代码洞数据区头部之后的第一块 (未开启 hook 计数时捕获环最先分配)
+    inline QWORD CaptureRingAddress(ProcessMemory& memory) {
+        QWORD arena = CommittedRegion(memory, JumpTarget(memory, WEAPON_SITE));
+        return arena != 0 ? arena + RemoteArena::CODE_SIZE + RemoteArena::HEADER_SIZE : 0;
+    }
+
+    // 按生产者协议追加一条捕获记录，相当于 hook 命中一次
+    inline bool ProduceCapture(ProcessMemory& memory, QWORD ringAddress, QWORD base, uint8_t source, QWORD owner = 0) {
+        CaptureRingHeader header;
+        if (ringAddress == 0 || !memory.Read(ringAddress, &header, sizeof(header))) {
+            return false;
+        }
+        uint64_t sequence = header.writeIndex++;
+        CaptureRingEntry entry;
+        entry.tag = ((sequence + 1) << CaptureRingLayout::TAG_SEQUENCE_SHIFT) | source;
+        entry.base = base;
+        entry.owner = owner;
+        entry.seal = entry.tag;
+        header.lastTag = entry.tag;
+        QWORD slot = ringAddress + sizeof(header) + (sequence & (CaptureRingLayout::CAPACITY - 1)) * sizeof(entry);
+        return memory.Write(slot, &entry, sizeof(entry)) && memory.Write(ringAddress, &header, sizeof(header));
+    }
+}
+
+// 转发到工具持有的后端 (会话拥有传给它的后端对象)
+// 与 [readFailStart, readFailEnd) 相交的读取、与 [writeFailStart, writeFailEnd) 相交的写入返回失败
+class BorrowedProcessMemory : public ProcessMemory {
+public:
+    explicit BorrowedProcessMemory(ProcessMemory& inner) : m_inner(inner) {}
+
+    QWORD readFailStart = 0, readFailEnd = 0;
+    QWORD writeFailStart = 0, writeFailEnd = 0;
+
+    bool Read(QWORD address, void* buffer, size_t size, size_t* bytesRead = nullptr) override {
+        if (address < readFailEnd && address + size > readFailStart) {
+            if (bytesRead != nullptr) {
+                *bytesRead = 0;
+            }
+            return false;
+        }
+        return m_inner.Read(address, buffer, size, bytesRead);
+    }
+    bool Write(QWORD address, const void* buffer, size_t size) override {
+        if (address < writeFailEnd && address + size > writeFailStart) {
+            return false;
+        }
+        return m_inner.Write(address, buffer, size);
+    }
+    bool Query(QWORD address, MemoryRegion& outRegion) override { return m_inner.Query(address, outRegion); }
+    bool Protect(QWORD address, size_t size, uint32_t newProtect, uint32_t* oldProtect) override {
+        return m_inner.Protect(address, size, newProtect, oldProtect);
+    }
+    QWORD Allocate(QWORD preferredAddress, size_t size, uint32_t protect) override {
+        return m_inner.Allocate(preferredAddress, size, protect);
+    }
+    bool Free(QWORD address) override { return m_inner.Free(address); }
+    bool GetMainModule(QWORD& baseAddress, QWORD& moduleSize) override { return m_inner.GetMainModule(baseAddress, moduleSize); }
+    bool SuspendThreads(std::vector<QWORD>* outInstructionPointers) override { return m_inner.SuspendThreads(outInstructionPointers); }
+    void ResumeThreads() override { m_inner.ResumeThreads(); }
+
+private:
+    ProcessMemory& m_inner;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "process_memory.h"
+#include "region_scan.h"
+#include <cstring>
+#include <vector>
+
+// 合成的目标进程快照 (扫描基准使用): 区域内容都在本进程内存中，只读写不分配
+class SnapshotMemory : public ProcessMemory {
+public:
+    struct Region {
+        QWORD base;
+        uint32_t protect;
+        uint32_t type;
+        std::vector<uint8_t> bytes;
+    };
+
+    std::vector<Region> regions;    // 按基址排序
+    QWORD moduleBase = 0;
+    QWORD moduleSize = 0;
+
+    uint8_t* At(QWORD address, size_t size) {
+        for (Region& region : regions) {
+            if (address >= region.base && address + size <= region.base + region.bytes.size()) {
+                return region.bytes.data() + (address - region.base);
+            }
+        }
+        return nullptr;
+    }
+
+    void Put(QWORD address, QWORD value) {
+        memcpy(At(address, sizeof(value)), &value, sizeof(value));
+    }
+
+    bool Read(QWORD address, void* buffer, size_t size, size_t* bytesRead = nullptr) override {
+        const uint8_t* source = At(address, size);
+        if (bytesRead != nullptr) {
+            *bytesRead = source != nullptr ? size : 0;
+        }
+        if (source == nullptr) {
+            return false;
+        }
+        memcpy(buffer, source, size);
+        return true;
+    }
+
+    bool Write(QWORD address, const void* buffer, size_t size) override {
+        uint8_t* target = At(address, size);
+        if (target == nullptr) {
+            return false;
+        }
+        memcpy(target, buffer, size);
+        return true;
+    }
+
+    bool Query(QWORD address, MemoryRegion& outRegion) override {
+        QWORD freeStart = 0;
+        for (const Region& region : regions) {
+            QWORD end = region.base + region.bytes.size();
+            if (address < region.base) {
+                outRegion = { freeStart, region.base - freeStart, MemState::Free, MemProtect::NoAccess, 0 };
+                return true;
+            }
+            if (address < end) {
+                outRegion = { region.base, region.bytes.size(), MemState::Commit, region.protect, region.type };
+                return true;
+            }
+            freeStart = end;
+        }
+        outRegion = { freeStart, RegionScanLayout::USER_SPACE_END - freeStart, MemState::Free, MemProtect::NoAccess, 0 };
+        return true;
+    }
+
+    bool Protect(QWORD, size_t, uint32_t, uint32_t*) override { return false; }
+    QWORD Allocate(QWORD, size_t, uint32_t) override { return 0; }
+    bool Free(QWORD) override { return false; }
+
+    bool GetMainModule(QWORD& baseAddress, QWORD& size) override {
+        baseAddress = moduleBase;
+        size = moduleSize;
+        return moduleSize != 0;
+    }
+};
@@ -0,0 +1,295 @@
+// 共享状态页检查 (POSIX 共享内存，不需要游戏进程)
+//
+// 用法:
+//   state_page_check [--check]
+//
+// 写者和读者分别打开同一个命名映射，按 seqlock 协议发布和读取；另用一个子进程作为读者，再让会话发布自己的状态页。
+// 要求:
+//   首次读取为 Ok，没有新发布时为 Unchanged，sequence 为奇数时为 Torn，页头不符时为 Invalid；
+//   写者线程不断发布时，读者接受的每个正文都来自同一次发布 (不接受撕裂的正文)；
+//   读者复制正文时被信号打断、信号处理函数发布新正文，这次读取为 Torn 而不是 Ok；
+//   子进程中的读者同样只读到完整的正文，并能读到最后一次发布；
+//   会话的附加 / hook / 捕获状态变化后发布新正文，状态不变的调用不发布。
+
+#include "check_tool.h"
+#include "session.h"
+#include "simulated_game.h"
+#include "state_page.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <csignal>
+#include <string>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+    constexpr int PUBLISH_MILLISECONDS = 1500;
+    constexpr int CHILD_PUBLISHES = 200000;
+    constexpr int SIGNAL_INTERVAL_US = 20;
+
+    using CheckTool::Expect;
+
+    std::string PageName(const char* suffix) {
+        return "n3check." + std::to_string((long)getpid()) + "." + suffix;
+    }
+
+    // 正文 (发布计数之外) 的每个字节都是发布序号的低 8 位；Publish 把发布计数加一，与序号相同
+    constexpr size_t PUBLISH_COUNT_OFFSET = offsetof(StatePageBody, counters) + offsetof(StateCounters, publishCount);
+
+    void Fill(StatePageBody& body, uint64_t index) {
+        uint64_t count = body.counters.publishCount;
+        memset(&body, (int)(index & 0xFF), sizeof(body));
+        body.counters.publishCount = count;
+    }
+
+    bool IsWhole(const StatePageBody& body) {
+        const uint8_t* bytes = (const uint8_t*)&body;
+        for (size_t i = 0; i < PUBLISH_COUNT_OFFSET; i++) {
+            if (bytes[i] != (uint8_t)body.counters.publishCount) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 页头和 sequence 的各种状态
+    bool CheckProtocol() {
+        std::string name = PageName("protocol");
+        StatePagePublisher publisher;
+        StatePageReader reader;
+        SharedMemory raw;
+        bool ok = Expect(publisher.Open(name.c_str()) && reader.Open(name.c_str()) &&
+            raw.Open(name.c_str(), sizeof(SharedStatePage), true), "open page");
+        if (!ok) {
+            return false;
+        }
+        SharedStatePage* page = (SharedStatePage*)raw.GetData();
+
+        StatePageBody body;
+        uint64_t last = 0;
+        ok = Expect(reader.TryRead(body, last) == StatePageReadResult::Ok, "first read") && ok;
+        ok = Expect(reader.TryRead(body, last) == StatePageReadResult::Unchanged, "read without a publish") && ok;
+
+        Fill(publisher.Staging(), 1);
+        publisher.Publish();
+        ok = Expect(reader.TryRead(body, last) == StatePageReadResult::Ok && IsWhole(body) && body.flags == 0x01010101u,
+            "read after a publish") && ok;
+
+        // 写者写到一半
+        uint64_t sequence = page->sequence.load();
+        page->sequence.store(sequence + 1);
+        ok = Expect(reader.TryRead(body, last) == StatePageReadResult::Torn, "odd sequence is not torn") && ok;
+        page->sequence.store(sequence + 2);
+        ok = Expect(reader.TryRead(body, last) == StatePageReadResult::Ok, "read after the write completes") && ok;
+
+        page->version++;
+        ok = Expect(reader.TryRead(body, last) == StatePageReadResult::Invalid, "version mismatch is not invalid") && ok;
+        page->version--;
+
+        StatePageReader closed;
+        ok = Expect(closed.TryRead(body, last) == StatePageReadResult::Invalid, "unopened reader") && ok;
+        return CheckTool::Report("protocol", ok);
+    }
+
+    // 写者线程和读者线程
+    bool CheckThreads() {
+        std::string name = PageName("threads");
+        StatePagePublisher publisher;
+        StatePageReader reader;
+        bool ok = Expect(publisher.Open(name.c_str()) && reader.Open(name.c_str()), "open page");
+        if (!ok) {
+            return false;
+        }
+
+        std::atomic<bool> stop(false);
+        uint64_t published = 0;
+        std::thread writer([&]() {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(PUBLISH_MILLISECONDS);
+            while (std::chrono::steady_clock::now() < deadline) {
+                Fill(publisher.Staging(), ++published);
+                publisher.Publish();
+            }
+            stop = true;
+        });
+
+        StatePageBody body;
+        uint64_t last = 0;
+        uint64_t accepted = 0;
+        uint64_t torn = 0;
+        uint64_t broken = 0;
+        while (!stop) {
+            StatePageReadResult result = reader.TryRead(body, last);
+            if (result == StatePageReadResult::Ok) {
+                accepted++;
+                broken += IsWhole(body) ? 0 : 1;
+            } else if (result == StatePageReadResult::Torn) {
+                torn++;
+            }
+        }
+        writer.join();
+
+        ok = Expect(broken == 0, "accepted a torn body") && ok;
+        ok = Expect(accepted > 1, "reader saw no publishes") && ok;
+        ok = Expect(reader.TryRead(body, last) != StatePageReadResult::Torn && reader.TryRead(body, last) ==
+            StatePageReadResult::Unchanged && IsWhole(body) && body.counters.publishCount == published,
+            "last publish not read") && ok;
+        return CheckTool::Report("threads", ok, "%llu publishes, %llu accepted, %llu torn",
+            (unsigned long long)published, (unsigned long long)accepted, (unsigned long long)torn);
+    }
+
+    // 信号处理函数中发布: 读者在复制正文的任意位置被打断，返回后 sequence 已经变化
+    StatePagePublisher* g_signalPublisher = nullptr;
+    volatile sig_atomic_t g_signalPublishes = 0;
+
+    void PublishFromSignal(int) {
+        Fill(g_signalPublisher->Staging(), (uint64_t)g_signalPublishes + 1);
+        g_signalPublisher->Publish();
+        g_signalPublishes = g_signalPublishes + 1;
+    }
+
+    bool CheckInterruptedReads() {
+        std::string name = PageName("signal");
+        StatePagePublisher publisher;
+        StatePageReader reader;
+        bool ok = Expect(publisher.Open(name.c_str()) && reader.Open(name.c_str()), "open page");
+        if (!ok) {
+            return false;
+        }
+
+        g_signalPublisher = &publisher;
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = PublishFromSignal;
+        sigaction(SIGALRM, &action, nullptr);
+        itimerval timer;
+        timer.it_interval.tv_sec = 0;
+        timer.it_interval.tv_usec = SIGNAL_INTERVAL_US;
+        timer.it_value = timer.it_interval;
+        setitimer(ITIMER_REAL, &timer, nullptr);
+
+        StatePageBody body;
+        uint64_t last = 0;
+        uint64_t torn = 0;
+        uint64_t broken = 0;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(PUBLISH_MILLISECONDS);
+        while (std::chrono::steady_clock::now() < deadline) {
+            for (int i = 0; i < 1000; i++) {
+                // 每次都复制正文，不在 Unchanged 处提前返回
+                last = 0;
+                StatePageReadResult result = reader.TryRead(body, last);
+                if (result == StatePageReadResult::Ok) {
+                    broken += IsWhole(body) ? 0 : 1;
+                } else if (result == StatePageReadResult::Torn) {
+                    torn++;
+                }
+            }
+        }
+
+        memset(&timer, 0, sizeof(timer));
+        setitimer(ITIMER_REAL, &timer, nullptr);
+        signal(SIGALRM, SIG_DFL);
+        g_signalPublisher = nullptr;
+
+        ok = Expect(broken == 0, "accepted a body changed during the copy") && ok;
+        ok = Expect(torn > 0, "no read was interrupted") && ok;
+        return CheckTool::Report("interrupted reads", ok, "%d publishes, %llu torn",
+            (int)g_signalPublishes, (unsigned long long)torn);
+    }
+
+    // 子进程打开同名映射读取，退出码为 0 表示只读到完整正文且读到了最后一次发布
+    int RunChildReader(const char* name) {
+        StatePageReader reader;
+        if (!reader.Open(name)) {
+            return 2;
+        }
+        StatePageBody body;
+        uint64_t last = 0;
+        while (true) {
+            if (reader.TryRead(body, last) == StatePageReadResult::Ok) {
+                if (!IsWhole(body)) {
+                    return 1;
+                }
+                if (body.counters.publishCount == (uint64_t)CHILD_PUBLISHES) {
+                    return 0;
+                }
+            }
+        }
+    }
+
+    bool CheckChildProcess() {
+        std::string name = PageName("child");
+        StatePagePublisher publisher;
+        bool ok = Expect(publisher.Open(name.c_str()), "open page");
+        if (!ok) {
+            return false;
+        }
+        fflush(stdout);
+        pid_t child = fork();
+        if (child == 0) {
+            _exit(RunChildReader(name.c_str()));
+        }
+        ok = Expect(child > 0, "fork") && ok;
+
+        for (int i = 1; i <= CHILD_PUBLISHES; i++) {
+            Fill(publisher.Staging(), (uint64_t)i);
+            publisher.Publish();
+        }
+
+        int status = -1;
+        if (child > 0) {
+            waitpid(child, &status, 0);
+        }
+        ok = Expect(WIFEXITED(status) && WEXITSTATUS(status) == 0, "child reader saw a torn body or missed the last publish") && ok;
+        return CheckTool::Report("child process", ok);
+    }
+
+    // 会话发布的状态
+    bool CheckSession() {
+        std::string name = PageName("session");
+        SimulatedProcessMemory memory;
+        SimulatedGame::Build(memory);
+        Session session;
+        StatePageReader reader;
+        bool ok = Expect(session.EnableStatePage(name.c_str()) && reader.Open(name.c_str()), "enable state page");
+        if (!ok) {
+            return false;
+        }
+
+        StatePageBody body;
+        uint64_t last = 0;
+        ok = Expect(reader.TryRead(body, last) == StatePageReadResult::Ok && body.flags == 0, "initial state") && ok;
+
+        ok = Expect(session.Attach(std::unique_ptr<ProcessMemory>(new BorrowedProcessMemory(memory))), "attach") && ok;
+        ok = Expect(reader.TryRead(body, last) == StatePageReadResult::Ok && body.flags == StatePageLayout::FLAG_ATTACHED,
+            "attached state") && ok;
+        session.IsAttached();
+        ok = Expect(reader.TryRead(body, last) == StatePageReadResult::Unchanged, "unchanged state was published") && ok;
+
+        ok = Expect(session.EnableCapture(), "enable capture") && ok;
+        const uint32_t hooked = StatePageLayout::FLAG_ATTACHED | StatePageLayout::FLAG_WEAPON_HOOK | StatePageLayout::FLAG_ARMOR_HOOK;
+        ok = Expect(reader.TryRead(body, last) == StatePageReadResult::Ok && body.flags == hooked, "hooked state") && ok;
+
+        QWORD record = SimulatedGame::HEAP_BASE + 0x400;
+        SimulatedGame::ProduceCapture(memory, SimulatedGame::CaptureRingAddress(memory), record, CaptureRingLayout::SOURCE_WEAPON);
+        session.GetEquipmentBase();
+        ok = Expect(reader.TryRead(body, last) == StatePageReadResult::Ok && body.equipmentBase == record &&
+            body.weaponBase == record, "captured base") && ok;
+
+        session.Detach();
+        ok = Expect(reader.TryRead(body, last) == StatePageReadResult::Ok && body.flags == 0 && body.equipmentBase == 0,
+            "detached state") && ok;
+        session.DisableStatePage();
+        return CheckTool::Report("session", ok);
+    }
+}
+
+int main(int argc, char** argv) {
+    return CheckTool::Run(argc, argv, "state page", {
+        CheckProtocol, CheckThreads, CheckInterruptedReads, CheckChildProcess, CheckSession
+    });
+}
@@ -0,0 +1,263 @@
+// 远程内存跟踪回放工具
+//
+// 用法:
+//   trace_replay <trace>                  按原顺序重放跟踪中的每个操作，按阶段比较录制耗时与回放耗时
+//   trace_replay <trace> --session        用跟踪重建的模拟进程运行当前核心的附加/捕获/读取流程，
+//                                         报告每一步的远程操作次数和耗时
+//   --latency                             (与 --session 一起使用) 为每类操作加上录制时的中位耗时，
+//                                         近似真实跨进程调用的开销
+//
+// 跟踪文件由 SessionSetTraceFile 在 Windows 上录制，本工具不依赖 Windows。
+
+#include "memory_trace.h"
+#include "session.h"
+#include "simulated_process_memory.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    double ElapsedMs(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    struct PhaseStats {
+        uint64_t ops = 0;
+        uint64_t bytes = 0;
+        uint64_t recordedNs = 0;
+        double replayMs = 0;
+    };
+
+    // 会话会在 Detach 时销毁后端，回放时用它借用模拟进程以便 Detach 之后仍能读取计数
+    class BorrowedProcessMemory : public ProcessMemory {
+    public:
+        explicit BorrowedProcessMemory(ProcessMemory& inner) : m_inner(inner) {}
+
+        bool Read(QWORD address, void* buffer, size_t size, size_t* bytesRead = nullptr) override { return m_inner.Read(address, buffer, size, bytesRead); }
+        bool Write(QWORD address, const void* buffer, size_t size) override { return m_inner.Write(address, buffer, size); }
+        bool Query(QWORD address, MemoryRegion& outRegion) override { return m_inner.Query(address, outRegion); }
+        bool Protect(QWORD address, size_t size, uint32_t newProtect, uint32_t* oldProtect) override { return m_inner.Protect(address, size, newProtect, oldProtect); }
+        QWORD Allocate(QWORD preferredAddress, size_t size, uint32_t protect) override { return m_inner.Allocate(preferredAddress, size, protect); }
+        bool Free(QWORD address) override { return m_inner.Free(address); }
+        bool GetMainModule(QWORD& baseAddress, QWORD& moduleSize) override { return m_inner.GetMainModule(baseAddress, moduleSize); }
+
+    private:
+        ProcessMemory& m_inner;
+    };
+
+    void PrintSummary(const std::vector<TraceRecord>& records) {
+        uint64_t counts[TRACE_OP_COUNT] = {};
+        uint64_t bytes[TRACE_OP_COUNT] = {};
+        uint64_t ns[TRACE_OP_COUNT] = {};
+        uint64_t failures = 0;
+        for (const TraceRecord& record : records) {
+            int op = (int)record.op;
+            counts[op]++;
+            ns[op] += record.durationNs;
+            if (record.op == TraceOp::Read || record.op == TraceOp::Write) {
+                bytes[op] += record.size;
+            }
+            if (!record.ok && record.op != TraceOp::Phase) {
+                failures++;
+            }
+        }
+
+        printf("%-14s %10s %14s %12s\n", "op", "count", "bytes", "total ms");
+        for (int op = 1; op < TRACE_OP_COUNT; op++) {
+            if (counts[op] == 0 || op == (int)TraceOp::Phase) {
+                continue;
+            }
+            printf("%-14s %10llu %14llu %12.3f\n", GetTraceOpName((TraceOp)op),
+                (unsigned long long)counts[op], (unsigned long long)bytes[op], ns[op] / 1e6);
+        }
+        printf("failures: %llu\n\n", (unsigned long long)failures);
+    }
+
+    // 按原顺序重放每个操作
+    void ReplayOperations(const std::vector<TraceRecord>& records) {
+        SimulatedProcessMemory memory;
+        memory.LoadFromTrace(records);
+
+        std::vector<std::string> order;
+        std::map<std::string, PhaseStats> phases;
+        std::string phase = "(none)";
+        std::vector<uint8_t> buffer;
+        uint64_t mismatches = 0;
+
+        for (const TraceRecord& record : records) {
+            if (record.op == TraceOp::Phase) {
+                phase.assign(record.payload.begin(), record.payload.end());
+                continue;
+            }
+
+            if (phases.find(phase) == phases.end()) {
+                order.push_back(phase);
+            }
+            PhaseStats& stats = phases[phase];
+            stats.ops++;
+            stats.recordedNs += record.durationNs;
+
+            bool ok = false;
+            auto start = Clock::now();
+            switch (record.op) {
+            case TraceOp::Read:
+                buffer.resize((size_t)record.size);
+                ok = memory.Read(record.address, buffer.data(), buffer.size());
+                stats.bytes += record.size;
+                break;
+            case TraceOp::Write:
+                ok = memory.Write(record.address, record.payload.data(), record.payload.size());
+                stats.bytes += record.size;
+                break;
+            case TraceOp::Query: {
+                MemoryRegion region;
+                ok = memory.Query(record.address, region);
+                break;
+            }
+            case TraceOp::Protect:
+                ok = memory.Protect(record.address, (size_t)record.size, record.arg, nullptr);
+                break;
+            case TraceOp::Allocate:
+                ok = memory.Allocate(record.address, (size_t)record.size, record.arg) != 0;
+                break;
+            case TraceOp::Free:
+                ok = memory.Free(record.address);
+                break;
+            case TraceOp::GetMainModule: {
+                QWORD base = 0;
+                QWORD size = 0;
+                ok = memory.GetMainModule(base, size);
+                break;
+            }
+            case TraceOp::Phase:
+                break;
+            }
+            stats.replayMs += ElapsedMs(start);
+
+            if (ok != record.ok) {
+                mismatches++;
+            }
+        }
+
+        printf("%-28s %10s %14s %14s %14s\n", "phase", "ops", "bytes", "recorded ms", "replay ms");
+        for (const std::string& name : order) {
+            const PhaseStats& stats = phases[name];
+            printf("%-28s %10llu %14llu %14.3f %14.3f\n", name.c_str(),
+                (unsigned long long)stats.ops, (unsigned long long)stats.bytes, stats.recordedNs / 1e6, stats.replayMs);
+        }
+        printf("result mismatches: %llu\n", (unsigned long long)mismatches);
+    }
+
+    // 每类操作录制耗时的中位数
+    void ApplyRecordedLatency(const std::vector<TraceRecord>& records, SimulatedProcessMemory& memory) {
+        std::vector<uint32_t> durations[TRACE_OP_COUNT];
+        for (const TraceRecord& record : records) {
+            durations[(int)record.op].push_back(record.durationNs);
+        }
+        for (int op = 1; op < TRACE_OP_COUNT; op++) {
+            std::vector<uint32_t>& values = durations[op];
+            if (values.empty()) {
+                continue;
+            }
+            std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+            memory.SetLatency((TraceOp)op, values[values.size() / 2]);
+        }
+    }
+
+    // 用当前核心跑一遍附加/捕获/读取流程
+    int ReplaySession(const std::vector<TraceRecord>& records, bool withLatency) {
+        SimulatedProcessMemory memory;
+        memory.LoadFromTrace(records);
+        if (withLatency) {
+            ApplyRecordedLatency(records, memory);
+        }
+
+        Session session;
+        printf("%-22s %8s %8s %8s %8s %8s %12s\n", "step", "result", "reads", "writes", "queries", "other", "ms");
+
+        auto runStep = [&](const char* name, auto&& step) {
+            memory.ResetOpCounts();
+            auto start = Clock::now();
+            bool ok = step();
+            double ms = ElapsedMs(start);
+            uint64_t other = memory.GetOpCount(TraceOp::Protect) + memory.GetOpCount(TraceOp::Allocate)
+                + memory.GetOpCount(TraceOp::Free) + memory.GetOpCount(TraceOp::GetMainModule);
+            printf("%-22s %8s %8llu %8llu %8llu %8llu %12.3f\n", name, ok ? "ok" : "fail",
+                (unsigned long long)memory.GetOpCount(TraceOp::Read),
+                (unsigned long long)memory.GetOpCount(TraceOp::Write),
+                (unsigned long long)memory.GetOpCount(TraceOp::Query),
+                (unsigned long long)other, ms);
+            if (!ok && session.GetLastErrorMessage()[0] != '\0') {
+                printf("    error: %s\n", session.GetLastErrorMessage());
+            }
+            return ok;
+        };
+
+        runStep("Attach", [&] {
+            return session.Attach(std::unique_ptr<ProcessMemory>(new BorrowedProcessMemory(memory)));
+        });
+        runStep("EnableCapture", [&] { return session.EnableCapture(); });
+        runStep("GetEquipmentBase", [&] { return session.GetEquipmentBase() != 0; });
+        runStep("ReadEquipmentBasics", [&] {
+            short itemId, transmogId, level;
+            uint8_t plus;
+            int quality, skillId, familiarity;
+            bool isUnderworld;
+            return session.ReadEquipmentBasics(&itemId, &transmogId, &level, &plus, &quality, &skillId, &familiarity, &isUnderworld);
+        });
+        runStep("ReadAffixEx x7", [&] {
+            bool ok = true;
+            for (int slot = 0; slot < 7; slot++) {
+                int id, level;
+                uint8_t prefixes[4];
+                ok = session.ReadAffixEx(slot, &id, &level, prefixes) && ok;
+            }
+            return ok;
+        });
+        runStep("DisableCapture", [&] { session.DisableCapture(); return true; });
+        runStep("Detach", [&] { session.Detach(); return true; });
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <trace> [--session [--latency]]\n", argv[0]);
+        return 2;
+    }
+
+    bool sessionMode = false;
+    bool withLatency = false;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--session") == 0) {
+            sessionMode = true;
+        } else if (strcmp(argv[i], "--latency") == 0) {
+            withLatency = true;
+        } else {
+            fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    std::vector<TraceRecord> records;
+    if (!TraceReader::LoadAll(argv[1], records)) {
+        fprintf(stderr, "failed to open trace: %s\n", argv[1]);
+        return 1;
+    }
+
+    printf("%s: %zu records\n\n", argv[1], records.size());
+    PrintSummary(records);
+
+    if (sessionMode) {
+        return ReplaySession(records, withLatency);
+    }
+
+    ReplayOperations(records);
+    return 0;
+}
@@ -0,0 +1,518 @@
+// 数值扫描基准 (比较内核 + 合成快照)
+//
+// 用法:
+//   value_bench [--heap-mb N] [--threads N]
+//   value_bench --check                   只用小快照检查正确性
+//
+// 1. 比较内核: 同一块低熵数据上 SSE2 与逐个比较的吞吐 (GB/s)，两者的位图必须相同
+// 2. 扫描序列: 在本进程内存中生成合成快照 (主模块 + 若干 16MB 堆区域，大部分为 0 和小整数)，
+//    其中一个 int32 "装备字段" 在扫描之间被改写，其余数据随机抖动；按 等于 -> 增大 -> 不变 -> 减小 -> 等于 缩小，
+//    报告每一步的耗时、候选数、候选占用和稠密/稀疏块数，最终只剩该字段
+// 3. --check: 每种值类型、每种比较的首次/再次扫描结果都与逐个比较的参考实现相同，且单线程/多线程结果相同；
+//    超过候选占用上限时扫描失败并保留之前的结果；等于的值超出值类型的取值范围、范围与之不相交时查询无效，
+//    范围只截断超出的一端；浮点 0 按 "等于" 扫描后 +0.0 改为 -0.0 不算变化，结果中是实际的值
+
+#include "value_scan.h"
+#include "snapshot_memory.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr QWORD MODULE_BASE = 0x140000000ull;
+    constexpr QWORD MODULE_SIZE = 0x400000;
+    constexpr QWORD DATA_OFFSET = 0x200000;         // .data 段 (可读写)
+    constexpr QWORD DATA_SIZE = 0x100000;
+    constexpr QWORD HEAP_REGION_SIZE = 0x1000000;
+    constexpr int32_t TRACKED_INITIAL = 7;
+
+    const char* TYPE_NAMES[] = { "", "int8", "int16", "int32", "int64", "float", "double" };
+    const char* COMPARE_NAMES[] = { "", "exact", "range", "changed", "unchanged", "increased", "decreased" };
+
+    double Seconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    ValueScanQuery MakeQuery(int valueType, int compare, uint32_t threads) {
+        ValueScanQuery query;
+        memset(&query, 0, sizeof(query));
+        query.valueType = valueType;
+        query.compare = compare;
+        query.threads = threads;
+        return query;
+    }
+
+    bool IsFloatType(int valueType) {
+        return valueType == VALUE_TYPE_FLOAT || valueType == VALUE_TYPE_DOUBLE;
+    }
+
+    // 查询的值: 整数类型用 intValue，浮点用 floatValue
+    void SetValues(ValueScanQuery& query, double low, double high) {
+        query.intValue = (int64_t)low;
+        query.intValue2 = (int64_t)high;
+        query.floatValue = low;
+        query.floatValue2 = high;
+    }
+
+    // 低熵数据: 约 3/4 的字节为 0，其余为小整数；每 64 字节放一个常见的浮点值
+    void FillLowEntropy(uint8_t* data, size_t size, std::mt19937_64& random) {
+        for (size_t i = 0; i + 8 <= size; i += 8) {
+            uint64_t r = random();
+            uint64_t word = 0;
+            for (int b = 0; b < 8; b++) {
+                uint8_t byte = (uint8_t)(r >> (b * 8));
+                word |= (uint64_t)((byte & 3) == 0 ? (byte >> 4) : 0) << (b * 8);
+            }
+            memcpy(data + i, &word, sizeof(word));
+            if ((i & 63) == 0) {
+                if (r & 0x100) {
+                    float value = (r & 0x200) ? 1.0f : 100.0f;
+                    memcpy(data + i, &value, sizeof(value));
+                } else {
+                    double value = (r & 0x200) ? 1.0 : 100.0;
+                    memcpy(data + i, &value, sizeof(value));
+                }
+            }
+        }
+    }
+
+    void Generate(SnapshotMemory& memory, uint64_t seed, uint32_t heapMb) {
+        std::mt19937_64 random(seed);
+        memory.regions.clear();
+        memory.moduleBase = MODULE_BASE;
+        memory.moduleSize = MODULE_SIZE;
+        memory.regions.push_back({ MODULE_BASE, MemProtect::ExecuteRead, MemType::Image, std::vector<uint8_t>(DATA_OFFSET) });
+        memory.regions.push_back({ MODULE_BASE + DATA_OFFSET, MemProtect::ReadWrite, MemType::Image, std::vector<uint8_t>(DATA_SIZE) });
+        memory.regions.push_back({ MODULE_BASE + DATA_OFFSET + DATA_SIZE, MemProtect::ReadOnly, MemType::Image,
+            std::vector<uint8_t>(MODULE_SIZE - DATA_OFFSET - DATA_SIZE) });
+        FillLowEntropy(memory.regions[1].bytes.data(), DATA_SIZE, random);
+
+        uint32_t heapRegions = std::max(1u, heapMb * 0x100000 / (uint32_t)HEAP_REGION_SIZE);
+        QWORD heapBase = 0x20000000000ull;
+        for (uint32_t i = 0; i < heapRegions; i++) {
+            memory.regions.push_back({ heapBase, MemProtect::ReadWrite, MemType::Private, std::vector<uint8_t>(HEAP_REGION_SIZE) });
+            FillLowEntropy(memory.regions.back().bytes.data(), HEAP_REGION_SIZE, random);
+            heapBase += HEAP_REGION_SIZE + (1 + random() % 16) * 0x10000;
+        }
+    }
+
+    // 游戏运行一段时间: 可读写区域中每 density 个字节约改写一个
+    void Mutate(SnapshotMemory& memory, std::mt19937_64& random, uint32_t density) {
+        for (SnapshotMemory::Region& region : memory.regions) {
+            if (region.protect != MemProtect::ReadWrite) {
+                continue;
+            }
+            for (size_t n = region.bytes.size() / density; n > 0; n--) {
+                uint64_t r = random();
+                uint8_t& byte = region.bytes[(r >> 8) % region.bytes.size()];
+                byte = (uint8_t)(byte + (int8_t)((r & 7) - 3));
+            }
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // 比较内核
+    // ------------------------------------------------------------------
+
+    bool BenchKernels(bool checkOnly) {
+        const size_t size = checkOnly ? 0x100000 : 0x4000000;
+        const int rounds = checkOnly ? 1 : 8;
+        std::mt19937_64 random(0x5EED);
+        std::vector<uint8_t> data(size);
+        FillLowEntropy(data.data(), size, random);
+
+        printf("%-8s %-6s %12s %12s %10s\n", "type", "mode", "scalar GB/s", "simd GB/s", "matches");
+        for (int type = VALUE_TYPE_INT8; type <= VALUE_TYPE_DOUBLE; type++) {
+            for (int compare = VALUE_COMPARE_EXACT; compare <= VALUE_COMPARE_RANGE; compare++) {
+                ValueScanQuery query = MakeQuery(type, compare, 1);
+                SetValues(query, IsFloatType(type) ? 1.0 : 3.0, IsFloatType(type) ? 100.0 : 9.0);
+                const size_t slots = size / GetValueSize(type);
+                std::vector<uint64_t> bits[2] = { std::vector<uint64_t>((slots + 63) / 64), std::vector<uint64_t>((slots + 63) / 64) };
+                double seconds[2] = { 0, 0 };
+                for (int simd = 0; simd < 2; simd++) {
+                    auto start = std::chrono::steady_clock::now();
+                    for (int round = 0; round < rounds; round++) {
+                        CompareValueBlock(data.data(), slots, query, bits[simd].data(), simd != 0);
+                    }
+                    seconds[simd] = Seconds(start);
+                }
+                if (bits[0] != bits[1]) {
+                    fprintf(stderr, "%s %s: SIMD and scalar kernels disagree\n", TYPE_NAMES[type], COMPARE_NAMES[compare]);
+                    return false;
+                }
+                uint64_t matches = 0;
+                for (uint64_t word : bits[0]) {
+                    for (; word != 0; word &= word - 1) {
+                        matches++;
+                    }
+                }
+                double gigabytes = (double)size * rounds / 1e9;
+                printf("%-8s %-6s %12.2f %12.2f %10llu\n", TYPE_NAMES[type], COMPARE_NAMES[compare],
+                    gigabytes / seconds[0], gigabytes / seconds[1], (unsigned long long)matches);
+            }
+        }
+        printf("\n");
+        return true;
+    }
+
+    // ------------------------------------------------------------------
+    // 参考实现 (逐个比较)
+    // ------------------------------------------------------------------
+
+    template <typename T>
+    bool ReferenceMatch(T current, T previous, const ValueScanQuery& query) {
+        T low = IsFloatType(query.valueType) ? (T)query.floatValue : (T)query.intValue;
+        T high = query.compare == VALUE_COMPARE_RANGE
+            ? (IsFloatType(query.valueType) ? (T)query.floatValue2 : (T)query.intValue2)
+            : low;
+        switch (query.compare) {
+        case VALUE_COMPARE_EXACT:
+        case VALUE_COMPARE_RANGE: return current >= low && current <= high;
+        case VALUE_COMPARE_CHANGED: return memcmp(&current, &previous, sizeof(T)) != 0 && !(current == previous);
+        case VALUE_COMPARE_UNCHANGED: return memcmp(&current, &previous, sizeof(T)) == 0 || current == previous;
+        case VALUE_COMPARE_INCREASED: return current > previous;
+        case VALUE_COMPARE_DECREASED: return current < previous;
+        }
+        return false;
+    }
+
+    bool ReferenceMatch(const uint8_t* current, uint64_t previous, const ValueScanQuery& query) {
+        auto match = [&](auto sample) {
+            using T = decltype(sample);
+            T now;
+            T before;
+            memcpy(&now, current, sizeof(T));
+            memcpy(&before, &previous, sizeof(T));
+            return ReferenceMatch<T>(now, before, query);
+        };
+        switch (query.valueType) {
+        case VALUE_TYPE_INT8: return match((int8_t)0);
+        case VALUE_TYPE_INT16: return match((int16_t)0);
+        case VALUE_TYPE_INT32: return match((int32_t)0);
+        case VALUE_TYPE_INT64: return match((int64_t)0);
+        case VALUE_TYPE_FLOAT: return match(0.0f);
+        default: return match(0.0);
+        }
+    }
+
+    void ReferenceFirstScan(SnapshotMemory& memory, const ValueScanQuery& query, std::vector<ValueScanResult>& results) {
+        const size_t valueSize = GetValueSize(query.valueType);
+        results.clear();
+        for (const SnapshotMemory::Region& region : memory.regions) {
+            if (region.protect != MemProtect::ReadWrite) {
+                continue;
+            }
+            for (size_t offset = 0; offset + valueSize <= region.bytes.size(); offset += valueSize) {
+                if (ReferenceMatch(region.bytes.data() + offset, 0, query)) {
+                    ValueScanResult result = { region.base + offset, 0 };
+                    memcpy(&result.value, region.bytes.data() + offset, valueSize);
+                    results.push_back(result);
+                }
+            }
+        }
+    }
+
+    void ReferenceNextScan(SnapshotMemory& memory, const ValueScanQuery& query, std::vector<ValueScanResult>& results) {
+        const size_t valueSize = GetValueSize(query.valueType);
+        std::vector<ValueScanResult> kept;
+        for (const ValueScanResult& previous : results) {
+            const uint8_t* current = memory.At(previous.address, valueSize);
+            if (ReferenceMatch(current, previous.value, query)) {
+                ValueScanResult result = { previous.address, 0 };
+                memcpy(&result.value, current, valueSize);
+                kept.push_back(result);
+            }
+        }
+        results.swap(kept);
+    }
+
+    bool SameResults(const ValueScanner& scanner, const std::vector<ValueScanResult>& expected) {
+        std::vector<ValueScanResult> actual(expected.size() + 1);
+        uint64_t total = scanner.GetResults(actual.data(), actual.size());
+        if (total != expected.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < expected.size(); i++) {
+            if (actual[i].address != expected[i].address || actual[i].value != expected[i].value) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 每种值类型两组序列 (首次按 范围 / 等于)，之后依次使用所有比较，每一步都与参考实现比较
+    bool CheckScans(uint32_t threads) {
+        const int sequences[2][7] = {
+            { VALUE_COMPARE_RANGE, VALUE_COMPARE_CHANGED, VALUE_COMPARE_UNCHANGED, VALUE_COMPARE_INCREASED,
+              VALUE_COMPARE_DECREASED, VALUE_COMPARE_RANGE, VALUE_COMPARE_EXACT },
+            { VALUE_COMPARE_EXACT, VALUE_COMPARE_UNCHANGED, VALUE_COMPARE_RANGE, VALUE_COMPARE_CHANGED,
+              VALUE_COMPARE_INCREASED, VALUE_COMPARE_UNCHANGED, VALUE_COMPARE_DECREASED }
+        };
+
+        for (int type = VALUE_TYPE_INT8; type <= VALUE_TYPE_DOUBLE; type++) {
+            for (int s = 0; s < 2; s++) {
+                SnapshotMemory memory;
+                Generate(memory, 0x4000 + type * 16 + s, 16);
+                std::mt19937_64 random(type * 16 + s);
+                ValueScanner scanners[2];
+                std::vector<ValueScanResult> expected;
+
+                for (int step = 0; step < 7; step++) {
+                    ValueScanQuery query = MakeQuery(type, sequences[s][step], 1);
+                    if (IsFloatType(type)) {
+                        SetValues(query, 1.0, 100.0);
+                    } else {
+                        SetValues(query, step == 0 ? 0 : 1, 12);
+                    }
+                    if (step == 0) {
+                        ReferenceFirstScan(memory, query, expected);
+                    } else {
+                        Mutate(memory, random, 64);
+                        ReferenceNextScan(memory, query, expected);
+                    }
+
+                    for (int run = 0; run < 2; run++) {
+                        query.threads = run == 0 ? 1 : threads;
+                        ValueScanStats stats;
+                        bool ok = step == 0
+                            ? scanners[run].FirstScan(&memory, query, stats)
+                            : scanners[run].NextScan(&memory, query, stats);
+                        if (!ok || stats.candidates != expected.size() || !SameResults(scanners[run], expected)) {
+                            fprintf(stderr, "%s step %d (%s, %u threads): %llu candidates, expected %zu\n",
+                                TYPE_NAMES[type], step, COMPARE_NAMES[query.compare], query.threads,
+                                (unsigned long long)stats.candidates, expected.size());
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+
+        // 候选占用上限: 超过时失败，之前的结果不变
+        SnapshotMemory memory;
+        Generate(memory, 0x77, 16);
+        ValueScanner scanner;
+        ValueScanStats stats;
+        ValueScanQuery query = MakeQuery(VALUE_TYPE_INT32, VALUE_COMPARE_EXACT, threads);
+        SetValues(query, 100, 100);
+        if (!scanner.FirstScan(&memory, query, stats)) {
+            fprintf(stderr, "first scan failed\n");
+            return false;
+        }
+        uint64_t before = scanner.GetCount();
+        query.compare = VALUE_COMPARE_RANGE;
+        query.intValue = 0;
+        query.maxMemoryBytes = 0x10000;
+        if (scanner.FirstScan(&memory, query, stats) || scanner.GetCount() != before || !scanner.HasResults()) {
+            fprintf(stderr, "memory limit was not enforced\n");
+            return false;
+        }
+        // 首次扫描不接受与上一次比较的条件
+        query.compare = VALUE_COMPARE_CHANGED;
+        query.maxMemoryBytes = 0;
+        if (scanner.FirstScan(&memory, query, stats)) {
+            fprintf(stderr, "first scan accepted a relative comparison\n");
+            return false;
+        }
+        return true;
+    }
+
+    bool CheckQueryBounds() {
+        struct Case {
+            int valueType;
+            int compare;
+            double low;
+            double high;
+            bool valid;
+        };
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        const Case cases[] = {
+            { VALUE_TYPE_INT8, VALUE_COMPARE_EXACT, 300, 300, false },
+            { VALUE_TYPE_INT8, VALUE_COMPARE_EXACT, -129, -129, false },
+            { VALUE_TYPE_INT16, VALUE_COMPARE_EXACT, -40000, -40000, false },
+            { VALUE_TYPE_INT16, VALUE_COMPARE_EXACT, -1, -1, true },
+            { VALUE_TYPE_INT8, VALUE_COMPARE_RANGE, 100, 300, true },
+            { VALUE_TYPE_INT8, VALUE_COMPARE_RANGE, 200, 300, false },
+            { VALUE_TYPE_INT8, VALUE_COMPARE_RANGE, -300, -200, false },
+            { VALUE_TYPE_INT32, VALUE_COMPARE_RANGE, 9, 3, false },
+            { VALUE_TYPE_FLOAT, VALUE_COMPARE_EXACT, 1e300, 1e300, false },
+            { VALUE_TYPE_FLOAT, VALUE_COMPARE_RANGE, 0, 1e300, true },
+            { VALUE_TYPE_FLOAT, VALUE_COMPARE_EXACT, nan, nan, false },
+            { VALUE_TYPE_DOUBLE, VALUE_COMPARE_EXACT, 1e300, 1e300, true },
+        };
+        for (const Case& c : cases) {
+            ValueScanQuery query = MakeQuery(c.valueType, c.compare, 1);
+            SetValues(query, c.low, c.high);
+            if (std::isnan(c.low)) {
+                query.intValue = query.intValue2 = 0;
+            }
+            if (IsValidValueQuery(query, true) != c.valid || IsValidValueQuery(query, false) != c.valid) {
+                fprintf(stderr, "%s %s [%g, %g]: expected %s\n", TYPE_NAMES[c.valueType], COMPARE_NAMES[c.compare],
+                    c.low, c.high, c.valid ? "valid" : "invalid");
+                return false;
+            }
+        }
+
+        // int8 范围 [100, 300] 截断为 [100, 127]
+        const int8_t bytes[] = { 100, 127, -128, 99, 0, 101 };
+        ValueScanQuery query = MakeQuery(VALUE_TYPE_INT8, VALUE_COMPARE_RANGE, 1);
+        SetValues(query, 100, 300);
+        for (int simd = 0; simd < 2; simd++) {
+            uint64_t bits = 0;
+            CompareValueBlock((const uint8_t*)bytes, sizeof(bytes), query, &bits, simd != 0);
+            if (bits != 0x23) {
+                fprintf(stderr, "int8 range [100, 300] matched %llx\n", (unsigned long long)bits);
+                return false;
+            }
+        }
+
+        // 浮点 0: +0.0 改为 -0.0 后仍是 "不变"
+        SnapshotMemory memory;
+        memory.regions.push_back({ 0x10000000ull, MemProtect::ReadWrite, MemType::Private, std::vector<uint8_t>(0x1000, 0xFF) });
+        const float positive = 0.0f;
+        const float negative = -0.0f;
+        memcpy(memory.At(0x10000100ull, 4), &positive, 4);
+        ValueScanner changed;
+        ValueScanner scanner;
+        ValueScanStats stats;
+        query = MakeQuery(VALUE_TYPE_FLOAT, VALUE_COMPARE_EXACT, 1);
+        SetValues(query, -0.0, -0.0);
+        bool ok = changed.FirstScan(&memory, query, stats) && scanner.FirstScan(&memory, query, stats) && stats.candidates == 1;
+        memcpy(memory.At(0x10000100ull, 4), &negative, 4);
+        query.compare = VALUE_COMPARE_CHANGED;
+        ok = ok && changed.NextScan(&memory, query, stats) && stats.candidates == 0;
+        query.compare = VALUE_COMPARE_UNCHANGED;
+        ValueScanResult result = {};
+        ok = ok && scanner.NextScan(&memory, query, stats) && stats.candidates == 1 && scanner.GetResults(&result, 1) == 1;
+        if (!ok || result.address != 0x10000100ull || memcmp(&result.value, &negative, 4) != 0) {
+            fprintf(stderr, "+0.0 and -0.0 compared by their bits\n");
+            return false;
+        }
+        return true;
+    }
+
+    // ------------------------------------------------------------------
+    // 扫描序列
+    // ------------------------------------------------------------------
+
+    void PrintRow(const char* step, const ValueScanStats& stats) {
+        printf("%-12s %10.1f %12llu %10.2f %10.1f %8u %8u %8u\n", step, stats.microseconds / 1000.0,
+            (unsigned long long)stats.candidates, stats.memoryBytes / 1048576.0, stats.scannedBytes / 1048576.0,
+            stats.reads, stats.denseBlocks, stats.sparseBlocks);
+    }
+
+    bool BenchSequence(uint32_t heapMb, uint32_t threads) {
+        SnapshotMemory memory;
+        Generate(memory, 0xBEEF, heapMb);
+        std::mt19937_64 random(0xF00D);
+
+        // 被追踪的字段放在某个堆区域中间
+        const SnapshotMemory::Region& heap = memory.regions[3 + (memory.regions.size() - 3) / 2];
+        const QWORD tracked = heap.base + 0x7654 * 4;
+        int32_t value = TRACKED_INITIAL;
+        memcpy(memory.At(tracked, 4), &value, 4);
+
+        struct Step {
+            const char* name;
+            int compare;
+            int32_t newValue;       // 扫描前字段的新值
+        };
+        const Step steps[] = {
+            { "exact 7", VALUE_COMPARE_EXACT, TRACKED_INITIAL },
+            { "increased", VALUE_COMPARE_INCREASED, 9 },
+            { "unchanged", VALUE_COMPARE_UNCHANGED, 9 },
+            { "decreased", VALUE_COMPARE_DECREASED, 3 },
+            { "exact 3", VALUE_COMPARE_EXACT, 3 },
+        };
+
+        printf("heap %u MB, %u threads\n", heapMb, threads);
+        printf("%-12s %10s %12s %10s %10s %8s %8s %8s\n", "step", "ms", "candidates", "store MB", "read MB", "reads", "dense", "sparse");
+
+        ValueScanner scanner;
+        for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+            if (i != 0) {
+                Mutate(memory, random, 256);
+            }
+            memcpy(memory.At(tracked, 4), &steps[i].newValue, 4);
+
+            ValueScanQuery query = MakeQuery(VALUE_TYPE_INT32, steps[i].compare, threads);
+            SetValues(query, steps[i].newValue, steps[i].newValue);
+            ValueScanStats stats;
+            bool ok = i == 0 ? scanner.FirstScan(&memory, query, stats) : scanner.NextScan(&memory, query, stats);
+            if (!ok) {
+                fprintf(stderr, "%s failed\n", steps[i].name);
+                return false;
+            }
+            PrintRow(steps[i].name, stats);
+        }
+
+        ValueScanResult result;
+        if (scanner.GetResults(&result, 1) == 0 || result.address != tracked) {
+            fprintf(stderr, "tracked field lost\n");
+            return false;
+        }
+        printf("remaining: %llu (tracked field at 0x%llX)\n\n", (unsigned long long)scanner.GetCount(), (unsigned long long)tracked);
+
+        // 浮点范围扫描的首次扫描
+        ValueScanQuery query = MakeQuery(VALUE_TYPE_FLOAT, VALUE_COMPARE_RANGE, threads);
+        SetValues(query, 99.5, 100.5);
+        ValueScanStats stats;
+        if (!scanner.FirstScan(&memory, query, stats)) {
+            fprintf(stderr, "float range scan failed\n");
+            return false;
+        }
+        PrintRow("float range", stats);
+        printf("\n");
+        return true;
+    }
+
+    struct Options {
+        uint32_t heapMb = 1024;
+        uint32_t threads = 0;
+        bool checkOnly = false;
+    };
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--check") == 0) {
+            options.checkOnly = true;
+        } else if (strcmp(argv[i], "--heap-mb") == 0 && hasValue) {
+            options.heapMb = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        } else {
+            fprintf(stderr, "usage: %s [--check] [--heap-mb N] [--threads N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (options.checkOnly) {
+        options.heapMb = 32;
+        options.threads = options.threads != 0 ? options.threads : 4;
+    }
+    if (options.heapMb == 0) {
+        fprintf(stderr, "invalid options\n");
+        return 2;
+    }
+    const uint32_t threads = options.threads != 0 ? options.threads : std::max(2u, std::thread::hardware_concurrency());
+
+    bool ok = BenchKernels(options.checkOnly) && BenchSequence(options.heapMb, threads);
+    if (ok && options.checkOnly) {
+        ok = CheckScans(threads) && CheckQueryBounds();
+    }
+    if (!ok) {
+        fprintf(stderr, "value scan checks failed\n");
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "tracing_process_memory.h"
+#include <chrono>
+#include <cstring>
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    uint32_t ElapsedNs(Clock::time_point start) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        return ns > 0xFFFFFFFFll ? 0xFFFFFFFFu : (uint32_t)ns;
+    }
+}
+
+TracingProcessMemory::TracingProcessMemory(std::unique_ptr<ProcessMemory> inner)
+    : m_inner(std::move(inner))
+{
+}
+
+TracingProcessMemory::~TracingProcessMemory() {
+    m_writer.Close();
+}
+
+bool TracingProcessMemory::Read(QWORD address, void* buffer, size_t size, size_t* bytesRead) {
+    size_t read = 0;
+    auto start = Clock::now();
+    bool ok = m_inner->Read(address, buffer, size, &read);
+    uint32_t elapsed = ElapsedNs(start);
+
+    m_writer.AppendRead(ok, elapsed, address, size, buffer, (uint32_t)read);
+
+    if (bytesRead) *bytesRead = read;
+    return ok;
+}
+
+bool TracingProcessMemory::Write(QWORD address, const void* buffer, size_t size) {
+    auto start = Clock::now();
+    bool ok = m_inner->Write(address, buffer, size);
+    m_writer.Append(TraceOp::Write, ok, ElapsedNs(start), address, size, 0, buffer, (uint32_t)size);
+    return ok;
+}
+
+bool TracingProcessMemory::Query(QWORD address, MemoryRegion& outRegion) {
+    auto start = Clock::now();
+    bool ok = m_inner->Query(address, outRegion);
+    uint32_t elapsed = ElapsedNs(start);
+
+    TraceRegion region;
+    region.baseAddress = outRegion.baseAddress;
+    region.regionSize = outRegion.regionSize;
+    region.state = outRegion.state;
+    region.protect = outRegion.protect;
+    region.type = outRegion.type;
+    m_writer.Append(TraceOp::Query, ok, elapsed, address, 0, 0, &region, ok ? (uint32_t)sizeof(region) : 0);
+    return ok;
+}
+
+bool TracingProcessMemory::Protect(QWORD address, size_t size, uint32_t newProtect, uint32_t* oldProtect) {
+    uint32_t old = 0;
+    auto start = Clock::now();
+    bool ok = m_inner->Protect(address, size, newProtect, &old);
+    m_writer.Append(TraceOp::Protect, ok, ElapsedNs(start), address, size, newProtect, &old, sizeof(old));
+
+    if (oldProtect) *oldProtect = old;
+    return ok;
+}
+
+QWORD TracingProcessMemory::Allocate(QWORD preferredAddress, size_t size, uint32_t protect) {
+    auto start = Clock::now();
+    QWORD result = m_inner->Allocate(preferredAddress, size, protect);
+    m_writer.Append(TraceOp::Allocate, result != 0, ElapsedNs(start), preferredAddress, size, protect, &result, sizeof(result));
+    return result;
+}
+
+bool TracingProcessMemory::Free(QWORD address) {
+    auto start = Clock::now();
+    bool ok = m_inner->Free(address);
+    m_writer.Append(TraceOp::Free, ok, ElapsedNs(start), address, 0, 0, nullptr, 0);
+    return ok;
+}
+
+bool TracingProcessMemory::GetMainModule(QWORD& baseAddress, QWORD& moduleSize) {
+    auto start = Clock::now();
+    bool ok = m_inner->GetMainModule(baseAddress, moduleSize);
+    uint64_t payload[2] = { baseAddress, moduleSize };
+    m_writer.Append(TraceOp::GetMainModule, ok, ElapsedNs(start), 0, 0, 0, payload, ok ? (uint32_t)sizeof(payload) : 0);
+    return ok;
+}
+
+void TracingProcessMemory::MarkPhase(const char* phase) {
+    if (phase == nullptr || m_phase == phase) {
+        return;
+    }
+
+    m_phase = phase;
+    m_writer.Append(TraceOp::Phase, true, 0, 0, 0, 0, phase, (uint32_t)strlen(phase));
+    m_inner->MarkPhase(phase);
+}
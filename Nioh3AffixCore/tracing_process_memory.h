@@ -0,0 +1,37 @@
+#pragma once
+
+#include "memory_trace.h"
+#include "process_memory.h"
+#include <memory>
+#include <string>
+
+// 把每个远程操作 (参数、结果、耗时、读写内容) 记录到跟踪文件的后端装饰器
+// 跟踪文件可在任意平台上用 tools/trace_replay 回放 (见 simulated_process_memory.h)。
+// 与其它后端一样不做内部加锁，由会话锁串行化调用。
+// 不转发 MapShared: 共享视图上的访问无法被记录，跟踪时退回到远程读写，保证回放时能看到全部访问。
+class TracingProcessMemory : public ProcessMemory {
+public:
+    explicit TracingProcessMemory(std::unique_ptr<ProcessMemory> inner);
+    ~TracingProcessMemory() override;
+
+    bool Open(const char* path) { return m_writer.Open(path); }
+    bool IsOpen() const { return m_writer.IsOpen(); }
+
+    bool Read(QWORD address, void* buffer, size_t size, size_t* bytesRead = nullptr) override;
+    bool Write(QWORD address, const void* buffer, size_t size) override;
+    bool Query(QWORD address, MemoryRegion& outRegion) override;
+    bool Protect(QWORD address, size_t size, uint32_t newProtect, uint32_t* oldProtect) override;
+    QWORD Allocate(QWORD preferredAddress, size_t size, uint32_t protect) override;
+    bool Free(QWORD address) override;
+    bool GetMainModule(QWORD& baseAddress, QWORD& moduleSize) override;
+    void MarkPhase(const char* phase) override;
+
+    // 挂起线程不访问内存，直接转发 (不记录)
+    bool SuspendThreads(std::vector<QWORD>* outInstructionPointers) override { return m_inner->SuspendThreads(outInstructionPointers); }
+    void ResumeThreads() override { m_inner->ResumeThreads(); }
+
+private:
+    std::unique_ptr<ProcessMemory> m_inner;
+    TraceWriter m_writer;
+    std::string m_phase;    // 阶段未变化时不重复记录
+};
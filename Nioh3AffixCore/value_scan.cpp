@@ -0,0 +1,640 @@
+#include "value_scan.h"
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+
+// x86-64 上 SSE2 总是可用
+#if defined(__SSE2__) || defined(_M_X64)
+#define VALUE_SCAN_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+    template <typename T>
+    struct Bounds {
+        T low;
+        T high;
+    };
+
+    template <typename T>
+    T Load(const uint8_t* data) {
+        T value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    template <typename T>
+    bool InBounds(T value, const Bounds<T>& bounds) {
+        // 浮点 NaN 不在任何范围内
+        return !(value < bounds.low) && !(bounds.high < value);
+    }
+
+    template <typename T>
+    T ClampToType(int64_t value) {
+        if (value < (int64_t)std::numeric_limits<T>::min()) return std::numeric_limits<T>::min();
+        if (value > (int64_t)std::numeric_limits<T>::max()) return std::numeric_limits<T>::max();
+        return (T)value;
+    }
+
+    // 超出 float 取值范围的有限值截断到最大有限值 (直接转换是未定义行为)
+    template <typename T>
+    T ClampToFloat(double value) {
+        const double max = (double)std::numeric_limits<T>::max();
+        if (std::isinf(value)) return (T)value;
+        return (T)std::min(std::max(value, -max), max);
+    }
+
+    // 等于时 low == high；范围超出类型取值范围的一端截断 (IsValidValueQuery 已拒绝等于的值超出范围和范围与类型不相交)
+    template <typename T>
+    Bounds<T> MakeBounds(const ValueScanQuery& query) {
+        const bool range = query.compare == VALUE_COMPARE_RANGE;
+        Bounds<T> bounds;
+        if constexpr (std::is_floating_point<T>::value) {
+            bounds.low = ClampToFloat<T>(query.floatValue);
+            bounds.high = range ? ClampToFloat<T>(query.floatValue2) : bounds.low;
+        } else {
+            bounds.low = ClampToType<T>(query.intValue);
+            bounds.high = range ? ClampToType<T>(query.intValue2) : bounds.low;
+        }
+        return bounds;
+    }
+
+    template <typename T>
+    uint64_t RawBits(T value) {
+        uint64_t bits = 0;
+        memcpy(&bits, &value, sizeof(value));
+        return bits;
+    }
+
+    // 按值比较，+0.0 与 -0.0 相同；位相同的 NaN 也算相同
+    template <typename T>
+    bool SameValue(T current, T previous) {
+        return RawBits(current) == RawBits(previous) || current == previous;
+    }
+
+    template <typename T>
+    bool MatchNext(T current, T previous, int compare, const Bounds<T>& bounds) {
+        switch (compare) {
+        case VALUE_COMPARE_EXACT:
+        case VALUE_COMPARE_RANGE:
+            return InBounds(current, bounds);
+        case VALUE_COMPARE_CHANGED:
+            return !SameValue(current, previous);
+        case VALUE_COMPARE_UNCHANGED:
+            return SameValue(current, previous);
+        case VALUE_COMPARE_INCREASED:
+            return previous < current;
+        case VALUE_COMPARE_DECREASED:
+            return current < previous;
+        }
+        return false;
+    }
+
+#ifdef VALUE_SCAN_SSE2
+    // 每种类型的 16 字节比较；Bits 把每个通道的全 0/全 1 掩码压缩为每通道一位
+    template <typename T>
+    struct Simd;
+
+    template <>
+    struct Simd<int8_t> {
+        static constexpr bool HAS_RANGE = true;
+        static __m128i Splat(int8_t v) { return _mm_set1_epi8(v); }
+        static __m128i Equal(__m128i v, __m128i x) { return _mm_cmpeq_epi8(v, x); }
+        static __m128i Outside(__m128i v, __m128i lo, __m128i hi) { return _mm_or_si128(_mm_cmpgt_epi8(lo, v), _mm_cmpgt_epi8(v, hi)); }
+        static uint64_t Bits(__m128i m) { return (uint32_t)_mm_movemask_epi8(m); }
+    };
+
+    template <>
+    struct Simd<int16_t> {
+        static constexpr bool HAS_RANGE = true;
+        static __m128i Splat(int16_t v) { return _mm_set1_epi16(v); }
+        static __m128i Equal(__m128i v, __m128i x) { return _mm_cmpeq_epi16(v, x); }
+        static __m128i Outside(__m128i v, __m128i lo, __m128i hi) { return _mm_or_si128(_mm_cmpgt_epi16(lo, v), _mm_cmpgt_epi16(v, hi)); }
+        static uint64_t Bits(__m128i m) { return (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(m, m)) & 0xFF; }
+    };
+
+    template <>
+    struct Simd<int32_t> {
+        static constexpr bool HAS_RANGE = true;
+        static __m128i Splat(int32_t v) { return _mm_set1_epi32(v); }
+        static __m128i Equal(__m128i v, __m128i x) { return _mm_cmpeq_epi32(v, x); }
+        static __m128i Outside(__m128i v, __m128i lo, __m128i hi) { return _mm_or_si128(_mm_cmpgt_epi32(lo, v), _mm_cmpgt_epi32(v, hi)); }
+        static uint64_t Bits(__m128i m) { return (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(m)); }
+    };
+
+    // SSE2 没有 64 位比较: 相等由两个 32 位相等合成，范围逐个比较
+    template <>
+    struct Simd<int64_t> {
+        static constexpr bool HAS_RANGE = false;
+        static __m128i Splat(int64_t v) { return _mm_set1_epi64x(v); }
+        static __m128i Equal(__m128i v, __m128i x) {
+            __m128i e = _mm_cmpeq_epi32(v, x);
+            return _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+        static __m128i Outside(__m128i v, __m128i, __m128i) { return v; }
+        static uint64_t Bits(__m128i m) { return (uint32_t)_mm_movemask_pd(_mm_castsi128_pd(m)); }
+    };
+
+    template <>
+    struct Simd<float> {
+        static constexpr bool HAS_RANGE = true;
+        static __m128i Splat(float v) { return _mm_castps_si128(_mm_set1_ps(v)); }
+        static __m128i Equal(__m128i v, __m128i x) { return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(v), _mm_castsi128_ps(x))); }
+        // NaN 的比较结果为假，NaN 落在 "外面"
+        static __m128i Outside(__m128i v, __m128i lo, __m128i hi) {
+            __m128 inside = _mm_and_ps(_mm_cmpge_ps(_mm_castsi128_ps(v), _mm_castsi128_ps(lo)),
+                _mm_cmple_ps(_mm_castsi128_ps(v), _mm_castsi128_ps(hi)));
+            return _mm_castps_si128(_mm_xor_ps(inside, _mm_castsi128_ps(_mm_set1_epi32(-1))));
+        }
+        static uint64_t Bits(__m128i m) { return (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(m)); }
+    };
+
+    template <>
+    struct Simd<double> {
+        static constexpr bool HAS_RANGE = true;
+        static __m128i Splat(double v) { return _mm_castpd_si128(_mm_set1_pd(v)); }
+        static __m128i Equal(__m128i v, __m128i x) { return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(v), _mm_castsi128_pd(x))); }
+        static __m128i Outside(__m128i v, __m128i lo, __m128i hi) {
+            __m128d inside = _mm_and_pd(_mm_cmpge_pd(_mm_castsi128_pd(v), _mm_castsi128_pd(lo)),
+                _mm_cmple_pd(_mm_castsi128_pd(v), _mm_castsi128_pd(hi)));
+            return _mm_castpd_si128(_mm_xor_pd(inside, _mm_castsi128_pd(_mm_set1_epi32(-1))));
+        }
+        static uint64_t Bits(__m128i m) { return (uint32_t)_mm_movemask_pd(_mm_castsi128_pd(m)); }
+    };
+
+    // 处理 [0, 返回值) 的槽位；每次 16 字节，通道数整除 64，结果不会跨位图字
+    template <typename T, bool Exact>
+    size_t CompareSimd(const uint8_t* data, size_t slots, const Bounds<T>& bounds, uint64_t* outBits) {
+        constexpr size_t LANES = 16 / sizeof(T);
+        const __m128i low = Simd<T>::Splat(bounds.low);
+        const __m128i high = Simd<T>::Splat(bounds.high);
+        size_t i = 0;
+        for (; i + LANES <= slots; i += LANES) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(data + i * sizeof(T)));
+            uint64_t bits = Exact
+                ? Simd<T>::Bits(Simd<T>::Equal(v, low))
+                : Simd<T>::Bits(Simd<T>::Outside(v, low, high)) ^ ((1ull << LANES) - 1);
+            outBits[i >> 6] |= bits << (i & 63);
+        }
+        return i;
+    }
+#endif
+
+    template <typename T>
+    void CompareTyped(const uint8_t* data, size_t slots, const ValueScanQuery& query, uint64_t* outBits, bool useSimd) {
+        const Bounds<T> bounds = MakeBounds<T>(query);
+        memset(outBits, 0, (slots + 63) / 64 * sizeof(uint64_t));
+
+        size_t i = 0;
+#ifdef VALUE_SCAN_SSE2
+        if (useSimd) {
+            if (query.compare == VALUE_COMPARE_EXACT) {
+                i = CompareSimd<T, true>(data, slots, bounds, outBits);
+            } else if (Simd<T>::HAS_RANGE) {
+                i = CompareSimd<T, false>(data, slots, bounds, outBits);
+            }
+        }
+#else
+        (void)useSimd;
+#endif
+        for (; i < slots; i++) {
+            if (InBounds(Load<T>(data + i * sizeof(T)), bounds)) {
+                outBits[i >> 6] |= 1ull << (i & 63);
+            }
+        }
+    }
+
+    // 按值类型分派 Work<T>
+    template <template <typename> class Work, typename... Args>
+    auto DispatchType(int valueType, Args&&... args) {
+        switch (valueType) {
+        case VALUE_TYPE_INT8: return Work<int8_t>::Run(std::forward<Args>(args)...);
+        case VALUE_TYPE_INT16: return Work<int16_t>::Run(std::forward<Args>(args)...);
+        case VALUE_TYPE_INT32: return Work<int32_t>::Run(std::forward<Args>(args)...);
+        case VALUE_TYPE_INT64: return Work<int64_t>::Run(std::forward<Args>(args)...);
+        case VALUE_TYPE_FLOAT: return Work<float>::Run(std::forward<Args>(args)...);
+        default: return Work<double>::Run(std::forward<Args>(args)...);
+        }
+    }
+
+    template <typename T>
+    struct CompareWork {
+        static void Run(const uint8_t* data, size_t slots, const ValueScanQuery& query, uint64_t* outBits, bool useSimd) {
+            CompareTyped<T>(data, slots, query, outBits, useSimd);
+        }
+    };
+
+    template <typename T>
+    struct ExactBitsWork {
+        static uint64_t Run(const ValueScanQuery& query) { return RawBits(MakeBounds<T>(query).low); }
+    };
+
+    // 按 "等于" 缩小后的值是否只有一种表示 (可以不保存)；浮点 0 同时匹配 +0.0 和 -0.0
+    template <typename T>
+    struct UniformWork {
+        static bool Run(const ValueScanQuery& query) {
+            if (query.compare != VALUE_COMPARE_EXACT) {
+                return false;
+            }
+            return !std::is_floating_point<T>::value || MakeBounds<T>(query).low != 0;
+        }
+    };
+
+    // 等于的值必须能用值类型表示；范围两端有序且与类型的取值范围相交，超出的一端由 MakeBounds 截断
+    template <typename T>
+    struct QueryBoundsWork {
+        static bool Run(const ValueScanQuery& query) {
+            const bool range = query.compare == VALUE_COMPARE_RANGE;
+            if constexpr (std::is_floating_point<T>::value) {
+                const double low = query.floatValue;
+                const double high = range ? query.floatValue2 : low;
+                const double max = (double)std::numeric_limits<T>::max();
+                if (std::isnan(low) || std::isnan(high) || high < low) {
+                    return false;
+                }
+                return (low <= max || std::isinf(low)) && (high >= -max || std::isinf(high));
+            } else {
+                const int64_t low = query.intValue;
+                const int64_t high = range ? query.intValue2 : low;
+                return low <= high && low <= (int64_t)std::numeric_limits<T>::max() && high >= (int64_t)std::numeric_limits<T>::min();
+            }
+        }
+    };
+
+    // 再次扫描: 比较一个候选，current / previous 为原始字节
+    template <typename T>
+    struct MatchWork {
+        static bool Run(const uint8_t* current, const uint8_t* previous, const ValueScanQuery& query) {
+            return MatchNext(Load<T>(current), Load<T>(previous), query.compare, MakeBounds<T>(query));
+        }
+    };
+
+    uint64_t CountBits(const std::vector<uint64_t>& bits) {
+        uint64_t count = 0;
+        for (uint64_t word : bits) {
+            count += std::bitset<64>(word).count();
+        }
+        return count;
+    }
+
+    uint32_t LowestBit(uint64_t word) {
+        return (uint32_t)std::bitset<64>((word & (0 - word)) - 1).count();
+    }
+
+    uint64_t ElapsedMicroseconds(std::chrono::steady_clock::time_point start) {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+size_t GetValueSize(int valueType) {
+    switch (valueType) {
+    case VALUE_TYPE_INT8: return 1;
+    case VALUE_TYPE_INT16: return 2;
+    case VALUE_TYPE_INT32: return 4;
+    case VALUE_TYPE_INT64: return 8;
+    case VALUE_TYPE_FLOAT: return 4;
+    case VALUE_TYPE_DOUBLE: return 8;
+    }
+    return 0;
+}
+
+bool IsValidValueQuery(const ValueScanQuery& query, bool firstScan) {
+    if (GetValueSize(query.valueType) == 0) {
+        return false;
+    }
+    if (query.compare == VALUE_COMPARE_EXACT || query.compare == VALUE_COMPARE_RANGE) {
+        return DispatchType<QueryBoundsWork>(query.valueType, query);
+    }
+    return !firstScan && query.compare > VALUE_COMPARE_RANGE && query.compare <= VALUE_COMPARE_DECREASED;
+}
+
+void CompareValueBlock(const uint8_t* data, size_t slots, const ValueScanQuery& query, uint64_t* outBits, bool useSimd) {
+    DispatchType<CompareWork>(query.valueType, data, slots, query, outBits, useSimd);
+}
+
+// ---------------------------------------------------------------------------
+// ValueScanner
+// ---------------------------------------------------------------------------
+
+ValueScanner::ValueScanner()
+    : m_valueType(0)
+{
+}
+
+void ValueScanner::Reset() {
+    m_blocks.clear();
+    m_blocks.shrink_to_fit();
+    m_valueType = 0;
+}
+
+uint64_t ValueScanner::GetCount() const {
+    uint64_t count = 0;
+    for (const Block& block : m_blocks) {
+        count += block.count;
+    }
+    return count;
+}
+
+uint64_t ValueScanner::GetMemoryUsage() const {
+    uint64_t bytes = 0;
+    for (const Block& block : m_blocks) {
+        bytes += block.MemoryBytes();
+    }
+    return bytes;
+}
+
+void ValueScanner::StoreCandidates(Block& block, std::vector<uint64_t>& bits, std::vector<uint8_t>& values, size_t valueSize) {
+    (void)valueSize;
+    block.count = (uint32_t)CountBits(bits);
+    block.bits.clear();
+    block.indices.clear();
+    block.values.clear();
+    if (block.count == 0) {
+        return;
+    }
+
+    // 位图 slots / 8 字节，数组每个候选 4 字节
+    block.dense = (uint64_t)block.count * sizeof(uint32_t) > bits.size() * sizeof(uint64_t);
+    if (block.dense) {
+        block.bits.swap(bits);
+    } else {
+        block.indices.reserve(block.count);
+        for (size_t w = 0; w < bits.size(); w++) {
+            for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                block.indices.push_back((uint32_t)(w * 64 + LowestBit(word)));
+            }
+        }
+    }
+    if (!block.uniform) {
+        block.values.swap(values);
+        block.values.shrink_to_fit();
+    }
+}
+
+template <typename Visit>
+void ValueScanner::ForEachCandidate(const Block& block, Visit&& visit) {
+    if (!block.dense) {
+        for (size_t i = 0; i < block.indices.size(); i++) {
+            visit(block.indices[i], i);
+        }
+        return;
+    }
+    size_t ordinal = 0;
+    for (size_t w = 0; w < block.bits.size(); w++) {
+        for (uint64_t word = block.bits[w]; word != 0; word &= word - 1) {
+            visit((uint32_t)(w * 64 + LowestBit(word)), ordinal++);
+        }
+    }
+}
+
+bool ValueScanner::FirstScan(ProcessMemory* memory, const ValueScanQuery& query, ValueScanStats& outStats) {
+    auto start = std::chrono::steady_clock::now();
+    memset(&outStats, 0, sizeof(outStats));
+    if (!IsValidValueQuery(query, true)) {
+        return false;
+    }
+
+    std::vector<MemoryRegion> regions;
+    if (!CollectDataRegions(memory, query.startAddress, query.endAddress, regions)) {
+        return false;
+    }
+
+    struct Chunk {
+        QWORD address;
+        uint32_t size;
+    };
+    std::vector<Chunk> chunks;
+    for (const MemoryRegion& region : regions) {
+        for (QWORD offset = 0; offset < region.regionSize; offset += ValueScanLayout::BLOCK_SIZE) {
+            chunks.push_back({ region.baseAddress + offset,
+                (uint32_t)std::min<QWORD>(ValueScanLayout::BLOCK_SIZE, region.regionSize - offset) });
+        }
+    }
+
+    const size_t valueSize = GetValueSize(query.valueType);
+    const uint32_t threads = ResolveScanThreads(query.threads);
+    const uint64_t limit = query.maxMemoryBytes != 0 ? query.maxMemoryBytes : ValueScanLayout::DEFAULT_MAX_MEMORY_BYTES;
+    const bool uniform = DispatchType<UniformWork>(query.valueType, query);
+    const uint64_t exactBits = DispatchType<ExactBitsWork>(query.valueType, query);
+
+    std::vector<Block> blocks(chunks.size());
+    std::mutex readLock;
+    std::atomic<size_t> nextChunk(0);
+    std::atomic<uint64_t> memoryBytes(0);
+    std::atomic<uint64_t> scannedBytes(0);
+    std::atomic<uint32_t> reads(0);
+    std::atomic<bool> overflow(false);
+
+    RunScanWorkers(threads, [&](uint32_t) {
+        std::vector<uint8_t> buffer(ValueScanLayout::BLOCK_SIZE);
+        std::vector<uint64_t> bits;
+        std::vector<uint8_t> values;
+
+        for (size_t i = nextChunk++; i < chunks.size() && !overflow; i = nextChunk++) {
+            const Chunk& chunk = chunks[i];
+            const size_t slots = chunk.size / valueSize;
+
+            // 整块读取；失败时 (扫描期间有页被释放) 逐页读取，读不到的页不产生候选
+            std::vector<uint32_t> failedPages;
+            bool ok;
+            {
+                std::lock_guard<std::mutex> lock(readLock);
+                ok = memory->Read(chunk.address, buffer.data(), chunk.size);
+                reads++;
+                for (uint32_t offset = 0; !ok && offset < chunk.size; offset += RegionScanLayout::PAGE_SIZE) {
+                    reads++;
+                    if (!memory->Read(chunk.address + offset, buffer.data() + offset, RegionScanLayout::PAGE_SIZE)) {
+                        failedPages.push_back(offset);
+                    }
+                }
+            }
+            scannedBytes += chunk.size;
+
+            bits.resize((slots + 63) / 64);
+            CompareValueBlock(buffer.data(), slots, query, bits.data(), true);
+            for (uint32_t offset : failedPages) {
+                for (size_t slot = offset / valueSize; slot < (offset + RegionScanLayout::PAGE_SIZE) / valueSize; slot++) {
+                    bits[slot >> 6] &= ~(1ull << (slot & 63));
+                }
+            }
+
+            Block& block = blocks[i];
+            block.address = chunk.address;
+            block.slots = (uint32_t)slots;
+            block.uniform = uniform;
+            block.uniformValue = uniform ? exactBits : 0;
+            values.clear();
+            if (!uniform) {
+                for (size_t w = 0; w < bits.size(); w++) {
+                    for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                        size_t slot = w * 64 + LowestBit(word);
+                        const uint8_t* value = buffer.data() + slot * valueSize;
+                        values.insert(values.end(), value, value + valueSize);
+                    }
+                }
+            }
+            StoreCandidates(block, bits, values, valueSize);
+            if (memoryBytes.fetch_add(block.MemoryBytes()) + block.MemoryBytes() > limit) {
+                overflow = true;
+            }
+        }
+    });
+
+    outStats.memoryBytes = memoryBytes;
+    outStats.scannedBytes = scannedBytes;
+    outStats.reads = reads;
+    outStats.threads = threads;
+    if (overflow) {
+        outStats.microseconds = ElapsedMicroseconds(start);
+        return false;
+    }
+
+    m_blocks.clear();
+    for (Block& block : blocks) {
+        if (block.count != 0) {
+            m_blocks.push_back(std::move(block));
+        }
+    }
+    m_valueType = query.valueType;
+
+    for (const Block& block : m_blocks) {
+        outStats.candidates += block.count;
+        (block.dense ? outStats.denseBlocks : outStats.sparseBlocks)++;
+    }
+    outStats.microseconds = ElapsedMicroseconds(start);
+    return true;
+}
+
+bool ValueScanner::NextScan(ProcessMemory* memory, const ValueScanQuery& query, ValueScanStats& outStats) {
+    auto start = std::chrono::steady_clock::now();
+    memset(&outStats, 0, sizeof(outStats));
+    if (!HasResults() || query.valueType != m_valueType || !IsValidValueQuery(query, false)) {
+        return false;
+    }
+
+    const size_t valueSize = GetValueSize(query.valueType);
+    const uint32_t threads = ResolveScanThreads(query.threads);
+    const uint64_t limit = query.maxMemoryBytes != 0 ? query.maxMemoryBytes : ValueScanLayout::DEFAULT_MAX_MEMORY_BYTES;
+    const bool exactUniform = DispatchType<UniformWork>(query.valueType, query);
+    const uint64_t exactBits = DispatchType<ExactBitsWork>(query.valueType, query);
+
+    std::vector<Block> blocks(m_blocks.size());
+    std::mutex readLock;
+    std::atomic<size_t> nextBlock(0);
+    std::atomic<uint64_t> memoryBytes(0);
+    std::atomic<uint64_t> scannedBytes(0);
+    std::atomic<uint32_t> reads(0);
+    std::atomic<bool> overflow(false);
+
+    RunScanWorkers(threads, [&](uint32_t) {
+        std::vector<uint8_t> buffer(ValueScanLayout::BLOCK_SIZE);
+        std::vector<uint32_t> slots;
+        std::vector<uint64_t> bits;
+        std::vector<uint8_t> values;
+
+        for (size_t i = nextBlock++; i < m_blocks.size() && !overflow; i = nextBlock++) {
+            const Block& old = m_blocks[i];
+            slots.clear();
+            ForEachCandidate(old, [&](uint32_t slot, size_t) { slots.push_back(slot); });
+
+            // 相邻的候选合并为一次读取；读不到的区间中的候选淘汰
+            std::vector<uint8_t> readable(slots.size(), 0);
+            for (size_t first = 0; first < slots.size();) {
+                size_t last = first + 1;
+                while (last < slots.size() &&
+                    (uint64_t)(slots[last] - slots[last - 1] - 1) * valueSize <= ValueScanLayout::MERGE_GAP) {
+                    last++;
+                }
+                size_t spanStart = slots[first] * valueSize;
+                size_t spanSize = (slots[last - 1] + 1) * valueSize - spanStart;
+                bool ok;
+                {
+                    std::lock_guard<std::mutex> lock(readLock);
+                    ok = memory->Read(old.address + spanStart, buffer.data() + spanStart, spanSize);
+                    reads++;
+                }
+                scannedBytes += spanSize;
+                std::fill(readable.begin() + first, readable.begin() + last, (uint8_t)(ok ? 1 : 0));
+                first = last;
+            }
+
+            Block& block = blocks[i];
+            block.address = old.address;
+            block.slots = old.slots;
+            // 按 "等于" 缩小后值都相同 (浮点 0 除外)；统一的值经过 "不变" 仍然统一
+            block.uniform = exactUniform || (old.uniform && query.compare == VALUE_COMPARE_UNCHANGED);
+            block.uniformValue = exactUniform ? exactBits : old.uniformValue;
+
+            bits.assign((old.slots + 63) / 64, 0);
+            values.clear();
+            for (size_t k = 0; k < slots.size(); k++) {
+                if (!readable[k]) {
+                    continue;
+                }
+                const uint8_t* current = buffer.data() + (size_t)slots[k] * valueSize;
+                const uint8_t* previous = old.uniform
+                    ? (const uint8_t*)&old.uniformValue
+                    : old.values.data() + k * valueSize;
+                if (!DispatchType<MatchWork>(query.valueType, current, previous, query)) {
+                    continue;
+                }
+                bits[slots[k] >> 6] |= 1ull << (slots[k] & 63);
+                if (!block.uniform) {
+                    values.insert(values.end(), current, current + valueSize);
+                }
+            }
+            StoreCandidates(block, bits, values, valueSize);
+            if (memoryBytes.fetch_add(block.MemoryBytes()) + block.MemoryBytes() > limit) {
+                overflow = true;
+            }
+        }
+    });
+
+    outStats.memoryBytes = memoryBytes;
+    outStats.scannedBytes = scannedBytes;
+    outStats.reads = reads;
+    outStats.threads = threads;
+    if (overflow) {
+        outStats.microseconds = ElapsedMicroseconds(start);
+        return false;
+    }
+
+    m_blocks.clear();
+    for (Block& block : blocks) {
+        if (block.count != 0) {
+            m_blocks.push_back(std::move(block));
+        }
+    }
+    for (const Block& block : m_blocks) {
+        outStats.candidates += block.count;
+        (block.dense ? outStats.denseBlocks : outStats.sparseBlocks)++;
+    }
+    outStats.microseconds = ElapsedMicroseconds(start);
+    return true;
+}
+
+uint64_t ValueScanner::GetResults(ValueScanResult* outResults, uint64_t capacity) const {
+    const size_t valueSize = GetValueSize(m_valueType);
+    uint64_t written = 0;
+    for (const Block& block : m_blocks) {
+        if (outResults == nullptr || written >= capacity) {
+            break;
+        }
+        ForEachCandidate(block, [&](uint32_t slot, size_t ordinal) {
+            if (written >= capacity) {
+                return;
+            }
+            ValueScanResult& result = outResults[written++];
+            result.address = block.address + (QWORD)slot * valueSize;
+            result.value = 0;
+            memcpy(&result.value, block.uniform ? (const uint8_t*)&block.uniformValue : block.values.data() + ordinal * valueSize, valueSize);
+        });
+    }
+    return GetCount();
+}
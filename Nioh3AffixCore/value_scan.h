@@ -0,0 +1,133 @@
+#pragma once
+
+#include "process_memory.h"
+#include "region_scan.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 数值扫描 (首次扫描 / 再次扫描)
+//
+// 用于在运行时定位装备记录中未知字段的偏移: 首次扫描在所有可写数据区域中找出等于某值 (或在某范围内) 的位置，
+// 之后游戏中改变该值，再次扫描只检查上一次的候选并按 变化/不变/增大/减小/等于/范围 缩小。
+//
+// 候选按块保存 (每块对应区域中 BLOCK_SIZE 字节，槽位按值的大小对齐):
+//   - 稠密块: 每个槽位一位的位图；稀疏块: 候选槽位序号的有序数组 (u32)；每块取两者中较小的一种
+//   - 每个候选上一次读到的值按槽位顺序紧凑保存；首次按 "等于" 扫描时所有候选的值相同，不保存
+//   - 候选 (位图/数组/值) 的总占用受 maxMemoryBytes 限制，超过时本次扫描失败，保留之前的结果
+// 首次扫描整块读取并用 SSE2 比较 (每次 16 字节，结果直接写入位图)；再次扫描把相邻的候选合并为一次读取，逐个比较。
+// 目标进程的读取在内部串行 (后端不必线程安全)，比较和候选整理在多个线程上并行。
+//
+// 首次扫描只支持 等于 / 范围: 其它比较需要先保存全部内存的值，与限制内存占用的目标不符。
+namespace ValueScanLayout {
+    constexpr uint32_t BLOCK_SIZE = 0x100000;
+    constexpr uint32_t MERGE_GAP = 0x1000;                  // 再次扫描时相距不超过这么多的候选合并为一次读取
+    constexpr uint64_t DEFAULT_MAX_MEMORY_BYTES = 256ull * 1024 * 1024;
+}
+
+// 与导出函数 SessionFirstScan / SessionNextScan 共用
+enum ValueType {
+    VALUE_TYPE_INT8 = 1,
+    VALUE_TYPE_INT16 = 2,
+    VALUE_TYPE_INT32 = 3,
+    VALUE_TYPE_INT64 = 4,
+    VALUE_TYPE_FLOAT = 5,
+    VALUE_TYPE_DOUBLE = 6
+};
+
+enum ValueCompare {
+    VALUE_COMPARE_EXACT = 1,        // 等于 intValue / floatValue
+    VALUE_COMPARE_RANGE = 2,        // 在 [value, value2] 内
+    VALUE_COMPARE_CHANGED = 3,      // 与上一次扫描读到的值比较 (只用于再次扫描)
+    VALUE_COMPARE_UNCHANGED = 4,
+    VALUE_COMPARE_INCREASED = 5,
+    VALUE_COMPARE_DECREASED = 6
+};
+
+// 整数按有符号比较，浮点用 floatValue / floatValue2
+struct ValueScanQuery {
+    int32_t valueType;          // ValueType (再次扫描时必须与首次相同)
+    int32_t compare;            // ValueCompare
+    int64_t intValue;
+    int64_t intValue2;
+    double floatValue;
+    double floatValue2;
+    QWORD startAddress;         // 首次扫描的地址范围，endAddress 为 0 表示到用户空间末尾
+    QWORD endAddress;
+    uint64_t maxMemoryBytes;    // 候选占用上限，0 表示默认
+    uint32_t threads;           // 0 表示按 CPU 核数
+    uint32_t reserved;
+};
+
+struct ValueScanStats {
+    uint64_t candidates;
+    uint64_t memoryBytes;       // 候选占用 (位图 + 数组 + 值)
+    uint64_t scannedBytes;      // 从目标进程读取的字节数
+    uint64_t microseconds;
+    uint32_t reads;
+    uint32_t denseBlocks;
+    uint32_t sparseBlocks;
+    uint32_t threads;
+};
+
+// 一个候选 (与导出函数 SessionGetScanResults 共用)
+struct ValueScanResult {
+    QWORD address;
+    uint64_t value;             // 最近一次扫描读到的值 (按值类型的原始字节，高位补 0)
+};
+
+size_t GetValueSize(int valueType);
+
+// 等于的值超出值类型的取值范围、范围两端颠倒或与取值范围不相交、浮点值为 NaN 时无效
+// (范围只截断超出取值范围的一端)；变化/不变按值比较，浮点 +0.0 与 -0.0 视为相同
+bool IsValidValueQuery(const ValueScanQuery& query, bool firstScan);
+
+// 比较一块连续的槽位 (首次扫描的内核)，第 i 个槽位匹配时置 outBits 的第 i 位
+// useSimd 为 false 时使用逐个比较的实现 (用于基准对比和校验)
+void CompareValueBlock(const uint8_t* data, size_t slots, const ValueScanQuery& query, uint64_t* outBits, bool useSimd);
+
+class ValueScanner {
+public:
+    ValueScanner();
+
+    ValueScanner(const ValueScanner&) = delete;
+    ValueScanner& operator=(const ValueScanner&) = delete;
+
+    bool FirstScan(ProcessMemory* memory, const ValueScanQuery& query, ValueScanStats& outStats);
+    bool NextScan(ProcessMemory* memory, const ValueScanQuery& query, ValueScanStats& outStats);
+    void Reset();
+
+    bool HasResults() const { return m_valueType != 0; }
+    int32_t GetValueType() const { return m_valueType; }
+    uint64_t GetCount() const;
+    uint64_t GetMemoryUsage() const;
+
+    // 按地址顺序输出前 capacity 个候选，返回总数
+    uint64_t GetResults(ValueScanResult* outResults, uint64_t capacity) const;
+
+private:
+    struct Block {
+        QWORD address;
+        uint32_t slots;
+        uint32_t count;
+        bool dense;
+        bool uniform;                   // 所有候选的值都是 uniformValue (values 为空)
+        uint64_t uniformValue;
+        std::vector<uint64_t> bits;     // 稠密块
+        std::vector<uint32_t> indices;  // 稀疏块，升序
+        std::vector<uint8_t> values;    // count * 值大小，按槽位顺序
+
+        uint64_t MemoryBytes() const {
+            return bits.size() * sizeof(uint64_t) + indices.size() * sizeof(uint32_t) + values.size();
+        }
+    };
+
+    std::vector<Block> m_blocks;        // 按地址排序，不含没有候选的块
+    int32_t m_valueType;
+
+    // 由位图整理出块的候选 (选稠密或稀疏)，values 为匹配槽位的值 (uniform 时为空)
+    static void StoreCandidates(Block& block, std::vector<uint64_t>& bits, std::vector<uint8_t>& values, size_t valueSize);
+
+    template <typename Visit>
+    static void ForEachCandidate(const Block& block, Visit&& visit);
+};
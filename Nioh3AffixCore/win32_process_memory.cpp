@@ -0,0 +1,239 @@
+#include "win32_process_memory.h"
+#include "shared_memory.h"
+#include <Psapi.h>
+#include <TlHelp32.h>
+
+#pragma comment(lib, "psapi.lib")
+
+namespace {
+    typedef PVOID (WINAPI* MapViewOfFileNuma2Fn)(HANDLE, HANDLE, ULONG64, PVOID, SIZE_T, ULONG, ULONG, ULONG);
+    typedef BOOL (WINAPI* UnmapViewOfFile2Fn)(HANDLE, PVOID, ULONG);
+
+    constexpr ULONG NO_PREFERRED_NODE = 0xFFFFFFFF;    // NUMA_NO_PREFERRED_NODE
+
+    struct SharedViewApi {
+        MapViewOfFileNuma2Fn mapViewOfFileNuma2 = nullptr;
+        UnmapViewOfFile2Fn unmapViewOfFile2 = nullptr;
+
+        SharedViewApi() {
+            HMODULE kernelBase = GetModuleHandleW(L"kernelbase.dll");
+            if (kernelBase != nullptr) {
+                mapViewOfFileNuma2 = (MapViewOfFileNuma2Fn)GetProcAddress(kernelBase, "MapViewOfFileNuma2");
+                unmapViewOfFile2 = (UnmapViewOfFile2Fn)GetProcAddress(kernelBase, "UnmapViewOfFile2");
+            }
+        }
+
+        bool IsAvailable() const { return mapViewOfFileNuma2 != nullptr && unmapViewOfFile2 != nullptr; }
+    };
+
+    const SharedViewApi& GetSharedViewApi() {
+        static const SharedViewApi api;
+        return api;
+    }
+}
+
+Win32ProcessMemory::Win32ProcessMemory()
+    : m_process(nullptr)
+{
+}
+
+Win32ProcessMemory::~Win32ProcessMemory() {
+    Close();
+}
+
+bool Win32ProcessMemory::Open(DWORD processId) {
+    Close();
+
+    m_process = OpenProcess(
+        PROCESS_VM_READ | PROCESS_VM_WRITE | PROCESS_VM_OPERATION | PROCESS_QUERY_INFORMATION,
+        FALSE,
+        processId
+    );
+    return m_process != nullptr;
+}
+
+void Win32ProcessMemory::Close() {
+    ResumeThreads();
+    if (m_process != nullptr) {
+        CloseHandle(m_process);
+        m_process = nullptr;
+    }
+}
+
+bool Win32ProcessMemory::Read(QWORD address, void* buffer, size_t size, size_t* bytesRead) {
+    SIZE_T read = 0;
+    BOOL ok = ReadProcessMemory(m_process, (LPCVOID)address, buffer, size, &read);
+    if (bytesRead) *bytesRead = (size_t)read;
+    return ok && read == size;
+}
+
+bool Win32ProcessMemory::Write(QWORD address, const void* buffer, size_t size) {
+    SIZE_T written = 0;
+    return WriteProcessMemory(m_process, (LPVOID)address, buffer, size, &written) && written == size;
+}
+
+bool Win32ProcessMemory::Query(QWORD address, MemoryRegion& outRegion) {
+    MEMORY_BASIC_INFORMATION mbi;
+    if (VirtualQueryEx(m_process, (LPCVOID)address, &mbi, sizeof(mbi)) != sizeof(mbi)) {
+        return false;
+    }
+    outRegion.baseAddress = (QWORD)mbi.BaseAddress;
+    outRegion.regionSize = (QWORD)mbi.RegionSize;
+    outRegion.state = mbi.State;
+    outRegion.protect = mbi.Protect;
+    outRegion.type = mbi.Type;
+    return true;
+}
+
+bool Win32ProcessMemory::Protect(QWORD address, size_t size, uint32_t newProtect, uint32_t* oldProtect) {
+    DWORD old = 0;
+    if (!VirtualProtectEx(m_process, (LPVOID)address, size, newProtect, &old)) {
+        return false;
+    }
+    if (oldProtect) *oldProtect = old;
+    return true;
+}
+
+QWORD Win32ProcessMemory::Allocate(QWORD preferredAddress, size_t size, uint32_t protect) {
+    return (QWORD)VirtualAllocEx(m_process, (LPVOID)preferredAddress, size, MEM_COMMIT | MEM_RESERVE, protect);
+}
+
+bool Win32ProcessMemory::Free(QWORD address) {
+    return VirtualFreeEx(m_process, (LPVOID)address, 0, MEM_RELEASE) != FALSE;
+}
+
+bool Win32ProcessMemory::GetMainModule(QWORD& baseAddress, QWORD& moduleSize) {
+    HMODULE hMods[1024];
+    DWORD cbNeeded;
+
+    if (EnumProcessModules(m_process, hMods, sizeof(hMods), &cbNeeded)) {
+        MODULEINFO modInfo;
+        if (GetModuleInformation(m_process, hMods[0], &modInfo, sizeof(modInfo))) {
+            baseAddress = (QWORD)modInfo.lpBaseOfDll;
+            moduleSize = (QWORD)modInfo.SizeOfImage;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Win32ProcessMemory::CanMapShared() const {
+    return m_process != nullptr && GetSharedViewApi().IsAvailable();
+}
+
+bool Win32ProcessMemory::MapShared(QWORD preferredAddress, size_t size, SharedView& outView) {
+    if (!CanMapShared()) {
+        return false;
+    }
+    const SharedViewApi& api = GetSharedViewApi();
+
+    SharedMemory* section = new SharedMemory();
+    if (!section->CreateAnonymous(size)) {
+        delete section;
+        return false;
+    }
+
+    PVOID remote = api.mapViewOfFileNuma2(
+        (HANDLE)section->GetNativeHandle(),
+        m_process,
+        0,
+        (PVOID)preferredAddress,
+        size,
+        0,
+        PAGE_READWRITE,
+        NO_PREFERRED_NODE
+    );
+    if (remote == nullptr) {
+        delete section;
+        return false;
+    }
+
+    outView.remoteAddress = (QWORD)remote;
+    outView.section = section;
+    return true;
+}
+
+void Win32ProcessMemory::UnmapShared(SharedView& view) {
+    if (view.section == nullptr) {
+        return;
+    }
+
+    const SharedViewApi& api = GetSharedViewApi();
+    if (view.remoteAddress != 0 && m_process != nullptr && api.IsAvailable()) {
+        api.unmapViewOfFile2(m_process, (PVOID)view.remoteAddress, 0);
+    }
+
+    // 目标进程的视图独立持有节对象，本进程一侧可以直接关闭
+    delete view.section;
+    view.section = nullptr;
+    view.remoteAddress = 0;
+}
+
+bool Win32ProcessMemory::SuspendThreads(std::vector<QWORD>* outInstructionPointers) {
+    ResumeThreads();
+    if (outInstructionPointers != nullptr) {
+        outInstructionPointers->clear();
+    }
+    if (m_process == nullptr) {
+        return false;
+    }
+
+    DWORD processId = GetProcessId(m_process);
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    bool ok = true;
+    THREADENTRY32 entry;
+    entry.dwSize = sizeof(entry);
+    for (BOOL more = Thread32First(snapshot, &entry); more && ok; more = Thread32Next(snapshot, &entry)) {
+        if (entry.th32OwnerProcessID != processId || entry.th32ThreadID == GetCurrentThreadId()) {
+            continue;
+        }
+        HANDLE thread = OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION,
+            FALSE, entry.th32ThreadID);
+        if (thread == nullptr) {
+            // 快照之后已退出的线程
+            if (GetLastError() == ERROR_INVALID_PARAMETER) {
+                continue;
+            }
+            ok = false;
+            break;
+        }
+        if (SuspendThread(thread) == (DWORD)-1) {
+            CloseHandle(thread);
+            ok = false;
+            break;
+        }
+        m_suspended.push_back(thread);
+
+        // 挂起在内核返回前不一定生效，GetThreadContext 会等到线程真正停下
+        CONTEXT context = {};
+        context.ContextFlags = CONTEXT_CONTROL;
+        if (!GetThreadContext(thread, &context)) {
+            ok = false;
+            break;
+        }
+        if (outInstructionPointers != nullptr) {
+            outInstructionPointers->push_back((QWORD)context.Rip);
+        }
+    }
+    CloseHandle(snapshot);
+
+    if (!ok) {
+        ResumeThreads();
+        if (outInstructionPointers != nullptr) {
+            outInstructionPointers->clear();
+        }
+    }
+    return ok;
+}
+
+void Win32ProcessMemory::ResumeThreads() {
+    for (HANDLE thread : m_suspended) {
+        ResumeThread(thread);
+        CloseHandle(thread);
+    }
+    m_suspended.clear();
+}
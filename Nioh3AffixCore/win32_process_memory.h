@@ -0,0 +1,43 @@
+#pragma once
+
+#include <windows.h>
+#include "process_memory.h"
+#include <vector>
+
+// 基于 OpenProcess 句柄的 Win32 后端
+class Win32ProcessMemory : public ProcessMemory {
+public:
+    Win32ProcessMemory();
+    ~Win32ProcessMemory() override;
+
+    // 打开目标进程
+    bool Open(DWORD processId);
+
+    // 关闭进程句柄
+    void Close();
+
+    HANDLE GetHandle() const { return m_process; }
+
+    bool Read(QWORD address, void* buffer, size_t size, size_t* bytesRead = nullptr) override;
+    bool Write(QWORD address, const void* buffer, size_t size) override;
+    bool Query(QWORD address, MemoryRegion& outRegion) override;
+    bool Protect(QWORD address, size_t size, uint32_t newProtect, uint32_t* oldProtect) override;
+    QWORD Allocate(QWORD preferredAddress, size_t size, uint32_t protect) override;
+    bool Free(QWORD address) override;
+    bool GetMainModule(QWORD& baseAddress, QWORD& moduleSize) override;
+
+    // 页面文件支持的无名节，本进程用 MapViewOfFile 映射，目标进程用 MapViewOfFile2 映射
+    // (MapViewOfFileNuma2 / UnmapViewOfFile2 在 Windows 10 1703 之前不存在，运行时解析)
+    bool CanMapShared() const override;
+    bool MapShared(QWORD preferredAddress, size_t size, SharedView& outView) override;
+    void UnmapShared(SharedView& view) override;
+
+    // 按 Toolhelp 快照逐个 SuspendThread，任一线程失败时恢复已挂起的线程并返回 false
+    // (快照之后新建的线程不在其中)
+    bool SuspendThreads(std::vector<QWORD>* outInstructionPointers) override;
+    void ResumeThreads() override;
+
+private:
+    HANDLE m_process;
+    std::vector<HANDLE> m_suspended;    // 已挂起的线程句柄，ResumeThreads 时恢复并关闭
+};
@@ -0,0 +1,358 @@
+#include "x64_decoder.h"
+#include <cstring>
+
+namespace {
+    constexpr size_t MAX_INSTRUCTION_LENGTH = 15;
+
+    // 操作码属性 (按位组合，与 MapFlags 的返回值同为 uint8_t)
+    constexpr uint8_t OP_NONE = 0;
+    constexpr uint8_t OP_MODRM = 1 << 0;
+    constexpr uint8_t OP_IMM8 = 1 << 1;
+    constexpr uint8_t OP_IMMZ = 1 << 2;     // 32 位立即数 (66 前缀且无 REX.W 时为 16 位)
+    constexpr uint8_t OP_IMM16 = 1 << 3;
+    constexpr uint8_t OP_REL8 = 1 << 4;
+    constexpr uint8_t OP_REL32 = 1 << 5;
+    constexpr uint8_t OP_INVALID = 1 << 7;
+
+    bool IsLegacyPrefix(uint8_t value) {
+        switch (value) {
+        case 0xF0: case 0xF2: case 0xF3:
+        case 0x2E: case 0x36: case 0x3E: case 0x26: case 0x64: case 0x65:
+        case 0x66: case 0x67:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    uint8_t OneByteFlags(uint8_t op) {
+        if (op < 0x40) {
+            switch (op & 7) {
+            case 0: case 1: case 2: case 3:
+                return OP_MODRM;
+            case 4:
+                return OP_IMM8;
+            case 5:
+                return OP_IMMZ;
+            default:
+                // push/pop 段寄存器、daa/das/aaa/aas 在 64 位模式下无效 (段前缀和 0F 在之前处理)
+                return OP_INVALID;
+            }
+        }
+        if (op >= 0x50 && op <= 0x5F) return OP_NONE;
+        if (op >= 0x70 && op <= 0x7F) return OP_REL8;
+        if (op >= 0x84 && op <= 0x8F) return OP_MODRM;
+        if (op >= 0x90 && op <= 0x9F) return op == 0x9A ? OP_INVALID : OP_NONE;
+        if (op >= 0xB0 && op <= 0xB7) return OP_IMM8;
+        if (op >= 0xB8 && op <= 0xBF) return OP_IMMZ;     // REX.W 时为 64 位，由调用者处理
+        if (op >= 0xD8 && op <= 0xDF) return OP_MODRM;     // x87
+
+        switch (op) {
+        case 0x63: return OP_MODRM;
+        case 0x68: return OP_IMMZ;
+        case 0x69: return OP_MODRM | OP_IMMZ;
+        case 0x6A: return OP_IMM8;
+        case 0x6B: return OP_MODRM | OP_IMM8;
+        case 0x6C: case 0x6D: case 0x6E: case 0x6F: return OP_NONE;
+        case 0x80: return OP_MODRM | OP_IMM8;
+        case 0x81: return OP_MODRM | OP_IMMZ;
+        case 0x83: return OP_MODRM | OP_IMM8;
+        case 0xA0: case 0xA1: case 0xA2: case 0xA3: return OP_NONE;  // moffs，由调用者处理
+        case 0xA4: case 0xA5: case 0xA6: case 0xA7: return OP_NONE;
+        case 0xA8: return OP_IMM8;
+        case 0xA9: return OP_IMMZ;
+        case 0xAA: case 0xAB: case 0xAC: case 0xAD: case 0xAE: case 0xAF: return OP_NONE;
+        case 0xC0: case 0xC1: return OP_MODRM | OP_IMM8;
+        case 0xC2: return OP_IMM16;
+        case 0xC3: return OP_NONE;
+        case 0xC6: return OP_MODRM | OP_IMM8;
+        case 0xC7: return OP_MODRM | OP_IMMZ;
+        case 0xC8: return OP_IMM16 | OP_IMM8;
+        case 0xC9: return OP_NONE;
+        case 0xCA: return OP_IMM16;
+        case 0xCB: case 0xCC: return OP_NONE;
+        case 0xCD: return OP_IMM8;
+        case 0xCF: return OP_NONE;
+        case 0xD0: case 0xD1: case 0xD2: case 0xD3: return OP_MODRM;
+        case 0xD7: return OP_NONE;
+        case 0xE0: case 0xE1: case 0xE2: case 0xE3: return OP_REL8;
+        case 0xE4: case 0xE5: case 0xE6: case 0xE7: return OP_IMM8;
+        case 0xE8: case 0xE9: return OP_REL32;
+        case 0xEB: return OP_REL8;
+        case 0xEC: case 0xED: case 0xEE: case 0xEF: return OP_NONE;
+        case 0xF1: case 0xF4: case 0xF5: return OP_NONE;
+        case 0xF6: case 0xF7: return OP_MODRM;             // /0 /1 带立即数，由调用者处理
+        case 0xF8: case 0xF9: case 0xFA: case 0xFB: case 0xFC: case 0xFD: return OP_NONE;
+        case 0xFE: case 0xFF: return OP_MODRM;
+        default:
+            // 60 61 82 9A CE D4 D5 D6 EA 在 64 位模式下无效
+            return OP_INVALID;
+        }
+    }
+
+    // 0F 映射 (也用于 VEX/EVEX 的 map 1)
+    uint8_t TwoByteFlags(uint8_t op) {
+        if (op >= 0x80 && op <= 0x8F) return OP_REL32;
+        if (op >= 0x30 && op <= 0x37) return OP_NONE;      // wrmsr rdtsc rdmsr rdpmc sysenter sysexit getsec
+        if (op >= 0xC8 && op <= 0xCF) return OP_NONE;      // bswap
+        if (op >= 0x70 && op <= 0x73) return OP_MODRM | OP_IMM8;
+
+        switch (op) {
+        case 0x04: case 0x0A: case 0x0C: return OP_INVALID;
+        case 0x05: case 0x06: case 0x07: case 0x08: case 0x09: case 0x0B: case 0x0E: return OP_NONE;
+        case 0x0F: return OP_MODRM | OP_IMM8;   // 3DNow! (后缀字节)
+        case 0x77: return OP_NONE;              // emms / vzeroupper
+        case 0xA0: case 0xA1: case 0xA2: case 0xA8: case 0xA9: case 0xAA: return OP_NONE;
+        case 0xA4: case 0xAC: case 0xBA: return OP_MODRM | OP_IMM8;
+        case 0xC2: case 0xC4: case 0xC5: case 0xC6: return OP_MODRM | OP_IMM8;
+        default:
+            return OP_MODRM;
+        }
+    }
+
+    uint8_t MapFlags(uint8_t map, uint8_t op) {
+        switch (map) {
+        case 1: return TwoByteFlags(op);
+        case 2: return OP_MODRM;                // 0F 38
+        case 3: return OP_MODRM | OP_IMM8;      // 0F 3A
+        default: return OP_INVALID;
+        }
+    }
+}
+
+bool DecodeX64Instruction(const uint8_t* code, size_t available, X64Instruction& outInstruction) {
+    memset(&outInstruction, 0, sizeof(outInstruction));
+    if (available > MAX_INSTRUCTION_LENGTH) {
+        available = MAX_INSTRUCTION_LENGTH;
+    }
+
+    size_t pos = 0;
+    bool operandSize16 = false;
+    bool addressSize32 = false;
+    bool rexW = false;
+
+    // 传统前缀，之后是可选的 REX
+    while (pos < available && IsLegacyPrefix(code[pos])) {
+        if (code[pos] == 0x66) operandSize16 = true;
+        if (code[pos] == 0x67) addressSize32 = true;
+        pos++;
+    }
+    if (pos < available && (code[pos] & 0xF0) == 0x40) {
+        rexW = (code[pos] & 0x08) != 0;
+        pos++;
+    }
+    if (pos >= available) {
+        return false;
+    }
+
+    outInstruction.opcodeOffset = (uint8_t)pos;
+    uint8_t map = 0;
+    uint8_t op = code[pos++];
+    uint8_t flags;
+    bool vexMap1NoModRM = false;
+
+    if (op == 0x0F) {
+        if (pos >= available) return false;
+        op = code[pos++];
+        if (op == 0x38 || op == 0x3A) {
+            map = op == 0x38 ? 2 : 3;
+            if (pos >= available) return false;
+            op = code[pos++];
+        } else {
+            map = 1;
+        }
+        flags = MapFlags(map, op);
+    } else if (op == 0xC4 || op == 0xC5 || op == 0x62) {
+        // VEX (C5 xx / C4 xx xx) 和 EVEX (62 xx xx xx)，64 位模式下没有 LES/LDS/BOUND
+        size_t prefixSize = op == 0xC5 ? 1 : (op == 0xC4 ? 2 : 3);
+        if (pos + prefixSize >= available) return false;
+        if (op == 0xC5) {
+            map = 1;
+        } else if (op == 0xC4) {
+            map = code[pos] & 0x1F;
+            rexW = (code[pos + 1] & 0x80) != 0;
+        } else {
+            map = code[pos] & 0x07;
+            rexW = (code[pos + 1] & 0x80) != 0;
+        }
+        pos += prefixSize;
+        op = code[pos++];
+        // vzeroupper/vzeroall 没有 ModRM；其余 VEX/EVEX 指令都有
+        vexMap1NoModRM = map == 1 && op == 0x77;
+        flags = (map >= 1 && map <= 3) ? MapFlags(map, op) : (map == 5 || map == 6 ? OP_MODRM : OP_INVALID);
+        if (flags & (OP_REL8 | OP_REL32)) {
+            return false;
+        }
+        flags = vexMap1NoModRM ? OP_NONE : (uint8_t)((flags & OP_IMM8) | OP_MODRM);
+    } else {
+        if (op == 0x8F && pos < available && (code[pos] & 0x38) != 0) {
+            return false;   // XOP
+        }
+        flags = OneByteFlags(op);
+    }
+
+    if (flags & OP_INVALID) {
+        return false;
+    }
+    outInstruction.opcode = op;
+    outInstruction.opcodeMap = map;
+
+    // ModRM / SIB / 位移
+    if (flags & OP_MODRM) {
+        if (pos >= available) return false;
+        uint8_t modrm = code[pos++];
+        uint8_t mod = modrm >> 6;
+        uint8_t reg = (modrm >> 3) & 7;
+        uint8_t rm = modrm & 7;
+        size_t displacement = 0;
+        outInstruction.hasModRM = true;
+
+        if (mod != 3) {
+            if (rm == 4) {
+                if (pos >= available) return false;
+                uint8_t sib = code[pos++];
+                if (mod == 0 && (sib & 7) == 5) {
+                    displacement = 4;
+                }
+            } else if (mod == 0 && rm == 5) {
+                outInstruction.ripRelative = true;
+                outInstruction.displacementOffset = (uint8_t)pos;
+                displacement = 4;
+            }
+            if (mod == 1) displacement = 1;
+            if (mod == 2) displacement = 4;
+        }
+        pos += displacement;
+
+        // test r/m, imm 是 F6/F7 中唯一带立即数的形式
+        if (map == 0 && (op == 0xF6 || op == 0xF7) && reg <= 1) {
+            flags |= op == 0xF6 ? OP_IMM8 : OP_IMMZ;
+        }
+        // xbegin (C7 F8 rel32) 的目标是相对的，不能当作立即数复制
+        if (map == 0 && op == 0xC7 && modrm == 0xF8) {
+            return false;
+        }
+        // EIP 相对寻址 (67 前缀) 截断到 32 位，不支持搬移
+        if (outInstruction.ripRelative && addressSize32) {
+            return false;
+        }
+    }
+
+    // 立即数和相对位移
+    if (map == 0 && op >= 0xB8 && op <= 0xBF && rexW) {
+        pos += 8;
+    } else if (map == 0 && op >= 0xA0 && op <= 0xA3) {
+        pos += addressSize32 ? 4 : 8;
+    } else {
+        if (flags & OP_IMM16) pos += 2;
+        if (flags & OP_IMM8) pos += 1;
+        if (flags & OP_IMMZ) pos += operandSize16 && !rexW ? 2 : 4;
+    }
+
+    if (flags & (OP_REL8 | OP_REL32)) {
+        // 64 位模式下近跳转的 66 前缀在 Intel 和 AMD 上含义不同，不支持
+        if (operandSize16) {
+            return false;
+        }
+        outInstruction.branchOffset = (uint8_t)pos;
+        outInstruction.branchSize = (flags & OP_REL8) ? 1 : 4;
+        pos += outInstruction.branchSize;
+
+        if (map == 1) {
+            outInstruction.branch = X64BranchKind::Jcc;
+            outInstruction.condition = op & 0x0F;
+        } else if (op >= 0x70 && op <= 0x7F) {
+            outInstruction.branch = X64BranchKind::Jcc;
+            outInstruction.condition = op & 0x0F;
+        } else if (op >= 0xE0 && op <= 0xE3) {
+            outInstruction.branch = X64BranchKind::Loop;
+        } else if (op == 0xE8) {
+            outInstruction.branch = X64BranchKind::Call;
+        } else {
+            outInstruction.branch = X64BranchKind::Jmp;
+        }
+    }
+
+    if (pos > available) {
+        return false;
+    }
+    outInstruction.length = (uint8_t)pos;
+    return true;
+}
+
+size_t MeasureX64Instructions(const uint8_t* code, size_t available, size_t minimumLength) {
+    size_t length = 0;
+    while (length < minimumLength) {
+        X64Instruction instruction;
+        if (!DecodeX64Instruction(code + length, available - length, instruction)) {
+            return 0;
+        }
+        length += instruction.length;
+    }
+    return length;
+}
+
+bool RelocateX64Instructions(const uint8_t* code, size_t length, QWORD sourceAddress, X64Emitter& emitter) {
+    size_t offset = 0;
+    while (offset < length) {
+        X64Instruction instruction;
+        if (!DecodeX64Instruction(code + offset, length - offset, instruction)) {
+            return false;
+        }
+
+        const uint8_t* bytes = code + offset;
+        QWORD address = sourceAddress + offset;
+        QWORD next = address + instruction.length;
+
+        if (instruction.branch != X64BranchKind::None) {
+            int64_t delta;
+            if (instruction.branchSize == 1) {
+                delta = (int8_t)bytes[instruction.branchOffset];
+            } else {
+                int32_t rel32;
+                memcpy(&rel32, bytes + instruction.branchOffset, sizeof(rel32));
+                delta = rel32;
+            }
+            QWORD target = next + (QWORD)delta;
+
+            // 跳回被覆盖区域内部的分支在搬移后会落到注入点的 jmp 中间
+            if (target > sourceAddress && target < sourceAddress + length) {
+                return false;
+            }
+
+            switch (instruction.branch) {
+            case X64BranchKind::Jmp:
+                emitter.Jmp(target);
+                break;
+            case X64BranchKind::Jcc:
+                emitter.Jcc((X64Cond)instruction.condition, target);
+                break;
+            case X64BranchKind::Call:
+                emitter.Call(target);
+                break;
+            default:
+                return false;
+            }
+        } else if (instruction.ripRelative) {
+            // 目标地址不变，按新位置重算位移 (位移之后可能还有立即数，指令长度不变)
+            int32_t displacement;
+            memcpy(&displacement, bytes + instruction.displacementOffset, sizeof(displacement));
+            QWORD target = next + (QWORD)(int64_t)displacement;
+            QWORD newNext = emitter.CurrentAddress() + instruction.length;
+            if (!X64Emitter::IsRel32Reachable(newNext, target)) {
+                return false;
+            }
+
+            uint8_t copy[MAX_INSTRUCTION_LENGTH];
+            memcpy(copy, bytes, instruction.length);
+            int32_t newDisplacement = (int32_t)(target - newNext);
+            memcpy(copy + instruction.displacementOffset, &newDisplacement, sizeof(newDisplacement));
+            emitter.Bytes(copy, instruction.length);
+        } else {
+            emitter.Bytes(bytes, instruction.length);
+        }
+
+        offset += instruction.length;
+    }
+    return emitter.Ok();
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "x64_emitter.h"
+#include <cstddef>
+#include <cstdint>
+
+// x86-64 指令长度解码与搬移
+//
+// 注入点被 5 字节的 jmp 覆盖，被覆盖的完整指令要搬到 hook 代码中执行。
+// 解码器只求出长度和需要修正的字段 (RIP 相对位移、相对跳转)，不解释指令语义:
+//   前缀 (传统前缀 / REX) -> 操作码 (单字节、0F、0F 38、0F 3A、VEX、EVEX) -> ModRM/SIB/位移 -> 立即数
+// 64 位模式下无效的单字节操作码 (如 06、27、60、9A、D4、EA) 和 XOP 编码返回失败。
+// 搬移时:
+//   RIP 相对操作数  -> 原样复制，按新位置重算 disp32
+//   jmp/call rel8/rel32 -> 按新位置重新编码为 rel32 (不可达时为绝对跳转/调用)
+//   jcc rel8/rel32  -> 重新编码为 0F 8x rel32 (不可达时为条件取反 + 绝对跳转)
+//   loop/jrcxz (只有 rel8 形式) 和跳回被覆盖区域内部的分支无法搬移，返回失败
+enum class X64BranchKind : uint8_t {
+    None = 0,
+    Jmp,        // EB rel8 / E9 rel32
+    Jcc,        // 7x rel8 / 0F 8x rel32
+    Call,       // E8 rel32
+    Loop        // E0-E3 rel8 (loopnz/loopz/loop/jrcxz)
+};
+
+struct X64Instruction {
+    uint8_t length;
+    uint8_t opcodeOffset;       // 第一个操作码字节的位置 (前缀之后，VEX/EVEX 时为前缀第一个字节)
+    uint8_t opcode;             // 主操作码 (映射中的最后一个操作码字节)
+    uint8_t opcodeMap;          // 0 单字节, 1 0F, 2 0F 38, 3 0F 3A (VEX/EVEX 按 mmmmm 字段)
+    bool hasModRM;
+    bool ripRelative;           // 有 [rip+disp32] 操作数
+    uint8_t displacementOffset; // ripRelative 时 disp32 的位置
+    X64BranchKind branch;
+    uint8_t branchOffset;       // branch != None 时相对位移的位置
+    uint8_t branchSize;         // 1 或 4
+    uint8_t condition;          // Jcc 的条件码 (低 4 位)
+};
+
+// 解码 code 开头的一条指令，available 为可读字节数；无法识别或不完整时返回 false
+bool DecodeX64Instruction(const uint8_t* code, size_t available, X64Instruction& outInstruction);
+
+// 覆盖至少 minimumLength 字节的完整指令的总长度；解码失败时返回 0
+size_t MeasureX64Instructions(const uint8_t* code, size_t available, size_t minimumLength);
+
+// 把 code 开头总长为 length 的完整指令 (原位于 sourceAddress) 搬到 emitter 的当前位置
+// 失败 (解码失败、无法搬移的分支、位移不可达、缓冲区不足) 时返回 false
+bool RelocateX64Instructions(const uint8_t* code, size_t length, QWORD sourceAddress, X64Emitter& emitter);
@@ -0,0 +1,387 @@
+#include "x64_emitter.h"
+#include <cstring>
+
+namespace {
+    constexpr uint8_t REX_W = 0x48;
+    constexpr uint8_t REX_R = 0x04;
+    constexpr uint8_t REX_B = 0x01;
+
+    uint8_t RegLow(X64Reg reg) { return (uint8_t)reg & 7; }
+    bool RegHigh(X64Reg reg) { return ((uint8_t)reg & 8) != 0; }
+}
+
+X64Emitter::X64Emitter(uint8_t* buffer, size_t capacity, QWORD baseAddress)
+    : m_buffer(buffer)
+    , m_capacity(capacity)
+    , m_size(0)
+    , m_baseAddress(baseAddress)
+    , m_failed(false)
+{
+}
+
+void X64Emitter::Emit8(uint8_t value) {
+    if (m_size >= m_capacity) {
+        m_failed = true;
+        return;
+    }
+    m_buffer[m_size++] = value;
+}
+
+void X64Emitter::Emit32(uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        Emit8((uint8_t)(value >> (i * 8)));
+    }
+}
+
+void X64Emitter::Emit64(uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        Emit8((uint8_t)(value >> (i * 8)));
+    }
+}
+
+bool X64Emitter::IsRel32Reachable(QWORD nextInstruction, QWORD target) {
+    int64_t delta = (int64_t)(target - nextInstruction);
+    return delta >= INT32_MIN && delta <= INT32_MAX;
+}
+
+void X64Emitter::Bytes(const uint8_t* bytes, size_t count) {
+    if (m_size + count > m_capacity) {
+        m_failed = true;
+        return;
+    }
+    memcpy(m_buffer + m_size, bytes, count);
+    m_size += count;
+}
+
+void X64Emitter::EmitRip(const uint8_t* opcode, size_t opcodeSize, X64Reg reg, QWORD target, bool lockPrefix) {
+    // [lock] + REX + opcode + ModRM + disp32
+    QWORD next = CurrentAddress() + (lockPrefix ? 1 : 0) + 1 + opcodeSize + 1 + 4;
+    if (!IsRel32Reachable(next, target)) {
+        m_failed = true;
+        return;
+    }
+
+    if (lockPrefix) {
+        Emit8(0xF0);
+    }
+    Emit8((uint8_t)(REX_W | (RegHigh(reg) ? REX_R : 0)));
+    Bytes(opcode, opcodeSize);
+    Emit8((uint8_t)((RegLow(reg) << 3) | 0x05));   // mod=00 rm=101: [rip+disp32]
+    Emit32((uint32_t)(int32_t)(target - next));
+}
+
+void X64Emitter::MovRip(uint8_t opcode, X64Reg reg, QWORD target) {
+    EmitRip(&opcode, 1, reg, target);
+}
+
+void X64Emitter::EmitRegReg(uint8_t opcode, uint8_t regField, X64Reg rm) {
+    EmitRegReg(&opcode, 1, regField, rm);
+}
+
+void X64Emitter::EmitRegReg(const uint8_t* opcode, size_t opcodeSize, uint8_t regField, X64Reg rm) {
+    Emit8((uint8_t)(REX_W | ((regField & 8) ? REX_R : 0) | (RegHigh(rm) ? REX_B : 0)));
+    Bytes(opcode, opcodeSize);
+    Emit8((uint8_t)(0xC0 | ((regField & 7) << 3) | RegLow(rm)));
+}
+
+void X64Emitter::MovRipStore(QWORD target, X64Reg source) {
+    MovRip(0x89, source, target);
+}
+
+void X64Emitter::MovRipLoad(X64Reg destination, QWORD target) {
+    MovRip(0x8B, destination, target);
+}
+
+void X64Emitter::MovImm64(X64Reg destination, uint64_t value) {
+    Emit8((uint8_t)(REX_W | (RegHigh(destination) ? REX_B : 0)));
+    Emit8((uint8_t)(0xB8 + RegLow(destination)));
+    Emit64(value);
+}
+
+void X64Emitter::MovImm32(X64Reg destination, uint32_t value) {
+    if (RegHigh(destination)) {
+        Emit8(0x41);
+    }
+    Emit8((uint8_t)(0xB8 + RegLow(destination)));
+    Emit32(value);
+}
+
+void X64Emitter::MovReg(X64Reg destination, X64Reg source) {
+    EmitRegReg(0x89, (uint8_t)source, destination);
+}
+
+void X64Emitter::EmitMem(const uint8_t* opcode, size_t opcodeSize, X64Reg reg, X64Reg base, int32_t displacement, bool lockPrefix) {
+    bool disp8 = displacement >= -128 && displacement <= 127;
+    // rbp/r13 作为基址时没有 mod=00 形式，统一带位移
+    uint8_t mod = disp8 ? 0x40 : 0x80;
+
+    if (lockPrefix) {
+        Emit8(0xF0);
+    }
+    Emit8((uint8_t)(REX_W | (RegHigh(reg) ? REX_R : 0) | (RegHigh(base) ? REX_B : 0)));
+    Bytes(opcode, opcodeSize);
+    Emit8((uint8_t)(mod | (RegLow(reg) << 3) | RegLow(base)));
+    if (RegLow(base) == 4) {
+        Emit8(0x24);    // rsp/r12 作为基址需要 SIB
+    }
+    if (disp8) {
+        Emit8((uint8_t)(int8_t)displacement);
+    } else {
+        Emit32((uint32_t)displacement);
+    }
+}
+
+void X64Emitter::MovStore(X64Reg base, int32_t displacement, X64Reg source) {
+    const uint8_t opcode = 0x89;
+    EmitMem(&opcode, 1, source, base, displacement);
+}
+
+void X64Emitter::MovLoad(X64Reg destination, X64Reg base, int32_t displacement) {
+    const uint8_t opcode = 0x8B;
+    EmitMem(&opcode, 1, destination, base, displacement);
+}
+
+void X64Emitter::AndLoad(X64Reg destination, X64Reg base, int32_t displacement) {
+    const uint8_t opcode = 0x23;
+    EmitMem(&opcode, 1, destination, base, displacement);
+}
+
+void X64Emitter::XorLoad(X64Reg destination, X64Reg base, int32_t displacement) {
+    const uint8_t opcode = 0x33;
+    EmitMem(&opcode, 1, destination, base, displacement);
+}
+
+void X64Emitter::CmpRip(X64Reg reg, QWORD target) {
+    MovRip(0x3B, reg, target);
+}
+
+void X64Emitter::LockCmpxchg(X64Reg base, int32_t displacement, X64Reg source) {
+    const uint8_t opcode[2] = { 0x0F, 0xB1 };
+    EmitMem(opcode, sizeof(opcode), source, base, displacement, true);
+}
+
+void X64Emitter::LockAdd(X64Reg base, int32_t displacement, X64Reg source) {
+    const uint8_t opcode = 0x01;
+    EmitMem(&opcode, 1, source, base, displacement, true);
+}
+
+void X64Emitter::LeaRip(X64Reg destination, QWORD target) {
+    MovRip(0x8D, destination, target);
+}
+
+void X64Emitter::LockXaddRip(QWORD target, X64Reg source) {
+    const uint8_t opcode[2] = { 0x0F, 0xC1 };
+    EmitRip(opcode, sizeof(opcode), source, target, true);
+}
+
+void X64Emitter::LockCmpxchgRip(QWORD target, X64Reg source) {
+    const uint8_t opcode[2] = { 0x0F, 0xB1 };
+    EmitRip(opcode, sizeof(opcode), source, target, true);
+}
+
+void X64Emitter::AddReg(X64Reg destination, X64Reg source) {
+    EmitRegReg(0x01, (uint8_t)source, destination);
+}
+
+void X64Emitter::SubReg(X64Reg destination, X64Reg source) {
+    EmitRegReg(0x29, (uint8_t)source, destination);
+}
+
+void X64Emitter::OrReg(X64Reg destination, X64Reg source) {
+    EmitRegReg(0x09, (uint8_t)source, destination);
+}
+
+void X64Emitter::XorReg(X64Reg destination, X64Reg source) {
+    EmitRegReg(0x31, (uint8_t)source, destination);
+}
+
+void X64Emitter::TestReg(X64Reg first, X64Reg second) {
+    EmitRegReg(0x85, (uint8_t)second, first);
+}
+
+void X64Emitter::CmpReg(X64Reg first, X64Reg second) {
+    EmitRegReg(0x39, (uint8_t)second, first);
+}
+
+void X64Emitter::Bsr(X64Reg destination, X64Reg source) {
+    // 0F BD /r: reg 字段是目的操作数
+    const uint8_t opcode[2] = { 0x0F, 0xBD };
+    EmitRegReg(opcode, sizeof(opcode), (uint8_t)destination, source);
+}
+
+void X64Emitter::AddImm8(X64Reg destination, int8_t value) {
+    EmitRegReg(0x83, 0, destination);
+    Emit8((uint8_t)value);
+}
+
+void X64Emitter::AndImm32(X64Reg destination, int32_t value) {
+    EmitRegReg(0x81, 4, destination);
+    Emit32((uint32_t)value);
+}
+
+void X64Emitter::OrImm8(X64Reg destination, int8_t value) {
+    EmitRegReg(0x83, 1, destination);
+    Emit8((uint8_t)value);
+}
+
+void X64Emitter::ShlImm8(X64Reg destination, uint8_t count) {
+    EmitRegReg(0xC1, 4, destination);
+    Emit8(count);
+}
+
+void X64Emitter::Inc(X64Reg destination) {
+    EmitRegReg(0xFF, 0, destination);
+}
+
+void X64Emitter::Dec(X64Reg destination) {
+    EmitRegReg(0xFF, 1, destination);
+}
+
+void X64Emitter::Rdtsc() {
+    Emit8(0x0F);
+    Emit8(0x31);
+}
+
+void X64Emitter::Push(X64Reg reg) {
+    if (RegHigh(reg)) {
+        Emit8(0x41);
+    }
+    Emit8((uint8_t)(0x50 + RegLow(reg)));
+}
+
+void X64Emitter::Pop(X64Reg reg) {
+    if (RegHigh(reg)) {
+        Emit8(0x41);
+    }
+    Emit8((uint8_t)(0x58 + RegLow(reg)));
+}
+
+void X64Emitter::Pushfq() {
+    Emit8(0x9C);
+}
+
+void X64Emitter::Popfq() {
+    Emit8(0x9D);
+}
+
+void X64Emitter::Lahf() {
+    Emit8(0x9F);
+}
+
+void X64Emitter::Sahf() {
+    Emit8(0x9E);
+}
+
+void X64Emitter::SetoAl() {
+    Emit8(0x0F);
+    Emit8(0x90);
+    Emit8(0xC0);
+}
+
+void X64Emitter::AddAlImm8(int8_t value) {
+    Emit8(0x04);
+    Emit8((uint8_t)value);
+}
+
+void X64Emitter::JmpRel32(QWORD target) {
+    QWORD next = CurrentAddress() + JMP_REL32_SIZE;
+    if (!IsRel32Reachable(next, target)) {
+        m_failed = true;
+        return;
+    }
+
+    Emit8(0xE9);
+    Emit32((uint32_t)(int32_t)(target - next));
+}
+
+void X64Emitter::JmpAbs(QWORD target) {
+    Emit8(0xFF);
+    Emit8(0x25);
+    Emit32(0);
+    Emit64(target);
+}
+
+void X64Emitter::Jmp(QWORD target) {
+    if (IsRel32Reachable(CurrentAddress() + JMP_REL32_SIZE, target)) {
+        JmpRel32(target);
+    } else {
+        JmpAbs(target);
+    }
+}
+
+void X64Emitter::Jcc(X64Cond condition, QWORD target) {
+    QWORD next = CurrentAddress() + 6;
+    if (IsRel32Reachable(next, target)) {
+        Emit8(0x0F);
+        Emit8((uint8_t)(0x80 | (uint8_t)condition));
+        Emit32((uint32_t)(int32_t)(target - next));
+        return;
+    }
+
+    Emit8((uint8_t)(0x70 | ((uint8_t)condition ^ 1)));
+    Emit8((uint8_t)JMP_ABS_SIZE);
+    JmpAbs(target);
+}
+
+void X64Emitter::Call(QWORD target) {
+    QWORD next = CurrentAddress() + 5;
+    if (IsRel32Reachable(next, target)) {
+        Emit8(0xE8);
+        Emit32((uint32_t)(int32_t)(target - next));
+        return;
+    }
+
+    Emit8(0xFF);
+    Emit8(0x15);
+    Emit32(2);
+    Emit8(0xEB);
+    Emit8(0x08);
+    Emit64(target);
+}
+
+void X64Emitter::Nop(size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        Emit8(0x90);
+    }
+}
+
+void X64Emitter::EmitLabelRel32(X64Label& label) {
+    if (label.position != (size_t)-1) {
+        // 向后跳: 位移相对 rel32 之后的下一条指令
+        Emit32((uint32_t)(int32_t)((int64_t)label.position - (int64_t)(m_size + 4)));
+        return;
+    }
+
+    if (label.fixupCount >= X64Label::MAX_FIXUPS) {
+        m_failed = true;
+        return;
+    }
+    label.fixups[label.fixupCount++] = m_size;
+    Emit32(0);
+}
+
+void X64Emitter::Jmp(X64Label& label) {
+    Emit8(0xE9);
+    EmitLabelRel32(label);
+}
+
+void X64Emitter::Jcc(X64Cond condition, X64Label& label) {
+    Emit8(0x0F);
+    Emit8((uint8_t)(0x80 | (uint8_t)condition));
+    EmitLabelRel32(label);
+}
+
+void X64Emitter::Bind(X64Label& label) {
+    label.position = m_size;
+    for (int i = 0; i < label.fixupCount; i++) {
+        size_t fixup = label.fixups[i];
+        if (fixup + 4 > m_size) {
+            continue;   // 缓冲区不足时没有写入，失败标志已置位
+        }
+        int32_t delta = (int32_t)((int64_t)m_size - (int64_t)(fixup + 4));
+        for (int b = 0; b < 4; b++) {
+            m_buffer[fixup + b] = (uint8_t)((uint32_t)delta >> (b * 8));
+        }
+    }
+    label.fixupCount = 0;
+}
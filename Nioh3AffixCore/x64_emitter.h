@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+typedef uint64_t QWORD;
+
+// 64 位通用寄存器 (取值即编码)
+enum class X64Reg : uint8_t {
+    Rax = 0, Rcx = 1, Rdx = 2, Rbx = 3, Rsp = 4, Rbp = 5, Rsi = 6, Rdi = 7,
+    R8 = 8, R9 = 9, R10 = 10, R11 = 11, R12 = 12, R13 = 13, R14 = 14, R15 = 15
+};
+
+// 条件码 (Jcc 的低 4 位)
+enum class X64Cond : uint8_t {
+    Equal = 0x4,
+    NotEqual = 0x5,
+    BelowOrEqual = 0x6
+};
+
+// 跳转标签: 绑定前的跳转记下位置，Bind 时回填 rel32
+struct X64Label {
+    static constexpr int MAX_FIXUPS = 8;
+
+    size_t position = (size_t)-1;
+    size_t fixups[MAX_FIXUPS] = {};
+    int fixupCount = 0;
+};
+
+// 最小的 x86-64 指令编码器，只覆盖注入代码用到的指令
+// 编码器按目标地址 (代码最终在目标进程中的位置) 计算 RIP 相对位移和 rel32 跳转，
+// 写入本地缓冲区；位移超出范围或缓冲区不足时置失败标志，调用者在最后检查 Ok()。
+class X64Emitter {
+public:
+    // buffer: 本地缓冲区；baseAddress: buffer[0] 在目标进程中的地址
+    X64Emitter(uint8_t* buffer, size_t capacity, QWORD baseAddress);
+
+    size_t Size() const { return m_size; }
+    QWORD CurrentAddress() const { return m_baseAddress + m_size; }
+    bool Ok() const { return !m_failed; }
+
+    // 原样复制字节 (如被覆盖的原始指令)
+    void Bytes(const uint8_t* bytes, size_t count);
+
+    // mov [rip+disp32], r64    REX.W 89 /r
+    void MovRipStore(QWORD target, X64Reg source);
+
+    // mov r64, [rip+disp32]    REX.W 8B /r
+    void MovRipLoad(X64Reg destination, QWORD target);
+
+    // mov r64, imm64           REX.W B8+r
+    void MovImm64(X64Reg destination, uint64_t value);
+
+    // mov r32, imm32           B8+r (高 32 位清零)
+    void MovImm32(X64Reg destination, uint32_t value);
+
+    // mov r64, r64             REX.W 89 /r
+    void MovReg(X64Reg destination, X64Reg source);
+
+    // mov [base+disp], r64     REX.W 89 /r
+    void MovStore(X64Reg base, int32_t displacement, X64Reg source);
+
+    // mov r64, [base+disp]     REX.W 8B /r
+    void MovLoad(X64Reg destination, X64Reg base, int32_t displacement);
+
+    // and/xor r64, [base+disp] REX.W 23 /r / REX.W 33 /r
+    void AndLoad(X64Reg destination, X64Reg base, int32_t displacement);
+    void XorLoad(X64Reg destination, X64Reg base, int32_t displacement);
+
+    // cmp r64, [rip+disp32]    REX.W 3B /r
+    void CmpRip(X64Reg reg, QWORD target);
+
+    // lock cmpxchg [base+disp], r64   F0 REX.W 0F B1 /r (比较值在 rax 中)
+    void LockCmpxchg(X64Reg base, int32_t displacement, X64Reg source);
+
+    // lock add [base+disp], r64     F0 REX.W 01 /r
+    void LockAdd(X64Reg base, int32_t displacement, X64Reg source);
+
+    // lea r64, [rip+disp32]    REX.W 8D /r
+    void LeaRip(X64Reg destination, QWORD target);
+
+    // lock xadd [rip+disp32], r64   F0 REX.W 0F C1 /r
+    void LockXaddRip(QWORD target, X64Reg source);
+
+    // lock cmpxchg [rip+disp32], r64   F0 REX.W 0F B1 /r (比较值在 rax 中)
+    void LockCmpxchgRip(QWORD target, X64Reg source);
+
+    // add/sub/or/xor r64, r64 / test r64, r64 / cmp r64, r64 / bsr r64, r64
+    // add r64, imm8 / and r64, imm32 / or r64, imm8 / shl r64, imm8 / inc r64 / dec r64
+    void AddReg(X64Reg destination, X64Reg source);
+    void SubReg(X64Reg destination, X64Reg source);
+    void OrReg(X64Reg destination, X64Reg source);
+    void XorReg(X64Reg destination, X64Reg source);
+    void TestReg(X64Reg first, X64Reg second);
+    void CmpReg(X64Reg first, X64Reg second);
+    void Bsr(X64Reg destination, X64Reg source);
+    void AddImm8(X64Reg destination, int8_t value);
+    void AndImm32(X64Reg destination, int32_t value);
+    void OrImm8(X64Reg destination, int8_t value);
+    void ShlImm8(X64Reg destination, uint8_t count);
+    void Inc(X64Reg destination);
+    void Dec(X64Reg destination);
+
+    // rdtsc                    0F 31 (edx:eax = 时间戳计数)
+    void Rdtsc();
+
+    // push/pop r64, pushfq/popfq
+    void Push(X64Reg reg);
+    void Pop(X64Reg reg);
+    void Pushfq();
+    void Popfq();
+
+    // lahf / sahf              9F / 9E (ah <-> SF/ZF/AF/PF/CF，不含 OF)
+    // seto al / add al, imm8   0F 90 C0 / 04 ib (单独保存和恢复 OF)
+    void Lahf();
+    void Sahf();
+    void SetoAl();
+    void AddAlImm8(int8_t value);
+
+    // jmp rel32                E9 (5 字节)
+    void JmpRel32(QWORD target);
+
+    // jmp [rip+0]; dq target   FF 25 00000000 + 8 字节 (14 字节，不占用寄存器)
+    void JmpAbs(QWORD target);
+
+    // 在 rel32 范围内用 JmpRel32，否则用 JmpAbs
+    void Jmp(QWORD target);
+
+    // 跳向绝对地址的条件跳转 / 调用 (搬移原始指令时使用)
+    // rel32 可达时为 0F 8x rel32 / E8 rel32；否则为
+    //   7x' 0E; FF 25 00000000; dq target          (条件取反跳过绝对跳转，16 字节)
+    //   FF 15 02000000; EB 08; dq target           (call [rip+2]，16 字节)
+    // condition 可以是任意 4 位条件码
+    void Jcc(X64Cond condition, QWORD target);
+    void Call(QWORD target);
+
+    // 跳向本段代码内的标签 (统一用 rel32 编码)
+    void Jmp(X64Label& label);                  // E9 rel32
+    void Jcc(X64Cond condition, X64Label& label);  // 0F 8x rel32
+
+    // 把标签绑定到当前位置，并回填之前的跳转
+    void Bind(X64Label& label);
+
+    // 单字节 nop 填充
+    void Nop(size_t count);
+
+    // 从 nextInstruction 出发的 32 位相对位移能否到达 target
+    static bool IsRel32Reachable(QWORD nextInstruction, QWORD target);
+
+    static constexpr size_t JMP_REL32_SIZE = 5;
+    static constexpr size_t JMP_ABS_SIZE = 14;
+
+private:
+    uint8_t* m_buffer;
+    size_t m_capacity;
+    size_t m_size;
+    QWORD m_baseAddress;
+    bool m_failed;
+
+    void Emit8(uint8_t value);
+    void Emit32(uint32_t value);
+    void Emit64(uint64_t value);
+
+    // RIP 相对寻址 ([prefix] REX.W opcode... ModRM disp32)，disp32 相对下一条指令
+    void EmitRip(const uint8_t* opcode, size_t opcodeSize, X64Reg reg, QWORD target, bool lockPrefix = false);
+    void MovRip(uint8_t opcode, X64Reg reg, QWORD target);
+
+    // REX.W + opcode... + ModRM(mod=11)
+    void EmitRegReg(uint8_t opcode, uint8_t regField, X64Reg rm);
+    void EmitRegReg(const uint8_t* opcode, size_t opcodeSize, uint8_t regField, X64Reg rm);
+
+    // [lock] REX.W + opcode... + ModRM/SIB + disp8/disp32 ([base+disp])
+    void EmitMem(const uint8_t* opcode, size_t opcodeSize, X64Reg reg, X64Reg base, int32_t displacement, bool lockPrefix = false);
+
+    // 在当前位置写入跳向标签的 rel32 (标签未绑定时登记回填位置)
+    void EmitLabelRel32(X64Label& label);
+};
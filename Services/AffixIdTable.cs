@@ -204,6 +204,29 @@ public sealed class AffixIdTable
             }
         }
 
+        return Build(idToName);
+    }
+
+    /// <summary>
+    /// Builds the table from names read out of the game (see NativeAffixEngine.TryLoadGameCatalog).
+    /// </summary>
+    public static AffixIdTable FromNames(IReadOnlyDictionary<int, string> names)
+    {
+        var idToName = new Dictionary<int, string>(names.Count);
+        foreach (var kv in names)
+        {
+            var name = kv.Value.Trim();
+            if (kv.Key != 0 && name.Length != 0)
+            {
+                idToName[kv.Key] = name;
+            }
+        }
+
+        return Build(idToName);
+    }
+
+    private static AffixIdTable Build(Dictionary<int, string> idToName)
+    {
         var nameToMinId = new Dictionary<string, int>(StringComparer.OrdinalIgnoreCase);
         foreach (var kv in idToName)
         {
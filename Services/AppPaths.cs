@@ -16,4 +16,10 @@ public static class AppPaths
 
     public static string GetUnderworldSkillTablePath()
         => System.IO.Path.Combine(GetAppDataDir(), "underworld_skill_table.csv");
+
+    public static string GetGameCatalogCachePath()
+        => System.IO.Path.Combine(GetAppDataDir(), "game_catalog.bin");
+
+    public static string GetRecordLayoutPath()
+        => System.IO.Path.Combine(GetAppDataDir(), "record_layout.txt");
 }
@@ -172,6 +172,30 @@ public sealed class UnderworldSkillTable
             allNames.Add(name);
         }
 
+        return Build(idToName, allNames);
+    }
+
+    /// <summary>
+    /// Builds the table from names read out of the game (see NativeAffixEngine.TryLoadGameCatalog).
+    /// </summary>
+    public static UnderworldSkillTable FromNames(IReadOnlyDictionary<int, string> names)
+    {
+        var idToName = new Dictionary<int, string>(names.Count);
+        var allNames = new List<string>(names.Count);
+        foreach (var kv in names)
+        {
+            var name = kv.Value.Trim();
+            if (name.Length != 0 && idToName.TryAdd(kv.Key, name))
+            {
+                allNames.Add(name);
+            }
+        }
+
+        return Build(idToName, allNames);
+    }
+
+    private static UnderworldSkillTable Build(Dictionary<int, string> idToName, List<string> allNames)
+    {
         var duplicateNames = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
         var counts = new Dictionary<string, int>(StringComparer.OrdinalIgnoreCase);
         foreach (var name in allNames)